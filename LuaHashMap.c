@@ -23,12 +23,19 @@
  
  */
 
+/* pthread_rwlock_t is hidden by strict ANSI modes (e.g. -std=c89/c99) unless POSIX.1-2001 is requested. */
+#if !defined(_WIN32) && !defined(WIN32) && !defined(_POSIX_C_SOURCE) && !defined(_XOPEN_SOURCE) && !defined(_GNU_SOURCE)
+	#define _POSIX_C_SOURCE 200112L
+#endif
+
 #include "LuaHashMap.h"
 #include "lua.h"
 #include "lauxlib.h"
+#include "lualib.h"
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <limits.h>
 
 #if !defined(__STDC_VERSION__) || (__STDC_VERSION__ < 199901L)
 	/* Not ISO/IEC 9899:1999-compliant. */
@@ -67,12 +74,299 @@
 #define LUAHASHMAP_ASSERT(e)
 #endif
 
+/* Minimal mutex, reader/writer lock and condition variable wrappers for LuaHashMapSharded, group locking (LuaHashMap_EnableGroupLocking), LuaHashMapActor and snapshots. */
+#if defined(_WIN32) || defined(WIN32)
+	#ifndef WIN32_LEAN_AND_MEAN
+		#define WIN32_LEAN_AND_MEAN
+	#endif
+	#include <windows.h>
+	/* SRW locks are smaller and faster than CRITICAL_SECTION and need no cleanup. (Vista and later) */
+	typedef SRWLOCK LuaHashMap_InternalMutex;
+	#define LUAHASHMAP_MUTEX_INIT(the_mutex) InitializeSRWLock(the_mutex)
+	#define LUAHASHMAP_MUTEX_DESTROY(the_mutex)
+	#define LUAHASHMAP_MUTEX_LOCK(the_mutex) AcquireSRWLockExclusive(the_mutex)
+	#define LUAHASHMAP_MUTEX_UNLOCK(the_mutex) ReleaseSRWLockExclusive(the_mutex)
+	typedef SRWLOCK LuaHashMap_InternalRWLock;
+	#define LUAHASHMAP_RWLOCK_INIT(the_lock) InitializeSRWLock(the_lock)
+	#define LUAHASHMAP_RWLOCK_DESTROY(the_lock)
+	#define LUAHASHMAP_RWLOCK_TRY_LOCK_EXCLUSIVE(the_lock) (0 != TryAcquireSRWLockExclusive(the_lock))
+	#define LUAHASHMAP_RWLOCK_LOCK_EXCLUSIVE(the_lock) AcquireSRWLockExclusive(the_lock)
+	#define LUAHASHMAP_RWLOCK_UNLOCK_EXCLUSIVE(the_lock) ReleaseSRWLockExclusive(the_lock)
+	#define LUAHASHMAP_RWLOCK_TRY_LOCK_SHARED(the_lock) (0 != TryAcquireSRWLockShared(the_lock))
+	#define LUAHASHMAP_RWLOCK_LOCK_SHARED(the_lock) AcquireSRWLockShared(the_lock)
+	#define LUAHASHMAP_RWLOCK_UNLOCK_SHARED(the_lock) ReleaseSRWLockShared(the_lock)
+	typedef CONDITION_VARIABLE LuaHashMap_InternalCondition;
+	#define LUAHASHMAP_CONDITION_INIT(the_condition) InitializeConditionVariable(the_condition)
+	#define LUAHASHMAP_CONDITION_DESTROY(the_condition)
+	#define LUAHASHMAP_CONDITION_SIGNAL(the_condition) WakeConditionVariable(the_condition)
+	#define LUAHASHMAP_CONDITION_WAIT(the_condition, the_mutex) SleepConditionVariableSRW(the_condition, the_mutex, INFINITE, 0)
+	#define LUAHASHMAP_THREAD_YIELD() SwitchToThread()
+#else
+	#include <pthread.h>
+	typedef pthread_mutex_t LuaHashMap_InternalMutex;
+	#define LUAHASHMAP_MUTEX_INIT(the_mutex) pthread_mutex_init(the_mutex, NULL)
+	#define LUAHASHMAP_MUTEX_DESTROY(the_mutex) pthread_mutex_destroy(the_mutex)
+	#define LUAHASHMAP_MUTEX_LOCK(the_mutex) pthread_mutex_lock(the_mutex)
+	#define LUAHASHMAP_MUTEX_UNLOCK(the_mutex) pthread_mutex_unlock(the_mutex)
+	typedef pthread_rwlock_t LuaHashMap_InternalRWLock;
+	#define LUAHASHMAP_RWLOCK_INIT(the_lock) pthread_rwlock_init(the_lock, NULL)
+	#define LUAHASHMAP_RWLOCK_DESTROY(the_lock) pthread_rwlock_destroy(the_lock)
+	#define LUAHASHMAP_RWLOCK_TRY_LOCK_EXCLUSIVE(the_lock) (0 == pthread_rwlock_trywrlock(the_lock))
+	#define LUAHASHMAP_RWLOCK_LOCK_EXCLUSIVE(the_lock) pthread_rwlock_wrlock(the_lock)
+	#define LUAHASHMAP_RWLOCK_UNLOCK_EXCLUSIVE(the_lock) pthread_rwlock_unlock(the_lock)
+	#define LUAHASHMAP_RWLOCK_TRY_LOCK_SHARED(the_lock) (0 == pthread_rwlock_tryrdlock(the_lock))
+	#define LUAHASHMAP_RWLOCK_LOCK_SHARED(the_lock) pthread_rwlock_rdlock(the_lock)
+	#define LUAHASHMAP_RWLOCK_UNLOCK_SHARED(the_lock) pthread_rwlock_unlock(the_lock)
+	typedef pthread_cond_t LuaHashMap_InternalCondition;
+	#define LUAHASHMAP_CONDITION_INIT(the_condition) pthread_cond_init(the_condition, NULL)
+	#define LUAHASHMAP_CONDITION_DESTROY(the_condition) pthread_cond_destroy(the_condition)
+	#define LUAHASHMAP_CONDITION_SIGNAL(the_condition) pthread_cond_signal(the_condition)
+	#define LUAHASHMAP_CONDITION_WAIT(the_condition, the_mutex) pthread_cond_wait(the_condition, the_mutex)
+	#include <sched.h>
+	#define LUAHASHMAP_THREAD_YIELD() sched_yield()
+#endif
+
+/* The few atomic operations the LuaHashMapActor submission queue and snapshot publishing need. 
+ * Loads and adds of longs are sequentially consistent because the snapshot epoch protocol needs a store followed by a load to stay in order.
+ * Compilers without atomics fall back to one global mutex, which is correct but no longer lock-free.
+ */
+#if defined(_WIN32) || defined(WIN32)
+	static LUAHASHMAP_INLINE bool Internal_AtomicCompareAndSwapPointer(void* volatile* the_target, void* expected_value, void* new_value)
+	{
+		return InterlockedCompareExchangePointer(the_target, new_value, expected_value) == expected_value;
+	}
+	static LUAHASHMAP_INLINE void* Internal_AtomicExchangePointer(void* volatile* the_target, void* new_value)
+	{
+		return InterlockedExchangePointer(the_target, new_value);
+	}
+	static LUAHASHMAP_INLINE void* Internal_AtomicLoadPointer(void* volatile* the_target)
+	{
+		return InterlockedCompareExchangePointer(the_target, NULL, NULL);
+	}
+	static LUAHASHMAP_INLINE void Internal_AtomicStoreLong(volatile long* the_target, long new_value)
+	{
+		InterlockedExchange(the_target, new_value);
+	}
+	static LUAHASHMAP_INLINE long Internal_AtomicLoadLong(volatile long* the_target)
+	{
+		return InterlockedCompareExchange(the_target, 0, 0);
+	}
+	/* Returns the new value. */
+	static LUAHASHMAP_INLINE long Internal_AtomicAddLong(volatile long* the_target, long the_delta)
+	{
+		return InterlockedExchangeAdd(the_target, the_delta) + the_delta;
+	}
+#elif defined(__GNUC__)
+	static LUAHASHMAP_INLINE bool Internal_AtomicCompareAndSwapPointer(void* volatile* the_target, void* expected_value, void* new_value)
+	{
+		return __atomic_compare_exchange_n(the_target, &expected_value, new_value, 0, __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+	}
+	static LUAHASHMAP_INLINE void* Internal_AtomicExchangePointer(void* volatile* the_target, void* new_value)
+	{
+		return __atomic_exchange_n(the_target, new_value, __ATOMIC_ACQ_REL);
+	}
+	static LUAHASHMAP_INLINE void* Internal_AtomicLoadPointer(void* volatile* the_target)
+	{
+		return __atomic_load_n(the_target, __ATOMIC_ACQUIRE);
+	}
+	static LUAHASHMAP_INLINE void Internal_AtomicStoreLong(volatile long* the_target, long new_value)
+	{
+		__atomic_store_n(the_target, new_value, __ATOMIC_RELEASE);
+	}
+	static LUAHASHMAP_INLINE long Internal_AtomicLoadLong(volatile long* the_target)
+	{
+		return __atomic_load_n(the_target, __ATOMIC_SEQ_CST);
+	}
+	/* Returns the new value. */
+	static LUAHASHMAP_INLINE long Internal_AtomicAddLong(volatile long* the_target, long the_delta)
+	{
+		return __atomic_add_fetch(the_target, the_delta, __ATOMIC_SEQ_CST);
+	}
+#else
+	static pthread_mutex_t s_atomicFallbackMutex = PTHREAD_MUTEX_INITIALIZER;
+	static bool Internal_AtomicCompareAndSwapPointer(void* volatile* the_target, void* expected_value, void* new_value)
+	{
+		bool ret_val = false;
+		pthread_mutex_lock(&s_atomicFallbackMutex);
+		if(*the_target == expected_value)
+		{
+			*the_target = new_value;
+			ret_val = true;
+		}
+		pthread_mutex_unlock(&s_atomicFallbackMutex);
+		return ret_val;
+	}
+	static void* Internal_AtomicExchangePointer(void* volatile* the_target, void* new_value)
+	{
+		void* ret_val;
+		pthread_mutex_lock(&s_atomicFallbackMutex);
+		ret_val = *the_target;
+		*the_target = new_value;
+		pthread_mutex_unlock(&s_atomicFallbackMutex);
+		return ret_val;
+	}
+	static void* Internal_AtomicLoadPointer(void* volatile* the_target)
+	{
+		void* ret_val;
+		pthread_mutex_lock(&s_atomicFallbackMutex);
+		ret_val = *the_target;
+		pthread_mutex_unlock(&s_atomicFallbackMutex);
+		return ret_val;
+	}
+	static void Internal_AtomicStoreLong(volatile long* the_target, long new_value)
+	{
+		pthread_mutex_lock(&s_atomicFallbackMutex);
+		*the_target = new_value;
+		pthread_mutex_unlock(&s_atomicFallbackMutex);
+	}
+	static long Internal_AtomicLoadLong(volatile long* the_target)
+	{
+		long ret_val;
+		pthread_mutex_lock(&s_atomicFallbackMutex);
+		ret_val = *the_target;
+		pthread_mutex_unlock(&s_atomicFallbackMutex);
+		return ret_val;
+	}
+	static long Internal_AtomicAddLong(volatile long* the_target, long the_delta)
+	{
+		long ret_val;
+		pthread_mutex_lock(&s_atomicFallbackMutex);
+		*the_target += the_delta;
+		ret_val = *the_target;
+		pthread_mutex_unlock(&s_atomicFallbackMutex);
+		return ret_val;
+	}
+#endif
+
 struct LuaHashMap
 {
 	lua_State* luaState;
 	lua_Alloc memoryAllocator;
 	void* allocatorUserData;
 	int uniqueTableNameForSharedState;
+	/* Absolute stack index of the table while an access session is open (see LuaHashMap_BeginAccess), 0 otherwise. */
+	int pinnedTableStackIndex;
+	int pinnedAccessCount;
+	/* Number of live entries in the table so Count doesn't have to walk the table. */
+	size_t elementCount;
+	/* The largest the hash part is known to have been sized for since it was last rebuilt. Lua never shrinks a table on remove so this is used to estimate dead slots. */
+	size_t hashCapacityHint;
+	/* The array part size the table was last created with, so Reserve can tell when a request is already covered. */
+	size_t arrayCapacityHint;
+	/* Only meaningful before Lua 5.3. Integers that don't survive a trip through lua_Number are stored as light userdata. */
+	bool useExactIntegers;
+	/* Set when a LuaHashMap_Eval chunk may have modified the table behind our back. elementCount is recounted the next time it is needed. */
+	bool isElementCountStale;
+	/* Bumped whenever a key is added or the table is replaced. Either may rehash, which reorders a lua_next traversal (see LuaHashMapScan). */
+	size_t tableGeneration;
+	/* The lua_State's group lock, shared by every hash map on that lua_State (see Internal_JoinGroup). It only locks once isEnabled is set. */
+	struct LuaHashMapGroupLock* groupLock;
+	/* LuaHashMapSnapshot*. The latest LuaHashMap_PublishSnapshot, which holds a reference to it. NULL until the first publish. */
+	void* volatile publishedSnapshot;
+	/* LuaHashMap_AcquireSnapshot counts itself in snapshotReaderCounts[snapshotEpoch & 1] while it picks up publishedSnapshot. 
+	 * (See Internal_ReplacePublishedSnapshot.) 
+	 */
+	volatile long snapshotEpoch;
+	volatile long snapshotReaderCounts[2];
+};
+
+struct LuaHashMapCursor
+{
+	/* Holds the current key/value for the accessors. hashMap is the owning map. */
+	LuaHashMapIterator theIterator;
+	/* A coroutine of hash_map->luaState whose stack is [key, table] between steps (or [table] at the end). */
+	lua_State* threadState;
+	/* Registry reference that keeps threadState from being garbage collected. */
+	int threadReference;
+};
+
+struct LuaHashMapScan
+{
+	LuaHashMap* hashMap;
+	/* A coroutine of hash_map->luaState. Its stack is [key, table] while walking the table directly 
+	 * and [table, snapshot_keys] after switching to the snapshot.
+	 */
+	lua_State* threadState;
+	int threadReference;
+	/* hashMap->tableGeneration when the direct walk started. If it changes, the lua_next order can't be trusted anymore. */
+	size_t tableGeneration;
+	/* Next 1-based index into snapshot_keys, and the number of keys in it. */
+	size_t snapshotPosition;
+	size_t snapshotCount;
+	bool isSnapshot;
+	bool isFinished;
+};
+
+struct LuaHashMapShard
+{
+	LuaHashMap* hashMap;
+	LuaHashMap_InternalMutex shardLock;
+};
+
+/* Pad every shard out so two shards never share a cache line. Otherwise threads hammering different shards would still contend on the lock words. */
+union LuaHashMapShardSlot
+{
+	struct LuaHashMapShard theShard;
+	char cacheLinePadding[128];
+};
+
+struct LuaHashMapSharded
+{
+	union LuaHashMapShardSlot* shardsArray;
+	size_t numberOfShards;
+};
+
+struct LuaHashMapActor
+{
+	LuaHashMap* hashMap;
+	/* LuaHashMapActorRequest*. Submitters push onto the front with a compare-and-swap, so the list is newest first. 
+	 * The owner takes the whole list in one exchange.
+	 */
+	void* volatile pendingRequests;
+	/* Only used to put an idle owner to sleep (LuaHashMapActor_Run). Submitting never blocks on it unless the queue was empty. */
+	LuaHashMap_InternalMutex wakeLock;
+	LuaHashMap_InternalCondition wakeCondition;
+	bool isStopRequested;
+};
+
+/* One per lua_State, kept alive by the registry (LUAHASHMAP_GROUP_LOCK_KEY) and cleaned up by its __gc when the lua_State is closed. */
+struct LuaHashMapGroupLock
+{
+	/* Set once by LuaHashMap_EnableGroupLocking. The locks below are only initialized after that. */
+	bool isEnabled;
+	/* Writers and anything that may allocate take this exclusively and run on the group's main lua_State. */
+	LuaHashMap_InternalRWLock readWriteLock;
+	/* Guards the reader state pool and the shared counters, since many readers hold readWriteLock at once. */
+	LuaHashMap_InternalMutex readerPoolLock;
+	/* Lua threads of the group's lua_State. Readers each borrow one so they don't share a stack. 
+	 * The first numberOfFreeReaderStates entries are the free ones.
+	 */
+	lua_State** readerStatesArray;
+	size_t numberOfFreeReaderStates;
+	LuaHashMapLockStatistics lockStatistics;
+};
+
+/* One bucket of a snapshot's open addressing table. */
+struct LuaHashMapSnapshotEntry
+{
+	size_t keyHash;
+	/* In the form made by Internal_CanonicalizeSnapshotKey. LUA_TNIL (all zero) marks an empty bucket. */
+	LuaHashMapValue theKey;
+	LuaHashMapValue theValue;
+};
+
+/* An immutable copy of a hash map that never touches the lua_State, so any number of threads can read it without locks. 
+ * It is one allocation: this header, the buckets, then the characters of every string key and value.
+ */
+struct LuaHashMapSnapshot
+{
+	volatile long referenceCount;
+	size_t numberOfEntries;
+	/* The number of buckets minus one. The number of buckets is a power of two at least twice numberOfEntries. */
+	size_t bucketMask;
+	struct LuaHashMapSnapshotEntry* bucketsArray;
+	/* The hash map's exact integer mode at publish time. It changes how light userdata keys are looked up. */
+	bool useExactIntegers;
 };
 
 
@@ -98,11 +392,21 @@ struct LuaHashMap
 #if 1
 	#define LUAHASHMAP_SETTABLE lua_rawset
 	#define LUAHASHMAP_GETTABLE lua_rawget
+	/* Integer keys skip the key push and go straight to the array part when they fall inside it. */
+	#define LUAHASHMAP_SETTABLEI lua_rawseti
+	#define LUAHASHMAP_GETTABLEI lua_rawgeti
 #else
 	#define LUAHASHMAP_SETTABLE lua_settable
 	#define LUAHASHMAP_GETTABLE lua_gettable
 #endif
 
+/* The length (a border) of the table, which for keys 1..n is how big the array part should be. */
+#if LUA_VERSION_NUM <= 501
+	#define LUAHASHMAP_RAWLEN(lua_state, stack_index) lua_objlen(lua_state, stack_index)
+#else
+	#define LUAHASHMAP_RAWLEN(lua_state, stack_index) lua_rawlen(lua_state, stack_index)
+#endif
+
 /* Lua 5.2 lua_pushstring returns the internalized string pointer, but 5.1 does not.
  * This is useful to me in a few places so I'm creating a macro.
  */
@@ -127,10 +431,8 @@ struct LuaHashMap
 	#if LUA_VERSION_NUM <= 501 /* Lua 5.1 or less */
 		#define LUAHASHMAP_GETGLOBAL_UNIQUESTRING(lua_state, unique_key) lua_rawgeti(lua_state, LUA_GLOBALSINDEX, unique_key)
 
-/* Unused: But here is the implementation if needed. */
-/*
+		/* Pops the table on top of the stack and stores it as the hash map's table. */
 		#define LUAHASHMAP_SETGLOBAL_UNIQUESTRING(lua_state, unique_key) lua_rawseti(lua_state, LUA_GLOBALSINDEX, unique_key)
-*/
 
 		#define LUAHASHMAP_REPLACE_WITH_EMPTY_TABLE(lua_state, unique_key) \
 			do { \
@@ -155,15 +457,14 @@ struct LuaHashMap
 				lua_remove(lua_state, -2); \
 			} while(0)
 
-/* Unused: But here is the implementation if needed. */
-/*
+		/* Pops the table on top of the stack and stores it as the hash map's table. */
 		#define LUAHASHMAP_SETGLOBAL_UNIQUESTRING(lua_state, unique_key) \
 			do { \
 				lua_pushglobaltable(lua_state); \
-				lua_rawseti(lua_state, -1, unique_key); \
+				lua_insert(lua_state, -2); \
+				lua_rawseti(lua_state, -2, unique_key); \
 				lua_pop(lua_state, 1); \
 			} while(0)
-*/
 
 		#define LUAHASHMAP_REPLACE_WITH_EMPTY_TABLE(lua_state, unique_key) \
 			do { \
@@ -199,10 +500,8 @@ struct LuaHashMap
 
 	#define LUAHASHMAP_GETGLOBAL_UNIQUESTRING(lua_state, unique_key) lua_rawgeti(lua_state, LUA_REGISTRYINDEX, unique_key)
 
-/* Unused: But here is the implementation if needed. */
-/*
+	/* Pops the table on top of the stack and stores it as the hash map's table. */
 	#define LUAHASHMAP_SETGLOBAL_UNIQUESTRING(lua_state, unique_key) lua_rawseti(lua_state, LUA_REGISTRYINDEX, unique_key)
-*/
 
 	#define LUAHASHMAP_REPLACE_WITH_EMPTY_TABLE(lua_state, unique_key) \
 		do { \
@@ -222,799 +521,1116 @@ struct LuaHashMap
 #endif
 
 
-static void Internal_InitializeInternalTables(LuaHashMap* hash_map)
+/* While an access session is open (LuaHashMap_BeginAccess), the table is already sitting on the stack 
+ * so we can just copy it to the top instead of going through LUAHASHMAP_GETGLOBAL_UNIQUESTRING every time.
+ */
+#define LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, unique_key) \
+	do { \
+		if(0 != (hash_map)->pinnedTableStackIndex) \
+		{ \
+			lua_pushvalue((hash_map)->luaState, (hash_map)->pinnedTableStackIndex); \
+		} \
+		else \
+		{ \
+			LUAHASHMAP_GETGLOBAL_UNIQUESTRING((hash_map)->luaState, unique_key); \
+		} \
+	} while(0)
+
+/* Hash maps sharing a lua_State may end their access sessions in any order. 
+ * Removing a slot from the middle of the stack would move the tables pinned above it, so an ended session that isn't on top 
+ * leaves this marker in its slot instead. The marker is popped once everything above it is gone.
+ */
+static const char s_pinnedSlotHoleMarker = 0;
+
+static LUAHASHMAP_INLINE bool Internal_IsPinnedSlotHole(lua_State* lua_state, int stack_index)
 {
-	/* Create a table in Lua to be our hash map */
-	 /* According to Lua Gems performance, Lua tables are created with 0 size by default to not waste memory
-	 * so creating different tables shouldn't be that bad.
-	 * 
-	 * I originally did an experiment to see if integer keys on the global table with 
-	 * rawset/geti was faster than the rawset/get with light userdata keys (which 
-	 * are also effectively integers). (The light userdata keys were static strings.)
-	 * My benchmarks are inconclusive, testing with 10000000 insert/removes.
-	 * They appear to be the same speed, though I've seen large timing variations in
-	 * both tests.
-	 * But in the changes for shared state, I realized luaL_ref basically was what I was doing with 
-	 * integer keys. So I removed all this for a luaL_ref based implementation which is more
-	 * general, but I lose the explicit separate tables for the 4 key types.
-	 * luaL_ref is nice in that is also creates unique table numbers automatically and recycles them as they become free.
-	 */
-	
-	lua_newtable(hash_map->luaState);
-	/* The idea is that every LuaHashMap instance gets a unique reference id so they can share the same lua_State. */
-	/* Even the first/original hash map created gets its own so all hash maps are effectively peers of each other. */
-	hash_map->uniqueTableNameForSharedState = Internal_NewGlobalLuaRef(hash_map->luaState);
+	return (LUA_TLIGHTUSERDATA == lua_type(lua_state, stack_index)) 
+		&& ((const void*)&s_pinnedSlotHoleMarker == lua_touserdata(lua_state, stack_index));
 }
 
-const LuaHashMapVersion* LuaHashMap_GetLinkedVersion()
+#ifdef LUAHASHMAP_DEBUG
+/* Every operation must leave the stack holding exactly the slots pinned by access sessions (of any hash map sharing the lua_State). 
+ * Debug builds keep that count in the registry, keyed by the lua_State, so Lua threads used by readers (see Internal_BeginSharedAccess) count as 0.
+ */
+static int Internal_GetPinnedSlotCount(lua_State* lua_state)
 {
-	static LuaHashMapVersion linked_version;
-	LUAHASHMAP_GET_COMPILED_VERSION(&linked_version);
-	return(&linked_version);
+	int number_of_slots;
+	lua_pushlightuserdata(lua_state, lua_state);
+	lua_rawget(lua_state, LUA_REGISTRYINDEX);
+	number_of_slots = (int)lua_tointeger(lua_state, -1);
+	lua_pop(lua_state, 1);
+	return number_of_slots;
 }
 
-LuaHashMap* LuaHashMap_Create()
+static void Internal_SetPinnedSlotCount(lua_State* lua_state, int number_of_slots)
 {
-	LuaHashMap* hash_map;
-	lua_State* lua_state = luaL_newstate();
-	if(NULL == lua_state)
+	lua_pushlightuserdata(lua_state, lua_state);
+	if(0 == number_of_slots)
 	{
-		return NULL;
+		lua_pushnil(lua_state);
 	}
-	hash_map = (LuaHashMap*)calloc(1, sizeof(LuaHashMap));
-	if(NULL == hash_map)
+	else
 	{
-		lua_close(lua_state);
-		return NULL;
+		lua_pushinteger(lua_state, number_of_slots);
 	}
-	hash_map->luaState = lua_state;
-
-	Internal_InitializeInternalTables(hash_map);
-
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);
-	return hash_map;
+	lua_rawset(lua_state, LUA_REGISTRYINDEX);
 }
 
-LuaHashMap* LuaHashMap_CreateWithAllocator(lua_Alloc the_allocator, void* user_data)
+#define LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map) LUAHASHMAP_ASSERT(lua_gettop((hash_map)->luaState) == Internal_GetPinnedSlotCount((hash_map)->luaState))
+#else
+#define LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map)
+#endif
+
+/* Removes the hash map's pinned table from the stack when its outermost session ends (or the hash map is freed).
+ * The slot is found by value since the stored index is only a hint if somebody else rearranged the stack.
+ */
+static void Internal_UnpinTable(LuaHashMap* hash_map)
 {
-	LuaHashMap* hash_map;
-	lua_State* lua_state = lua_newstate(the_allocator, user_data);
-	if(NULL == lua_state)
+	lua_State* lua_state = hash_map->luaState;
+	int stack_index = hash_map->pinnedTableStackIndex;
+
+	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(lua_state, hash_map->uniqueTableNameForSharedState); /* stack: [table, ...] */
+	if((stack_index > lua_gettop(lua_state) - 1) || (0 == lua_rawequal(lua_state, -1, stack_index)))
 	{
-		return NULL;
+		for(stack_index = lua_gettop(lua_state) - 1; stack_index > 0; stack_index--)
+		{
+			if(0 != lua_rawequal(lua_state, -1, stack_index))
+			{
+				break;
+			}
+		}
 	}
-
-	hash_map = (LuaHashMap*)(*the_allocator)(user_data, NULL, 0, sizeof(LuaHashMap));
-	if(NULL == hash_map)
+	lua_pop(lua_state, 1); /* stack: [...] */
+	hash_map->pinnedTableStackIndex = 0;
+	if(0 == stack_index)
 	{
-		lua_close(lua_state);
-		return NULL;
+		/* Somebody else already removed it. */
+		LUAHASHMAP_ASSERT(false);
+		return;
 	}
-	memset(hash_map, 0, sizeof(LuaHashMap));
-
-	hash_map->luaState = lua_state;
-	hash_map->memoryAllocator = the_allocator;
-	hash_map->allocatorUserData = user_data;
 
-	Internal_InitializeInternalTables(hash_map);
-	
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);
-	return hash_map;
+	if(lua_gettop(lua_state) == stack_index)
+	{
+		lua_pop(lua_state, 1);
+		/* Sessions below us that already ended */
+		while((lua_gettop(lua_state) > 0) && Internal_IsPinnedSlotHole(lua_state, -1))
+		{
+			lua_pop(lua_state, 1);
+		}
+	}
+	else
+	{
+		lua_pushlightuserdata(lua_state, (void*)&s_pinnedSlotHoleMarker);
+		lua_replace(lua_state, stack_index);
+	}
+#ifdef LUAHASHMAP_DEBUG
+	Internal_SetPinnedSlotCount(lua_state, lua_gettop(lua_state));
+#endif
 }
 
+/* hashCapacityHint only covers the hash part. Any entries beyond what the array part was created for must have grown the hash part. */
+static LUAHASHMAP_INLINE void Internal_RaiseHashCapacityHint(LuaHashMap* hash_map)
+{
+	if(hash_map->elementCount > hash_map->hashCapacityHint + hash_map->arrayCapacityHint)
+	{
+		hash_map->hashCapacityHint = hash_map->elementCount - hash_map->arrayCapacityHint;
+	}
+}
 
-LuaHashMap* LuaHashMap_CreateWithSizeHints(int number_of_array_elements, int number_of_hash_elements)
+/* Records an insert or remove in elementCount (and tableGeneration), given whether the key had a value before the set and has one after. */
+static LUAHASHMAP_INLINE void Internal_UpdateCount(LuaHashMap* hash_map, bool had_value, bool has_value)
 {
-	LuaHashMap* hash_map;
-	lua_State* lua_state = luaL_newstate();
-	if(NULL == lua_state)
+	if(has_value && !had_value)
 	{
-		return NULL;
+		hash_map->tableGeneration++;
 	}
-	hash_map = (LuaHashMap*)calloc(1, sizeof(LuaHashMap));
-	if(NULL == hash_map)
+	if(true == hash_map->isElementCountStale)
 	{
-		lua_close(lua_state);
-		return NULL;
+		/* It will be recounted from scratch anyway. */
+		return;
+	}
+	if(has_value && !had_value)
+	{
+		hash_map->elementCount++;
+		Internal_RaiseHashCapacityHint(hash_map);
+	}
+	else if(had_value && !has_value)
+	{
+		hash_map->elementCount--;
 	}
-	hash_map->luaState = lua_state;
-
-	lua_createtable(hash_map->luaState, number_of_array_elements, number_of_hash_elements);	
-	hash_map->uniqueTableNameForSharedState = Internal_NewGlobalLuaRef(hash_map->luaState);
-
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);
-	return hash_map;
 }
 
-
-LuaHashMap* LuaHashMap_CreateWithAllocatorAndSizeHints(lua_Alloc the_allocator, void* user_data, int number_of_array_elements, int number_of_hash_elements)
+/* Set without looking up the old value, for when elementCount is stale and will be recounted from scratch anyway.
+ * Any non-nil value may be a new key that rehashed the table, so tableGeneration must change.
+ */
+static LUAHASHMAP_INLINE void Internal_UpdateStaleCount(LuaHashMap* hash_map, bool has_value)
 {
-	LuaHashMap* hash_map;
-	lua_State* lua_state = lua_newstate(the_allocator, user_data);
-	if(NULL == lua_state)
+	if(has_value)
 	{
-		return NULL;
+		hash_map->tableGeneration++;
 	}
+}
 
-	hash_map = (LuaHashMap*)(*the_allocator)(user_data, NULL, 0, sizeof(LuaHashMap));
-	if(NULL == hash_map)
+/* Drop-in replacement for LUAHASHMAP_SETTABLE(lua_state, -3) which also keeps elementCount up to date.
+ * Expects stack: [value, key, table] and leaves stack: [table] just like LUAHASHMAP_SETTABLE.
+ * A nil value means a remove. We must look up the old value to know if this is an insert, an overwrite, 
+ * or a remove of a key that doesn't exist.
+ * That lookup doubles the cost of a set, so it is only done while the count is exact (see isElementCountStale).
+ */
+static LUAHASHMAP_INLINE void Internal_SetTableAndUpdateCount(LuaHashMap* hash_map)
+{
+	bool had_value;
+	bool has_value;
+
+	if(true == hash_map->isElementCountStale)
 	{
-		lua_close(lua_state);
-		return NULL;
+		has_value = (LUA_TNIL != lua_type(hash_map->luaState, -1));
+		LUAHASHMAP_SETTABLE(hash_map->luaState, -3);  /* table[key]=value; stack: [table] */
+		Internal_UpdateStaleCount(hash_map, has_value);
+		return;
 	}
-	memset(hash_map, 0, sizeof(LuaHashMap));
+	lua_pushvalue(hash_map->luaState, -2); /* stack: [key, value, key, table] */
+	LUAHASHMAP_GETTABLE(hash_map->luaState, -4);  /* table[key]; stack: [old_value, value, key, table] */
+	had_value = (LUA_TNIL != lua_type(hash_map->luaState, -1));
+	lua_pop(hash_map->luaState, 1); /* stack: [value, key, table] */
+	has_value = (LUA_TNIL != lua_type(hash_map->luaState, -1));
+	LUAHASHMAP_SETTABLE(hash_map->luaState, -3);  /* table[key]=value; stack: [table] */
 
-	hash_map->luaState = lua_state;
-	hash_map->memoryAllocator = the_allocator;
-	hash_map->allocatorUserData = user_data;
+	Internal_UpdateCount(hash_map, had_value, has_value);
+}
 
-	lua_createtable(hash_map->luaState, number_of_array_elements, number_of_hash_elements);	
-	hash_map->uniqueTableNameForSharedState = Internal_NewGlobalLuaRef(hash_map->luaState);
+static size_t Internal_Count(LuaHashMap* hash_map)
+{
+	size_t total_count = 0;
 
-	
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);
-	return hash_map;
-}
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+
+	lua_pushnil(hash_map->luaState);  /* first key */
+	while (lua_next(hash_map->luaState, -2) != 0) /* use index of table */
+	{
+		/* lua_next puts 'key' (at index -2) and 'value' (at index -1) */
+		total_count++;
+		/* removes 'value'; keeps 'key' for next iteration */
+		lua_pop(hash_map->luaState, 1);
+	}
 
+	/* Pop the global table */
+	lua_pop(hash_map->luaState, 1);	
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);	
+	return total_count;
+}
 
-LuaHashMap* LuaHashMap_CreateShare(LuaHashMap* original_hash_map)
+/* Use instead of reading elementCount directly so a count made stale by LuaHashMap_Eval is fixed up first. */
+static size_t Internal_GetElementCount(LuaHashMap* hash_map)
 {
-	LuaHashMap* hash_map;
-	if(NULL == original_hash_map)
+	if(true == hash_map->isElementCountStale)
 	{
-		return NULL;
+		hash_map->elementCount = Internal_Count(hash_map);
+		Internal_RaiseHashCapacityHint(hash_map);
+		hash_map->isElementCountStale = false;
 	}
-	if(NULL == original_hash_map->memoryAllocator)
+	return hash_map->elementCount;
+}
+
+/* The garbage collector belongs to the lua_State, so the mode is kept in its registry where every hash map sharing it sees the same one. */
+#define LUAHASHMAP_GC_MODE_KEY "LuaHashMap.GCMode"
+
+static LuaHashMapGCMode Internal_GetGCMode(LuaHashMap* hash_map)
+{
+	LuaHashMapGCMode gc_mode;
+	lua_getfield(hash_map->luaState, LUA_REGISTRYINDEX, LUAHASHMAP_GC_MODE_KEY); /* stack: [gc_mode] */
+	if(LUA_TNUMBER == lua_type(hash_map->luaState, -1))
 	{
-		hash_map = (LuaHashMap*)calloc(1, sizeof(LuaHashMap));
-	}	
+		gc_mode = (LuaHashMapGCMode)lua_tointeger(hash_map->luaState, -1);
+	}
 	else
 	{
-		hash_map = (LuaHashMap*)(*original_hash_map->memoryAllocator)(original_hash_map->allocatorUserData, NULL, 0, sizeof(LuaHashMap));
+		gc_mode = LUAHASHMAP_GCMODE_INCREMENTAL;
 	}
-	if(NULL == hash_map)
+	lua_pop(hash_map->luaState, 1); /* stack: [] */
+	return gc_mode;
+}
+
+/* In Lua 5.1, any explicit collection (full or step) resets the GC threshold which silently restarts a stopped collector.
+ * So after we invoke the collector ourselves, we must stop it again if the user asked for it to be stopped.
+ * Lua 5.2+ has an explicit running flag which explicit collections don't touch.
+ */
+static void Internal_ReapplyStoppedGCMode(LuaHashMap* hash_map)
+{
+#if LUA_VERSION_NUM <= 501
+	if(LUAHASHMAP_GCMODE_STOPPED == Internal_GetGCMode(hash_map))
 	{
-		return NULL;
+		lua_gc(hash_map->luaState, LUA_GCSTOP, 0);
 	}
-	memset(hash_map, 0, sizeof(LuaHashMap));
-
-	hash_map->luaState = original_hash_map->luaState;
-	hash_map->memoryAllocator = original_hash_map->memoryAllocator;
-	hash_map->allocatorUserData = original_hash_map->allocatorUserData;
-
-	Internal_InitializeInternalTables(hash_map);
-
-	return hash_map;
+#else
+	(void)hash_map;
+#endif
 }
 
+#if LUA_VERSION_NUM < 503
+/* Every integer with a magnitude below 2^53 fits in the mantissa of a double. 
+ * Anything at or beyond that may silently collide with a neighbor when pushed as a lua_Number.
+ */
+static LUAHASHMAP_INLINE bool Internal_IsIntegerExactAsNumber(lua_Integer the_integer)
+{
+	lua_Number the_number = (lua_Number)the_integer;
+	return (the_number < 9007199254740992.0) && (the_number > -9007199254740992.0);
+}
+#endif
 
-LuaHashMap* LuaHashMap_CreateShareWithSizeHints(LuaHashMap* original_hash_map, int number_of_array_elements, int number_of_hash_elements)
+/* Replacement for lua_pushinteger for all integer keys and values.
+ * Lua 5.3+ has a native integer subtype so this is just lua_pushinteger.
+ * Before 5.3, in exact integer mode, integers that would lose precision as a lua_Number are pushed as light userdata
+ * so distinct 64-bit integers remain distinct keys. Small integers are still pushed as numbers so the common case is unchanged.
+ */
+static LUAHASHMAP_INLINE void Internal_PushInteger(LuaHashMap* hash_map, lua_Integer the_integer)
 {
-	LuaHashMap* hash_map;
-	if(NULL == original_hash_map)
-	{
-		return NULL;
-	}
-	if(NULL == original_hash_map->memoryAllocator)
-	{
-		hash_map = (LuaHashMap*)malloc(sizeof(LuaHashMap));
-	}	
-	else
-	{
-		hash_map = (LuaHashMap*)(*original_hash_map->memoryAllocator)(original_hash_map->allocatorUserData, NULL, 0, sizeof(LuaHashMap));
-	}
-	if(NULL == hash_map)
+#if LUA_VERSION_NUM < 503
+	if(true == hash_map->useExactIntegers && false == Internal_IsIntegerExactAsNumber(the_integer))
 	{
-		return NULL;
+		lua_pushlightuserdata(hash_map->luaState, (void*)(ptrdiff_t)the_integer);
+		return;
 	}
-	memset(hash_map, 0, sizeof(LuaHashMap));
-
-	hash_map->luaState = original_hash_map->luaState;
-	hash_map->memoryAllocator = original_hash_map->memoryAllocator;
-	hash_map->allocatorUserData = original_hash_map->allocatorUserData;
-
-	lua_createtable(hash_map->luaState, number_of_array_elements, number_of_hash_elements);	
-	hash_map->uniqueTableNameForSharedState = Internal_NewGlobalLuaRef(hash_map->luaState);
-
-	return hash_map;
+#endif
+	lua_pushinteger(hash_map->luaState, the_integer);
 }
 
-
-LuaHashMap* LuaHashMap_CreateShareFromLuaState(lua_State* lua_state)
+/* Replacement for lua_tointeger for all integer keys and values. Undoes Internal_PushInteger. */
+static LUAHASHMAP_INLINE lua_Integer Internal_ToInteger(LuaHashMap* hash_map, int stack_index)
 {
-	LuaHashMap* hash_map;
-	if(NULL == lua_state)
+#if LUA_VERSION_NUM < 503
+	if(true == hash_map->useExactIntegers && LUA_TLIGHTUSERDATA == lua_type(hash_map->luaState, stack_index))
 	{
-		return NULL;
+		return (lua_Integer)(ptrdiff_t)lua_touserdata(hash_map->luaState, stack_index);
 	}
-	hash_map = (LuaHashMap*)calloc(1, sizeof(LuaHashMap));
-	if(NULL == hash_map)
+#endif
+	return lua_tointeger(hash_map->luaState, stack_index);
+}
+
+/* Copies the key or value at stack_index into an iterator slot and returns the type to record for it.
+ * Numbers that are integers (the Lua 5.3+ integer subtype, or an exact integer mode light userdata before 5.3)
+ * are kept in theInteger so they never round trip through a lua_Number.
+ * lua_state is normally hash_map->luaState, but may be a thread of it (see LuaHashMapCursor).
+ */
+static int Internal_ToKeyValueTypeInState(LuaHashMap* hash_map, lua_State* lua_state, int stack_index, union LuaHashMapKeyValueType* key_value, bool* is_integer)
+{
+	int the_type = lua_type(lua_state, stack_index);
+	*is_integer = false;
+	switch(the_type)
 	{
-		return NULL;
+		case LUA_TSTRING:
+		{
+			key_value->theString.stringPointer = lua_tolstring(lua_state, stack_index, &key_value->theString.stringLength);
+			break;
+		}
+		case LUA_TLIGHTUSERDATA:
+		{
+#if LUA_VERSION_NUM < 503
+			if(true == hash_map->useExactIntegers)
+			{
+				key_value->theInteger = (lua_Integer)(ptrdiff_t)lua_touserdata(lua_state, stack_index);
+				*is_integer = true;
+				return LUA_TNUMBER;
+			}
+#else
+			(void)hash_map;
+#endif
+			key_value->thePointer = lua_touserdata(lua_state, stack_index);
+			break;
+		}
+		case LUA_TUSERDATA:
+		{
+			key_value->thePointer = lua_touserdata(lua_state, stack_index);
+			break;
+		}
+		case LUA_TNUMBER:
+		{
+#if LUA_VERSION_NUM >= 503
+			if(lua_isinteger(lua_state, stack_index))
+			{
+				key_value->theInteger = lua_tointeger(lua_state, stack_index);
+				*is_integer = true;
+				break;
+			}
+#endif
+			key_value->theNumber = lua_tonumber(lua_state, stack_index);
+			break;
+		}
+		default:
+		{
+			/* Clear the largest field to make sure every thing is cleared. */
+			memset(key_value, 0, sizeof(union LuaHashMapKeyValueType));
+		}
 	}
-
-	hash_map->luaState = lua_state;
-	
-	Internal_InitializeInternalTables(hash_map);
-
-	return hash_map;
+	return the_type;
 }
 
+static LUAHASHMAP_INLINE int Internal_ToKeyValueType(LuaHashMap* hash_map, int stack_index, union LuaHashMapKeyValueType* key_value, bool* is_integer)
+{
+	return Internal_ToKeyValueTypeInState(hash_map, hash_map->luaState, stack_index, key_value, is_integer);
+}
 
-LuaHashMap* LuaHashMap_CreateShareFromLuaStateWithAllocatorAndSizeHints(lua_State* lua_state, lua_Alloc the_allocator, void* user_data, int number_of_array_elements, int number_of_hash_elements)
+/* Pushes a LUA_TNUMBER key or value saved by Internal_ToKeyValueType back on the stack. */
+static LUAHASHMAP_INLINE void Internal_PushKeyValueNumber(LuaHashMap* hash_map, const union LuaHashMapKeyValueType* key_value, bool is_integer)
 {
-	LuaHashMap* hash_map;
-	if(NULL == lua_state)
+	if(true == is_integer)
 	{
-		return NULL;
+		Internal_PushInteger(hash_map, key_value->theInteger);
 	}
-	if(NULL == the_allocator)
-	{
-		hash_map = (LuaHashMap*)malloc(sizeof(LuaHashMap));
-	}	
 	else
 	{
-		hash_map = (LuaHashMap*)(*the_allocator)(user_data, NULL, 0, sizeof(LuaHashMap));
-	}
-	if(NULL == hash_map)
-	{
-		return NULL;
+		lua_pushnumber(hash_map->luaState, key_value->theNumber);
 	}
-	memset(hash_map, 0, sizeof(LuaHashMap));
+}
 
-	hash_map->luaState = lua_state;
-	hash_map->memoryAllocator = the_allocator;
-	hash_map->allocatorUserData = user_data;
+/* lua_rawgeti/lua_rawseti take an int before Lua 5.3, so only keys in int range can use them there.
+ * (Those keys are also always exact as a lua_Number so the exact integer mode never applies to them.)
+ */
+#if LUA_VERSION_NUM >= 503
+	typedef lua_Integer LuaHashMap_InternalIndexType;
+#else
+	typedef int LuaHashMap_InternalIndexType;
+#endif
 
-	lua_createtable(hash_map->luaState, number_of_array_elements, number_of_hash_elements);	
-	hash_map->uniqueTableNameForSharedState = Internal_NewGlobalLuaRef(hash_map->luaState);
+/* Lua 5.1/5.2 have no limit macros for lua_Integer (a ptrdiff_t by default), so derive them from its size. */
+#if LUA_VERSION_NUM >= 503
+	#define LUAHASHMAP_INTEGER_MAX LUA_MAXINTEGER
+	#define LUAHASHMAP_INTEGER_MIN LUA_MININTEGER
+#else
+	#define LUAHASHMAP_INTEGER_MAX ((lua_Integer)((((lua_Integer)1 << (sizeof(lua_Integer)*CHAR_BIT - 2)) - 1) * 2 + 1))
+	#define LUAHASHMAP_INTEGER_MIN (-LUAHASHMAP_INTEGER_MAX - 1)
+#endif
 
-	return hash_map;
+static LUAHASHMAP_INLINE bool Internal_IsIntegerKeyIndexable(lua_Integer key_integer)
+{
+#if !defined(LUAHASHMAP_GETTABLEI) || !defined(LUAHASHMAP_SETTABLEI)
+	(void)key_integer;
+	return false;
+#elif LUA_VERSION_NUM >= 503
+	(void)key_integer;
+	return true;
+#else
+	return (key_integer >= INT_MIN) && (key_integer <= INT_MAX);
+#endif
 }
 
-
-LuaHashMap* LuaHashMap_CreateShareFromLuaStateWithSizeHints(lua_State* lua_state, int number_of_array_elements, int number_of_hash_elements)
+/* table[key_integer]. Expects stack: [table] and leaves stack: [value, table]. */
+static LUAHASHMAP_INLINE void Internal_GetTableForKeyInteger(LuaHashMap* hash_map, lua_Integer key_integer)
 {
-	LuaHashMap* hash_map;
-	if(NULL == lua_state)
-	{
-		return NULL;
-	}
-	hash_map = (LuaHashMap*)calloc(1, sizeof(LuaHashMap));
-	if(NULL == hash_map)
+#if defined(LUAHASHMAP_GETTABLEI)
+	if(Internal_IsIntegerKeyIndexable(key_integer))
 	{
-		return NULL;
+		LUAHASHMAP_GETTABLEI(hash_map->luaState, -1, (LuaHashMap_InternalIndexType)key_integer); /* stack: [value, table] */
+		return;
 	}
-	if(NULL == hash_map)
+#endif
+	Internal_PushInteger(hash_map, key_integer); /* stack: [key_integer, table] */
+	LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_integer]; stack: [value, table] */
+}
+
+/* Integer key version of Internal_SetTableAndUpdateCount. Expects stack: [value, table] and leaves stack: [table]. */
+static LUAHASHMAP_INLINE void Internal_SetTableForKeyIntegerAndUpdateCount(LuaHashMap* hash_map, lua_Integer key_integer)
+{
+#if defined(LUAHASHMAP_SETTABLEI)
+	if(Internal_IsIntegerKeyIndexable(key_integer))
 	{
-		return NULL;
+		bool had_value;
+		bool has_value;
+
+		if(true == hash_map->isElementCountStale)
+		{
+			has_value = (LUA_TNIL != lua_type(hash_map->luaState, -1));
+			LUAHASHMAP_SETTABLEI(hash_map->luaState, -2, (LuaHashMap_InternalIndexType)key_integer); /* table[key_integer]=value; stack: [table] */
+			Internal_UpdateStaleCount(hash_map, has_value);
+			return;
+		}
+		LUAHASHMAP_GETTABLEI(hash_map->luaState, -2, (LuaHashMap_InternalIndexType)key_integer); /* stack: [old_value, value, table] */
+		had_value = (LUA_TNIL != lua_type(hash_map->luaState, -1));
+		lua_pop(hash_map->luaState, 1); /* stack: [value, table] */
+		has_value = (LUA_TNIL != lua_type(hash_map->luaState, -1));
+		LUAHASHMAP_SETTABLEI(hash_map->luaState, -2, (LuaHashMap_InternalIndexType)key_integer); /* table[key_integer]=value; stack: [table] */
+
+		Internal_UpdateCount(hash_map, had_value, has_value);
+		return;
 	}
+#endif
+	Internal_PushInteger(hash_map, key_integer); /* stack: [key_integer, value, table] */
+	lua_insert(hash_map->luaState, -2); /* stack: [value, key_integer, table] */
+	Internal_SetTableAndUpdateCount(hash_map);  /* table[key_integer]=value; stack: [table] */
+}
 
-	hash_map->luaState = lua_state;
+static void Internal_InitializeInternalTables(LuaHashMap* hash_map)
+{
+	/* Create a table in Lua to be our hash map */
+	 /* According to Lua Gems performance, Lua tables are created with 0 size by default to not waste memory
+	 * so creating different tables shouldn't be that bad.
+	 * 
+	 * I originally did an experiment to see if integer keys on the global table with 
+	 * rawset/geti was faster than the rawset/get with light userdata keys (which 
+	 * are also effectively integers). (The light userdata keys were static strings.)
+	 * My benchmarks are inconclusive, testing with 10000000 insert/removes.
+	 * They appear to be the same speed, though I've seen large timing variations in
+	 * both tests.
+	 * But in the changes for shared state, I realized luaL_ref basically was what I was doing with 
+	 * integer keys. So I removed all this for a luaL_ref based implementation which is more
+	 * general, but I lose the explicit separate tables for the 4 key types.
+	 * luaL_ref is nice in that is also creates unique table numbers automatically and recycles them as they become free.
+	 */
 	
-	lua_createtable(hash_map->luaState, number_of_array_elements, number_of_hash_elements);	
+	lua_newtable(hash_map->luaState);
+	/* The idea is that every LuaHashMap instance gets a unique reference id so they can share the same lua_State. */
+	/* Even the first/original hash map created gets its own so all hash maps are effectively peers of each other. */
 	hash_map->uniqueTableNameForSharedState = Internal_NewGlobalLuaRef(hash_map->luaState);
-	
-	return hash_map;
 }
 
+const LuaHashMapVersion* LuaHashMap_GetLinkedVersion()
+{
+	static LuaHashMapVersion linked_version;
+	LUAHASHMAP_GET_COMPILED_VERSION(&linked_version);
+	return(&linked_version);
+}
 
+/* Group locking: every public entry point below runs its Internal_Unlocked_ implementation under the group lock (if there is one). 
+ * Lua only touches shared state when it allocates (string interning, table resizes, garbage collection). 
+ * A lookup with a pointer or number key doesn't allocate, so readers can run at the same time as long as 
+ * each one uses its own Lua thread for the stack. Everything else is exclusive and uses the main lua_State.
+ * (Except on 5.4, where lookups write to the table too. See Internal_BeginSharedAccess.)
+ */
+#define LUAHASHMAP_GROUP_LOCK_KEY "LuaHashMap.GroupLock"
+#define LUAHASHMAP_GROUP_LOCK_READER_STATES_KEY "LuaHashMap.GroupLockReaderStates"
 
-
-
-/* This version does not close the Lua state since it is shared */
-void LuaHashMap_FreeShare(LuaHashMap* hash_map)
+/* Returns the group lock if locking is on for hash_map's lua_State, NULL otherwise. */
+static LUAHASHMAP_INLINE struct LuaHashMapGroupLock* Internal_GetEnabledGroupLock(LuaHashMap* hash_map)
 {
-	if(NULL == hash_map)
-	{
-		return;
-	}
-	LUAHASHMAP_GLOBAL_LUA_UNREF(hash_map->luaState, hash_map->uniqueTableNameForSharedState);
-	/* Seems like a good time to force the garbage collector */
-	lua_gc(hash_map->luaState, LUA_GCCOLLECT, 0);
-	if(NULL != hash_map->memoryAllocator)
-	{
-		(*hash_map->memoryAllocator)(hash_map->allocatorUserData, hash_map, sizeof(LuaHashMap), 0);
-	}
-	else
+	if((NULL == hash_map) || (NULL == hash_map->groupLock) || (false == hash_map->groupLock->isEnabled))
 	{
-		free(hash_map);
+		return NULL;
 	}
+	return hash_map->groupLock;
 }
 
-void LuaHashMap_Free(LuaHashMap* hash_map)
+static struct LuaHashMapGroupLock* Internal_LockGroupExclusive(LuaHashMap* hash_map)
 {
-	if(NULL == hash_map)
+	struct LuaHashMapGroupLock* group_lock = Internal_GetEnabledGroupLock(hash_map);
+	bool is_contended = false;
+	if(NULL == group_lock)
 	{
-		return;
+		return NULL;
 	}
-	/* Since we close the lua_State, we don't need to call luaL_unref */
-	/* LUAHASHMAP_GLOBAL_LUA_UNREF(hash_map->luaState, hash_map->uniqueTableNameForSharedState); */
-	lua_close(hash_map->luaState);
-	if(NULL != hash_map->memoryAllocator)
+	if(!LUAHASHMAP_RWLOCK_TRY_LOCK_EXCLUSIVE(&group_lock->readWriteLock))
 	{
-		(*hash_map->memoryAllocator)(hash_map->allocatorUserData, hash_map, sizeof(LuaHashMap), 0);
+		is_contended = true;
+		LUAHASHMAP_RWLOCK_LOCK_EXCLUSIVE(&group_lock->readWriteLock);
 	}
-	else
+	/* We own the lock exclusively so nobody else can be touching the counters. */
+	group_lock->lockStatistics.exclusiveAcquireCount++;
+	if(true == is_contended)
 	{
-		free(hash_map);
+		group_lock->lockStatistics.exclusiveContendedCount++;
 	}
+	return group_lock;
 }
 
-lua_State* LuaHashMap_GetLuaState(LuaHashMap* hash_map)
+/* Takes the lock returned by Internal_LockGroupExclusive because the hash_map may be gone by now (e.g. LuaHashMap_FreeShare). */
+static LUAHASHMAP_INLINE void Internal_UnlockGroupExclusive(struct LuaHashMapGroupLock* group_lock)
 {
-	if(NULL == hash_map)
+	if(NULL != group_lock)
 	{
-		return NULL;
+		LUAHASHMAP_RWLOCK_UNLOCK_EXCLUSIVE(&group_lock->readWriteLock);
 	}
-	return hash_map->luaState;
-}
-
-static const char* Internal_SetValueStringForKeyStringWithLength(LuaHashMap* restrict hash_map, const char* value_string, const char* key_string, size_t value_string_length, size_t key_string_length)
-{
-	const char* internalized_key_string = NULL;
-
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
-	LUAHASHMAP_PUSHLSTRING_AND_ASSIGNINTERNALSTRING(hash_map->luaState, key_string, key_string_length, internalized_key_string); /* stack: [key_string, table] */
-	lua_pushlstring(hash_map->luaState, value_string, value_string_length); /* stack: [value_string, key_string, table] */
-	LUAHASHMAP_SETTABLE(hash_map->luaState, -3);  /* table[key_string]=value_string; stack: [table] */
-	
-	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
-	lua_pop(hash_map->luaState, 1);
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);
-
-	return internalized_key_string;
 }
 
-const char* LuaHashMap_SetValueStringForKeyString(LuaHashMap* restrict hash_map, const char* value_string, const char* key_string)
+/* Returns the hash map to run a read-only, non-allocating operation on. 
+ * That is reader_map_storage (a copy of hash_map that uses a borrowed Lua thread) when we got a shared lock and a free reader state.
+ * If all the reader states are busy, we fall back to the exclusive lock and return hash_map itself.
+ */
+static LuaHashMap* Internal_BeginSharedAccess(LuaHashMap* hash_map, LuaHashMap* reader_map_storage)
 {
-	if(NULL == hash_map)
+	struct LuaHashMapGroupLock* group_lock = Internal_GetEnabledGroupLock(hash_map);
+#if LUA_VERSION_NUM >= 504
+	/* 5.4's luaH_getint updates the table's alimit as a side effect, so even lua_rawgeti on the registry or the map table writes. 
+	 * There are no read-only lookups, so everything is exclusive.
+	 */
+	(void)reader_map_storage;
+	if(NULL != group_lock)
 	{
-		return NULL;
+		Internal_LockGroupExclusive(hash_map);
 	}
-	if(NULL == key_string)
+	return hash_map;
+#else
+	lua_State* reader_state = NULL;
+	bool is_contended = false;
+	if(NULL == group_lock)
 	{
-		return NULL;
+		return hash_map;
 	}
-	if(NULL == value_string)
+	if(!LUAHASHMAP_RWLOCK_TRY_LOCK_SHARED(&group_lock->readWriteLock))
 	{
-		return Internal_SetValueStringForKeyStringWithLength(hash_map, value_string, key_string, 0, strlen(key_string));	
+		is_contended = true;
+		LUAHASHMAP_RWLOCK_LOCK_SHARED(&group_lock->readWriteLock);
+	}
+
+	LUAHASHMAP_MUTEX_LOCK(&group_lock->readerPoolLock);
+	if(group_lock->numberOfFreeReaderStates > 0)
+	{
+		group_lock->numberOfFreeReaderStates--;
+		reader_state = group_lock->readerStatesArray[group_lock->numberOfFreeReaderStates];
+		group_lock->lockStatistics.sharedAcquireCount++;
+		if(true == is_contended)
+		{
+			group_lock->lockStatistics.sharedContendedCount++;
+		}
 	}
 	else
 	{
-		return Internal_SetValueStringForKeyStringWithLength(hash_map, value_string, key_string, strlen(value_string), strlen(key_string));
+		group_lock->lockStatistics.readerStateUnavailableCount++;
+	}
+	LUAHASHMAP_MUTEX_UNLOCK(&group_lock->readerPoolLock);
+
+	if(NULL == reader_state)
+	{
+		/* This counts as an exclusive acquisition only, so the totals add up to the number of calls. */
+		LUAHASHMAP_RWLOCK_UNLOCK_SHARED(&group_lock->readWriteLock);
+		Internal_LockGroupExclusive(hash_map);
+		return hash_map;
 	}
 
+	*reader_map_storage = *hash_map;
+	reader_map_storage->luaState = reader_state;
+	/* An access session pins the table on the main stack, which this thread can't see. Go through the registry. */
+	reader_map_storage->pinnedTableStackIndex = 0;
+	reader_map_storage->pinnedAccessCount = 0;
+	return reader_map_storage;
+#endif
 }
 
-const char* LuaHashMap_SetValueStringForKeyStringWithLength(LuaHashMap* restrict hash_map, const char* value_string, const char* key_string, size_t value_string_length, size_t key_string_length)
+static void Internal_EndSharedAccess(LuaHashMap* hash_map, LuaHashMap* reader_map)
 {
-	if(NULL == hash_map)
+	struct LuaHashMapGroupLock* group_lock = Internal_GetEnabledGroupLock(hash_map);
+	if(NULL == group_lock)
 	{
-		return NULL;
+		return;
 	}
-	if(NULL == key_string)
+	if(reader_map == hash_map)
 	{
-		return NULL;
+		/* We fell back to the exclusive lock */
+		Internal_UnlockGroupExclusive(group_lock);
+		return;
 	}
-	return Internal_SetValueStringForKeyStringWithLength(hash_map, value_string, key_string, value_string_length, key_string_length);	
+	LUAHASHMAP_MUTEX_LOCK(&group_lock->readerPoolLock);
+	group_lock->readerStatesArray[group_lock->numberOfFreeReaderStates] = reader_map->luaState;
+	group_lock->numberOfFreeReaderStates++;
+	LUAHASHMAP_MUTEX_UNLOCK(&group_lock->readerPoolLock);
+	LUAHASHMAP_RWLOCK_UNLOCK_SHARED(&group_lock->readWriteLock);
 }
 
-static const char* Internal_SetValuePointerForKeyStringWithLength(LuaHashMap* hash_map, void* value_pointer, const char* key_string, size_t key_string_length)
+static LUAHASHMAP_INLINE LuaHashMap* Internal_GetHashMapForIterator(const LuaHashMapIterator* hash_iterator)
 {
-	const char* internalized_key_string = NULL;
+	return (NULL == hash_iterator) ? NULL : hash_iterator->hashMap;
+}
 
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
-	LUAHASHMAP_PUSHLSTRING_AND_ASSIGNINTERNALSTRING(hash_map->luaState, key_string, key_string_length, internalized_key_string); /* stack: [key_string, table] */
-	lua_pushlightuserdata(hash_map->luaState, value_pointer); /* stack: [value_pointer, key_string, table] */
-	LUAHASHMAP_SETTABLE(hash_map->luaState, -3);  /* table[key_string]=value_pointer; stack: [table] */
-	
-	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
-	lua_pop(hash_map->luaState, 1);
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);
+static LUAHASHMAP_INLINE LuaHashMap* Internal_GetHashMapForCursor(const LuaHashMapCursor* hash_cursor)
+{
+	return (NULL == hash_cursor) ? NULL : hash_cursor->theIterator.hashMap;
+}
 
-	return internalized_key_string;
+static LUAHASHMAP_INLINE LuaHashMap* Internal_GetHashMapForScan(const LuaHashMapScan* hash_scan)
+{
+	return (NULL == hash_scan) ? NULL : hash_scan->hashMap;
 }
 
-const char* LuaHashMap_SetValuePointerForKeyString(LuaHashMap* hash_map, void* value_pointer, const char* key_string)
+/* The group lock's __gc. It runs when the lua_State is closed, whoever closes it. (The Lua reader threads are collected by Lua itself.) */
+static int Internal_FreeGroupLock(lua_State* lua_state)
 {
-	if(NULL == hash_map)
-	{
-		return NULL;
-	}
-	if(NULL == key_string)
+	struct LuaHashMapGroupLock* group_lock = (struct LuaHashMapGroupLock*)lua_touserdata(lua_state, 1);
+	if((NULL != group_lock) && (true == group_lock->isEnabled))
 	{
-		return NULL;
+		LUAHASHMAP_RWLOCK_DESTROY(&group_lock->readWriteLock);
+		LUAHASHMAP_MUTEX_DESTROY(&group_lock->readerPoolLock);
+		free(group_lock->readerStatesArray);
+		group_lock->isEnabled = false;
 	}
-	return Internal_SetValuePointerForKeyStringWithLength(hash_map, value_pointer, key_string, strlen(key_string));
+	return 0;
 }
 
-const char* LuaHashMap_SetValuePointerForKeyStringWithLength(LuaHashMap* hash_map, void* value_pointer, const char* key_string, size_t key_string_length)
+/* Every hash map on a lua_State (the creator, CreateShare, or CreateShareFromLuaState*) resolves the same group lock through the registry, 
+ * creating it if it is the first. So LuaHashMap_EnableGroupLocking on any of them turns locking on for all of them, including ones created earlier.
+ * The lock is a full userdata rather than a malloc'd block so lua_close frees it even when the caller owns the lua_State.
+ */
+static void Internal_JoinGroup(LuaHashMap* hash_map)
 {
-	if(NULL == hash_map)
+	lua_getfield(hash_map->luaState, LUA_REGISTRYINDEX, LUAHASHMAP_GROUP_LOCK_KEY); /* stack: [group_lock] */
+	if(LUA_TUSERDATA != lua_type(hash_map->luaState, -1))
 	{
-		return NULL;
+		lua_pop(hash_map->luaState, 1); /* stack: [] */
+		memset(lua_newuserdata(hash_map->luaState, sizeof(struct LuaHashMapGroupLock)), 0, sizeof(struct LuaHashMapGroupLock)); /* stack: [group_lock] */
+		lua_newtable(hash_map->luaState); /* stack: [metatable, group_lock] */
+		lua_pushcfunction(hash_map->luaState, Internal_FreeGroupLock); /* stack: [gc_function, metatable, group_lock] */
+		lua_setfield(hash_map->luaState, -2, "__gc"); /* stack: [metatable, group_lock] */
+		lua_setmetatable(hash_map->luaState, -2); /* stack: [group_lock] */
+		lua_pushvalue(hash_map->luaState, -1); /* stack: [group_lock, group_lock] */
+		lua_setfield(hash_map->luaState, LUA_REGISTRYINDEX, LUAHASHMAP_GROUP_LOCK_KEY); /* stack: [group_lock] */
 	}
-	if(NULL == key_string)
+	hash_map->groupLock = (struct LuaHashMapGroupLock*)lua_touserdata(hash_map->luaState, -1);
+	lua_pop(hash_map->luaState, 1);
+}
+
+/* Drops one reference. Whoever drops the last one frees the snapshot, on whatever thread that is. */
+static void Internal_ReleaseSnapshot(struct LuaHashMapSnapshot* hash_snapshot)
+{
+	if(0 == Internal_AtomicAddLong(&hash_snapshot->referenceCount, -1))
 	{
-		return NULL;
+		free(hash_snapshot);
 	}
-	return Internal_SetValuePointerForKeyStringWithLength(hash_map, value_pointer, key_string, key_string_length);
 }
 
-static const char* Internal_SetValueNumberForKeyStringWithLength(LuaHashMap* restrict hash_map, lua_Number value_number, const char* restrict key_string, size_t key_string_length)
+/* Publishes new_snapshot (which may be NULL) and drops the hash map's reference to the one it replaces.
+ * The hard part is a reader that has loaded the old pointer but not yet taken its reference. 
+ * Readers are only counted in snapshotReaderCounts for those few instructions, in the slot of the epoch they started in. 
+ * So after moving to the next epoch, once the old epoch's count drains to zero, nobody can still be picking up the old snapshot.
+ * Readers that already took a reference keep it alive until they release it.
+ */
+static void Internal_ReplacePublishedSnapshot(LuaHashMap* hash_map, struct LuaHashMapSnapshot* new_snapshot)
 {
-	const char* internalized_key_string = NULL;
-	
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
-	LUAHASHMAP_PUSHLSTRING_AND_ASSIGNINTERNALSTRING(hash_map->luaState, key_string, key_string_length, internalized_key_string); /* stack: [key_string, table] */
-	lua_pushnumber(hash_map->luaState, value_number); /* stack: [value_number, key_string, table] */
-	LUAHASHMAP_SETTABLE(hash_map->luaState, -3);  /* table[key_string]=value_number; stack: [table] */
-	
-	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
-	lua_pop(hash_map->luaState, 1);
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);	
-
-	return internalized_key_string;
+	struct LuaHashMapSnapshot* old_snapshot = (struct LuaHashMapSnapshot*)Internal_AtomicExchangePointer(&hash_map->publishedSnapshot, new_snapshot);
+	long old_epoch = Internal_AtomicAddLong(&hash_map->snapshotEpoch, 1) - 1;
+	while(0 != Internal_AtomicLoadLong(&hash_map->snapshotReaderCounts[old_epoch & 1]))
+	{
+		LUAHASHMAP_THREAD_YIELD();
+	}
+	if(NULL != old_snapshot)
+	{
+		Internal_ReleaseSnapshot(old_snapshot);
+	}
 }
 
-const char* LuaHashMap_SetValueNumberForKeyString(LuaHashMap* restrict hash_map, lua_Number value_number, const char* restrict key_string)
+
+LuaHashMap* LuaHashMap_Create()
 {
-	if(NULL == hash_map)
+	LuaHashMap* hash_map;
+	lua_State* lua_state = luaL_newstate();
+	if(NULL == lua_state)
 	{
 		return NULL;
 	}
-	if(NULL == key_string)
+	hash_map = (LuaHashMap*)calloc(1, sizeof(LuaHashMap));
+	if(NULL == hash_map)
 	{
+		lua_close(lua_state);
 		return NULL;
 	}
-	return Internal_SetValueNumberForKeyStringWithLength(hash_map, value_number, key_string, strlen(key_string));
+	hash_map->luaState = lua_state;
+	Internal_JoinGroup(hash_map);
+
+	Internal_InitializeInternalTables(hash_map);
+
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return hash_map;
 }
 
-const char* LuaHashMap_SetValueNumberForKeyStringWithLength(LuaHashMap* restrict hash_map, lua_Number value_number, const char* restrict key_string, size_t key_string_length)
+LuaHashMap* LuaHashMap_CreateWithAllocator(lua_Alloc the_allocator, void* user_data)
 {
-	if(NULL == hash_map)
+	LuaHashMap* hash_map;
+	lua_State* lua_state = lua_newstate(the_allocator, user_data);
+	if(NULL == lua_state)
 	{
 		return NULL;
 	}
-	if(NULL == key_string)
+
+	hash_map = (LuaHashMap*)(*the_allocator)(user_data, NULL, 0, sizeof(LuaHashMap));
+	if(NULL == hash_map)
 	{
+		lua_close(lua_state);
 		return NULL;
 	}
-	return Internal_SetValueNumberForKeyStringWithLength(hash_map, value_number, key_string, key_string_length);
-}
-
-static const char* Internal_SetValueIntegerForKeyStringWithLength(LuaHashMap* restrict hash_map, lua_Integer value_integer, const char* restrict key_string, size_t key_string_length)
-{
-	const char* internalized_key_string = NULL;
-	
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
-	LUAHASHMAP_PUSHLSTRING_AND_ASSIGNINTERNALSTRING(hash_map->luaState, key_string, key_string_length, internalized_key_string); /* stack: [key_string, table] */
-	lua_pushinteger(hash_map->luaState, value_integer); /* stack: [value_integer, key_string, table] */
-	LUAHASHMAP_SETTABLE(hash_map->luaState, -3);  /* table[key_string]=value_integer; stack: [table] */
+	memset(hash_map, 0, sizeof(LuaHashMap));
 
-	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
-	lua_pop(hash_map->luaState, 1);
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);	
+	hash_map->luaState = lua_state;
+	Internal_JoinGroup(hash_map);
+	hash_map->memoryAllocator = the_allocator;
+	hash_map->allocatorUserData = user_data;
 
-	return internalized_key_string;
+	Internal_InitializeInternalTables(hash_map);
+	
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return hash_map;
 }
 
 
-const char* LuaHashMap_SetValueIntegerForKeyString(LuaHashMap* restrict hash_map, lua_Integer value_integer, const char* restrict key_string)
+LuaHashMap* LuaHashMap_CreateWithSizeHints(int number_of_array_elements, int number_of_hash_elements)
 {
-	if(NULL == hash_map)
+	LuaHashMap* hash_map;
+	lua_State* lua_state = luaL_newstate();
+	if(NULL == lua_state)
 	{
 		return NULL;
 	}
-	if(NULL == key_string)
+	hash_map = (LuaHashMap*)calloc(1, sizeof(LuaHashMap));
+	if(NULL == hash_map)
 	{
+		lua_close(lua_state);
 		return NULL;
 	}
-	return Internal_SetValueIntegerForKeyStringWithLength(hash_map, value_integer, key_string, strlen(key_string));
+	hash_map->luaState = lua_state;
+	Internal_JoinGroup(hash_map);
+
+	lua_createtable(hash_map->luaState, number_of_array_elements, number_of_hash_elements);	
+	if(number_of_hash_elements > 0)
+	{
+		hash_map->hashCapacityHint = (size_t)number_of_hash_elements;
+	}
+	if(number_of_array_elements > 0)
+	{
+		hash_map->arrayCapacityHint = (size_t)number_of_array_elements;
+	}
+	hash_map->uniqueTableNameForSharedState = Internal_NewGlobalLuaRef(hash_map->luaState);
+
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return hash_map;
 }
 
-const char* LuaHashMap_SetValueIntegerForKeyStringWithLength(LuaHashMap* restrict hash_map, lua_Integer value_integer, const char* restrict key_string, size_t key_string_length)
+
+LuaHashMap* LuaHashMap_CreateWithAllocatorAndSizeHints(lua_Alloc the_allocator, void* user_data, int number_of_array_elements, int number_of_hash_elements)
 {
-	if(NULL == hash_map)
+	LuaHashMap* hash_map;
+	lua_State* lua_state = lua_newstate(the_allocator, user_data);
+	if(NULL == lua_state)
 	{
 		return NULL;
 	}
-	if(NULL == key_string)
+
+	hash_map = (LuaHashMap*)(*the_allocator)(user_data, NULL, 0, sizeof(LuaHashMap));
+	if(NULL == hash_map)
 	{
+		lua_close(lua_state);
 		return NULL;
 	}
-	return Internal_SetValueIntegerForKeyStringWithLength(hash_map, value_integer, key_string, key_string_length);
-}
+	memset(hash_map, 0, sizeof(LuaHashMap));
+
+	hash_map->luaState = lua_state;
+	Internal_JoinGroup(hash_map);
+	hash_map->memoryAllocator = the_allocator;
+	hash_map->allocatorUserData = user_data;
+
+	lua_createtable(hash_map->luaState, number_of_array_elements, number_of_hash_elements);	
+	if(number_of_hash_elements > 0)
+	{
+		hash_map->hashCapacityHint = (size_t)number_of_hash_elements;
+	}
+	if(number_of_array_elements > 0)
+	{
+		hash_map->arrayCapacityHint = (size_t)number_of_array_elements;
+	}
+	hash_map->uniqueTableNameForSharedState = Internal_NewGlobalLuaRef(hash_map->luaState);
 
-static void Internal_SetValueStringForKeyPointerWithLength(LuaHashMap* hash_map, const char* value_string, void* key_pointer, size_t value_string_length)
-{
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
-	lua_pushlightuserdata(hash_map->luaState, key_pointer); /* stack: [key_pointer, table] */
-	lua_pushlstring(hash_map->luaState, value_string, value_string_length); /* stack: [value_string, key_pointer, table] */
-	LUAHASHMAP_SETTABLE(hash_map->luaState, -3);  /* table[key_pointer]=value_string; stack: [table] */
 	
-	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
-	lua_pop(hash_map->luaState, 1);
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return hash_map;
 }
 
-void LuaHashMap_SetValuePointerForKeyPointer(LuaHashMap* hash_map, void* value_pointer, void* key_pointer)
+
+static LuaHashMap* Internal_Unlocked_CreateShare(LuaHashMap* original_hash_map)
 {
+	LuaHashMap* hash_map;
+	if(NULL == original_hash_map)
+	{
+		return NULL;
+	}
+	if(NULL == original_hash_map->memoryAllocator)
+	{
+		hash_map = (LuaHashMap*)calloc(1, sizeof(LuaHashMap));
+	}	
+	else
+	{
+		hash_map = (LuaHashMap*)(*original_hash_map->memoryAllocator)(original_hash_map->allocatorUserData, NULL, 0, sizeof(LuaHashMap));
+	}
 	if(NULL == hash_map)
 	{
-		return;
+		return NULL;
 	}
+	memset(hash_map, 0, sizeof(LuaHashMap));
 
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
-	lua_pushlightuserdata(hash_map->luaState, key_pointer); /* stack: [key_pointer, table] */
-	lua_pushlightuserdata(hash_map->luaState, value_pointer); /* stack: [value_pointer, key_pointer, table] */
-	LUAHASHMAP_SETTABLE(hash_map->luaState, -3);  /* table[key_pointer]=value_pointer; stack: [table] */
+	hash_map->luaState = original_hash_map->luaState;
+	hash_map->memoryAllocator = original_hash_map->memoryAllocator;
+	hash_map->allocatorUserData = original_hash_map->allocatorUserData;
+	hash_map->groupLock = original_hash_map->groupLock;
 
-	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
-	lua_pop(hash_map->luaState, 1);
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);
+	Internal_InitializeInternalTables(hash_map);
+
+	return hash_map;
 }
 
-void LuaHashMap_SetValueStringForKeyPointer(LuaHashMap* hash_map, const char* value_string, void* key_pointer)
+
+static LuaHashMap* Internal_Unlocked_CreateShareWithSizeHints(LuaHashMap* original_hash_map, int number_of_array_elements, int number_of_hash_elements)
 {
-	if(NULL == hash_map)
+	LuaHashMap* hash_map;
+	if(NULL == original_hash_map)
 	{
-		return;
+		return NULL;
 	}
-	if(NULL == value_string)
+	if(NULL == original_hash_map->memoryAllocator)
 	{
-		Internal_SetValueStringForKeyPointerWithLength(hash_map, value_string, key_pointer, 0);
-	}
+		hash_map = (LuaHashMap*)malloc(sizeof(LuaHashMap));
+	}	
 	else
 	{
-		Internal_SetValueStringForKeyPointerWithLength(hash_map, value_string, key_pointer, strlen(value_string));
+		hash_map = (LuaHashMap*)(*original_hash_map->memoryAllocator)(original_hash_map->allocatorUserData, NULL, 0, sizeof(LuaHashMap));
 	}
-}
-
-void LuaHashMap_SetValueStringForKeyPointerWithLength(LuaHashMap* hash_map, const char* value_string, void* key_pointer, size_t value_string_length)
-{
 	if(NULL == hash_map)
 	{
-		return;
+		return NULL;
 	}
-	Internal_SetValueStringForKeyPointerWithLength(hash_map, value_string, key_pointer, value_string_length);
+	memset(hash_map, 0, sizeof(LuaHashMap));
 
-}
+	hash_map->luaState = original_hash_map->luaState;
+	hash_map->memoryAllocator = original_hash_map->memoryAllocator;
+	hash_map->allocatorUserData = original_hash_map->allocatorUserData;
+	hash_map->groupLock = original_hash_map->groupLock;
 
-void LuaHashMap_SetValueNumberForKeyPointer(LuaHashMap* hash_map, lua_Number value_number, void* key_pointer)
-{
-	if(NULL == hash_map)
+	lua_createtable(hash_map->luaState, number_of_array_elements, number_of_hash_elements);	
+	if(number_of_hash_elements > 0)
 	{
-		return;
+		hash_map->hashCapacityHint = (size_t)number_of_hash_elements;
 	}
-	
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
-	lua_pushlightuserdata(hash_map->luaState, key_pointer); /* stack: [key_pointer, table] */
-	lua_pushnumber(hash_map->luaState, value_number); /* stack: [value_number, key_pointer, table] */
-	LUAHASHMAP_SETTABLE(hash_map->luaState, -3);  /* table[key_pointer]=value_number; stack: [table] */
-	
-	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
-	lua_pop(hash_map->luaState, 1);
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);
+	if(number_of_array_elements > 0)
+	{
+		hash_map->arrayCapacityHint = (size_t)number_of_array_elements;
+	}
+	hash_map->uniqueTableNameForSharedState = Internal_NewGlobalLuaRef(hash_map->luaState);
+
+	return hash_map;
 }
 
-void LuaHashMap_SetValueIntegerForKeyPointer(LuaHashMap* hash_map, lua_Integer value_integer, void* key_pointer)
+
+LuaHashMap* LuaHashMap_CreateShareFromLuaState(lua_State* lua_state)
 {
+	LuaHashMap* hash_map;
+	if(NULL == lua_state)
+	{
+		return NULL;
+	}
+	hash_map = (LuaHashMap*)calloc(1, sizeof(LuaHashMap));
 	if(NULL == hash_map)
 	{
-		return;
+		return NULL;
 	}
-	
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
-	lua_pushlightuserdata(hash_map->luaState, key_pointer); /* stack: [key_pointer, table] */
-	lua_pushinteger(hash_map->luaState, value_integer); /* stack: [value_integer, key_pointer, table] */
-	LUAHASHMAP_SETTABLE(hash_map->luaState, -3);  /* table[key_pointer]=value_integer; stack: [table] */
-	
-	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
-	lua_pop(hash_map->luaState, 1);
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);
-}
 
-static void Internal_SetValueStringForKeyNumberWithLength(LuaHashMap* restrict hash_map, const char* restrict value_string, lua_Number key_number, size_t value_string_length)
-{
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
-	lua_pushnumber(hash_map->luaState, key_number); /* stack: [key_number, table] */
-	lua_pushlstring(hash_map->luaState, value_string, value_string_length); /* stack: [value_string, key_number, table] */
-	LUAHASHMAP_SETTABLE(hash_map->luaState, -3);  /* table[key_number]=value_string; stack: [table] */
+	hash_map->luaState = lua_state;
+	Internal_JoinGroup(hash_map);
 	
-	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
-	lua_pop(hash_map->luaState, 1);
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);
+	Internal_InitializeInternalTables(hash_map);
+
+	return hash_map;
 }
 
-void LuaHashMap_SetValueStringForKeyNumber(LuaHashMap* restrict hash_map, const char* restrict value_string, lua_Number key_number)
+
+LuaHashMap* LuaHashMap_CreateShareFromLuaStateWithAllocatorAndSizeHints(lua_State* lua_state, lua_Alloc the_allocator, void* user_data, int number_of_array_elements, int number_of_hash_elements)
 {
-	if(NULL == hash_map)
+	LuaHashMap* hash_map;
+	if(NULL == lua_state)
 	{
-		return;
+		return NULL;
 	}
-	if(NULL == value_string)
+	if(NULL == the_allocator)
 	{
-		Internal_SetValueStringForKeyNumberWithLength(hash_map, value_string, key_number, 0);
-	}
+		hash_map = (LuaHashMap*)malloc(sizeof(LuaHashMap));
+	}	
 	else
 	{
-		Internal_SetValueStringForKeyNumberWithLength(hash_map, value_string, key_number, strlen(value_string));
+		hash_map = (LuaHashMap*)(*the_allocator)(user_data, NULL, 0, sizeof(LuaHashMap));
 	}
-}
-
-void LuaHashMap_SetValueStringForKeyNumberWithLength(LuaHashMap* restrict hash_map, const char* restrict value_string, lua_Number key_number, size_t value_string_length)
-{
 	if(NULL == hash_map)
 	{
-		return;
+		return NULL;
 	}
-	Internal_SetValueStringForKeyNumberWithLength(hash_map, value_string, key_number, value_string_length);
-}
+	memset(hash_map, 0, sizeof(LuaHashMap));
 
-void LuaHashMap_SetValuePointerForKeyNumber(LuaHashMap* hash_map, void* value_pointer, lua_Number key_number)
-{
-	if(NULL == hash_map)
+	hash_map->luaState = lua_state;
+	hash_map->memoryAllocator = the_allocator;
+	hash_map->allocatorUserData = user_data;
+	Internal_JoinGroup(hash_map);
+
+	lua_createtable(hash_map->luaState, number_of_array_elements, number_of_hash_elements);	
+	if(number_of_hash_elements > 0)
 	{
-		return;
+		hash_map->hashCapacityHint = (size_t)number_of_hash_elements;
 	}
-	
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
-	lua_pushnumber(hash_map->luaState, key_number); /* stack: [key_number, table] */
-	lua_pushlightuserdata(hash_map->luaState, value_pointer); /* stack: [value_pointer, key_number, table] */
-	LUAHASHMAP_SETTABLE(hash_map->luaState, -3);  /* table[key_number]=value_pointer; stack: [table] */
-	
-	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
-	lua_pop(hash_map->luaState, 1);
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);
+	if(number_of_array_elements > 0)
+	{
+		hash_map->arrayCapacityHint = (size_t)number_of_array_elements;
+	}
+	hash_map->uniqueTableNameForSharedState = Internal_NewGlobalLuaRef(hash_map->luaState);
+
+	return hash_map;
 }
 
 
-void LuaHashMap_SetValueNumberForKeyNumber(LuaHashMap* hash_map, lua_Number value_number, lua_Number key_number)
+LuaHashMap* LuaHashMap_CreateShareFromLuaStateWithSizeHints(lua_State* lua_state, int number_of_array_elements, int number_of_hash_elements)
 {
+	LuaHashMap* hash_map;
+	if(NULL == lua_state)
+	{
+		return NULL;
+	}
+	hash_map = (LuaHashMap*)calloc(1, sizeof(LuaHashMap));
 	if(NULL == hash_map)
 	{
-		return;
+		return NULL;
 	}
-	
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
-	lua_pushnumber(hash_map->luaState, key_number); /* stack: [key_number, table] */
-	lua_pushnumber(hash_map->luaState, value_number); /* stack: [value_number, key_number, table] */
-	LUAHASHMAP_SETTABLE(hash_map->luaState, -3);  /* table[key_number]=value_number; stack: [table] */
-	
-	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
-	lua_pop(hash_map->luaState, 1);
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);
-}
-
-void LuaHashMap_SetValueIntegerForKeyNumber(LuaHashMap* hash_map, lua_Integer value_integer, lua_Number key_number)
-{
 	if(NULL == hash_map)
 	{
-		return;
+		return NULL;
 	}
+
+	hash_map->luaState = lua_state;
+	Internal_JoinGroup(hash_map);
 	
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
-	lua_pushnumber(hash_map->luaState, key_number); /* stack: [key_number, table] */
-	lua_pushinteger(hash_map->luaState, value_integer); /* stack: [value_integer, key_number, table] */
-	LUAHASHMAP_SETTABLE(hash_map->luaState, -3);  /* table[key_number]=value_integer; stack: [table] */
+	lua_createtable(hash_map->luaState, number_of_array_elements, number_of_hash_elements);	
+	if(number_of_hash_elements > 0)
+	{
+		hash_map->hashCapacityHint = (size_t)number_of_hash_elements;
+	}
+	if(number_of_array_elements > 0)
+	{
+		hash_map->arrayCapacityHint = (size_t)number_of_array_elements;
+	}
+	hash_map->uniqueTableNameForSharedState = Internal_NewGlobalLuaRef(hash_map->luaState);
 	
-	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
-	lua_pop(hash_map->luaState, 1);
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);
+	return hash_map;
 }
 
-static void Internal_SetValueStringForKeyIntegerWithLength(LuaHashMap* restrict hash_map, const char* restrict value_string, lua_Integer key_integer, size_t value_string_length)
+
+
+
+
+/* Defined with the Eval family below. */
+static void Internal_SetEvalResult(LuaHashMap* hash_map);
+
+/* This version does not close the Lua state since it is shared */
+static void Internal_Unlocked_FreeShare(LuaHashMap* hash_map)
 {
 	if(NULL == hash_map)
 	{
 		return;
 	}
-	
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
-	lua_pushinteger(hash_map->luaState, key_integer); /* stack: [key_integer, table] */
-	lua_pushlstring(hash_map->luaState, value_string, value_string_length); /* stack: [value_string, key_integer, table] */
-	LUAHASHMAP_SETTABLE(hash_map->luaState, -3);  /* table[key_integer]=value_string; stack: [table] */
-	
-	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	/* If the user forgot to end an access session, don't leave the table stranded on the shared stack. */
+	if(0 != hash_map->pinnedTableStackIndex)
+	{
+		Internal_UnpinTable(hash_map);
+		hash_map->pinnedAccessCount = 0;
+	}
+	/* Readers still holding a snapshot keep it. They just can't acquire new ones. */
+	if(NULL != hash_map->publishedSnapshot)
+	{
+		Internal_ReplacePublishedSnapshot(hash_map, NULL);
+	}
+	LUAHASHMAP_GLOBAL_LUA_UNREF(hash_map->luaState, hash_map->uniqueTableNameForSharedState);
+	/* Release our LuaHashMap_Eval result. It is keyed by our address, which the next hash map may reuse. */
+	lua_pushnil(hash_map->luaState);
+	Internal_SetEvalResult(hash_map);
 	lua_pop(hash_map->luaState, 1);
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);
+	/* Seems like a good time to force the garbage collector */
+	lua_gc(hash_map->luaState, LUA_GCCOLLECT, 0);
+	Internal_ReapplyStoppedGCMode(hash_map);
+	if(NULL != hash_map->memoryAllocator)
+	{
+		(*hash_map->memoryAllocator)(hash_map->allocatorUserData, hash_map, sizeof(LuaHashMap), 0);
+	}
+	else
+	{
+		free(hash_map);
+	}
 }
 
-void LuaHashMap_SetValueStringForKeyInteger(LuaHashMap* restrict hash_map, const char* restrict value_string, lua_Integer key_integer)
+void LuaHashMap_Free(LuaHashMap* hash_map)
 {
 	if(NULL == hash_map)
 	{
 		return;
 	}
-	if(NULL == value_string)
+	/* Readers still holding a snapshot keep it. They just can't acquire new ones. */
+	if(NULL != hash_map->publishedSnapshot)
 	{
-		Internal_SetValueStringForKeyIntegerWithLength(hash_map, value_string, key_integer, 0);
+		Internal_ReplacePublishedSnapshot(hash_map, NULL);
+	}
+	/* Since we close the lua_State, we don't need to call luaL_unref */
+	/* LUAHASHMAP_GLOBAL_LUA_UNREF(hash_map->luaState, hash_map->uniqueTableNameForSharedState); */
+	/* The group lock belongs to the lua_State, so it goes with it (see Internal_FreeGroupLock). */
+	lua_close(hash_map->luaState);
+	if(NULL != hash_map->memoryAllocator)
+	{
+		(*hash_map->memoryAllocator)(hash_map->allocatorUserData, hash_map, sizeof(LuaHashMap), 0);
 	}
 	else
 	{
-		Internal_SetValueStringForKeyIntegerWithLength(hash_map, value_string, key_integer, strlen(value_string));
+		free(hash_map);
 	}
 }
 
-void LuaHashMap_SetValueStringForKeyIntegerWithLength(LuaHashMap* restrict hash_map, const char* restrict value_string, lua_Integer key_integer, size_t value_string_length)
+lua_State* LuaHashMap_GetLuaState(LuaHashMap* hash_map)
 {
 	if(NULL == hash_map)
 	{
-		return;
+		return NULL;
 	}
-	Internal_SetValueStringForKeyIntegerWithLength(hash_map, value_string, key_integer, value_string_length);
+	return hash_map->luaState;
 }
 
-void LuaHashMap_SetValuePointerForKeyInteger(LuaHashMap* hash_map, void* value_pointer, lua_Integer key_integer)
+static void Internal_Unlocked_BeginAccess(LuaHashMap* hash_map)
 {
 	if(NULL == hash_map)
 	{
 		return;
 	}
-	
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
-	lua_pushinteger(hash_map->luaState, key_integer); /* stack: [key_integer, table] */
-	lua_pushlightuserdata(hash_map->luaState, value_pointer); /* stack: [value_pointer, key_integer, table] */
-	LUAHASHMAP_SETTABLE(hash_map->luaState, -3);  /* table[key_integer]=value_pointer; stack: [table] */
-	
-	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
-	lua_pop(hash_map->luaState, 1);
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);
+	/* Sessions nest. Only the outermost one actually pushes the table. */
+	if(0 == hash_map->pinnedAccessCount)
+	{
+		LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+		LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+		hash_map->pinnedTableStackIndex = lua_gettop(hash_map->luaState);
+#ifdef LUAHASHMAP_DEBUG
+		Internal_SetPinnedSlotCount(hash_map->luaState, hash_map->pinnedTableStackIndex);
+#endif
+	}
+	hash_map->pinnedAccessCount++;
 }
 
-void LuaHashMap_SetValueNumberForKeyInteger(LuaHashMap* hash_map, lua_Number value_number, lua_Integer key_integer)
+static void Internal_Unlocked_EndAccess(LuaHashMap* hash_map)
 {
 	if(NULL == hash_map)
 	{
 		return;
 	}
-	
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
-	lua_pushinteger(hash_map->luaState, key_integer); /* stack: [key_integer, table] */
-	lua_pushnumber(hash_map->luaState, value_number); /* stack: [value_number, key_integer, table] */
-	LUAHASHMAP_SETTABLE(hash_map->luaState, -3);  /* table[key_integer]=value_number; stack: [table] */
-	
-	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
-	lua_pop(hash_map->luaState, 1);
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);
-}
-
-void LuaHashMap_SetValueIntegerForKeyInteger(LuaHashMap* hash_map, lua_Integer value_integer, lua_Integer key_integer)
-{
-	if(NULL == hash_map)
+	if(0 == hash_map->pinnedAccessCount)
 	{
 		return;
 	}
-	
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
-	lua_pushinteger(hash_map->luaState, key_integer); /* stack: [key_integer, table] */
-	lua_pushinteger(hash_map->luaState, value_integer); /* stack: [value_integer, key_integer, table] */
-	LUAHASHMAP_SETTABLE(hash_map->luaState, -3);  /* table[key_integer]=value_integer; stack: [table] */
-	
-	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
-	lua_pop(hash_map->luaState, 1);
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);
+	hash_map->pinnedAccessCount--;
+	if(0 == hash_map->pinnedAccessCount)
+	{
+		/* Only pinned tables should be left on the stack. */
+		LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+		Internal_UnpinTable(hash_map);
+	}
 }
 
-static const char* Internal_GetValueStringForKeyStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t* value_string_length_return, size_t key_string_length)
+static const char* Internal_SetValueStringForKeyStringWithLength(LuaHashMap* restrict hash_map, const char* value_string, const char* key_string, size_t value_string_length, size_t key_string_length)
 {
-	const char* ret_val;
+	const char* internalized_key_string = NULL;
 
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
-	lua_pushlstring(hash_map->luaState, key_string, key_string_length); /* stack: [key_string, table] */
-	LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_string]; stack: [value_string, table] */
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	LUAHASHMAP_PUSHLSTRING_AND_ASSIGNINTERNALSTRING(hash_map->luaState, key_string, key_string_length, internalized_key_string); /* stack: [key_string, table] */
+	lua_pushlstring(hash_map->luaState, value_string, value_string_length); /* stack: [value_string, key_string, table] */
+	Internal_SetTableAndUpdateCount(hash_map);  /* table[key_string]=value_string; stack: [table] */
 	
-	ret_val = lua_tolstring(hash_map->luaState, -1, value_string_length_return);
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
 
-	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
-	lua_pop(hash_map->luaState, 2);
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);	
-	return ret_val;
+	return internalized_key_string;
 }
 
-const char* LuaHashMap_GetValueStringForKeyString(LuaHashMap* restrict hash_map, const char* restrict key_string)
+static const char* Internal_Unlocked_SetValueStringForKeyString(LuaHashMap* restrict hash_map, const char* value_string, const char* key_string)
 {
 	if(NULL == hash_map)
 	{
@@ -1024,10 +1640,18 @@ const char* LuaHashMap_GetValueStringForKeyString(LuaHashMap* restrict hash_map,
 	{
 		return NULL;
 	}
-	return Internal_GetValueStringForKeyStringWithLength(hash_map, key_string, NULL, strlen(key_string));
+	if(NULL == value_string)
+	{
+		return Internal_SetValueStringForKeyStringWithLength(hash_map, value_string, key_string, 0, strlen(key_string));	
+	}
+	else
+	{
+		return Internal_SetValueStringForKeyStringWithLength(hash_map, value_string, key_string, strlen(value_string), strlen(key_string));
+	}
+
 }
 
-const char* LuaHashMap_GetValueStringForKeyStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t* restrict value_string_length_return, size_t key_string_length)
+static const char* Internal_Unlocked_SetValueStringForKeyStringWithLength(LuaHashMap* restrict hash_map, const char* value_string, const char* key_string, size_t value_string_length, size_t key_string_length)
 {
 	if(NULL == hash_map)
 	{
@@ -1037,26 +1661,26 @@ const char* LuaHashMap_GetValueStringForKeyStringWithLength(LuaHashMap* restrict
 	{
 		return NULL;
 	}
-	return Internal_GetValueStringForKeyStringWithLength(hash_map, key_string, value_string_length_return, key_string_length);
+	return Internal_SetValueStringForKeyStringWithLength(hash_map, value_string, key_string, value_string_length, key_string_length);	
 }
 
-static void* Internal_GetValuePointerForKeyStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length)
+static const char* Internal_SetValuePointerForKeyStringWithLength(LuaHashMap* hash_map, void* value_pointer, const char* key_string, size_t key_string_length)
 {
-	void* ret_val;
-
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
-	lua_pushlstring(hash_map->luaState, key_string, key_string_length); /* stack: [key_string, table] */
-	LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_string]; stack: [value_pointer, table] */
+	const char* internalized_key_string = NULL;
 
-	ret_val = lua_touserdata(hash_map->luaState, -1);
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	LUAHASHMAP_PUSHLSTRING_AND_ASSIGNINTERNALSTRING(hash_map->luaState, key_string, key_string_length, internalized_key_string); /* stack: [key_string, table] */
+	lua_pushlightuserdata(hash_map->luaState, value_pointer); /* stack: [value_pointer, key_string, table] */
+	Internal_SetTableAndUpdateCount(hash_map);  /* table[key_string]=value_pointer; stack: [table] */
+	
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
 
-	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
-	lua_pop(hash_map->luaState, 2);
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);	
-	return ret_val;
+	return internalized_key_string;
 }
 
-void* LuaHashMap_GetValuePointerForKeyString(LuaHashMap* restrict hash_map, const char* restrict key_string)
+static const char* Internal_Unlocked_SetValuePointerForKeyString(LuaHashMap* hash_map, void* value_pointer, const char* key_string)
 {
 	if(NULL == hash_map)
 	{
@@ -1066,10 +1690,10 @@ void* LuaHashMap_GetValuePointerForKeyString(LuaHashMap* restrict hash_map, cons
 	{
 		return NULL;
 	}
-	return Internal_GetValuePointerForKeyStringWithLength(hash_map, key_string, strlen(key_string));
+	return Internal_SetValuePointerForKeyStringWithLength(hash_map, value_pointer, key_string, strlen(key_string));
 }
 
-void* LuaHashMap_GetValuePointerForKeyStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length)
+static const char* Internal_Unlocked_SetValuePointerForKeyStringWithLength(LuaHashMap* hash_map, void* value_pointer, const char* key_string, size_t key_string_length)
 {
 	if(NULL == hash_map)
 	{
@@ -1079,1142 +1703,7318 @@ void* LuaHashMap_GetValuePointerForKeyStringWithLength(LuaHashMap* restrict hash
 	{
 		return NULL;
 	}
-	return Internal_GetValuePointerForKeyStringWithLength(hash_map, key_string, key_string_length);
+	return Internal_SetValuePointerForKeyStringWithLength(hash_map, value_pointer, key_string, key_string_length);
 }
 
-static lua_Number Internal_GetValueNumberForKeyStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length)
+static const char* Internal_SetValueNumberForKeyStringWithLength(LuaHashMap* restrict hash_map, lua_Number value_number, const char* restrict key_string, size_t key_string_length)
 {
-	lua_Number ret_val;
+	const char* internalized_key_string = NULL;
 	
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
-	lua_pushlstring(hash_map->luaState, key_string, key_string_length); /* stack: [key_string, table] */
-	LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_string]; stack: [value_number, table] */
-	ret_val = lua_tonumber(hash_map->luaState, -1);
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	LUAHASHMAP_PUSHLSTRING_AND_ASSIGNINTERNALSTRING(hash_map->luaState, key_string, key_string_length, internalized_key_string); /* stack: [key_string, table] */
+	lua_pushnumber(hash_map->luaState, value_number); /* stack: [value_number, key_string, table] */
+	Internal_SetTableAndUpdateCount(hash_map);  /* table[key_string]=value_number; stack: [table] */
 	
-	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
-	lua_pop(hash_map->luaState, 2);
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);	
-	return ret_val;
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);	
+
+	return internalized_key_string;
 }
 
-lua_Number LuaHashMap_GetValueNumberForKeyString(LuaHashMap* restrict hash_map, const char* restrict key_string)
+static const char* Internal_Unlocked_SetValueNumberForKeyString(LuaHashMap* restrict hash_map, lua_Number value_number, const char* restrict key_string)
 {
 	if(NULL == hash_map)
 	{
-		return (lua_Number)0.0;
+		return NULL;
 	}
 	if(NULL == key_string)
 	{
-		return (lua_Number)0.0;
+		return NULL;
 	}
-	return Internal_GetValueNumberForKeyStringWithLength(hash_map, key_string, strlen(key_string));	
+	return Internal_SetValueNumberForKeyStringWithLength(hash_map, value_number, key_string, strlen(key_string));
 }
 
-lua_Number LuaHashMap_GetValueNumberForKeyStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length)
+static const char* Internal_Unlocked_SetValueNumberForKeyStringWithLength(LuaHashMap* restrict hash_map, lua_Number value_number, const char* restrict key_string, size_t key_string_length)
 {
 	if(NULL == hash_map)
 	{
-		return (lua_Number)0.0;
+		return NULL;
 	}
 	if(NULL == key_string)
 	{
-		return (lua_Number)0.0;
+		return NULL;
 	}
-	return Internal_GetValueNumberForKeyStringWithLength(hash_map, key_string, key_string_length);
+	return Internal_SetValueNumberForKeyStringWithLength(hash_map, value_number, key_string, key_string_length);
 }
 
-static lua_Integer Internal_GetValueIntegerForKeyStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length)
+static const char* Internal_SetValueIntegerForKeyStringWithLength(LuaHashMap* restrict hash_map, lua_Integer value_integer, const char* restrict key_string, size_t key_string_length)
 {
-	lua_Integer ret_val;
-
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
-	lua_pushlstring(hash_map->luaState, key_string, key_string_length); /* stack: [key_string, table] */
-	LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_string]; stack: [value_integer, table] */
-	ret_val = lua_tointeger(hash_map->luaState, -1);
+	const char* internalized_key_string = NULL;
 	
-	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
-	lua_pop(hash_map->luaState, 2);
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);	
-	return ret_val;
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	LUAHASHMAP_PUSHLSTRING_AND_ASSIGNINTERNALSTRING(hash_map->luaState, key_string, key_string_length, internalized_key_string); /* stack: [key_string, table] */
+	Internal_PushInteger(hash_map, value_integer); /* stack: [value_integer, key_string, table] */
+	Internal_SetTableAndUpdateCount(hash_map);  /* table[key_string]=value_integer; stack: [table] */
+
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);	
+
+	return internalized_key_string;
 }
 
-lua_Integer LuaHashMap_GetValueIntegerForKeyString(LuaHashMap* restrict hash_map, const char* restrict key_string)
+
+static const char* Internal_Unlocked_SetValueIntegerForKeyString(LuaHashMap* restrict hash_map, lua_Integer value_integer, const char* restrict key_string)
 {
 	if(NULL == hash_map)
 	{
-		return 0;
+		return NULL;
 	}
 	if(NULL == key_string)
 	{
-		return 0;
+		return NULL;
 	}
-	return Internal_GetValueIntegerForKeyStringWithLength(hash_map, key_string, strlen(key_string));
+	return Internal_SetValueIntegerForKeyStringWithLength(hash_map, value_integer, key_string, strlen(key_string));
 }
 
-lua_Integer LuaHashMap_GetValueIntegerForKeyStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length)
+static const char* Internal_Unlocked_SetValueIntegerForKeyStringWithLength(LuaHashMap* restrict hash_map, lua_Integer value_integer, const char* restrict key_string, size_t key_string_length)
 {
 	if(NULL == hash_map)
 	{
-		return 0;
+		return NULL;
 	}
 	if(NULL == key_string)
 	{
-		return 0;
+		return NULL;
 	}
-	return Internal_GetValueIntegerForKeyStringWithLength(hash_map, key_string, key_string_length);
+	return Internal_SetValueIntegerForKeyStringWithLength(hash_map, value_integer, key_string, key_string_length);
 }
 
-static const char* Internal_GetValueStringForKeyPointerWithLength(LuaHashMap* hash_map, void* key_pointer, size_t* value_string_length_return)
+static void Internal_SetValueStringForKeyPointerWithLength(LuaHashMap* hash_map, const char* value_string, void* key_pointer, size_t value_string_length)
 {
-	const char* ret_val;
-	
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
 	lua_pushlightuserdata(hash_map->luaState, key_pointer); /* stack: [key_pointer, table] */
-	LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_pointer]; stack: [value_pointer, table] */
-	ret_val = lua_tolstring(hash_map->luaState, -1, value_string_length_return);
+	lua_pushlstring(hash_map->luaState, value_string, value_string_length); /* stack: [value_string, key_pointer, table] */
+	Internal_SetTableAndUpdateCount(hash_map);  /* table[key_pointer]=value_string; stack: [table] */
 	
-	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
-	lua_pop(hash_map->luaState, 2);
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);
-	return ret_val;
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
 }
 
-const char* LuaHashMap_GetValueStringForKeyPointer(LuaHashMap* hash_map, void* key_pointer)
+static void Internal_Unlocked_SetValuePointerForKeyPointer(LuaHashMap* hash_map, void* value_pointer, void* key_pointer)
 {
 	if(NULL == hash_map)
 	{
-		return NULL;
+		return;
 	}
-	return Internal_GetValueStringForKeyPointerWithLength(hash_map, key_pointer, NULL);
+
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	lua_pushlightuserdata(hash_map->luaState, key_pointer); /* stack: [key_pointer, table] */
+	lua_pushlightuserdata(hash_map->luaState, value_pointer); /* stack: [value_pointer, key_pointer, table] */
+	Internal_SetTableAndUpdateCount(hash_map);  /* table[key_pointer]=value_pointer; stack: [table] */
+
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
 }
 
-const char* LuaHashMap_GetValueStringForKeyPointerWithLength(LuaHashMap* hash_map, void* key_pointer, size_t* value_string_length_return)
+static void Internal_Unlocked_SetValueStringForKeyPointer(LuaHashMap* hash_map, const char* value_string, void* key_pointer)
 {
 	if(NULL == hash_map)
 	{
-		return NULL;
+		return;
+	}
+	if(NULL == value_string)
+	{
+		Internal_SetValueStringForKeyPointerWithLength(hash_map, value_string, key_pointer, 0);
+	}
+	else
+	{
+		Internal_SetValueStringForKeyPointerWithLength(hash_map, value_string, key_pointer, strlen(value_string));
 	}
-	return Internal_GetValueStringForKeyPointerWithLength(hash_map, key_pointer, value_string_length_return);
 }
 
-void* LuaHashMap_GetValuePointerForKeyPointer(LuaHashMap* hash_map, void* key_pointer)
+static void Internal_Unlocked_SetValueStringForKeyPointerWithLength(LuaHashMap* hash_map, const char* value_string, void* key_pointer, size_t value_string_length)
 {
-	void* ret_val;
 	if(NULL == hash_map)
 	{
-		return NULL;
+		return;
 	}
+	Internal_SetValueStringForKeyPointerWithLength(hash_map, value_string, key_pointer, value_string_length);
 
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
-	lua_pushlightuserdata(hash_map->luaState, key_pointer); /* stack: [key_pointer, table] */
-	LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_pointer]; stack: [value_pointer, table] */
-	ret_val = lua_touserdata(hash_map->luaState, -1);
+}
 
-	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
-	lua_pop(hash_map->luaState, 2);
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);
-	return ret_val;
-}
-
-lua_Number LuaHashMap_GetValueNumberForKeyPointer(LuaHashMap* hash_map, void* key_pointer)
+static void Internal_Unlocked_SetValueNumberForKeyPointer(LuaHashMap* hash_map, lua_Number value_number, void* key_pointer)
 {
-	lua_Number ret_val;
 	if(NULL == hash_map)
 	{
-		return 0.0;
+		return;
 	}
 	
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
 	lua_pushlightuserdata(hash_map->luaState, key_pointer); /* stack: [key_pointer, table] */
-	LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_pointer]; stack: [value_pointer, table] */
-	ret_val = lua_tonumber(hash_map->luaState, -1);
+	lua_pushnumber(hash_map->luaState, value_number); /* stack: [value_number, key_pointer, table] */
+	Internal_SetTableAndUpdateCount(hash_map);  /* table[key_pointer]=value_number; stack: [table] */
 	
-	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
-	lua_pop(hash_map->luaState, 2);
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);
-	return ret_val;
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
 }
 
-lua_Integer LuaHashMap_GetValueIntegerForKeyPointer(LuaHashMap* hash_map, void* key_pointer)
+static void Internal_Unlocked_SetValueIntegerForKeyPointer(LuaHashMap* hash_map, lua_Integer value_integer, void* key_pointer)
 {
-	lua_Integer ret_val;
 	if(NULL == hash_map)
 	{
-		return 0;
+		return;
 	}
 	
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
 	lua_pushlightuserdata(hash_map->luaState, key_pointer); /* stack: [key_pointer, table] */
-	LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_pointer]; stack: [value_pointer, table] */
-	ret_val = lua_tointeger(hash_map->luaState, -1);
+	Internal_PushInteger(hash_map, value_integer); /* stack: [value_integer, key_pointer, table] */
+	Internal_SetTableAndUpdateCount(hash_map);  /* table[key_pointer]=value_integer; stack: [table] */
 	
-	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
-	lua_pop(hash_map->luaState, 2);
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);
-	return ret_val;
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
 }
 
-static const char* Internal_GetValueStringForKeyNumberWithLength(LuaHashMap* restrict hash_map, lua_Number key_number, size_t* restrict value_string_length_return)
+static void Internal_SetValueStringForKeyNumberWithLength(LuaHashMap* restrict hash_map, const char* restrict value_string, lua_Number key_number, size_t value_string_length)
 {
-	const char* ret_val;
-
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
 	lua_pushnumber(hash_map->luaState, key_number); /* stack: [key_number, table] */
-	LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_number]; stack: [value_pointer, table] */
-	ret_val = lua_tolstring(hash_map->luaState, -1, value_string_length_return);
+	lua_pushlstring(hash_map->luaState, value_string, value_string_length); /* stack: [value_string, key_number, table] */
+	Internal_SetTableAndUpdateCount(hash_map);  /* table[key_number]=value_string; stack: [table] */
 	
-	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
-	lua_pop(hash_map->luaState, 2);
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);
-	return ret_val;
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
 }
 
-const char* LuaHashMap_GetValueStringForKeyNumber(LuaHashMap* hash_map, lua_Number key_number)
+static void Internal_Unlocked_SetValueStringForKeyNumber(LuaHashMap* restrict hash_map, const char* restrict value_string, lua_Number key_number)
 {
 	if(NULL == hash_map)
 	{
-		return NULL;
+		return;
+	}
+	if(NULL == value_string)
+	{
+		Internal_SetValueStringForKeyNumberWithLength(hash_map, value_string, key_number, 0);
+	}
+	else
+	{
+		Internal_SetValueStringForKeyNumberWithLength(hash_map, value_string, key_number, strlen(value_string));
 	}
-	return Internal_GetValueStringForKeyNumberWithLength(hash_map, key_number, NULL);
 }
 
-const char* LuaHashMap_GetValueStringForKeyNumberWithLength(LuaHashMap* restrict hash_map, lua_Number key_number, size_t* restrict value_string_length_return)
+static void Internal_Unlocked_SetValueStringForKeyNumberWithLength(LuaHashMap* restrict hash_map, const char* restrict value_string, lua_Number key_number, size_t value_string_length)
 {
 	if(NULL == hash_map)
 	{
-		return NULL;
+		return;
 	}
-	return Internal_GetValueStringForKeyNumberWithLength(hash_map, key_number, value_string_length_return);
+	Internal_SetValueStringForKeyNumberWithLength(hash_map, value_string, key_number, value_string_length);
 }
 
-void* LuaHashMap_GetValuePointerForKeyNumber(LuaHashMap* hash_map, lua_Number key_number)
+static void Internal_Unlocked_SetValuePointerForKeyNumber(LuaHashMap* hash_map, void* value_pointer, lua_Number key_number)
 {
-	void* ret_val;
 	if(NULL == hash_map)
 	{
-		return NULL;
+		return;
 	}
 	
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
 	lua_pushnumber(hash_map->luaState, key_number); /* stack: [key_number, table] */
-	LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_number]; stack: [value_pointer, table] */
-	ret_val = lua_touserdata(hash_map->luaState, -1);
+	lua_pushlightuserdata(hash_map->luaState, value_pointer); /* stack: [value_pointer, key_number, table] */
+	Internal_SetTableAndUpdateCount(hash_map);  /* table[key_number]=value_pointer; stack: [table] */
 	
-	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
-	lua_pop(hash_map->luaState, 2);
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);
-	return ret_val;
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
 }
 
-lua_Number LuaHashMap_GetValueNumberForKeyNumber(LuaHashMap* hash_map, lua_Number key_number)
+
+static void Internal_Unlocked_SetValueNumberForKeyNumber(LuaHashMap* hash_map, lua_Number value_number, lua_Number key_number)
 {
-	lua_Number ret_val;
 	if(NULL == hash_map)
 	{
-		return 0.0;
+		return;
 	}
 	
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
 	lua_pushnumber(hash_map->luaState, key_number); /* stack: [key_number, table] */
-	LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_number]; stack: [value_number, table] */
-	ret_val = lua_tonumber(hash_map->luaState, -1);
+	lua_pushnumber(hash_map->luaState, value_number); /* stack: [value_number, key_number, table] */
+	Internal_SetTableAndUpdateCount(hash_map);  /* table[key_number]=value_number; stack: [table] */
 	
-	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
-	lua_pop(hash_map->luaState, 2);
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);
-	return ret_val;
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
 }
 
-lua_Integer LuaHashMap_GetValueIntegerForKeyNumber(LuaHashMap* hash_map, lua_Number key_number)
+static void Internal_Unlocked_SetValueIntegerForKeyNumber(LuaHashMap* hash_map, lua_Integer value_integer, lua_Number key_number)
 {
-	lua_Integer ret_val;
 	if(NULL == hash_map)
 	{
-		return 0;
+		return;
 	}
 	
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
 	lua_pushnumber(hash_map->luaState, key_number); /* stack: [key_number, table] */
-	LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_number]; stack: [value_integer, table] */
-	ret_val = lua_tointeger(hash_map->luaState, -1);
+	Internal_PushInteger(hash_map, value_integer); /* stack: [value_integer, key_number, table] */
+	Internal_SetTableAndUpdateCount(hash_map);  /* table[key_number]=value_integer; stack: [table] */
 	
-	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
-	lua_pop(hash_map->luaState, 2);
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);
-	return ret_val;
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
 }
 
-static const char* Internal_GetValueStringForKeyIntegerWithLength(LuaHashMap* restrict hash_map, lua_Integer key_integer, size_t* restrict value_string_length_return)
+static void Internal_SetValueStringForKeyIntegerWithLength(LuaHashMap* restrict hash_map, const char* restrict value_string, lua_Integer key_integer, size_t value_string_length)
 {
-	const char* ret_val;
+	if(NULL == hash_map)
+	{
+		return;
+	}
 	
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
-	lua_pushinteger(hash_map->luaState, key_integer); /* stack: [key_integer, table] */
-	LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_number]; stack: [value_string, table] */
-	ret_val = lua_tolstring(hash_map->luaState, -1, value_string_length_return);
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	lua_pushlstring(hash_map->luaState, value_string, value_string_length); /* stack: [value_string, table] */
+	Internal_SetTableForKeyIntegerAndUpdateCount(hash_map, key_integer);  /* table[key_integer]=value_string; stack: [table] */
 	
-	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
-	lua_pop(hash_map->luaState, 2);
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);
-	return ret_val;
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
 }
 
-const char* LuaHashMap_GetValueStringForKeyInteger(LuaHashMap* hash_map, lua_Integer key_integer)
+static void Internal_Unlocked_SetValueStringForKeyInteger(LuaHashMap* restrict hash_map, const char* restrict value_string, lua_Integer key_integer)
 {
 	if(NULL == hash_map)
 	{
-		return NULL;
+		return;
+	}
+	if(NULL == value_string)
+	{
+		Internal_SetValueStringForKeyIntegerWithLength(hash_map, value_string, key_integer, 0);
+	}
+	else
+	{
+		Internal_SetValueStringForKeyIntegerWithLength(hash_map, value_string, key_integer, strlen(value_string));
 	}
-	return Internal_GetValueStringForKeyIntegerWithLength(hash_map, key_integer, NULL);
 }
 
-const char* LuaHashMap_GetValueStringForKeyIntegerWithLength(LuaHashMap* restrict hash_map, lua_Integer key_integer, size_t* restrict value_string_length_return)
+static void Internal_Unlocked_SetValueStringForKeyIntegerWithLength(LuaHashMap* restrict hash_map, const char* restrict value_string, lua_Integer key_integer, size_t value_string_length)
 {
 	if(NULL == hash_map)
 	{
-		return NULL;
+		return;
 	}
-	return Internal_GetValueStringForKeyIntegerWithLength(hash_map, key_integer, value_string_length_return);
+	Internal_SetValueStringForKeyIntegerWithLength(hash_map, value_string, key_integer, value_string_length);
 }
 
-void* LuaHashMap_GetValuePointerForKeyInteger(LuaHashMap* hash_map, lua_Integer key_integer)
+static void Internal_Unlocked_SetValuePointerForKeyInteger(LuaHashMap* hash_map, void* value_pointer, lua_Integer key_integer)
 {
-	void* ret_val;
 	if(NULL == hash_map)
 	{
-		return NULL;
+		return;
 	}
 	
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
-	lua_pushinteger(hash_map->luaState, key_integer); /* stack: [key_integer, table] */
-	LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_integer]; stack: [value_pointer, table] */
-	ret_val = lua_touserdata(hash_map->luaState, -1);
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	lua_pushlightuserdata(hash_map->luaState, value_pointer); /* stack: [value_pointer, table] */
+	Internal_SetTableForKeyIntegerAndUpdateCount(hash_map, key_integer);  /* table[key_integer]=value_pointer; stack: [table] */
 	
-	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
-	lua_pop(hash_map->luaState, 2);
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);
-	return ret_val;
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
 }
 
-lua_Number LuaHashMap_GetValueNumberForKeyInteger(LuaHashMap* hash_map, lua_Integer key_integer)
+static void Internal_Unlocked_SetValueNumberForKeyInteger(LuaHashMap* hash_map, lua_Number value_number, lua_Integer key_integer)
 {
-	lua_Number ret_val;
 	if(NULL == hash_map)
 	{
-		return 0.0;
+		return;
 	}
 	
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
-	lua_pushinteger(hash_map->luaState, key_integer); /* stack: [key_integer, table] */
-	LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_integer]; stack: [value_number, table] */
-	ret_val = lua_tonumber(hash_map->luaState, -1);
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	lua_pushnumber(hash_map->luaState, value_number); /* stack: [value_number, table] */
+	Internal_SetTableForKeyIntegerAndUpdateCount(hash_map, key_integer);  /* table[key_integer]=value_number; stack: [table] */
 	
-	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
-	lua_pop(hash_map->luaState, 2);
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);
-	return ret_val;
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
 }
 
-lua_Integer LuaHashMap_GetValueIntegerForKeyInteger(LuaHashMap* hash_map, lua_Integer key_integer)
+static void Internal_Unlocked_SetValueIntegerForKeyInteger(LuaHashMap* hash_map, lua_Integer value_integer, lua_Integer key_integer)
 {
-	lua_Integer ret_val;
 	if(NULL == hash_map)
 	{
-		return 0;
+		return;
 	}
 	
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
-	lua_pushinteger(hash_map->luaState, key_integer); /* stack: [key_integer, table] */
-	LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_integer]; stack: [value_integer, table] */
-	ret_val = lua_tointeger(hash_map->luaState, -1);
-	
-	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
-	lua_pop(hash_map->luaState, 2);
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);
-	return ret_val;
-}
-
-
-
-static void Internal_RemoveKeyStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length)
-{
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
-	lua_pushlstring(hash_map->luaState, key_string, key_string_length); /* stack: [key_string, table] */
-	lua_pushnil(hash_map->luaState); /* stack: [nil, key_string, table] */
-	LUAHASHMAP_SETTABLE(hash_map->luaState, -3);  /* table[key_string]=nil; stack: [table] */
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	Internal_PushInteger(hash_map, value_integer); /* stack: [value_integer, table] */
+	Internal_SetTableForKeyIntegerAndUpdateCount(hash_map, key_integer);  /* table[key_integer]=value_integer; stack: [table] */
 	
 	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
 	lua_pop(hash_map->luaState, 1);
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);	
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
 }
 
-void LuaHashMap_RemoveKeyString(LuaHashMap* restrict hash_map, const char* restrict key_string)
+/* Batch versions of the SetValueForKey family. These fetch the table once and stream all the pairs through it. */
+static void Internal_Unlocked_SetValuesStringForKeysString(LuaHashMap* hash_map, const char* values_array[], const char* keys_array[], const size_t value_lengths_array[], const size_t key_lengths_array[], size_t number_of_elements)
 {
+	size_t i;
 	if(NULL == hash_map)
 	{
 		return;
 	}
-	if(NULL == key_string)
+	if((NULL == values_array) || (NULL == keys_array))
 	{
 		return;
 	}
-	Internal_RemoveKeyStringWithLength(hash_map, key_string, strlen(key_string));
+
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	for(i=0; i<number_of_elements; i++)
+	{
+		if(NULL == keys_array[i])
+		{
+			/* NULL key strings are disallowed, same as LuaHashMap_SetValueStringForKeyString */
+			continue;
+		}
+		lua_pushlstring(hash_map->luaState, keys_array[i], (NULL == key_lengths_array) ? strlen(keys_array[i]) : key_lengths_array[i]); /* stack: [key_string, table] */
+		if(NULL == values_array[i])
+		{
+			lua_pushlstring(hash_map->luaState, NULL, 0); /* stack: [value_string, key_string, table] */
+		}
+		else
+		{
+			lua_pushlstring(hash_map->luaState, values_array[i], (NULL == value_lengths_array) ? strlen(values_array[i]) : value_lengths_array[i]); /* stack: [value_string, key_string, table] */
+		}
+		Internal_SetTableAndUpdateCount(hash_map);  /* table[key_string]=value_string; stack: [table] */
+	}
+
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
 }
 
-void LuaHashMap_RemoveKeyStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length)
+static void Internal_Unlocked_SetValuesPointerForKeysString(LuaHashMap* hash_map, void* values_array[], const char* keys_array[], const size_t key_lengths_array[], size_t number_of_elements)
 {
+	size_t i;
 	if(NULL == hash_map)
 	{
 		return;
 	}
-	if(NULL == key_string)
+	if((NULL == values_array) || (NULL == keys_array))
 	{
 		return;
 	}
-	Internal_RemoveKeyStringWithLength(hash_map, key_string, key_string_length);
+
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	for(i=0; i<number_of_elements; i++)
+	{
+		if(NULL == keys_array[i])
+		{
+			/* NULL key strings are disallowed, same as LuaHashMap_SetValuePointerForKeyString */
+			continue;
+		}
+		lua_pushlstring(hash_map->luaState, keys_array[i], (NULL == key_lengths_array) ? strlen(keys_array[i]) : key_lengths_array[i]); /* stack: [key_string, table] */
+		lua_pushlightuserdata(hash_map->luaState, values_array[i]); /* stack: [value_pointer, key_string, table] */
+		Internal_SetTableAndUpdateCount(hash_map);  /* table[key_string]=value_pointer; stack: [table] */
+	}
+
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
 }
 
-void LuaHashMap_RemoveKeyPointer(LuaHashMap* hash_map, void* key_pointer)
+static void Internal_Unlocked_SetValuesNumberForKeysString(LuaHashMap* hash_map, const lua_Number values_array[], const char* keys_array[], const size_t key_lengths_array[], size_t number_of_elements)
 {
+	size_t i;
 	if(NULL == hash_map)
 	{
 		return;
 	}
+	if((NULL == values_array) || (NULL == keys_array))
+	{
+		return;
+	}
 
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
-	lua_pushlightuserdata(hash_map->luaState, key_pointer); /* stack: [key_pointer, table] */
-	lua_pushnil(hash_map->luaState); /* stack: [nil, key_pointer, table] */
-	LUAHASHMAP_SETTABLE(hash_map->luaState, -3);  /* table[key_pointer]=nil; stack: [table] */
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	for(i=0; i<number_of_elements; i++)
+	{
+		if(NULL == keys_array[i])
+		{
+			/* NULL key strings are disallowed, same as LuaHashMap_SetValueNumberForKeyString */
+			continue;
+		}
+		lua_pushlstring(hash_map->luaState, keys_array[i], (NULL == key_lengths_array) ? strlen(keys_array[i]) : key_lengths_array[i]); /* stack: [key_string, table] */
+		lua_pushnumber(hash_map->luaState, values_array[i]); /* stack: [value_number, key_string, table] */
+		Internal_SetTableAndUpdateCount(hash_map);  /* table[key_string]=value_number; stack: [table] */
+	}
 
 	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
 	lua_pop(hash_map->luaState, 1);
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
 }
 
-void LuaHashMap_RemoveKeyNumber(LuaHashMap* hash_map, lua_Number key_number)
+static void Internal_Unlocked_SetValuesIntegerForKeysString(LuaHashMap* hash_map, const lua_Integer values_array[], const char* keys_array[], const size_t key_lengths_array[], size_t number_of_elements)
 {
+	size_t i;
 	if(NULL == hash_map)
 	{
 		return;
 	}
-	
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
-	lua_pushnumber(hash_map->luaState, key_number); /* stack: [key_number, table] */
-	lua_pushnil(hash_map->luaState); /* stack: [nil, key_number, table] */
-	LUAHASHMAP_SETTABLE(hash_map->luaState, -3);  /* table[key_number]=nil; stack: [table] */
-	
+	if((NULL == values_array) || (NULL == keys_array))
+	{
+		return;
+	}
+
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	for(i=0; i<number_of_elements; i++)
+	{
+		if(NULL == keys_array[i])
+		{
+			/* NULL key strings are disallowed, same as LuaHashMap_SetValueIntegerForKeyString */
+			continue;
+		}
+		lua_pushlstring(hash_map->luaState, keys_array[i], (NULL == key_lengths_array) ? strlen(keys_array[i]) : key_lengths_array[i]); /* stack: [key_string, table] */
+		Internal_PushInteger(hash_map, values_array[i]); /* stack: [value_integer, key_string, table] */
+		Internal_SetTableAndUpdateCount(hash_map);  /* table[key_string]=value_integer; stack: [table] */
+	}
+
 	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
 	lua_pop(hash_map->luaState, 1);
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
 }
 
-void LuaHashMap_RemoveKeyInteger(LuaHashMap* hash_map, lua_Integer key_integer)
+static void Internal_Unlocked_SetValuesStringForKeysPointer(LuaHashMap* hash_map, const char* values_array[], void* keys_array[], const size_t value_lengths_array[], size_t number_of_elements)
 {
+	size_t i;
 	if(NULL == hash_map)
 	{
 		return;
 	}
-	
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
-	lua_pushinteger(hash_map->luaState, key_integer); /* stack: [key_integer, table] */
-	lua_pushnil(hash_map->luaState); /* stack: [nil, key_integer, table] */
-	LUAHASHMAP_SETTABLE(hash_map->luaState, -3);  /* table[key_integer]=nil; stack: [table] */
-	
+	if((NULL == values_array) || (NULL == keys_array))
+	{
+		return;
+	}
+
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	for(i=0; i<number_of_elements; i++)
+	{
+		lua_pushlightuserdata(hash_map->luaState, keys_array[i]); /* stack: [key_pointer, table] */
+		if(NULL == values_array[i])
+		{
+			lua_pushlstring(hash_map->luaState, NULL, 0); /* stack: [value_string, key_pointer, table] */
+		}
+		else
+		{
+			lua_pushlstring(hash_map->luaState, values_array[i], (NULL == value_lengths_array) ? strlen(values_array[i]) : value_lengths_array[i]); /* stack: [value_string, key_pointer, table] */
+		}
+		Internal_SetTableAndUpdateCount(hash_map);  /* table[key_pointer]=value_string; stack: [table] */
+	}
+
 	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
 	lua_pop(hash_map->luaState, 1);
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
 }
 
-static bool Internal_ExistsKeyStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length)
+static void Internal_Unlocked_SetValuesPointerForKeysPointer(LuaHashMap* hash_map, void* values_array[], void* keys_array[], size_t number_of_elements)
 {
-	bool ret_val;
-
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
-	lua_pushlstring(hash_map->luaState, key_string, key_string_length); /* stack: [key_string, table] */
-	LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_string]; stack: [value, table] */
-	
-	if(LUA_TNIL==lua_type(hash_map->luaState, -1))
+	size_t i;
+	if(NULL == hash_map)
 	{
-		ret_val = false;
+		return;
 	}
-	else
+	if((NULL == values_array) || (NULL == keys_array))
 	{
-		ret_val = true;
+		return;
 	}
-	
-	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
-	lua_pop(hash_map->luaState, 2);
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);	
-	return ret_val;
+
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	for(i=0; i<number_of_elements; i++)
+	{
+		lua_pushlightuserdata(hash_map->luaState, keys_array[i]); /* stack: [key_pointer, table] */
+		lua_pushlightuserdata(hash_map->luaState, values_array[i]); /* stack: [value_pointer, key_pointer, table] */
+		Internal_SetTableAndUpdateCount(hash_map);  /* table[key_pointer]=value_pointer; stack: [table] */
+	}
+
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
 }
 
-bool LuaHashMap_ExistsKeyString(LuaHashMap* restrict hash_map, const char* restrict key_string)
+static void Internal_Unlocked_SetValuesNumberForKeysPointer(LuaHashMap* hash_map, const lua_Number values_array[], void* keys_array[], size_t number_of_elements)
 {
+	size_t i;
 	if(NULL == hash_map)
 	{
-		return false;
+		return;
 	}
-	if(NULL == key_string)
+	if((NULL == values_array) || (NULL == keys_array))
 	{
-		return false;
+		return;
 	}
-	return Internal_ExistsKeyStringWithLength(hash_map, key_string, strlen(key_string));	
+
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	for(i=0; i<number_of_elements; i++)
+	{
+		lua_pushlightuserdata(hash_map->luaState, keys_array[i]); /* stack: [key_pointer, table] */
+		lua_pushnumber(hash_map->luaState, values_array[i]); /* stack: [value_number, key_pointer, table] */
+		Internal_SetTableAndUpdateCount(hash_map);  /* table[key_pointer]=value_number; stack: [table] */
+	}
+
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
 }
 
-bool LuaHashMap_ExistsKeyStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length)
+static void Internal_Unlocked_SetValuesIntegerForKeysPointer(LuaHashMap* hash_map, const lua_Integer values_array[], void* keys_array[], size_t number_of_elements)
 {
+	size_t i;
 	if(NULL == hash_map)
 	{
-		return false;
+		return;
 	}
-	if(NULL == key_string)
+	if((NULL == values_array) || (NULL == keys_array))
 	{
-		return false;
+		return;
 	}
-	return Internal_ExistsKeyStringWithLength(hash_map, key_string, key_string_length);
+
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	for(i=0; i<number_of_elements; i++)
+	{
+		lua_pushlightuserdata(hash_map->luaState, keys_array[i]); /* stack: [key_pointer, table] */
+		Internal_PushInteger(hash_map, values_array[i]); /* stack: [value_integer, key_pointer, table] */
+		Internal_SetTableAndUpdateCount(hash_map);  /* table[key_pointer]=value_integer; stack: [table] */
+	}
+
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
 }
 
-bool LuaHashMap_ExistsKeyPointer(LuaHashMap* hash_map, void* key_pointer)
+static void Internal_Unlocked_SetValuesStringForKeysNumber(LuaHashMap* hash_map, const char* values_array[], const lua_Number keys_array[], const size_t value_lengths_array[], size_t number_of_elements)
 {
-	bool ret_val;
+	size_t i;
 	if(NULL == hash_map)
 	{
-		return false;
+		return;
 	}
-
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
-	lua_pushlightuserdata(hash_map->luaState, key_pointer); /* stack: [key_pointer, table] */
-	LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_pointer]; stack: [value_pointer, table] */
-
-	if(LUA_TNIL==lua_type(hash_map->luaState, -1))
+	if((NULL == values_array) || (NULL == keys_array))
 	{
-		ret_val = false;
+		return;
 	}
-	else
+
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	for(i=0; i<number_of_elements; i++)
 	{
-		ret_val = true;
+		lua_pushnumber(hash_map->luaState, keys_array[i]); /* stack: [key_number, table] */
+		if(NULL == values_array[i])
+		{
+			lua_pushlstring(hash_map->luaState, NULL, 0); /* stack: [value_string, key_number, table] */
+		}
+		else
+		{
+			lua_pushlstring(hash_map->luaState, values_array[i], (NULL == value_lengths_array) ? strlen(values_array[i]) : value_lengths_array[i]); /* stack: [value_string, key_number, table] */
+		}
+		Internal_SetTableAndUpdateCount(hash_map);  /* table[key_number]=value_string; stack: [table] */
 	}
 
-	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
-	lua_pop(hash_map->luaState, 2);
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);
-	return ret_val;
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
 }
 
-bool LuaHashMap_ExistsKeyNumber(LuaHashMap* hash_map, lua_Number key_number)
+static void Internal_Unlocked_SetValuesPointerForKeysNumber(LuaHashMap* hash_map, void* values_array[], const lua_Number keys_array[], size_t number_of_elements)
 {
-	bool ret_val;
+	size_t i;
 	if(NULL == hash_map)
 	{
-		return false;
+		return;
 	}
-
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
-	lua_pushnumber(hash_map->luaState, key_number); /* stack: [key_number, table] */
-	LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_number]; stack: [value_pointer, table] */
-
-	if(LUA_TNIL==lua_type(hash_map->luaState, -1))
+	if((NULL == values_array) || (NULL == keys_array))
 	{
-		ret_val = false;
+		return;
 	}
-	else
+
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	for(i=0; i<number_of_elements; i++)
 	{
-		ret_val = true;
+		lua_pushnumber(hash_map->luaState, keys_array[i]); /* stack: [key_number, table] */
+		lua_pushlightuserdata(hash_map->luaState, values_array[i]); /* stack: [value_pointer, key_number, table] */
+		Internal_SetTableAndUpdateCount(hash_map);  /* table[key_number]=value_pointer; stack: [table] */
 	}
 
-	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
-	lua_pop(hash_map->luaState, 2);
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);
-	return ret_val;
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
 }
 
-bool LuaHashMap_ExistsKeyInteger(LuaHashMap* hash_map, lua_Integer key_integer)
+static void Internal_Unlocked_SetValuesNumberForKeysNumber(LuaHashMap* hash_map, const lua_Number values_array[], const lua_Number keys_array[], size_t number_of_elements)
 {
-	bool ret_val;
+	size_t i;
 	if(NULL == hash_map)
 	{
-		return false;
+		return;
 	}
-	
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
-	lua_pushinteger(hash_map->luaState, key_integer); /* stack: [key_integer, table] */
-	LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_integer]; stack: [value_pointer, table] */
-	
-	if(LUA_TNIL==lua_type(hash_map->luaState, -1))
+	if((NULL == values_array) || (NULL == keys_array))
 	{
-		ret_val = false;
+		return;
 	}
-	else
+
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	for(i=0; i<number_of_elements; i++)
 	{
-		ret_val = true;
+		lua_pushnumber(hash_map->luaState, keys_array[i]); /* stack: [key_number, table] */
+		lua_pushnumber(hash_map->luaState, values_array[i]); /* stack: [value_number, key_number, table] */
+		Internal_SetTableAndUpdateCount(hash_map);  /* table[key_number]=value_number; stack: [table] */
 	}
-	
-	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
-	lua_pop(hash_map->luaState, 2);
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);
-	return ret_val;
+
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
 }
 
-static void Internal_Clear(LuaHashMap* hash_map, LuaHashMap_InternalGlobalKeyType table_name)
+static void Internal_Unlocked_SetValuesIntegerForKeysNumber(LuaHashMap* hash_map, const lua_Integer values_array[], const lua_Number keys_array[], size_t number_of_elements)
 {
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, table_name); /* stack: [table] */
-	lua_pushnil(hash_map->luaState);  /* first key */
-	while (lua_next(hash_map->luaState, -2) != 0) /* use index of table */
+	size_t i;
+	if(NULL == hash_map)
 	{
-		/* lua_next puts 'key' (at index -2) and 'value' (at index -1) */
-		
-		lua_pop(hash_map->luaState, 1); /* pop the value because we don't need it; stack: [key table] */
-		/* duplicate the key because we want to save a copy of it to be used for the next round of lua_next */
-		lua_pushvalue(hash_map->luaState, -1); /* stack: [key key table] */
-		lua_pushnil(hash_map->luaState); /* stack: [nil, key, key, table] */
-		LUAHASHMAP_SETTABLE(hash_map->luaState, -4);  /* table[key_pointer]=nil; stack: [key table] */
-		
-		/* key is at the top of the stack, ready for next round of lua_next() */
+		return;
 	}
-	lua_pop(hash_map->luaState, 1); /* pop the table */
+	if((NULL == values_array) || (NULL == keys_array))
+	{
+		return;
+	}
+
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	for(i=0; i<number_of_elements; i++)
+	{
+		lua_pushnumber(hash_map->luaState, keys_array[i]); /* stack: [key_number, table] */
+		Internal_PushInteger(hash_map, values_array[i]); /* stack: [value_integer, key_number, table] */
+		Internal_SetTableAndUpdateCount(hash_map);  /* table[key_number]=value_integer; stack: [table] */
+	}
+
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
 }
 
-void LuaHashMap_Clear(LuaHashMap* hash_map)
+static void Internal_Unlocked_SetValuesStringForKeysInteger(LuaHashMap* hash_map, const char* values_array[], const lua_Integer keys_array[], const size_t value_lengths_array[], size_t number_of_elements)
 {
+	size_t i;
 	if(NULL == hash_map)
 	{
 		return;
 	}
-/*	Internal_InitializeInternalTables(hash_map); */
-	/* If we simply replace the current table with a new one, we lose the internal current size of the hash
-	 * which might be painful to reallocate if the user intends to refill the hash with the same amount of data.
-	 * So instead, it is probably better to iterate through all keys and remove them.
-	 * If the user wants to blow away everything for more speed, they can always destroy the hashmap and create a new one.
-     * Lua Gems verifies that removing entries only nils entries and doesn't rehash so 
-     * it is safe to iterate via lua_next while removing items.
-	 * See Purge for clearing that reclaims memory.
-	 */
+	if((NULL == values_array) || (NULL == keys_array))
+	{
+		return;
+	}
 
-	Internal_Clear(hash_map, hash_map->uniqueTableNameForSharedState);
-	
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);	
-	LUAHASHMAP_ASSERT(true == LuaHashMap_IsEmpty(hash_map));
-}
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	for(i=0; i<number_of_elements; i++)
+	{
+		if(NULL == values_array[i])
+		{
+			lua_pushlstring(hash_map->luaState, NULL, 0); /* stack: [value_string, table] */
+		}
+		else
+		{
+			lua_pushlstring(hash_map->luaState, values_array[i], (NULL == value_lengths_array) ? strlen(values_array[i]) : value_lengths_array[i]); /* stack: [value_string, table] */
+		}
+		Internal_SetTableForKeyIntegerAndUpdateCount(hash_map, keys_array[i]);  /* table[key_integer]=value_string; stack: [table] */
+	}
 
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+}
 
-void LuaHashMap_Purge(LuaHashMap* hash_map)
+static void Internal_Unlocked_SetValuesPointerForKeysInteger(LuaHashMap* hash_map, void* values_array[], const lua_Integer keys_array[], size_t number_of_elements)
 {
+	size_t i;
 	if(NULL == hash_map)
 	{
 		return;
 	}
-	/* Unlike Clear, this version replaces the existing table with a completely new one.
-	 * This effectively purges the memory since Lua normally doesn't reclaim memory when nil-ing an entry.
-	 * The presumption here is you really want the memory back.
-	 */
-	LUAHASHMAP_REPLACE_WITH_EMPTY_TABLE(hash_map->luaState, hash_map->uniqueTableNameForSharedState);
+	if((NULL == values_array) || (NULL == keys_array))
+	{
+		return;
+	}
 
-	/* Now seems to be a reasonable time to invoke garbage collection. */
-	lua_gc(hash_map->luaState, LUA_GCCOLLECT, 0);
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	for(i=0; i<number_of_elements; i++)
+	{
+		lua_pushlightuserdata(hash_map->luaState, values_array[i]); /* stack: [value_pointer, table] */
+		Internal_SetTableForKeyIntegerAndUpdateCount(hash_map, keys_array[i]);  /* table[key_integer]=value_pointer; stack: [table] */
+	}
 
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);	
-	LUAHASHMAP_ASSERT(true == LuaHashMap_IsEmpty(hash_map));
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
 }
 
-
-static bool Internal_IsEmpty(LuaHashMap* hash_map, LuaHashMap_InternalGlobalKeyType table_name)
+static void Internal_Unlocked_SetValuesNumberForKeysInteger(LuaHashMap* hash_map, const lua_Number values_array[], const lua_Integer keys_array[], size_t number_of_elements)
 {
-	bool is_empty;
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, table_name); /* stack: [table] */
-
-	lua_pushnil(hash_map->luaState);  /* first key */
-	if(lua_next(hash_map->luaState, -2) != 0) /* use index of table */
+	size_t i;
+	if(NULL == hash_map)
 	{
-		is_empty = false;
-		/* pop key, value, and table */
-		lua_pop(hash_map->luaState, 3);
+		return;
 	}
-	else
+	if((NULL == values_array) || (NULL == keys_array))
 	{
-		is_empty = true;
-		/* pop table */
-		lua_pop(hash_map->luaState, 1);
+		return;
 	}
 
-	return is_empty;
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	for(i=0; i<number_of_elements; i++)
+	{
+		lua_pushnumber(hash_map->luaState, values_array[i]); /* stack: [value_number, table] */
+		Internal_SetTableForKeyIntegerAndUpdateCount(hash_map, keys_array[i]);  /* table[key_integer]=value_number; stack: [table] */
+	}
+
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
 }
 
-bool LuaHashMap_IsEmpty(LuaHashMap* hash_map)
+static void Internal_Unlocked_SetValuesIntegerForKeysInteger(LuaHashMap* hash_map, const lua_Integer values_array[], const lua_Integer keys_array[], size_t number_of_elements)
 {
-	bool is_empty = true;
+	size_t i;
 	if(NULL == hash_map)
 	{
-		return true;
+		return;
+	}
+	if((NULL == values_array) || (NULL == keys_array))
+	{
+		return;
 	}
 
-	is_empty = Internal_IsEmpty(hash_map, hash_map->uniqueTableNameForSharedState);
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	for(i=0; i<number_of_elements; i++)
+	{
+		Internal_PushInteger(hash_map, values_array[i]); /* stack: [value_integer, table] */
+		Internal_SetTableForKeyIntegerAndUpdateCount(hash_map, keys_array[i]);  /* table[key_integer]=value_integer; stack: [table] */
+	}
 
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);		
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+}
 
-	return is_empty;
+static const char* Internal_GetValueStringForKeyStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t* value_string_length_return, size_t key_string_length)
+{
+	const char* ret_val;
+
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	lua_pushlstring(hash_map->luaState, key_string, key_string_length); /* stack: [key_string, table] */
+	LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_string]; stack: [value_string, table] */
+	
+	ret_val = lua_tolstring(hash_map->luaState, -1, value_string_length_return);
+
+	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 2);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);	
+	return ret_val;
 }
 
+static const char* Internal_Unlocked_GetValueStringForKeyString(LuaHashMap* restrict hash_map, const char* restrict key_string)
+{
+	if(NULL == hash_map)
+	{
+		return NULL;
+	}
+	if(NULL == key_string)
+	{
+		return NULL;
+	}
+	return Internal_GetValueStringForKeyStringWithLength(hash_map, key_string, NULL, strlen(key_string));
+}
 
-static bool Internal_IteratorIsAlreadyNext(LuaHashMapIterator* hash_iterator)
+static const char* Internal_Unlocked_GetValueStringForKeyStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t* restrict value_string_length_return, size_t key_string_length)
 {
-	hash_iterator->isNext = false;
-	
-	/* This is my clue as to whether we are at an end iterator or not */
-	if(LUA_TNONE == hash_iterator->keyType)
+	if(NULL == hash_map)
 	{
-		hash_iterator->atEnd = true;
-		/* Memory should already be set correctly */
-		return false;
+		return NULL;
 	}
-	/* Assumption: Remove already set the currentKey/Value and types so all we need to do is flip the isNext flag. */
-	/* Note: There is a corner case where the cached values could be stale when the user is expecting them to be fresh.
-	hash_iterator = LuaHashMap_GetIteratorAtBegin(hash_map);
-	do
+	if(NULL == key_string)
 	{
-		fprintf(stderr, "Removing: Price of %s: %lf\n", 
-			LuaHashMap_GetCachedKeyStringAtIterator(&hash_iterator), 
-			LuaHashMap_GetCachedValueNumberAtIterator(&hash_iterator));
-		LuaHashMap_RemoveAtIterator(&hash_iterator);
-		// Change a value in the hash that happens to be the next position.
-		LuaHashMap_SetValue*ForKey*(...);
-		
-	} while(LuaHashMap_IteratorNext(&hash_iterator));
-	
-	 In this case, the value was already cached in RemoveAtIterator so in the next loop, the value is stale.
-	 However, since this technically wasn't using the iterator APIs to set the value, this is one of the cases GetCached is documented to miss.
-	 For performance reasons, I don't really want to re-fetch the value here. I presume the common case is to iterate and remove
-	 so it doesn't make sense to do a double lookup.
-	 */
-	return true;	
+		return NULL;
+	}
+	return Internal_GetValueStringForKeyStringWithLength(hash_map, key_string, value_string_length_return, key_string_length);
 }
 
-static bool Internal_IteratorNext(LuaHashMapIterator* hash_iterator)
+static void* Internal_GetValuePointerForKeyStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length)
 {
-	LuaHashMap* hash_map = hash_iterator->hashMap;
-	LuaHashMap_InternalGlobalKeyType table_name = hash_iterator->whichTable;
+	void* ret_val;
 
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, table_name); /* stack: [table] */
-	
-	 /* first key */
-	if(LUA_TSTRING == hash_iterator->keyType)
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	lua_pushlstring(hash_map->luaState, key_string, key_string_length); /* stack: [key_string, table] */
+	LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_string]; stack: [value_pointer, table] */
+
+	ret_val = lua_touserdata(hash_map->luaState, -1);
+
+	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 2);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);	
+	return ret_val;
+}
+
+static void* Internal_Unlocked_GetValuePointerForKeyString(LuaHashMap* restrict hash_map, const char* restrict key_string)
+{
+	if(NULL == hash_map)
 	{
-		lua_pushlstring(hash_map->luaState, hash_iterator->currentKey.theString.stringPointer, hash_iterator->currentKey.theString.stringLength);
+		return NULL;
 	}
-	else if(LUA_TLIGHTUSERDATA == hash_iterator->keyType)
+	if(NULL == key_string)
 	{
-		lua_pushlightuserdata(hash_map->luaState, hash_iterator->currentKey.thePointer);
+		return NULL;
 	}
-	/* Note: This could be either a number or integer since they are the same to Lua.
-	 * Since this is just for internal use, I don't need to distinguish.
-	 */
-	else if(LUA_TNUMBER == hash_iterator->keyType)
+	return Internal_GetValuePointerForKeyStringWithLength(hash_map, key_string, strlen(key_string));
+}
+
+static void* Internal_Unlocked_GetValuePointerForKeyStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length)
+{
+	if(NULL == hash_map)
 	{
-		lua_pushnumber(hash_map->luaState, hash_iterator->currentKey.theNumber);
+		return NULL;
 	}
-	else
+	if(NULL == key_string)
 	{
-		/* shouldn't get here */
-		LUAHASHMAP_ASSERT(false);
-		lua_pop(hash_map->luaState, 1);
-		return false;
+		return NULL;
 	}
+	return Internal_GetValuePointerForKeyStringWithLength(hash_map, key_string, key_string_length);
+}
 
-	if(lua_next(hash_map->luaState, -2) != 0) /* use index of table */
-	{
-		hash_iterator->atEnd = false;
-		hash_iterator->keyType = lua_type(hash_map->luaState, -2);
-		switch(hash_iterator->keyType)
-		{
-			case LUA_TSTRING:
+static lua_Number Internal_GetValueNumberForKeyStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length)
+{
+	lua_Number ret_val;
+	
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	lua_pushlstring(hash_map->luaState, key_string, key_string_length); /* stack: [key_string, table] */
+	LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_string]; stack: [value_number, table] */
+	ret_val = lua_tonumber(hash_map->luaState, -1);
+	
+	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 2);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);	
+	return ret_val;
+}
+
+static lua_Number Internal_Unlocked_GetValueNumberForKeyString(LuaHashMap* restrict hash_map, const char* restrict key_string)
+{
+	if(NULL == hash_map)
+	{
+		return (lua_Number)0.0;
+	}
+	if(NULL == key_string)
+	{
+		return (lua_Number)0.0;
+	}
+	return Internal_GetValueNumberForKeyStringWithLength(hash_map, key_string, strlen(key_string));	
+}
+
+static lua_Number Internal_Unlocked_GetValueNumberForKeyStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length)
+{
+	if(NULL == hash_map)
+	{
+		return (lua_Number)0.0;
+	}
+	if(NULL == key_string)
+	{
+		return (lua_Number)0.0;
+	}
+	return Internal_GetValueNumberForKeyStringWithLength(hash_map, key_string, key_string_length);
+}
+
+static lua_Integer Internal_GetValueIntegerForKeyStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length)
+{
+	lua_Integer ret_val;
+
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	lua_pushlstring(hash_map->luaState, key_string, key_string_length); /* stack: [key_string, table] */
+	LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_string]; stack: [value_integer, table] */
+	ret_val = Internal_ToInteger(hash_map, -1);
+	
+	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 2);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);	
+	return ret_val;
+}
+
+static lua_Integer Internal_Unlocked_GetValueIntegerForKeyString(LuaHashMap* restrict hash_map, const char* restrict key_string)
+{
+	if(NULL == hash_map)
+	{
+		return 0;
+	}
+	if(NULL == key_string)
+	{
+		return 0;
+	}
+	return Internal_GetValueIntegerForKeyStringWithLength(hash_map, key_string, strlen(key_string));
+}
+
+static lua_Integer Internal_Unlocked_GetValueIntegerForKeyStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length)
+{
+	if(NULL == hash_map)
+	{
+		return 0;
+	}
+	if(NULL == key_string)
+	{
+		return 0;
+	}
+	return Internal_GetValueIntegerForKeyStringWithLength(hash_map, key_string, key_string_length);
+}
+
+static const char* Internal_GetValueStringForKeyPointerWithLength(LuaHashMap* hash_map, void* key_pointer, size_t* value_string_length_return)
+{
+	const char* ret_val;
+	
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	lua_pushlightuserdata(hash_map->luaState, key_pointer); /* stack: [key_pointer, table] */
+	LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_pointer]; stack: [value_pointer, table] */
+	ret_val = lua_tolstring(hash_map->luaState, -1, value_string_length_return);
+	
+	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 2);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return ret_val;
+}
+
+static const char* Internal_Unlocked_GetValueStringForKeyPointer(LuaHashMap* hash_map, void* key_pointer)
+{
+	if(NULL == hash_map)
+	{
+		return NULL;
+	}
+	return Internal_GetValueStringForKeyPointerWithLength(hash_map, key_pointer, NULL);
+}
+
+static const char* Internal_Unlocked_GetValueStringForKeyPointerWithLength(LuaHashMap* hash_map, void* key_pointer, size_t* value_string_length_return)
+{
+	if(NULL == hash_map)
+	{
+		return NULL;
+	}
+	return Internal_GetValueStringForKeyPointerWithLength(hash_map, key_pointer, value_string_length_return);
+}
+
+static void* Internal_Unlocked_GetValuePointerForKeyPointer(LuaHashMap* hash_map, void* key_pointer)
+{
+	void* ret_val;
+	if(NULL == hash_map)
+	{
+		return NULL;
+	}
+
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	lua_pushlightuserdata(hash_map->luaState, key_pointer); /* stack: [key_pointer, table] */
+	LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_pointer]; stack: [value_pointer, table] */
+	ret_val = lua_touserdata(hash_map->luaState, -1);
+
+	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 2);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return ret_val;
+}
+
+static lua_Number Internal_Unlocked_GetValueNumberForKeyPointer(LuaHashMap* hash_map, void* key_pointer)
+{
+	lua_Number ret_val;
+	if(NULL == hash_map)
+	{
+		return 0.0;
+	}
+	
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	lua_pushlightuserdata(hash_map->luaState, key_pointer); /* stack: [key_pointer, table] */
+	LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_pointer]; stack: [value_pointer, table] */
+	ret_val = lua_tonumber(hash_map->luaState, -1);
+	
+	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 2);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return ret_val;
+}
+
+static lua_Integer Internal_Unlocked_GetValueIntegerForKeyPointer(LuaHashMap* hash_map, void* key_pointer)
+{
+	lua_Integer ret_val;
+	if(NULL == hash_map)
+	{
+		return 0;
+	}
+	
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	lua_pushlightuserdata(hash_map->luaState, key_pointer); /* stack: [key_pointer, table] */
+	LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_pointer]; stack: [value_pointer, table] */
+	ret_val = Internal_ToInteger(hash_map, -1);
+	
+	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 2);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return ret_val;
+}
+
+static const char* Internal_GetValueStringForKeyNumberWithLength(LuaHashMap* restrict hash_map, lua_Number key_number, size_t* restrict value_string_length_return)
+{
+	const char* ret_val;
+
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	lua_pushnumber(hash_map->luaState, key_number); /* stack: [key_number, table] */
+	LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_number]; stack: [value_pointer, table] */
+	ret_val = lua_tolstring(hash_map->luaState, -1, value_string_length_return);
+	
+	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 2);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return ret_val;
+}
+
+static const char* Internal_Unlocked_GetValueStringForKeyNumber(LuaHashMap* hash_map, lua_Number key_number)
+{
+	if(NULL == hash_map)
+	{
+		return NULL;
+	}
+	return Internal_GetValueStringForKeyNumberWithLength(hash_map, key_number, NULL);
+}
+
+static const char* Internal_Unlocked_GetValueStringForKeyNumberWithLength(LuaHashMap* restrict hash_map, lua_Number key_number, size_t* restrict value_string_length_return)
+{
+	if(NULL == hash_map)
+	{
+		return NULL;
+	}
+	return Internal_GetValueStringForKeyNumberWithLength(hash_map, key_number, value_string_length_return);
+}
+
+static void* Internal_Unlocked_GetValuePointerForKeyNumber(LuaHashMap* hash_map, lua_Number key_number)
+{
+	void* ret_val;
+	if(NULL == hash_map)
+	{
+		return NULL;
+	}
+	
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	lua_pushnumber(hash_map->luaState, key_number); /* stack: [key_number, table] */
+	LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_number]; stack: [value_pointer, table] */
+	ret_val = lua_touserdata(hash_map->luaState, -1);
+	
+	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 2);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return ret_val;
+}
+
+static lua_Number Internal_Unlocked_GetValueNumberForKeyNumber(LuaHashMap* hash_map, lua_Number key_number)
+{
+	lua_Number ret_val;
+	if(NULL == hash_map)
+	{
+		return 0.0;
+	}
+	
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	lua_pushnumber(hash_map->luaState, key_number); /* stack: [key_number, table] */
+	LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_number]; stack: [value_number, table] */
+	ret_val = lua_tonumber(hash_map->luaState, -1);
+	
+	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 2);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return ret_val;
+}
+
+static lua_Integer Internal_Unlocked_GetValueIntegerForKeyNumber(LuaHashMap* hash_map, lua_Number key_number)
+{
+	lua_Integer ret_val;
+	if(NULL == hash_map)
+	{
+		return 0;
+	}
+	
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	lua_pushnumber(hash_map->luaState, key_number); /* stack: [key_number, table] */
+	LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_number]; stack: [value_integer, table] */
+	ret_val = Internal_ToInteger(hash_map, -1);
+	
+	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 2);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return ret_val;
+}
+
+static const char* Internal_GetValueStringForKeyIntegerWithLength(LuaHashMap* restrict hash_map, lua_Integer key_integer, size_t* restrict value_string_length_return)
+{
+	const char* ret_val;
+	
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	Internal_GetTableForKeyInteger(hash_map, key_integer); /* table[key_integer]; stack: [value_string, table] */
+	ret_val = lua_tolstring(hash_map->luaState, -1, value_string_length_return);
+	
+	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 2);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return ret_val;
+}
+
+static const char* Internal_Unlocked_GetValueStringForKeyInteger(LuaHashMap* hash_map, lua_Integer key_integer)
+{
+	if(NULL == hash_map)
+	{
+		return NULL;
+	}
+	return Internal_GetValueStringForKeyIntegerWithLength(hash_map, key_integer, NULL);
+}
+
+static const char* Internal_Unlocked_GetValueStringForKeyIntegerWithLength(LuaHashMap* restrict hash_map, lua_Integer key_integer, size_t* restrict value_string_length_return)
+{
+	if(NULL == hash_map)
+	{
+		return NULL;
+	}
+	return Internal_GetValueStringForKeyIntegerWithLength(hash_map, key_integer, value_string_length_return);
+}
+
+static void* Internal_Unlocked_GetValuePointerForKeyInteger(LuaHashMap* hash_map, lua_Integer key_integer)
+{
+	void* ret_val;
+	if(NULL == hash_map)
+	{
+		return NULL;
+	}
+	
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	Internal_GetTableForKeyInteger(hash_map, key_integer); /* table[key_integer]; stack: [value_pointer, table] */
+	ret_val = lua_touserdata(hash_map->luaState, -1);
+	
+	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 2);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return ret_val;
+}
+
+static lua_Number Internal_Unlocked_GetValueNumberForKeyInteger(LuaHashMap* hash_map, lua_Integer key_integer)
+{
+	lua_Number ret_val;
+	if(NULL == hash_map)
+	{
+		return 0.0;
+	}
+	
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	Internal_GetTableForKeyInteger(hash_map, key_integer); /* table[key_integer]; stack: [value_number, table] */
+	ret_val = lua_tonumber(hash_map->luaState, -1);
+	
+	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 2);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return ret_val;
+}
+
+static lua_Integer Internal_Unlocked_GetValueIntegerForKeyInteger(LuaHashMap* hash_map, lua_Integer key_integer)
+{
+	lua_Integer ret_val;
+	if(NULL == hash_map)
+	{
+		return 0;
+	}
+	
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	Internal_GetTableForKeyInteger(hash_map, key_integer); /* table[key_integer]; stack: [value_integer, table] */
+	ret_val = Internal_ToInteger(hash_map, -1);
+	
+	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 2);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return ret_val;
+}
+
+
+
+/* Batch versions of the GetValueForKey family. These fetch the table once and look up all the keys through it. */
+static void Internal_SetBitmap(unsigned char found_bitmap[], size_t bit_index, bool is_set)
+{
+	if(NULL == found_bitmap)
+	{
+		return;
+	}
+	if(is_set)
+	{
+		found_bitmap[bit_index/8] |= (unsigned char)(1u << (bit_index%8));
+	}
+	else
+	{
+		found_bitmap[bit_index/8] &= (unsigned char)~(1u << (bit_index%8));
+	}
+}
+
+/* The TryGet family does a single look up and reports both presence and value.
+ * The Internal_PushValueForKey* helpers leave stack: [value, table]
+ * and the Internal_TryGetValue*AndPop helpers read the value and pop both.
+ */
+static LUAHASHMAP_INLINE void Internal_PushValueForKeyString(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length)
+{
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	lua_pushlstring(hash_map->luaState, key_string, key_string_length); /* stack: [key_string, table] */
+	LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_string]; stack: [value, table] */
+}
+
+static LUAHASHMAP_INLINE void Internal_PushValueForKeyPointer(LuaHashMap* hash_map, void* key_pointer)
+{
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	lua_pushlightuserdata(hash_map->luaState, key_pointer); /* stack: [key_pointer, table] */
+	LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_pointer]; stack: [value, table] */
+}
+
+static LUAHASHMAP_INLINE void Internal_PushValueForKeyNumber(LuaHashMap* hash_map, lua_Number key_number)
+{
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	lua_pushnumber(hash_map->luaState, key_number); /* stack: [key_number, table] */
+	LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_number]; stack: [value, table] */
+}
+
+static LUAHASHMAP_INLINE void Internal_PushValueForKeyInteger(LuaHashMap* hash_map, lua_Integer key_integer)
+{
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	Internal_GetTableForKeyInteger(hash_map, key_integer); /* table[key_integer]; stack: [value, table] */
+}
+
+/* Expects stack: [value, table]. Returns true if the value is not nil. */
+static LUAHASHMAP_INLINE bool Internal_TryGetValueType(LuaHashMap* hash_map, int* value_type_return)
+{
+	int value_type = lua_type(hash_map->luaState, -1);
+#if LUA_VERSION_NUM < 503
+	/* Report exact integer mode integers as numbers just like the iterators do. */
+	if((LUA_TLIGHTUSERDATA == value_type) && (true == hash_map->useExactIntegers))
+	{
+		value_type = LUA_TNUMBER;
+	}
+#endif
+	if(NULL != value_type_return)
+	{
+		*value_type_return = (LUA_TNIL == value_type) ? LUA_TNONE : value_type;
+	}
+	return (LUA_TNIL != value_type);
+}
+
+static bool Internal_TryGetValueStringAndPop(LuaHashMap* restrict hash_map, const char** restrict value_string_return, size_t* restrict value_string_length_return, int* restrict value_type_return)
+{
+	bool is_found = Internal_TryGetValueType(hash_map, value_type_return);
+	const char* value_string = lua_tolstring(hash_map->luaState, -1, value_string_length_return);
+	if(NULL != value_string_return)
+	{
+		*value_string_return = value_string;
+	}
+	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 2);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return is_found;
+}
+
+static bool Internal_TryGetValuePointerAndPop(LuaHashMap* restrict hash_map, void** restrict value_pointer_return, int* restrict value_type_return)
+{
+	bool is_found = Internal_TryGetValueType(hash_map, value_type_return);
+	if(NULL != value_pointer_return)
+	{
+		*value_pointer_return = lua_touserdata(hash_map->luaState, -1);
+	}
+	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 2);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return is_found;
+}
+
+static bool Internal_TryGetValueNumberAndPop(LuaHashMap* restrict hash_map, lua_Number* restrict value_number_return, int* restrict value_type_return)
+{
+	bool is_found = Internal_TryGetValueType(hash_map, value_type_return);
+	if(NULL != value_number_return)
+	{
+		*value_number_return = lua_tonumber(hash_map->luaState, -1);
+	}
+	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 2);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return is_found;
+}
+
+static bool Internal_TryGetValueIntegerAndPop(LuaHashMap* restrict hash_map, lua_Integer* restrict value_integer_return, int* restrict value_type_return)
+{
+	bool is_found = Internal_TryGetValueType(hash_map, value_type_return);
+	if(NULL != value_integer_return)
+	{
+		*value_integer_return = Internal_ToInteger(hash_map, -1);
+	}
+	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 2);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return is_found;
+}
+
+static bool Internal_Unlocked_TryGetValueStringForKeyString(LuaHashMap* restrict hash_map, const char* restrict key_string, const char** restrict value_string_return, int* restrict value_type_return)
+{
+	if((NULL == hash_map) || (NULL == key_string))
+	{
+		if(NULL != value_string_return)
+		{
+			*value_string_return = NULL;
+		}
+		if(NULL != value_type_return)
+		{
+			*value_type_return = LUA_TNONE;
+		}
+		return false;
+	}
+	Internal_PushValueForKeyString(hash_map, key_string, strlen(key_string)); /* stack: [value, table] */
+	return Internal_TryGetValueStringAndPop(hash_map, value_string_return, NULL, value_type_return);
+}
+
+static bool Internal_Unlocked_TryGetValueStringForKeyStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length, const char** restrict value_string_return, size_t* restrict value_string_length_return, int* restrict value_type_return)
+{
+	if((NULL == hash_map) || (NULL == key_string))
+	{
+		if(NULL != value_string_return)
+		{
+			*value_string_return = NULL;
+		}
+		if(NULL != value_string_length_return)
+		{
+			*value_string_length_return = 0;
+		}
+		if(NULL != value_type_return)
+		{
+			*value_type_return = LUA_TNONE;
+		}
+		return false;
+	}
+	Internal_PushValueForKeyString(hash_map, key_string, key_string_length); /* stack: [value, table] */
+	return Internal_TryGetValueStringAndPop(hash_map, value_string_return, value_string_length_return, value_type_return);
+}
+
+static bool Internal_Unlocked_TryGetValuePointerForKeyString(LuaHashMap* restrict hash_map, const char* restrict key_string, void** restrict value_pointer_return, int* restrict value_type_return)
+{
+	if((NULL == hash_map) || (NULL == key_string))
+	{
+		if(NULL != value_pointer_return)
+		{
+			*value_pointer_return = NULL;
+		}
+		if(NULL != value_type_return)
+		{
+			*value_type_return = LUA_TNONE;
+		}
+		return false;
+	}
+	Internal_PushValueForKeyString(hash_map, key_string, strlen(key_string)); /* stack: [value, table] */
+	return Internal_TryGetValuePointerAndPop(hash_map, value_pointer_return, value_type_return);
+}
+
+static bool Internal_Unlocked_TryGetValuePointerForKeyStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length, void** restrict value_pointer_return, int* restrict value_type_return)
+{
+	if((NULL == hash_map) || (NULL == key_string))
+	{
+		if(NULL != value_pointer_return)
+		{
+			*value_pointer_return = NULL;
+		}
+		if(NULL != value_type_return)
+		{
+			*value_type_return = LUA_TNONE;
+		}
+		return false;
+	}
+	Internal_PushValueForKeyString(hash_map, key_string, key_string_length); /* stack: [value, table] */
+	return Internal_TryGetValuePointerAndPop(hash_map, value_pointer_return, value_type_return);
+}
+
+static bool Internal_Unlocked_TryGetValueNumberForKeyString(LuaHashMap* restrict hash_map, const char* restrict key_string, lua_Number* restrict value_number_return, int* restrict value_type_return)
+{
+	if((NULL == hash_map) || (NULL == key_string))
+	{
+		if(NULL != value_number_return)
+		{
+			*value_number_return = 0.0;
+		}
+		if(NULL != value_type_return)
+		{
+			*value_type_return = LUA_TNONE;
+		}
+		return false;
+	}
+	Internal_PushValueForKeyString(hash_map, key_string, strlen(key_string)); /* stack: [value, table] */
+	return Internal_TryGetValueNumberAndPop(hash_map, value_number_return, value_type_return);
+}
+
+static bool Internal_Unlocked_TryGetValueNumberForKeyStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length, lua_Number* restrict value_number_return, int* restrict value_type_return)
+{
+	if((NULL == hash_map) || (NULL == key_string))
+	{
+		if(NULL != value_number_return)
+		{
+			*value_number_return = 0.0;
+		}
+		if(NULL != value_type_return)
+		{
+			*value_type_return = LUA_TNONE;
+		}
+		return false;
+	}
+	Internal_PushValueForKeyString(hash_map, key_string, key_string_length); /* stack: [value, table] */
+	return Internal_TryGetValueNumberAndPop(hash_map, value_number_return, value_type_return);
+}
+
+static bool Internal_Unlocked_TryGetValueIntegerForKeyString(LuaHashMap* restrict hash_map, const char* restrict key_string, lua_Integer* restrict value_integer_return, int* restrict value_type_return)
+{
+	if((NULL == hash_map) || (NULL == key_string))
+	{
+		if(NULL != value_integer_return)
+		{
+			*value_integer_return = 0;
+		}
+		if(NULL != value_type_return)
+		{
+			*value_type_return = LUA_TNONE;
+		}
+		return false;
+	}
+	Internal_PushValueForKeyString(hash_map, key_string, strlen(key_string)); /* stack: [value, table] */
+	return Internal_TryGetValueIntegerAndPop(hash_map, value_integer_return, value_type_return);
+}
+
+static bool Internal_Unlocked_TryGetValueIntegerForKeyStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length, lua_Integer* restrict value_integer_return, int* restrict value_type_return)
+{
+	if((NULL == hash_map) || (NULL == key_string))
+	{
+		if(NULL != value_integer_return)
+		{
+			*value_integer_return = 0;
+		}
+		if(NULL != value_type_return)
+		{
+			*value_type_return = LUA_TNONE;
+		}
+		return false;
+	}
+	Internal_PushValueForKeyString(hash_map, key_string, key_string_length); /* stack: [value, table] */
+	return Internal_TryGetValueIntegerAndPop(hash_map, value_integer_return, value_type_return);
+}
+
+static bool Internal_Unlocked_TryGetValueStringForKeyPointer(LuaHashMap* hash_map, void* key_pointer, const char** value_string_return, int* value_type_return)
+{
+	if(NULL == hash_map)
+	{
+		if(NULL != value_string_return)
+		{
+			*value_string_return = NULL;
+		}
+		if(NULL != value_type_return)
+		{
+			*value_type_return = LUA_TNONE;
+		}
+		return false;
+	}
+	Internal_PushValueForKeyPointer(hash_map, key_pointer); /* stack: [value, table] */
+	return Internal_TryGetValueStringAndPop(hash_map, value_string_return, NULL, value_type_return);
+}
+
+static bool Internal_Unlocked_TryGetValueStringForKeyPointerWithLength(LuaHashMap* hash_map, void* key_pointer, const char** value_string_return, size_t* value_string_length_return, int* value_type_return)
+{
+	if(NULL == hash_map)
+	{
+		if(NULL != value_string_return)
+		{
+			*value_string_return = NULL;
+		}
+		if(NULL != value_string_length_return)
+		{
+			*value_string_length_return = 0;
+		}
+		if(NULL != value_type_return)
+		{
+			*value_type_return = LUA_TNONE;
+		}
+		return false;
+	}
+	Internal_PushValueForKeyPointer(hash_map, key_pointer); /* stack: [value, table] */
+	return Internal_TryGetValueStringAndPop(hash_map, value_string_return, value_string_length_return, value_type_return);
+}
+
+static bool Internal_Unlocked_TryGetValuePointerForKeyPointer(LuaHashMap* hash_map, void* key_pointer, void** value_pointer_return, int* value_type_return)
+{
+	if(NULL == hash_map)
+	{
+		if(NULL != value_pointer_return)
+		{
+			*value_pointer_return = NULL;
+		}
+		if(NULL != value_type_return)
+		{
+			*value_type_return = LUA_TNONE;
+		}
+		return false;
+	}
+	Internal_PushValueForKeyPointer(hash_map, key_pointer); /* stack: [value, table] */
+	return Internal_TryGetValuePointerAndPop(hash_map, value_pointer_return, value_type_return);
+}
+
+static bool Internal_Unlocked_TryGetValueNumberForKeyPointer(LuaHashMap* hash_map, void* key_pointer, lua_Number* value_number_return, int* value_type_return)
+{
+	if(NULL == hash_map)
+	{
+		if(NULL != value_number_return)
+		{
+			*value_number_return = 0.0;
+		}
+		if(NULL != value_type_return)
+		{
+			*value_type_return = LUA_TNONE;
+		}
+		return false;
+	}
+	Internal_PushValueForKeyPointer(hash_map, key_pointer); /* stack: [value, table] */
+	return Internal_TryGetValueNumberAndPop(hash_map, value_number_return, value_type_return);
+}
+
+static bool Internal_Unlocked_TryGetValueIntegerForKeyPointer(LuaHashMap* hash_map, void* key_pointer, lua_Integer* value_integer_return, int* value_type_return)
+{
+	if(NULL == hash_map)
+	{
+		if(NULL != value_integer_return)
+		{
+			*value_integer_return = 0;
+		}
+		if(NULL != value_type_return)
+		{
+			*value_type_return = LUA_TNONE;
+		}
+		return false;
+	}
+	Internal_PushValueForKeyPointer(hash_map, key_pointer); /* stack: [value, table] */
+	return Internal_TryGetValueIntegerAndPop(hash_map, value_integer_return, value_type_return);
+}
+
+static bool Internal_Unlocked_TryGetValueStringForKeyNumber(LuaHashMap* restrict hash_map, lua_Number key_number, const char** restrict value_string_return, int* restrict value_type_return)
+{
+	if(NULL == hash_map)
+	{
+		if(NULL != value_string_return)
+		{
+			*value_string_return = NULL;
+		}
+		if(NULL != value_type_return)
+		{
+			*value_type_return = LUA_TNONE;
+		}
+		return false;
+	}
+	Internal_PushValueForKeyNumber(hash_map, key_number); /* stack: [value, table] */
+	return Internal_TryGetValueStringAndPop(hash_map, value_string_return, NULL, value_type_return);
+}
+
+static bool Internal_Unlocked_TryGetValueStringForKeyNumberWithLength(LuaHashMap* restrict hash_map, lua_Number key_number, const char** restrict value_string_return, size_t* restrict value_string_length_return, int* restrict value_type_return)
+{
+	if(NULL == hash_map)
+	{
+		if(NULL != value_string_return)
+		{
+			*value_string_return = NULL;
+		}
+		if(NULL != value_string_length_return)
+		{
+			*value_string_length_return = 0;
+		}
+		if(NULL != value_type_return)
+		{
+			*value_type_return = LUA_TNONE;
+		}
+		return false;
+	}
+	Internal_PushValueForKeyNumber(hash_map, key_number); /* stack: [value, table] */
+	return Internal_TryGetValueStringAndPop(hash_map, value_string_return, value_string_length_return, value_type_return);
+}
+
+static bool Internal_Unlocked_TryGetValuePointerForKeyNumber(LuaHashMap* restrict hash_map, lua_Number key_number, void** restrict value_pointer_return, int* restrict value_type_return)
+{
+	if(NULL == hash_map)
+	{
+		if(NULL != value_pointer_return)
+		{
+			*value_pointer_return = NULL;
+		}
+		if(NULL != value_type_return)
+		{
+			*value_type_return = LUA_TNONE;
+		}
+		return false;
+	}
+	Internal_PushValueForKeyNumber(hash_map, key_number); /* stack: [value, table] */
+	return Internal_TryGetValuePointerAndPop(hash_map, value_pointer_return, value_type_return);
+}
+
+static bool Internal_Unlocked_TryGetValueNumberForKeyNumber(LuaHashMap* restrict hash_map, lua_Number key_number, lua_Number* restrict value_number_return, int* restrict value_type_return)
+{
+	if(NULL == hash_map)
+	{
+		if(NULL != value_number_return)
+		{
+			*value_number_return = 0.0;
+		}
+		if(NULL != value_type_return)
+		{
+			*value_type_return = LUA_TNONE;
+		}
+		return false;
+	}
+	Internal_PushValueForKeyNumber(hash_map, key_number); /* stack: [value, table] */
+	return Internal_TryGetValueNumberAndPop(hash_map, value_number_return, value_type_return);
+}
+
+static bool Internal_Unlocked_TryGetValueIntegerForKeyNumber(LuaHashMap* restrict hash_map, lua_Number key_number, lua_Integer* restrict value_integer_return, int* restrict value_type_return)
+{
+	if(NULL == hash_map)
+	{
+		if(NULL != value_integer_return)
+		{
+			*value_integer_return = 0;
+		}
+		if(NULL != value_type_return)
+		{
+			*value_type_return = LUA_TNONE;
+		}
+		return false;
+	}
+	Internal_PushValueForKeyNumber(hash_map, key_number); /* stack: [value, table] */
+	return Internal_TryGetValueIntegerAndPop(hash_map, value_integer_return, value_type_return);
+}
+
+static bool Internal_Unlocked_TryGetValueStringForKeyInteger(LuaHashMap* restrict hash_map, lua_Integer key_integer, const char** restrict value_string_return, int* restrict value_type_return)
+{
+	if(NULL == hash_map)
+	{
+		if(NULL != value_string_return)
+		{
+			*value_string_return = NULL;
+		}
+		if(NULL != value_type_return)
+		{
+			*value_type_return = LUA_TNONE;
+		}
+		return false;
+	}
+	Internal_PushValueForKeyInteger(hash_map, key_integer); /* stack: [value, table] */
+	return Internal_TryGetValueStringAndPop(hash_map, value_string_return, NULL, value_type_return);
+}
+
+static bool Internal_Unlocked_TryGetValueStringForKeyIntegerWithLength(LuaHashMap* restrict hash_map, lua_Integer key_integer, const char** restrict value_string_return, size_t* restrict value_string_length_return, int* restrict value_type_return)
+{
+	if(NULL == hash_map)
+	{
+		if(NULL != value_string_return)
+		{
+			*value_string_return = NULL;
+		}
+		if(NULL != value_string_length_return)
+		{
+			*value_string_length_return = 0;
+		}
+		if(NULL != value_type_return)
+		{
+			*value_type_return = LUA_TNONE;
+		}
+		return false;
+	}
+	Internal_PushValueForKeyInteger(hash_map, key_integer); /* stack: [value, table] */
+	return Internal_TryGetValueStringAndPop(hash_map, value_string_return, value_string_length_return, value_type_return);
+}
+
+static bool Internal_Unlocked_TryGetValuePointerForKeyInteger(LuaHashMap* restrict hash_map, lua_Integer key_integer, void** restrict value_pointer_return, int* restrict value_type_return)
+{
+	if(NULL == hash_map)
+	{
+		if(NULL != value_pointer_return)
+		{
+			*value_pointer_return = NULL;
+		}
+		if(NULL != value_type_return)
+		{
+			*value_type_return = LUA_TNONE;
+		}
+		return false;
+	}
+	Internal_PushValueForKeyInteger(hash_map, key_integer); /* stack: [value, table] */
+	return Internal_TryGetValuePointerAndPop(hash_map, value_pointer_return, value_type_return);
+}
+
+static bool Internal_Unlocked_TryGetValueNumberForKeyInteger(LuaHashMap* restrict hash_map, lua_Integer key_integer, lua_Number* restrict value_number_return, int* restrict value_type_return)
+{
+	if(NULL == hash_map)
+	{
+		if(NULL != value_number_return)
+		{
+			*value_number_return = 0.0;
+		}
+		if(NULL != value_type_return)
+		{
+			*value_type_return = LUA_TNONE;
+		}
+		return false;
+	}
+	Internal_PushValueForKeyInteger(hash_map, key_integer); /* stack: [value, table] */
+	return Internal_TryGetValueNumberAndPop(hash_map, value_number_return, value_type_return);
+}
+
+static bool Internal_Unlocked_TryGetValueIntegerForKeyInteger(LuaHashMap* restrict hash_map, lua_Integer key_integer, lua_Integer* restrict value_integer_return, int* restrict value_type_return)
+{
+	if(NULL == hash_map)
+	{
+		if(NULL != value_integer_return)
+		{
+			*value_integer_return = 0;
+		}
+		if(NULL != value_type_return)
+		{
+			*value_type_return = LUA_TNONE;
+		}
+		return false;
+	}
+	Internal_PushValueForKeyInteger(hash_map, key_integer); /* stack: [value, table] */
+	return Internal_TryGetValueIntegerAndPop(hash_map, value_integer_return, value_type_return);
+}
+
+
+/* Returns the string on top of the stack, or NULL (and length 0) for anything that isn't a string.
+ * lua_tolstring would convert a number into a new string that nothing references once it is popped, 
+ * so a later lua_pushlstring in the same batch could collect it while an earlier values_array entry still points at it.
+ */
+static LUAHASHMAP_INLINE const char* Internal_ToBatchValueString(LuaHashMap* hash_map, size_t* value_length_return)
+{
+	if(LUA_TSTRING != lua_type(hash_map->luaState, -1))
+	{
+		if(NULL != value_length_return)
+		{
+			*value_length_return = 0;
+		}
+		return NULL;
+	}
+	return lua_tolstring(hash_map->luaState, -1, value_length_return);
+}
+
+static size_t Internal_Unlocked_GetValuesStringForKeysString(LuaHashMap* hash_map, const char* values_array[], const char* keys_array[], size_t value_lengths_array[], const size_t key_lengths_array[], unsigned char found_bitmap[], size_t number_of_elements)
+{
+	size_t i;
+	size_t total_found = 0;
+	if(NULL == hash_map)
+	{
+		return 0;
+	}
+	if((NULL == values_array) || (NULL == keys_array))
+	{
+		return 0;
+	}
+
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	for(i=0; i<number_of_elements; i++)
+	{
+		if(NULL == keys_array[i])
+		{
+			values_array[i] = NULL;
+			if(NULL != value_lengths_array)
+			{
+				value_lengths_array[i] = 0;
+			}
+			Internal_SetBitmap(found_bitmap, i, false);
+			continue;
+		}
+		lua_pushlstring(hash_map->luaState, keys_array[i], (NULL == key_lengths_array) ? strlen(keys_array[i]) : key_lengths_array[i]); /* stack: [key_string, table] */
+		LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_string]; stack: [value_string, table] */
+		if(LUA_TNIL == lua_type(hash_map->luaState, -1))
+		{
+			Internal_SetBitmap(found_bitmap, i, false);
+		}
+		else
+		{
+			Internal_SetBitmap(found_bitmap, i, true);
+			total_found++;
+		}
+		values_array[i] = Internal_ToBatchValueString(hash_map, (NULL == value_lengths_array) ? NULL : &value_lengths_array[i]);
+		/* pop the value; keep the table for the next key */
+		lua_pop(hash_map->luaState, 1); /* stack: [table] */
+	}
+
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return total_found;
+}
+
+static size_t Internal_Unlocked_GetValuesPointerForKeysString(LuaHashMap* hash_map, void* values_array[], const char* keys_array[], const size_t key_lengths_array[], unsigned char found_bitmap[], size_t number_of_elements)
+{
+	size_t i;
+	size_t total_found = 0;
+	if(NULL == hash_map)
+	{
+		return 0;
+	}
+	if((NULL == values_array) || (NULL == keys_array))
+	{
+		return 0;
+	}
+
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	for(i=0; i<number_of_elements; i++)
+	{
+		if(NULL == keys_array[i])
+		{
+			values_array[i] = NULL;
+			Internal_SetBitmap(found_bitmap, i, false);
+			continue;
+		}
+		lua_pushlstring(hash_map->luaState, keys_array[i], (NULL == key_lengths_array) ? strlen(keys_array[i]) : key_lengths_array[i]); /* stack: [key_string, table] */
+		LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_string]; stack: [value_pointer, table] */
+		if(LUA_TNIL == lua_type(hash_map->luaState, -1))
+		{
+			Internal_SetBitmap(found_bitmap, i, false);
+		}
+		else
+		{
+			Internal_SetBitmap(found_bitmap, i, true);
+			total_found++;
+		}
+		values_array[i] = lua_touserdata(hash_map->luaState, -1);
+		/* pop the value; keep the table for the next key */
+		lua_pop(hash_map->luaState, 1); /* stack: [table] */
+	}
+
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return total_found;
+}
+
+static size_t Internal_Unlocked_GetValuesNumberForKeysString(LuaHashMap* hash_map, lua_Number values_array[], const char* keys_array[], const size_t key_lengths_array[], unsigned char found_bitmap[], size_t number_of_elements)
+{
+	size_t i;
+	size_t total_found = 0;
+	if(NULL == hash_map)
+	{
+		return 0;
+	}
+	if((NULL == values_array) || (NULL == keys_array))
+	{
+		return 0;
+	}
+
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	for(i=0; i<number_of_elements; i++)
+	{
+		if(NULL == keys_array[i])
+		{
+			values_array[i] = (lua_Number)0.0;
+			Internal_SetBitmap(found_bitmap, i, false);
+			continue;
+		}
+		lua_pushlstring(hash_map->luaState, keys_array[i], (NULL == key_lengths_array) ? strlen(keys_array[i]) : key_lengths_array[i]); /* stack: [key_string, table] */
+		LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_string]; stack: [value_number, table] */
+		if(LUA_TNIL == lua_type(hash_map->luaState, -1))
+		{
+			Internal_SetBitmap(found_bitmap, i, false);
+		}
+		else
+		{
+			Internal_SetBitmap(found_bitmap, i, true);
+			total_found++;
+		}
+		values_array[i] = lua_tonumber(hash_map->luaState, -1);
+		/* pop the value; keep the table for the next key */
+		lua_pop(hash_map->luaState, 1); /* stack: [table] */
+	}
+
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return total_found;
+}
+
+static size_t Internal_Unlocked_GetValuesIntegerForKeysString(LuaHashMap* hash_map, lua_Integer values_array[], const char* keys_array[], const size_t key_lengths_array[], unsigned char found_bitmap[], size_t number_of_elements)
+{
+	size_t i;
+	size_t total_found = 0;
+	if(NULL == hash_map)
+	{
+		return 0;
+	}
+	if((NULL == values_array) || (NULL == keys_array))
+	{
+		return 0;
+	}
+
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	for(i=0; i<number_of_elements; i++)
+	{
+		if(NULL == keys_array[i])
+		{
+			values_array[i] = 0;
+			Internal_SetBitmap(found_bitmap, i, false);
+			continue;
+		}
+		lua_pushlstring(hash_map->luaState, keys_array[i], (NULL == key_lengths_array) ? strlen(keys_array[i]) : key_lengths_array[i]); /* stack: [key_string, table] */
+		LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_string]; stack: [value_integer, table] */
+		if(LUA_TNIL == lua_type(hash_map->luaState, -1))
+		{
+			Internal_SetBitmap(found_bitmap, i, false);
+		}
+		else
+		{
+			Internal_SetBitmap(found_bitmap, i, true);
+			total_found++;
+		}
+		values_array[i] = Internal_ToInteger(hash_map, -1);
+		/* pop the value; keep the table for the next key */
+		lua_pop(hash_map->luaState, 1); /* stack: [table] */
+	}
+
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return total_found;
+}
+
+static size_t Internal_Unlocked_GetValuesStringForKeysPointer(LuaHashMap* hash_map, const char* values_array[], void* keys_array[], size_t value_lengths_array[], unsigned char found_bitmap[], size_t number_of_elements)
+{
+	size_t i;
+	size_t total_found = 0;
+	if(NULL == hash_map)
+	{
+		return 0;
+	}
+	if((NULL == values_array) || (NULL == keys_array))
+	{
+		return 0;
+	}
+
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	for(i=0; i<number_of_elements; i++)
+	{
+		lua_pushlightuserdata(hash_map->luaState, keys_array[i]); /* stack: [key_pointer, table] */
+		LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_pointer]; stack: [value_string, table] */
+		if(LUA_TNIL == lua_type(hash_map->luaState, -1))
+		{
+			Internal_SetBitmap(found_bitmap, i, false);
+		}
+		else
+		{
+			Internal_SetBitmap(found_bitmap, i, true);
+			total_found++;
+		}
+		values_array[i] = Internal_ToBatchValueString(hash_map, (NULL == value_lengths_array) ? NULL : &value_lengths_array[i]);
+		/* pop the value; keep the table for the next key */
+		lua_pop(hash_map->luaState, 1); /* stack: [table] */
+	}
+
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return total_found;
+}
+
+static size_t Internal_Unlocked_GetValuesPointerForKeysPointer(LuaHashMap* hash_map, void* values_array[], void* keys_array[], unsigned char found_bitmap[], size_t number_of_elements)
+{
+	size_t i;
+	size_t total_found = 0;
+	if(NULL == hash_map)
+	{
+		return 0;
+	}
+	if((NULL == values_array) || (NULL == keys_array))
+	{
+		return 0;
+	}
+
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	for(i=0; i<number_of_elements; i++)
+	{
+		lua_pushlightuserdata(hash_map->luaState, keys_array[i]); /* stack: [key_pointer, table] */
+		LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_pointer]; stack: [value_pointer, table] */
+		if(LUA_TNIL == lua_type(hash_map->luaState, -1))
+		{
+			Internal_SetBitmap(found_bitmap, i, false);
+		}
+		else
+		{
+			Internal_SetBitmap(found_bitmap, i, true);
+			total_found++;
+		}
+		values_array[i] = lua_touserdata(hash_map->luaState, -1);
+		/* pop the value; keep the table for the next key */
+		lua_pop(hash_map->luaState, 1); /* stack: [table] */
+	}
+
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return total_found;
+}
+
+static size_t Internal_Unlocked_GetValuesNumberForKeysPointer(LuaHashMap* hash_map, lua_Number values_array[], void* keys_array[], unsigned char found_bitmap[], size_t number_of_elements)
+{
+	size_t i;
+	size_t total_found = 0;
+	if(NULL == hash_map)
+	{
+		return 0;
+	}
+	if((NULL == values_array) || (NULL == keys_array))
+	{
+		return 0;
+	}
+
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	for(i=0; i<number_of_elements; i++)
+	{
+		lua_pushlightuserdata(hash_map->luaState, keys_array[i]); /* stack: [key_pointer, table] */
+		LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_pointer]; stack: [value_number, table] */
+		if(LUA_TNIL == lua_type(hash_map->luaState, -1))
+		{
+			Internal_SetBitmap(found_bitmap, i, false);
+		}
+		else
+		{
+			Internal_SetBitmap(found_bitmap, i, true);
+			total_found++;
+		}
+		values_array[i] = lua_tonumber(hash_map->luaState, -1);
+		/* pop the value; keep the table for the next key */
+		lua_pop(hash_map->luaState, 1); /* stack: [table] */
+	}
+
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return total_found;
+}
+
+static size_t Internal_Unlocked_GetValuesIntegerForKeysPointer(LuaHashMap* hash_map, lua_Integer values_array[], void* keys_array[], unsigned char found_bitmap[], size_t number_of_elements)
+{
+	size_t i;
+	size_t total_found = 0;
+	if(NULL == hash_map)
+	{
+		return 0;
+	}
+	if((NULL == values_array) || (NULL == keys_array))
+	{
+		return 0;
+	}
+
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	for(i=0; i<number_of_elements; i++)
+	{
+		lua_pushlightuserdata(hash_map->luaState, keys_array[i]); /* stack: [key_pointer, table] */
+		LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_pointer]; stack: [value_integer, table] */
+		if(LUA_TNIL == lua_type(hash_map->luaState, -1))
+		{
+			Internal_SetBitmap(found_bitmap, i, false);
+		}
+		else
+		{
+			Internal_SetBitmap(found_bitmap, i, true);
+			total_found++;
+		}
+		values_array[i] = Internal_ToInteger(hash_map, -1);
+		/* pop the value; keep the table for the next key */
+		lua_pop(hash_map->luaState, 1); /* stack: [table] */
+	}
+
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return total_found;
+}
+
+static size_t Internal_Unlocked_GetValuesStringForKeysNumber(LuaHashMap* hash_map, const char* values_array[], const lua_Number keys_array[], size_t value_lengths_array[], unsigned char found_bitmap[], size_t number_of_elements)
+{
+	size_t i;
+	size_t total_found = 0;
+	if(NULL == hash_map)
+	{
+		return 0;
+	}
+	if((NULL == values_array) || (NULL == keys_array))
+	{
+		return 0;
+	}
+
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	for(i=0; i<number_of_elements; i++)
+	{
+		lua_pushnumber(hash_map->luaState, keys_array[i]); /* stack: [key_number, table] */
+		LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_number]; stack: [value_string, table] */
+		if(LUA_TNIL == lua_type(hash_map->luaState, -1))
+		{
+			Internal_SetBitmap(found_bitmap, i, false);
+		}
+		else
+		{
+			Internal_SetBitmap(found_bitmap, i, true);
+			total_found++;
+		}
+		values_array[i] = Internal_ToBatchValueString(hash_map, (NULL == value_lengths_array) ? NULL : &value_lengths_array[i]);
+		/* pop the value; keep the table for the next key */
+		lua_pop(hash_map->luaState, 1); /* stack: [table] */
+	}
+
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return total_found;
+}
+
+static size_t Internal_Unlocked_GetValuesPointerForKeysNumber(LuaHashMap* hash_map, void* values_array[], const lua_Number keys_array[], unsigned char found_bitmap[], size_t number_of_elements)
+{
+	size_t i;
+	size_t total_found = 0;
+	if(NULL == hash_map)
+	{
+		return 0;
+	}
+	if((NULL == values_array) || (NULL == keys_array))
+	{
+		return 0;
+	}
+
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	for(i=0; i<number_of_elements; i++)
+	{
+		lua_pushnumber(hash_map->luaState, keys_array[i]); /* stack: [key_number, table] */
+		LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_number]; stack: [value_pointer, table] */
+		if(LUA_TNIL == lua_type(hash_map->luaState, -1))
+		{
+			Internal_SetBitmap(found_bitmap, i, false);
+		}
+		else
+		{
+			Internal_SetBitmap(found_bitmap, i, true);
+			total_found++;
+		}
+		values_array[i] = lua_touserdata(hash_map->luaState, -1);
+		/* pop the value; keep the table for the next key */
+		lua_pop(hash_map->luaState, 1); /* stack: [table] */
+	}
+
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return total_found;
+}
+
+static size_t Internal_Unlocked_GetValuesNumberForKeysNumber(LuaHashMap* hash_map, lua_Number values_array[], const lua_Number keys_array[], unsigned char found_bitmap[], size_t number_of_elements)
+{
+	size_t i;
+	size_t total_found = 0;
+	if(NULL == hash_map)
+	{
+		return 0;
+	}
+	if((NULL == values_array) || (NULL == keys_array))
+	{
+		return 0;
+	}
+
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	for(i=0; i<number_of_elements; i++)
+	{
+		lua_pushnumber(hash_map->luaState, keys_array[i]); /* stack: [key_number, table] */
+		LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_number]; stack: [value_number, table] */
+		if(LUA_TNIL == lua_type(hash_map->luaState, -1))
+		{
+			Internal_SetBitmap(found_bitmap, i, false);
+		}
+		else
+		{
+			Internal_SetBitmap(found_bitmap, i, true);
+			total_found++;
+		}
+		values_array[i] = lua_tonumber(hash_map->luaState, -1);
+		/* pop the value; keep the table for the next key */
+		lua_pop(hash_map->luaState, 1); /* stack: [table] */
+	}
+
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return total_found;
+}
+
+static size_t Internal_Unlocked_GetValuesIntegerForKeysNumber(LuaHashMap* hash_map, lua_Integer values_array[], const lua_Number keys_array[], unsigned char found_bitmap[], size_t number_of_elements)
+{
+	size_t i;
+	size_t total_found = 0;
+	if(NULL == hash_map)
+	{
+		return 0;
+	}
+	if((NULL == values_array) || (NULL == keys_array))
+	{
+		return 0;
+	}
+
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	for(i=0; i<number_of_elements; i++)
+	{
+		lua_pushnumber(hash_map->luaState, keys_array[i]); /* stack: [key_number, table] */
+		LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_number]; stack: [value_integer, table] */
+		if(LUA_TNIL == lua_type(hash_map->luaState, -1))
+		{
+			Internal_SetBitmap(found_bitmap, i, false);
+		}
+		else
+		{
+			Internal_SetBitmap(found_bitmap, i, true);
+			total_found++;
+		}
+		values_array[i] = Internal_ToInteger(hash_map, -1);
+		/* pop the value; keep the table for the next key */
+		lua_pop(hash_map->luaState, 1); /* stack: [table] */
+	}
+
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return total_found;
+}
+
+static size_t Internal_Unlocked_GetValuesStringForKeysInteger(LuaHashMap* hash_map, const char* values_array[], const lua_Integer keys_array[], size_t value_lengths_array[], unsigned char found_bitmap[], size_t number_of_elements)
+{
+	size_t i;
+	size_t total_found = 0;
+	if(NULL == hash_map)
+	{
+		return 0;
+	}
+	if((NULL == values_array) || (NULL == keys_array))
+	{
+		return 0;
+	}
+
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	for(i=0; i<number_of_elements; i++)
+	{
+		Internal_GetTableForKeyInteger(hash_map, keys_array[i]); /* table[key_integer]; stack: [value_string, table] */
+		if(LUA_TNIL == lua_type(hash_map->luaState, -1))
+		{
+			Internal_SetBitmap(found_bitmap, i, false);
+		}
+		else
+		{
+			Internal_SetBitmap(found_bitmap, i, true);
+			total_found++;
+		}
+		values_array[i] = Internal_ToBatchValueString(hash_map, (NULL == value_lengths_array) ? NULL : &value_lengths_array[i]);
+		/* pop the value; keep the table for the next key */
+		lua_pop(hash_map->luaState, 1); /* stack: [table] */
+	}
+
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return total_found;
+}
+
+static size_t Internal_Unlocked_GetValuesPointerForKeysInteger(LuaHashMap* hash_map, void* values_array[], const lua_Integer keys_array[], unsigned char found_bitmap[], size_t number_of_elements)
+{
+	size_t i;
+	size_t total_found = 0;
+	if(NULL == hash_map)
+	{
+		return 0;
+	}
+	if((NULL == values_array) || (NULL == keys_array))
+	{
+		return 0;
+	}
+
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	for(i=0; i<number_of_elements; i++)
+	{
+		Internal_GetTableForKeyInteger(hash_map, keys_array[i]); /* table[key_integer]; stack: [value_pointer, table] */
+		if(LUA_TNIL == lua_type(hash_map->luaState, -1))
+		{
+			Internal_SetBitmap(found_bitmap, i, false);
+		}
+		else
+		{
+			Internal_SetBitmap(found_bitmap, i, true);
+			total_found++;
+		}
+		values_array[i] = lua_touserdata(hash_map->luaState, -1);
+		/* pop the value; keep the table for the next key */
+		lua_pop(hash_map->luaState, 1); /* stack: [table] */
+	}
+
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return total_found;
+}
+
+static size_t Internal_Unlocked_GetValuesNumberForKeysInteger(LuaHashMap* hash_map, lua_Number values_array[], const lua_Integer keys_array[], unsigned char found_bitmap[], size_t number_of_elements)
+{
+	size_t i;
+	size_t total_found = 0;
+	if(NULL == hash_map)
+	{
+		return 0;
+	}
+	if((NULL == values_array) || (NULL == keys_array))
+	{
+		return 0;
+	}
+
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	for(i=0; i<number_of_elements; i++)
+	{
+		Internal_GetTableForKeyInteger(hash_map, keys_array[i]); /* table[key_integer]; stack: [value_number, table] */
+		if(LUA_TNIL == lua_type(hash_map->luaState, -1))
+		{
+			Internal_SetBitmap(found_bitmap, i, false);
+		}
+		else
+		{
+			Internal_SetBitmap(found_bitmap, i, true);
+			total_found++;
+		}
+		values_array[i] = lua_tonumber(hash_map->luaState, -1);
+		/* pop the value; keep the table for the next key */
+		lua_pop(hash_map->luaState, 1); /* stack: [table] */
+	}
+
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return total_found;
+}
+
+static size_t Internal_Unlocked_GetValuesIntegerForKeysInteger(LuaHashMap* hash_map, lua_Integer values_array[], const lua_Integer keys_array[], unsigned char found_bitmap[], size_t number_of_elements)
+{
+	size_t i;
+	size_t total_found = 0;
+	if(NULL == hash_map)
+	{
+		return 0;
+	}
+	if((NULL == values_array) || (NULL == keys_array))
+	{
+		return 0;
+	}
+
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	for(i=0; i<number_of_elements; i++)
+	{
+		Internal_GetTableForKeyInteger(hash_map, keys_array[i]); /* table[key_integer]; stack: [value_integer, table] */
+		if(LUA_TNIL == lua_type(hash_map->luaState, -1))
+		{
+			Internal_SetBitmap(found_bitmap, i, false);
+		}
+		else
+		{
+			Internal_SetBitmap(found_bitmap, i, true);
+			total_found++;
+		}
+		values_array[i] = Internal_ToInteger(hash_map, -1);
+		/* pop the value; keep the table for the next key */
+		lua_pop(hash_map->luaState, 1); /* stack: [table] */
+	}
+
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return total_found;
+}
+
+static void Internal_RemoveKeyStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length)
+{
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	lua_pushlstring(hash_map->luaState, key_string, key_string_length); /* stack: [key_string, table] */
+	lua_pushnil(hash_map->luaState); /* stack: [nil, key_string, table] */
+	Internal_SetTableAndUpdateCount(hash_map);  /* table[key_string]=nil; stack: [table] */
+	
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);	
+}
+
+static void Internal_Unlocked_RemoveKeyString(LuaHashMap* restrict hash_map, const char* restrict key_string)
+{
+	if(NULL == hash_map)
+	{
+		return;
+	}
+	if(NULL == key_string)
+	{
+		return;
+	}
+	Internal_RemoveKeyStringWithLength(hash_map, key_string, strlen(key_string));
+}
+
+static void Internal_Unlocked_RemoveKeyStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length)
+{
+	if(NULL == hash_map)
+	{
+		return;
+	}
+	if(NULL == key_string)
+	{
+		return;
+	}
+	Internal_RemoveKeyStringWithLength(hash_map, key_string, key_string_length);
+}
+
+static void Internal_Unlocked_RemoveKeyPointer(LuaHashMap* hash_map, void* key_pointer)
+{
+	if(NULL == hash_map)
+	{
+		return;
+	}
+
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	lua_pushlightuserdata(hash_map->luaState, key_pointer); /* stack: [key_pointer, table] */
+	lua_pushnil(hash_map->luaState); /* stack: [nil, key_pointer, table] */
+	Internal_SetTableAndUpdateCount(hash_map);  /* table[key_pointer]=nil; stack: [table] */
+
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+}
+
+static void Internal_Unlocked_RemoveKeyNumber(LuaHashMap* hash_map, lua_Number key_number)
+{
+	if(NULL == hash_map)
+	{
+		return;
+	}
+	
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	lua_pushnumber(hash_map->luaState, key_number); /* stack: [key_number, table] */
+	lua_pushnil(hash_map->luaState); /* stack: [nil, key_number, table] */
+	Internal_SetTableAndUpdateCount(hash_map);  /* table[key_number]=nil; stack: [table] */
+	
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+}
+
+static void Internal_Unlocked_RemoveKeyInteger(LuaHashMap* hash_map, lua_Integer key_integer)
+{
+	if(NULL == hash_map)
+	{
+		return;
+	}
+	
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	lua_pushnil(hash_map->luaState); /* stack: [nil, table] */
+	Internal_SetTableForKeyIntegerAndUpdateCount(hash_map, key_integer);  /* table[key_integer]=nil; stack: [table] */
+	
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+}
+
+/* The Increment, GetOrSet and Take families do a read and a write with a single key push.
+ * The Internal_PushTableAndKey* helpers leave stack: [key, table]. The key stays on the stack for both the
+ * look up and the write back so strings are only hashed and internalized once.
+ * The Internal_*ForPushedKeyAndPop helpers finish the operation and pop both.
+ * Integer keys that rawgeti/rawseti can take aren't pushed at all (see Internal_PushTableAndIndexKeyInteger).
+ * For those, the helpers get the key as key_index and the stack is just [table]. key_index is NULL when the key was pushed.
+ */
+static LUAHASHMAP_INLINE void Internal_PushTableAndKeyString(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length)
+{
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	lua_pushlstring(hash_map->luaState, key_string, key_string_length); /* stack: [key_string, table] */
+}
+
+static LUAHASHMAP_INLINE void Internal_PushTableAndKeyPointer(LuaHashMap* hash_map, void* key_pointer)
+{
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	lua_pushlightuserdata(hash_map->luaState, key_pointer); /* stack: [key_pointer, table] */
+}
+
+static LUAHASHMAP_INLINE void Internal_PushTableAndKeyNumber(LuaHashMap* hash_map, lua_Number key_number)
+{
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	lua_pushnumber(hash_map->luaState, key_number); /* stack: [key_number, table] */
+}
+
+/* Leaves stack: [table] and returns key_integer as the key_index if rawgeti/rawseti can use it.
+ * Otherwise this pushes the key like the other Internal_PushTableAndKey* helpers (stack: [key_integer, table]) and returns NULL.
+ */
+static LUAHASHMAP_INLINE const lua_Integer* Internal_PushTableAndIndexKeyInteger(LuaHashMap* hash_map, const lua_Integer* key_integer)
+{
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	if(Internal_IsIntegerKeyIndexable(*key_integer))
+	{
+		return key_integer;
+	}
+	Internal_PushInteger(hash_map, *key_integer); /* stack: [key_integer, table] */
+	return NULL;
+}
+
+/* Expects stack: [key, table] and leaves stack: [old_value, key, table]. Returns true if the old value is not nil. */
+static LUAHASHMAP_INLINE bool Internal_ProbePushedKey(LuaHashMap* hash_map)
+{
+	lua_pushvalue(hash_map->luaState, -1); /* stack: [key, key, table] */
+	LUAHASHMAP_GETTABLE(hash_map->luaState, -3);  /* table[key]; stack: [old_value, key, table] */
+	return (LUA_TNIL != lua_type(hash_map->luaState, -1));
+}
+
+/* Internal_ProbePushedKey, or rawgeti for a key_index. Leaves stack: [old_value, key, table] or [old_value, table]. */
+static LUAHASHMAP_INLINE bool Internal_ProbeKey(LuaHashMap* hash_map, const lua_Integer* key_index)
+{
+#if defined(LUAHASHMAP_GETTABLEI)
+	if(NULL != key_index)
+	{
+		LUAHASHMAP_GETTABLEI(hash_map->luaState, -1, (LuaHashMap_InternalIndexType)*key_index); /* stack: [old_value, table] */
+		return (LUA_TNIL != lua_type(hash_map->luaState, -1));
+	}
+#endif
+	(void)key_index;
+	return Internal_ProbePushedKey(hash_map);
+}
+
+/* Like Internal_SetTableAndUpdateCount, but the caller already probed the old value so we don't look it up again.
+ * Expects stack: [value, key, table] (or [value, table] for a key_index) and leaves stack: [table].
+ */
+static LUAHASHMAP_INLINE void Internal_SetProbedKeyAndUpdateCount(LuaHashMap* hash_map, const lua_Integer* key_index, bool had_value)
+{
+	bool has_value = (LUA_TNIL != lua_type(hash_map->luaState, -1));
+#if defined(LUAHASHMAP_SETTABLEI)
+	if(NULL != key_index)
+	{
+		LUAHASHMAP_SETTABLEI(hash_map->luaState, -2, (LuaHashMap_InternalIndexType)*key_index); /* table[key_index]=value; stack: [table] */
+		Internal_UpdateCount(hash_map, had_value, has_value);
+		return;
+	}
+#endif
+	(void)key_index;
+	LUAHASHMAP_SETTABLE(hash_map->luaState, -3);  /* table[key]=value; stack: [table] */
+	Internal_UpdateCount(hash_map, had_value, has_value);
+}
+
+/* Pops the key (unless there is a key_index) and the table. */
+static LUAHASHMAP_INLINE void Internal_PopKeyAndTable(LuaHashMap* hash_map, const lua_Integer* key_index)
+{
+	lua_pop(hash_map->luaState, (NULL == key_index) ? 2 : 1);
+}
+
+/* Reads the current value for Increment. A missing (nil) value is 0 so the first increment creates the key.
+ * Returns false for anything else that isn't an integer: strings, pointers, and numbers with no exact integer value.
+ */
+static LUAHASHMAP_INLINE bool Internal_ToIncrementableInteger(LuaHashMap* restrict hash_map, int stack_index, lua_Integer* restrict integer_return)
+{
+	switch(lua_type(hash_map->luaState, stack_index))
+	{
+		case LUA_TNIL:
+		{
+			*integer_return = 0;
+			return true;
+		}
+		case LUA_TNUMBER:
+		{
+#if LUA_VERSION_NUM >= 503
+			int is_integral;
+			*integer_return = lua_tointegerx(hash_map->luaState, stack_index, &is_integral);
+			return (0 != is_integral);
+#else
+			/* lua_tointeger would silently truncate 2.5, so check it converts exactly like lua_tointegerx does in 5.3. 
+			 * The range check comes first since converting an out of range (or NaN) number is undefined.
+			 */
+			const lua_Number integer_limit = (lua_Number)((lua_Integer)1 << (sizeof(lua_Integer)*CHAR_BIT - 2)) * 2;
+			lua_Number the_number = lua_tonumber(hash_map->luaState, stack_index);
+			if(!((the_number >= -integer_limit) && (the_number < integer_limit)))
+			{
+				return false;
+			}
+			*integer_return = (lua_Integer)the_number;
+			return ((lua_Number)*integer_return == the_number);
+#endif
+		}
+#if LUA_VERSION_NUM < 503
+		case LUA_TLIGHTUSERDATA:
+		{
+			if(true == hash_map->useExactIntegers)
+			{
+				*integer_return = Internal_ToInteger(hash_map, stack_index);
+				return true;
+			}
+			return false;
+		}
+#endif
+		default:
+		{
+			return false;
+		}
+	}
+}
+
+static bool Internal_IncrementIntegerForPushedKeyAndPop(LuaHashMap* restrict hash_map, const lua_Integer* key_index, lua_Integer delta, lua_Integer* restrict value_integer_return)
+{
+	lua_Integer old_value;
+	bool had_value = Internal_ProbeKey(hash_map, key_index); /* stack: [old_value, key, table] */
+
+	/* Signed overflow is undefined behavior so check before adding. */
+	if((false == Internal_ToIncrementableInteger(hash_map, -1, &old_value))
+		|| ((delta > 0) && (old_value > LUAHASHMAP_INTEGER_MAX - delta))
+		|| ((delta < 0) && (old_value < LUAHASHMAP_INTEGER_MIN - delta))
+	)
+	{
+		/* Leave the value alone. old_value, key and table are still on top of stack. */
+		lua_pop(hash_map->luaState, 1); /* stack: [key, table] */
+		Internal_PopKeyAndTable(hash_map, key_index);
+		LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+		return false;
+	}
+
+	lua_pop(hash_map->luaState, 1); /* stack: [key, table] */
+	Internal_PushInteger(hash_map, old_value + delta); /* stack: [value_integer, key, table] */
+	Internal_SetProbedKeyAndUpdateCount(hash_map, key_index, had_value); /* table[key]=value_integer; stack: [table] */
+
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	if(NULL != value_integer_return)
+	{
+		*value_integer_return = old_value + delta;
+	}
+	return true;
+}
+
+static const char* Internal_GetOrSetValueStringForPushedKeyAndPop(LuaHashMap* hash_map, const lua_Integer* key_index, const char* value_string, size_t value_string_length)
+{
+	const char* ret_val;
+
+	if(true == Internal_ProbeKey(hash_map, key_index)) /* stack: [old_value, key, table] */
+	{
+		ret_val = lua_tostring(hash_map->luaState, -1);
+		/* old_value, key and table are still on top of stack. Don't forget to pop them now that we are done with them */
+		lua_pop(hash_map->luaState, 1);
+		Internal_PopKeyAndTable(hash_map, key_index);
+	}
+	else
+	{
+		lua_pop(hash_map->luaState, 1); /* stack: [key, table] */
+		lua_pushlstring(hash_map->luaState, value_string, value_string_length); /* stack: [value_string, key, table] */
+		/* Return the Lua internalized string which stays valid as long as it is in the table. */
+		ret_val = lua_tostring(hash_map->luaState, -1);
+		Internal_SetProbedKeyAndUpdateCount(hash_map, key_index, false); /* table[key]=value_string; stack: [table] */
+		/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+		lua_pop(hash_map->luaState, 1);
+	}
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return ret_val;
+}
+
+static void* Internal_GetOrSetValuePointerForPushedKeyAndPop(LuaHashMap* hash_map, const lua_Integer* key_index, void* value_pointer)
+{
+	void* ret_val;
+
+	if(true == Internal_ProbeKey(hash_map, key_index)) /* stack: [old_value, key, table] */
+	{
+		ret_val = lua_touserdata(hash_map->luaState, -1);
+		/* old_value, key and table are still on top of stack. Don't forget to pop them now that we are done with them */
+		lua_pop(hash_map->luaState, 1);
+		Internal_PopKeyAndTable(hash_map, key_index);
+	}
+	else
+	{
+		lua_pop(hash_map->luaState, 1); /* stack: [key, table] */
+		lua_pushlightuserdata(hash_map->luaState, value_pointer); /* stack: [value_pointer, key, table] */
+		ret_val = value_pointer;
+		Internal_SetProbedKeyAndUpdateCount(hash_map, key_index, false); /* table[key]=value_pointer; stack: [table] */
+		/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+		lua_pop(hash_map->luaState, 1);
+	}
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return ret_val;
+}
+
+static lua_Number Internal_GetOrSetValueNumberForPushedKeyAndPop(LuaHashMap* hash_map, const lua_Integer* key_index, lua_Number value_number)
+{
+	lua_Number ret_val;
+
+	if(true == Internal_ProbeKey(hash_map, key_index)) /* stack: [old_value, key, table] */
+	{
+		ret_val = lua_tonumber(hash_map->luaState, -1);
+		/* old_value, key and table are still on top of stack. Don't forget to pop them now that we are done with them */
+		lua_pop(hash_map->luaState, 1);
+		Internal_PopKeyAndTable(hash_map, key_index);
+	}
+	else
+	{
+		lua_pop(hash_map->luaState, 1); /* stack: [key, table] */
+		lua_pushnumber(hash_map->luaState, value_number); /* stack: [value_number, key, table] */
+		ret_val = value_number;
+		Internal_SetProbedKeyAndUpdateCount(hash_map, key_index, false); /* table[key]=value_number; stack: [table] */
+		/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+		lua_pop(hash_map->luaState, 1);
+	}
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return ret_val;
+}
+
+static lua_Integer Internal_GetOrSetValueIntegerForPushedKeyAndPop(LuaHashMap* hash_map, const lua_Integer* key_index, lua_Integer value_integer)
+{
+	lua_Integer ret_val;
+
+	if(true == Internal_ProbeKey(hash_map, key_index)) /* stack: [old_value, key, table] */
+	{
+		ret_val = Internal_ToInteger(hash_map, -1);
+		/* old_value, key and table are still on top of stack. Don't forget to pop them now that we are done with them */
+		lua_pop(hash_map->luaState, 1);
+		Internal_PopKeyAndTable(hash_map, key_index);
+	}
+	else
+	{
+		lua_pop(hash_map->luaState, 1); /* stack: [key, table] */
+		Internal_PushInteger(hash_map, value_integer); /* stack: [value_integer, key, table] */
+		ret_val = value_integer;
+		Internal_SetProbedKeyAndUpdateCount(hash_map, key_index, false); /* table[key]=value_integer; stack: [table] */
+		/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+		lua_pop(hash_map->luaState, 1);
+	}
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return ret_val;
+}
+
+static void* Internal_TakeValuePointerForPushedKeyAndPop(LuaHashMap* hash_map, const lua_Integer* key_index)
+{
+	void* ret_val = NULL;
+
+	if(true == Internal_ProbeKey(hash_map, key_index)) /* stack: [old_value, key, table] */
+	{
+		ret_val = lua_touserdata(hash_map->luaState, -1);
+		lua_pop(hash_map->luaState, 1); /* stack: [key, table] */
+		lua_pushnil(hash_map->luaState); /* stack: [nil, key, table] */
+		Internal_SetProbedKeyAndUpdateCount(hash_map, key_index, true); /* table[key]=nil; stack: [table] */
+		/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+		lua_pop(hash_map->luaState, 1);
+	}
+	else
+	{
+		/* nil, key and table are still on top of stack. Don't forget to pop them now that we are done with them */
+		lua_pop(hash_map->luaState, 1);
+		Internal_PopKeyAndTable(hash_map, key_index);
+	}
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return ret_val;
+}
+
+static lua_Number Internal_TakeValueNumberForPushedKeyAndPop(LuaHashMap* hash_map, const lua_Integer* key_index)
+{
+	lua_Number ret_val = 0.0;
+
+	if(true == Internal_ProbeKey(hash_map, key_index)) /* stack: [old_value, key, table] */
+	{
+		ret_val = lua_tonumber(hash_map->luaState, -1);
+		lua_pop(hash_map->luaState, 1); /* stack: [key, table] */
+		lua_pushnil(hash_map->luaState); /* stack: [nil, key, table] */
+		Internal_SetProbedKeyAndUpdateCount(hash_map, key_index, true); /* table[key]=nil; stack: [table] */
+		/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+		lua_pop(hash_map->luaState, 1);
+	}
+	else
+	{
+		/* nil, key and table are still on top of stack. Don't forget to pop them now that we are done with them */
+		lua_pop(hash_map->luaState, 1);
+		Internal_PopKeyAndTable(hash_map, key_index);
+	}
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return ret_val;
+}
+
+static lua_Integer Internal_TakeValueIntegerForPushedKeyAndPop(LuaHashMap* hash_map, const lua_Integer* key_index)
+{
+	lua_Integer ret_val = 0;
+
+	if(true == Internal_ProbeKey(hash_map, key_index)) /* stack: [old_value, key, table] */
+	{
+		ret_val = Internal_ToInteger(hash_map, -1);
+		lua_pop(hash_map->luaState, 1); /* stack: [key, table] */
+		lua_pushnil(hash_map->luaState); /* stack: [nil, key, table] */
+		Internal_SetProbedKeyAndUpdateCount(hash_map, key_index, true); /* table[key]=nil; stack: [table] */
+		/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+		lua_pop(hash_map->luaState, 1);
+	}
+	else
+	{
+		/* nil, key and table are still on top of stack. Don't forget to pop them now that we are done with them */
+		lua_pop(hash_map->luaState, 1);
+		Internal_PopKeyAndTable(hash_map, key_index);
+	}
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return ret_val;
+}
+
+static bool Internal_Unlocked_IncrementIntegerForKeyString(LuaHashMap* restrict hash_map, const char* restrict key_string, lua_Integer delta, lua_Integer* restrict value_integer_return)
+{
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+	if(NULL == key_string)
+	{
+		return false;
+	}
+
+	Internal_PushTableAndKeyString(hash_map, key_string, strlen(key_string)); /* stack: [key_string, table] */
+	return Internal_IncrementIntegerForPushedKeyAndPop(hash_map, NULL, delta, value_integer_return);
+}
+
+static bool Internal_Unlocked_IncrementIntegerForKeyPointer(LuaHashMap* hash_map, void* key_pointer, lua_Integer delta, lua_Integer* restrict value_integer_return)
+{
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+
+	Internal_PushTableAndKeyPointer(hash_map, key_pointer); /* stack: [key_pointer, table] */
+	return Internal_IncrementIntegerForPushedKeyAndPop(hash_map, NULL, delta, value_integer_return);
+}
+
+static bool Internal_Unlocked_IncrementIntegerForKeyNumber(LuaHashMap* restrict hash_map, lua_Number key_number, lua_Integer delta, lua_Integer* restrict value_integer_return)
+{
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+
+	Internal_PushTableAndKeyNumber(hash_map, key_number); /* stack: [key_number, table] */
+	return Internal_IncrementIntegerForPushedKeyAndPop(hash_map, NULL, delta, value_integer_return);
+}
+
+static bool Internal_Unlocked_IncrementIntegerForKeyInteger(LuaHashMap* restrict hash_map, lua_Integer key_integer, lua_Integer delta, lua_Integer* restrict value_integer_return)
+{
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+
+	/* stack: [table], or [key_integer, table] if rawgeti/rawseti can't take key_integer */
+	return Internal_IncrementIntegerForPushedKeyAndPop(hash_map, Internal_PushTableAndIndexKeyInteger(hash_map, &key_integer), delta, value_integer_return);
+}
+
+static bool Internal_Unlocked_IncrementIntegerForKeyStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length, lua_Integer delta, lua_Integer* restrict value_integer_return)
+{
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+	if(NULL == key_string)
+	{
+		return false;
+	}
+
+	Internal_PushTableAndKeyString(hash_map, key_string, key_string_length); /* stack: [key_string, table] */
+	return Internal_IncrementIntegerForPushedKeyAndPop(hash_map, NULL, delta, value_integer_return);
+}
+
+static const char* Internal_Unlocked_GetOrSetValueStringForKeyString(LuaHashMap* restrict hash_map, const char* value_string, const char* restrict key_string)
+{
+	size_t value_string_length;
+
+	if(NULL == hash_map)
+	{
+		return NULL;
+	}
+	if(NULL == key_string)
+	{
+		return NULL;
+	}
+
+	value_string_length = (NULL == value_string) ? 0 : strlen(value_string);
+	Internal_PushTableAndKeyString(hash_map, key_string, strlen(key_string)); /* stack: [key_string, table] */
+	return Internal_GetOrSetValueStringForPushedKeyAndPop(hash_map, NULL, value_string, value_string_length);
+}
+
+static const char* Internal_Unlocked_GetOrSetValueStringForKeyStringWithLength(LuaHashMap* restrict hash_map, const char* value_string, const char* restrict key_string, size_t value_string_length, size_t key_string_length)
+{
+	if(NULL == hash_map)
+	{
+		return NULL;
+	}
+	if(NULL == key_string)
+	{
+		return NULL;
+	}
+
+	if(NULL == value_string)
+	{
+		value_string_length = 0;
+	}
+	Internal_PushTableAndKeyString(hash_map, key_string, key_string_length); /* stack: [key_string, table] */
+	return Internal_GetOrSetValueStringForPushedKeyAndPop(hash_map, NULL, value_string, value_string_length);
+}
+
+static const char* Internal_Unlocked_GetOrSetValueStringForKeyPointer(LuaHashMap* hash_map, const char* value_string, void* key_pointer)
+{
+	size_t value_string_length;
+
+	if(NULL == hash_map)
+	{
+		return NULL;
+	}
+
+	value_string_length = (NULL == value_string) ? 0 : strlen(value_string);
+	Internal_PushTableAndKeyPointer(hash_map, key_pointer); /* stack: [key_pointer, table] */
+	return Internal_GetOrSetValueStringForPushedKeyAndPop(hash_map, NULL, value_string, value_string_length);
+}
+
+static const char* Internal_Unlocked_GetOrSetValueStringForKeyPointerWithLength(LuaHashMap* hash_map, const char* value_string, void* key_pointer, size_t value_string_length)
+{
+	if(NULL == hash_map)
+	{
+		return NULL;
+	}
+
+	if(NULL == value_string)
+	{
+		value_string_length = 0;
+	}
+	Internal_PushTableAndKeyPointer(hash_map, key_pointer); /* stack: [key_pointer, table] */
+	return Internal_GetOrSetValueStringForPushedKeyAndPop(hash_map, NULL, value_string, value_string_length);
+}
+
+static const char* Internal_Unlocked_GetOrSetValueStringForKeyNumber(LuaHashMap* restrict hash_map, const char* value_string, lua_Number key_number)
+{
+	size_t value_string_length;
+
+	if(NULL == hash_map)
+	{
+		return NULL;
+	}
+
+	value_string_length = (NULL == value_string) ? 0 : strlen(value_string);
+	Internal_PushTableAndKeyNumber(hash_map, key_number); /* stack: [key_number, table] */
+	return Internal_GetOrSetValueStringForPushedKeyAndPop(hash_map, NULL, value_string, value_string_length);
+}
+
+static const char* Internal_Unlocked_GetOrSetValueStringForKeyNumberWithLength(LuaHashMap* restrict hash_map, const char* value_string, lua_Number key_number, size_t value_string_length)
+{
+	if(NULL == hash_map)
+	{
+		return NULL;
+	}
+
+	if(NULL == value_string)
+	{
+		value_string_length = 0;
+	}
+	Internal_PushTableAndKeyNumber(hash_map, key_number); /* stack: [key_number, table] */
+	return Internal_GetOrSetValueStringForPushedKeyAndPop(hash_map, NULL, value_string, value_string_length);
+}
+
+static const char* Internal_Unlocked_GetOrSetValueStringForKeyInteger(LuaHashMap* restrict hash_map, const char* value_string, lua_Integer key_integer)
+{
+	size_t value_string_length;
+
+	if(NULL == hash_map)
+	{
+		return NULL;
+	}
+
+	value_string_length = (NULL == value_string) ? 0 : strlen(value_string);
+	/* stack: [table], or [key_integer, table] if rawgeti/rawseti can't take key_integer */
+	return Internal_GetOrSetValueStringForPushedKeyAndPop(hash_map, Internal_PushTableAndIndexKeyInteger(hash_map, &key_integer), value_string, value_string_length);
+}
+
+static const char* Internal_Unlocked_GetOrSetValueStringForKeyIntegerWithLength(LuaHashMap* restrict hash_map, const char* value_string, lua_Integer key_integer, size_t value_string_length)
+{
+	if(NULL == hash_map)
+	{
+		return NULL;
+	}
+
+	if(NULL == value_string)
+	{
+		value_string_length = 0;
+	}
+	/* stack: [table], or [key_integer, table] if rawgeti/rawseti can't take key_integer */
+	return Internal_GetOrSetValueStringForPushedKeyAndPop(hash_map, Internal_PushTableAndIndexKeyInteger(hash_map, &key_integer), value_string, value_string_length);
+}
+
+static void* Internal_Unlocked_GetOrSetValuePointerForKeyString(LuaHashMap* hash_map, void* value_pointer, const char* key_string)
+{
+	if(NULL == hash_map)
+	{
+		return NULL;
+	}
+	if(NULL == key_string)
+	{
+		return NULL;
+	}
+
+	Internal_PushTableAndKeyString(hash_map, key_string, strlen(key_string)); /* stack: [key_string, table] */
+	return Internal_GetOrSetValuePointerForPushedKeyAndPop(hash_map, NULL, value_pointer);
+}
+
+static void* Internal_Unlocked_GetOrSetValuePointerForKeyStringWithLength(LuaHashMap* hash_map, void* value_pointer, const char* key_string, size_t key_string_length)
+{
+	if(NULL == hash_map)
+	{
+		return NULL;
+	}
+	if(NULL == key_string)
+	{
+		return NULL;
+	}
+
+	Internal_PushTableAndKeyString(hash_map, key_string, key_string_length); /* stack: [key_string, table] */
+	return Internal_GetOrSetValuePointerForPushedKeyAndPop(hash_map, NULL, value_pointer);
+}
+
+static void* Internal_Unlocked_GetOrSetValuePointerForKeyPointer(LuaHashMap* hash_map, void* value_pointer, void* key_pointer)
+{
+	if(NULL == hash_map)
+	{
+		return NULL;
+	}
+
+	Internal_PushTableAndKeyPointer(hash_map, key_pointer); /* stack: [key_pointer, table] */
+	return Internal_GetOrSetValuePointerForPushedKeyAndPop(hash_map, NULL, value_pointer);
+}
+
+static void* Internal_Unlocked_GetOrSetValuePointerForKeyNumber(LuaHashMap* hash_map, void* value_pointer, lua_Number key_number)
+{
+	if(NULL == hash_map)
+	{
+		return NULL;
+	}
+
+	Internal_PushTableAndKeyNumber(hash_map, key_number); /* stack: [key_number, table] */
+	return Internal_GetOrSetValuePointerForPushedKeyAndPop(hash_map, NULL, value_pointer);
+}
+
+static void* Internal_Unlocked_GetOrSetValuePointerForKeyInteger(LuaHashMap* hash_map, void* value_pointer, lua_Integer key_integer)
+{
+	if(NULL == hash_map)
+	{
+		return NULL;
+	}
+
+	/* stack: [table], or [key_integer, table] if rawgeti/rawseti can't take key_integer */
+	return Internal_GetOrSetValuePointerForPushedKeyAndPop(hash_map, Internal_PushTableAndIndexKeyInteger(hash_map, &key_integer), value_pointer);
+}
+
+static lua_Number Internal_Unlocked_GetOrSetValueNumberForKeyString(LuaHashMap* restrict hash_map, lua_Number value_number, const char* restrict key_string)
+{
+	if(NULL == hash_map)
+	{
+		return 0.0;
+	}
+	if(NULL == key_string)
+	{
+		return 0.0;
+	}
+
+	Internal_PushTableAndKeyString(hash_map, key_string, strlen(key_string)); /* stack: [key_string, table] */
+	return Internal_GetOrSetValueNumberForPushedKeyAndPop(hash_map, NULL, value_number);
+}
+
+static lua_Number Internal_Unlocked_GetOrSetValueNumberForKeyStringWithLength(LuaHashMap* restrict hash_map, lua_Number value_number, const char* restrict key_string, size_t key_string_length)
+{
+	if(NULL == hash_map)
+	{
+		return 0.0;
+	}
+	if(NULL == key_string)
+	{
+		return 0.0;
+	}
+
+	Internal_PushTableAndKeyString(hash_map, key_string, key_string_length); /* stack: [key_string, table] */
+	return Internal_GetOrSetValueNumberForPushedKeyAndPop(hash_map, NULL, value_number);
+}
+
+static lua_Number Internal_Unlocked_GetOrSetValueNumberForKeyPointer(LuaHashMap* hash_map, lua_Number value_number, void* key_pointer)
+{
+	if(NULL == hash_map)
+	{
+		return 0.0;
+	}
+
+	Internal_PushTableAndKeyPointer(hash_map, key_pointer); /* stack: [key_pointer, table] */
+	return Internal_GetOrSetValueNumberForPushedKeyAndPop(hash_map, NULL, value_number);
+}
+
+static lua_Number Internal_Unlocked_GetOrSetValueNumberForKeyNumber(LuaHashMap* restrict hash_map, lua_Number value_number, lua_Number key_number)
+{
+	if(NULL == hash_map)
+	{
+		return 0.0;
+	}
+
+	Internal_PushTableAndKeyNumber(hash_map, key_number); /* stack: [key_number, table] */
+	return Internal_GetOrSetValueNumberForPushedKeyAndPop(hash_map, NULL, value_number);
+}
+
+static lua_Number Internal_Unlocked_GetOrSetValueNumberForKeyInteger(LuaHashMap* restrict hash_map, lua_Number value_number, lua_Integer key_integer)
+{
+	if(NULL == hash_map)
+	{
+		return 0.0;
+	}
+
+	/* stack: [table], or [key_integer, table] if rawgeti/rawseti can't take key_integer */
+	return Internal_GetOrSetValueNumberForPushedKeyAndPop(hash_map, Internal_PushTableAndIndexKeyInteger(hash_map, &key_integer), value_number);
+}
+
+static lua_Integer Internal_Unlocked_GetOrSetValueIntegerForKeyString(LuaHashMap* restrict hash_map, lua_Integer value_integer, const char* restrict key_string)
+{
+	if(NULL == hash_map)
+	{
+		return 0;
+	}
+	if(NULL == key_string)
+	{
+		return 0;
+	}
+
+	Internal_PushTableAndKeyString(hash_map, key_string, strlen(key_string)); /* stack: [key_string, table] */
+	return Internal_GetOrSetValueIntegerForPushedKeyAndPop(hash_map, NULL, value_integer);
+}
+
+static lua_Integer Internal_Unlocked_GetOrSetValueIntegerForKeyStringWithLength(LuaHashMap* restrict hash_map, lua_Integer value_integer, const char* restrict key_string, size_t key_string_length)
+{
+	if(NULL == hash_map)
+	{
+		return 0;
+	}
+	if(NULL == key_string)
+	{
+		return 0;
+	}
+
+	Internal_PushTableAndKeyString(hash_map, key_string, key_string_length); /* stack: [key_string, table] */
+	return Internal_GetOrSetValueIntegerForPushedKeyAndPop(hash_map, NULL, value_integer);
+}
+
+static lua_Integer Internal_Unlocked_GetOrSetValueIntegerForKeyPointer(LuaHashMap* hash_map, lua_Integer value_integer, void* key_pointer)
+{
+	if(NULL == hash_map)
+	{
+		return 0;
+	}
+
+	Internal_PushTableAndKeyPointer(hash_map, key_pointer); /* stack: [key_pointer, table] */
+	return Internal_GetOrSetValueIntegerForPushedKeyAndPop(hash_map, NULL, value_integer);
+}
+
+static lua_Integer Internal_Unlocked_GetOrSetValueIntegerForKeyNumber(LuaHashMap* restrict hash_map, lua_Integer value_integer, lua_Number key_number)
+{
+	if(NULL == hash_map)
+	{
+		return 0;
+	}
+
+	Internal_PushTableAndKeyNumber(hash_map, key_number); /* stack: [key_number, table] */
+	return Internal_GetOrSetValueIntegerForPushedKeyAndPop(hash_map, NULL, value_integer);
+}
+
+static lua_Integer Internal_Unlocked_GetOrSetValueIntegerForKeyInteger(LuaHashMap* restrict hash_map, lua_Integer value_integer, lua_Integer key_integer)
+{
+	if(NULL == hash_map)
+	{
+		return 0;
+	}
+
+	/* stack: [table], or [key_integer, table] if rawgeti/rawseti can't take key_integer */
+	return Internal_GetOrSetValueIntegerForPushedKeyAndPop(hash_map, Internal_PushTableAndIndexKeyInteger(hash_map, &key_integer), value_integer);
+}
+
+static void* Internal_Unlocked_TakeValuePointerForKeyString(LuaHashMap* restrict hash_map, const char* restrict key_string)
+{
+	if(NULL == hash_map)
+	{
+		return NULL;
+	}
+	if(NULL == key_string)
+	{
+		return NULL;
+	}
+
+	Internal_PushTableAndKeyString(hash_map, key_string, strlen(key_string)); /* stack: [key_string, table] */
+	return Internal_TakeValuePointerForPushedKeyAndPop(hash_map, NULL);
+}
+
+static void* Internal_Unlocked_TakeValuePointerForKeyStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length)
+{
+	if(NULL == hash_map)
+	{
+		return NULL;
+	}
+	if(NULL == key_string)
+	{
+		return NULL;
+	}
+
+	Internal_PushTableAndKeyString(hash_map, key_string, key_string_length); /* stack: [key_string, table] */
+	return Internal_TakeValuePointerForPushedKeyAndPop(hash_map, NULL);
+}
+
+static void* Internal_Unlocked_TakeValuePointerForKeyPointer(LuaHashMap* hash_map, void* key_pointer)
+{
+	if(NULL == hash_map)
+	{
+		return NULL;
+	}
+
+	Internal_PushTableAndKeyPointer(hash_map, key_pointer); /* stack: [key_pointer, table] */
+	return Internal_TakeValuePointerForPushedKeyAndPop(hash_map, NULL);
+}
+
+static void* Internal_Unlocked_TakeValuePointerForKeyNumber(LuaHashMap* restrict hash_map, lua_Number key_number)
+{
+	if(NULL == hash_map)
+	{
+		return NULL;
+	}
+
+	Internal_PushTableAndKeyNumber(hash_map, key_number); /* stack: [key_number, table] */
+	return Internal_TakeValuePointerForPushedKeyAndPop(hash_map, NULL);
+}
+
+static void* Internal_Unlocked_TakeValuePointerForKeyInteger(LuaHashMap* restrict hash_map, lua_Integer key_integer)
+{
+	if(NULL == hash_map)
+	{
+		return NULL;
+	}
+
+	/* stack: [table], or [key_integer, table] if rawgeti/rawseti can't take key_integer */
+	return Internal_TakeValuePointerForPushedKeyAndPop(hash_map, Internal_PushTableAndIndexKeyInteger(hash_map, &key_integer));
+}
+
+static lua_Number Internal_Unlocked_TakeValueNumberForKeyString(LuaHashMap* restrict hash_map, const char* restrict key_string)
+{
+	if(NULL == hash_map)
+	{
+		return 0.0;
+	}
+	if(NULL == key_string)
+	{
+		return 0.0;
+	}
+
+	Internal_PushTableAndKeyString(hash_map, key_string, strlen(key_string)); /* stack: [key_string, table] */
+	return Internal_TakeValueNumberForPushedKeyAndPop(hash_map, NULL);
+}
+
+static lua_Number Internal_Unlocked_TakeValueNumberForKeyStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length)
+{
+	if(NULL == hash_map)
+	{
+		return 0.0;
+	}
+	if(NULL == key_string)
+	{
+		return 0.0;
+	}
+
+	Internal_PushTableAndKeyString(hash_map, key_string, key_string_length); /* stack: [key_string, table] */
+	return Internal_TakeValueNumberForPushedKeyAndPop(hash_map, NULL);
+}
+
+static lua_Number Internal_Unlocked_TakeValueNumberForKeyPointer(LuaHashMap* hash_map, void* key_pointer)
+{
+	if(NULL == hash_map)
+	{
+		return 0.0;
+	}
+
+	Internal_PushTableAndKeyPointer(hash_map, key_pointer); /* stack: [key_pointer, table] */
+	return Internal_TakeValueNumberForPushedKeyAndPop(hash_map, NULL);
+}
+
+static lua_Number Internal_Unlocked_TakeValueNumberForKeyNumber(LuaHashMap* restrict hash_map, lua_Number key_number)
+{
+	if(NULL == hash_map)
+	{
+		return 0.0;
+	}
+
+	Internal_PushTableAndKeyNumber(hash_map, key_number); /* stack: [key_number, table] */
+	return Internal_TakeValueNumberForPushedKeyAndPop(hash_map, NULL);
+}
+
+static lua_Number Internal_Unlocked_TakeValueNumberForKeyInteger(LuaHashMap* restrict hash_map, lua_Integer key_integer)
+{
+	if(NULL == hash_map)
+	{
+		return 0.0;
+	}
+
+	/* stack: [table], or [key_integer, table] if rawgeti/rawseti can't take key_integer */
+	return Internal_TakeValueNumberForPushedKeyAndPop(hash_map, Internal_PushTableAndIndexKeyInteger(hash_map, &key_integer));
+}
+
+static lua_Integer Internal_Unlocked_TakeValueIntegerForKeyString(LuaHashMap* restrict hash_map, const char* restrict key_string)
+{
+	if(NULL == hash_map)
+	{
+		return 0;
+	}
+	if(NULL == key_string)
+	{
+		return 0;
+	}
+
+	Internal_PushTableAndKeyString(hash_map, key_string, strlen(key_string)); /* stack: [key_string, table] */
+	return Internal_TakeValueIntegerForPushedKeyAndPop(hash_map, NULL);
+}
+
+static lua_Integer Internal_Unlocked_TakeValueIntegerForKeyStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length)
+{
+	if(NULL == hash_map)
+	{
+		return 0;
+	}
+	if(NULL == key_string)
+	{
+		return 0;
+	}
+
+	Internal_PushTableAndKeyString(hash_map, key_string, key_string_length); /* stack: [key_string, table] */
+	return Internal_TakeValueIntegerForPushedKeyAndPop(hash_map, NULL);
+}
+
+static lua_Integer Internal_Unlocked_TakeValueIntegerForKeyPointer(LuaHashMap* hash_map, void* key_pointer)
+{
+	if(NULL == hash_map)
+	{
+		return 0;
+	}
+
+	Internal_PushTableAndKeyPointer(hash_map, key_pointer); /* stack: [key_pointer, table] */
+	return Internal_TakeValueIntegerForPushedKeyAndPop(hash_map, NULL);
+}
+
+static lua_Integer Internal_Unlocked_TakeValueIntegerForKeyNumber(LuaHashMap* restrict hash_map, lua_Number key_number)
+{
+	if(NULL == hash_map)
+	{
+		return 0;
+	}
+
+	Internal_PushTableAndKeyNumber(hash_map, key_number); /* stack: [key_number, table] */
+	return Internal_TakeValueIntegerForPushedKeyAndPop(hash_map, NULL);
+}
+
+static lua_Integer Internal_Unlocked_TakeValueIntegerForKeyInteger(LuaHashMap* restrict hash_map, lua_Integer key_integer)
+{
+	if(NULL == hash_map)
+	{
+		return 0;
+	}
+
+	/* stack: [table], or [key_integer, table] if rawgeti/rawseti can't take key_integer */
+	return Internal_TakeValueIntegerForPushedKeyAndPop(hash_map, Internal_PushTableAndIndexKeyInteger(hash_map, &key_integer));
+}
+
+/* Shared by the CompareAndSetValueForKey and RemoveKeyIfValue families.
+ * Expects stack: [value, expected_value, key, table] (or [value, expected_value, table] for a key_index, see Internal_PushTableAndIndexKeyInteger) 
+ * and pops all of them.
+ * Sets table[key]=value only if the current value is equal (lua_rawequal) to expected_value, with a single look up.
+ * A nil value makes this a conditional remove. A missing key never matches.
+ */
+static bool Internal_CompareAndSetPushedValueAndPop(LuaHashMap* hash_map, const lua_Integer* key_index)
+{
+	bool is_equal;
+
+#if defined(LUAHASHMAP_GETTABLEI)
+	if(NULL != key_index)
+	{
+		LUAHASHMAP_GETTABLEI(hash_map->luaState, -3, (LuaHashMap_InternalIndexType)*key_index);  /* table[key_index]; stack: [old_value, value, expected_value, table] */
+	}
+	else
+#endif
+	{
+		lua_pushvalue(hash_map->luaState, -3); /* stack: [key, value, expected_value, key, table] */
+		LUAHASHMAP_GETTABLE(hash_map->luaState, -5);  /* table[key]; stack: [old_value, value, expected_value, key, table] */
+	}
+	is_equal = (LUA_TNIL != lua_type(hash_map->luaState, -1)) && (0 != lua_rawequal(hash_map->luaState, -1, -3));
+	lua_pop(hash_map->luaState, 1); /* stack: [value, expected_value, key, table] */
+	lua_remove(hash_map->luaState, -2); /* stack: [value, key, table] */
+	if(true == is_equal)
+	{
+		Internal_SetProbedKeyAndUpdateCount(hash_map, key_index, true); /* table[key]=value; stack: [table] */
+		/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+		lua_pop(hash_map->luaState, 1);
+	}
+	else
+	{
+		/* value, key and table are still on top of stack. Don't forget to pop them now that we are done with them */
+		lua_pop(hash_map->luaState, 1);
+		Internal_PopKeyAndTable(hash_map, key_index);
+	}
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return is_equal;
+}
+
+static bool Internal_Unlocked_CompareAndSetValueStringForKeyString(LuaHashMap* restrict hash_map, const char* value_string, const char* expected_value_string, const char* restrict key_string)
+{
+	size_t value_string_length;
+	size_t expected_value_string_length;
+
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+	if(NULL == key_string)
+	{
+		return false;
+	}
+
+	value_string_length = (NULL == value_string) ? 0 : strlen(value_string);
+	expected_value_string_length = (NULL == expected_value_string) ? 0 : strlen(expected_value_string);
+	Internal_PushTableAndKeyString(hash_map, key_string, strlen(key_string)); /* stack: [key_string, table] */
+	lua_pushlstring(hash_map->luaState, expected_value_string, expected_value_string_length); /* stack: [expected_value_string, key_string, table] */
+	lua_pushlstring(hash_map->luaState, value_string, value_string_length); /* stack: [value_string, expected_value_string, key_string, table] */
+	return Internal_CompareAndSetPushedValueAndPop(hash_map, NULL);
+}
+
+static bool Internal_Unlocked_CompareAndSetValueStringForKeyStringWithLength(LuaHashMap* restrict hash_map, const char* value_string, const char* expected_value_string, const char* restrict key_string, size_t value_string_length, size_t expected_value_string_length, size_t key_string_length)
+{
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+	if(NULL == key_string)
+	{
+		return false;
+	}
+
+	if(NULL == value_string)
+	{
+		value_string_length = 0;
+	}
+	if(NULL == expected_value_string)
+	{
+		expected_value_string_length = 0;
+	}
+	Internal_PushTableAndKeyString(hash_map, key_string, key_string_length); /* stack: [key_string, table] */
+	lua_pushlstring(hash_map->luaState, expected_value_string, expected_value_string_length); /* stack: [expected_value_string, key_string, table] */
+	lua_pushlstring(hash_map->luaState, value_string, value_string_length); /* stack: [value_string, expected_value_string, key_string, table] */
+	return Internal_CompareAndSetPushedValueAndPop(hash_map, NULL);
+}
+
+static bool Internal_Unlocked_CompareAndSetValueStringForKeyPointer(LuaHashMap* hash_map, const char* value_string, const char* expected_value_string, void* key_pointer)
+{
+	size_t value_string_length;
+	size_t expected_value_string_length;
+
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+
+	value_string_length = (NULL == value_string) ? 0 : strlen(value_string);
+	expected_value_string_length = (NULL == expected_value_string) ? 0 : strlen(expected_value_string);
+	Internal_PushTableAndKeyPointer(hash_map, key_pointer); /* stack: [key_pointer, table] */
+	lua_pushlstring(hash_map->luaState, expected_value_string, expected_value_string_length); /* stack: [expected_value_string, key_pointer, table] */
+	lua_pushlstring(hash_map->luaState, value_string, value_string_length); /* stack: [value_string, expected_value_string, key_pointer, table] */
+	return Internal_CompareAndSetPushedValueAndPop(hash_map, NULL);
+}
+
+static bool Internal_Unlocked_CompareAndSetValueStringForKeyPointerWithLength(LuaHashMap* hash_map, const char* value_string, const char* expected_value_string, void* key_pointer, size_t value_string_length, size_t expected_value_string_length)
+{
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+
+	if(NULL == value_string)
+	{
+		value_string_length = 0;
+	}
+	if(NULL == expected_value_string)
+	{
+		expected_value_string_length = 0;
+	}
+	Internal_PushTableAndKeyPointer(hash_map, key_pointer); /* stack: [key_pointer, table] */
+	lua_pushlstring(hash_map->luaState, expected_value_string, expected_value_string_length); /* stack: [expected_value_string, key_pointer, table] */
+	lua_pushlstring(hash_map->luaState, value_string, value_string_length); /* stack: [value_string, expected_value_string, key_pointer, table] */
+	return Internal_CompareAndSetPushedValueAndPop(hash_map, NULL);
+}
+
+static bool Internal_Unlocked_CompareAndSetValueStringForKeyNumber(LuaHashMap* restrict hash_map, const char* value_string, const char* expected_value_string, lua_Number key_number)
+{
+	size_t value_string_length;
+	size_t expected_value_string_length;
+
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+
+	value_string_length = (NULL == value_string) ? 0 : strlen(value_string);
+	expected_value_string_length = (NULL == expected_value_string) ? 0 : strlen(expected_value_string);
+	Internal_PushTableAndKeyNumber(hash_map, key_number); /* stack: [key_number, table] */
+	lua_pushlstring(hash_map->luaState, expected_value_string, expected_value_string_length); /* stack: [expected_value_string, key_number, table] */
+	lua_pushlstring(hash_map->luaState, value_string, value_string_length); /* stack: [value_string, expected_value_string, key_number, table] */
+	return Internal_CompareAndSetPushedValueAndPop(hash_map, NULL);
+}
+
+static bool Internal_Unlocked_CompareAndSetValueStringForKeyNumberWithLength(LuaHashMap* restrict hash_map, const char* value_string, const char* expected_value_string, lua_Number key_number, size_t value_string_length, size_t expected_value_string_length)
+{
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+
+	if(NULL == value_string)
+	{
+		value_string_length = 0;
+	}
+	if(NULL == expected_value_string)
+	{
+		expected_value_string_length = 0;
+	}
+	Internal_PushTableAndKeyNumber(hash_map, key_number); /* stack: [key_number, table] */
+	lua_pushlstring(hash_map->luaState, expected_value_string, expected_value_string_length); /* stack: [expected_value_string, key_number, table] */
+	lua_pushlstring(hash_map->luaState, value_string, value_string_length); /* stack: [value_string, expected_value_string, key_number, table] */
+	return Internal_CompareAndSetPushedValueAndPop(hash_map, NULL);
+}
+
+static bool Internal_Unlocked_CompareAndSetValueStringForKeyInteger(LuaHashMap* restrict hash_map, const char* value_string, const char* expected_value_string, lua_Integer key_integer)
+{
+	const lua_Integer* key_index;
+	size_t value_string_length;
+	size_t expected_value_string_length;
+
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+
+	value_string_length = (NULL == value_string) ? 0 : strlen(value_string);
+	expected_value_string_length = (NULL == expected_value_string) ? 0 : strlen(expected_value_string);
+	key_index = Internal_PushTableAndIndexKeyInteger(hash_map, &key_integer); /* stack: [key_integer, table] (just [table] with a key_index) */
+	lua_pushlstring(hash_map->luaState, expected_value_string, expected_value_string_length); /* stack: [expected_value_string, key_integer, table] */
+	lua_pushlstring(hash_map->luaState, value_string, value_string_length); /* stack: [value_string, expected_value_string, key_integer, table] */
+	return Internal_CompareAndSetPushedValueAndPop(hash_map, key_index);
+}
+
+static bool Internal_Unlocked_CompareAndSetValueStringForKeyIntegerWithLength(LuaHashMap* restrict hash_map, const char* value_string, const char* expected_value_string, lua_Integer key_integer, size_t value_string_length, size_t expected_value_string_length)
+{
+	const lua_Integer* key_index;
+
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+
+	if(NULL == value_string)
+	{
+		value_string_length = 0;
+	}
+	if(NULL == expected_value_string)
+	{
+		expected_value_string_length = 0;
+	}
+	key_index = Internal_PushTableAndIndexKeyInteger(hash_map, &key_integer); /* stack: [key_integer, table] (just [table] with a key_index) */
+	lua_pushlstring(hash_map->luaState, expected_value_string, expected_value_string_length); /* stack: [expected_value_string, key_integer, table] */
+	lua_pushlstring(hash_map->luaState, value_string, value_string_length); /* stack: [value_string, expected_value_string, key_integer, table] */
+	return Internal_CompareAndSetPushedValueAndPop(hash_map, key_index);
+}
+
+static bool Internal_Unlocked_CompareAndSetValuePointerForKeyString(LuaHashMap* hash_map, void* value_pointer, void* expected_value_pointer, const char* key_string)
+{
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+	if(NULL == key_string)
+	{
+		return false;
+	}
+
+	Internal_PushTableAndKeyString(hash_map, key_string, strlen(key_string)); /* stack: [key_string, table] */
+	lua_pushlightuserdata(hash_map->luaState, expected_value_pointer); /* stack: [expected_value_pointer, key_string, table] */
+	lua_pushlightuserdata(hash_map->luaState, value_pointer); /* stack: [value_pointer, expected_value_pointer, key_string, table] */
+	return Internal_CompareAndSetPushedValueAndPop(hash_map, NULL);
+}
+
+static bool Internal_Unlocked_CompareAndSetValuePointerForKeyStringWithLength(LuaHashMap* hash_map, void* value_pointer, void* expected_value_pointer, const char* key_string, size_t key_string_length)
+{
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+	if(NULL == key_string)
+	{
+		return false;
+	}
+
+	Internal_PushTableAndKeyString(hash_map, key_string, key_string_length); /* stack: [key_string, table] */
+	lua_pushlightuserdata(hash_map->luaState, expected_value_pointer); /* stack: [expected_value_pointer, key_string, table] */
+	lua_pushlightuserdata(hash_map->luaState, value_pointer); /* stack: [value_pointer, expected_value_pointer, key_string, table] */
+	return Internal_CompareAndSetPushedValueAndPop(hash_map, NULL);
+}
+
+static bool Internal_Unlocked_CompareAndSetValuePointerForKeyPointer(LuaHashMap* hash_map, void* value_pointer, void* expected_value_pointer, void* key_pointer)
+{
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+
+	Internal_PushTableAndKeyPointer(hash_map, key_pointer); /* stack: [key_pointer, table] */
+	lua_pushlightuserdata(hash_map->luaState, expected_value_pointer); /* stack: [expected_value_pointer, key_pointer, table] */
+	lua_pushlightuserdata(hash_map->luaState, value_pointer); /* stack: [value_pointer, expected_value_pointer, key_pointer, table] */
+	return Internal_CompareAndSetPushedValueAndPop(hash_map, NULL);
+}
+
+static bool Internal_Unlocked_CompareAndSetValuePointerForKeyNumber(LuaHashMap* hash_map, void* value_pointer, void* expected_value_pointer, lua_Number key_number)
+{
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+
+	Internal_PushTableAndKeyNumber(hash_map, key_number); /* stack: [key_number, table] */
+	lua_pushlightuserdata(hash_map->luaState, expected_value_pointer); /* stack: [expected_value_pointer, key_number, table] */
+	lua_pushlightuserdata(hash_map->luaState, value_pointer); /* stack: [value_pointer, expected_value_pointer, key_number, table] */
+	return Internal_CompareAndSetPushedValueAndPop(hash_map, NULL);
+}
+
+static bool Internal_Unlocked_CompareAndSetValuePointerForKeyInteger(LuaHashMap* hash_map, void* value_pointer, void* expected_value_pointer, lua_Integer key_integer)
+{
+	const lua_Integer* key_index;
+
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+
+	key_index = Internal_PushTableAndIndexKeyInteger(hash_map, &key_integer); /* stack: [key_integer, table] (just [table] with a key_index) */
+	lua_pushlightuserdata(hash_map->luaState, expected_value_pointer); /* stack: [expected_value_pointer, key_integer, table] */
+	lua_pushlightuserdata(hash_map->luaState, value_pointer); /* stack: [value_pointer, expected_value_pointer, key_integer, table] */
+	return Internal_CompareAndSetPushedValueAndPop(hash_map, key_index);
+}
+
+static bool Internal_Unlocked_CompareAndSetValueNumberForKeyString(LuaHashMap* restrict hash_map, lua_Number value_number, lua_Number expected_value_number, const char* restrict key_string)
+{
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+	if(NULL == key_string)
+	{
+		return false;
+	}
+
+	Internal_PushTableAndKeyString(hash_map, key_string, strlen(key_string)); /* stack: [key_string, table] */
+	lua_pushnumber(hash_map->luaState, expected_value_number); /* stack: [expected_value_number, key_string, table] */
+	lua_pushnumber(hash_map->luaState, value_number); /* stack: [value_number, expected_value_number, key_string, table] */
+	return Internal_CompareAndSetPushedValueAndPop(hash_map, NULL);
+}
+
+static bool Internal_Unlocked_CompareAndSetValueNumberForKeyStringWithLength(LuaHashMap* restrict hash_map, lua_Number value_number, lua_Number expected_value_number, const char* restrict key_string, size_t key_string_length)
+{
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+	if(NULL == key_string)
+	{
+		return false;
+	}
+
+	Internal_PushTableAndKeyString(hash_map, key_string, key_string_length); /* stack: [key_string, table] */
+	lua_pushnumber(hash_map->luaState, expected_value_number); /* stack: [expected_value_number, key_string, table] */
+	lua_pushnumber(hash_map->luaState, value_number); /* stack: [value_number, expected_value_number, key_string, table] */
+	return Internal_CompareAndSetPushedValueAndPop(hash_map, NULL);
+}
+
+static bool Internal_Unlocked_CompareAndSetValueNumberForKeyPointer(LuaHashMap* hash_map, lua_Number value_number, lua_Number expected_value_number, void* key_pointer)
+{
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+
+	Internal_PushTableAndKeyPointer(hash_map, key_pointer); /* stack: [key_pointer, table] */
+	lua_pushnumber(hash_map->luaState, expected_value_number); /* stack: [expected_value_number, key_pointer, table] */
+	lua_pushnumber(hash_map->luaState, value_number); /* stack: [value_number, expected_value_number, key_pointer, table] */
+	return Internal_CompareAndSetPushedValueAndPop(hash_map, NULL);
+}
+
+static bool Internal_Unlocked_CompareAndSetValueNumberForKeyNumber(LuaHashMap* restrict hash_map, lua_Number value_number, lua_Number expected_value_number, lua_Number key_number)
+{
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+
+	Internal_PushTableAndKeyNumber(hash_map, key_number); /* stack: [key_number, table] */
+	lua_pushnumber(hash_map->luaState, expected_value_number); /* stack: [expected_value_number, key_number, table] */
+	lua_pushnumber(hash_map->luaState, value_number); /* stack: [value_number, expected_value_number, key_number, table] */
+	return Internal_CompareAndSetPushedValueAndPop(hash_map, NULL);
+}
+
+static bool Internal_Unlocked_CompareAndSetValueNumberForKeyInteger(LuaHashMap* restrict hash_map, lua_Number value_number, lua_Number expected_value_number, lua_Integer key_integer)
+{
+	const lua_Integer* key_index;
+
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+
+	key_index = Internal_PushTableAndIndexKeyInteger(hash_map, &key_integer); /* stack: [key_integer, table] (just [table] with a key_index) */
+	lua_pushnumber(hash_map->luaState, expected_value_number); /* stack: [expected_value_number, key_integer, table] */
+	lua_pushnumber(hash_map->luaState, value_number); /* stack: [value_number, expected_value_number, key_integer, table] */
+	return Internal_CompareAndSetPushedValueAndPop(hash_map, key_index);
+}
+
+static bool Internal_Unlocked_CompareAndSetValueIntegerForKeyString(LuaHashMap* restrict hash_map, lua_Integer value_integer, lua_Integer expected_value_integer, const char* restrict key_string)
+{
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+	if(NULL == key_string)
+	{
+		return false;
+	}
+
+	Internal_PushTableAndKeyString(hash_map, key_string, strlen(key_string)); /* stack: [key_string, table] */
+	Internal_PushInteger(hash_map, expected_value_integer); /* stack: [expected_value_integer, key_string, table] */
+	Internal_PushInteger(hash_map, value_integer); /* stack: [value_integer, expected_value_integer, key_string, table] */
+	return Internal_CompareAndSetPushedValueAndPop(hash_map, NULL);
+}
+
+static bool Internal_Unlocked_CompareAndSetValueIntegerForKeyStringWithLength(LuaHashMap* restrict hash_map, lua_Integer value_integer, lua_Integer expected_value_integer, const char* restrict key_string, size_t key_string_length)
+{
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+	if(NULL == key_string)
+	{
+		return false;
+	}
+
+	Internal_PushTableAndKeyString(hash_map, key_string, key_string_length); /* stack: [key_string, table] */
+	Internal_PushInteger(hash_map, expected_value_integer); /* stack: [expected_value_integer, key_string, table] */
+	Internal_PushInteger(hash_map, value_integer); /* stack: [value_integer, expected_value_integer, key_string, table] */
+	return Internal_CompareAndSetPushedValueAndPop(hash_map, NULL);
+}
+
+static bool Internal_Unlocked_CompareAndSetValueIntegerForKeyPointer(LuaHashMap* hash_map, lua_Integer value_integer, lua_Integer expected_value_integer, void* key_pointer)
+{
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+
+	Internal_PushTableAndKeyPointer(hash_map, key_pointer); /* stack: [key_pointer, table] */
+	Internal_PushInteger(hash_map, expected_value_integer); /* stack: [expected_value_integer, key_pointer, table] */
+	Internal_PushInteger(hash_map, value_integer); /* stack: [value_integer, expected_value_integer, key_pointer, table] */
+	return Internal_CompareAndSetPushedValueAndPop(hash_map, NULL);
+}
+
+static bool Internal_Unlocked_CompareAndSetValueIntegerForKeyNumber(LuaHashMap* restrict hash_map, lua_Integer value_integer, lua_Integer expected_value_integer, lua_Number key_number)
+{
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+
+	Internal_PushTableAndKeyNumber(hash_map, key_number); /* stack: [key_number, table] */
+	Internal_PushInteger(hash_map, expected_value_integer); /* stack: [expected_value_integer, key_number, table] */
+	Internal_PushInteger(hash_map, value_integer); /* stack: [value_integer, expected_value_integer, key_number, table] */
+	return Internal_CompareAndSetPushedValueAndPop(hash_map, NULL);
+}
+
+static bool Internal_Unlocked_CompareAndSetValueIntegerForKeyInteger(LuaHashMap* restrict hash_map, lua_Integer value_integer, lua_Integer expected_value_integer, lua_Integer key_integer)
+{
+	const lua_Integer* key_index;
+
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+
+	key_index = Internal_PushTableAndIndexKeyInteger(hash_map, &key_integer); /* stack: [key_integer, table] (just [table] with a key_index) */
+	Internal_PushInteger(hash_map, expected_value_integer); /* stack: [expected_value_integer, key_integer, table] */
+	Internal_PushInteger(hash_map, value_integer); /* stack: [value_integer, expected_value_integer, key_integer, table] */
+	return Internal_CompareAndSetPushedValueAndPop(hash_map, key_index);
+}
+
+static bool Internal_Unlocked_RemoveKeyStringIfValueString(LuaHashMap* restrict hash_map, const char* restrict key_string, const char* expected_value_string)
+{
+	size_t expected_value_string_length;
+
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+	if(NULL == key_string)
+	{
+		return false;
+	}
+
+	expected_value_string_length = (NULL == expected_value_string) ? 0 : strlen(expected_value_string);
+	Internal_PushTableAndKeyString(hash_map, key_string, strlen(key_string)); /* stack: [key_string, table] */
+	lua_pushlstring(hash_map->luaState, expected_value_string, expected_value_string_length); /* stack: [expected_value_string, key_string, table] */
+	lua_pushnil(hash_map->luaState); /* stack: [nil, expected_value_string, key_string, table] */
+	return Internal_CompareAndSetPushedValueAndPop(hash_map, NULL);
+}
+
+static bool Internal_Unlocked_RemoveKeyStringIfValueStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, const char* expected_value_string, size_t key_string_length, size_t expected_value_string_length)
+{
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+	if(NULL == key_string)
+	{
+		return false;
+	}
+
+	if(NULL == expected_value_string)
+	{
+		expected_value_string_length = 0;
+	}
+	Internal_PushTableAndKeyString(hash_map, key_string, key_string_length); /* stack: [key_string, table] */
+	lua_pushlstring(hash_map->luaState, expected_value_string, expected_value_string_length); /* stack: [expected_value_string, key_string, table] */
+	lua_pushnil(hash_map->luaState); /* stack: [nil, expected_value_string, key_string, table] */
+	return Internal_CompareAndSetPushedValueAndPop(hash_map, NULL);
+}
+
+static bool Internal_Unlocked_RemoveKeyPointerIfValueString(LuaHashMap* hash_map, void* key_pointer, const char* expected_value_string)
+{
+	size_t expected_value_string_length;
+
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+
+	expected_value_string_length = (NULL == expected_value_string) ? 0 : strlen(expected_value_string);
+	Internal_PushTableAndKeyPointer(hash_map, key_pointer); /* stack: [key_pointer, table] */
+	lua_pushlstring(hash_map->luaState, expected_value_string, expected_value_string_length); /* stack: [expected_value_string, key_pointer, table] */
+	lua_pushnil(hash_map->luaState); /* stack: [nil, expected_value_string, key_pointer, table] */
+	return Internal_CompareAndSetPushedValueAndPop(hash_map, NULL);
+}
+
+static bool Internal_Unlocked_RemoveKeyPointerIfValueStringWithLength(LuaHashMap* hash_map, void* key_pointer, const char* expected_value_string, size_t expected_value_string_length)
+{
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+
+	if(NULL == expected_value_string)
+	{
+		expected_value_string_length = 0;
+	}
+	Internal_PushTableAndKeyPointer(hash_map, key_pointer); /* stack: [key_pointer, table] */
+	lua_pushlstring(hash_map->luaState, expected_value_string, expected_value_string_length); /* stack: [expected_value_string, key_pointer, table] */
+	lua_pushnil(hash_map->luaState); /* stack: [nil, expected_value_string, key_pointer, table] */
+	return Internal_CompareAndSetPushedValueAndPop(hash_map, NULL);
+}
+
+static bool Internal_Unlocked_RemoveKeyNumberIfValueString(LuaHashMap* restrict hash_map, lua_Number key_number, const char* expected_value_string)
+{
+	size_t expected_value_string_length;
+
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+
+	expected_value_string_length = (NULL == expected_value_string) ? 0 : strlen(expected_value_string);
+	Internal_PushTableAndKeyNumber(hash_map, key_number); /* stack: [key_number, table] */
+	lua_pushlstring(hash_map->luaState, expected_value_string, expected_value_string_length); /* stack: [expected_value_string, key_number, table] */
+	lua_pushnil(hash_map->luaState); /* stack: [nil, expected_value_string, key_number, table] */
+	return Internal_CompareAndSetPushedValueAndPop(hash_map, NULL);
+}
+
+static bool Internal_Unlocked_RemoveKeyNumberIfValueStringWithLength(LuaHashMap* restrict hash_map, lua_Number key_number, const char* expected_value_string, size_t expected_value_string_length)
+{
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+
+	if(NULL == expected_value_string)
+	{
+		expected_value_string_length = 0;
+	}
+	Internal_PushTableAndKeyNumber(hash_map, key_number); /* stack: [key_number, table] */
+	lua_pushlstring(hash_map->luaState, expected_value_string, expected_value_string_length); /* stack: [expected_value_string, key_number, table] */
+	lua_pushnil(hash_map->luaState); /* stack: [nil, expected_value_string, key_number, table] */
+	return Internal_CompareAndSetPushedValueAndPop(hash_map, NULL);
+}
+
+static bool Internal_Unlocked_RemoveKeyIntegerIfValueString(LuaHashMap* restrict hash_map, lua_Integer key_integer, const char* expected_value_string)
+{
+	const lua_Integer* key_index;
+	size_t expected_value_string_length;
+
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+
+	expected_value_string_length = (NULL == expected_value_string) ? 0 : strlen(expected_value_string);
+	key_index = Internal_PushTableAndIndexKeyInteger(hash_map, &key_integer); /* stack: [key_integer, table] (just [table] with a key_index) */
+	lua_pushlstring(hash_map->luaState, expected_value_string, expected_value_string_length); /* stack: [expected_value_string, key_integer, table] */
+	lua_pushnil(hash_map->luaState); /* stack: [nil, expected_value_string, key_integer, table] */
+	return Internal_CompareAndSetPushedValueAndPop(hash_map, key_index);
+}
+
+static bool Internal_Unlocked_RemoveKeyIntegerIfValueStringWithLength(LuaHashMap* restrict hash_map, lua_Integer key_integer, const char* expected_value_string, size_t expected_value_string_length)
+{
+	const lua_Integer* key_index;
+
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+
+	if(NULL == expected_value_string)
+	{
+		expected_value_string_length = 0;
+	}
+	key_index = Internal_PushTableAndIndexKeyInteger(hash_map, &key_integer); /* stack: [key_integer, table] (just [table] with a key_index) */
+	lua_pushlstring(hash_map->luaState, expected_value_string, expected_value_string_length); /* stack: [expected_value_string, key_integer, table] */
+	lua_pushnil(hash_map->luaState); /* stack: [nil, expected_value_string, key_integer, table] */
+	return Internal_CompareAndSetPushedValueAndPop(hash_map, key_index);
+}
+
+static bool Internal_Unlocked_RemoveKeyStringIfValuePointer(LuaHashMap* hash_map, const char* key_string, void* expected_value_pointer)
+{
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+	if(NULL == key_string)
+	{
+		return false;
+	}
+
+	Internal_PushTableAndKeyString(hash_map, key_string, strlen(key_string)); /* stack: [key_string, table] */
+	lua_pushlightuserdata(hash_map->luaState, expected_value_pointer); /* stack: [expected_value_pointer, key_string, table] */
+	lua_pushnil(hash_map->luaState); /* stack: [nil, expected_value_pointer, key_string, table] */
+	return Internal_CompareAndSetPushedValueAndPop(hash_map, NULL);
+}
+
+static bool Internal_Unlocked_RemoveKeyStringIfValuePointerWithLength(LuaHashMap* hash_map, const char* key_string, void* expected_value_pointer, size_t key_string_length)
+{
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+	if(NULL == key_string)
+	{
+		return false;
+	}
+
+	Internal_PushTableAndKeyString(hash_map, key_string, key_string_length); /* stack: [key_string, table] */
+	lua_pushlightuserdata(hash_map->luaState, expected_value_pointer); /* stack: [expected_value_pointer, key_string, table] */
+	lua_pushnil(hash_map->luaState); /* stack: [nil, expected_value_pointer, key_string, table] */
+	return Internal_CompareAndSetPushedValueAndPop(hash_map, NULL);
+}
+
+static bool Internal_Unlocked_RemoveKeyPointerIfValuePointer(LuaHashMap* hash_map, void* key_pointer, void* expected_value_pointer)
+{
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+
+	Internal_PushTableAndKeyPointer(hash_map, key_pointer); /* stack: [key_pointer, table] */
+	lua_pushlightuserdata(hash_map->luaState, expected_value_pointer); /* stack: [expected_value_pointer, key_pointer, table] */
+	lua_pushnil(hash_map->luaState); /* stack: [nil, expected_value_pointer, key_pointer, table] */
+	return Internal_CompareAndSetPushedValueAndPop(hash_map, NULL);
+}
+
+static bool Internal_Unlocked_RemoveKeyNumberIfValuePointer(LuaHashMap* hash_map, lua_Number key_number, void* expected_value_pointer)
+{
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+
+	Internal_PushTableAndKeyNumber(hash_map, key_number); /* stack: [key_number, table] */
+	lua_pushlightuserdata(hash_map->luaState, expected_value_pointer); /* stack: [expected_value_pointer, key_number, table] */
+	lua_pushnil(hash_map->luaState); /* stack: [nil, expected_value_pointer, key_number, table] */
+	return Internal_CompareAndSetPushedValueAndPop(hash_map, NULL);
+}
+
+static bool Internal_Unlocked_RemoveKeyIntegerIfValuePointer(LuaHashMap* hash_map, lua_Integer key_integer, void* expected_value_pointer)
+{
+	const lua_Integer* key_index;
+
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+
+	key_index = Internal_PushTableAndIndexKeyInteger(hash_map, &key_integer); /* stack: [key_integer, table] (just [table] with a key_index) */
+	lua_pushlightuserdata(hash_map->luaState, expected_value_pointer); /* stack: [expected_value_pointer, key_integer, table] */
+	lua_pushnil(hash_map->luaState); /* stack: [nil, expected_value_pointer, key_integer, table] */
+	return Internal_CompareAndSetPushedValueAndPop(hash_map, key_index);
+}
+
+static bool Internal_Unlocked_RemoveKeyStringIfValueNumber(LuaHashMap* restrict hash_map, const char* restrict key_string, lua_Number expected_value_number)
+{
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+	if(NULL == key_string)
+	{
+		return false;
+	}
+
+	Internal_PushTableAndKeyString(hash_map, key_string, strlen(key_string)); /* stack: [key_string, table] */
+	lua_pushnumber(hash_map->luaState, expected_value_number); /* stack: [expected_value_number, key_string, table] */
+	lua_pushnil(hash_map->luaState); /* stack: [nil, expected_value_number, key_string, table] */
+	return Internal_CompareAndSetPushedValueAndPop(hash_map, NULL);
+}
+
+static bool Internal_Unlocked_RemoveKeyStringIfValueNumberWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, lua_Number expected_value_number, size_t key_string_length)
+{
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+	if(NULL == key_string)
+	{
+		return false;
+	}
+
+	Internal_PushTableAndKeyString(hash_map, key_string, key_string_length); /* stack: [key_string, table] */
+	lua_pushnumber(hash_map->luaState, expected_value_number); /* stack: [expected_value_number, key_string, table] */
+	lua_pushnil(hash_map->luaState); /* stack: [nil, expected_value_number, key_string, table] */
+	return Internal_CompareAndSetPushedValueAndPop(hash_map, NULL);
+}
+
+static bool Internal_Unlocked_RemoveKeyPointerIfValueNumber(LuaHashMap* hash_map, void* key_pointer, lua_Number expected_value_number)
+{
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+
+	Internal_PushTableAndKeyPointer(hash_map, key_pointer); /* stack: [key_pointer, table] */
+	lua_pushnumber(hash_map->luaState, expected_value_number); /* stack: [expected_value_number, key_pointer, table] */
+	lua_pushnil(hash_map->luaState); /* stack: [nil, expected_value_number, key_pointer, table] */
+	return Internal_CompareAndSetPushedValueAndPop(hash_map, NULL);
+}
+
+static bool Internal_Unlocked_RemoveKeyNumberIfValueNumber(LuaHashMap* restrict hash_map, lua_Number key_number, lua_Number expected_value_number)
+{
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+
+	Internal_PushTableAndKeyNumber(hash_map, key_number); /* stack: [key_number, table] */
+	lua_pushnumber(hash_map->luaState, expected_value_number); /* stack: [expected_value_number, key_number, table] */
+	lua_pushnil(hash_map->luaState); /* stack: [nil, expected_value_number, key_number, table] */
+	return Internal_CompareAndSetPushedValueAndPop(hash_map, NULL);
+}
+
+static bool Internal_Unlocked_RemoveKeyIntegerIfValueNumber(LuaHashMap* restrict hash_map, lua_Integer key_integer, lua_Number expected_value_number)
+{
+	const lua_Integer* key_index;
+
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+
+	key_index = Internal_PushTableAndIndexKeyInteger(hash_map, &key_integer); /* stack: [key_integer, table] (just [table] with a key_index) */
+	lua_pushnumber(hash_map->luaState, expected_value_number); /* stack: [expected_value_number, key_integer, table] */
+	lua_pushnil(hash_map->luaState); /* stack: [nil, expected_value_number, key_integer, table] */
+	return Internal_CompareAndSetPushedValueAndPop(hash_map, key_index);
+}
+
+static bool Internal_Unlocked_RemoveKeyStringIfValueInteger(LuaHashMap* restrict hash_map, const char* restrict key_string, lua_Integer expected_value_integer)
+{
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+	if(NULL == key_string)
+	{
+		return false;
+	}
+
+	Internal_PushTableAndKeyString(hash_map, key_string, strlen(key_string)); /* stack: [key_string, table] */
+	Internal_PushInteger(hash_map, expected_value_integer); /* stack: [expected_value_integer, key_string, table] */
+	lua_pushnil(hash_map->luaState); /* stack: [nil, expected_value_integer, key_string, table] */
+	return Internal_CompareAndSetPushedValueAndPop(hash_map, NULL);
+}
+
+static bool Internal_Unlocked_RemoveKeyStringIfValueIntegerWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, lua_Integer expected_value_integer, size_t key_string_length)
+{
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+	if(NULL == key_string)
+	{
+		return false;
+	}
+
+	Internal_PushTableAndKeyString(hash_map, key_string, key_string_length); /* stack: [key_string, table] */
+	Internal_PushInteger(hash_map, expected_value_integer); /* stack: [expected_value_integer, key_string, table] */
+	lua_pushnil(hash_map->luaState); /* stack: [nil, expected_value_integer, key_string, table] */
+	return Internal_CompareAndSetPushedValueAndPop(hash_map, NULL);
+}
+
+static bool Internal_Unlocked_RemoveKeyPointerIfValueInteger(LuaHashMap* hash_map, void* key_pointer, lua_Integer expected_value_integer)
+{
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+
+	Internal_PushTableAndKeyPointer(hash_map, key_pointer); /* stack: [key_pointer, table] */
+	Internal_PushInteger(hash_map, expected_value_integer); /* stack: [expected_value_integer, key_pointer, table] */
+	lua_pushnil(hash_map->luaState); /* stack: [nil, expected_value_integer, key_pointer, table] */
+	return Internal_CompareAndSetPushedValueAndPop(hash_map, NULL);
+}
+
+static bool Internal_Unlocked_RemoveKeyNumberIfValueInteger(LuaHashMap* restrict hash_map, lua_Number key_number, lua_Integer expected_value_integer)
+{
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+
+	Internal_PushTableAndKeyNumber(hash_map, key_number); /* stack: [key_number, table] */
+	Internal_PushInteger(hash_map, expected_value_integer); /* stack: [expected_value_integer, key_number, table] */
+	lua_pushnil(hash_map->luaState); /* stack: [nil, expected_value_integer, key_number, table] */
+	return Internal_CompareAndSetPushedValueAndPop(hash_map, NULL);
+}
+
+static bool Internal_Unlocked_RemoveKeyIntegerIfValueInteger(LuaHashMap* restrict hash_map, lua_Integer key_integer, lua_Integer expected_value_integer)
+{
+	const lua_Integer* key_index;
+
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+
+	key_index = Internal_PushTableAndIndexKeyInteger(hash_map, &key_integer); /* stack: [key_integer, table] (just [table] with a key_index) */
+	Internal_PushInteger(hash_map, expected_value_integer); /* stack: [expected_value_integer, key_integer, table] */
+	lua_pushnil(hash_map->luaState); /* stack: [nil, expected_value_integer, key_integer, table] */
+	return Internal_CompareAndSetPushedValueAndPop(hash_map, key_index);
+}
+
+static bool Internal_ExistsKeyStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length)
+{
+	bool ret_val;
+
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	lua_pushlstring(hash_map->luaState, key_string, key_string_length); /* stack: [key_string, table] */
+	LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_string]; stack: [value, table] */
+	
+	if(LUA_TNIL==lua_type(hash_map->luaState, -1))
+	{
+		ret_val = false;
+	}
+	else
+	{
+		ret_val = true;
+	}
+	
+	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 2);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);	
+	return ret_val;
+}
+
+static bool Internal_Unlocked_ExistsKeyString(LuaHashMap* restrict hash_map, const char* restrict key_string)
+{
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+	if(NULL == key_string)
+	{
+		return false;
+	}
+	return Internal_ExistsKeyStringWithLength(hash_map, key_string, strlen(key_string));	
+}
+
+static bool Internal_Unlocked_ExistsKeyStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length)
+{
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+	if(NULL == key_string)
+	{
+		return false;
+	}
+	return Internal_ExistsKeyStringWithLength(hash_map, key_string, key_string_length);
+}
+
+static bool Internal_Unlocked_ExistsKeyPointer(LuaHashMap* hash_map, void* key_pointer)
+{
+	bool ret_val;
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	lua_pushlightuserdata(hash_map->luaState, key_pointer); /* stack: [key_pointer, table] */
+	LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_pointer]; stack: [value_pointer, table] */
+
+	if(LUA_TNIL==lua_type(hash_map->luaState, -1))
+	{
+		ret_val = false;
+	}
+	else
+	{
+		ret_val = true;
+	}
+
+	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 2);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return ret_val;
+}
+
+static bool Internal_Unlocked_ExistsKeyNumber(LuaHashMap* hash_map, lua_Number key_number)
+{
+	bool ret_val;
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	lua_pushnumber(hash_map->luaState, key_number); /* stack: [key_number, table] */
+	LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_number]; stack: [value_pointer, table] */
+
+	if(LUA_TNIL==lua_type(hash_map->luaState, -1))
+	{
+		ret_val = false;
+	}
+	else
+	{
+		ret_val = true;
+	}
+
+	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 2);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return ret_val;
+}
+
+static bool Internal_Unlocked_ExistsKeyInteger(LuaHashMap* hash_map, lua_Integer key_integer)
+{
+	bool ret_val;
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+	
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	Internal_GetTableForKeyInteger(hash_map, key_integer); /* table[key_integer]; stack: [value_pointer, table] */
+	
+	if(LUA_TNIL==lua_type(hash_map->luaState, -1))
+	{
+		ret_val = false;
+	}
+	else
+	{
+		ret_val = true;
+	}
+	
+	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 2);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return ret_val;
+}
+
+/* Batch versions of the ExistsKey family. */
+static size_t Internal_Unlocked_ExistsKeysString(LuaHashMap* hash_map, const char* keys_array[], const size_t key_lengths_array[], unsigned char found_bitmap[], size_t number_of_elements)
+{
+	size_t i;
+	size_t total_found = 0;
+	if(NULL == hash_map)
+	{
+		return 0;
+	}
+	if(NULL == keys_array)
+	{
+		return 0;
+	}
+
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	for(i=0; i<number_of_elements; i++)
+	{
+		if(NULL == keys_array[i])
+		{
+			Internal_SetBitmap(found_bitmap, i, false);
+			continue;
+		}
+		lua_pushlstring(hash_map->luaState, keys_array[i], (NULL == key_lengths_array) ? strlen(keys_array[i]) : key_lengths_array[i]); /* stack: [key_string, table] */
+		LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_string]; stack: [value, table] */
+		if(LUA_TNIL == lua_type(hash_map->luaState, -1))
+		{
+			Internal_SetBitmap(found_bitmap, i, false);
+		}
+		else
+		{
+			Internal_SetBitmap(found_bitmap, i, true);
+			total_found++;
+		}
+		/* pop the value; keep the table for the next key */
+		lua_pop(hash_map->luaState, 1); /* stack: [table] */
+	}
+
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return total_found;
+}
+
+static size_t Internal_Unlocked_ExistsKeysPointer(LuaHashMap* hash_map, void* keys_array[], unsigned char found_bitmap[], size_t number_of_elements)
+{
+	size_t i;
+	size_t total_found = 0;
+	if(NULL == hash_map)
+	{
+		return 0;
+	}
+	if(NULL == keys_array)
+	{
+		return 0;
+	}
+
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	for(i=0; i<number_of_elements; i++)
+	{
+		lua_pushlightuserdata(hash_map->luaState, keys_array[i]); /* stack: [key_pointer, table] */
+		LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_pointer]; stack: [value, table] */
+		if(LUA_TNIL == lua_type(hash_map->luaState, -1))
+		{
+			Internal_SetBitmap(found_bitmap, i, false);
+		}
+		else
+		{
+			Internal_SetBitmap(found_bitmap, i, true);
+			total_found++;
+		}
+		/* pop the value; keep the table for the next key */
+		lua_pop(hash_map->luaState, 1); /* stack: [table] */
+	}
+
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return total_found;
+}
+
+static size_t Internal_Unlocked_ExistsKeysNumber(LuaHashMap* hash_map, const lua_Number keys_array[], unsigned char found_bitmap[], size_t number_of_elements)
+{
+	size_t i;
+	size_t total_found = 0;
+	if(NULL == hash_map)
+	{
+		return 0;
+	}
+	if(NULL == keys_array)
+	{
+		return 0;
+	}
+
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	for(i=0; i<number_of_elements; i++)
+	{
+		lua_pushnumber(hash_map->luaState, keys_array[i]); /* stack: [key_number, table] */
+		LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_number]; stack: [value, table] */
+		if(LUA_TNIL == lua_type(hash_map->luaState, -1))
+		{
+			Internal_SetBitmap(found_bitmap, i, false);
+		}
+		else
+		{
+			Internal_SetBitmap(found_bitmap, i, true);
+			total_found++;
+		}
+		/* pop the value; keep the table for the next key */
+		lua_pop(hash_map->luaState, 1); /* stack: [table] */
+	}
+
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return total_found;
+}
+
+static size_t Internal_Unlocked_ExistsKeysInteger(LuaHashMap* hash_map, const lua_Integer keys_array[], unsigned char found_bitmap[], size_t number_of_elements)
+{
+	size_t i;
+	size_t total_found = 0;
+	if(NULL == hash_map)
+	{
+		return 0;
+	}
+	if(NULL == keys_array)
+	{
+		return 0;
+	}
+
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	for(i=0; i<number_of_elements; i++)
+	{
+		Internal_GetTableForKeyInteger(hash_map, keys_array[i]); /* table[key_integer]; stack: [value, table] */
+		if(LUA_TNIL == lua_type(hash_map->luaState, -1))
+		{
+			Internal_SetBitmap(found_bitmap, i, false);
+		}
+		else
+		{
+			Internal_SetBitmap(found_bitmap, i, true);
+			total_found++;
+		}
+		/* pop the value; keep the table for the next key */
+		lua_pop(hash_map->luaState, 1); /* stack: [table] */
+	}
+
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return total_found;
+}
+
+static void Internal_Clear(LuaHashMap* hash_map, LuaHashMap_InternalGlobalKeyType table_name)
+{
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, table_name); /* stack: [table] */
+	lua_pushnil(hash_map->luaState);  /* first key */
+	while (lua_next(hash_map->luaState, -2) != 0) /* use index of table */
+	{
+		/* lua_next puts 'key' (at index -2) and 'value' (at index -1) */
+		
+		lua_pop(hash_map->luaState, 1); /* pop the value because we don't need it; stack: [key table] */
+		/* duplicate the key because we want to save a copy of it to be used for the next round of lua_next */
+		lua_pushvalue(hash_map->luaState, -1); /* stack: [key key table] */
+		lua_pushnil(hash_map->luaState); /* stack: [nil, key, key, table] */
+		LUAHASHMAP_SETTABLE(hash_map->luaState, -4);  /* table[key_pointer]=nil; stack: [key table] */
+		
+		/* key is at the top of the stack, ready for next round of lua_next() */
+	}
+	lua_pop(hash_map->luaState, 1); /* pop the table */
+}
+
+/* Only for the asserts in Clear and Purge, which run under the lock already. */
+static bool Internal_Unlocked_IsEmpty(LuaHashMap* hash_map);
+
+static void Internal_Unlocked_Clear(LuaHashMap* hash_map)
+{
+	if(NULL == hash_map)
+	{
+		return;
+	}
+/*	Internal_InitializeInternalTables(hash_map); */
+	/* If we simply replace the current table with a new one, we lose the internal current size of the hash
+	 * which might be painful to reallocate if the user intends to refill the hash with the same amount of data.
+	 * So instead, it is probably better to iterate through all keys and remove them.
+	 * If the user wants to blow away everything for more speed, they can always destroy the hashmap and create a new one.
+     * Lua Gems verifies that removing entries only nils entries and doesn't rehash so 
+     * it is safe to iterate via lua_next while removing items.
+	 * See Purge for clearing that reclaims memory.
+	 */
+
+	Internal_Clear(hash_map, hash_map->uniqueTableNameForSharedState);
+	hash_map->elementCount = 0;
+	hash_map->isElementCountStale = false;
+	
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);	
+	LUAHASHMAP_ASSERT(true == Internal_Unlocked_IsEmpty(hash_map));
+}
+
+
+static void Internal_Unlocked_Purge(LuaHashMap* hash_map)
+{
+	if(NULL == hash_map)
+	{
+		return;
+	}
+	/* Unlike Clear, this version replaces the existing table with a completely new one.
+	 * This effectively purges the memory since Lua normally doesn't reclaim memory when nil-ing an entry.
+	 * The presumption here is you really want the memory back.
+	 */
+	LUAHASHMAP_REPLACE_WITH_EMPTY_TABLE(hash_map->luaState, hash_map->uniqueTableNameForSharedState);
+	hash_map->tableGeneration++;
+	hash_map->elementCount = 0;
+	hash_map->isElementCountStale = false;
+	hash_map->hashCapacityHint = 0;
+	hash_map->arrayCapacityHint = 0;
+	/* If an access session is open, the pinned slot still refers to the old table so swap in the new one. */
+	if(0 != hash_map->pinnedTableStackIndex)
+	{
+		LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [new_table, ..., old_table] */
+		lua_replace(hash_map->luaState, hash_map->pinnedTableStackIndex); /* stack: [..., new_table] */
+	}
+
+	/* Now seems to be a reasonable time to invoke garbage collection. */
+	lua_gc(hash_map->luaState, LUA_GCCOLLECT, 0);
+	Internal_ReapplyStoppedGCMode(hash_map);
+
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);	
+	LUAHASHMAP_ASSERT(true == Internal_Unlocked_IsEmpty(hash_map));
+}
+
+/* Lua has no API to resize an existing table, so the only way to get a table of a specific size
+ * is to create a new one with lua_createtable and copy everything over.
+ * That costs a single O(n) copy instead of the log2(n) cascade of rehashes we'd get by growing naturally.
+ * Iterators into the old table are invalidated since the traversal order of the new table is different.
+ */
+static void Internal_RebuildTable(LuaHashMap* hash_map, int number_of_array_elements, int number_of_hash_elements)
+{
+	lua_createtable(hash_map->luaState, number_of_array_elements, number_of_hash_elements); /* stack: [new_table] */
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [old_table, new_table] */
+
+	lua_pushnil(hash_map->luaState);  /* first key */
+	while (lua_next(hash_map->luaState, -2) != 0) /* use index of table */
+	{
+		/* lua_next puts 'key' (at index -2) and 'value' (at index -1) */
+		/* stack: [value, key, old_table, new_table] */
+		lua_pushvalue(hash_map->luaState, -2); /* stack: [key, value, key, old_table, new_table] */
+		lua_insert(hash_map->luaState, -2); /* stack: [value, key, key, old_table, new_table] */
+		LUAHASHMAP_SETTABLE(hash_map->luaState, -5);  /* new_table[key]=value; stack: [key, old_table, new_table] */
+	}
+	lua_pop(hash_map->luaState, 1); /* stack: [new_table] */
+
+	/* If an access session is open, the pinned slot still refers to the old table so swap in the new one. */
+	if(0 != hash_map->pinnedTableStackIndex)
+	{
+		lua_pushvalue(hash_map->luaState, -1); /* stack: [new_table, new_table] */
+		lua_replace(hash_map->luaState, hash_map->pinnedTableStackIndex); /* stack: [new_table] */
+	}
+	LUAHASHMAP_SETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [] */
+	hash_map->tableGeneration++;
+	hash_map->hashCapacityHint = (size_t)number_of_hash_elements;
+	hash_map->arrayCapacityHint = (size_t)number_of_array_elements;
+
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+}
+
+static void Internal_Unlocked_Reserve(LuaHashMap* hash_map, int number_of_array_elements, int number_of_hash_elements)
+{
+	if(NULL == hash_map)
+	{
+		return;
+	}
+	if(number_of_array_elements < 0)
+	{
+		number_of_array_elements = 0;
+	}
+	if(number_of_hash_elements < 0)
+	{
+		number_of_hash_elements = 0;
+	}
+	/* Reserve only grows. Don't let the new table be smaller than what we already have (or already reserved) 
+	 * or we'd just rehash again during the copy. 
+	 * Fixing up a stale count first raises hashCapacityHint so the two hints cover every entry.
+	 */
+	Internal_GetElementCount(hash_map);
+	if((size_t)number_of_hash_elements < hash_map->hashCapacityHint)
+	{
+		number_of_hash_elements = (int)hash_map->hashCapacityHint;
+	}
+	if((size_t)number_of_array_elements < hash_map->arrayCapacityHint)
+	{
+		number_of_array_elements = (int)hash_map->arrayCapacityHint;
+	}
+	/* Already covered. Rebuilding is O(n) so repeated Reserve calls with the same sizes must be free. */
+	if(((size_t)number_of_hash_elements == hash_map->hashCapacityHint) && ((size_t)number_of_array_elements == hash_map->arrayCapacityHint))
+	{
+		return;
+	}
+	Internal_RebuildTable(hash_map, number_of_array_elements, number_of_hash_elements);
+}
+
+static void Internal_Unlocked_Compact(LuaHashMap* hash_map, bool should_collect_garbage)
+{
+	size_t element_count;
+	size_t number_of_array_elements;
+	if(NULL == hash_map)
+	{
+		return;
+	}
+	/* Rebuild at exactly the live size. This drops all the dead (nil'd) slots that Lua never reclaims on its own. 
+	 * Keys 1..n go in the array part, so size it by the length of the table or they would all land in the hash part.
+	 */
+	element_count = Internal_GetElementCount(hash_map);
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	number_of_array_elements = LUAHASHMAP_RAWLEN(hash_map->luaState, -1);
+	lua_pop(hash_map->luaState, 1); /* stack: [] */
+	if(number_of_array_elements > element_count)
+	{
+		number_of_array_elements = element_count;
+	}
+	Internal_RebuildTable(hash_map, (int)number_of_array_elements, (int)(element_count - number_of_array_elements));
+
+	/* The old table is now garbage. The user may prefer to let the collector get to it at its own pace. */
+	if(should_collect_garbage)
+	{
+		lua_gc(hash_map->luaState, LUA_GCCOLLECT, 0);
+		Internal_ReapplyStoppedGCMode(hash_map);
+	}
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+}
+
+static double Internal_Unlocked_GetUnusedCapacityRatio(LuaHashMap* hash_map)
+{
+	size_t estimated_hash_capacity = 1;
+	size_t estimated_capacity;
+	size_t element_count;
+	if(NULL == hash_map)
+	{
+		return 0.0;
+	}
+	/* Fix up a stale count first since that can also raise hashCapacityHint. */
+	element_count = Internal_GetElementCount(hash_map);
+	if((0 == hash_map->hashCapacityHint) && (0 == hash_map->arrayCapacityHint))
+	{
+		return 0.0;
+	}
+	/* Lua sizes the hash part of a table in powers of 2. */
+	while(estimated_hash_capacity < hash_map->hashCapacityHint)
+	{
+		estimated_hash_capacity <<= 1;
+	}
+	estimated_capacity = estimated_hash_capacity + hash_map->arrayCapacityHint;
+	if(element_count >= estimated_capacity)
+	{
+		return 0.0;
+	}
+	return (double)(estimated_capacity - element_count) / (double)estimated_capacity;
+}
+
+static bool Internal_Unlocked_SetGCMode(LuaHashMap* hash_map, LuaHashMapGCMode gc_mode)
+{
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+	switch(gc_mode)
+	{
+		case LUAHASHMAP_GCMODE_INCREMENTAL:
+		{
+#if LUA_VERSION_NUM == 504
+			lua_gc(hash_map->luaState, LUA_GCINC, 0, 0, 0);
+#elif LUA_VERSION_NUM == 502
+			lua_gc(hash_map->luaState, LUA_GCINC, 0);
+#endif
+			lua_gc(hash_map->luaState, LUA_GCRESTART, 0);
+			break;
+		}
+		case LUAHASHMAP_GCMODE_STOPPED:
+		{
+			lua_gc(hash_map->luaState, LUA_GCSTOP, 0);
+			break;
+		}
+		case LUAHASHMAP_GCMODE_GENERATIONAL:
+		{
+			/* Lua 5.2 had an experimental generational mode which was removed in 5.3 and came back for real in 5.4. */
+#if LUA_VERSION_NUM == 504
+			lua_gc(hash_map->luaState, LUA_GCGEN, 0, 0);
+#elif LUA_VERSION_NUM == 502
+			lua_gc(hash_map->luaState, LUA_GCGEN, 0);
+#else
+			return false;
+#endif
+			lua_gc(hash_map->luaState, LUA_GCRESTART, 0);
+			break;
+		}
+		default:
+		{
+			return false;
+		}
+	}
+	lua_pushinteger(hash_map->luaState, (lua_Integer)gc_mode); /* stack: [gc_mode] */
+	lua_setfield(hash_map->luaState, LUA_REGISTRYINDEX, LUAHASHMAP_GC_MODE_KEY); /* stack: [] */
+	return true;
+}
+
+static LuaHashMapGCMode Internal_Unlocked_GetGCMode(LuaHashMap* hash_map)
+{
+	if(NULL == hash_map)
+	{
+		return LUAHASHMAP_GCMODE_INCREMENTAL;
+	}
+	return Internal_GetGCMode(hash_map);
+}
+
+static bool Internal_Unlocked_GCStep(LuaHashMap* hash_map, int step_size)
+{
+	bool is_cycle_finished;
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+	if(step_size < 0)
+	{
+		step_size = 0;
+	}
+	is_cycle_finished = (0 != lua_gc(hash_map->luaState, LUA_GCSTEP, step_size));
+	Internal_ReapplyStoppedGCMode(hash_map);
+	return is_cycle_finished;
+}
+
+static bool Internal_Unlocked_SetExactIntegerMode(LuaHashMap* hash_map, bool use_exact_integers)
+{
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+#if LUA_VERSION_NUM >= 503
+	/* Native integer subtype. There is nothing to emulate and nothing to turn off. */
+	return use_exact_integers;
+#else
+	if(use_exact_integers == hash_map->useExactIntegers)
+	{
+		return true;
+	}
+	/* Keys already stored under one representation would be unreachable under the other. */
+	if(Internal_GetElementCount(hash_map) > 0)
+	{
+		return false;
+	}
+	if(sizeof(lua_Integer) > sizeof(void*))
+	{
+		return false;
+	}
+	hash_map->useExactIntegers = use_exact_integers;
+	return true;
+#endif
+}
+
+static bool Internal_Unlocked_GetExactIntegerMode(LuaHashMap* hash_map)
+{
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+#if LUA_VERSION_NUM >= 503
+	return true;
+#else
+	return hash_map->useExactIntegers;
+#endif
+}
+
+
+static bool Internal_IsEmpty(LuaHashMap* hash_map, LuaHashMap_InternalGlobalKeyType table_name)
+{
+	bool is_empty;
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, table_name); /* stack: [table] */
+
+	lua_pushnil(hash_map->luaState);  /* first key */
+	if(lua_next(hash_map->luaState, -2) != 0) /* use index of table */
+	{
+		is_empty = false;
+		/* pop key, value, and table */
+		lua_pop(hash_map->luaState, 3);
+	}
+	else
+	{
+		is_empty = true;
+		/* pop table */
+		lua_pop(hash_map->luaState, 1);
+	}
+
+	return is_empty;
+}
+
+static bool Internal_Unlocked_IsEmpty(LuaHashMap* hash_map)
+{
+	bool is_empty = true;
+	if(NULL == hash_map)
+	{
+		return true;
+	}
+
+	is_empty = Internal_IsEmpty(hash_map, hash_map->uniqueTableNameForSharedState);
+
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);		
+
+	return is_empty;
+}
+
+
+static bool Internal_IteratorIsAlreadyNext(LuaHashMapIterator* hash_iterator)
+{
+	hash_iterator->isNext = false;
+	
+	/* This is my clue as to whether we are at an end iterator or not */
+	if(LUA_TNONE == hash_iterator->keyType)
+	{
+		hash_iterator->atEnd = true;
+		/* Memory should already be set correctly */
+		return false;
+	}
+	/* Assumption: Remove already set the currentKey/Value and types so all we need to do is flip the isNext flag. */
+	/* Note: There is a corner case where the cached values could be stale when the user is expecting them to be fresh.
+	hash_iterator = LuaHashMap_GetIteratorAtBegin(hash_map);
+	do
+	{
+		fprintf(stderr, "Removing: Price of %s: %lf\n", 
+			LuaHashMap_GetCachedKeyStringAtIterator(&hash_iterator), 
+			LuaHashMap_GetCachedValueNumberAtIterator(&hash_iterator));
+		LuaHashMap_RemoveAtIterator(&hash_iterator);
+		// Change a value in the hash that happens to be the next position.
+		LuaHashMap_SetValue*ForKey*(...);
+		
+	} while(LuaHashMap_IteratorNext(&hash_iterator));
+	
+	 In this case, the value was already cached in RemoveAtIterator so in the next loop, the value is stale.
+	 However, since this technically wasn't using the iterator APIs to set the value, this is one of the cases GetCached is documented to miss.
+	 For performance reasons, I don't really want to re-fetch the value here. I presume the common case is to iterate and remove
+	 so it doesn't make sense to do a double lookup.
+	 */
+	return true;	
+}
+
+static bool Internal_IteratorNext(LuaHashMapIterator* hash_iterator)
+{
+	LuaHashMap* hash_map = hash_iterator->hashMap;
+	LuaHashMap_InternalGlobalKeyType table_name = hash_iterator->whichTable;
+
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, table_name); /* stack: [table] */
+	
+	 /* first key */
+	if(LUA_TSTRING == hash_iterator->keyType)
+	{
+		lua_pushlstring(hash_map->luaState, hash_iterator->currentKey.theString.stringPointer, hash_iterator->currentKey.theString.stringLength);
+	}
+	else if(LUA_TLIGHTUSERDATA == hash_iterator->keyType)
+	{
+		lua_pushlightuserdata(hash_map->luaState, hash_iterator->currentKey.thePointer);
+	}
+	else if(LUA_TNUMBER == hash_iterator->keyType)
+	{
+		Internal_PushKeyValueNumber(hash_map, &hash_iterator->currentKey, hash_iterator->isKeyInteger);
+	}
+	else
+	{
+		/* shouldn't get here */
+		LUAHASHMAP_ASSERT(false);
+		lua_pop(hash_map->luaState, 1);
+		return false;
+	}
+
+	if(lua_next(hash_map->luaState, -2) != 0) /* use index of table */
+	{
+		hash_iterator->atEnd = false;
+		hash_iterator->keyType = Internal_ToKeyValueType(hash_map, -2, &hash_iterator->currentKey, &hash_iterator->isKeyInteger);
+		hash_iterator->valueType = Internal_ToKeyValueType(hash_map, -1, &hash_iterator->currentValue, &hash_iterator->isValueInteger);
+		/* pop key, value, and table */
+		lua_pop(hash_map->luaState, 3);
+	}
+	else
+	{
+		hash_iterator->atEnd = true;
+		hash_iterator->keyType = LUA_TNONE;
+		hash_iterator->valueType = LUA_TNONE;
+		/* Clear the largest field to make sure every thing is cleared. */
+		memset(&hash_iterator->currentKey, 0, sizeof(union LuaHashMapKeyValueType));
+		memset(&hash_iterator->currentValue, 0, sizeof(union LuaHashMapKeyValueType));
+
+		/* pop table */
+		lua_pop(hash_map->luaState, 1);
+	}
+	
+	/* return true if more keys follow, false if we're at the end */
+	return (false == hash_iterator->atEnd);
+}
+
+static LuaHashMapIterator Internal_GetIteratorBegin(LuaHashMap* hash_map, LuaHashMap_InternalGlobalKeyType table_name)
+{
+	LuaHashMapIterator the_iterator;
+	memset(&the_iterator, 0, sizeof(LuaHashMapIterator));
+	the_iterator.hashMap = hash_map;
+	the_iterator.whichTable = table_name;
+	the_iterator.keyType = LUA_TNONE;
+	the_iterator.valueType = LUA_TNONE;
+
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, table_name); /* stack: [table] */
+	
+	lua_pushnil(hash_map->luaState);  /* first key */
+	if(lua_next(hash_map->luaState, -2) != 0) /* use index of table */
+	{
+		the_iterator.atEnd = false;
+		the_iterator.keyType = Internal_ToKeyValueType(hash_map, -2, &the_iterator.currentKey, &the_iterator.isKeyInteger);
+		the_iterator.valueType = Internal_ToKeyValueType(hash_map, -1, &the_iterator.currentValue, &the_iterator.isValueInteger);
+
+		/* pop key, value, and table */
+		lua_pop(hash_map->luaState, 3);
+	}
+	else
+	{
+		the_iterator.atEnd = true;
+		the_iterator.currentKey.thePointer = NULL;
+		the_iterator.currentValue.thePointer = NULL;
+
+		/* pop table */
+		lua_pop(hash_map->luaState, 1);
+	}
+	
+	return the_iterator;
+}
+
+static LuaHashMapIterator Internal_GetIteratorEnd(LuaHashMap* hash_map, LuaHashMap_InternalGlobalKeyType table_name)
+{
+	LuaHashMapIterator the_iterator;
+	memset(&the_iterator, 0, sizeof(LuaHashMapIterator));
+	the_iterator.hashMap = hash_map;
+	the_iterator.whichTable = table_name;
+	the_iterator.atEnd = true;
+	the_iterator.keyType = LUA_TNONE;	
+	the_iterator.valueType = LUA_TNONE;	
+	/* Clear the largest field to make sure every thing is cleared. */
+	memset(&the_iterator.currentKey, 0, sizeof(union LuaHashMapKeyValueType));
+	memset(&the_iterator.currentValue, 0, sizeof(union LuaHashMapKeyValueType));
+	return the_iterator;
+}
+
+static bool Internal_Unlocked_IteratorNext(LuaHashMapIterator* hash_iterator)
+{
+	if(NULL == hash_iterator)
+	{
+		return false;
+	}
+	if(true == hash_iterator->atEnd)
+	{
+		return false;
+	}
+	if(true == hash_iterator->isNext)
+	{
+		return Internal_IteratorIsAlreadyNext(hash_iterator);
+	}
+	return Internal_IteratorNext(hash_iterator);
+}
+
+static int Internal_Unlocked_ForEach(LuaHashMap* hash_map, LuaHashMap_ForEachCallback callback_function, void* user_data)
+{
+	LuaHashMapIterator the_iterator;
+	int ret_val = 0;
+
+	if(NULL == hash_map)
+	{
+		return 0;
+	}
+	if(NULL == callback_function)
+	{
+		return 0;
+	}
+
+	memset(&the_iterator, 0, sizeof(LuaHashMapIterator));
+	the_iterator.hashMap = hash_map;
+	the_iterator.whichTable = hash_map->uniqueTableNameForSharedState;
+
+	/* Unlike the iterator APIs, we keep the table and the current key on the stack for the whole traversal 
+	 * so each step is a single lua_next without re-fetching the table or re-pushing (and re-hashing) the key.
+	 */
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	lua_pushnil(hash_map->luaState);  /* first key; stack: [nil, table] */
+	while(lua_next(hash_map->luaState, -2) != 0) /* stack: [value, key, table] */
+	{
+		the_iterator.keyType = Internal_ToKeyValueType(hash_map, -2, &the_iterator.currentKey, &the_iterator.isKeyInteger);
+		the_iterator.valueType = Internal_ToKeyValueType(hash_map, -1, &the_iterator.currentValue, &the_iterator.isValueInteger);
+		/* The value is still referenced by the table so any string pointers stay valid during the callback. */
+		lua_pop(hash_map->luaState, 1); /* stack: [key, table] */
+
+		ret_val = callback_function(&the_iterator, user_data);
+		if(0 != ret_val)
+		{
+			/* pop key so the table is left on top of the stack just like when lua_next finishes */
+			lua_pop(hash_map->luaState, 1); /* stack: [table] */
+			break;
+		}
+	}
+
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return ret_val;
+}
+
+static size_t Internal_Unlocked_RemoveIf(LuaHashMap* hash_map, LuaHashMap_RemoveIfPredicate predicate_function, void* user_data)
+{
+	LuaHashMapIterator the_iterator;
+	size_t number_of_removed = 0;
+
+	if(NULL == hash_map)
+	{
+		return 0;
+	}
+	if(NULL == predicate_function)
+	{
+		return 0;
+	}
+	/* We adjust the count as we go, so it must be right to start with. */
+	Internal_GetElementCount(hash_map);
+
+	memset(&the_iterator, 0, sizeof(LuaHashMapIterator));
+	the_iterator.hashMap = hash_map;
+	the_iterator.whichTable = hash_map->uniqueTableNameForSharedState;
+
+	/* Same single lua_next pass as ForEach. 
+	 * As noted in LuaHashMap_Clear, removing entries only nils them and doesn't rehash, 
+	 * so it is safe to remove the current key and keep going with lua_next.
+	 */
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	lua_pushnil(hash_map->luaState);  /* first key; stack: [nil, table] */
+	while(lua_next(hash_map->luaState, -2) != 0) /* stack: [value, key, table] */
+	{
+		the_iterator.keyType = Internal_ToKeyValueType(hash_map, -2, &the_iterator.currentKey, &the_iterator.isKeyInteger);
+		the_iterator.valueType = Internal_ToKeyValueType(hash_map, -1, &the_iterator.currentValue, &the_iterator.isValueInteger);
+		lua_pop(hash_map->luaState, 1); /* stack: [key, table] */
+
+		if(0 != predicate_function(&the_iterator, user_data))
+		{
+			lua_pushvalue(hash_map->luaState, -1); /* stack: [key, key, table] */
+			lua_pushnil(hash_map->luaState); /* stack: [nil, key, key, table] */
+			LUAHASHMAP_SETTABLE(hash_map->luaState, -4);  /* table[key]=nil; stack: [key, table] */
+			number_of_removed++;
+		}
+	}
+	/* Every key we removed existed, so we don't need to look up the old values to keep the count correct. */
+	hash_map->elementCount -= number_of_removed;
+
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return number_of_removed;
+}
+
+/* For the single pass traversals. Expects stack: [value, key, table] and leaves stack: [key, table] so lua_next can continue.
+ * Assigning to a key that already exists during lua_next is safe. (Adding new keys is not.)
+ */
+static LUAHASHMAP_INLINE void Internal_SetTableForTraversedKey(LuaHashMap* hash_map)
+{
+	lua_pushvalue(hash_map->luaState, -2); /* stack: [key, value, key, table] */
+	lua_insert(hash_map->luaState, -2); /* stack: [value, key, key, table] */
+	LUAHASHMAP_SETTABLE(hash_map->luaState, -4);  /* table[key]=value; stack: [key, table] */
+}
+
+static size_t Internal_Unlocked_TransformValues(LuaHashMap* hash_map, LuaHashMap_TransformValuesCallback callback_function, void* user_data)
+{
+	LuaHashMapIterator the_iterator;
+	size_t number_of_changed = 0;
+
+	if(NULL == hash_map)
+	{
+		return 0;
+	}
+	if(NULL == callback_function)
+	{
+		return 0;
+	}
+
+	/* We adjust the count as we go, so it must be right to start with. */
+	Internal_GetElementCount(hash_map);
+
+	memset(&the_iterator, 0, sizeof(LuaHashMapIterator));
+	the_iterator.hashMap = hash_map;
+	the_iterator.whichTable = hash_map->uniqueTableNameForSharedState;
+
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	lua_pushnil(hash_map->luaState);  /* first key; stack: [nil, table] */
+	while(lua_next(hash_map->luaState, -2) != 0) /* stack: [value, key, table] */
+	{
+		the_iterator.keyType = Internal_ToKeyValueType(hash_map, -2, &the_iterator.currentKey, &the_iterator.isKeyInteger);
+		the_iterator.valueType = Internal_ToKeyValueType(hash_map, -1, &the_iterator.currentValue, &the_iterator.isValueInteger);
+		lua_pop(hash_map->luaState, 1); /* stack: [key, table] */
+
+		if(0 == callback_function(&the_iterator, user_data))
+		{
+			continue;
+		}
+
+		switch(the_iterator.valueType)
+		{
+			case LUA_TSTRING:
+			{
+				lua_pushlstring(hash_map->luaState, the_iterator.currentValue.theString.stringPointer, the_iterator.currentValue.theString.stringLength); /* stack: [value_string, key, table] */
+				break;
+			}
+			case LUA_TLIGHTUSERDATA:
+			{
+				lua_pushlightuserdata(hash_map->luaState, the_iterator.currentValue.thePointer); /* stack: [value_pointer, key, table] */
+				break;
+			}
+			case LUA_TNUMBER:
+			{
+				Internal_PushKeyValueNumber(hash_map, &the_iterator.currentValue, the_iterator.isValueInteger); /* stack: [value_number, key, table] */
+				break;
+			}
+			case LUA_TNIL:
+			{
+				/* Removing the current key during lua_next is safe too. */
+				lua_pushnil(hash_map->luaState); /* stack: [nil, key, table] */
+				hash_map->elementCount--;
+				break;
+			}
+			default:
+			{
+				/* shouldn't get here */
+				LUAHASHMAP_ASSERT(false);
+				continue;
+			}
+		}
+		Internal_SetTableForTraversedKey(hash_map); /* table[key]=value; stack: [key, table] */
+		number_of_changed++;
+	}
+
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return number_of_changed;
+}
+
+static size_t Internal_Unlocked_TransformValuesNumber(LuaHashMap* hash_map, LuaHashMap_TransformValuesNumberCallback callback_function, void* user_data)
+{
+	size_t number_of_changed = 0;
+	lua_Number value_number;
+
+	if(NULL == hash_map)
+	{
+		return 0;
+	}
+	if(NULL == callback_function)
+	{
+		return 0;
+	}
+
+	/* Unlike TransformValues, we skip the key conversion and the iterator entirely. */
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	lua_pushnil(hash_map->luaState);  /* first key; stack: [nil, table] */
+	while(lua_next(hash_map->luaState, -2) != 0) /* stack: [value, key, table] */
+	{
+		switch(lua_type(hash_map->luaState, -1))
+		{
+			case LUA_TNUMBER:
+			{
+				value_number = lua_tonumber(hash_map->luaState, -1);
+				break;
+			}
+#if LUA_VERSION_NUM < 503
+			case LUA_TLIGHTUSERDATA:
+			{
+				if(true == hash_map->useExactIntegers)
+				{
+					value_number = (lua_Number)Internal_ToInteger(hash_map, -1);
+					break;
+				}
+				/* Pointers are not numbers. */
+				lua_pop(hash_map->luaState, 1); /* stack: [key, table] */
+				continue;
+			}
+#endif
+			default:
+			{
+				lua_pop(hash_map->luaState, 1); /* stack: [key, table] */
+				continue;
+			}
+		}
+		lua_pop(hash_map->luaState, 1); /* stack: [key, table] */
+		lua_pushnumber(hash_map->luaState, callback_function(value_number, user_data)); /* stack: [value_number, key, table] */
+		Internal_SetTableForTraversedKey(hash_map); /* table[key]=value_number; stack: [key, table] */
+		number_of_changed++;
+	}
+
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return number_of_changed;
+}
+
+static size_t Internal_Unlocked_TransformValuesInteger(LuaHashMap* hash_map, LuaHashMap_TransformValuesIntegerCallback callback_function, void* user_data)
+{
+	size_t number_of_changed = 0;
+	lua_Integer value_integer;
+
+	if(NULL == hash_map)
+	{
+		return 0;
+	}
+	if(NULL == callback_function)
+	{
+		return 0;
+	}
+
+	/* Unlike TransformValues, we skip the key conversion and the iterator entirely. */
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	lua_pushnil(hash_map->luaState);  /* first key; stack: [nil, table] */
+	while(lua_next(hash_map->luaState, -2) != 0) /* stack: [value, key, table] */
+	{
+		int value_type = lua_type(hash_map->luaState, -1);
+#if LUA_VERSION_NUM < 503
+		if((LUA_TLIGHTUSERDATA == value_type) && (true == hash_map->useExactIntegers))
+		{
+			value_type = LUA_TNUMBER;
+		}
+#endif
+		if(LUA_TNUMBER != value_type)
+		{
+			lua_pop(hash_map->luaState, 1); /* stack: [key, table] */
+			continue;
+		}
+#if LUA_VERSION_NUM >= 503
+		{
+			/* lua_tointeger returns 0 for a float with no exact integer value (e.g. 2.5). Skip those instead of overwriting them. */
+			int is_integral;
+			value_integer = lua_tointegerx(hash_map->luaState, -1, &is_integral);
+			if(0 == is_integral)
+			{
+				lua_pop(hash_map->luaState, 1); /* stack: [key, table] */
+				continue;
+			}
+		}
+#else
+		value_integer = Internal_ToInteger(hash_map, -1);
+#endif
+		lua_pop(hash_map->luaState, 1); /* stack: [key, table] */
+		Internal_PushInteger(hash_map, callback_function(value_integer, user_data)); /* stack: [value_integer, key, table] */
+		Internal_SetTableForTraversedKey(hash_map); /* table[key]=value_integer; stack: [key, table] */
+		number_of_changed++;
+	}
+
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return number_of_changed;
+}
+
+/* Reads a number for AggregateNumbers. Returns false if the key or value at stack_index is not a number. */
+static LUAHASHMAP_INLINE bool Internal_ToAggregateNumber(LuaHashMap* hash_map, int stack_index, lua_Number* number_return)
+{
+	switch(lua_type(hash_map->luaState, stack_index))
+	{
+		case LUA_TNUMBER:
+		{
+			*number_return = lua_tonumber(hash_map->luaState, stack_index);
+			return true;
+		}
+#if LUA_VERSION_NUM < 503
+		case LUA_TLIGHTUSERDATA:
+		{
+			if(true == hash_map->useExactIntegers)
+			{
+				*number_return = (lua_Number)Internal_ToInteger(hash_map, stack_index);
+				return true;
+			}
+			return false;
+		}
+#endif
+		default:
+		{
+			return false;
+		}
+	}
+}
+
+static LUAHASHMAP_INLINE void Internal_AddToNumberStats(LuaHashMapNumberStats* number_stats, lua_Number the_number)
+{
+	if(0 == number_stats->count)
+	{
+		number_stats->min = the_number;
+		number_stats->max = the_number;
+	}
+	else if(the_number < number_stats->min)
+	{
+		number_stats->min = the_number;
+	}
+	else if(the_number > number_stats->max)
+	{
+		number_stats->max = the_number;
+	}
+	number_stats->sum += the_number;
+	number_stats->count++;
+}
+
+static void Internal_Unlocked_AggregateNumbers(LuaHashMap* hash_map, LuaHashMapAggregateStats* stats_return)
+{
+	lua_Number the_number;
+
+	if(NULL == stats_return)
+	{
+		return;
+	}
+	memset(stats_return, 0, sizeof(LuaHashMapAggregateStats));
+	if(NULL == hash_map)
+	{
+		return;
+	}
+
+	/* One tight lua_next loop with the key kept on the stack, same as ForEach but without any callbacks. */
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	lua_pushnil(hash_map->luaState);  /* first key; stack: [nil, table] */
+	while(lua_next(hash_map->luaState, -2) != 0) /* stack: [value, key, table] */
+	{
+		if(true == Internal_ToAggregateNumber(hash_map, -1, &the_number))
+		{
+			Internal_AddToNumberStats(&stats_return->values, the_number);
+		}
+		if(true == Internal_ToAggregateNumber(hash_map, -2, &the_number))
+		{
+			Internal_AddToNumberStats(&stats_return->keys, the_number);
+		}
+		lua_pop(hash_map->luaState, 1); /* stack: [key, table] */
+	}
+
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+
+	if(stats_return->values.count > 0)
+	{
+		stats_return->values.mean = stats_return->values.sum / (lua_Number)stats_return->values.count;
+	}
+	if(stats_return->keys.count > 0)
+	{
+		stats_return->keys.mean = stats_return->keys.sum / (lua_Number)stats_return->keys.count;
+	}
+}
+
+/* Registry keys for the Eval state. The chunk cache and environment are per lua_State, so hash maps sharing a lua_State share them. 
+ * The results table holds one anchored result per hash map, keyed by the LuaHashMap pointer.
+ */
+#define LUAHASHMAP_EVAL_CHUNK_CACHE_KEY "LuaHashMap.EvalChunkCache"
+#define LUAHASHMAP_EVAL_ENVIRONMENT_KEY "LuaHashMap.EvalEnvironment"
+#define LUAHASHMAP_EVAL_RESULTS_KEY "LuaHashMap.EvalResults"
+
+/* A LuaHashMap lua_State normally has no libraries loaded since it is only used as a table store, and the user may have put their own globals in it. 
+ * Eval chunks need at least next/pairs, so the first Eval builds a private environment table with a small set of libraries (modeled on linit.c)
+ * and every chunk runs with that as its globals. The lua_State's real globals are never touched.
+ * Leaves stack: [environment]
+ */
+static void Internal_PushEvalEnvironment(lua_State* lua_state)
+{
+	static const luaL_Reg eval_libraries[] =
+	{
+		{ "_G", luaopen_base },
+		{ LUA_STRLIBNAME, luaopen_string },
+		{ LUA_TABLIBNAME, luaopen_table },
+		{ LUA_MATHLIBNAME, luaopen_math },
+		{ NULL, NULL }
+	};
+	/* Base functions that reach outside the environment (files, other globals, the collector) or the process (stdout/stderr). */
+	static const char* const unsafe_functions[] =
+	{
+		"dofile", "loadfile", "load", "loadstring", "require", "module",
+		"getfenv", "setfenv", "collectgarbage", "print", "warn",
+		NULL
+	};
+	const luaL_Reg* the_library;
+	const char* const* the_name;
+	int environment_index;
+
+	lua_getfield(lua_state, LUA_REGISTRYINDEX, LUAHASHMAP_EVAL_ENVIRONMENT_KEY); /* stack: [environment] */
+	if(LUA_TTABLE == lua_type(lua_state, -1))
+	{
+		return;
+	}
+	lua_pop(lua_state, 1); /* stack: [] */
+	lua_newtable(lua_state); /* stack: [environment] */
+	environment_index = lua_gettop(lua_state);
+
+	/* The luaopen_ functions register into whatever the globals are, so point the globals at our environment while they run. */
+#if LUA_VERSION_NUM >= 502
+	lua_rawgeti(lua_state, LUA_REGISTRYINDEX, LUA_RIDX_GLOBALS); /* stack: [globals, environment] */
+	lua_pushvalue(lua_state, environment_index); /* stack: [environment, globals, environment] */
+	lua_rawseti(lua_state, LUA_REGISTRYINDEX, LUA_RIDX_GLOBALS); /* stack: [globals, environment] */
+#else
+	/* 5.1's luaL_register also reuses anything already in package.loaded, which would hand us the real _G if the user opened the libraries. */
+	lua_pushvalue(lua_state, LUA_GLOBALSINDEX); /* stack: [globals, environment] */
+	lua_getfield(lua_state, LUA_REGISTRYINDEX, "_LOADED"); /* stack: [loaded, globals, environment] */
+	lua_pushvalue(lua_state, environment_index); /* stack: [environment, loaded, globals, environment] */
+	lua_replace(lua_state, LUA_GLOBALSINDEX); /* stack: [loaded, globals, environment] */
+	lua_newtable(lua_state); /* stack: [private_loaded, loaded, globals, environment] */
+	lua_setfield(lua_state, LUA_REGISTRYINDEX, "_LOADED"); /* stack: [loaded, globals, environment] */
+#endif
+
+	for(the_library = eval_libraries; NULL != the_library->func; the_library++)
+	{
+		lua_pushcfunction(lua_state, the_library->func); /* stack: [luaopen, ...] */
+		lua_pushstring(lua_state, the_library->name); /* stack: [name, luaopen, ...] */
+		lua_call(lua_state, 1, 1); /* stack: [library, ...] */
+		lua_setfield(lua_state, environment_index, the_library->name); /* stack: [...] */
+	}
+
+#if LUA_VERSION_NUM >= 502
+	lua_rawseti(lua_state, LUA_REGISTRYINDEX, LUA_RIDX_GLOBALS); /* stack: [environment] */
+#else
+	lua_setfield(lua_state, LUA_REGISTRYINDEX, "_LOADED"); /* stack: [globals, environment] */
+	lua_replace(lua_state, LUA_GLOBALSINDEX); /* stack: [environment] */
+#endif
+
+	for(the_name = unsafe_functions; NULL != *the_name; the_name++)
+	{
+		lua_pushnil(lua_state); /* stack: [nil, environment] */
+		lua_setfield(lua_state, environment_index, *the_name); /* stack: [environment] */
+	}
+	lua_pushvalue(lua_state, environment_index); /* stack: [environment, environment] */
+	lua_setfield(lua_state, LUA_REGISTRYINDEX, LUAHASHMAP_EVAL_ENVIRONMENT_KEY); /* stack: [environment] */
+}
+
+/* Leaves stack: [function] on success or [error_message] on failure and returns the load status.
+ * Compiled chunks are cached in a table keyed by the chunk source itself.
+ * Lua hashes the source string for the table look up, so a repeated chunk costs a hash and compare instead of a parse.
+ */
+static int Internal_PushEvalChunk(LuaHashMap* restrict hash_map, const char* restrict lua_chunk, size_t lua_chunk_length)
+{
+	int ret_val = 0;
+
+	lua_getfield(hash_map->luaState, LUA_REGISTRYINDEX, LUAHASHMAP_EVAL_CHUNK_CACHE_KEY); /* stack: [cache] */
+	if(LUA_TTABLE != lua_type(hash_map->luaState, -1))
+	{
+		/* First Eval on this lua_State, or the cache was cleared */
+		lua_pop(hash_map->luaState, 1); /* stack: [] */
+		lua_newtable(hash_map->luaState); /* stack: [cache] */
+		lua_pushvalue(hash_map->luaState, -1); /* stack: [cache, cache] */
+		lua_setfield(hash_map->luaState, LUA_REGISTRYINDEX, LUAHASHMAP_EVAL_CHUNK_CACHE_KEY); /* stack: [cache] */
+	}
+
+	lua_pushlstring(hash_map->luaState, lua_chunk, lua_chunk_length); /* stack: [source, cache] */
+	lua_pushvalue(hash_map->luaState, -1); /* stack: [source, source, cache] */
+	lua_rawget(hash_map->luaState, -3); /* cache[source]; stack: [cached_function, source, cache] */
+	if(LUA_TFUNCTION != lua_type(hash_map->luaState, -1))
+	{
+		lua_pop(hash_map->luaState, 1); /* stack: [source, cache] */
+		/* Source only. Lua doesn't verify bytecode, so a malformed precompiled chunk could corrupt memory no matter what environment it runs in. */
+#if LUA_VERSION_NUM >= 502
+		ret_val = luaL_loadbufferx(hash_map->luaState, lua_chunk, lua_chunk_length, "=LuaHashMap_Eval", "t"); /* stack: [function or error_message, source, cache] */
+#else
+		if((lua_chunk_length > 0) && (LUA_SIGNATURE[0] == lua_chunk[0]))
+		{
+			lua_pushliteral(hash_map->luaState, "LuaHashMap_Eval: attempt to load a binary chunk"); /* stack: [error_message, source, cache] */
+			ret_val = LUA_ERRSYNTAX;
+		}
+		else
+		{
+			ret_val = luaL_loadbuffer(hash_map->luaState, lua_chunk, lua_chunk_length, "=LuaHashMap_Eval"); /* stack: [function or error_message, source, cache] */
+		}
+#endif
+		if(0 == ret_val)
+		{
+			Internal_PushEvalEnvironment(hash_map->luaState); /* stack: [environment, function, source, cache] */
+#if LUA_VERSION_NUM >= 502
+			/* A main chunk's only upvalue is _ENV. */
+			if(NULL == lua_setupvalue(hash_map->luaState, -2, 1)) /* stack: [function, source, cache] */
+			{
+				lua_pop(hash_map->luaState, 1);
+			}
+#else
+			lua_setfenv(hash_map->luaState, -2); /* stack: [function, source, cache] */
+#endif
+			lua_pushvalue(hash_map->luaState, -1); /* stack: [function, function, source, cache] */
+			lua_insert(hash_map->luaState, -3); /* stack: [function, source, function, cache] */
+			lua_rawset(hash_map->luaState, -4); /* cache[source]=function; stack: [function, cache] */
+			lua_remove(hash_map->luaState, -2); /* stack: [function] */
+			return ret_val;
+		}
+	}
+	/* stack: [function or error_message, source, cache] */
+	lua_replace(hash_map->luaState, -3); /* stack: [source, function or error_message] */
+	lua_pop(hash_map->luaState, 1); /* stack: [function or error_message] */
+	return ret_val;
+}
+
+/* Anchors the value on top of the stack as this hash map's Eval result, replacing the previous one. Stack is unchanged.
+ * Pass a nil to just release it.
+ */
+static void Internal_SetEvalResult(LuaHashMap* hash_map)
+{
+	lua_getfield(hash_map->luaState, LUA_REGISTRYINDEX, LUAHASHMAP_EVAL_RESULTS_KEY); /* stack: [results, result] */
+	if(LUA_TTABLE != lua_type(hash_map->luaState, -1))
+	{
+		lua_pop(hash_map->luaState, 1); /* stack: [result] */
+		if(lua_isnil(hash_map->luaState, -1))
+		{
+			/* Nothing was ever anchored */
+			return;
+		}
+		lua_newtable(hash_map->luaState); /* stack: [results, result] */
+		lua_pushvalue(hash_map->luaState, -1); /* stack: [results, results, result] */
+		lua_setfield(hash_map->luaState, LUA_REGISTRYINDEX, LUAHASHMAP_EVAL_RESULTS_KEY); /* stack: [results, result] */
+	}
+	lua_pushlightuserdata(hash_map->luaState, hash_map); /* stack: [hash_map, results, result] */
+	lua_pushvalue(hash_map->luaState, -3); /* stack: [result, hash_map, results, result] */
+	lua_rawset(hash_map->luaState, -3); /* results[hash_map]=result; stack: [results, result] */
+	lua_pop(hash_map->luaState, 1); /* stack: [result] */
+}
+
+static void Internal_PushEvalValue(LuaHashMap* hash_map, const LuaHashMapValue* the_value)
+{
+	switch(the_value->valueType)
+	{
+		case LUA_TSTRING:
+		{
+			lua_pushlstring(hash_map->luaState, the_value->theValue.theString.stringPointer, the_value->theValue.theString.stringLength);
+			break;
+		}
+		case LUA_TLIGHTUSERDATA:
+		{
+			lua_pushlightuserdata(hash_map->luaState, the_value->theValue.thePointer);
+			break;
+		}
+		case LUA_TNUMBER:
+		{
+			Internal_PushKeyValueNumber(hash_map, &the_value->theValue, the_value->isInteger);
+			break;
+		}
+		case LUA_TBOOLEAN:
+		{
+			lua_pushboolean(hash_map->luaState, 0 != the_value->theValue.theInteger);
+			break;
+		}
+		default:
+		{
+			lua_pushnil(hash_map->luaState);
+			break;
+		}
+	}
+}
+
+static void Internal_ToEvalValue(LuaHashMap* hash_map, int stack_index, LuaHashMapValue* the_value)
+{
+	if(LUA_TBOOLEAN == lua_type(hash_map->luaState, stack_index))
+	{
+		the_value->valueType = LUA_TBOOLEAN;
+		the_value->isInteger = true;
+		the_value->theValue.theInteger = lua_toboolean(hash_map->luaState, stack_index);
+		return;
+	}
+	the_value->valueType = Internal_ToKeyValueType(hash_map, stack_index, &the_value->theValue, &the_value->isInteger);
+}
+
+static bool Internal_Unlocked_Eval(LuaHashMap* restrict hash_map, const char* restrict lua_chunk, size_t lua_chunk_length, const LuaHashMapValue* restrict arguments_array, size_t number_of_arguments, LuaHashMapValue* restrict result_return)
+{
+	int ret_val;
+	size_t i;
+
+	if(NULL == hash_map)
+	{
+		return false;
+	}
+	if(NULL == lua_chunk)
+	{
+		return false;
+	}
+	if(NULL == arguments_array)
+	{
+		number_of_arguments = 0;
+	}
+	/* function + table + arguments */
+	if((number_of_arguments > (size_t)(INT_MAX - 2)) || (0 == lua_checkstack(hash_map->luaState, (int)number_of_arguments + 2)))
+	{
+		return false;
+	}
+
+	ret_val = Internal_PushEvalChunk(hash_map, lua_chunk, lua_chunk_length); /* stack: [function or error_message] */
+	if(0 == ret_val)
+	{
+		LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table, function] */
+		for(i=0; i<number_of_arguments; i++)
+		{
+			Internal_PushEvalValue(hash_map, &arguments_array[i]); /* stack: [arguments..., table, function] */
+		}
+		ret_val = lua_pcall(hash_map->luaState, (int)number_of_arguments + 1, 1, 0); /* stack: [result or error_message] */
+		/* The chunk may have added or removed keys. Recounting now would make every small Eval O(n), so defer it until the count is needed. */
+		hash_map->isElementCountStale = true;
+		hash_map->tableGeneration++;
+	}
+
+	/* Keep the result referenced until the next Eval on this hash map so a returned string stays valid after we pop it. */
+	Internal_SetEvalResult(hash_map); /* stack: [result] */
+	if(NULL != result_return)
+	{
+		Internal_ToEvalValue(hash_map, -1, result_return);
+	}
+	lua_pop(hash_map->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return (0 == ret_val);
+}
+
+static void Internal_Unlocked_ClearEvalCache(LuaHashMap* hash_map)
+{
+	if(NULL == hash_map)
+	{
+		return;
+	}
+	/* The next Eval creates a new cache. The environment is kept. */
+	lua_pushnil(hash_map->luaState);
+	lua_setfield(hash_map->luaState, LUA_REGISTRYINDEX, LUAHASHMAP_EVAL_CHUNK_CACHE_KEY);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+}
+
+static LuaHashMapIterator Internal_CreateBadIterator()
+{
+	LuaHashMapIterator the_iterator;
+	memset(&the_iterator, 0, sizeof(LuaHashMapIterator));
+	the_iterator.whichTable = LUA_NOREF;
+	the_iterator.atEnd = true;
+	the_iterator.keyType = LUA_TNONE;
+	the_iterator.valueType = LUA_TNONE;
+	return the_iterator;
+}
+
+/* Stuff for public inline functions */
+#if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 199901L)
+/* Using C99 inline. These need to be externed (but not redefined) here to force compilation unit/linkage requirements by C99. */
+extern bool LuaHashMap_IteratorIsNotFound(const LuaHashMapIterator* hash_iterator);
+#else /* We are not using C99 inline so the implementation must be here. */
+bool LuaHashMap_IteratorIsNotFound(const LuaHashMapIterator* hash_iterator)
+{
+	if(NULL == hash_iterator)
+	{
+		return true;
+	}
+	/* To make this distinct from a good iterator and an end iterator, whichTable==LUA_NOREF seems to be the only unique characteristic. */
+	if(LUA_NOREF == hash_iterator->whichTable)
+	{
+		return true;
+	}
+	else
+	{
+		return false;		
+	}
+}
+#endif /* defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 199901L) */
+
+static LuaHashMapIterator Internal_Unlocked_GetIteratorAtBegin(LuaHashMap* hash_map)
+{
+	if(NULL == hash_map)
+	{
+		return Internal_CreateBadIterator();
+	}
+	return Internal_GetIteratorBegin(hash_map, hash_map->uniqueTableNameForSharedState);
+}
+
+static LuaHashMapIterator Internal_Unlocked_GetIteratorAtEnd(LuaHashMap* hash_map)
+{
+	return Internal_GetIteratorEnd(hash_map, hash_map->uniqueTableNameForSharedState);
+}
+
+static void Internal_SetCurrentValueInIteratorFromStackIndex(LuaHashMapIterator* the_iterator, int stack_index)
+{
+	int value_type = lua_type(the_iterator->hashMap->luaState, stack_index);
+	switch(value_type)
+	{
+		case LUA_TSTRING:
+		case LUA_TLIGHTUSERDATA:
+		case LUA_TUSERDATA:
+		case LUA_TNUMBER:
+		{
+			break;
+		}
+		default:
+		{
+			/* shouldn't get here */
+			LUAHASHMAP_ASSERT(false);
+			return;
+		}
+	}
+	the_iterator->valueType = Internal_ToKeyValueType(the_iterator->hashMap, stack_index, &the_iterator->currentValue, &the_iterator->isValueInteger);
+}
+
+static LuaHashMapIterator Internal_GetIteratorForKeyStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length)
+{
+	const char* internalized_key_string = NULL;
+	int value_type;
+	LuaHashMapIterator the_iterator;
+	
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	/* pushes the string on the stack and sets internalized_key_string to the internalized Lua string pointer. */
+	LUAHASHMAP_PUSHLSTRING_AND_ASSIGNINTERNALSTRING(hash_map->luaState, key_string, key_string_length, internalized_key_string); /* stack: [key_string, table] */
+	LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_string]; stack: [value, table] */
+	
+	
+	value_type = lua_type(hash_map->luaState, -1);
+	if(LUA_TNIL == value_type)
+	{
+		/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
+		lua_pop(hash_map->luaState, 2);
+		LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);			
+		return Internal_CreateBadIterator();
+	}
+	
+	memset(&the_iterator, 0, sizeof(LuaHashMapIterator));
+	the_iterator.hashMap = hash_map;
+	the_iterator.whichTable = hash_map->uniqueTableNameForSharedState;
+	the_iterator.keyType = LUA_TSTRING;
+	/* Make sure to use the Lua internalized string and not the passed in string in case the string passed into this function gets released. */
+	the_iterator.currentKey.theString.stringPointer = internalized_key_string;
+	the_iterator.currentKey.theString.stringLength = key_string_length;
+
+	switch(value_type)
+	{
+		case LUA_TSTRING:
+		case LUA_TLIGHTUSERDATA:
+		case LUA_TUSERDATA:
+		case LUA_TNUMBER:
+		{
+			break;
+		}
+		default:
+		{
+			/* shouldn't get here */
+			LUAHASHMAP_ASSERT(false);
+			
+			/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
+			lua_pop(hash_map->luaState, 2);
+			LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);			
+			return Internal_CreateBadIterator();
+		}
+	}
+	
+	Internal_SetCurrentValueInIteratorFromStackIndex(&the_iterator, -1);
+	
+	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 2);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);	
+		
+	return the_iterator;
+}
+
+static LuaHashMapIterator Internal_Unlocked_GetIteratorForKeyString(LuaHashMap* restrict hash_map, const char* restrict key_string)
+{
+	if(NULL == hash_map)
+	{
+		return Internal_CreateBadIterator();
+	}
+	if(NULL == key_string)
+	{
+		return Internal_CreateBadIterator();
+	}
+	return Internal_GetIteratorForKeyStringWithLength(hash_map, key_string, strlen(key_string));
+}
+
+static LuaHashMapIterator Internal_Unlocked_GetIteratorForKeyStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length)
+{
+	if(NULL == hash_map)
+	{
+		return Internal_CreateBadIterator();
+	}
+	if(NULL == key_string)
+	{
+		return Internal_CreateBadIterator();
+	}
+	return Internal_GetIteratorForKeyStringWithLength(hash_map, key_string, key_string_length);
+}
+
+static LuaHashMapIterator Internal_Unlocked_GetIteratorForKeyPointer(LuaHashMap* hash_map, void* key_pointer)
+{
+	int value_type;
+	LuaHashMapIterator the_iterator;
+	if(NULL == hash_map)
+	{
+		return Internal_CreateBadIterator();
+	}
+
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	lua_pushlightuserdata(hash_map->luaState, key_pointer); /* stack: [key_pointer, table] */
+	LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_pointer]; stack: [value_pointer, table] */
+	
+	value_type = lua_type(hash_map->luaState, -1);
+	if(LUA_TNIL == value_type)
+	{
+		/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
+		lua_pop(hash_map->luaState, 2);
+		LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);			
+		return Internal_CreateBadIterator();
+	}
+	
+	memset(&the_iterator, 0, sizeof(LuaHashMapIterator));
+	the_iterator.hashMap = hash_map;
+	the_iterator.whichTable = hash_map->uniqueTableNameForSharedState;
+	the_iterator.keyType = LUA_TLIGHTUSERDATA;		
+	the_iterator.currentKey.thePointer = key_pointer;
+
+	switch(value_type)
+	{
+		case LUA_TSTRING:
+		case LUA_TLIGHTUSERDATA:
+		case LUA_TUSERDATA:
+		case LUA_TNUMBER:
+		{
+			break;
+		}
+		default:
+		{
+			/* shouldn't get here */
+			LUAHASHMAP_ASSERT(false);
+			
+			/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
+			lua_pop(hash_map->luaState, 2);
+			LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);			
+			return Internal_CreateBadIterator();
+		}
+	}
+	
+	Internal_SetCurrentValueInIteratorFromStackIndex(&the_iterator, -1);
+	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 2);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);	
+		
+	return the_iterator;
+}
+
+static LuaHashMapIterator Internal_Unlocked_GetIteratorForKeyNumber(LuaHashMap* hash_map, lua_Number key_number)
+{
+	int value_type;
+	LuaHashMapIterator the_iterator;
+	if(NULL == hash_map)
+	{
+		return Internal_CreateBadIterator();
+	}
+	
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	lua_pushnumber(hash_map->luaState, key_number); /* stack: [key_number, table] */
+	LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_number]; stack: [value_pointer, table] */
+	
+	value_type = lua_type(hash_map->luaState, -1);
+	if(LUA_TNIL == value_type)
+	{
+		/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
+		lua_pop(hash_map->luaState, 2);
+		LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);			
+		return Internal_CreateBadIterator();
+	}
+	
+	memset(&the_iterator, 0, sizeof(LuaHashMapIterator));
+	the_iterator.hashMap = hash_map;
+	the_iterator.whichTable = hash_map->uniqueTableNameForSharedState;
+	the_iterator.keyType = LUA_TNUMBER;
+	the_iterator.currentKey.theNumber = key_number;
+#if LUA_VERSION_NUM >= 503
+	/* Lua 5.3+ stores a float key with an integral value as an integer key, and lua_next won't accept the float form. */
+	{
+		lua_Integer key_as_integer;
+		if(lua_numbertointeger(key_number, &key_as_integer) && (lua_Number)key_as_integer == key_number)
+		{
+			the_iterator.currentKey.theInteger = key_as_integer;
+			the_iterator.isKeyInteger = true;
+		}
+	}
+#endif
+
+	switch(value_type)
+	{
+		case LUA_TSTRING:
+		case LUA_TLIGHTUSERDATA:
+		case LUA_TUSERDATA:
+		case LUA_TNUMBER:
+		{
+			break;
+		}
+		default:
+		{
+			/* shouldn't get here */
+			LUAHASHMAP_ASSERT(false);
+			
+			/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
+			lua_pop(hash_map->luaState, 2);
+			LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);			
+			return Internal_CreateBadIterator();
+		}
+	}
+	
+	Internal_SetCurrentValueInIteratorFromStackIndex(&the_iterator, -1);
+
+	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 2);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);	
+		
+	return the_iterator;
+}
+
+
+
+static LuaHashMapIterator Internal_Unlocked_GetIteratorForKeyInteger(LuaHashMap* hash_map, lua_Integer key_integer)
+{
+	int value_type;
+	LuaHashMapIterator the_iterator;
+	if(NULL == hash_map)
+	{
+		return Internal_CreateBadIterator();
+	}
+	
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	Internal_GetTableForKeyInteger(hash_map, key_integer); /* table[key_integer]; stack: [value_pointer, table] */
+	
+	value_type = lua_type(hash_map->luaState, -1);
+	if(LUA_TNIL == value_type)
+	{
+		/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
+		lua_pop(hash_map->luaState, 2);
+		LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);			
+		return Internal_CreateBadIterator();
+	}
+	
+	memset(&the_iterator, 0, sizeof(LuaHashMapIterator));
+	the_iterator.hashMap = hash_map;
+	the_iterator.whichTable = hash_map->uniqueTableNameForSharedState;
+	the_iterator.keyType = LUA_TNUMBER;
+	the_iterator.currentKey.theInteger = key_integer;
+	the_iterator.isKeyInteger = true;
+
+	switch(value_type)
+	{
+		case LUA_TSTRING:
+		case LUA_TLIGHTUSERDATA:
+		case LUA_TUSERDATA:
+		case LUA_TNUMBER:
+		{
+			break;
+		}
+		default:
+		{
+			/* shouldn't get here */
+			LUAHASHMAP_ASSERT(false);
+
+			/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
+			lua_pop(hash_map->luaState, 2);
+			LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);			
+			return Internal_CreateBadIterator();
+		}
+	}
+	
+	Internal_SetCurrentValueInIteratorFromStackIndex(&the_iterator, -1);
+
+	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_map->luaState, 2);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);	
+		
+	return the_iterator;
+}
+
+/*
+static int Internal_safestrcmp(const char* str1, const char* str2)
+{
+	if(NULL == str1 && NULL == str2)
+	{
+		return 0;
+	}
+	else if(NULL == str1)
+	{
+		return 1;
+	}
+	else if(NULL == str2)
+	{
+		return -1;
+	}
+	else
+	{
+		return strcmp(str1, str2);
+	}
+}
+*/
+
+/* Can be faster than safestrcmp since it can use the string length to compare and doesn't need to return greater-than/less-than. */
+static bool Internal_safestrequal(const char* str1, size_t length1, const char* str2, size_t length2)
+{
+	if(NULL == str1 && NULL == str2)
+	{
+		return true;
+	}
+	else if(length1 != length2)
+	{
+		return false;
+	}
+	else if(NULL == str1)
+	{
+		return false;
+	}
+	else if(NULL == str2)
+	{
+		return false;
+	}
+	else
+	{
+		return (0 == strcmp(str1, str2));
+	}
+}
+
+bool LuaHashMap_IteratorIsEqual(const LuaHashMapIterator* hash_iterator1, const LuaHashMapIterator* hash_iterator2)
+{
+	if(NULL == hash_iterator1 && NULL == hash_iterator2)
+	{
+		return true;
+	}
+	else if(NULL == hash_iterator1)
+	{
+		return false;
+	}
+	else if(NULL == hash_iterator2)
+	{
+		return false;
+	}
+	else
+	{
+		/* Note: Don't test against keyType because when I create an End iterator, I don't know the type. */
+		bool ret_flag = (hash_iterator1->hashMap == hash_iterator2->hashMap)
+			&& (hash_iterator1->whichTable == hash_iterator2->whichTable)
+			&& (hash_iterator1->atEnd == hash_iterator2->atEnd)
+		;
+		if(false == ret_flag)
+		{
+			return false;
+		}
+		/* If the iterators are both atEnd, we can consider them equal. */
+		if(true == hash_iterator1->atEnd)
+		{
+			return true;
+		}
+		 
+		
+		if(LUA_TSTRING == hash_iterator1->keyType)
+		{
+			return (0 == Internal_safestrequal(hash_iterator1->currentKey.theString.stringPointer, hash_iterator1->currentKey.theString.stringLength, hash_iterator2->currentKey.theString.stringPointer, hash_iterator2->currentKey.theString.stringLength));
+		}
+		else if(LUA_TLIGHTUSERDATA == hash_iterator1->keyType)
+		{
+			return (hash_iterator1->currentKey.thePointer == hash_iterator2->currentKey.thePointer);
+		}
+		else if(LUA_TNUMBER == hash_iterator1->keyType)
+		{
+			if(hash_iterator1->isKeyInteger && hash_iterator2->isKeyInteger)
+			{
+				return (hash_iterator1->currentKey.theInteger == hash_iterator2->currentKey.theInteger);
+			}
+			/* This line is correct! Clang's -Wfloat-equal (-Weverything) complains about this line. Ignore that warning. */
+			return ((hash_iterator1->isKeyInteger ? (lua_Number)hash_iterator1->currentKey.theInteger : hash_iterator1->currentKey.theNumber)
+				== (hash_iterator2->isKeyInteger ? (lua_Number)hash_iterator2->currentKey.theInteger : hash_iterator2->currentKey.theNumber));
+		}
+		else
+		{
+			/* shouldn't get here */
+			LUAHASHMAP_ASSERT(false);
+			return false;
+		}
+	}
+}
+
+
+/* Helper function for LuaHashMap_SetValue*AtIterator. This pushes the table and key onto the stack provided from the iterator.
+ * It is expected to be immediately followed by pushing the value and calling settable.
+ * This should not fail. Validation checking is expected to be done before this.
+ */
+static void Internal_PushTableAndKeyInIterator(LuaHashMapIterator* hash_iterator)
+{
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_iterator->hashMap, hash_iterator->hashMap->uniqueTableNameForSharedState); /* stack: [table] */
+
+	switch(hash_iterator->keyType)
+	{
+		case LUA_TSTRING:
+		{
+			lua_pushlstring(hash_iterator->hashMap->luaState, hash_iterator->currentKey.theString.stringPointer, hash_iterator->currentKey.theString.stringLength); /* stack: [key_string, table] */
+			break;
+		}
+		case LUA_TLIGHTUSERDATA:
+		case LUA_TUSERDATA:
+		{
+			lua_pushlightuserdata(hash_iterator->hashMap->luaState, hash_iterator->currentKey.thePointer); /* stack: [key_pointer, table] */
+			break;
+		}
+		case LUA_TNUMBER:
+		{
+			Internal_PushKeyValueNumber(hash_iterator->hashMap, &hash_iterator->currentKey, hash_iterator->isKeyInteger); /* stack: [key_number, table] */
+			break;
+		}
+		default:
+		{
+			/* shouldn't get here */
+			LUAHASHMAP_ASSERT(false);
+			
+			/* pop LUAHASHMAP_GETGLOBAL_UNIQUESTRING */
+			lua_pop(hash_iterator->hashMap->luaState, 1);
+		}
+	}
+}
+
+static size_t Internal_Unlocked_IteratorNextBatch(LuaHashMapIterator* restrict hash_iterator, LuaHashMapValue* restrict keys_array, LuaHashMapValue* restrict values_array, size_t max_number_of_elements)
+{
+	LuaHashMap* hash_map;
+	size_t number_of_elements = 0;
+
+	if(NULL == hash_iterator)
+	{
+		return 0;
+	}
+	/* This also covers the not found iterator. */
+	if(true == hash_iterator->atEnd)
+	{
+		return 0;
+	}
+	if((NULL == keys_array) || (0 == max_number_of_elements))
+	{
+		return 0;
+	}
+	/* If the current entry was removed, the cached key/value already hold the next entry so just start from there. */
+	if(true == hash_iterator->isNext)
+	{
+		if(false == Internal_IteratorIsAlreadyNext(hash_iterator))
+		{
+			return 0;
+		}
+	}
+	hash_map = hash_iterator->hashMap;
+
+	Internal_PushTableAndKeyInIterator(hash_iterator); /* stack: [key, table] */
+	/* Re-fetch the current value instead of trusting the cached one in case it was changed since. This is once per batch. */
+	lua_pushvalue(hash_map->luaState, -1); /* stack: [key, key, table] */
+	LUAHASHMAP_GETTABLE(hash_map->luaState, -3);  /* table[key]; stack: [value, key, table] */
+
+	while(true)
+	{
+		/* The current key may have been removed behind the iterator's back. lua_next can still continue from it, but we don't report it. */
+		if(LUA_TNIL != lua_type(hash_map->luaState, -1))
+		{
+			keys_array[number_of_elements].valueType = Internal_ToKeyValueType(hash_map, -2, &keys_array[number_of_elements].theValue, &keys_array[number_of_elements].isInteger);
+			if(NULL != values_array)
+			{
+				values_array[number_of_elements].valueType = Internal_ToKeyValueType(hash_map, -1, &values_array[number_of_elements].theValue, &values_array[number_of_elements].isInteger);
+			}
+			number_of_elements++;
+		}
+		lua_pop(hash_map->luaState, 1); /* stack: [key, table] */
+
+		if(lua_next(hash_map->luaState, -2) == 0) /* stack: [value, key, table] */
+		{
+			/* stack: [table] */
+			hash_iterator->atEnd = true;
+			hash_iterator->isNext = false;
+			hash_iterator->keyType = LUA_TNONE;
+			hash_iterator->valueType = LUA_TNONE;
+			/* Clear the largest field to make sure every thing is cleared. */
+			memset(&hash_iterator->currentKey, 0, sizeof(union LuaHashMapKeyValueType));
+			memset(&hash_iterator->currentValue, 0, sizeof(union LuaHashMapKeyValueType));
+			/* pop table */
+			lua_pop(hash_map->luaState, 1);
+			break;
+		}
+		if(number_of_elements == max_number_of_elements)
+		{
+			/* Leave the iterator on the first entry we didn't read so the next batch starts there. */
+			hash_iterator->isNext = false;
+			hash_iterator->keyType = Internal_ToKeyValueType(hash_map, -2, &hash_iterator->currentKey, &hash_iterator->isKeyInteger);
+			hash_iterator->valueType = Internal_ToKeyValueType(hash_map, -1, &hash_iterator->currentValue, &hash_iterator->isValueInteger);
+			/* pop key, value, and table */
+			lua_pop(hash_map->luaState, 3);
+			break;
+		}
+	}
+
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return number_of_elements;
+}
+
+static void Internal_Unlocked_CursorReset(LuaHashMapCursor* hash_cursor);
+
+static LuaHashMapCursor* Internal_Unlocked_CreateCursor(LuaHashMap* hash_map)
+{
+	LuaHashMapCursor* hash_cursor;
+	if(NULL == hash_map)
+	{
+		return NULL;
+	}
+	if(NULL != hash_map->memoryAllocator)
+	{
+		hash_cursor = (LuaHashMapCursor*)(*hash_map->memoryAllocator)(hash_map->allocatorUserData, NULL, 0, sizeof(LuaHashMapCursor));
+	}
+	else
+	{
+		hash_cursor = (LuaHashMapCursor*)malloc(sizeof(LuaHashMapCursor));
+	}
+	if(NULL == hash_cursor)
+	{
+		return NULL;
+	}
+	memset(hash_cursor, 0, sizeof(LuaHashMapCursor));
+	hash_cursor->theIterator.hashMap = hash_map;
+	hash_cursor->theIterator.whichTable = hash_map->uniqueTableNameForSharedState;
+
+	/* Each cursor gets its own thread so its traversal state lives on its own stack 
+	 * and doesn't fight with the main stack, access sessions, or any other cursor.
+	 */
+	hash_cursor->threadState = lua_newthread(hash_map->luaState); /* stack: [thread] */
+	hash_cursor->threadReference = luaL_ref(hash_map->luaState, LUA_REGISTRYINDEX); /* stack: [] */
+
+	Internal_Unlocked_CursorReset(hash_cursor);
+
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return hash_cursor;
+}
+
+static void Internal_Unlocked_FreeCursor(LuaHashMapCursor* hash_cursor)
+{
+	LuaHashMap* hash_map;
+	if(NULL == hash_cursor)
+	{
+		return;
+	}
+	hash_map = hash_cursor->theIterator.hashMap;
+	/* Dropping the reference lets the collector reclaim the thread along with the key and table it holds. */
+	luaL_unref(hash_map->luaState, LUA_REGISTRYINDEX, hash_cursor->threadReference);
+	if(NULL != hash_map->memoryAllocator)
+	{
+		(*hash_map->memoryAllocator)(hash_map->allocatorUserData, hash_cursor, sizeof(LuaHashMapCursor), 0);
+	}
+	else
+	{
+		free(hash_cursor);
+	}
+}
+
+static void Internal_Unlocked_CursorReset(LuaHashMapCursor* hash_cursor)
+{
+	LuaHashMap* hash_map;
+	if(NULL == hash_cursor)
+	{
+		return;
+	}
+	hash_map = hash_cursor->theIterator.hashMap;
+	/* Fetch the table again in case Purge, Reserve or Compact replaced it since the last traversal. */
+	lua_settop(hash_cursor->threadState, 0); /* thread stack: [] */
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	lua_xmove(hash_map->luaState, hash_cursor->threadState, 1); /* stack: []; thread stack: [table] */
+	lua_pushnil(hash_cursor->threadState); /* first key; thread stack: [nil, table] */
+
+	/* Before the first LuaHashMap_CursorNext, there is no current entry. */
+	hash_cursor->theIterator.atEnd = false;
+	hash_cursor->theIterator.isNext = false;
+	hash_cursor->theIterator.keyType = LUA_TNONE;
+	hash_cursor->theIterator.valueType = LUA_TNONE;
+	hash_cursor->theIterator.isKeyInteger = false;
+	hash_cursor->theIterator.isValueInteger = false;
+	memset(&hash_cursor->theIterator.currentKey, 0, sizeof(union LuaHashMapKeyValueType));
+	memset(&hash_cursor->theIterator.currentValue, 0, sizeof(union LuaHashMapKeyValueType));
+
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+}
+
+static bool Internal_Unlocked_CursorNext(LuaHashMapCursor* hash_cursor)
+{
+	lua_State* thread_state;
+	if(NULL == hash_cursor)
+	{
+		return false;
+	}
+	if(true == hash_cursor->theIterator.atEnd)
+	{
+		return false;
+	}
+	thread_state = hash_cursor->threadState;
+
+	/* The previous key is still on the thread stack so this is a bare lua_next. No table fetch, no key push. */
+	if(lua_next(thread_state, -2) == 0) /* thread stack: [value, key, table] */
+	{
+		/* thread stack: [table] */
+		hash_cursor->theIterator.atEnd = true;
+		hash_cursor->theIterator.keyType = LUA_TNONE;
+		hash_cursor->theIterator.valueType = LUA_TNONE;
+		memset(&hash_cursor->theIterator.currentKey, 0, sizeof(union LuaHashMapKeyValueType));
+		memset(&hash_cursor->theIterator.currentValue, 0, sizeof(union LuaHashMapKeyValueType));
+		return false;
+	}
+	hash_cursor->theIterator.keyType = Internal_ToKeyValueTypeInState(hash_cursor->theIterator.hashMap, thread_state, -2, &hash_cursor->theIterator.currentKey, &hash_cursor->theIterator.isKeyInteger);
+	hash_cursor->theIterator.valueType = Internal_ToKeyValueTypeInState(hash_cursor->theIterator.hashMap, thread_state, -1, &hash_cursor->theIterator.currentValue, &hash_cursor->theIterator.isValueInteger);
+	/* Keep the key for the next step. It also keeps the key string alive for LuaHashMap_GetKeyStringAtIterator. */
+	lua_pop(thread_state, 1); /* thread stack: [key, table] */
+	return true;
+}
+
+const LuaHashMapIterator* LuaHashMap_GetIteratorAtCursor(const LuaHashMapCursor* hash_cursor)
+{
+	if(NULL == hash_cursor)
+	{
+		return NULL;
+	}
+	return &hash_cursor->theIterator;
+}
+
+static LuaHashMapScan* Internal_Unlocked_CreateScan(LuaHashMap* hash_map)
+{
+	LuaHashMapScan* hash_scan;
+	if(NULL == hash_map)
+	{
+		return NULL;
+	}
+	if(NULL != hash_map->memoryAllocator)
+	{
+		hash_scan = (LuaHashMapScan*)(*hash_map->memoryAllocator)(hash_map->allocatorUserData, NULL, 0, sizeof(LuaHashMapScan));
+	}
+	else
+	{
+		hash_scan = (LuaHashMapScan*)malloc(sizeof(LuaHashMapScan));
+	}
+	if(NULL == hash_scan)
+	{
+		return NULL;
+	}
+	memset(hash_scan, 0, sizeof(LuaHashMapScan));
+	hash_scan->hashMap = hash_map;
+	hash_scan->tableGeneration = hash_map->tableGeneration;
+
+	hash_scan->threadState = lua_newthread(hash_map->luaState); /* stack: [thread] */
+	hash_scan->threadReference = luaL_ref(hash_map->luaState, LUA_REGISTRYINDEX); /* stack: [] */
+
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	lua_xmove(hash_map->luaState, hash_scan->threadState, 1); /* stack: []; thread stack: [table] */
+	lua_pushnil(hash_scan->threadState); /* first key; thread stack: [nil, table] */
+
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return hash_scan;
+}
+
+static void Internal_Unlocked_FreeScan(LuaHashMapScan* hash_scan)
+{
+	LuaHashMap* hash_map;
+	if(NULL == hash_scan)
+	{
+		return;
+	}
+	hash_map = hash_scan->hashMap;
+	luaL_unref(hash_map->luaState, LUA_REGISTRYINDEX, hash_scan->threadReference);
+	if(NULL != hash_map->memoryAllocator)
+	{
+		(*hash_map->memoryAllocator)(hash_map->allocatorUserData, hash_scan, sizeof(LuaHashMapScan), 0);
+	}
+	else
+	{
+		free(hash_scan);
+	}
+}
+
+/* Lua only rehashes when a new key is inserted, and removing or overwriting keys during lua_next is allowed.
+ * So until hashMap->tableGeneration changes, continuing lua_next from the last key is safe and visits every key exactly once.
+ * After it changes, the order is scrambled and the last key may not even be valid to lua_next anymore.
+ * At that point we copy every key currently in the table into an array and walk that instead.
+ * Any key present for the whole scan is in the array, so it is still visited (keys already returned may be returned again).
+ * The copy is one pass over the table inside Lua, and it happens at most once per scan.
+ */
+static void Internal_SwitchScanToSnapshot(LuaHashMapScan* hash_scan)
+{
+	LuaHashMap* hash_map = hash_scan->hashMap;
+	lua_State* thread_state = hash_scan->threadState;
+	size_t number_of_keys = 0;
+	size_t element_count = Internal_GetElementCount(hash_map);
+
+	lua_settop(thread_state, 0); /* thread stack: [] */
+	/* The size is only a hint, so clamp it rather than let it wrap. */
+	lua_createtable(thread_state, (element_count > (size_t)INT_MAX) ? INT_MAX : (int)element_count, 0); /* thread stack: [snapshot_keys] */
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	lua_xmove(hash_map->luaState, thread_state, 1); /* thread stack: [table, snapshot_keys] */
+
+	lua_pushnil(thread_state); /* first key; thread stack: [nil, table, snapshot_keys] */
+	while(lua_next(thread_state, -2) != 0) /* thread stack: [value, key, table, snapshot_keys] */
+	{
+		lua_pop(thread_state, 1); /* thread stack: [key, table, snapshot_keys] */
+		lua_pushvalue(thread_state, -1); /* thread stack: [key, key, table, snapshot_keys] */
+		number_of_keys++;
+		lua_rawseti(thread_state, -4, (LuaHashMap_InternalIndexType)number_of_keys); /* snapshot_keys[n]=key; thread stack: [key, table, snapshot_keys] */
+	}
+	/* thread stack: [table, snapshot_keys] */
+	hash_scan->isSnapshot = true;
+	hash_scan->snapshotPosition = 1;
+	hash_scan->snapshotCount = number_of_keys;
+}
+
+static size_t Internal_Unlocked_ScanNext(LuaHashMapScan* restrict hash_scan, LuaHashMapValue* restrict keys_array, LuaHashMapValue* restrict values_array, size_t max_number_of_elements)
+{
+	LuaHashMap* hash_map;
+	lua_State* thread_state;
+	size_t number_of_elements = 0;
+
+	if(NULL == hash_scan)
+	{
+		return 0;
+	}
+	if(true == hash_scan->isFinished)
+	{
+		return 0;
+	}
+	if((NULL == keys_array) || (0 == max_number_of_elements))
+	{
+		return 0;
+	}
+	hash_map = hash_scan->hashMap;
+	thread_state = hash_scan->threadState;
+
+	if((false == hash_scan->isSnapshot) && (hash_scan->tableGeneration != hash_map->tableGeneration))
+	{
+		Internal_SwitchScanToSnapshot(hash_scan);
+	}
+
+	if(false == hash_scan->isSnapshot)
+	{
+		/* thread stack: [key, table] */
+		while(number_of_elements < max_number_of_elements)
+		{
+			if(lua_next(thread_state, -2) == 0) /* thread stack: [value, key, table] */
 			{
-				hash_iterator->currentKey.theString.stringPointer = lua_tolstring(hash_map->luaState, -2, &hash_iterator->currentKey.theString.stringLength);
+				/* thread stack: [table] */
+				hash_scan->isFinished = true;
 				break;
 			}
-			case LUA_TLIGHTUSERDATA:
-			case LUA_TUSERDATA:
+			keys_array[number_of_elements].valueType = Internal_ToKeyValueTypeInState(hash_map, thread_state, -2, &keys_array[number_of_elements].theValue, &keys_array[number_of_elements].isInteger);
+			if(NULL != values_array)
 			{
-				hash_iterator->currentKey.thePointer = lua_touserdata(hash_map->luaState, -2);
-				break;
+				values_array[number_of_elements].valueType = Internal_ToKeyValueTypeInState(hash_map, thread_state, -1, &values_array[number_of_elements].theValue, &values_array[number_of_elements].isInteger);
 			}
-			case LUA_TNUMBER:
+			number_of_elements++;
+			lua_pop(thread_state, 1); /* thread stack: [key, table] */
+		}
+	}
+	else
+	{
+		/* Fetch the live table again in case Purge, Reserve or Compact replaced it since the last call. */
+		LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+		lua_xmove(hash_map->luaState, thread_state, 1); /* thread stack: [table, old_table, snapshot_keys] */
+		lua_replace(thread_state, 2); /* thread stack: [table, snapshot_keys] */
+
+		while(number_of_elements < max_number_of_elements)
+		{
+			if(hash_scan->snapshotPosition > hash_scan->snapshotCount)
 			{
-				/* Note: Like above, I can't easily distinguish between a number and integer.
-				 * So I will treat things as a number since that is the Lua default and cast later as necessary.
-				 */
-				hash_iterator->currentKey.theNumber = lua_tonumber(hash_map->luaState, -2);
+				hash_scan->isFinished = true;
 				break;
 			}
-			default:
+			lua_rawgeti(thread_state, 1, (LuaHashMap_InternalIndexType)hash_scan->snapshotPosition); /* thread stack: [key, table, snapshot_keys] */
+			hash_scan->snapshotPosition++;
+			lua_pushvalue(thread_state, -1); /* thread stack: [key, key, table, snapshot_keys] */
+			LUAHASHMAP_GETTABLE(thread_state, 2); /* table[key]; thread stack: [value, key, table, snapshot_keys] */
+			/* Skip keys that were removed since the snapshot was taken. */
+			if(LUA_TNIL != lua_type(thread_state, -1))
+			{
+				keys_array[number_of_elements].valueType = Internal_ToKeyValueTypeInState(hash_map, thread_state, -2, &keys_array[number_of_elements].theValue, &keys_array[number_of_elements].isInteger);
+				if(NULL != values_array)
+				{
+					values_array[number_of_elements].valueType = Internal_ToKeyValueTypeInState(hash_map, thread_state, -1, &values_array[number_of_elements].theValue, &values_array[number_of_elements].isInteger);
+				}
+				number_of_elements++;
+			}
+			lua_pop(thread_state, 2); /* thread stack: [table, snapshot_keys] */
+		}
+	}
+
+	if(true == hash_scan->isFinished)
+	{
+		/* Let the collector have the table (and snapshot) now instead of waiting for LuaHashMap_FreeScan. */
+		lua_settop(thread_state, 0);
+	}
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return number_of_elements;
+}
+
+static void Internal_SetValueStringAtIteratorWithLength(LuaHashMapIterator* restrict hash_iterator, const char* restrict value_string, size_t value_string_length)
+{
+	/* Early error checking so I can call Internal_PushTableAndKeyInIterator without worrying */
+	switch(hash_iterator->keyType)
+	{
+		case LUA_TLIGHTUSERDATA:
+		case LUA_TUSERDATA:
+		case LUA_TNUMBER:
+		{
+			break;
+		}
+		case LUA_TSTRING:
+		{
+			if(NULL == hash_iterator->currentKey.theString.stringPointer)
+			{
+				LUAHASHMAP_ASSERT_STACK_BALANCED(hash_iterator->hashMap);			
+				return;
+			}
+			break;
+		}
+		default:
+		{
+			/* shouldn't get here */
+			LUAHASHMAP_ASSERT(false);
+			LUAHASHMAP_ASSERT_STACK_BALANCED(hash_iterator->hashMap);
+			return;
+		}
+	}
+	
+	hash_iterator->valueType = LUA_TSTRING;
+	
+	Internal_PushTableAndKeyInIterator(hash_iterator); /* stack: [key, table] */
+	LUAHASHMAP_PUSHLSTRING_AND_ASSIGNINTERNALSTRING(hash_iterator->hashMap->luaState, value_string, value_string_length, hash_iterator->currentValue.theString.stringPointer); /* stack: [value_string, key, table] */
+	Internal_SetTableAndUpdateCount(hash_iterator->hashMap);  /* table[key]=value_string; stack: [table] */
+	
+	hash_iterator->currentValue.theString.stringLength = value_string_length; /* Don't forget to save the length */
+	
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_iterator->hashMap->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_iterator->hashMap);
+}
+
+static void Internal_Unlocked_SetValueStringAtIterator(LuaHashMapIterator* restrict hash_iterator, const char* restrict value_string)
+{
+	if(NULL == hash_iterator)
+	{
+		return;
+	}
+	if(true == hash_iterator->atEnd)
+	{
+		return;
+	}
+	if(NULL == hash_iterator->hashMap)
+	{
+		return;
+	}
+	if(true == hash_iterator->isNext)
+	{
+		return;
+	}
+	Internal_SetValueStringAtIteratorWithLength(hash_iterator, value_string, strlen(value_string));
+}
+
+static void Internal_Unlocked_SetValueStringAtIteratorWithLength(LuaHashMapIterator* restrict hash_iterator, const char* restrict value_string, size_t value_string_length)
+{
+	if(NULL == hash_iterator)
+	{
+		return;
+	}
+	if(true == hash_iterator->atEnd)
+	{
+		return;
+	}
+	if(NULL == hash_iterator->hashMap)
+	{
+		return;
+	}
+	if(true == hash_iterator->isNext)
+	{
+		return;
+	}
+	Internal_SetValueStringAtIteratorWithLength(hash_iterator, value_string, value_string_length);
+}
+
+
+static void Internal_Unlocked_SetValuePointerAtIterator(LuaHashMapIterator* hash_iterator, void* value_pointer)
+{
+	if(NULL == hash_iterator)
+	{
+		return;
+	}
+	if(true == hash_iterator->atEnd)
+	{
+		return;
+	}
+	if(NULL == hash_iterator->hashMap)
+	{
+		return;
+	}
+	if(true == hash_iterator->isNext)
+	{
+		return;
+	}
+	
+	/* Early error checking so I can call Internal_PushTableAndKeyInIterator without worrying */
+	switch(hash_iterator->keyType)
+	{
+		case LUA_TLIGHTUSERDATA:
+		case LUA_TUSERDATA:
+		case LUA_TNUMBER:
+		{
+			break;
+		}
+		case LUA_TSTRING:
+		{
+			if(NULL == hash_iterator->currentKey.theString.stringPointer)
 			{
-				/* Clear the largest field to make sure every thing is cleared. */
-				memset(&hash_iterator->currentKey, 0, sizeof(union LuaHashMapKeyValueType));
+				LUAHASHMAP_ASSERT_STACK_BALANCED(hash_iterator->hashMap);			
+				return;
 			}
+			break;
 		}
-		hash_iterator->valueType = lua_type(hash_map->luaState, -1);
-		switch(hash_iterator->valueType)
+		default:
 		{
-			case LUA_TSTRING:
-			{
-				hash_iterator->currentValue.theString.stringPointer = lua_tolstring(hash_map->luaState, -1, &hash_iterator->currentValue.theString.stringLength);
-				break;
-			}
-			case LUA_TLIGHTUSERDATA:
-			case LUA_TUSERDATA:
-			{
-				hash_iterator->currentValue.thePointer = lua_touserdata(hash_map->luaState, -1);
-				break;
-			}
-			case LUA_TNUMBER:
+			/* shouldn't get here */
+			LUAHASHMAP_ASSERT(false);
+			LUAHASHMAP_ASSERT_STACK_BALANCED(hash_iterator->hashMap);
+			return;
+		}
+	}
+	
+	hash_iterator->valueType = LUA_TLIGHTUSERDATA;
+	
+	Internal_PushTableAndKeyInIterator(hash_iterator); /* stack: [key, table] */
+	lua_pushlightuserdata(hash_iterator->hashMap->luaState, value_pointer); /* stack: [value_pointer, key, table] */
+	Internal_SetTableAndUpdateCount(hash_iterator->hashMap);  /* table[key]=value_string; stack: [table] */
+	
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_iterator->hashMap->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_iterator->hashMap);
+}
+
+static void Internal_Unlocked_SetValueNumberAtIterator(LuaHashMapIterator* hash_iterator, lua_Number value_number)
+{
+	if(NULL == hash_iterator)
+	{
+		return;
+	}
+	if(true == hash_iterator->atEnd)
+	{
+		return;
+	}
+	if(NULL == hash_iterator->hashMap)
+	{
+		return;
+	}
+	if(true == hash_iterator->isNext)
+	{
+		return;
+	}
+	
+	/* Early error checking so I can call Internal_PushTableAndKeyInIterator without worrying */
+	switch(hash_iterator->keyType)
+	{
+		case LUA_TLIGHTUSERDATA:
+		case LUA_TUSERDATA:
+		case LUA_TNUMBER:
+		{
+			break;
+		}
+		case LUA_TSTRING:
+		{
+			if(NULL == hash_iterator->currentKey.theString.stringPointer)
 			{
-				/* Note: Like above, I can't easily distinguish between a number and integer.
-				 * So I will treat things as a number since that is the Lua default and cast later as necessary.
-				 */
-				hash_iterator->currentValue.theNumber = lua_tonumber(hash_map->luaState, -1);
-				break;
+				LUAHASHMAP_ASSERT_STACK_BALANCED(hash_iterator->hashMap);			
+				return;
 			}
-			default:
+			break;
+		}
+		default:
+		{
+			/* shouldn't get here */
+			LUAHASHMAP_ASSERT(false);
+			LUAHASHMAP_ASSERT_STACK_BALANCED(hash_iterator->hashMap);
+			return;
+		}
+	}
+	
+	hash_iterator->valueType = LUA_TNUMBER;
+	
+	Internal_PushTableAndKeyInIterator(hash_iterator); /* stack: [key, table] */
+	lua_pushnumber(hash_iterator->hashMap->luaState, value_number); /* stack: [value_number, key, table] */
+	Internal_SetTableAndUpdateCount(hash_iterator->hashMap);  /* table[key]=value_string; stack: [table] */
+	
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_iterator->hashMap->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_iterator->hashMap);
+}
+
+static void Internal_Unlocked_SetValueIntegerAtIterator(LuaHashMapIterator* hash_iterator, lua_Integer value_integer)
+{
+	if(NULL == hash_iterator)
+	{
+		return;
+	}
+	if(true == hash_iterator->atEnd)
+	{
+		return;
+	}
+	if(NULL == hash_iterator->hashMap)
+	{
+		return;
+	}
+	if(true == hash_iterator->isNext)
+	{
+		return;
+	}
+	
+	/* Early error checking so I can call Internal_PushTableAndKeyInIterator without worrying */
+	switch(hash_iterator->keyType)
+	{
+		case LUA_TLIGHTUSERDATA:
+		case LUA_TUSERDATA:
+		case LUA_TNUMBER:
+		{
+			break;
+		}
+		case LUA_TSTRING:
+		{
+			if(NULL == hash_iterator->currentKey.theString.stringPointer)
 			{
-				/* Clear the largest field to make sure every thing is cleared. */
-				memset(&hash_iterator->currentValue, 0, sizeof(union LuaHashMapKeyValueType));
+				LUAHASHMAP_ASSERT_STACK_BALANCED(hash_iterator->hashMap);			
+				return;
 			}
-		}		
-		/* pop key, value, and table */
-		lua_pop(hash_map->luaState, 3);
+			break;
+		}
+		default:
+		{
+			/* shouldn't get here */
+			LUAHASHMAP_ASSERT(false);
+			LUAHASHMAP_ASSERT_STACK_BALANCED(hash_iterator->hashMap);
+			return;
+		}
+	}
+
+	hash_iterator->valueType = LUA_TNUMBER;
+	
+	Internal_PushTableAndKeyInIterator(hash_iterator); /* stack: [key, table] */
+	Internal_PushInteger(hash_iterator->hashMap, value_integer); /* stack: [value_integer, key, table] */
+	Internal_SetTableAndUpdateCount(hash_iterator->hashMap);  /* table[key]=value_string; stack: [table] */
+	
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_iterator->hashMap->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_iterator->hashMap);
+}
+
+static const char* Internal_GetValueStringAtIteratorWithLength(LuaHashMapIterator* restrict hash_iterator, size_t* restrict value_string_length_return)
+{
+	const char* ret_val = NULL;
+	size_t ret_string_length = 0;
+	if(NULL == hash_iterator)
+	{
+		return NULL;
+	}
+	if(true == hash_iterator->atEnd)
+	{
+		return NULL;
+	}
+	if(true == hash_iterator->isNext)
+	{
+		return NULL;
+	}
+	
+	if(LUA_TSTRING == hash_iterator->keyType)
+	{
+        ret_val = Internal_Unlocked_GetValueStringForKeyStringWithLength(hash_iterator->hashMap, hash_iterator->currentKey.theString.stringPointer, &ret_string_length, hash_iterator->currentKey.theString.stringLength);
+	}
+	else if(LUA_TLIGHTUSERDATA == hash_iterator->keyType)
+	{
+        ret_val = Internal_Unlocked_GetValueStringForKeyPointerWithLength(hash_iterator->hashMap, hash_iterator->currentKey.thePointer, &ret_string_length);
+	}
+	else if(LUA_TNUMBER == hash_iterator->keyType)
+	{
+		if(true == hash_iterator->isKeyInteger)
+		{
+			ret_val = Internal_Unlocked_GetValueStringForKeyIntegerWithLength(hash_iterator->hashMap, hash_iterator->currentKey.theInteger, &ret_string_length);
+		}
+		else
+		{
+			ret_val = Internal_Unlocked_GetValueStringForKeyNumberWithLength(hash_iterator->hashMap, hash_iterator->currentKey.theNumber, &ret_string_length);
+		}
 	}
 	else
 	{
-		hash_iterator->atEnd = true;
-		hash_iterator->keyType = LUA_TNONE;
-		hash_iterator->valueType = LUA_TNONE;
-		/* Clear the largest field to make sure every thing is cleared. */
-		memset(&hash_iterator->currentKey, 0, sizeof(union LuaHashMapKeyValueType));
-		memset(&hash_iterator->currentValue, 0, sizeof(union LuaHashMapKeyValueType));
+		/* shouldn't get here */
+		LUAHASHMAP_ASSERT(false);
+		if(NULL != value_string_length_return)
+		{
+			*value_string_length_return = 0;
+		}
+		return NULL;
+	}
+	hash_iterator->currentValue.theString.stringPointer = ret_val;
+	hash_iterator->currentValue.theString.stringLength = ret_string_length;
+	if(NULL != value_string_length_return)
+	{
+		*value_string_length_return = ret_string_length;
+	}
+	hash_iterator->valueType = LUA_TSTRING;
+	return ret_val;
+}
 
-		/* pop table */
-		lua_pop(hash_map->luaState, 1);
+
+static const char* Internal_Unlocked_GetValueStringAtIterator(LuaHashMapIterator* hash_iterator)
+{
+	if(NULL == hash_iterator)
+	{
+		return NULL;
+	}
+	if(true == hash_iterator->atEnd)
+	{
+		return NULL;
+	}
+	if(true == hash_iterator->isNext)
+	{
+		return NULL;
+	}
+	return Internal_GetValueStringAtIteratorWithLength(hash_iterator, NULL);
+}
+
+static const char* Internal_Unlocked_GetValueStringAtIteratorWithLength(LuaHashMapIterator* restrict hash_iterator, size_t* restrict value_string_length_return)
+{
+	if(NULL == hash_iterator)
+	{
+		return NULL;
+	}
+	if(true == hash_iterator->atEnd)
+	{
+		return NULL;
+	}
+	if(true == hash_iterator->isNext)
+	{
+		return NULL;
+	}
+	return Internal_GetValueStringAtIteratorWithLength(hash_iterator, value_string_length_return);
+}
+
+static void* Internal_Unlocked_GetValuePointerAtIterator(LuaHashMapIterator* hash_iterator)
+{
+	void* ret_val = NULL;
+	if(NULL == hash_iterator)
+	{
+		return NULL;
+	}
+	if(true == hash_iterator->atEnd)
+	{
+		return NULL;
+	}
+	if(true == hash_iterator->isNext)
+	{
+		return NULL;
 	}
 	
-	/* return true if more keys follow, false if we're at the end */
-	return (false == hash_iterator->atEnd);
+	if(LUA_TSTRING == hash_iterator->keyType)
+	{
+        ret_val = Internal_Unlocked_GetValuePointerForKeyStringWithLength(hash_iterator->hashMap, hash_iterator->currentKey.theString.stringPointer, hash_iterator->currentKey.theString.stringLength);
+	}
+	else if(LUA_TLIGHTUSERDATA == hash_iterator->keyType)
+	{
+        ret_val = Internal_Unlocked_GetValuePointerForKeyPointer(hash_iterator->hashMap, hash_iterator->currentKey.thePointer);
+	}
+	else if(LUA_TNUMBER == hash_iterator->keyType)
+	{
+		if(true == hash_iterator->isKeyInteger)
+		{
+			ret_val = Internal_Unlocked_GetValuePointerForKeyInteger(hash_iterator->hashMap, hash_iterator->currentKey.theInteger);
+		}
+		else
+		{
+			ret_val = Internal_Unlocked_GetValuePointerForKeyNumber(hash_iterator->hashMap, hash_iterator->currentKey.theNumber);
+		}
+	}
+	else
+	{
+		/* shouldn't get here */
+		LUAHASHMAP_ASSERT(false);
+		return NULL;
+	}
+	hash_iterator->currentValue.thePointer = ret_val;
+	hash_iterator->valueType = LUA_TLIGHTUSERDATA;
+	return ret_val;
 }
 
-static LuaHashMapIterator Internal_GetIteratorBegin(LuaHashMap* hash_map, LuaHashMap_InternalGlobalKeyType table_name)
+static lua_Number Internal_Unlocked_GetValueNumberAtIterator(LuaHashMapIterator* hash_iterator)
 {
-	LuaHashMapIterator the_iterator;
-	memset(&the_iterator, 0, sizeof(LuaHashMapIterator));
-	the_iterator.hashMap = hash_map;
-	the_iterator.whichTable = table_name;
-	the_iterator.keyType = LUA_TNONE;
-	the_iterator.valueType = LUA_TNONE;
-
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, table_name); /* stack: [table] */
+	lua_Number ret_val = 0.0;
+	if(NULL == hash_iterator)
+	{
+		return 0.0;
+	}
+	if(true == hash_iterator->atEnd)
+	{
+		return 0.0;
+	}
+	if(true == hash_iterator->isNext)
+	{
+		return 0.0;
+	}
 	
-	lua_pushnil(hash_map->luaState);  /* first key */
-	if(lua_next(hash_map->luaState, -2) != 0) /* use index of table */
+	if(LUA_TSTRING == hash_iterator->keyType)
 	{
-		the_iterator.atEnd = false;
-		the_iterator.keyType = lua_type(hash_map->luaState, -2);
-		switch(the_iterator.keyType)
+        ret_val = Internal_Unlocked_GetValueNumberForKeyStringWithLength(hash_iterator->hashMap, hash_iterator->currentKey.theString.stringPointer, hash_iterator->currentKey.theString.stringLength);
+	}
+	else if(LUA_TLIGHTUSERDATA == hash_iterator->keyType)
+	{
+        ret_val = Internal_Unlocked_GetValueNumberForKeyPointer(hash_iterator->hashMap, hash_iterator->currentKey.thePointer);
+	}
+	else if(LUA_TNUMBER == hash_iterator->keyType)
+	{
+		if(true == hash_iterator->isKeyInteger)
 		{
-			case LUA_TSTRING:
-			{
-				the_iterator.currentKey.theString.stringPointer = lua_tolstring(hash_map->luaState, -2, &the_iterator.currentKey.theString.stringLength);
-				break;
-			}
-			case LUA_TLIGHTUSERDATA:
-			case LUA_TUSERDATA:
-			{
-				the_iterator.currentKey.thePointer = lua_touserdata(hash_map->luaState, -2);
-				break;
-			}
-			case LUA_TNUMBER:
-			{
-				/* Note: Like above, I can't easily distinguish between a number and integer.
-				 * So I will treat things as a number since that is the Lua default and cast later as necessary.
-				 */
-				the_iterator.currentKey.theNumber = lua_tonumber(hash_map->luaState, -2);
-				break;
-			}
-			default:
-			{
-				the_iterator.currentKey.thePointer = NULL;
-			}
+			ret_val = Internal_Unlocked_GetValueNumberForKeyInteger(hash_iterator->hashMap, hash_iterator->currentKey.theInteger);
 		}
-		the_iterator.valueType = lua_type(hash_map->luaState, -1);
-		switch(the_iterator.valueType)
+		else
 		{
-			case LUA_TSTRING:
-			{
-				the_iterator.currentValue.theString.stringPointer = lua_tolstring(hash_map->luaState, -1, &the_iterator.currentValue.theString.stringLength);
-				break;
-			}
-			case LUA_TLIGHTUSERDATA:
-			case LUA_TUSERDATA:
-			{
-				the_iterator.currentValue.thePointer = lua_touserdata(hash_map->luaState, -1);
-				break;
-			}
-			case LUA_TNUMBER:
-			{
-				/* Note: Like above, I can't easily distinguish between a number and integer.
-				 * So I will treat things as a number since that is the Lua default and cast later as necessary.
-				 */
-				the_iterator.currentValue.theNumber = lua_tonumber(hash_map->luaState, -1);
-				break;
-			}
-			default:
-			{
-				the_iterator.currentValue.thePointer = NULL;
-			}
+			ret_val = Internal_Unlocked_GetValueNumberForKeyNumber(hash_iterator->hashMap, hash_iterator->currentKey.theNumber);
 		}
-
-		/* pop key, value, and table */
-		lua_pop(hash_map->luaState, 3);
 	}
 	else
 	{
-		the_iterator.atEnd = true;
-		the_iterator.currentKey.thePointer = NULL;
-		the_iterator.currentValue.thePointer = NULL;
-
-		/* pop table */
-		lua_pop(hash_map->luaState, 1);
+		/* shouldn't get here */
+		LUAHASHMAP_ASSERT(false);
+		return 0.0;
 	}
-	
-	return the_iterator;
+	hash_iterator->currentValue.theNumber = ret_val;
+	hash_iterator->valueType = LUA_TNUMBER;
+	hash_iterator->isValueInteger = false;
+	return ret_val;
 }
 
-static LuaHashMapIterator Internal_GetIteratorEnd(LuaHashMap* hash_map, LuaHashMap_InternalGlobalKeyType table_name)
-{
-	LuaHashMapIterator the_iterator;
-	memset(&the_iterator, 0, sizeof(LuaHashMapIterator));
-	the_iterator.hashMap = hash_map;
-	the_iterator.whichTable = table_name;
-	the_iterator.atEnd = true;
-	the_iterator.keyType = LUA_TNONE;	
-	the_iterator.valueType = LUA_TNONE;	
-	/* Clear the largest field to make sure every thing is cleared. */
-	memset(&the_iterator.currentKey, 0, sizeof(union LuaHashMapKeyValueType));
-	memset(&the_iterator.currentValue, 0, sizeof(union LuaHashMapKeyValueType));
-	return the_iterator;
-}
 
-bool LuaHashMap_IteratorNext(LuaHashMapIterator* hash_iterator)
+static lua_Integer Internal_Unlocked_GetValueIntegerAtIterator(LuaHashMapIterator* hash_iterator)
 {
+	lua_Integer ret_val = 0;
 	if(NULL == hash_iterator)
 	{
-		return false;
+		return 0;
 	}
 	if(true == hash_iterator->atEnd)
 	{
-		return false;
+		return 0;
 	}
 	if(true == hash_iterator->isNext)
 	{
-		return Internal_IteratorIsAlreadyNext(hash_iterator);
+		return 0;
 	}
-	return Internal_IteratorNext(hash_iterator);
-}
-
-static LuaHashMapIterator Internal_CreateBadIterator()
-{
-	LuaHashMapIterator the_iterator;
-	memset(&the_iterator, 0, sizeof(LuaHashMapIterator));
-	the_iterator.whichTable = LUA_NOREF;
-	the_iterator.atEnd = true;
-	the_iterator.keyType = LUA_TNONE;
-	the_iterator.valueType = LUA_TNONE;
-	return the_iterator;
-}
-
-/* Stuff for public inline functions */
-#if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 199901L)
-/* Using C99 inline. These need to be externed (but not redefined) here to force compilation unit/linkage requirements by C99. */
-extern bool LuaHashMap_IteratorIsNotFound(const LuaHashMapIterator* hash_iterator);
-#else /* We are not using C99 inline so the implementation must be here. */
-bool LuaHashMap_IteratorIsNotFound(const LuaHashMapIterator* hash_iterator)
-{
-	if(NULL == hash_iterator)
+	
+	if(LUA_TSTRING == hash_iterator->keyType)
 	{
-		return true;
+        ret_val = Internal_Unlocked_GetValueIntegerForKeyStringWithLength(hash_iterator->hashMap, hash_iterator->currentKey.theString.stringPointer, hash_iterator->currentKey.theString.stringLength);
 	}
-	/* To make this distinct from a good iterator and an end iterator, whichTable==LUA_NOREF seems to be the only unique characteristic. */
-	if(LUA_NOREF == hash_iterator->whichTable)
+	else if(LUA_TLIGHTUSERDATA == hash_iterator->keyType)
 	{
-		return true;
+        ret_val = Internal_Unlocked_GetValueIntegerForKeyPointer(hash_iterator->hashMap, hash_iterator->currentKey.thePointer);
+	}
+	else if(LUA_TNUMBER == hash_iterator->keyType)
+	{
+		if(true == hash_iterator->isKeyInteger)
+		{
+			ret_val = Internal_Unlocked_GetValueIntegerForKeyInteger(hash_iterator->hashMap, hash_iterator->currentKey.theInteger);
+		}
+		else
+		{
+			ret_val = Internal_Unlocked_GetValueIntegerForKeyNumber(hash_iterator->hashMap, hash_iterator->currentKey.theNumber);
+		}
 	}
 	else
 	{
-		return false;		
+		/* shouldn't get here */
+		LUAHASHMAP_ASSERT(false);
+		return 0;
 	}
+	hash_iterator->currentValue.theInteger = ret_val;
+	hash_iterator->valueType = LUA_TNUMBER;
+	hash_iterator->isValueInteger = true;
+	return ret_val;
 }
-#endif /* defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 199901L) */
 
-LuaHashMapIterator LuaHashMap_GetIteratorAtBegin(LuaHashMap* hash_map)
+static bool Internal_Unlocked_ExistsAtIterator(LuaHashMapIterator* hash_iterator)
 {
-	if(NULL == hash_map)
+	int value_type;
+	if(NULL == hash_iterator)
 	{
-		return Internal_CreateBadIterator();
+		return false;
 	}
-	return Internal_GetIteratorBegin(hash_map, hash_map->uniqueTableNameForSharedState);
-}
-
-LuaHashMapIterator LuaHashMap_GetIteratorAtEnd(LuaHashMap* hash_map)
-{
-	return Internal_GetIteratorEnd(hash_map, hash_map->uniqueTableNameForSharedState);
-}
-
-static void Internal_SetCurrentValueInIteratorFromStackIndex(LuaHashMapIterator* the_iterator, int stack_index)
-{
-	int value_type = lua_type(the_iterator->hashMap->luaState, -1);
-	switch(value_type)
+	if(true == hash_iterator->atEnd)
+	{
+		return false;
+	}
+	if(true == hash_iterator->isNext)
+	{
+		return false;
+	}
+	
+	switch(hash_iterator->keyType)
 	{
 		case LUA_TSTRING:
 		{
-			the_iterator->currentValue.theString.stringPointer = lua_tolstring(the_iterator->hashMap->luaState, stack_index, &the_iterator->currentValue.theString.stringLength);
-			break;			
+			break;
+			
 		}
 		case LUA_TLIGHTUSERDATA:
 		case LUA_TUSERDATA:
 		{
-			the_iterator->currentValue.thePointer = lua_touserdata(the_iterator->hashMap->luaState, stack_index);
 			break;
 			
 		}
 		case LUA_TNUMBER:
 		{
-			the_iterator->currentValue.theNumber = lua_tonumber(the_iterator->hashMap->luaState, stack_index);
 			break;
 		}
 		default:
 		{
 			/* shouldn't get here */
 			LUAHASHMAP_ASSERT(false);
-			return;
+			return false;
 		}
 	}
-	the_iterator->valueType = value_type;
+	
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_iterator->hashMap, hash_iterator->hashMap->uniqueTableNameForSharedState); /* stack: [table] */
 
-}
+	switch(hash_iterator->keyType)
+	{
+		case LUA_TSTRING:
+		{
+			lua_pushlstring(hash_iterator->hashMap->luaState, hash_iterator->currentKey.theString.stringPointer, hash_iterator->currentKey.theString.stringLength); /* stack: [key_string, table] */
+			break;
 
-static LuaHashMapIterator Internal_GetIteratorForKeyStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length)
-{
-	const char* internalized_key_string = NULL;
-	int value_type;
-	LuaHashMapIterator the_iterator;
+		}
+		case LUA_TLIGHTUSERDATA:
+		case LUA_TUSERDATA:
+		{
+			lua_pushlightuserdata(hash_iterator->hashMap->luaState, hash_iterator->currentKey.thePointer); /* stack: [key_pointer, table] */
+
+			break;
+
+		}
+		case LUA_TNUMBER:
+		{
+			Internal_PushKeyValueNumber(hash_iterator->hashMap, &hash_iterator->currentKey, hash_iterator->isKeyInteger); /* stack: [key_number, table] */
+			break;
+		}
+		default:
+		{
+			/* shouldn't get here */
+			LUAHASHMAP_ASSERT(false);
+			/* pop LUAHASHMAP_GETGLOBAL_UNIQUESTRING */
+			lua_pop(hash_iterator->hashMap->luaState, 1);
+			LUAHASHMAP_ASSERT_STACK_BALANCED(hash_iterator->hashMap);			
+			return false;
+		}
+	}
 	
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
-	/* pushes the string on the stack and sets internalized_key_string to the internalized Lua string pointer. */
-	LUAHASHMAP_PUSHLSTRING_AND_ASSIGNINTERNALSTRING(hash_map->luaState, key_string, key_string_length, internalized_key_string); /* stack: [key_string, table] */
-	LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_string]; stack: [value, table] */
+	LUAHASHMAP_GETTABLE(hash_iterator->hashMap->luaState, -2);  /* table[key]; stack: [value, table] */
+
+	value_type = lua_type(hash_iterator->hashMap->luaState, -1);
+	
+	/* Cache the value before returning */
+	Internal_SetCurrentValueInIteratorFromStackIndex(hash_iterator, -1);
+
+	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_iterator->hashMap->luaState, 2);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_iterator->hashMap);			
 	
 	
-	value_type = lua_type(hash_map->luaState, -1);
-	if(LUA_TNIL == value_type)
+	switch(value_type)
+	{
+		case LUA_TSTRING:
+		case LUA_TLIGHTUSERDATA:
+		case LUA_TUSERDATA:
+		case LUA_TNUMBER:
+		{
+			return true;
+		}
+		default:
+		{
+			return false;
+		}
+	}
+
+	
+}
+
+static void Internal_Unlocked_RemoveAtIterator(LuaHashMapIterator* hash_iterator)
+{
+	union LuaHashMapKeyValueType next_key;
+	union LuaHashMapKeyValueType next_value;
+	int next_key_type = LUA_TNONE;
+	int next_value_type = LUA_TNONE;
+	bool next_key_is_integer = false;
+	bool next_value_is_integer = false;
+	
+	if(NULL == hash_iterator)
+	{
+		return;
+	}
+	if(true == hash_iterator->atEnd)
+	{
+		return;
+	}
+	if(true == hash_iterator->isNext)
 	{
-		/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
-		lua_pop(hash_map->luaState, 2);
-		LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);			
-		return Internal_CreateBadIterator();
+		return;
 	}
 	
-	memset(&the_iterator, 0, sizeof(LuaHashMapIterator));
-	the_iterator.hashMap = hash_map;
-	the_iterator.whichTable = hash_map->uniqueTableNameForSharedState;
-	the_iterator.keyType = LUA_TSTRING;
-	/* Make sure to use the Lua internalized string and not the passed in string in case the string passed into this function gets released. */
-	the_iterator.currentKey.theString.stringPointer = internalized_key_string;
-	the_iterator.currentKey.theString.stringLength = key_string_length;
+	switch(hash_iterator->keyType)
+	{
+		case LUA_TSTRING:
+		case LUA_TLIGHTUSERDATA:
+		case LUA_TUSERDATA:
+		case LUA_TNUMBER:
+		{
+			break;
+		}
+		default:
+		{
+			return;
+		}
+	}
 
-	switch(value_type)
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_iterator->hashMap, hash_iterator->hashMap->uniqueTableNameForSharedState); /* stack: [table] */
+	switch(hash_iterator->keyType)
 	{
 		case LUA_TSTRING:
+		{
+			lua_pushlstring(hash_iterator->hashMap->luaState, hash_iterator->currentKey.theString.stringPointer, hash_iterator->currentKey.theString.stringLength); /* stack: [key table] */
+			break;
+		}
 		case LUA_TLIGHTUSERDATA:
 		case LUA_TUSERDATA:
+		{
+			lua_pushlightuserdata(hash_iterator->hashMap->luaState, hash_iterator->currentKey.thePointer); /* stack: [key table] */
+			break;
+		}
 		case LUA_TNUMBER:
 		{
+			Internal_PushKeyValueNumber(hash_iterator->hashMap, &hash_iterator->currentKey, hash_iterator->isKeyInteger); /* stack: [key table] */
 			break;
 		}
 		default:
 		{
 			/* shouldn't get here */
 			LUAHASHMAP_ASSERT(false);
-			
-			/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
-			lua_pop(hash_map->luaState, 2);
-			LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);			
-			return Internal_CreateBadIterator();
+			/* pop LUAHASHMAP_GETGLOBAL_UNIQUESTRING */
+			lua_pop(hash_iterator->hashMap->luaState, 1);
+			LUAHASHMAP_ASSERT_STACK_BALANCED(hash_iterator->hashMap);
+			return;
 		}
 	}
 	
-	Internal_SetCurrentValueInIteratorFromStackIndex(&the_iterator, -1);
+	/* Before setting the value to nil, we want to fetch/save the next key so iterating while removing can be done. */
 	
-	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
-	lua_pop(hash_map->luaState, 2);
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);	
-		
-	return the_iterator;
-}
+	/* For performance, duplicate the just pushed key on the stack because we'll need to come back to it when we remove the value */
+	/* This will avoid re-inserting from the C-side which may hopefully skip some strlen() and string comparisons in the string case. */
+	/* It also saves us from needing to figure out what type the key is again. */
+	lua_pushvalue(hash_iterator->hashMap->luaState, -1); /* stack: [key key table] */
 
-LuaHashMapIterator LuaHashMap_GetIteratorForKeyString(LuaHashMap* restrict hash_map, const char* restrict key_string)
-{
-	if(NULL == hash_map)
+	/* Using the duplicated key on top of the stack, use lua_next to find the next key/value pair. */
+	if(lua_next(hash_iterator->hashMap->luaState, -3) != 0)
 	{
-		return Internal_CreateBadIterator();
+		/* stack: [next_value next_key key table] */
+		/* Save the next key and value in temporary variables */
+		next_key_type = Internal_ToKeyValueType(hash_iterator->hashMap, -2, &next_key, &next_key_is_integer);
+		next_value_type = Internal_ToKeyValueType(hash_iterator->hashMap, -1, &next_value, &next_value_is_integer);
+
+		/* Now pop the next key/value and go back to our regularly scheduled program. */
+		lua_pop(hash_iterator->hashMap->luaState, 2); /* stack: [key table] */
 	}
-	if(NULL == key_string)
+	else
 	{
-		return Internal_CreateBadIterator();
+		/* No next, so we are at the end of the hash. */
+		/* stack: [key table] */
+		
+		memset(&next_key, 0, sizeof(union LuaHashMapKeyValueType));
+		memset(&next_value, 0, sizeof(union LuaHashMapKeyValueType));
+		next_key_type = LUA_TNONE;
+		next_value_type = LUA_TNONE;
+		next_key_is_integer = false;
+		next_value_is_integer = false;
 	}
-	return Internal_GetIteratorForKeyStringWithLength(hash_map, key_string, strlen(key_string));
+	
+	
+	/* Now back to the regularly scheduled program of removing the key/value */
+	/* stack: [key table] */
+	lua_pushnil(hash_iterator->hashMap->luaState); /* stack: [nil, key, table] */
+	Internal_SetTableAndUpdateCount(hash_iterator->hashMap);  /* table[key_string]=nil; stack: [table] */
+
+	
+	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
+	lua_pop(hash_iterator->hashMap->luaState, 1);
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_iterator->hashMap);
+	
+	/* Now that we've removed the key/value pair, the current iterator is invalid.
+	 * In the worst case, Lua will collect the key so when we try to use IteratorNext which has a stale key,
+	 * it will fail when it tries to use lua_next with that stale key.
+	 * To get around this, we mark this iterator as 'invalid' and save the next key so IteratorNext knows it needs to
+	 * do something special because the normal current key has been invalidated/destroyed.
+	 * I will use an isNext flag to denote this special case and reuse the currentKey and currentValue fields to store the next values.
+	 * If there is no next, I will use the type LUA_TNONE to infer that there is no next in the IteratorNext implementation.
+	 */
+	hash_iterator->isNext = true;
+	hash_iterator->keyType = next_key_type;
+	hash_iterator->valueType = next_value_type;
+	hash_iterator->currentKey = next_key;
+	hash_iterator->currentValue = next_value;
+	hash_iterator->isKeyInteger = next_key_is_integer;
+	hash_iterator->isValueInteger = next_value_is_integer;
 }
 
-LuaHashMapIterator LuaHashMap_GetIteratorForKeyStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length)
+
+static size_t Internal_Unlocked_Count(LuaHashMap* hash_map)
 {
 	if(NULL == hash_map)
 	{
-		return Internal_CreateBadIterator();
-	}
-	if(NULL == key_string)
-	{
-		return Internal_CreateBadIterator();
+		return 0;
 	}
-	return Internal_GetIteratorForKeyStringWithLength(hash_map, key_string, key_string_length);
+	Internal_GetElementCount(hash_map);
+	/* Internal_Count walks the whole table so only use it to verify the counter in debug builds. */
+	LUAHASHMAP_ASSERT(hash_map->elementCount == Internal_Count(hash_map));
+	return hash_map->elementCount;
 }
 
-LuaHashMapIterator LuaHashMap_GetIteratorForKeyPointer(LuaHashMap* hash_map, void* key_pointer)
+static int Internal_Unlocked_GetValueTypeAtIterator(LuaHashMapIterator* hash_iterator)
 {
-	int value_type;
-	LuaHashMapIterator the_iterator;
+	int ret_val;
+	LuaHashMap* hash_map;
+	if(NULL == hash_iterator)
+	{
+		return LUA_TNONE;
+	}
+	if(true == hash_iterator->atEnd)
+	{
+		return LUA_TNONE;
+	}
+	if(true == hash_iterator->isNext)
+	{
+		return LUA_TNONE;
+	}
+	
+	hash_map = hash_iterator->hashMap;
 	if(NULL == hash_map)
 	{
-		return Internal_CreateBadIterator();
+		return LUA_TNONE;
 	}
 
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
-	lua_pushlightuserdata(hash_map->luaState, key_pointer); /* stack: [key_pointer, table] */
-	LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_pointer]; stack: [value_pointer, table] */
-	
-	value_type = lua_type(hash_map->luaState, -1);
-	if(LUA_TNIL == value_type)
+	if(LUA_TSTRING == hash_iterator->keyType)
 	{
-		/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
-		lua_pop(hash_map->luaState, 2);
-		LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);			
-		return Internal_CreateBadIterator();
+		LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+		lua_pushlstring(hash_map->luaState, hash_iterator->currentKey.theString.stringPointer, hash_iterator->currentKey.theString.stringLength); /* stack: [key_string, table] */
+		LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_string]; stack: [value_string, table] */
+	}
+	else if(LUA_TLIGHTUSERDATA == hash_iterator->keyType)
+	{
+		LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+		lua_pushlightuserdata(hash_map->luaState, hash_iterator->currentKey.thePointer); /* stack: [key_string, table] */
+		LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_string]; stack: [value_string, table] */
+	}
+	else if(LUA_TNUMBER == hash_iterator->keyType)
+	{
+		LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+		Internal_PushKeyValueNumber(hash_map, &hash_iterator->currentKey, hash_iterator->isKeyInteger); /* stack: [key_string, table] */
+		LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_string]; stack: [value_string, table] */
+	}
+	else
+	{
+		/* shouldn't get here */
+		LUAHASHMAP_ASSERT(false);
+		return LUA_TNONE;
 	}
 	
-	memset(&the_iterator, 0, sizeof(LuaHashMapIterator));
-	the_iterator.hashMap = hash_map;
-	the_iterator.whichTable = hash_map->uniqueTableNameForSharedState;
-	the_iterator.keyType = LUA_TLIGHTUSERDATA;		
-	the_iterator.currentKey.thePointer = key_pointer;
-
-	switch(value_type)
+	ret_val = lua_type(hash_map->luaState, -1);
+	switch(ret_val)
 	{
 		case LUA_TSTRING:
 		case LUA_TLIGHTUSERDATA:
-		case LUA_TUSERDATA:
 		case LUA_TNUMBER:
 		{
 			break;
@@ -2223,1553 +9023,2118 @@ LuaHashMapIterator LuaHashMap_GetIteratorForKeyPointer(LuaHashMap* hash_map, voi
 		{
 			/* shouldn't get here */
 			LUAHASHMAP_ASSERT(false);
-			
-			/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
-			lua_pop(hash_map->luaState, 2);
-			LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);			
-			return Internal_CreateBadIterator();
+			return LUA_TNONE;
 		}
 	}
+	/* Cache the value in the iterator */
+	ret_val = Internal_ToKeyValueType(hash_map, -1, &hash_iterator->currentValue, &hash_iterator->isValueInteger);
+	hash_iterator->valueType = ret_val;
 	
-	Internal_SetCurrentValueInIteratorFromStackIndex(&the_iterator, -1);
 	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
 	lua_pop(hash_map->luaState, 2);
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);	
-		
-	return the_iterator;
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);	
+	return ret_val;
+}
+
+/* Stuff for public inline functions */
+#if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 199901L)
+/* Using C99 inline. These need to be externed (but not redefined) here to force compilation unit/linkage requirements by C99. */
+
+extern const char* LuaHashMap_GetKeyStringAtIterator(const LuaHashMapIterator* hash_iterator);
+extern const char* LuaHashMap_GetKeyStringAtIteratorWithLength(const LuaHashMapIterator* restrict hash_iterator, size_t* restrict key_string_length_return);
+extern size_t LuaHashMap_GetKeyStringLengthAtIterator(const LuaHashMapIterator* hash_iterator);
+extern void* LuaHashMap_GetKeyPointerAtIterator(const LuaHashMapIterator* hash_iterator);
+extern lua_Number LuaHashMap_GetKeyNumberAtIterator(const LuaHashMapIterator* hash_iterator);
+extern lua_Integer LuaHashMap_GetKeyIntegerAtIterator(const LuaHashMapIterator* hash_iterator);
+
+extern int LuaHashMap_GetKeyTypeAtIterator(const LuaHashMapIterator* hash_iterator);
+
+extern int LuaHashMap_GetCachedValueTypeAtIterator(const LuaHashMapIterator* hash_iterator);
+
+extern const char* LuaHashMap_GetCachedValueStringAtIterator(const LuaHashMapIterator* hash_iterator);
+extern const char* LuaHashMap_GetCachedValueStringAtIteratorWithLength(const LuaHashMapIterator* restrict hash_iterator, size_t* restrict value_string_length_return);
+extern size_t LuaHashMap_GetCachedValueStringLengthAtIterator(const LuaHashMapIterator* hash_iterator);
+extern void* LuaHashMap_GetCachedValuePointerAtIterator(const LuaHashMapIterator* hash_iterator);
+extern lua_Number LuaHashMap_GetCachedValueNumberAtIterator(const LuaHashMapIterator* hash_iterator);
+extern lua_Integer LuaHashMap_GetCachedValueIntegerAtIterator(const LuaHashMapIterator* hash_iterator);
+
+#else /* We are not using C99 inline so the implementation must be here. */
+
+int LuaHashMap_GetKeyTypeAtIterator(const LuaHashMapIterator* hash_iterator)
+{
+	if(NULL == hash_iterator)
+	{
+		return LUA_TNONE;
+	}
+	return hash_iterator->keyType;
 }
 
-LuaHashMapIterator LuaHashMap_GetIteratorForKeyNumber(LuaHashMap* hash_map, lua_Number key_number)
+
+const char* LuaHashMap_GetKeyStringAtIterator(const LuaHashMapIterator* hash_iterator)
 {
-	int value_type;
-	LuaHashMapIterator the_iterator;
-	if(NULL == hash_map)
+	if(NULL == hash_iterator)
 	{
-		return Internal_CreateBadIterator();
+		return NULL;
 	}
-	
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
-	lua_pushnumber(hash_map->luaState, key_number); /* stack: [key_number, table] */
-	LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_number]; stack: [value_pointer, table] */
-	
-	value_type = lua_type(hash_map->luaState, -1);
-	if(LUA_TNIL == value_type)
+	if(true == hash_iterator->atEnd)
 	{
-		/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
-		lua_pop(hash_map->luaState, 2);
-		LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);			
-		return Internal_CreateBadIterator();
+		return NULL;
 	}
-	
-	memset(&the_iterator, 0, sizeof(LuaHashMapIterator));
-	the_iterator.hashMap = hash_map;
-	the_iterator.whichTable = hash_map->uniqueTableNameForSharedState;
-	the_iterator.keyType = LUA_TNUMBER;
-	the_iterator.currentKey.theNumber = key_number;
-
-	switch(value_type)
+	if(true == hash_iterator->isNext)
 	{
-		case LUA_TSTRING:
-		case LUA_TLIGHTUSERDATA:
-		case LUA_TUSERDATA:
-		case LUA_TNUMBER:
-		{
-			break;
-		}
-		default:
-		{
-			/* shouldn't get here */
-			LUAHASHMAP_ASSERT(false);
-			
-			/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
-			lua_pop(hash_map->luaState, 2);
-			LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);			
-			return Internal_CreateBadIterator();
-		}
+		return NULL;
+	}
+	if(LUA_TSTRING == hash_iterator->keyType)
+	{
+        return hash_iterator->currentKey.theString.stringPointer;
+	}
+	else
+	{
+		/* shouldn't get here */
+		LUAHASHMAP_ASSERT(false);
+		return NULL;
 	}
-	
-	Internal_SetCurrentValueInIteratorFromStackIndex(&the_iterator, -1);
-
-	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
-	lua_pop(hash_map->luaState, 2);
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);	
-		
-	return the_iterator;
 }
 
-
-
-LuaHashMapIterator LuaHashMap_GetIteratorForKeyInteger(LuaHashMap* hash_map, lua_Integer key_integer)
+const char* LuaHashMap_GetKeyStringAtIteratorWithLength(const LuaHashMapIterator* restrict hash_iterator, size_t* restrict key_string_length_return)
 {
-	int value_type;
-	LuaHashMapIterator the_iterator;
-	if(NULL == hash_map)
+	if(NULL == hash_iterator)
 	{
-		return Internal_CreateBadIterator();
+		if(NULL != key_string_length_return)
+		{
+			*key_string_length_return = 0;
+		}
+		return NULL;
 	}
-	
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
-	lua_pushinteger(hash_map->luaState, key_integer); /* stack: [key_integer, table] */
-	LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_integer]; stack: [value_pointer, table] */
-	
-	value_type = lua_type(hash_map->luaState, -1);
-	if(LUA_TNIL == value_type)
+	if(true == hash_iterator->atEnd)
 	{
-		/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
-		lua_pop(hash_map->luaState, 2);
-		LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);			
-		return Internal_CreateBadIterator();
+		if(NULL != key_string_length_return)
+		{
+			*key_string_length_return = 0;
+		}
+		return NULL;
 	}
-	
-	memset(&the_iterator, 0, sizeof(LuaHashMapIterator));
-	the_iterator.hashMap = hash_map;
-	the_iterator.whichTable = hash_map->uniqueTableNameForSharedState;
-	/* Note: I might be able to benefit from the information that this is an integer,
-	 * but since this is not the only entry point to create an iterator,
-	 * its usefulness is limited.
-	 */
-	the_iterator.keyType = LUA_TNUMBER;
-	the_iterator.currentKey.theNumber = (lua_Number)key_integer;		
-	/*		the_iterator.currentKey.theInteger = key_integer; */
-
-	switch(value_type)
+	if(true == hash_iterator->isNext)
 	{
-		case LUA_TSTRING:
-		case LUA_TLIGHTUSERDATA:
-		case LUA_TUSERDATA:
-		case LUA_TNUMBER:
+		if(NULL != key_string_length_return)
 		{
-			break;
+			*key_string_length_return = 0;
 		}
-		default:
-		{
-			/* shouldn't get here */
-			LUAHASHMAP_ASSERT(false);
+		return NULL;
+	}
 
-			/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
-			lua_pop(hash_map->luaState, 2);
-			LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);			
-			return Internal_CreateBadIterator();
-		}
+	if(NULL != key_string_length_return)
+	{
+		*key_string_length_return = hash_iterator->currentKey.theString.stringLength;
 	}
-	
-	Internal_SetCurrentValueInIteratorFromStackIndex(&the_iterator, -1);
 
-	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
-	lua_pop(hash_map->luaState, 2);
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);	
-		
-	return the_iterator;
+	if(LUA_TSTRING == hash_iterator->keyType)
+	{
+        return hash_iterator->currentKey.theString.stringPointer;
+	}
+	else
+	{
+		/* shouldn't get here */
+		LUAHASHMAP_ASSERT(false);
+		return NULL;
+	}
 }
 
-/*
-static int Internal_safestrcmp(const char* str1, const char* str2)
+size_t LuaHashMap_GetKeyStringLengthAtIterator(const LuaHashMapIterator* hash_iterator)
 {
-	if(NULL == str1 && NULL == str2)
+	if(NULL == hash_iterator)
 	{
 		return 0;
 	}
-	else if(NULL == str1)
+	if(true == hash_iterator->atEnd)
 	{
-		return 1;
+		return 0;
 	}
-	else if(NULL == str2)
+	if(true == hash_iterator->isNext)
 	{
-		return -1;
+		return 0;
+	}
+	
+	if(LUA_TSTRING == hash_iterator->keyType)
+	{
+        return hash_iterator->currentKey.theString.stringLength;
 	}
 	else
 	{
-		return strcmp(str1, str2);
+		/* shouldn't get here */
+		LUAHASHMAP_ASSERT(false);
+		return 0;
 	}
 }
-*/
 
-/* Can be faster than safestrcmp since it can use the string length to compare and doesn't need to return greater-than/less-than. */
-static bool Internal_safestrequal(const char* str1, size_t length1, const char* str2, size_t length2)
+void* LuaHashMap_GetKeyPointerAtIterator(const LuaHashMapIterator* hash_iterator)
 {
-	if(NULL == str1 && NULL == str2)
+	if(NULL == hash_iterator)
 	{
-		return true;
+		return NULL;
 	}
-	else if(length1 != length2)
+	if(true == hash_iterator->atEnd)
 	{
-		return false;
+		return NULL;
 	}
-	else if(NULL == str1)
+	if(true == hash_iterator->isNext)
 	{
-		return false;
+		return NULL;
 	}
-	else if(NULL == str2)
+	
+	if(LUA_TLIGHTUSERDATA == hash_iterator->keyType)
 	{
-		return false;
+        return hash_iterator->currentKey.thePointer;
 	}
 	else
 	{
-		return (0 == strcmp(str1, str2));
+		/* shouldn't get here */
+		LUAHASHMAP_ASSERT(false);
+		return NULL;
 	}
 }
 
-bool LuaHashMap_IteratorIsEqual(const LuaHashMapIterator* hash_iterator1, const LuaHashMapIterator* hash_iterator2)
+lua_Number LuaHashMap_GetKeyNumberAtIterator(const LuaHashMapIterator* hash_iterator)
 {
-	if(NULL == hash_iterator1 && NULL == hash_iterator2)
+	if(NULL == hash_iterator)
 	{
-		return true;
+		return 0.0;
 	}
-	else if(NULL == hash_iterator1)
+	if(true == hash_iterator->atEnd)
 	{
-		return false;
+		return 0.0;
 	}
-	else if(NULL == hash_iterator2)
+	if(true == hash_iterator->isNext)
 	{
-		return false;
+		return 0.0;
 	}
-	else
+	
+	if(LUA_TNUMBER == hash_iterator->keyType)
 	{
-		/* Note: Don't test against keyType because when I create an End iterator, I don't know the type. */
-		bool ret_flag = (hash_iterator1->hashMap == hash_iterator2->hashMap)
-			&& (hash_iterator1->whichTable == hash_iterator2->whichTable)
-			&& (hash_iterator1->atEnd == hash_iterator2->atEnd)
-		;
-		if(false == ret_flag)
-		{
-			return false;
-		}
-		/* If the iterators are both atEnd, we can consider them equal. */
-		if(true == hash_iterator1->atEnd)
-		{
-			return true;
-		}
-		 
-		
-		if(LUA_TSTRING == hash_iterator1->keyType)
+		if(true == hash_iterator->isKeyInteger)
 		{
-			return (0 == Internal_safestrequal(hash_iterator1->currentKey.theString.stringPointer, hash_iterator1->currentKey.theString.stringLength, hash_iterator2->currentKey.theString.stringPointer, hash_iterator2->currentKey.theString.stringLength));
-		}
-		else if(LUA_TLIGHTUSERDATA == hash_iterator1->keyType)
-		{
-			return (hash_iterator1->currentKey.thePointer == hash_iterator2->currentKey.thePointer);
-		}
-		else if(LUA_TNUMBER == hash_iterator1->keyType)
-		{
-			/* This line is correct! Clang's -Wfloat-equal (-Weverything) complains about this line. Ignore that warning. */
-			return (hash_iterator1->currentKey.theNumber == hash_iterator2->currentKey.theNumber);
-		}
-		else
-		{
-			/* shouldn't get here */
-			LUAHASHMAP_ASSERT(false);
-			return false;
+			return (lua_Number)hash_iterator->currentKey.theInteger;
 		}
+        return hash_iterator->currentKey.theNumber;
+	}
+	else
+	{
+		/* shouldn't get here */
+		LUAHASHMAP_ASSERT(false);
+		return 0.0;
 	}
 }
 
 
-/* Helper function for LuaHashMap_SetValue*AtIterator. This pushes the table and key onto the stack provided from the iterator.
- * It is expected to be immediately followed by pushing the value and calling settable.
- * This should not fail. Validation checking is expected to be done before this.
- */
-static void Internal_PushTableAndKeyInIterator(LuaHashMapIterator* hash_iterator)
+lua_Integer LuaHashMap_GetKeyIntegerAtIterator(const LuaHashMapIterator* hash_iterator)
 {
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_iterator->hashMap->luaState, hash_iterator->hashMap->uniqueTableNameForSharedState); /* stack: [table] */
-
-	switch(hash_iterator->keyType)
+	if(NULL == hash_iterator)
 	{
-		case LUA_TSTRING:
-		{
-			lua_pushlstring(hash_iterator->hashMap->luaState, hash_iterator->currentKey.theString.stringPointer, hash_iterator->currentKey.theString.stringLength); /* stack: [key_string, table] */
-			break;
-		}
-		case LUA_TLIGHTUSERDATA:
-		case LUA_TUSERDATA:
-		{
-			lua_pushlightuserdata(hash_iterator->hashMap->luaState, hash_iterator->currentKey.thePointer); /* stack: [key_pointer, table] */
-			break;
-		}
-		case LUA_TNUMBER:
-		{
-			/* Warning: This might be a problem. I can't easily distinguish between a number and integer.
-			 * If this is supposed to be an integer, I technically should be calling LuaHashMap_SetValue*ForKeyInteger..
-			 * As of this writing, the only difference between the functions is whether I call pushnumber or pushinteger.
-			 * In stock Lua cases, I don't think there will be a real difference.
-			 * To solve this, I would need to know the intention either by an explicit function, 
-			 * or I need to track the intention using a declaration/hint in creation, 
-			 * or I need to flag the first use of a type and save it.
-			 */
-			lua_pushnumber(hash_iterator->hashMap->luaState, hash_iterator->currentKey.theNumber); /* stack: [key_number, table] */
-			break;
-		}
-		default:
-		{
-			/* shouldn't get here */
-			LUAHASHMAP_ASSERT(false);
-			
-			/* pop LUAHASHMAP_GETGLOBAL_UNIQUESTRING */
-			lua_pop(hash_iterator->hashMap->luaState, 1);
-		}
+		return 0;
 	}
-}
-
-static void Internal_SetValueStringAtIteratorWithLength(LuaHashMapIterator* restrict hash_iterator, const char* restrict value_string, size_t value_string_length)
-{
-	/* Early error checking so I can call Internal_PushTableAndKeyInIterator without worrying */
-	switch(hash_iterator->keyType)
+	if(true == hash_iterator->atEnd)
 	{
-		case LUA_TLIGHTUSERDATA:
-		case LUA_TUSERDATA:
-		case LUA_TNUMBER:
-		{
-			break;
-		}
-		case LUA_TSTRING:
-		{
-			if(NULL == hash_iterator->currentKey.theString.stringPointer)
-			{
-				LUAHASHMAP_ASSERT(lua_gettop(hash_iterator->hashMap->luaState) == 0);			
-				return;
-			}
-			break;
-		}
-		default:
+		return 0;
+	}
+	if(true == hash_iterator->isNext)
+	{
+		return 0;
+	}
+	
+	if(LUA_TNUMBER == hash_iterator->keyType)
+	{
+		if(true == hash_iterator->isKeyInteger)
 		{
-			/* shouldn't get here */
-			LUAHASHMAP_ASSERT(false);
-			LUAHASHMAP_ASSERT(lua_gettop(hash_iterator->hashMap->luaState) == 0);
-			return;
+			return hash_iterator->currentKey.theInteger;
 		}
+        return (lua_Integer)hash_iterator->currentKey.theNumber;
+	}
+	else
+	{
+		/* shouldn't get here */
+		LUAHASHMAP_ASSERT(false);
+		return 0;
 	}
-	
-	hash_iterator->valueType = LUA_TSTRING;
-	
-	Internal_PushTableAndKeyInIterator(hash_iterator); /* stack: [key, table] */
-	LUAHASHMAP_PUSHLSTRING_AND_ASSIGNINTERNALSTRING(hash_iterator->hashMap->luaState, value_string, value_string_length, hash_iterator->currentValue.theString.stringPointer); /* stack: [value_string, key, table] */
-	LUAHASHMAP_SETTABLE(hash_iterator->hashMap->luaState, -3);  /* table[key]=value_string; stack: [table] */
-	
-	hash_iterator->currentValue.theString.stringLength = value_string_length; /* Don't forget to save the length */
-	
-	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
-	lua_pop(hash_iterator->hashMap->luaState, 1);
-	LUAHASHMAP_ASSERT(lua_gettop(hash_iterator->hashMap->luaState) == 0);
 }
 
-void LuaHashMap_SetValueStringAtIterator(LuaHashMapIterator* restrict hash_iterator, const char* restrict value_string)
+
+int LuaHashMap_GetCachedValueTypeAtIterator(const LuaHashMapIterator* hash_iterator)
 {
 	if(NULL == hash_iterator)
 	{
-		return;
+		return LUA_TNONE;
 	}
 	if(true == hash_iterator->atEnd)
 	{
-		return;
-	}
-	if(NULL == hash_iterator->hashMap)
-	{
-		return;
+		return LUA_TNONE;
 	}
 	if(true == hash_iterator->isNext)
 	{
-		return;
+		return LUA_TNONE;
 	}
-	Internal_SetValueStringAtIteratorWithLength(hash_iterator, value_string, strlen(value_string));
+	
+	return hash_iterator->valueType;
 }
 
-void LuaHashMap_SetValueStringAtIteratorWithLength(LuaHashMapIterator* restrict hash_iterator, const char* restrict value_string, size_t value_string_length)
+const char* LuaHashMap_GetCachedValueStringAtIterator(const LuaHashMapIterator* hash_iterator)
 {
 	if(NULL == hash_iterator)
 	{
-		return;
+		return NULL;
 	}
 	if(true == hash_iterator->atEnd)
 	{
-		return;
+		return NULL;
 	}
-	if(NULL == hash_iterator->hashMap)
+	if(true == hash_iterator->isNext)
 	{
-		return;
+		return NULL;
 	}
-	if(true == hash_iterator->isNext)
+	if(LUA_TSTRING != hash_iterator->valueType)
 	{
-		return;
+		return NULL;
 	}
-	Internal_SetValueStringAtIteratorWithLength(hash_iterator, value_string, value_string_length);
+	return hash_iterator->currentValue.theString.stringPointer;
 }
 
-
-void LuaHashMap_SetValuePointerAtIterator(LuaHashMapIterator* hash_iterator, void* value_pointer)
+const char* LuaHashMap_GetCachedValueStringAtIteratorWithLength(const LuaHashMapIterator* restrict hash_iterator, size_t* restrict value_string_length_return)
 {
 	if(NULL == hash_iterator)
 	{
-		return;
+		if(NULL != value_string_length_return)
+		{
+			*value_string_length_return = 0;
+		}
+		return NULL;
 	}
 	if(true == hash_iterator->atEnd)
 	{
-		return;
-	}
-	if(NULL == hash_iterator->hashMap)
-	{
-		return;
+		if(NULL != value_string_length_return)
+		{
+			*value_string_length_return = 0;
+		}
+		return NULL;
 	}
 	if(true == hash_iterator->isNext)
 	{
-		return;
-	}
-	
-	/* Early error checking so I can call Internal_PushTableAndKeyInIterator without worrying */
-	switch(hash_iterator->keyType)
-	{
-		case LUA_TLIGHTUSERDATA:
-		case LUA_TUSERDATA:
-		case LUA_TNUMBER:
-		{
-			break;
-		}
-		case LUA_TSTRING:
+		if(NULL != value_string_length_return)
 		{
-			if(NULL == hash_iterator->currentKey.theString.stringPointer)
-			{
-				LUAHASHMAP_ASSERT(lua_gettop(hash_iterator->hashMap->luaState) == 0);			
-				return;
-			}
-			break;
+			*value_string_length_return = 0;
 		}
-		default:
+		return NULL;
+	}
+	if(LUA_TSTRING != hash_iterator->valueType)
+	{
+		if(NULL != value_string_length_return)
 		{
-			/* shouldn't get here */
-			LUAHASHMAP_ASSERT(false);
-			LUAHASHMAP_ASSERT(lua_gettop(hash_iterator->hashMap->luaState) == 0);
-			return;
+			*value_string_length_return = 0;
 		}
+		return NULL;
 	}
-	
-	hash_iterator->valueType = LUA_TLIGHTUSERDATA;
-	
-	Internal_PushTableAndKeyInIterator(hash_iterator); /* stack: [key, table] */
-	lua_pushlightuserdata(hash_iterator->hashMap->luaState, value_pointer); /* stack: [value_pointer, key, table] */
-	LUAHASHMAP_SETTABLE(hash_iterator->hashMap->luaState, -3);  /* table[key]=value_string; stack: [table] */
-	
-	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
-	lua_pop(hash_iterator->hashMap->luaState, 1);
-	LUAHASHMAP_ASSERT(lua_gettop(hash_iterator->hashMap->luaState) == 0);
+
+	if(NULL != value_string_length_return)
+	{
+		*value_string_length_return = hash_iterator->currentKey.theString.stringLength;
+	}
+
+	return hash_iterator->currentValue.theString.stringPointer;
 }
 
-void LuaHashMap_SetValueNumberAtIterator(LuaHashMapIterator* hash_iterator, lua_Number value_number)
+size_t LuaHashMap_GetCachedValueStringLengthAtIterator(const LuaHashMapIterator* hash_iterator)
 {
 	if(NULL == hash_iterator)
 	{
-		return;
+		return 0;
 	}
 	if(true == hash_iterator->atEnd)
 	{
-		return;
+		return 0;
 	}
-	if(NULL == hash_iterator->hashMap)
+	if(true == hash_iterator->isNext)
 	{
-		return;
+		return 0;
+	}
+	if(LUA_TSTRING != hash_iterator->valueType)
+	{
+		return 0;
+	}
+	return hash_iterator->currentValue.theString.stringLength;
+}
+
+
+void* LuaHashMap_GetCachedValuePointerAtIterator(const LuaHashMapIterator* hash_iterator)
+{
+	if(NULL == hash_iterator)
+	{
+		return NULL;
+	}
+	if(true == hash_iterator->atEnd)
+	{
+		return NULL;
 	}
 	if(true == hash_iterator->isNext)
 	{
-		return;
+		return NULL;
 	}
-	
-	/* Early error checking so I can call Internal_PushTableAndKeyInIterator without worrying */
-	switch(hash_iterator->keyType)
+	if(LUA_TLIGHTUSERDATA != hash_iterator->valueType)
 	{
-		case LUA_TLIGHTUSERDATA:
-		case LUA_TUSERDATA:
-		case LUA_TNUMBER:
-		{
-			break;
-		}
-		case LUA_TSTRING:
-		{
-			if(NULL == hash_iterator->currentKey.theString.stringPointer)
-			{
-				LUAHASHMAP_ASSERT(lua_gettop(hash_iterator->hashMap->luaState) == 0);			
-				return;
-			}
-			break;
-		}
-		default:
-		{
-			/* shouldn't get here */
-			LUAHASHMAP_ASSERT(false);
-			LUAHASHMAP_ASSERT(lua_gettop(hash_iterator->hashMap->luaState) == 0);
-			return;
-		}
+		return NULL;
 	}
-	
-	hash_iterator->valueType = LUA_TNUMBER;
-	
-	Internal_PushTableAndKeyInIterator(hash_iterator); /* stack: [key, table] */
-	lua_pushnumber(hash_iterator->hashMap->luaState, value_number); /* stack: [value_number, key, table] */
-	LUAHASHMAP_SETTABLE(hash_iterator->hashMap->luaState, -3);  /* table[key]=value_string; stack: [table] */
-	
-	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
-	lua_pop(hash_iterator->hashMap->luaState, 1);
-	LUAHASHMAP_ASSERT(lua_gettop(hash_iterator->hashMap->luaState) == 0);
+	return hash_iterator->currentValue.thePointer;
 }
 
-void LuaHashMap_SetValueIntegerAtIterator(LuaHashMapIterator* hash_iterator, lua_Integer value_integer)
+lua_Number LuaHashMap_GetCachedValueNumberAtIterator(const LuaHashMapIterator* hash_iterator)
 {
 	if(NULL == hash_iterator)
 	{
-		return;
+		return 0.0;
 	}
 	if(true == hash_iterator->atEnd)
 	{
-		return;
+		return 0.0;
 	}
-	if(NULL == hash_iterator->hashMap)
+	if(true == hash_iterator->isNext)
 	{
-		return;
+		return 0.0;
 	}
-	if(true == hash_iterator->isNext)
+	if(LUA_TNUMBER != hash_iterator->valueType)
 	{
-		return;
+		return 0.0;
 	}
-	
-	/* Early error checking so I can call Internal_PushTableAndKeyInIterator without worrying */
-	switch(hash_iterator->keyType)
+	if(true == hash_iterator->isValueInteger)
 	{
-		case LUA_TLIGHTUSERDATA:
-		case LUA_TUSERDATA:
-		case LUA_TNUMBER:
-		{
-			break;
-		}
-		case LUA_TSTRING:
-		{
-			if(NULL == hash_iterator->currentKey.theString.stringPointer)
-			{
-				LUAHASHMAP_ASSERT(lua_gettop(hash_iterator->hashMap->luaState) == 0);			
-				return;
-			}
-			break;
-		}
-		default:
-		{
-			/* shouldn't get here */
-			LUAHASHMAP_ASSERT(false);
-			LUAHASHMAP_ASSERT(lua_gettop(hash_iterator->hashMap->luaState) == 0);
-			return;
-		}
+		return (lua_Number)hash_iterator->currentValue.theInteger;
 	}
-
-	hash_iterator->valueType = LUA_TNUMBER;
-	
-	Internal_PushTableAndKeyInIterator(hash_iterator); /* stack: [key, table] */
-	lua_pushinteger(hash_iterator->hashMap->luaState, value_integer); /* stack: [value_integer, key, table] */
-	LUAHASHMAP_SETTABLE(hash_iterator->hashMap->luaState, -3);  /* table[key]=value_string; stack: [table] */
-	
-	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
-	lua_pop(hash_iterator->hashMap->luaState, 1);
-	LUAHASHMAP_ASSERT(lua_gettop(hash_iterator->hashMap->luaState) == 0);
+	return hash_iterator->currentValue.theNumber;
 }
 
-static const char* Internal_GetValueStringAtIteratorWithLength(LuaHashMapIterator* restrict hash_iterator, size_t* restrict value_string_length_return)
+lua_Integer LuaHashMap_GetCachedValueIntegerAtIterator(const LuaHashMapIterator* hash_iterator)
 {
-	const char* ret_val = NULL;
-	size_t ret_string_length = 0;
 	if(NULL == hash_iterator)
 	{
-		return NULL;
+		return 0;
 	}
 	if(true == hash_iterator->atEnd)
 	{
-		return NULL;
+		return 0;
 	}
 	if(true == hash_iterator->isNext)
 	{
-		return NULL;
-	}
-	
-	if(LUA_TSTRING == hash_iterator->keyType)
-	{
-        ret_val = LuaHashMap_GetValueStringForKeyStringWithLength(hash_iterator->hashMap, hash_iterator->currentKey.theString.stringPointer, &ret_string_length, hash_iterator->currentKey.theString.stringLength);
+		return 0;
 	}
-	else if(LUA_TLIGHTUSERDATA == hash_iterator->keyType)
+	if(LUA_TNUMBER != hash_iterator->valueType)
 	{
-        ret_val = LuaHashMap_GetValueStringForKeyPointerWithLength(hash_iterator->hashMap, hash_iterator->currentKey.thePointer, &ret_string_length);
+		return 0;
 	}
-	else if(LUA_TNUMBER == hash_iterator->keyType)
+	if(true == hash_iterator->isValueInteger)
 	{
-		/* Warning: This might be a problem. I can't easily distinguish between a number and integer.
-		 * If this is supposed to be an integer, I technically should be calling LuaHashMap_GetValue*ForKeyInteger.
-		 * As of this writing, the only difference between the functions is whether I call pushnumber or pushinteger.
-		 * In stock Lua cases, I don't think there will be a real difference.
-		 * To solve this, I would need to know the intention either by an explicit function, 
-		 * or I need to track the intention using a declaration/hint in creation, 
-		 * or I need to flag the first use of a type and save it.
-		 */
-        ret_val = LuaHashMap_GetValueStringForKeyNumberWithLength(hash_iterator->hashMap, hash_iterator->currentKey.theNumber, &ret_string_length);
-        /* return LuaHashMap_GetValueStringForKeyInteger(hash_iterator->hashMap, hash_iterator->currentKey.theInteger); */
+		return hash_iterator->currentValue.theInteger;
 	}
-	else
+	return (lua_Integer)hash_iterator->currentValue.theNumber;
+}
+#endif /* defined(__STDC_VERSION__) && (__STDC_VERSION__ > 199901L) */
+
+
+
+
+/* Lock-per-shard wrappers. Each shard is a completely independent LuaHashMap (own lua_State), 
+ * so threads only serialize when they hit the same shard.
+ */
+
+/* FNV-1a folds the bytes, then the MurmurHash3 finalizer mixes them so every input bit affects the bits we take the modulo of.
+ * Pointer keys in particular have mostly constant low bits (alignment) which would otherwise pile onto a few shards.
+ * Everything is masked to 32 bits so this gives the same answer whether unsigned long is 32 or 64 bits.
+ */
+static unsigned long Internal_HashBytesForShard(const void* the_bytes, size_t number_of_bytes)
+{
+	const unsigned char* byte_pointer = (const unsigned char*)the_bytes;
+	unsigned long hash_value = 2166136261UL;
+	size_t i;
+	for(i=0; i<number_of_bytes; i++)
 	{
-		/* shouldn't get here */
-		LUAHASHMAP_ASSERT(false);
-		if(NULL != value_string_length_return)
-		{
-			*value_string_length_return = 0;
-		}
-		return NULL;
+		hash_value ^= byte_pointer[i];
+		hash_value = (hash_value * 16777619UL) & 0xFFFFFFFFUL;
 	}
-	hash_iterator->currentValue.theString.stringPointer = ret_val;
-	hash_iterator->currentValue.theString.stringLength = ret_string_length;
-	if(NULL != value_string_length_return)
+	hash_value ^= hash_value >> 16;
+	hash_value = (hash_value * 0x85EBCA6BUL) & 0xFFFFFFFFUL;
+	hash_value ^= hash_value >> 13;
+	hash_value = (hash_value * 0xC2B2AE35UL) & 0xFFFFFFFFUL;
+	hash_value ^= hash_value >> 16;
+	return hash_value;
+}
+
+static LUAHASHMAP_INLINE struct LuaHashMapShard* Internal_GetShardForHash(LuaHashMapSharded* sharded_hash_map, unsigned long hash_value)
+{
+	return &sharded_hash_map->shardsArray[hash_value % sharded_hash_map->numberOfShards].theShard;
+}
+
+static struct LuaHashMapShard* Internal_GetShardForKeyString(LuaHashMapSharded* sharded_hash_map, const char* key_string, size_t key_string_length)
+{
+	if(NULL == key_string)
 	{
-		*value_string_length_return = ret_string_length;
+		/* The shard will reject it the same way a plain LuaHashMap would. */
+		return &sharded_hash_map->shardsArray[0].theShard;
 	}
-	hash_iterator->valueType = LUA_TSTRING;
-	return ret_val;
+	return Internal_GetShardForHash(sharded_hash_map, Internal_HashBytesForShard(key_string, key_string_length));
+}
+
+static struct LuaHashMapShard* Internal_GetShardForKeyPointer(LuaHashMapSharded* sharded_hash_map, void* key_pointer)
+{
+	return Internal_GetShardForHash(sharded_hash_map, Internal_HashBytesForShard(&key_pointer, sizeof(void*)));
 }
 
+static struct LuaHashMapShard* Internal_GetShardForKeyInteger(LuaHashMapSharded* sharded_hash_map, lua_Integer key_integer)
+{
+	return Internal_GetShardForHash(sharded_hash_map, Internal_HashBytesForShard(&key_integer, sizeof(lua_Integer)));
+}
 
-const char* LuaHashMap_GetValueStringAtIterator(LuaHashMapIterator* hash_iterator)
+static struct LuaHashMapShard* Internal_GetShardForKeyNumber(LuaHashMapSharded* sharded_hash_map, lua_Number key_number)
 {
-	if(NULL == hash_iterator)
+	/* 2^(bits-1) computed without overflowing lua_Integer */
+	const lua_Number integer_limit = (lua_Number)((lua_Integer)1 << (sizeof(lua_Integer)*CHAR_BIT - 2)) * 2;
+	/* 3.0 and 3 are the same Lua key, so whole numbers must land on the same shard as the integer version. 
+	 * This also takes care of -0.0 vs 0.0.
+	 */
+	if((key_number >= -integer_limit) && (key_number < integer_limit) && ((lua_Number)(lua_Integer)key_number == key_number))
 	{
-		return NULL;
+		return Internal_GetShardForKeyInteger(sharded_hash_map, (lua_Integer)key_number);
 	}
-	if(true == hash_iterator->atEnd)
+	return Internal_GetShardForHash(sharded_hash_map, Internal_HashBytesForShard(&key_number, sizeof(lua_Number)));
+}
+
+static LUAHASHMAP_INLINE void Internal_LockShard(struct LuaHashMapShard* the_shard)
+{
+	LUAHASHMAP_MUTEX_LOCK(&the_shard->shardLock);
+}
+
+static LUAHASHMAP_INLINE void Internal_UnlockShard(struct LuaHashMapShard* the_shard)
+{
+	LUAHASHMAP_MUTEX_UNLOCK(&the_shard->shardLock);
+}
+
+LuaHashMapSharded* LuaHashMapSharded_CreateWithSizeHints(size_t number_of_shards, int number_of_hash_elements)
+{
+	LuaHashMapSharded* sharded_hash_map;
+	int number_of_hash_elements_per_shard = 0;
+	size_t i;
+
+	if(0 == number_of_shards)
 	{
 		return NULL;
 	}
-	if(true == hash_iterator->isNext)
+	if(number_of_hash_elements > 0)
 	{
-		return NULL;
+		/* Round up so the shards together hold at least what was asked for. */
+		number_of_hash_elements_per_shard = (int)(((size_t)number_of_hash_elements + number_of_shards - 1) / number_of_shards);
 	}
-	return Internal_GetValueStringAtIteratorWithLength(hash_iterator, NULL);
-}
 
-const char* LuaHashMap_GetValueStringAtIteratorWithLength(LuaHashMapIterator* restrict hash_iterator, size_t* restrict value_string_length_return)
-{
-	if(NULL == hash_iterator)
+	sharded_hash_map = (LuaHashMapSharded*)calloc(1, sizeof(LuaHashMapSharded));
+	if(NULL == sharded_hash_map)
 	{
 		return NULL;
 	}
-	if(true == hash_iterator->atEnd)
+	sharded_hash_map->shardsArray = (union LuaHashMapShardSlot*)calloc(number_of_shards, sizeof(union LuaHashMapShardSlot));
+	if(NULL == sharded_hash_map->shardsArray)
 	{
+		free(sharded_hash_map);
 		return NULL;
 	}
-	if(true == hash_iterator->isNext)
+
+	for(i=0; i<number_of_shards; i++)
 	{
-		return NULL;
+		struct LuaHashMapShard* the_shard = &sharded_hash_map->shardsArray[i].theShard;
+		the_shard->hashMap = LuaHashMap_CreateWithSizeHints(0, number_of_hash_elements_per_shard);
+		if(NULL == the_shard->hashMap)
+		{
+			/* Only the first i shards are set up, so that's all we tear down. */
+			sharded_hash_map->numberOfShards = i;
+			LuaHashMapSharded_Free(sharded_hash_map);
+			return NULL;
+		}
+		LUAHASHMAP_MUTEX_INIT(&the_shard->shardLock);
 	}
-	return Internal_GetValueStringAtIteratorWithLength(hash_iterator, value_string_length_return);
+	sharded_hash_map->numberOfShards = number_of_shards;
+	return sharded_hash_map;
 }
 
-void* LuaHashMap_GetValuePointerAtIterator(LuaHashMapIterator* hash_iterator)
+LuaHashMapSharded* LuaHashMapSharded_Create(size_t number_of_shards)
 {
-	void* ret_val = NULL;
-	if(NULL == hash_iterator)
+	return LuaHashMapSharded_CreateWithSizeHints(number_of_shards, 0);
+}
+
+void LuaHashMapSharded_Free(LuaHashMapSharded* sharded_hash_map)
+{
+	size_t i;
+	if(NULL == sharded_hash_map)
 	{
-		return NULL;
+		return;
 	}
-	if(true == hash_iterator->atEnd)
+	for(i=0; i<sharded_hash_map->numberOfShards; i++)
 	{
-		return NULL;
+		struct LuaHashMapShard* the_shard = &sharded_hash_map->shardsArray[i].theShard;
+		LUAHASHMAP_MUTEX_DESTROY(&the_shard->shardLock);
+		LuaHashMap_Free(the_shard->hashMap);
 	}
-	if(true == hash_iterator->isNext)
+	free(sharded_hash_map->shardsArray);
+	free(sharded_hash_map);
+}
+
+size_t LuaHashMapSharded_GetNumberOfShards(LuaHashMapSharded* sharded_hash_map)
+{
+	if(NULL == sharded_hash_map)
 	{
-		return NULL;
+		return 0;
 	}
-	
-	if(LUA_TSTRING == hash_iterator->keyType)
+	return sharded_hash_map->numberOfShards;
+}
+
+size_t LuaHashMapSharded_Count(LuaHashMapSharded* sharded_hash_map)
+{
+	size_t total_count = 0;
+	size_t i;
+	if(NULL == sharded_hash_map)
 	{
-        ret_val = LuaHashMap_GetValuePointerForKeyStringWithLength(hash_iterator->hashMap, hash_iterator->currentKey.theString.stringPointer, hash_iterator->currentKey.theString.stringLength);
+		return 0;
 	}
-	else if(LUA_TLIGHTUSERDATA == hash_iterator->keyType)
+	/* Each shard is counted under its own lock. With concurrent writers the total is only a point-in-time estimate. */
+	for(i=0; i<sharded_hash_map->numberOfShards; i++)
 	{
-        ret_val = LuaHashMap_GetValuePointerForKeyPointer(hash_iterator->hashMap, hash_iterator->currentKey.thePointer);
+		struct LuaHashMapShard* the_shard = &sharded_hash_map->shardsArray[i].theShard;
+		Internal_LockShard(the_shard);
+		total_count += LuaHashMap_Count(the_shard->hashMap);
+		Internal_UnlockShard(the_shard);
 	}
-	else if(LUA_TNUMBER == hash_iterator->keyType)
+	return total_count;
+}
+
+bool LuaHashMapSharded_IsEmpty(LuaHashMapSharded* sharded_hash_map)
+{
+	size_t i;
+	if(NULL == sharded_hash_map)
 	{
-		/* Warning: This might be a problem. I can't easily distinguish between a number and integer.
-		 * If this is supposed to be an integer, I technically should be calling LuaHashMap_GetValue*ForKeyInteger.
-		 * As of this writing, the only difference between the functions is whether I call pushnumber or pushinteger.
-		 * In stock Lua cases, I don't think there will be a real difference.
-		 * To solve this, I would need to know the intention either by an explicit function, 
-		 * or I need to track the intention using a declaration/hint in creation, 
-		 * or I need to flag the first use of a type and save it.
-		 */
-        ret_val = LuaHashMap_GetValuePointerForKeyNumber(hash_iterator->hashMap, hash_iterator->currentKey.theNumber);
-        /* return LuaHashMap_GetValuePointerForKeyInteger(hash_iterator->hashMap, hash_iterator->currentKey.theInteger); */
+		return true;
 	}
-	else
+	for(i=0; i<sharded_hash_map->numberOfShards; i++)
 	{
-		/* shouldn't get here */
-		LUAHASHMAP_ASSERT(false);
-		return NULL;
+		struct LuaHashMapShard* the_shard = &sharded_hash_map->shardsArray[i].theShard;
+		bool is_empty;
+		Internal_LockShard(the_shard);
+		is_empty = LuaHashMap_IsEmpty(the_shard->hashMap);
+		Internal_UnlockShard(the_shard);
+		if(false == is_empty)
+		{
+			return false;
+		}
 	}
-	hash_iterator->currentValue.thePointer = ret_val;
-	hash_iterator->valueType = LUA_TLIGHTUSERDATA;
-	return ret_val;
+	return true;
 }
 
-lua_Number LuaHashMap_GetValueNumberAtIterator(LuaHashMapIterator* hash_iterator)
+void LuaHashMapSharded_Clear(LuaHashMapSharded* sharded_hash_map)
 {
-	lua_Number ret_val = 0.0;
-	if(NULL == hash_iterator)
+	size_t i;
+	if(NULL == sharded_hash_map)
 	{
-		return 0.0;
+		return;
 	}
-	if(true == hash_iterator->atEnd)
+	for(i=0; i<sharded_hash_map->numberOfShards; i++)
 	{
-		return 0.0;
+		struct LuaHashMapShard* the_shard = &sharded_hash_map->shardsArray[i].theShard;
+		Internal_LockShard(the_shard);
+		LuaHashMap_Clear(the_shard->hashMap);
+		Internal_UnlockShard(the_shard);
 	}
-	if(true == hash_iterator->isNext)
+}
+
+int LuaHashMapSharded_ForEach(LuaHashMapSharded* sharded_hash_map, LuaHashMap_ForEachCallback callback_function, void* user_data)
+{
+	int ret_val = 0;
+	size_t i;
+	if(NULL == sharded_hash_map)
 	{
-		return 0.0;
+		return 0;
 	}
-	
-	if(LUA_TSTRING == hash_iterator->keyType)
+	for(i=0; (i<sharded_hash_map->numberOfShards) && (0 == ret_val); i++)
 	{
-        ret_val = LuaHashMap_GetValueNumberForKeyStringWithLength(hash_iterator->hashMap, hash_iterator->currentKey.theString.stringPointer, hash_iterator->currentKey.theString.stringLength);
+		struct LuaHashMapShard* the_shard = &sharded_hash_map->shardsArray[i].theShard;
+		Internal_LockShard(the_shard);
+		ret_val = LuaHashMap_ForEach(the_shard->hashMap, callback_function, user_data);
+		Internal_UnlockShard(the_shard);
 	}
-	else if(LUA_TLIGHTUSERDATA == hash_iterator->keyType)
+	return ret_val;
+}
+
+void LuaHashMapSharded_SetValueStringForKeyString(LuaHashMapSharded* restrict sharded_hash_map, const char* value_string, const char* key_string)
+{
+	struct LuaHashMapShard* the_shard;
+	if(NULL == sharded_hash_map)
 	{
-        ret_val = LuaHashMap_GetValueNumberForKeyPointer(hash_iterator->hashMap, hash_iterator->currentKey.thePointer);
+		return;
 	}
-	else if(LUA_TNUMBER == hash_iterator->keyType)
+	the_shard = Internal_GetShardForKeyString(sharded_hash_map, key_string, (NULL == key_string) ? 0 : strlen(key_string));
+	Internal_LockShard(the_shard);
+	LuaHashMap_SetValueStringForKeyString(the_shard->hashMap, value_string, key_string);
+	Internal_UnlockShard(the_shard);
+}
+
+void LuaHashMapSharded_SetValueStringForKeyStringWithLength(LuaHashMapSharded* restrict sharded_hash_map, const char* value_string, const char* key_string, size_t value_string_length, size_t key_string_length)
+{
+	struct LuaHashMapShard* the_shard;
+	if(NULL == sharded_hash_map)
 	{
-		/* Warning: This might be a problem. I can't easily distinguish between a number and integer.
-		 * If this is supposed to be an integer, I technically should be calling LuaHashMap_GetValue*ForKeyInteger.
-		 * As of this writing, the only difference between the functions is whether I call pushnumber or pushinteger.
-		 * In stock Lua cases, I don't think there will be a real difference.
-		 * To solve this, I would need to know the intention either by an explicit function, 
-		 * or I need to track the intention using a declaration/hint in creation, 
-		 * or I need to flag the first use of a type and save it.
-		 */
-        ret_val = LuaHashMap_GetValueNumberForKeyNumber(hash_iterator->hashMap, hash_iterator->currentKey.theNumber);
-        /* return LuaHashMap_GetValueNumberForKeyInteger(hash_iterator->hashMap, hash_iterator->currentKey.theInteger); */
+		return;
 	}
-	else
+	the_shard = Internal_GetShardForKeyString(sharded_hash_map, key_string, key_string_length);
+	Internal_LockShard(the_shard);
+	LuaHashMap_SetValueStringForKeyStringWithLength(the_shard->hashMap, value_string, key_string, value_string_length, key_string_length);
+	Internal_UnlockShard(the_shard);
+}
+
+void LuaHashMapSharded_SetValuePointerForKeyString(LuaHashMapSharded* sharded_hash_map, void* value_pointer, const char* key_string)
+{
+	struct LuaHashMapShard* the_shard;
+	if(NULL == sharded_hash_map)
 	{
-		/* shouldn't get here */
-		LUAHASHMAP_ASSERT(false);
-		return 0.0;
+		return;
 	}
-	hash_iterator->currentValue.theNumber = ret_val;
-	hash_iterator->valueType = LUA_TNUMBER;
-	return ret_val;
+	the_shard = Internal_GetShardForKeyString(sharded_hash_map, key_string, (NULL == key_string) ? 0 : strlen(key_string));
+	Internal_LockShard(the_shard);
+	LuaHashMap_SetValuePointerForKeyString(the_shard->hashMap, value_pointer, key_string);
+	Internal_UnlockShard(the_shard);
 }
 
-
-lua_Integer LuaHashMap_GetValueIntegerAtIterator(LuaHashMapIterator* hash_iterator)
+void LuaHashMapSharded_SetValuePointerForKeyStringWithLength(LuaHashMapSharded* sharded_hash_map, void* value_pointer, const char* key_string, size_t key_string_length)
 {
-	lua_Integer ret_val = 0;
-	if(NULL == hash_iterator)
+	struct LuaHashMapShard* the_shard;
+	if(NULL == sharded_hash_map)
 	{
-		return 0;
+		return;
 	}
-	if(true == hash_iterator->atEnd)
+	the_shard = Internal_GetShardForKeyString(sharded_hash_map, key_string, key_string_length);
+	Internal_LockShard(the_shard);
+	LuaHashMap_SetValuePointerForKeyStringWithLength(the_shard->hashMap, value_pointer, key_string, key_string_length);
+	Internal_UnlockShard(the_shard);
+}
+
+void LuaHashMapSharded_SetValueNumberForKeyString(LuaHashMapSharded* restrict sharded_hash_map, lua_Number value_number, const char* restrict key_string)
+{
+	struct LuaHashMapShard* the_shard;
+	if(NULL == sharded_hash_map)
 	{
-		return 0;
+		return;
 	}
-	if(true == hash_iterator->isNext)
+	the_shard = Internal_GetShardForKeyString(sharded_hash_map, key_string, (NULL == key_string) ? 0 : strlen(key_string));
+	Internal_LockShard(the_shard);
+	LuaHashMap_SetValueNumberForKeyString(the_shard->hashMap, value_number, key_string);
+	Internal_UnlockShard(the_shard);
+}
+
+void LuaHashMapSharded_SetValueNumberForKeyStringWithLength(LuaHashMapSharded* restrict sharded_hash_map, lua_Number value_number, const char* restrict key_string, size_t key_string_length)
+{
+	struct LuaHashMapShard* the_shard;
+	if(NULL == sharded_hash_map)
 	{
-		return 0;
+		return;
 	}
-	
-	if(LUA_TSTRING == hash_iterator->keyType)
+	the_shard = Internal_GetShardForKeyString(sharded_hash_map, key_string, key_string_length);
+	Internal_LockShard(the_shard);
+	LuaHashMap_SetValueNumberForKeyStringWithLength(the_shard->hashMap, value_number, key_string, key_string_length);
+	Internal_UnlockShard(the_shard);
+}
+
+void LuaHashMapSharded_SetValueIntegerForKeyString(LuaHashMapSharded* restrict sharded_hash_map, lua_Integer value_integer, const char* restrict key_string)
+{
+	struct LuaHashMapShard* the_shard;
+	if(NULL == sharded_hash_map)
 	{
-        ret_val = LuaHashMap_GetValueIntegerForKeyStringWithLength(hash_iterator->hashMap, hash_iterator->currentKey.theString.stringPointer, hash_iterator->currentKey.theString.stringLength);
+		return;
 	}
-	else if(LUA_TLIGHTUSERDATA == hash_iterator->keyType)
+	the_shard = Internal_GetShardForKeyString(sharded_hash_map, key_string, (NULL == key_string) ? 0 : strlen(key_string));
+	Internal_LockShard(the_shard);
+	LuaHashMap_SetValueIntegerForKeyString(the_shard->hashMap, value_integer, key_string);
+	Internal_UnlockShard(the_shard);
+}
+
+void LuaHashMapSharded_SetValueIntegerForKeyStringWithLength(LuaHashMapSharded* restrict sharded_hash_map, lua_Integer value_integer, const char* restrict key_string, size_t key_string_length)
+{
+	struct LuaHashMapShard* the_shard;
+	if(NULL == sharded_hash_map)
 	{
-        ret_val = LuaHashMap_GetValueIntegerForKeyPointer(hash_iterator->hashMap, hash_iterator->currentKey.thePointer);
+		return;
 	}
-	else if(LUA_TNUMBER == hash_iterator->keyType)
+	the_shard = Internal_GetShardForKeyString(sharded_hash_map, key_string, key_string_length);
+	Internal_LockShard(the_shard);
+	LuaHashMap_SetValueIntegerForKeyStringWithLength(the_shard->hashMap, value_integer, key_string, key_string_length);
+	Internal_UnlockShard(the_shard);
+}
+
+void LuaHashMapSharded_SetValueStringForKeyPointer(LuaHashMapSharded* sharded_hash_map, const char* value_string, void* key_pointer)
+{
+	struct LuaHashMapShard* the_shard;
+	if(NULL == sharded_hash_map)
 	{
-		/* Warning: This might be a problem. I can't easily distinguish between a number and integer.
-		 * If this is supposed to be an integer, I technically should be calling LuaHashMap_GetValue*ForKeyInteger.
-		 * As of this writing, the only difference between the functions is whether I call pushnumber or pushinteger.
-		 * In stock Lua cases, I don't think there will be a real difference.
-		 * To solve this, I would need to know the intention either by an explicit function, 
-		 * or I need to track the intention using a declaration/hint in creation, 
-		 * or I need to flag the first use of a type and save it.
-		 */
-        ret_val = LuaHashMap_GetValueIntegerForKeyNumber(hash_iterator->hashMap, hash_iterator->currentKey.theNumber);
-        /* return LuaHashMap_GetValueIntegerForKeyInteger(hash_iterator->hashMap, hash_iterator->currentKey.theInteger); */
+		return;
 	}
-	else
+	the_shard = Internal_GetShardForKeyPointer(sharded_hash_map, key_pointer);
+	Internal_LockShard(the_shard);
+	LuaHashMap_SetValueStringForKeyPointer(the_shard->hashMap, value_string, key_pointer);
+	Internal_UnlockShard(the_shard);
+}
+
+void LuaHashMapSharded_SetValueStringForKeyPointerWithLength(LuaHashMapSharded* sharded_hash_map, const char* value_string, void* key_pointer, size_t value_string_length)
+{
+	struct LuaHashMapShard* the_shard;
+	if(NULL == sharded_hash_map)
 	{
-		/* shouldn't get here */
-		LUAHASHMAP_ASSERT(false);
-		return 0;
+		return;
 	}
-	hash_iterator->currentValue.theNumber = (lua_Number)ret_val;
-	hash_iterator->valueType = LUA_TNUMBER;
-	return ret_val;
+	the_shard = Internal_GetShardForKeyPointer(sharded_hash_map, key_pointer);
+	Internal_LockShard(the_shard);
+	LuaHashMap_SetValueStringForKeyPointerWithLength(the_shard->hashMap, value_string, key_pointer, value_string_length);
+	Internal_UnlockShard(the_shard);
 }
 
-bool LuaHashMap_ExistsAtIterator(LuaHashMapIterator* hash_iterator)
+void LuaHashMapSharded_SetValuePointerForKeyPointer(LuaHashMapSharded* sharded_hash_map, void* value_pointer, void* key_pointer)
 {
-	int value_type;
-	if(NULL == hash_iterator)
+	struct LuaHashMapShard* the_shard;
+	if(NULL == sharded_hash_map)
 	{
-		return false;
+		return;
 	}
-	if(true == hash_iterator->atEnd)
+	the_shard = Internal_GetShardForKeyPointer(sharded_hash_map, key_pointer);
+	Internal_LockShard(the_shard);
+	LuaHashMap_SetValuePointerForKeyPointer(the_shard->hashMap, value_pointer, key_pointer);
+	Internal_UnlockShard(the_shard);
+}
+
+void LuaHashMapSharded_SetValueNumberForKeyPointer(LuaHashMapSharded* sharded_hash_map, lua_Number value_number, void* key_pointer)
+{
+	struct LuaHashMapShard* the_shard;
+	if(NULL == sharded_hash_map)
 	{
-		return false;
+		return;
 	}
-	if(true == hash_iterator->isNext)
+	the_shard = Internal_GetShardForKeyPointer(sharded_hash_map, key_pointer);
+	Internal_LockShard(the_shard);
+	LuaHashMap_SetValueNumberForKeyPointer(the_shard->hashMap, value_number, key_pointer);
+	Internal_UnlockShard(the_shard);
+}
+
+void LuaHashMapSharded_SetValueIntegerForKeyPointer(LuaHashMapSharded* sharded_hash_map, lua_Integer value_integer, void* key_pointer)
+{
+	struct LuaHashMapShard* the_shard;
+	if(NULL == sharded_hash_map)
 	{
-		return false;
+		return;
 	}
-	
-	switch(hash_iterator->keyType)
+	the_shard = Internal_GetShardForKeyPointer(sharded_hash_map, key_pointer);
+	Internal_LockShard(the_shard);
+	LuaHashMap_SetValueIntegerForKeyPointer(the_shard->hashMap, value_integer, key_pointer);
+	Internal_UnlockShard(the_shard);
+}
+
+void LuaHashMapSharded_SetValueStringForKeyNumber(LuaHashMapSharded* restrict sharded_hash_map, const char* restrict value_string, lua_Number key_number)
+{
+	struct LuaHashMapShard* the_shard;
+	if(NULL == sharded_hash_map)
 	{
-		case LUA_TSTRING:
-		{
-			break;
-			
-		}
-		case LUA_TLIGHTUSERDATA:
-		case LUA_TUSERDATA:
-		{
-			break;
-			
-		}
-		case LUA_TNUMBER:
-		{
-			break;
-		}
-		default:
-		{
-			/* shouldn't get here */
-			LUAHASHMAP_ASSERT(false);
-			return false;
-		}
+		return;
 	}
-	
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_iterator->hashMap->luaState, hash_iterator->hashMap->uniqueTableNameForSharedState); /* stack: [table] */
+	the_shard = Internal_GetShardForKeyNumber(sharded_hash_map, key_number);
+	Internal_LockShard(the_shard);
+	LuaHashMap_SetValueStringForKeyNumber(the_shard->hashMap, value_string, key_number);
+	Internal_UnlockShard(the_shard);
+}
 
-	switch(hash_iterator->keyType)
+void LuaHashMapSharded_SetValueStringForKeyNumberWithLength(LuaHashMapSharded* restrict sharded_hash_map, const char* restrict value_string, lua_Number key_number, size_t value_string_length)
+{
+	struct LuaHashMapShard* the_shard;
+	if(NULL == sharded_hash_map)
 	{
-		case LUA_TSTRING:
-		{
-			lua_pushlstring(hash_iterator->hashMap->luaState, hash_iterator->currentKey.theString.stringPointer, hash_iterator->currentKey.theString.stringLength); /* stack: [key_string, table] */
-			break;
-
-		}
-		case LUA_TLIGHTUSERDATA:
-		case LUA_TUSERDATA:
-		{
-			lua_pushlightuserdata(hash_iterator->hashMap->luaState, hash_iterator->currentKey.thePointer); /* stack: [key_pointer, table] */
-
-			break;
-
-		}
-		case LUA_TNUMBER:
-		{
-			lua_pushnumber(hash_iterator->hashMap->luaState, hash_iterator->currentKey.theNumber); /* stack: [key_number, table] */
-			break;
-		}
-		default:
-		{
-			/* shouldn't get here */
-			LUAHASHMAP_ASSERT(false);
-			/* pop LUAHASHMAP_GETGLOBAL_UNIQUESTRING */
-			lua_pop(hash_iterator->hashMap->luaState, 1);
-			LUAHASHMAP_ASSERT(lua_gettop(hash_iterator->hashMap->luaState) == 0);			
-			return false;
-		}
+		return;
 	}
-	
-	LUAHASHMAP_GETTABLE(hash_iterator->hashMap->luaState, -2);  /* table[key]; stack: [value, table] */
-
-	value_type = lua_type(hash_iterator->hashMap->luaState, -1);
-	
-	/* Cache the value before returning */
-	Internal_SetCurrentValueInIteratorFromStackIndex(hash_iterator, -1);
+	the_shard = Internal_GetShardForKeyNumber(sharded_hash_map, key_number);
+	Internal_LockShard(the_shard);
+	LuaHashMap_SetValueStringForKeyNumberWithLength(the_shard->hashMap, value_string, key_number, value_string_length);
+	Internal_UnlockShard(the_shard);
+}
 
-	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
-	lua_pop(hash_iterator->hashMap->luaState, 2);
-	LUAHASHMAP_ASSERT(lua_gettop(hash_iterator->hashMap->luaState) == 0);			
-	
-	
-	switch(value_type)
+void LuaHashMapSharded_SetValuePointerForKeyNumber(LuaHashMapSharded* sharded_hash_map, void* value_pointer, lua_Number key_number)
+{
+	struct LuaHashMapShard* the_shard;
+	if(NULL == sharded_hash_map)
 	{
-		case LUA_TSTRING:
-		case LUA_TLIGHTUSERDATA:
-		case LUA_TUSERDATA:
-		case LUA_TNUMBER:
-		{
-			return true;
-		}
-		default:
-		{
-			return false;
-		}
+		return;
 	}
+	the_shard = Internal_GetShardForKeyNumber(sharded_hash_map, key_number);
+	Internal_LockShard(the_shard);
+	LuaHashMap_SetValuePointerForKeyNumber(the_shard->hashMap, value_pointer, key_number);
+	Internal_UnlockShard(the_shard);
+}
 
-	
+void LuaHashMapSharded_SetValueNumberForKeyNumber(LuaHashMapSharded* sharded_hash_map, lua_Number value_number, lua_Number key_number)
+{
+	struct LuaHashMapShard* the_shard;
+	if(NULL == sharded_hash_map)
+	{
+		return;
+	}
+	the_shard = Internal_GetShardForKeyNumber(sharded_hash_map, key_number);
+	Internal_LockShard(the_shard);
+	LuaHashMap_SetValueNumberForKeyNumber(the_shard->hashMap, value_number, key_number);
+	Internal_UnlockShard(the_shard);
 }
 
-void LuaHashMap_RemoveAtIterator(LuaHashMapIterator* hash_iterator)
+void LuaHashMapSharded_SetValueIntegerForKeyNumber(LuaHashMapSharded* sharded_hash_map, lua_Integer value_integer, lua_Number key_number)
 {
-	union LuaHashMapKeyValueType next_key;
-	union LuaHashMapKeyValueType next_value;
-	int next_key_type = LUA_TNONE;
-	int next_value_type = LUA_TNONE;
-	
-	if(NULL == hash_iterator)
+	struct LuaHashMapShard* the_shard;
+	if(NULL == sharded_hash_map)
 	{
 		return;
 	}
-	if(true == hash_iterator->atEnd)
+	the_shard = Internal_GetShardForKeyNumber(sharded_hash_map, key_number);
+	Internal_LockShard(the_shard);
+	LuaHashMap_SetValueIntegerForKeyNumber(the_shard->hashMap, value_integer, key_number);
+	Internal_UnlockShard(the_shard);
+}
+
+void LuaHashMapSharded_SetValueStringForKeyInteger(LuaHashMapSharded* restrict sharded_hash_map, const char* restrict value_string, lua_Integer key_integer)
+{
+	struct LuaHashMapShard* the_shard;
+	if(NULL == sharded_hash_map)
 	{
 		return;
 	}
-	if(true == hash_iterator->isNext)
+	the_shard = Internal_GetShardForKeyInteger(sharded_hash_map, key_integer);
+	Internal_LockShard(the_shard);
+	LuaHashMap_SetValueStringForKeyInteger(the_shard->hashMap, value_string, key_integer);
+	Internal_UnlockShard(the_shard);
+}
+
+void LuaHashMapSharded_SetValueStringForKeyIntegerWithLength(LuaHashMapSharded* restrict sharded_hash_map, const char* restrict value_string, lua_Integer key_integer, size_t value_string_length)
+{
+	struct LuaHashMapShard* the_shard;
+	if(NULL == sharded_hash_map)
 	{
 		return;
 	}
-	
-	switch(hash_iterator->keyType)
+	the_shard = Internal_GetShardForKeyInteger(sharded_hash_map, key_integer);
+	Internal_LockShard(the_shard);
+	LuaHashMap_SetValueStringForKeyIntegerWithLength(the_shard->hashMap, value_string, key_integer, value_string_length);
+	Internal_UnlockShard(the_shard);
+}
+
+void LuaHashMapSharded_SetValuePointerForKeyInteger(LuaHashMapSharded* sharded_hash_map, void* value_pointer, lua_Integer key_integer)
+{
+	struct LuaHashMapShard* the_shard;
+	if(NULL == sharded_hash_map)
 	{
-		case LUA_TSTRING:
-		case LUA_TLIGHTUSERDATA:
-		case LUA_TUSERDATA:
-		case LUA_TNUMBER:
-		{
-			break;
-		}
-		default:
-		{
-			return;
-		}
+		return;
 	}
+	the_shard = Internal_GetShardForKeyInteger(sharded_hash_map, key_integer);
+	Internal_LockShard(the_shard);
+	LuaHashMap_SetValuePointerForKeyInteger(the_shard->hashMap, value_pointer, key_integer);
+	Internal_UnlockShard(the_shard);
+}
 
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_iterator->hashMap->luaState, hash_iterator->hashMap->uniqueTableNameForSharedState); /* stack: [table] */
-	switch(hash_iterator->keyType)
+void LuaHashMapSharded_SetValueNumberForKeyInteger(LuaHashMapSharded* sharded_hash_map, lua_Number value_number, lua_Integer key_integer)
+{
+	struct LuaHashMapShard* the_shard;
+	if(NULL == sharded_hash_map)
 	{
-		case LUA_TSTRING:
-		{
-			lua_pushlstring(hash_iterator->hashMap->luaState, hash_iterator->currentKey.theString.stringPointer, hash_iterator->currentKey.theString.stringLength); /* stack: [key table] */
-			break;
-		}
-		case LUA_TLIGHTUSERDATA:
-		case LUA_TUSERDATA:
-		{
-			lua_pushlightuserdata(hash_iterator->hashMap->luaState, hash_iterator->currentKey.thePointer); /* stack: [key table] */
-			break;
-		}
-		case LUA_TNUMBER:
-		{
-			lua_pushnumber(hash_iterator->hashMap->luaState, hash_iterator->currentKey.theNumber); /* stack: [key table] */
-			break;
-		}
-		default:
-		{
-			/* shouldn't get here */
-			LUAHASHMAP_ASSERT(false);
-			/* pop LUAHASHMAP_GETGLOBAL_UNIQUESTRING */
-			lua_pop(hash_iterator->hashMap->luaState, 1);
-			LUAHASHMAP_ASSERT(lua_gettop(hash_iterator->hashMap->luaState) == 0);
-			return;
-		}
+		return;
 	}
-	
-	/* Before setting the value to nil, we want to fetch/save the next key so iterating while removing can be done. */
-	
-	/* For performance, duplicate the just pushed key on the stack because we'll need to come back to it when we remove the value */
-	/* This will avoid re-inserting from the C-side which may hopefully skip some strlen() and string comparisons in the string case. */
-	/* It also saves us from needing to figure out what type the key is again. */
-	lua_pushvalue(hash_iterator->hashMap->luaState, -1); /* stack: [key key table] */
+	the_shard = Internal_GetShardForKeyInteger(sharded_hash_map, key_integer);
+	Internal_LockShard(the_shard);
+	LuaHashMap_SetValueNumberForKeyInteger(the_shard->hashMap, value_number, key_integer);
+	Internal_UnlockShard(the_shard);
+}
 
-	/* Using the duplicated key on top of the stack, use lua_next to find the next key/value pair. */
-	if(lua_next(hash_iterator->hashMap->luaState, -3) != 0)
+void LuaHashMapSharded_SetValueIntegerForKeyInteger(LuaHashMapSharded* sharded_hash_map, lua_Integer value_integer, lua_Integer key_integer)
+{
+	struct LuaHashMapShard* the_shard;
+	if(NULL == sharded_hash_map)
 	{
-		/* stack: [next_value next_key key table] */
-		next_key_type = lua_type(hash_iterator->hashMap->luaState, -2); 
-		next_value_type = lua_type(hash_iterator->hashMap->luaState, -1);
-		
-		/* Save the next key in a temporary variable */
-		switch(next_key_type)
-		{
-			case LUA_TSTRING:
-			{
-				next_key.theString.stringPointer = lua_tolstring(hash_iterator->hashMap->luaState, -2, &next_key.theString.stringLength);
-				break;
-			}
-			case LUA_TLIGHTUSERDATA:
-			case LUA_TUSERDATA:
-			{
-				next_key.thePointer = lua_touserdata(hash_iterator->hashMap->luaState, -2);
-				break;
-			}
-			case LUA_TNUMBER:
-			{
-				next_key.theNumber = lua_tonumber(hash_iterator->hashMap->luaState, -2);
-				break;
-			}
-			default:
-			{
-				break;
-			}
-		}
-		
-		/* Save the next value in a temporary variable */
-		switch(next_value_type)
-		{
-			case LUA_TSTRING:
-			{
-				next_value.theString.stringPointer = lua_tolstring(hash_iterator->hashMap->luaState, -1, &next_value.theString.stringLength);
-				break;
-			}
-			case LUA_TLIGHTUSERDATA:
-			case LUA_TUSERDATA:
-			{
-				next_value.thePointer = lua_touserdata(hash_iterator->hashMap->luaState, -1);
-				break;
-			}
-			case LUA_TNUMBER:
-			{
-				next_value.theNumber = lua_tonumber(hash_iterator->hashMap->luaState, -1);
-				break;
-			}
-			default:
-			{
-				break;
-			}
-		}
+		return;
+	}
+	the_shard = Internal_GetShardForKeyInteger(sharded_hash_map, key_integer);
+	Internal_LockShard(the_shard);
+	LuaHashMap_SetValueIntegerForKeyInteger(the_shard->hashMap, value_integer, key_integer);
+	Internal_UnlockShard(the_shard);
+}
 
-		/* Now pop the next key/value and go back to our regularly scheduled program. */
-		lua_pop(hash_iterator->hashMap->luaState, 2); /* stack: [key table] */
+/* Copies as much of the value as fits (always terminated if value_buffer_size > 0) and returns its full length, like snprintf. 
+ * A missing value copies as the empty string.
+ */
+static size_t Internal_CopyShardValueString(const char* value_string, size_t value_string_length, char* value_buffer, size_t value_buffer_size)
+{
+	size_t copy_length;
+	if(NULL == value_string)
+	{
+		value_string_length = 0;
 	}
-	else
+	if((NULL == value_buffer) || (0 == value_buffer_size))
 	{
-		/* No next, so we are at the end of the hash. */
-		/* stack: [key table] */
-		
-		memset(&next_key, 0, sizeof(union LuaHashMapKeyValueType));
-		memset(&next_value, 0, sizeof(union LuaHashMapKeyValueType));
-		next_key_type = LUA_TNONE;
-		next_value_type = LUA_TNONE;
+		return value_string_length;
 	}
-	
-	
-	/* Now back to the regularly scheduled program of removing the key/value */
-	/* stack: [key table] */
-	lua_pushnil(hash_iterator->hashMap->luaState); /* stack: [nil, key, table] */
-	LUAHASHMAP_SETTABLE(hash_iterator->hashMap->luaState, -3);  /* table[key_string]=nil; stack: [table] */
-
-	
-	/* table is still on top of stack. Don't forget to pop it now that we are done with it */
-	lua_pop(hash_iterator->hashMap->luaState, 1);
-	LUAHASHMAP_ASSERT(lua_gettop(hash_iterator->hashMap->luaState) == 0);
-	
-	/* Now that we've removed the key/value pair, the current iterator is invalid.
-	 * In the worst case, Lua will collect the key so when we try to use IteratorNext which has a stale key,
-	 * it will fail when it tries to use lua_next with that stale key.
-	 * To get around this, we mark this iterator as 'invalid' and save the next key so IteratorNext knows it needs to
-	 * do something special because the normal current key has been invalidated/destroyed.
-	 * I will use an isNext flag to denote this special case and reuse the currentKey and currentValue fields to store the next values.
-	 * If there is no next, I will use the type LUA_TNONE to infer that there is no next in the IteratorNext implementation.
-	 */
-	hash_iterator->isNext = true;
-	hash_iterator->keyType = next_key_type;
-	hash_iterator->valueType = next_value_type;
-	hash_iterator->currentKey = next_key;
-	hash_iterator->currentValue = next_value;
+	copy_length = (value_string_length < value_buffer_size) ? value_string_length : (value_buffer_size - 1);
+	if(copy_length > 0)
+	{
+		memcpy(value_buffer, value_string, copy_length);
+	}
+	value_buffer[copy_length] = '\0';
+	return value_string_length;
 }
 
-static size_t Internal_Count(LuaHashMap* hash_map)
+size_t LuaHashMapSharded_CopyValueStringForKeyStringWithLength(LuaHashMapSharded* restrict sharded_hash_map, const char* restrict key_string, char* restrict value_buffer, size_t value_buffer_size, size_t key_string_length)
 {
-	size_t total_count = 0;
+	struct LuaHashMapShard* the_shard;
+	const char* value_string;
+	size_t value_string_length = 0;
+	size_t ret_val;
+	if(NULL == sharded_hash_map)
+	{
+		return Internal_CopyShardValueString(NULL, 0, value_buffer, value_buffer_size);
+	}
+	the_shard = Internal_GetShardForKeyString(sharded_hash_map, key_string, key_string_length);
+	Internal_LockShard(the_shard);
+	value_string = LuaHashMap_GetValueStringForKeyStringWithLength(the_shard->hashMap, key_string, &value_string_length, key_string_length);
+	/* Copy while we still hold the lock. Once it's released, another thread may remove the value and the string may be collected. */
+	ret_val = Internal_CopyShardValueString(value_string, value_string_length, value_buffer, value_buffer_size);
+	Internal_UnlockShard(the_shard);
+	return ret_val;
+}
 
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+size_t LuaHashMapSharded_CopyValueStringForKeyString(LuaHashMapSharded* restrict sharded_hash_map, const char* restrict key_string, char* restrict value_buffer, size_t value_buffer_size)
+{
+	return LuaHashMapSharded_CopyValueStringForKeyStringWithLength(sharded_hash_map, key_string, value_buffer, value_buffer_size, (NULL == key_string) ? 0 : strlen(key_string));
+}
 
-	lua_pushnil(hash_map->luaState);  /* first key */
-	while (lua_next(hash_map->luaState, -2) != 0) /* use index of table */
+void* LuaHashMapSharded_GetValuePointerForKeyString(LuaHashMapSharded* restrict sharded_hash_map, const char* restrict key_string)
+{
+	struct LuaHashMapShard* the_shard;
+	void* ret_val;
+	if(NULL == sharded_hash_map)
 	{
-		/* lua_next puts 'key' (at index -2) and 'value' (at index -1) */
-		total_count++;
-		/* removes 'value'; keeps 'key' for next iteration */
-		lua_pop(hash_map->luaState, 1);
+		return NULL;
 	}
-
-	/* Pop the global table */
-	lua_pop(hash_map->luaState, 1);	
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);	
-	return total_count;
+	the_shard = Internal_GetShardForKeyString(sharded_hash_map, key_string, (NULL == key_string) ? 0 : strlen(key_string));
+	Internal_LockShard(the_shard);
+	ret_val = LuaHashMap_GetValuePointerForKeyString(the_shard->hashMap, key_string);
+	Internal_UnlockShard(the_shard);
+	return ret_val;
 }
 
-size_t LuaHashMap_Count(LuaHashMap* hash_map)
+void* LuaHashMapSharded_GetValuePointerForKeyStringWithLength(LuaHashMapSharded* restrict sharded_hash_map, const char* restrict key_string, size_t key_string_length)
 {
-	if(NULL == hash_map)
+	struct LuaHashMapShard* the_shard;
+	void* ret_val;
+	if(NULL == sharded_hash_map)
 	{
-		return 0;
+		return NULL;
 	}
-	return Internal_Count(hash_map);
+	the_shard = Internal_GetShardForKeyString(sharded_hash_map, key_string, key_string_length);
+	Internal_LockShard(the_shard);
+	ret_val = LuaHashMap_GetValuePointerForKeyStringWithLength(the_shard->hashMap, key_string, key_string_length);
+	Internal_UnlockShard(the_shard);
+	return ret_val;
 }
 
-int LuaHashMap_GetValueTypeAtIterator(LuaHashMapIterator* hash_iterator)
+lua_Number LuaHashMapSharded_GetValueNumberForKeyString(LuaHashMapSharded* restrict sharded_hash_map, const char* restrict key_string)
 {
-	int ret_val;
-	LuaHashMap* hash_map;
-	if(NULL == hash_iterator)
+	struct LuaHashMapShard* the_shard;
+	lua_Number ret_val;
+	if(NULL == sharded_hash_map)
 	{
-		return LUA_TNONE;
+		return 0.0;
 	}
-	if(true == hash_iterator->atEnd)
+	the_shard = Internal_GetShardForKeyString(sharded_hash_map, key_string, (NULL == key_string) ? 0 : strlen(key_string));
+	Internal_LockShard(the_shard);
+	ret_val = LuaHashMap_GetValueNumberForKeyString(the_shard->hashMap, key_string);
+	Internal_UnlockShard(the_shard);
+	return ret_val;
+}
+
+lua_Number LuaHashMapSharded_GetValueNumberForKeyStringWithLength(LuaHashMapSharded* restrict sharded_hash_map, const char* restrict key_string, size_t key_string_length)
+{
+	struct LuaHashMapShard* the_shard;
+	lua_Number ret_val;
+	if(NULL == sharded_hash_map)
 	{
-		return LUA_TNONE;
+		return 0.0;
 	}
-	if(true == hash_iterator->isNext)
+	the_shard = Internal_GetShardForKeyString(sharded_hash_map, key_string, key_string_length);
+	Internal_LockShard(the_shard);
+	ret_val = LuaHashMap_GetValueNumberForKeyStringWithLength(the_shard->hashMap, key_string, key_string_length);
+	Internal_UnlockShard(the_shard);
+	return ret_val;
+}
+
+lua_Integer LuaHashMapSharded_GetValueIntegerForKeyString(LuaHashMapSharded* restrict sharded_hash_map, const char* restrict key_string)
+{
+	struct LuaHashMapShard* the_shard;
+	lua_Integer ret_val;
+	if(NULL == sharded_hash_map)
 	{
-		return LUA_TNONE;
+		return 0;
 	}
-	
-	hash_map = hash_iterator->hashMap;
-	if(NULL == hash_map)
+	the_shard = Internal_GetShardForKeyString(sharded_hash_map, key_string, (NULL == key_string) ? 0 : strlen(key_string));
+	Internal_LockShard(the_shard);
+	ret_val = LuaHashMap_GetValueIntegerForKeyString(the_shard->hashMap, key_string);
+	Internal_UnlockShard(the_shard);
+	return ret_val;
+}
+
+lua_Integer LuaHashMapSharded_GetValueIntegerForKeyStringWithLength(LuaHashMapSharded* restrict sharded_hash_map, const char* restrict key_string, size_t key_string_length)
+{
+	struct LuaHashMapShard* the_shard;
+	lua_Integer ret_val;
+	if(NULL == sharded_hash_map)
 	{
-		return LUA_TNONE;
+		return 0;
 	}
+	the_shard = Internal_GetShardForKeyString(sharded_hash_map, key_string, key_string_length);
+	Internal_LockShard(the_shard);
+	ret_val = LuaHashMap_GetValueIntegerForKeyStringWithLength(the_shard->hashMap, key_string, key_string_length);
+	Internal_UnlockShard(the_shard);
+	return ret_val;
+}
 
-	if(LUA_TSTRING == hash_iterator->keyType)
+size_t LuaHashMapSharded_CopyValueStringForKeyPointer(LuaHashMapSharded* restrict sharded_hash_map, void* key_pointer, char* restrict value_buffer, size_t value_buffer_size)
+{
+	struct LuaHashMapShard* the_shard;
+	const char* value_string;
+	size_t value_string_length = 0;
+	size_t ret_val;
+	if(NULL == sharded_hash_map)
 	{
-		LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
-		lua_pushlstring(hash_map->luaState, hash_iterator->currentKey.theString.stringPointer, hash_iterator->currentKey.theString.stringLength); /* stack: [key_string, table] */
-		LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_string]; stack: [value_string, table] */
+		return Internal_CopyShardValueString(NULL, 0, value_buffer, value_buffer_size);
 	}
-	else if(LUA_TLIGHTUSERDATA == hash_iterator->keyType)
+	the_shard = Internal_GetShardForKeyPointer(sharded_hash_map, key_pointer);
+	Internal_LockShard(the_shard);
+	value_string = LuaHashMap_GetValueStringForKeyPointerWithLength(the_shard->hashMap, key_pointer, &value_string_length);
+	/* Copy while we still hold the lock. Once it's released, another thread may remove the value and the string may be collected. */
+	ret_val = Internal_CopyShardValueString(value_string, value_string_length, value_buffer, value_buffer_size);
+	Internal_UnlockShard(the_shard);
+	return ret_val;
+}
+
+void* LuaHashMapSharded_GetValuePointerForKeyPointer(LuaHashMapSharded* sharded_hash_map, void* key_pointer)
+{
+	struct LuaHashMapShard* the_shard;
+	void* ret_val;
+	if(NULL == sharded_hash_map)
 	{
-		LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
-		lua_pushlightuserdata(hash_map->luaState, hash_iterator->currentKey.thePointer); /* stack: [key_string, table] */
-		LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_string]; stack: [value_string, table] */
+		return NULL;
 	}
-	else if(LUA_TNUMBER == hash_iterator->keyType)
+	the_shard = Internal_GetShardForKeyPointer(sharded_hash_map, key_pointer);
+	Internal_LockShard(the_shard);
+	ret_val = LuaHashMap_GetValuePointerForKeyPointer(the_shard->hashMap, key_pointer);
+	Internal_UnlockShard(the_shard);
+	return ret_val;
+}
+
+lua_Number LuaHashMapSharded_GetValueNumberForKeyPointer(LuaHashMapSharded* sharded_hash_map, void* key_pointer)
+{
+	struct LuaHashMapShard* the_shard;
+	lua_Number ret_val;
+	if(NULL == sharded_hash_map)
 	{
-		/* Warning: This might be a problem. I can't distinguish between a number and integer. */		
-		LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
-		lua_pushnumber(hash_map->luaState, hash_iterator->currentKey.theNumber); /* stack: [key_string, table] */
-		LUAHASHMAP_GETTABLE(hash_map->luaState, -2);  /* table[key_string]; stack: [value_string, table] */
+		return 0.0;
 	}
-	else
+	the_shard = Internal_GetShardForKeyPointer(sharded_hash_map, key_pointer);
+	Internal_LockShard(the_shard);
+	ret_val = LuaHashMap_GetValueNumberForKeyPointer(the_shard->hashMap, key_pointer);
+	Internal_UnlockShard(the_shard);
+	return ret_val;
+}
+
+lua_Integer LuaHashMapSharded_GetValueIntegerForKeyPointer(LuaHashMapSharded* sharded_hash_map, void* key_pointer)
+{
+	struct LuaHashMapShard* the_shard;
+	lua_Integer ret_val;
+	if(NULL == sharded_hash_map)
 	{
-		/* shouldn't get here */
-		LUAHASHMAP_ASSERT(false);
-		return LUA_TNONE;
+		return 0;
 	}
-	
-	ret_val = lua_type(hash_map->luaState, -1);
-	hash_iterator->valueType = ret_val;
-	/* Cache the value in the iterator */
-	if(LUA_TSTRING == hash_iterator->valueType)
+	the_shard = Internal_GetShardForKeyPointer(sharded_hash_map, key_pointer);
+	Internal_LockShard(the_shard);
+	ret_val = LuaHashMap_GetValueIntegerForKeyPointer(the_shard->hashMap, key_pointer);
+	Internal_UnlockShard(the_shard);
+	return ret_val;
+}
+
+size_t LuaHashMapSharded_CopyValueStringForKeyNumber(LuaHashMapSharded* restrict sharded_hash_map, lua_Number key_number, char* restrict value_buffer, size_t value_buffer_size)
+{
+	struct LuaHashMapShard* the_shard;
+	const char* value_string;
+	size_t value_string_length = 0;
+	size_t ret_val;
+	if(NULL == sharded_hash_map)
 	{
-		hash_iterator->currentValue.theString.stringPointer = lua_tolstring(hash_map->luaState, -1, &hash_iterator->currentValue.theString.stringLength);
+		return Internal_CopyShardValueString(NULL, 0, value_buffer, value_buffer_size);
 	}
-	else if(LUA_TLIGHTUSERDATA == hash_iterator->valueType)
+	the_shard = Internal_GetShardForKeyNumber(sharded_hash_map, key_number);
+	Internal_LockShard(the_shard);
+	value_string = LuaHashMap_GetValueStringForKeyNumberWithLength(the_shard->hashMap, key_number, &value_string_length);
+	/* Copy while we still hold the lock. Once it's released, another thread may remove the value and the string may be collected. */
+	ret_val = Internal_CopyShardValueString(value_string, value_string_length, value_buffer, value_buffer_size);
+	Internal_UnlockShard(the_shard);
+	return ret_val;
+}
+
+void* LuaHashMapSharded_GetValuePointerForKeyNumber(LuaHashMapSharded* sharded_hash_map, lua_Number key_number)
+{
+	struct LuaHashMapShard* the_shard;
+	void* ret_val;
+	if(NULL == sharded_hash_map)
 	{
-		hash_iterator->currentValue.thePointer = lua_touserdata(hash_map->luaState, -1);
+		return NULL;
 	}
-	else if(LUA_TNUMBER == hash_iterator->valueType)
+	the_shard = Internal_GetShardForKeyNumber(sharded_hash_map, key_number);
+	Internal_LockShard(the_shard);
+	ret_val = LuaHashMap_GetValuePointerForKeyNumber(the_shard->hashMap, key_number);
+	Internal_UnlockShard(the_shard);
+	return ret_val;
+}
+
+lua_Number LuaHashMapSharded_GetValueNumberForKeyNumber(LuaHashMapSharded* sharded_hash_map, lua_Number key_number)
+{
+	struct LuaHashMapShard* the_shard;
+	lua_Number ret_val;
+	if(NULL == sharded_hash_map)
 	{
-		hash_iterator->currentValue.theNumber = lua_tonumber(hash_map->luaState, -1);
+		return 0.0;
 	}
-	else
+	the_shard = Internal_GetShardForKeyNumber(sharded_hash_map, key_number);
+	Internal_LockShard(the_shard);
+	ret_val = LuaHashMap_GetValueNumberForKeyNumber(the_shard->hashMap, key_number);
+	Internal_UnlockShard(the_shard);
+	return ret_val;
+}
+
+lua_Integer LuaHashMapSharded_GetValueIntegerForKeyNumber(LuaHashMapSharded* sharded_hash_map, lua_Number key_number)
+{
+	struct LuaHashMapShard* the_shard;
+	lua_Integer ret_val;
+	if(NULL == sharded_hash_map)
 	{
-		/* shouldn't get here */
-		LUAHASHMAP_ASSERT(false);
-		return LUA_TNONE;
+		return 0;
 	}
-	
-	/* return value and table are still on top of stack. Don't forget to pop it now that we are done with it */
-	lua_pop(hash_map->luaState, 2);
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);	
+	the_shard = Internal_GetShardForKeyNumber(sharded_hash_map, key_number);
+	Internal_LockShard(the_shard);
+	ret_val = LuaHashMap_GetValueIntegerForKeyNumber(the_shard->hashMap, key_number);
+	Internal_UnlockShard(the_shard);
 	return ret_val;
 }
 
-/* Stuff for public inline functions */
-#if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 199901L)
-/* Using C99 inline. These need to be externed (but not redefined) here to force compilation unit/linkage requirements by C99. */
-
-extern const char* LuaHashMap_GetKeyStringAtIterator(const LuaHashMapIterator* hash_iterator);
-extern const char* LuaHashMap_GetKeyStringAtIteratorWithLength(const LuaHashMapIterator* restrict hash_iterator, size_t* restrict key_string_length_return);
-extern size_t LuaHashMap_GetKeyStringLengthAtIterator(const LuaHashMapIterator* hash_iterator);
-extern void* LuaHashMap_GetKeyPointerAtIterator(const LuaHashMapIterator* hash_iterator);
-extern lua_Number LuaHashMap_GetKeyNumberAtIterator(const LuaHashMapIterator* hash_iterator);
-extern lua_Integer LuaHashMap_GetKeyIntegerAtIterator(const LuaHashMapIterator* hash_iterator);
-
-extern int LuaHashMap_GetKeyTypeAtIterator(const LuaHashMapIterator* hash_iterator);
-
-extern int LuaHashMap_GetCachedValueTypeAtIterator(const LuaHashMapIterator* hash_iterator);
-
-extern const char* LuaHashMap_GetCachedValueStringAtIterator(const LuaHashMapIterator* hash_iterator);
-extern const char* LuaHashMap_GetCachedValueStringAtIteratorWithLength(const LuaHashMapIterator* restrict hash_iterator, size_t* restrict value_string_length_return);
-extern size_t LuaHashMap_GetCachedValueStringLengthAtIterator(const LuaHashMapIterator* hash_iterator);
-extern void* LuaHashMap_GetCachedValuePointerAtIterator(const LuaHashMapIterator* hash_iterator);
-extern lua_Number LuaHashMap_GetCachedValueNumberAtIterator(const LuaHashMapIterator* hash_iterator);
-extern lua_Integer LuaHashMap_GetCachedValueIntegerAtIterator(const LuaHashMapIterator* hash_iterator);
-
-#else /* We are not using C99 inline so the implementation must be here. */
+size_t LuaHashMapSharded_CopyValueStringForKeyInteger(LuaHashMapSharded* restrict sharded_hash_map, lua_Integer key_integer, char* restrict value_buffer, size_t value_buffer_size)
+{
+	struct LuaHashMapShard* the_shard;
+	const char* value_string;
+	size_t value_string_length = 0;
+	size_t ret_val;
+	if(NULL == sharded_hash_map)
+	{
+		return Internal_CopyShardValueString(NULL, 0, value_buffer, value_buffer_size);
+	}
+	the_shard = Internal_GetShardForKeyInteger(sharded_hash_map, key_integer);
+	Internal_LockShard(the_shard);
+	value_string = LuaHashMap_GetValueStringForKeyIntegerWithLength(the_shard->hashMap, key_integer, &value_string_length);
+	/* Copy while we still hold the lock. Once it's released, another thread may remove the value and the string may be collected. */
+	ret_val = Internal_CopyShardValueString(value_string, value_string_length, value_buffer, value_buffer_size);
+	Internal_UnlockShard(the_shard);
+	return ret_val;
+}
 
-int LuaHashMap_GetKeyTypeAtIterator(const LuaHashMapIterator* hash_iterator)
+void* LuaHashMapSharded_GetValuePointerForKeyInteger(LuaHashMapSharded* sharded_hash_map, lua_Integer key_integer)
 {
-	if(NULL == hash_iterator)
+	struct LuaHashMapShard* the_shard;
+	void* ret_val;
+	if(NULL == sharded_hash_map)
 	{
-		return LUA_TNONE;
+		return NULL;
 	}
-	return hash_iterator->keyType;
+	the_shard = Internal_GetShardForKeyInteger(sharded_hash_map, key_integer);
+	Internal_LockShard(the_shard);
+	ret_val = LuaHashMap_GetValuePointerForKeyInteger(the_shard->hashMap, key_integer);
+	Internal_UnlockShard(the_shard);
+	return ret_val;
 }
 
+lua_Number LuaHashMapSharded_GetValueNumberForKeyInteger(LuaHashMapSharded* sharded_hash_map, lua_Integer key_integer)
+{
+	struct LuaHashMapShard* the_shard;
+	lua_Number ret_val;
+	if(NULL == sharded_hash_map)
+	{
+		return 0.0;
+	}
+	the_shard = Internal_GetShardForKeyInteger(sharded_hash_map, key_integer);
+	Internal_LockShard(the_shard);
+	ret_val = LuaHashMap_GetValueNumberForKeyInteger(the_shard->hashMap, key_integer);
+	Internal_UnlockShard(the_shard);
+	return ret_val;
+}
 
-const char* LuaHashMap_GetKeyStringAtIterator(const LuaHashMapIterator* hash_iterator)
+lua_Integer LuaHashMapSharded_GetValueIntegerForKeyInteger(LuaHashMapSharded* sharded_hash_map, lua_Integer key_integer)
 {
-	if(NULL == hash_iterator)
+	struct LuaHashMapShard* the_shard;
+	lua_Integer ret_val;
+	if(NULL == sharded_hash_map)
 	{
-		return NULL;
+		return 0;
 	}
-	if(true == hash_iterator->atEnd)
+	the_shard = Internal_GetShardForKeyInteger(sharded_hash_map, key_integer);
+	Internal_LockShard(the_shard);
+	ret_val = LuaHashMap_GetValueIntegerForKeyInteger(the_shard->hashMap, key_integer);
+	Internal_UnlockShard(the_shard);
+	return ret_val;
+}
+
+bool LuaHashMapSharded_ExistsKeyString(LuaHashMapSharded* restrict sharded_hash_map, const char* restrict key_string)
+{
+	struct LuaHashMapShard* the_shard;
+	bool ret_val;
+	if(NULL == sharded_hash_map)
 	{
-		return NULL;
+		return false;
 	}
-	if(true == hash_iterator->isNext)
+	the_shard = Internal_GetShardForKeyString(sharded_hash_map, key_string, (NULL == key_string) ? 0 : strlen(key_string));
+	Internal_LockShard(the_shard);
+	ret_val = LuaHashMap_ExistsKeyString(the_shard->hashMap, key_string);
+	Internal_UnlockShard(the_shard);
+	return ret_val;
+}
+
+bool LuaHashMapSharded_ExistsKeyStringWithLength(LuaHashMapSharded* restrict sharded_hash_map, const char* restrict key_string, size_t key_string_length)
+{
+	struct LuaHashMapShard* the_shard;
+	bool ret_val;
+	if(NULL == sharded_hash_map)
 	{
-		return NULL;
+		return false;
 	}
-	if(LUA_TSTRING == hash_iterator->keyType)
+	the_shard = Internal_GetShardForKeyString(sharded_hash_map, key_string, key_string_length);
+	Internal_LockShard(the_shard);
+	ret_val = LuaHashMap_ExistsKeyStringWithLength(the_shard->hashMap, key_string, key_string_length);
+	Internal_UnlockShard(the_shard);
+	return ret_val;
+}
+
+bool LuaHashMapSharded_ExistsKeyPointer(LuaHashMapSharded* sharded_hash_map, void* key_pointer)
+{
+	struct LuaHashMapShard* the_shard;
+	bool ret_val;
+	if(NULL == sharded_hash_map)
 	{
-        return hash_iterator->currentKey.theString.stringPointer;
+		return false;
 	}
-	else
+	the_shard = Internal_GetShardForKeyPointer(sharded_hash_map, key_pointer);
+	Internal_LockShard(the_shard);
+	ret_val = LuaHashMap_ExistsKeyPointer(the_shard->hashMap, key_pointer);
+	Internal_UnlockShard(the_shard);
+	return ret_val;
+}
+
+bool LuaHashMapSharded_ExistsKeyNumber(LuaHashMapSharded* sharded_hash_map, lua_Number key_number)
+{
+	struct LuaHashMapShard* the_shard;
+	bool ret_val;
+	if(NULL == sharded_hash_map)
 	{
-		/* shouldn't get here */
-		LUAHASHMAP_ASSERT(false);
-		return NULL;
+		return false;
 	}
+	the_shard = Internal_GetShardForKeyNumber(sharded_hash_map, key_number);
+	Internal_LockShard(the_shard);
+	ret_val = LuaHashMap_ExistsKeyNumber(the_shard->hashMap, key_number);
+	Internal_UnlockShard(the_shard);
+	return ret_val;
 }
 
-const char* LuaHashMap_GetKeyStringAtIteratorWithLength(const LuaHashMapIterator* restrict hash_iterator, size_t* restrict key_string_length_return)
+bool LuaHashMapSharded_ExistsKeyInteger(LuaHashMapSharded* sharded_hash_map, lua_Integer key_integer)
 {
-	if(NULL == hash_iterator)
+	struct LuaHashMapShard* the_shard;
+	bool ret_val;
+	if(NULL == sharded_hash_map)
 	{
-		if(NULL != key_string_length_return)
-		{
-			*key_string_length_return = 0;
-		}
-		return NULL;
+		return false;
 	}
-	if(true == hash_iterator->atEnd)
+	the_shard = Internal_GetShardForKeyInteger(sharded_hash_map, key_integer);
+	Internal_LockShard(the_shard);
+	ret_val = LuaHashMap_ExistsKeyInteger(the_shard->hashMap, key_integer);
+	Internal_UnlockShard(the_shard);
+	return ret_val;
+}
+
+void LuaHashMapSharded_RemoveKeyString(LuaHashMapSharded* restrict sharded_hash_map, const char* restrict key_string)
+{
+	struct LuaHashMapShard* the_shard;
+	if(NULL == sharded_hash_map)
 	{
-		if(NULL != key_string_length_return)
-		{
-			*key_string_length_return = 0;
-		}
-		return NULL;
+		return;
 	}
-	if(true == hash_iterator->isNext)
+	the_shard = Internal_GetShardForKeyString(sharded_hash_map, key_string, (NULL == key_string) ? 0 : strlen(key_string));
+	Internal_LockShard(the_shard);
+	LuaHashMap_RemoveKeyString(the_shard->hashMap, key_string);
+	Internal_UnlockShard(the_shard);
+}
+
+void LuaHashMapSharded_RemoveKeyStringWithLength(LuaHashMapSharded* restrict sharded_hash_map, const char* restrict key_string, size_t key_string_length)
+{
+	struct LuaHashMapShard* the_shard;
+	if(NULL == sharded_hash_map)
 	{
-		if(NULL != key_string_length_return)
-		{
-			*key_string_length_return = 0;
-		}
-		return NULL;
+		return;
 	}
+	the_shard = Internal_GetShardForKeyString(sharded_hash_map, key_string, key_string_length);
+	Internal_LockShard(the_shard);
+	LuaHashMap_RemoveKeyStringWithLength(the_shard->hashMap, key_string, key_string_length);
+	Internal_UnlockShard(the_shard);
+}
 
-	if(NULL != key_string_length_return)
+void LuaHashMapSharded_RemoveKeyPointer(LuaHashMapSharded* sharded_hash_map, void* key_pointer)
+{
+	struct LuaHashMapShard* the_shard;
+	if(NULL == sharded_hash_map)
 	{
-		*key_string_length_return = hash_iterator->currentKey.theString.stringLength;
+		return;
 	}
+	the_shard = Internal_GetShardForKeyPointer(sharded_hash_map, key_pointer);
+	Internal_LockShard(the_shard);
+	LuaHashMap_RemoveKeyPointer(the_shard->hashMap, key_pointer);
+	Internal_UnlockShard(the_shard);
+}
 
-	if(LUA_TSTRING == hash_iterator->keyType)
+void LuaHashMapSharded_RemoveKeyNumber(LuaHashMapSharded* sharded_hash_map, lua_Number key_number)
+{
+	struct LuaHashMapShard* the_shard;
+	if(NULL == sharded_hash_map)
 	{
-        return hash_iterator->currentKey.theString.stringPointer;
+		return;
 	}
-	else
+	the_shard = Internal_GetShardForKeyNumber(sharded_hash_map, key_number);
+	Internal_LockShard(the_shard);
+	LuaHashMap_RemoveKeyNumber(the_shard->hashMap, key_number);
+	Internal_UnlockShard(the_shard);
+}
+
+void LuaHashMapSharded_RemoveKeyInteger(LuaHashMapSharded* sharded_hash_map, lua_Integer key_integer)
+{
+	struct LuaHashMapShard* the_shard;
+	if(NULL == sharded_hash_map)
 	{
-		/* shouldn't get here */
-		LUAHASHMAP_ASSERT(false);
-		return NULL;
+		return;
 	}
+	the_shard = Internal_GetShardForKeyInteger(sharded_hash_map, key_integer);
+	Internal_LockShard(the_shard);
+	LuaHashMap_RemoveKeyInteger(the_shard->hashMap, key_integer);
+	Internal_UnlockShard(the_shard);
 }
 
-size_t LuaHashMap_GetKeyStringLengthAtIterator(const LuaHashMapIterator* hash_iterator)
+
+bool LuaHashMap_EnableGroupLocking(LuaHashMap* hash_map, size_t number_of_reader_states)
 {
-	if(NULL == hash_iterator)
+	struct LuaHashMapGroupLock* group_lock;
+	size_t i;
+	if((NULL == hash_map) || (NULL == hash_map->groupLock))
 	{
-		return 0;
+		return false;
 	}
-	if(true == hash_iterator->atEnd)
+	/* Any hash map in the group can install it, since they all share the one lock (see Internal_JoinGroup). */
+	group_lock = hash_map->groupLock;
+	if(true == group_lock->isEnabled)
 	{
-		return 0;
+		return true;
 	}
-	if(true == hash_iterator->isNext)
+	/* Access sessions (of any hash map in the group) are still pinning tables on the stack. */
+	if(0 != lua_gettop(hash_map->luaState))
 	{
-		return 0;
+		return false;
 	}
-	
-	if(LUA_TSTRING == hash_iterator->keyType)
+#if LUA_VERSION_NUM >= 504
+	/* Readers would be exclusive anyway (see Internal_BeginSharedAccess). */
+	number_of_reader_states = 0;
+#endif
+	if(number_of_reader_states > 0)
 	{
-        return hash_iterator->currentKey.theString.stringLength;
+		group_lock->readerStatesArray = (lua_State**)calloc(number_of_reader_states, sizeof(lua_State*));
+		if(NULL == group_lock->readerStatesArray)
+		{
+			return false;
+		}
 	}
-	else
+
+	/* Keep the reader threads alive by parking them in a registry table. */
+	lua_createtable(hash_map->luaState, (int)number_of_reader_states, 0); /* stack: [reader_states] */
+	for(i=0; i<number_of_reader_states; i++)
 	{
-		/* shouldn't get here */
-		LUAHASHMAP_ASSERT(false);
-		return 0;
+		group_lock->readerStatesArray[i] = lua_newthread(hash_map->luaState); /* stack: [thread, reader_states] */
+		lua_rawseti(hash_map->luaState, -2, (int)(i+1)); /* stack: [reader_states] */
 	}
+	lua_setfield(hash_map->luaState, LUA_REGISTRYINDEX, LUAHASHMAP_GROUP_LOCK_READER_STATES_KEY); /* stack: [] */
+	group_lock->numberOfFreeReaderStates = number_of_reader_states;
+
+	LUAHASHMAP_RWLOCK_INIT(&group_lock->readWriteLock);
+	LUAHASHMAP_MUTEX_INIT(&group_lock->readerPoolLock);
+	group_lock->isEnabled = true;
+
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return true;
 }
 
-void* LuaHashMap_GetKeyPointerAtIterator(const LuaHashMapIterator* hash_iterator)
+bool LuaHashMap_GetLockStatistics(LuaHashMap* hash_map, LuaHashMapLockStatistics* statistics_return)
 {
-	if(NULL == hash_iterator)
+	struct LuaHashMapGroupLock* group_lock = Internal_GetEnabledGroupLock(hash_map);
+	if((NULL == group_lock) || (NULL == statistics_return))
 	{
-		return NULL;
+		return false;
 	}
-	if(true == hash_iterator->atEnd)
+	/* No reader can be touching the counters while we hold it exclusively. Don't count ourselves. */
+	LUAHASHMAP_RWLOCK_LOCK_EXCLUSIVE(&group_lock->readWriteLock);
+	*statistics_return = group_lock->lockStatistics;
+	LUAHASHMAP_RWLOCK_UNLOCK_EXCLUSIVE(&group_lock->readWriteLock);
+	return true;
+}
+
+
+
+static void Internal_ExecuteActorRequest(LuaHashMap* hash_map, LuaHashMapActorRequest* actor_request)
+{
+	int key_type = actor_request->theKey.valueType;
+	if((LUA_TSTRING != key_type) && (LUA_TLIGHTUSERDATA != key_type) && (LUA_TNUMBER != key_type))
 	{
-		return NULL;
+		/* Not a key type we support. (nil would be a Lua error.) */
+		actor_request->wasFound = false;
+		if(LUAHASHMAP_ACTOR_GET == actor_request->theOperation)
+		{
+			memset(&actor_request->theValue, 0, sizeof(LuaHashMapValue));
+			actor_request->theValue.valueType = LUA_TNIL;
+		}
+		return;
 	}
-	if(true == hash_iterator->isNext)
+
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	Internal_PushEvalValue(hash_map, &actor_request->theKey); /* stack: [key, table] */
+	switch(actor_request->theOperation)
 	{
-		return NULL;
+		case LUAHASHMAP_ACTOR_GET:
+		case LUAHASHMAP_ACTOR_EXISTS:
+		{
+			LUAHASHMAP_GETTABLE(hash_map->luaState, -2); /* table[key]; stack: [value, table] */
+			actor_request->wasFound = (LUA_TNIL != lua_type(hash_map->luaState, -1));
+			if(LUAHASHMAP_ACTOR_GET == actor_request->theOperation)
+			{
+				Internal_ToEvalValue(hash_map, -1, &actor_request->theValue);
+				/* A polled request is read on another thread after we pop the value, when nothing keeps the string alive. Copy it out. */
+				if((LUA_TSTRING == actor_request->theValue.valueType) && (NULL == actor_request->completionFunction))
+				{
+					size_t string_length = actor_request->theValue.theValue.theString.stringLength;
+					if((NULL != actor_request->stringBuffer) && (string_length < actor_request->stringBufferSize))
+					{
+						memcpy(actor_request->stringBuffer, actor_request->theValue.theValue.theString.stringPointer, string_length);
+						actor_request->stringBuffer[string_length] = '\0';
+						actor_request->theValue.theValue.theString.stringPointer = actor_request->stringBuffer;
+					}
+					else
+					{
+						actor_request->theValue.theValue.theString.stringPointer = NULL;
+					}
+				}
+			}
+			lua_pop(hash_map->luaState, 2);
+			break;
+		}
+		case LUAHASHMAP_ACTOR_SET:
+		{
+			Internal_PushEvalValue(hash_map, &actor_request->theValue); /* stack: [value, key, table] */
+			Internal_SetTableAndUpdateCount(hash_map); /* table[key]=value; stack: [table] */
+			lua_pop(hash_map->luaState, 1);
+			break;
+		}
+		case LUAHASHMAP_ACTOR_REMOVE:
+		{
+			lua_pushnil(hash_map->luaState); /* stack: [nil, key, table] */
+			Internal_SetTableAndUpdateCount(hash_map); /* table[key]=nil; stack: [table] */
+			lua_pop(hash_map->luaState, 1);
+			break;
+		}
+		default:
+		{
+			lua_pop(hash_map->luaState, 2);
+			break;
+		}
 	}
-	
-	if(LUA_TLIGHTUSERDATA == hash_iterator->keyType)
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+}
+
+LuaHashMapActor* LuaHashMapActor_Create(LuaHashMap* hash_map)
+{
+	LuaHashMapActor* hash_actor;
+	if(NULL == hash_map)
 	{
-        return hash_iterator->currentKey.thePointer;
+		return NULL;
 	}
-	else
+	hash_actor = (LuaHashMapActor*)calloc(1, sizeof(LuaHashMapActor));
+	if(NULL == hash_actor)
 	{
-		/* shouldn't get here */
-		LUAHASHMAP_ASSERT(false);
 		return NULL;
 	}
+	hash_actor->hashMap = hash_map;
+	LUAHASHMAP_MUTEX_INIT(&hash_actor->wakeLock);
+	LUAHASHMAP_CONDITION_INIT(&hash_actor->wakeCondition);
+	return hash_actor;
 }
 
-lua_Number LuaHashMap_GetKeyNumberAtIterator(const LuaHashMapIterator* hash_iterator)
+void LuaHashMapActor_Free(LuaHashMapActor* hash_actor)
 {
-	if(NULL == hash_iterator)
+	if(NULL == hash_actor)
 	{
-		return 0.0;
+		return;
 	}
-	if(true == hash_iterator->atEnd)
+	LuaHashMapActor_Drain(hash_actor);
+	LUAHASHMAP_CONDITION_DESTROY(&hash_actor->wakeCondition);
+	LUAHASHMAP_MUTEX_DESTROY(&hash_actor->wakeLock);
+	free(hash_actor);
+}
+
+LuaHashMap* LuaHashMapActor_GetHashMap(LuaHashMapActor* hash_actor)
+{
+	if(NULL == hash_actor)
 	{
-		return 0.0;
+		return NULL;
 	}
-	if(true == hash_iterator->isNext)
+	return hash_actor->hashMap;
+}
+
+bool LuaHashMapActor_Submit(LuaHashMapActor* restrict hash_actor, LuaHashMapActorRequest* restrict actor_request)
+{
+	return LuaHashMapActor_SubmitBatch(hash_actor, actor_request, 1);
+}
+
+bool LuaHashMapActor_SubmitBatch(LuaHashMapActor* restrict hash_actor, LuaHashMapActorRequest* restrict actor_requests, size_t number_of_requests)
+{
+	void* old_head;
+	size_t i;
+	if((NULL == hash_actor) || (NULL == actor_requests) || (0 == number_of_requests))
 	{
-		return 0.0;
+		return false;
 	}
-	
-	if(LUA_TNUMBER == hash_iterator->keyType)
+	/* The queue is newest first, so chain the array backwards. Drain reverses it back into array order. */
+	for(i=0; i<number_of_requests; i++)
 	{
-        return hash_iterator->currentKey.theNumber;
+		actor_requests[i].isComplete = 0;
+		if(i > 0)
+		{
+			actor_requests[i].nextRequest = &actor_requests[i-1];
+		}
 	}
-	else
+	do
+	{
+		old_head = Internal_AtomicLoadPointer(&hash_actor->pendingRequests);
+		actor_requests[0].nextRequest = (LuaHashMapActorRequest*)old_head;
+	} while(!Internal_AtomicCompareAndSwapPointer(&hash_actor->pendingRequests, old_head, &actor_requests[number_of_requests-1]));
+
+	/* Only the submission that makes the queue non-empty needs to wake the owner. 
+	 * Signaling under the lock means an owner that just found the queue empty can't miss it.
+	 */
+	if(NULL == old_head)
 	{
-		/* shouldn't get here */
-		LUAHASHMAP_ASSERT(false);
-		return 0.0;
+		LUAHASHMAP_MUTEX_LOCK(&hash_actor->wakeLock);
+		LUAHASHMAP_CONDITION_SIGNAL(&hash_actor->wakeCondition);
+		LUAHASHMAP_MUTEX_UNLOCK(&hash_actor->wakeLock);
 	}
+	return true;
 }
 
-
-lua_Integer LuaHashMap_GetKeyIntegerAtIterator(const LuaHashMapIterator* hash_iterator)
+bool LuaHashMapActor_IsRequestComplete(const LuaHashMapActorRequest* actor_request)
 {
-	if(NULL == hash_iterator)
+	if(NULL == actor_request)
 	{
-		return 0;
+		return false;
 	}
-	if(true == hash_iterator->atEnd)
+	return 0 != Internal_AtomicLoadLong((volatile long*)&actor_request->isComplete);
+}
+
+size_t LuaHashMapActor_Drain(LuaHashMapActor* hash_actor)
+{
+	LuaHashMapActorRequest* request_list;
+	LuaHashMapActorRequest* batch_list = NULL;
+	LuaHashMapActorRequest* next_request;
+	struct LuaHashMapGroupLock* group_lock;
+	size_t number_of_requests = 0;
+	if(NULL == hash_actor)
 	{
 		return 0;
 	}
-	if(true == hash_iterator->isNext)
+	request_list = (LuaHashMapActorRequest*)Internal_AtomicExchangePointer(&hash_actor->pendingRequests, NULL);
+	if(NULL == request_list)
 	{
 		return 0;
 	}
-	
-	if(LUA_TNUMBER == hash_iterator->keyType)
+	/* The queue is newest first. Reverse it so requests run in submission order. */
+	while(NULL != request_list)
 	{
-        return (lua_Integer)hash_iterator->currentKey.theNumber;
+		next_request = request_list->nextRequest;
+		request_list->nextRequest = batch_list;
+		batch_list = request_list;
+		request_list = next_request;
 	}
-	else
+
+	group_lock = Internal_LockGroupExclusive(hash_actor->hashMap);
+	Internal_Unlocked_BeginAccess(hash_actor->hashMap);
+	while(NULL != batch_list)
 	{
-		/* shouldn't get here */
-		LUAHASHMAP_ASSERT(false);
-		return 0;
+		LuaHashMapActor_CompletionFunction completion_function = batch_list->completionFunction;
+		/* Grab everything we need first. Once the request is complete, the submitter may free it. */
+		next_request = batch_list->nextRequest;
+		Internal_ExecuteActorRequest(hash_actor->hashMap, batch_list);
+		if(NULL != completion_function)
+		{
+			completion_function(batch_list, batch_list->userData);
+		}
+		else
+		{
+			Internal_AtomicStoreLong(&batch_list->isComplete, 1);
+		}
+		number_of_requests++;
+		batch_list = next_request;
 	}
+	Internal_Unlocked_EndAccess(hash_actor->hashMap);
+	Internal_UnlockGroupExclusive(group_lock);
+	return number_of_requests;
 }
 
-
-int LuaHashMap_GetCachedValueTypeAtIterator(const LuaHashMapIterator* hash_iterator)
+bool LuaHashMapActor_WaitForRequests(LuaHashMapActor* hash_actor)
 {
-	if(NULL == hash_iterator)
+	bool is_stop_requested;
+	if(NULL == hash_actor)
 	{
-		return LUA_TNONE;
+		return false;
 	}
-	if(true == hash_iterator->atEnd)
+	LUAHASHMAP_MUTEX_LOCK(&hash_actor->wakeLock);
+	while((NULL == Internal_AtomicLoadPointer(&hash_actor->pendingRequests)) && (false == hash_actor->isStopRequested))
 	{
-		return LUA_TNONE;
+		LUAHASHMAP_CONDITION_WAIT(&hash_actor->wakeCondition, &hash_actor->wakeLock);
 	}
-	if(true == hash_iterator->isNext)
+	is_stop_requested = hash_actor->isStopRequested;
+	/* The stop is consumed so the owner can start over later. */
+	hash_actor->isStopRequested = false;
+	LUAHASHMAP_MUTEX_UNLOCK(&hash_actor->wakeLock);
+	return !is_stop_requested;
+}
+
+void LuaHashMapActor_Run(LuaHashMapActor* hash_actor)
+{
+	if(NULL == hash_actor)
 	{
-		return LUA_TNONE;
+		return;
 	}
-	
-	return hash_iterator->valueType;
+	do
+	{
+		LuaHashMapActor_Drain(hash_actor);
+	} while(LuaHashMapActor_WaitForRequests(hash_actor));
+	/* Anything submitted before the stop still gets done. */
+	LuaHashMapActor_Drain(hash_actor);
 }
 
-const char* LuaHashMap_GetCachedValueStringAtIterator(const LuaHashMapIterator* hash_iterator)
+void LuaHashMapActor_Stop(LuaHashMapActor* hash_actor)
 {
-	if(NULL == hash_iterator)
+	if(NULL == hash_actor)
 	{
-		return NULL;
+		return;
 	}
-	if(true == hash_iterator->atEnd)
+	LUAHASHMAP_MUTEX_LOCK(&hash_actor->wakeLock);
+	hash_actor->isStopRequested = true;
+	LUAHASHMAP_CONDITION_SIGNAL(&hash_actor->wakeCondition);
+	LUAHASHMAP_MUTEX_UNLOCK(&hash_actor->wakeLock);
+}
+
+
+/* Puts a key in the one form a snapshot stores and compares keys in, so keys Lua considers equal compare equal here:
+ * integers that are exact as a lua_Number become numbers (1 and 1.0 are the same key) and -0.0 becomes 0.0.
+ * In exact integer mode, light userdata becomes the integer it encodes, the same as Internal_ToKeyValueType does.
+ * (Integers beyond 2^53 only match a key of the same subtype.)
+ * Returns false for key types a snapshot doesn't hold.
+ */
+static bool Internal_CanonicalizeSnapshotKey(bool use_exact_integers, LuaHashMapValue* the_key)
+{
+#if LUA_VERSION_NUM < 503
+	if((true == use_exact_integers) && (LUA_TLIGHTUSERDATA == the_key->valueType))
 	{
-		return NULL;
+		the_key->theValue.theInteger = (lua_Integer)(ptrdiff_t)the_key->theValue.thePointer;
+		the_key->valueType = LUA_TNUMBER;
+		the_key->isInteger = true;
 	}
-	if(true == hash_iterator->isNext)
+#else
+	(void)use_exact_integers;
+#endif
+	switch(the_key->valueType)
 	{
-		return NULL;
+		case LUA_TNUMBER:
+		{
+			if(true == the_key->isInteger)
+			{
+				lua_Number the_number = (lua_Number)the_key->theValue.theInteger;
+				if((the_number < 9007199254740992.0) && (the_number > -9007199254740992.0))
+				{
+					the_key->theValue.theNumber = the_number;
+					the_key->isInteger = false;
+				}
+			}
+			if((false == the_key->isInteger) && (0 == the_key->theValue.theNumber))
+			{
+				the_key->theValue.theNumber = 0;
+			}
+			return true;
+		}
+		case LUA_TSTRING:
+		case LUA_TLIGHTUSERDATA:
+		{
+			the_key->isInteger = false;
+			return true;
+		}
+		case LUA_TBOOLEAN:
+		{
+			the_key->theValue.theInteger = (0 != the_key->theValue.theInteger);
+			the_key->isInteger = true;
+			return true;
+		}
+		default:
+		{
+			return false;
+		}
 	}
-	if(LUA_TSTRING != hash_iterator->valueType)
+}
+
+/* FNV-1a */
+static size_t Internal_HashSnapshotBytes(size_t the_hash, const void* the_bytes, size_t number_of_bytes)
+{
+	const unsigned char* bytes_pointer = (const unsigned char*)the_bytes;
+	size_t i;
+	for(i=0; i<number_of_bytes; i++)
 	{
-		return NULL;
+		the_hash ^= bytes_pointer[i];
+		the_hash *= (size_t)16777619UL;
 	}
-	return hash_iterator->currentValue.theString.stringPointer;
+	return the_hash;
 }
 
-const char* LuaHashMap_GetCachedValueStringAtIteratorWithLength(const LuaHashMapIterator* restrict hash_iterator, size_t* restrict value_string_length_return)
+/* Expects a key from Internal_CanonicalizeSnapshotKey. */
+static size_t Internal_HashSnapshotKey(const LuaHashMapValue* the_key)
 {
-	if(NULL == hash_iterator)
+	size_t the_hash = (size_t)2166136261UL ^ (size_t)the_key->valueType;
+	switch(the_key->valueType)
 	{
-		if(NULL != value_string_length_return)
+		case LUA_TSTRING:
 		{
-			*value_string_length_return = 0;
+			return Internal_HashSnapshotBytes(the_hash, the_key->theValue.theString.stringPointer, the_key->theValue.theString.stringLength);
 		}
-		return NULL;
-	}
-	if(true == hash_iterator->atEnd)
-	{
-		if(NULL != value_string_length_return)
+		case LUA_TNUMBER:
 		{
-			*value_string_length_return = 0;
+			if(true == the_key->isInteger)
+			{
+				return Internal_HashSnapshotBytes(the_hash, &the_key->theValue.theInteger, sizeof(lua_Integer));
+			}
+			return Internal_HashSnapshotBytes(the_hash, &the_key->theValue.theNumber, sizeof(lua_Number));
+		}
+		case LUA_TLIGHTUSERDATA:
+		{
+			return Internal_HashSnapshotBytes(the_hash, &the_key->theValue.thePointer, sizeof(void*));
+		}
+		default:
+		{
+			return Internal_HashSnapshotBytes(the_hash, &the_key->theValue.theInteger, sizeof(lua_Integer));
 		}
-		return NULL;
 	}
-	if(true == hash_iterator->isNext)
+}
+
+/* Expects keys from Internal_CanonicalizeSnapshotKey. */
+static bool Internal_IsSameSnapshotKey(const LuaHashMapValue* key1, const LuaHashMapValue* key2)
+{
+	if((key1->valueType != key2->valueType) || (key1->isInteger != key2->isInteger))
 	{
-		if(NULL != value_string_length_return)
+		return false;
+	}
+	switch(key1->valueType)
+	{
+		case LUA_TSTRING:
 		{
-			*value_string_length_return = 0;
+			return (key1->theValue.theString.stringLength == key2->theValue.theString.stringLength)
+				&& (0 == memcmp(key1->theValue.theString.stringPointer, key2->theValue.theString.stringPointer, key1->theValue.theString.stringLength));
+		}
+		case LUA_TNUMBER:
+		{
+			if(true == key1->isInteger)
+			{
+				return key1->theValue.theInteger == key2->theValue.theInteger;
+			}
+			return key1->theValue.theNumber == key2->theValue.theNumber;
+		}
+		case LUA_TLIGHTUSERDATA:
+		{
+			return key1->theValue.thePointer == key2->theValue.thePointer;
+		}
+		default:
+		{
+			return key1->theValue.theInteger == key2->theValue.theInteger;
 		}
-		return NULL;
 	}
-	if(LUA_TSTRING != hash_iterator->valueType)
+}
+
+/* Linear probing. Returns the bucket holding the key or the empty bucket where it would go. There is always an empty bucket. */
+static struct LuaHashMapSnapshotEntry* Internal_FindSnapshotBucket(const struct LuaHashMapSnapshot* hash_snapshot, const LuaHashMapValue* the_key, size_t key_hash)
+{
+	size_t bucket_index = key_hash & hash_snapshot->bucketMask;
+	for(;;)
 	{
-		if(NULL != value_string_length_return)
+		struct LuaHashMapSnapshotEntry* the_entry = &hash_snapshot->bucketsArray[bucket_index];
+		if(LUA_TNIL == the_entry->theKey.valueType)
 		{
-			*value_string_length_return = 0;
+			return the_entry;
 		}
-		return NULL;
+		if((key_hash == the_entry->keyHash) && Internal_IsSameSnapshotKey(&the_entry->theKey, the_key))
+		{
+			return the_entry;
+		}
+		bucket_index = (bucket_index + 1) & hash_snapshot->bucketMask;
 	}
+}
 
-	if(NULL != value_string_length_return)
+/* Copies a string key or value into the snapshot's string storage and points the_value at the copy. */
+static char* Internal_CopySnapshotString(LuaHashMapValue* the_value, char* string_storage)
+{
+	if(LUA_TSTRING == the_value->valueType)
 	{
-		*value_string_length_return = hash_iterator->currentKey.theString.stringLength;
+		memcpy(string_storage, the_value->theValue.theString.stringPointer, the_value->theValue.theString.stringLength);
+		string_storage[the_value->theValue.theString.stringLength] = '\0';
+		the_value->theValue.theString.stringPointer = string_storage;
+		string_storage += the_value->theValue.theString.stringLength + 1;
 	}
-
-	return hash_iterator->currentValue.theString.stringPointer;
+	return string_storage;
 }
 
-size_t LuaHashMap_GetCachedValueStringLengthAtIterator(const LuaHashMapIterator* hash_iterator)
+/* Walks the table twice: once to size the allocation and once to fill it. */
+static struct LuaHashMapSnapshot* Internal_CreateSnapshot(LuaHashMap* hash_map)
 {
-	if(NULL == hash_iterator)
+	struct LuaHashMapSnapshot* hash_snapshot = NULL;
+	LuaHashMapValue the_key;
+	LuaHashMapValue the_value;
+	size_t number_of_entries = 0;
+	size_t number_of_buckets = 8;
+	size_t string_storage_size = 0;
+	size_t buckets_offset;
+	char* string_storage;
+
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	lua_pushnil(hash_map->luaState); /* stack: [nil, table] */
+	while(lua_next(hash_map->luaState, -2) != 0) /* stack: [value, key, table] */
 	{
-		return 0;
+		Internal_ToEvalValue(hash_map, -2, &the_key);
+		if(true == Internal_CanonicalizeSnapshotKey(hash_map->useExactIntegers, &the_key))
+		{
+			Internal_ToEvalValue(hash_map, -1, &the_value);
+			number_of_entries++;
+			if(LUA_TSTRING == the_key.valueType)
+			{
+				string_storage_size += the_key.theValue.theString.stringLength + 1;
+			}
+			if(LUA_TSTRING == the_value.valueType)
+			{
+				string_storage_size += the_value.theValue.theString.stringLength + 1;
+			}
+		}
+		lua_pop(hash_map->luaState, 1); /* stack: [key, table] */
 	}
-	if(true == hash_iterator->atEnd)
+	/* stack: [table] */
+
+	while(number_of_buckets < 2*number_of_entries)
 	{
-		return 0;
+		number_of_buckets *= 2;
 	}
-	if(true == hash_iterator->isNext)
+	/* Round the header up to a whole number of entries so the buckets are aligned. */
+	buckets_offset = ((sizeof(struct LuaHashMapSnapshot) + sizeof(struct LuaHashMapSnapshotEntry) - 1) / sizeof(struct LuaHashMapSnapshotEntry)) * sizeof(struct LuaHashMapSnapshotEntry);
+	if(number_of_buckets <= ((size_t)-1 - buckets_offset - string_storage_size) / sizeof(struct LuaHashMapSnapshotEntry))
 	{
-		return 0;
+		hash_snapshot = (struct LuaHashMapSnapshot*)calloc(1, buckets_offset + number_of_buckets*sizeof(struct LuaHashMapSnapshotEntry) + string_storage_size);
 	}
-	if(LUA_TSTRING != hash_iterator->valueType)
+	if(NULL == hash_snapshot)
 	{
-		return 0;
+		lua_pop(hash_map->luaState, 1);
+		LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+		return NULL;
+	}
+	/* The reference is the hash map's, dropped when the snapshot is replaced. */
+	hash_snapshot->referenceCount = 1;
+	hash_snapshot->bucketMask = number_of_buckets - 1;
+	hash_snapshot->bucketsArray = (struct LuaHashMapSnapshotEntry*)((char*)hash_snapshot + buckets_offset);
+	hash_snapshot->useExactIntegers = hash_map->useExactIntegers;
+	string_storage = (char*)hash_snapshot->bucketsArray + number_of_buckets*sizeof(struct LuaHashMapSnapshotEntry);
+
+	lua_pushnil(hash_map->luaState); /* stack: [nil, table] */
+	while(lua_next(hash_map->luaState, -2) != 0) /* stack: [value, key, table] */
+	{
+		Internal_ToEvalValue(hash_map, -2, &the_key);
+		if(true == Internal_CanonicalizeSnapshotKey(hash_map->useExactIntegers, &the_key))
+		{
+			size_t key_hash = Internal_HashSnapshotKey(&the_key);
+			struct LuaHashMapSnapshotEntry* the_entry = Internal_FindSnapshotBucket(hash_snapshot, &the_key, key_hash);
+			/* Only a key that canonicalizes the same as another (which Lua itself wouldn't allow) finds a used bucket. */
+			if(LUA_TNIL == the_entry->theKey.valueType)
+			{
+				Internal_ToEvalValue(hash_map, -1, &the_value);
+				string_storage = Internal_CopySnapshotString(&the_key, string_storage);
+				string_storage = Internal_CopySnapshotString(&the_value, string_storage);
+				the_entry->keyHash = key_hash;
+				the_entry->theKey = the_key;
+				the_entry->theValue = the_value;
+				hash_snapshot->numberOfEntries++;
+			}
+		}
+		lua_pop(hash_map->luaState, 1); /* stack: [key, table] */
 	}
-	return hash_iterator->currentValue.theString.stringLength;
-}
 
+	lua_pop(hash_map->luaState, 1); /* stack: [] */
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);
+	return hash_snapshot;
+}
 
-void* LuaHashMap_GetCachedValuePointerAtIterator(const LuaHashMapIterator* hash_iterator)
+static bool Internal_Unlocked_PublishSnapshot(LuaHashMap* hash_map)
 {
-	if(NULL == hash_iterator)
+	struct LuaHashMapSnapshot* hash_snapshot;
+	if(NULL == hash_map)
 	{
-		return NULL;
+		return false;
 	}
-	if(true == hash_iterator->atEnd)
+	hash_snapshot = Internal_CreateSnapshot(hash_map);
+	if(NULL == hash_snapshot)
 	{
-		return NULL;
+		return false;
 	}
-	if(true == hash_iterator->isNext)
+	Internal_ReplacePublishedSnapshot(hash_map, hash_snapshot);
+	return true;
+}
+
+LuaHashMapSnapshot* LuaHashMap_AcquireSnapshot(LuaHashMap* hash_map)
+{
+	struct LuaHashMapSnapshot* hash_snapshot;
+	volatile long* reader_count;
+	long the_epoch;
+	if(NULL == hash_map)
 	{
 		return NULL;
 	}
-	if(LUA_TLIGHTUSERDATA != hash_iterator->valueType)
+	for(;;)
 	{
-		return NULL;
+		the_epoch = Internal_AtomicLoadLong(&hash_map->snapshotEpoch);
+		reader_count = &hash_map->snapshotReaderCounts[the_epoch & 1];
+		Internal_AtomicAddLong(reader_count, 1);
+		if(the_epoch == Internal_AtomicLoadLong(&hash_map->snapshotEpoch))
+		{
+			break;
+		}
+		/* A publish moved to the next epoch in between, and may already be waiting on the count we just bumped. Try again in the new epoch. */
+		Internal_AtomicAddLong(reader_count, -1);
 	}
-	return hash_iterator->currentValue.thePointer;
+	hash_snapshot = (struct LuaHashMapSnapshot*)Internal_AtomicLoadPointer(&hash_map->publishedSnapshot);
+	if(NULL != hash_snapshot)
+	{
+		Internal_AtomicAddLong(&hash_snapshot->referenceCount, 1);
+	}
+	Internal_AtomicAddLong(reader_count, -1);
+	return hash_snapshot;
 }
 
-lua_Number LuaHashMap_GetCachedValueNumberAtIterator(const LuaHashMapIterator* hash_iterator)
+void LuaHashMapSnapshot_Release(LuaHashMapSnapshot* hash_snapshot)
 {
-	if(NULL == hash_iterator)
+	if(NULL == hash_snapshot)
 	{
-		return 0.0;
+		return;
 	}
-	if(true == hash_iterator->atEnd)
+	Internal_ReleaseSnapshot(hash_snapshot);
+}
+
+size_t LuaHashMapSnapshot_Count(const LuaHashMapSnapshot* hash_snapshot)
+{
+	if(NULL == hash_snapshot)
 	{
-		return 0.0;
+		return 0;
 	}
-	if(true == hash_iterator->isNext)
+	return hash_snapshot->numberOfEntries;
+}
+
+bool LuaHashMapSnapshot_GetValueForKey(const LuaHashMapSnapshot* restrict hash_snapshot, const LuaHashMapValue* restrict the_key, LuaHashMapValue* restrict value_return)
+{
+	LuaHashMapValue canonical_key;
+	const struct LuaHashMapSnapshotEntry* the_entry;
+	if((NULL == hash_snapshot) || (NULL == the_key))
 	{
-		return 0.0;
+		return false;
 	}
-	if(LUA_TNUMBER != hash_iterator->valueType)
+	canonical_key = *the_key;
+	if((LUA_TSTRING == canonical_key.valueType) && (NULL == canonical_key.theValue.theString.stringPointer))
 	{
-		return 0.0;
+		return false;
 	}
-	return hash_iterator->currentValue.theNumber;
-}
-
-lua_Integer LuaHashMap_GetCachedValueIntegerAtIterator(const LuaHashMapIterator* hash_iterator)
-{
-	if(NULL == hash_iterator)
+	if(false == Internal_CanonicalizeSnapshotKey(hash_snapshot->useExactIntegers, &canonical_key))
 	{
-		return 0;
+		return false;
 	}
-	if(true == hash_iterator->atEnd)
+	the_entry = Internal_FindSnapshotBucket(hash_snapshot, &canonical_key, Internal_HashSnapshotKey(&canonical_key));
+	if(LUA_TNIL == the_entry->theKey.valueType)
 	{
-		return 0;
+		return false;
 	}
-	if(true == hash_iterator->isNext)
+	if(NULL != value_return)
 	{
-		return 0;
+		*value_return = the_entry->theValue;
 	}
-	if(LUA_TNUMBER != hash_iterator->valueType)
+	return true;
+}
+
+bool LuaHashMapSnapshot_GetValueForKeyString(const LuaHashMapSnapshot* restrict hash_snapshot, const char* restrict key_string, LuaHashMapValue* restrict value_return)
+{
+	LuaHashMapValue the_key;
+	if(NULL == key_string)
 	{
-		return 0;
+		return false;
 	}
-	return (lua_Integer)hash_iterator->currentValue.theNumber;
+	the_key.valueType = LUA_TSTRING;
+	the_key.isInteger = false;
+	the_key.theValue.theString.stringPointer = key_string;
+	the_key.theValue.theString.stringLength = strlen(key_string);
+	return LuaHashMapSnapshot_GetValueForKey(hash_snapshot, &the_key, value_return);
+}
+
+bool LuaHashMapSnapshot_GetValueForKeyPointer(const LuaHashMapSnapshot* restrict hash_snapshot, void* key_pointer, LuaHashMapValue* restrict value_return)
+{
+	LuaHashMapValue the_key;
+	the_key.valueType = LUA_TLIGHTUSERDATA;
+	the_key.isInteger = false;
+	the_key.theValue.thePointer = key_pointer;
+	return LuaHashMapSnapshot_GetValueForKey(hash_snapshot, &the_key, value_return);
+}
+
+bool LuaHashMapSnapshot_GetValueForKeyNumber(const LuaHashMapSnapshot* restrict hash_snapshot, lua_Number key_number, LuaHashMapValue* restrict value_return)
+{
+	LuaHashMapValue the_key;
+	the_key.valueType = LUA_TNUMBER;
+	the_key.isInteger = false;
+	the_key.theValue.theNumber = key_number;
+	return LuaHashMapSnapshot_GetValueForKey(hash_snapshot, &the_key, value_return);
 }
-#endif /* defined(__STDC_VERSION__) && (__STDC_VERSION__ > 199901L) */
 
+bool LuaHashMapSnapshot_GetValueForKeyInteger(const LuaHashMapSnapshot* restrict hash_snapshot, lua_Integer key_integer, LuaHashMapValue* restrict value_return)
+{
+	LuaHashMapValue the_key;
+	the_key.valueType = LUA_TNUMBER;
+	the_key.isInteger = true;
+	the_key.theValue.theInteger = key_integer;
+	return LuaHashMapSnapshot_GetValueForKey(hash_snapshot, &the_key, value_return);
+}
 
 
 /************************************ DEPRECATED *********************************************************/
-size_t LuaHashMap_GetKeysString(LuaHashMap* hash_map, const char* keys_array[], size_t max_array_size)
+static size_t Internal_Unlocked_GetKeysString(LuaHashMap* hash_map, const char* keys_array[], size_t max_array_size)
 {
 	size_t total_count = 0;
 	if(NULL == hash_map)
@@ -3777,7 +11142,7 @@ size_t LuaHashMap_GetKeysString(LuaHashMap* hash_map, const char* keys_array[],
 		return 0;
 	}
 
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
 
 	lua_pushnil(hash_map->luaState);  /* first key */
 	while (lua_next(hash_map->luaState, -2) != 0) /* use index of table */
@@ -3798,11 +11163,11 @@ size_t LuaHashMap_GetKeysString(LuaHashMap* hash_map, const char* keys_array[],
 
 	/* Pop the global table */
 	lua_pop(hash_map->luaState, 1);	
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);	
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);	
 	return total_count;
 }
 
-size_t LuaHashMap_GetKeysPointer(LuaHashMap* hash_map, void* keys_array[], size_t max_array_size)
+static size_t Internal_Unlocked_GetKeysPointer(LuaHashMap* hash_map, void* keys_array[], size_t max_array_size)
 {
 	size_t total_count = 0;
 	if(NULL == hash_map)
@@ -3810,7 +11175,7 @@ size_t LuaHashMap_GetKeysPointer(LuaHashMap* hash_map, void* keys_array[], size_
 		return 0;
 	}
 
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
 
 	lua_pushnil(hash_map->luaState);  /* first key */
 	while (lua_next(hash_map->luaState, -2) != 0) /* use index of table */
@@ -3831,11 +11196,11 @@ size_t LuaHashMap_GetKeysPointer(LuaHashMap* hash_map, void* keys_array[], size_
 
 	/* Pop the global table */
 	lua_pop(hash_map->luaState, 1);	
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);	
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);	
 	return total_count;
 }
 
-size_t LuaHashMap_GetKeysNumber(LuaHashMap* hash_map, lua_Number keys_array[], size_t max_array_size)
+static size_t Internal_Unlocked_GetKeysNumber(LuaHashMap* hash_map, lua_Number keys_array[], size_t max_array_size)
 {
 	size_t total_count = 0;
 	if(NULL == hash_map)
@@ -3843,7 +11208,7 @@ size_t LuaHashMap_GetKeysNumber(LuaHashMap* hash_map, lua_Number keys_array[], s
 		return 0;
 	}
 	
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
 	
 	lua_pushnil(hash_map->luaState);  /* first key */
 	while (lua_next(hash_map->luaState, -2) != 0) /* use index of table */
@@ -3864,11 +11229,11 @@ size_t LuaHashMap_GetKeysNumber(LuaHashMap* hash_map, lua_Number keys_array[], s
 	
 	/* Pop the global table */
 	lua_pop(hash_map->luaState, 1);	
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);	
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);	
 	return total_count;
 }
 
-size_t LuaHashMap_GetKeysInteger(LuaHashMap* hash_map, lua_Integer keys_array[], size_t max_array_size)
+static size_t Internal_Unlocked_GetKeysInteger(LuaHashMap* hash_map, lua_Integer keys_array[], size_t max_array_size)
 {
 	size_t total_count = 0;
 	if(NULL == hash_map)
@@ -3876,7 +11241,7 @@ size_t LuaHashMap_GetKeysInteger(LuaHashMap* hash_map, lua_Integer keys_array[],
 		return 0;
 	}
 	
-	LUAHASHMAP_GETGLOBAL_UNIQUESTRING(hash_map->luaState, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
+	LUAHASHMAP_PUSH_HASHMAP_TABLE(hash_map, hash_map->uniqueTableNameForSharedState); /* stack: [table] */
 	
 	lua_pushnil(hash_map->luaState);  /* first key */
 	while (lua_next(hash_map->luaState, -2) != 0) /* use index of table */
@@ -3886,7 +11251,7 @@ size_t LuaHashMap_GetKeysInteger(LuaHashMap* hash_map, lua_Integer keys_array[],
 		/* Remember that lua_tolstring modifies the string and confuses lua_next, so be sure these are all strings */
 		if( (NULL != keys_array) && (total_count < max_array_size) )
 		{
-			keys_array[total_count] = lua_tointeger(hash_map->luaState, -2);
+			keys_array[total_count] = Internal_ToInteger(hash_map, -2);
 		}
 		
 		total_count++;
@@ -3897,13 +11262,331 @@ size_t LuaHashMap_GetKeysInteger(LuaHashMap* hash_map, lua_Integer keys_array[],
 	
 	/* Pop the global table */
 	lua_pop(hash_map->luaState, 1);	
-	LUAHASHMAP_ASSERT(lua_gettop(hash_map->luaState) == 0);	
+	LUAHASHMAP_ASSERT_STACK_BALANCED(hash_map);	
 	return total_count;
 }
 /************************************ END DEPRECATED *********************************************************/
 
 
 
+/* The public entry points. Each one runs its Internal_Unlocked_ implementation under the group lock. 
+ * The hash map expression is evaluated once, before the call, since the call may free what it points to (e.g. LuaHashMap_FreeShare).
+ */
+#define LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(return_type, function_name, parameter_list, argument_list, hash_map_expression) \
+	return_type LuaHashMap_##function_name parameter_list \
+	{ \
+		struct LuaHashMapGroupLock* group_lock = Internal_LockGroupExclusive(hash_map_expression); \
+		return_type ret_val = Internal_Unlocked_##function_name argument_list; \
+		Internal_UnlockGroupExclusive(group_lock); \
+		return ret_val; \
+	}
+
+#define LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(function_name, parameter_list, argument_list, hash_map_expression) \
+	void LuaHashMap_##function_name parameter_list \
+	{ \
+		struct LuaHashMapGroupLock* group_lock = Internal_LockGroupExclusive(hash_map_expression); \
+		Internal_Unlocked_##function_name argument_list; \
+		Internal_UnlockGroupExclusive(group_lock); \
+	}
+
+/* For lookups that don't allocate. argument_list must pass reader_map in place of hash_map. */
+#define LUAHASHMAP_DEFINE_SHARED_FUNCTION(return_type, function_name, parameter_list, argument_list) \
+	return_type LuaHashMap_##function_name parameter_list \
+	{ \
+		LuaHashMap reader_map_storage; \
+		LuaHashMap* reader_map = Internal_BeginSharedAccess(hash_map, &reader_map_storage); \
+		return_type ret_val = Internal_Unlocked_##function_name argument_list; \
+		Internal_EndSharedAccess(hash_map, reader_map); \
+		return ret_val; \
+	}
+
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(LuaHashMap*, CreateShare, (LuaHashMap* original_hash_map), (original_hash_map), original_hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(LuaHashMap*, CreateShareWithSizeHints, (LuaHashMap* original_hash_map, int number_of_array_elements, int number_of_hash_elements), (original_hash_map, number_of_array_elements, number_of_hash_elements), original_hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(FreeShare, (LuaHashMap* hash_map), (hash_map), hash_map)
+/* A session keeps the table pinned on the shared stack between calls, while other threads would be using that stack. 
+ * So sessions are refused (they do nothing) once group locking is on. Each call fetches the table itself instead.
+ */
+void LuaHashMap_BeginAccess(LuaHashMap* hash_map)
+{
+	if((NULL == hash_map) || (NULL != Internal_GetEnabledGroupLock(hash_map)))
+	{
+		return;
+	}
+	Internal_Unlocked_BeginAccess(hash_map);
+}
+void LuaHashMap_EndAccess(LuaHashMap* hash_map)
+{
+	if((NULL == hash_map) || (NULL != Internal_GetEnabledGroupLock(hash_map)))
+	{
+		return;
+	}
+	Internal_Unlocked_EndAccess(hash_map);
+}
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(const char*, SetValueStringForKeyString, (LuaHashMap* restrict hash_map, const char* value_string, const char* key_string), (hash_map, value_string, key_string), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(const char*, SetValueStringForKeyStringWithLength, (LuaHashMap* restrict hash_map, const char* value_string, const char* key_string, size_t value_string_length, size_t key_string_length), (hash_map, value_string, key_string, value_string_length, key_string_length), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(const char*, SetValuePointerForKeyString, (LuaHashMap* hash_map, void* value_pointer, const char* key_string), (hash_map, value_pointer, key_string), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(const char*, SetValuePointerForKeyStringWithLength, (LuaHashMap* hash_map, void* value_pointer, const char* key_string, size_t key_string_length), (hash_map, value_pointer, key_string, key_string_length), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(const char*, SetValueNumberForKeyString, (LuaHashMap* restrict hash_map, lua_Number value_number, const char* restrict key_string), (hash_map, value_number, key_string), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(const char*, SetValueNumberForKeyStringWithLength, (LuaHashMap* restrict hash_map, lua_Number value_number, const char* restrict key_string, size_t key_string_length), (hash_map, value_number, key_string, key_string_length), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(const char*, SetValueIntegerForKeyString, (LuaHashMap* restrict hash_map, lua_Integer value_integer, const char* restrict key_string), (hash_map, value_integer, key_string), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(const char*, SetValueIntegerForKeyStringWithLength, (LuaHashMap* restrict hash_map, lua_Integer value_integer, const char* restrict key_string, size_t key_string_length), (hash_map, value_integer, key_string, key_string_length), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(SetValuePointerForKeyPointer, (LuaHashMap* hash_map, void* value_pointer, void* key_pointer), (hash_map, value_pointer, key_pointer), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(SetValueStringForKeyPointer, (LuaHashMap* hash_map, const char* value_string, void* key_pointer), (hash_map, value_string, key_pointer), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(SetValueStringForKeyPointerWithLength, (LuaHashMap* hash_map, const char* value_string, void* key_pointer, size_t value_string_length), (hash_map, value_string, key_pointer, value_string_length), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(SetValueNumberForKeyPointer, (LuaHashMap* hash_map, lua_Number value_number, void* key_pointer), (hash_map, value_number, key_pointer), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(SetValueIntegerForKeyPointer, (LuaHashMap* hash_map, lua_Integer value_integer, void* key_pointer), (hash_map, value_integer, key_pointer), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(SetValueStringForKeyNumber, (LuaHashMap* restrict hash_map, const char* restrict value_string, lua_Number key_number), (hash_map, value_string, key_number), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(SetValueStringForKeyNumberWithLength, (LuaHashMap* restrict hash_map, const char* restrict value_string, lua_Number key_number, size_t value_string_length), (hash_map, value_string, key_number, value_string_length), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(SetValuePointerForKeyNumber, (LuaHashMap* hash_map, void* value_pointer, lua_Number key_number), (hash_map, value_pointer, key_number), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(SetValueNumberForKeyNumber, (LuaHashMap* hash_map, lua_Number value_number, lua_Number key_number), (hash_map, value_number, key_number), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(SetValueIntegerForKeyNumber, (LuaHashMap* hash_map, lua_Integer value_integer, lua_Number key_number), (hash_map, value_integer, key_number), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(SetValueStringForKeyInteger, (LuaHashMap* restrict hash_map, const char* restrict value_string, lua_Integer key_integer), (hash_map, value_string, key_integer), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(SetValueStringForKeyIntegerWithLength, (LuaHashMap* restrict hash_map, const char* restrict value_string, lua_Integer key_integer, size_t value_string_length), (hash_map, value_string, key_integer, value_string_length), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(SetValuePointerForKeyInteger, (LuaHashMap* hash_map, void* value_pointer, lua_Integer key_integer), (hash_map, value_pointer, key_integer), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(SetValueNumberForKeyInteger, (LuaHashMap* hash_map, lua_Number value_number, lua_Integer key_integer), (hash_map, value_number, key_integer), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(SetValueIntegerForKeyInteger, (LuaHashMap* hash_map, lua_Integer value_integer, lua_Integer key_integer), (hash_map, value_integer, key_integer), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(SetValuesStringForKeysString, (LuaHashMap* hash_map, const char* values_array[], const char* keys_array[], const size_t value_lengths_array[], const size_t key_lengths_array[], size_t number_of_elements), (hash_map, values_array, keys_array, value_lengths_array, key_lengths_array, number_of_elements), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(SetValuesPointerForKeysString, (LuaHashMap* hash_map, void* values_array[], const char* keys_array[], const size_t key_lengths_array[], size_t number_of_elements), (hash_map, values_array, keys_array, key_lengths_array, number_of_elements), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(SetValuesNumberForKeysString, (LuaHashMap* hash_map, const lua_Number values_array[], const char* keys_array[], const size_t key_lengths_array[], size_t number_of_elements), (hash_map, values_array, keys_array, key_lengths_array, number_of_elements), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(SetValuesIntegerForKeysString, (LuaHashMap* hash_map, const lua_Integer values_array[], const char* keys_array[], const size_t key_lengths_array[], size_t number_of_elements), (hash_map, values_array, keys_array, key_lengths_array, number_of_elements), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(SetValuesStringForKeysPointer, (LuaHashMap* hash_map, const char* values_array[], void* keys_array[], const size_t value_lengths_array[], size_t number_of_elements), (hash_map, values_array, keys_array, value_lengths_array, number_of_elements), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(SetValuesPointerForKeysPointer, (LuaHashMap* hash_map, void* values_array[], void* keys_array[], size_t number_of_elements), (hash_map, values_array, keys_array, number_of_elements), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(SetValuesNumberForKeysPointer, (LuaHashMap* hash_map, const lua_Number values_array[], void* keys_array[], size_t number_of_elements), (hash_map, values_array, keys_array, number_of_elements), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(SetValuesIntegerForKeysPointer, (LuaHashMap* hash_map, const lua_Integer values_array[], void* keys_array[], size_t number_of_elements), (hash_map, values_array, keys_array, number_of_elements), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(SetValuesStringForKeysNumber, (LuaHashMap* hash_map, const char* values_array[], const lua_Number keys_array[], const size_t value_lengths_array[], size_t number_of_elements), (hash_map, values_array, keys_array, value_lengths_array, number_of_elements), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(SetValuesPointerForKeysNumber, (LuaHashMap* hash_map, void* values_array[], const lua_Number keys_array[], size_t number_of_elements), (hash_map, values_array, keys_array, number_of_elements), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(SetValuesNumberForKeysNumber, (LuaHashMap* hash_map, const lua_Number values_array[], const lua_Number keys_array[], size_t number_of_elements), (hash_map, values_array, keys_array, number_of_elements), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(SetValuesIntegerForKeysNumber, (LuaHashMap* hash_map, const lua_Integer values_array[], const lua_Number keys_array[], size_t number_of_elements), (hash_map, values_array, keys_array, number_of_elements), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(SetValuesStringForKeysInteger, (LuaHashMap* hash_map, const char* values_array[], const lua_Integer keys_array[], const size_t value_lengths_array[], size_t number_of_elements), (hash_map, values_array, keys_array, value_lengths_array, number_of_elements), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(SetValuesPointerForKeysInteger, (LuaHashMap* hash_map, void* values_array[], const lua_Integer keys_array[], size_t number_of_elements), (hash_map, values_array, keys_array, number_of_elements), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(SetValuesNumberForKeysInteger, (LuaHashMap* hash_map, const lua_Number values_array[], const lua_Integer keys_array[], size_t number_of_elements), (hash_map, values_array, keys_array, number_of_elements), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(SetValuesIntegerForKeysInteger, (LuaHashMap* hash_map, const lua_Integer values_array[], const lua_Integer keys_array[], size_t number_of_elements), (hash_map, values_array, keys_array, number_of_elements), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(const char*, GetValueStringForKeyString, (LuaHashMap* restrict hash_map, const char* restrict key_string), (hash_map, key_string), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(const char*, GetValueStringForKeyStringWithLength, (LuaHashMap* restrict hash_map, const char* restrict key_string, size_t* restrict value_string_length_return, size_t key_string_length), (hash_map, key_string, value_string_length_return, key_string_length), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(void*, GetValuePointerForKeyString, (LuaHashMap* restrict hash_map, const char* restrict key_string), (hash_map, key_string), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(void*, GetValuePointerForKeyStringWithLength, (LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length), (hash_map, key_string, key_string_length), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(lua_Number, GetValueNumberForKeyString, (LuaHashMap* restrict hash_map, const char* restrict key_string), (hash_map, key_string), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(lua_Number, GetValueNumberForKeyStringWithLength, (LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length), (hash_map, key_string, key_string_length), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(lua_Integer, GetValueIntegerForKeyString, (LuaHashMap* restrict hash_map, const char* restrict key_string), (hash_map, key_string), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(lua_Integer, GetValueIntegerForKeyStringWithLength, (LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length), (hash_map, key_string, key_string_length), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(const char*, GetValueStringForKeyPointer, (LuaHashMap* hash_map, void* key_pointer), (hash_map, key_pointer), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(const char*, GetValueStringForKeyPointerWithLength, (LuaHashMap* hash_map, void* key_pointer, size_t* value_string_length_return), (hash_map, key_pointer, value_string_length_return), hash_map)
+LUAHASHMAP_DEFINE_SHARED_FUNCTION(void*, GetValuePointerForKeyPointer, (LuaHashMap* hash_map, void* key_pointer), (reader_map, key_pointer))
+LUAHASHMAP_DEFINE_SHARED_FUNCTION(lua_Number, GetValueNumberForKeyPointer, (LuaHashMap* hash_map, void* key_pointer), (reader_map, key_pointer))
+LUAHASHMAP_DEFINE_SHARED_FUNCTION(lua_Integer, GetValueIntegerForKeyPointer, (LuaHashMap* hash_map, void* key_pointer), (reader_map, key_pointer))
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(const char*, GetValueStringForKeyNumber, (LuaHashMap* hash_map, lua_Number key_number), (hash_map, key_number), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(const char*, GetValueStringForKeyNumberWithLength, (LuaHashMap* restrict hash_map, lua_Number key_number, size_t* restrict value_string_length_return), (hash_map, key_number, value_string_length_return), hash_map)
+LUAHASHMAP_DEFINE_SHARED_FUNCTION(void*, GetValuePointerForKeyNumber, (LuaHashMap* hash_map, lua_Number key_number), (reader_map, key_number))
+LUAHASHMAP_DEFINE_SHARED_FUNCTION(lua_Number, GetValueNumberForKeyNumber, (LuaHashMap* hash_map, lua_Number key_number), (reader_map, key_number))
+LUAHASHMAP_DEFINE_SHARED_FUNCTION(lua_Integer, GetValueIntegerForKeyNumber, (LuaHashMap* hash_map, lua_Number key_number), (reader_map, key_number))
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(const char*, GetValueStringForKeyInteger, (LuaHashMap* hash_map, lua_Integer key_integer), (hash_map, key_integer), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(const char*, GetValueStringForKeyIntegerWithLength, (LuaHashMap* restrict hash_map, lua_Integer key_integer, size_t* restrict value_string_length_return), (hash_map, key_integer, value_string_length_return), hash_map)
+LUAHASHMAP_DEFINE_SHARED_FUNCTION(void*, GetValuePointerForKeyInteger, (LuaHashMap* hash_map, lua_Integer key_integer), (reader_map, key_integer))
+LUAHASHMAP_DEFINE_SHARED_FUNCTION(lua_Number, GetValueNumberForKeyInteger, (LuaHashMap* hash_map, lua_Integer key_integer), (reader_map, key_integer))
+LUAHASHMAP_DEFINE_SHARED_FUNCTION(lua_Integer, GetValueIntegerForKeyInteger, (LuaHashMap* hash_map, lua_Integer key_integer), (reader_map, key_integer))
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, TryGetValueStringForKeyString, (LuaHashMap* restrict hash_map, const char* restrict key_string, const char** restrict value_string_return, int* restrict value_type_return), (hash_map, key_string, value_string_return, value_type_return), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, TryGetValueStringForKeyStringWithLength, (LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length, const char** restrict value_string_return, size_t* restrict value_string_length_return, int* restrict value_type_return), (hash_map, key_string, key_string_length, value_string_return, value_string_length_return, value_type_return), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, TryGetValuePointerForKeyString, (LuaHashMap* restrict hash_map, const char* restrict key_string, void** restrict value_pointer_return, int* restrict value_type_return), (hash_map, key_string, value_pointer_return, value_type_return), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, TryGetValuePointerForKeyStringWithLength, (LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length, void** restrict value_pointer_return, int* restrict value_type_return), (hash_map, key_string, key_string_length, value_pointer_return, value_type_return), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, TryGetValueNumberForKeyString, (LuaHashMap* restrict hash_map, const char* restrict key_string, lua_Number* restrict value_number_return, int* restrict value_type_return), (hash_map, key_string, value_number_return, value_type_return), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, TryGetValueNumberForKeyStringWithLength, (LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length, lua_Number* restrict value_number_return, int* restrict value_type_return), (hash_map, key_string, key_string_length, value_number_return, value_type_return), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, TryGetValueIntegerForKeyString, (LuaHashMap* restrict hash_map, const char* restrict key_string, lua_Integer* restrict value_integer_return, int* restrict value_type_return), (hash_map, key_string, value_integer_return, value_type_return), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, TryGetValueIntegerForKeyStringWithLength, (LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length, lua_Integer* restrict value_integer_return, int* restrict value_type_return), (hash_map, key_string, key_string_length, value_integer_return, value_type_return), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, TryGetValueStringForKeyPointer, (LuaHashMap* hash_map, void* key_pointer, const char** value_string_return, int* value_type_return), (hash_map, key_pointer, value_string_return, value_type_return), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, TryGetValueStringForKeyPointerWithLength, (LuaHashMap* hash_map, void* key_pointer, const char** value_string_return, size_t* value_string_length_return, int* value_type_return), (hash_map, key_pointer, value_string_return, value_string_length_return, value_type_return), hash_map)
+LUAHASHMAP_DEFINE_SHARED_FUNCTION(bool, TryGetValuePointerForKeyPointer, (LuaHashMap* hash_map, void* key_pointer, void** value_pointer_return, int* value_type_return), (reader_map, key_pointer, value_pointer_return, value_type_return))
+LUAHASHMAP_DEFINE_SHARED_FUNCTION(bool, TryGetValueNumberForKeyPointer, (LuaHashMap* hash_map, void* key_pointer, lua_Number* value_number_return, int* value_type_return), (reader_map, key_pointer, value_number_return, value_type_return))
+LUAHASHMAP_DEFINE_SHARED_FUNCTION(bool, TryGetValueIntegerForKeyPointer, (LuaHashMap* hash_map, void* key_pointer, lua_Integer* value_integer_return, int* value_type_return), (reader_map, key_pointer, value_integer_return, value_type_return))
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, TryGetValueStringForKeyNumber, (LuaHashMap* restrict hash_map, lua_Number key_number, const char** restrict value_string_return, int* restrict value_type_return), (hash_map, key_number, value_string_return, value_type_return), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, TryGetValueStringForKeyNumberWithLength, (LuaHashMap* restrict hash_map, lua_Number key_number, const char** restrict value_string_return, size_t* restrict value_string_length_return, int* restrict value_type_return), (hash_map, key_number, value_string_return, value_string_length_return, value_type_return), hash_map)
+LUAHASHMAP_DEFINE_SHARED_FUNCTION(bool, TryGetValuePointerForKeyNumber, (LuaHashMap* restrict hash_map, lua_Number key_number, void** restrict value_pointer_return, int* restrict value_type_return), (reader_map, key_number, value_pointer_return, value_type_return))
+LUAHASHMAP_DEFINE_SHARED_FUNCTION(bool, TryGetValueNumberForKeyNumber, (LuaHashMap* restrict hash_map, lua_Number key_number, lua_Number* restrict value_number_return, int* restrict value_type_return), (reader_map, key_number, value_number_return, value_type_return))
+LUAHASHMAP_DEFINE_SHARED_FUNCTION(bool, TryGetValueIntegerForKeyNumber, (LuaHashMap* restrict hash_map, lua_Number key_number, lua_Integer* restrict value_integer_return, int* restrict value_type_return), (reader_map, key_number, value_integer_return, value_type_return))
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, TryGetValueStringForKeyInteger, (LuaHashMap* restrict hash_map, lua_Integer key_integer, const char** restrict value_string_return, int* restrict value_type_return), (hash_map, key_integer, value_string_return, value_type_return), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, TryGetValueStringForKeyIntegerWithLength, (LuaHashMap* restrict hash_map, lua_Integer key_integer, const char** restrict value_string_return, size_t* restrict value_string_length_return, int* restrict value_type_return), (hash_map, key_integer, value_string_return, value_string_length_return, value_type_return), hash_map)
+LUAHASHMAP_DEFINE_SHARED_FUNCTION(bool, TryGetValuePointerForKeyInteger, (LuaHashMap* restrict hash_map, lua_Integer key_integer, void** restrict value_pointer_return, int* restrict value_type_return), (reader_map, key_integer, value_pointer_return, value_type_return))
+LUAHASHMAP_DEFINE_SHARED_FUNCTION(bool, TryGetValueNumberForKeyInteger, (LuaHashMap* restrict hash_map, lua_Integer key_integer, lua_Number* restrict value_number_return, int* restrict value_type_return), (reader_map, key_integer, value_number_return, value_type_return))
+LUAHASHMAP_DEFINE_SHARED_FUNCTION(bool, TryGetValueIntegerForKeyInteger, (LuaHashMap* restrict hash_map, lua_Integer key_integer, lua_Integer* restrict value_integer_return, int* restrict value_type_return), (reader_map, key_integer, value_integer_return, value_type_return))
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(size_t, GetValuesStringForKeysString, (LuaHashMap* hash_map, const char* values_array[], const char* keys_array[], size_t value_lengths_array[], const size_t key_lengths_array[], unsigned char found_bitmap[], size_t number_of_elements), (hash_map, values_array, keys_array, value_lengths_array, key_lengths_array, found_bitmap, number_of_elements), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(size_t, GetValuesPointerForKeysString, (LuaHashMap* hash_map, void* values_array[], const char* keys_array[], const size_t key_lengths_array[], unsigned char found_bitmap[], size_t number_of_elements), (hash_map, values_array, keys_array, key_lengths_array, found_bitmap, number_of_elements), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(size_t, GetValuesNumberForKeysString, (LuaHashMap* hash_map, lua_Number values_array[], const char* keys_array[], const size_t key_lengths_array[], unsigned char found_bitmap[], size_t number_of_elements), (hash_map, values_array, keys_array, key_lengths_array, found_bitmap, number_of_elements), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(size_t, GetValuesIntegerForKeysString, (LuaHashMap* hash_map, lua_Integer values_array[], const char* keys_array[], const size_t key_lengths_array[], unsigned char found_bitmap[], size_t number_of_elements), (hash_map, values_array, keys_array, key_lengths_array, found_bitmap, number_of_elements), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(size_t, GetValuesStringForKeysPointer, (LuaHashMap* hash_map, const char* values_array[], void* keys_array[], size_t value_lengths_array[], unsigned char found_bitmap[], size_t number_of_elements), (hash_map, values_array, keys_array, value_lengths_array, found_bitmap, number_of_elements), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(size_t, GetValuesPointerForKeysPointer, (LuaHashMap* hash_map, void* values_array[], void* keys_array[], unsigned char found_bitmap[], size_t number_of_elements), (hash_map, values_array, keys_array, found_bitmap, number_of_elements), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(size_t, GetValuesNumberForKeysPointer, (LuaHashMap* hash_map, lua_Number values_array[], void* keys_array[], unsigned char found_bitmap[], size_t number_of_elements), (hash_map, values_array, keys_array, found_bitmap, number_of_elements), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(size_t, GetValuesIntegerForKeysPointer, (LuaHashMap* hash_map, lua_Integer values_array[], void* keys_array[], unsigned char found_bitmap[], size_t number_of_elements), (hash_map, values_array, keys_array, found_bitmap, number_of_elements), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(size_t, GetValuesStringForKeysNumber, (LuaHashMap* hash_map, const char* values_array[], const lua_Number keys_array[], size_t value_lengths_array[], unsigned char found_bitmap[], size_t number_of_elements), (hash_map, values_array, keys_array, value_lengths_array, found_bitmap, number_of_elements), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(size_t, GetValuesPointerForKeysNumber, (LuaHashMap* hash_map, void* values_array[], const lua_Number keys_array[], unsigned char found_bitmap[], size_t number_of_elements), (hash_map, values_array, keys_array, found_bitmap, number_of_elements), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(size_t, GetValuesNumberForKeysNumber, (LuaHashMap* hash_map, lua_Number values_array[], const lua_Number keys_array[], unsigned char found_bitmap[], size_t number_of_elements), (hash_map, values_array, keys_array, found_bitmap, number_of_elements), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(size_t, GetValuesIntegerForKeysNumber, (LuaHashMap* hash_map, lua_Integer values_array[], const lua_Number keys_array[], unsigned char found_bitmap[], size_t number_of_elements), (hash_map, values_array, keys_array, found_bitmap, number_of_elements), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(size_t, GetValuesStringForKeysInteger, (LuaHashMap* hash_map, const char* values_array[], const lua_Integer keys_array[], size_t value_lengths_array[], unsigned char found_bitmap[], size_t number_of_elements), (hash_map, values_array, keys_array, value_lengths_array, found_bitmap, number_of_elements), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(size_t, GetValuesPointerForKeysInteger, (LuaHashMap* hash_map, void* values_array[], const lua_Integer keys_array[], unsigned char found_bitmap[], size_t number_of_elements), (hash_map, values_array, keys_array, found_bitmap, number_of_elements), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(size_t, GetValuesNumberForKeysInteger, (LuaHashMap* hash_map, lua_Number values_array[], const lua_Integer keys_array[], unsigned char found_bitmap[], size_t number_of_elements), (hash_map, values_array, keys_array, found_bitmap, number_of_elements), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(size_t, GetValuesIntegerForKeysInteger, (LuaHashMap* hash_map, lua_Integer values_array[], const lua_Integer keys_array[], unsigned char found_bitmap[], size_t number_of_elements), (hash_map, values_array, keys_array, found_bitmap, number_of_elements), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(RemoveKeyString, (LuaHashMap* restrict hash_map, const char* restrict key_string), (hash_map, key_string), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(RemoveKeyStringWithLength, (LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length), (hash_map, key_string, key_string_length), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(RemoveKeyPointer, (LuaHashMap* hash_map, void* key_pointer), (hash_map, key_pointer), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(RemoveKeyNumber, (LuaHashMap* hash_map, lua_Number key_number), (hash_map, key_number), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(RemoveKeyInteger, (LuaHashMap* hash_map, lua_Integer key_integer), (hash_map, key_integer), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, IncrementIntegerForKeyString, (LuaHashMap* restrict hash_map, const char* restrict key_string, lua_Integer delta, lua_Integer* restrict value_integer_return), (hash_map, key_string, delta, value_integer_return), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, IncrementIntegerForKeyPointer, (LuaHashMap* hash_map, void* key_pointer, lua_Integer delta, lua_Integer* restrict value_integer_return), (hash_map, key_pointer, delta, value_integer_return), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, IncrementIntegerForKeyNumber, (LuaHashMap* restrict hash_map, lua_Number key_number, lua_Integer delta, lua_Integer* restrict value_integer_return), (hash_map, key_number, delta, value_integer_return), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, IncrementIntegerForKeyInteger, (LuaHashMap* restrict hash_map, lua_Integer key_integer, lua_Integer delta, lua_Integer* restrict value_integer_return), (hash_map, key_integer, delta, value_integer_return), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, IncrementIntegerForKeyStringWithLength, (LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length, lua_Integer delta, lua_Integer* restrict value_integer_return), (hash_map, key_string, key_string_length, delta, value_integer_return), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(const char*, GetOrSetValueStringForKeyString, (LuaHashMap* restrict hash_map, const char* value_string, const char* restrict key_string), (hash_map, value_string, key_string), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(const char*, GetOrSetValueStringForKeyStringWithLength, (LuaHashMap* restrict hash_map, const char* value_string, const char* restrict key_string, size_t value_string_length, size_t key_string_length), (hash_map, value_string, key_string, value_string_length, key_string_length), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(const char*, GetOrSetValueStringForKeyPointer, (LuaHashMap* hash_map, const char* value_string, void* key_pointer), (hash_map, value_string, key_pointer), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(const char*, GetOrSetValueStringForKeyPointerWithLength, (LuaHashMap* hash_map, const char* value_string, void* key_pointer, size_t value_string_length), (hash_map, value_string, key_pointer, value_string_length), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(const char*, GetOrSetValueStringForKeyNumber, (LuaHashMap* restrict hash_map, const char* value_string, lua_Number key_number), (hash_map, value_string, key_number), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(const char*, GetOrSetValueStringForKeyNumberWithLength, (LuaHashMap* restrict hash_map, const char* value_string, lua_Number key_number, size_t value_string_length), (hash_map, value_string, key_number, value_string_length), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(const char*, GetOrSetValueStringForKeyInteger, (LuaHashMap* restrict hash_map, const char* value_string, lua_Integer key_integer), (hash_map, value_string, key_integer), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(const char*, GetOrSetValueStringForKeyIntegerWithLength, (LuaHashMap* restrict hash_map, const char* value_string, lua_Integer key_integer, size_t value_string_length), (hash_map, value_string, key_integer, value_string_length), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(void*, GetOrSetValuePointerForKeyString, (LuaHashMap* hash_map, void* value_pointer, const char* key_string), (hash_map, value_pointer, key_string), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(void*, GetOrSetValuePointerForKeyStringWithLength, (LuaHashMap* hash_map, void* value_pointer, const char* key_string, size_t key_string_length), (hash_map, value_pointer, key_string, key_string_length), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(void*, GetOrSetValuePointerForKeyPointer, (LuaHashMap* hash_map, void* value_pointer, void* key_pointer), (hash_map, value_pointer, key_pointer), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(void*, GetOrSetValuePointerForKeyNumber, (LuaHashMap* hash_map, void* value_pointer, lua_Number key_number), (hash_map, value_pointer, key_number), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(void*, GetOrSetValuePointerForKeyInteger, (LuaHashMap* hash_map, void* value_pointer, lua_Integer key_integer), (hash_map, value_pointer, key_integer), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(lua_Number, GetOrSetValueNumberForKeyString, (LuaHashMap* restrict hash_map, lua_Number value_number, const char* restrict key_string), (hash_map, value_number, key_string), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(lua_Number, GetOrSetValueNumberForKeyStringWithLength, (LuaHashMap* restrict hash_map, lua_Number value_number, const char* restrict key_string, size_t key_string_length), (hash_map, value_number, key_string, key_string_length), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(lua_Number, GetOrSetValueNumberForKeyPointer, (LuaHashMap* hash_map, lua_Number value_number, void* key_pointer), (hash_map, value_number, key_pointer), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(lua_Number, GetOrSetValueNumberForKeyNumber, (LuaHashMap* restrict hash_map, lua_Number value_number, lua_Number key_number), (hash_map, value_number, key_number), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(lua_Number, GetOrSetValueNumberForKeyInteger, (LuaHashMap* restrict hash_map, lua_Number value_number, lua_Integer key_integer), (hash_map, value_number, key_integer), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(lua_Integer, GetOrSetValueIntegerForKeyString, (LuaHashMap* restrict hash_map, lua_Integer value_integer, const char* restrict key_string), (hash_map, value_integer, key_string), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(lua_Integer, GetOrSetValueIntegerForKeyStringWithLength, (LuaHashMap* restrict hash_map, lua_Integer value_integer, const char* restrict key_string, size_t key_string_length), (hash_map, value_integer, key_string, key_string_length), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(lua_Integer, GetOrSetValueIntegerForKeyPointer, (LuaHashMap* hash_map, lua_Integer value_integer, void* key_pointer), (hash_map, value_integer, key_pointer), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(lua_Integer, GetOrSetValueIntegerForKeyNumber, (LuaHashMap* restrict hash_map, lua_Integer value_integer, lua_Number key_number), (hash_map, value_integer, key_number), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(lua_Integer, GetOrSetValueIntegerForKeyInteger, (LuaHashMap* restrict hash_map, lua_Integer value_integer, lua_Integer key_integer), (hash_map, value_integer, key_integer), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(void*, TakeValuePointerForKeyString, (LuaHashMap* restrict hash_map, const char* restrict key_string), (hash_map, key_string), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(void*, TakeValuePointerForKeyStringWithLength, (LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length), (hash_map, key_string, key_string_length), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(void*, TakeValuePointerForKeyPointer, (LuaHashMap* hash_map, void* key_pointer), (hash_map, key_pointer), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(void*, TakeValuePointerForKeyNumber, (LuaHashMap* restrict hash_map, lua_Number key_number), (hash_map, key_number), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(void*, TakeValuePointerForKeyInteger, (LuaHashMap* restrict hash_map, lua_Integer key_integer), (hash_map, key_integer), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(lua_Number, TakeValueNumberForKeyString, (LuaHashMap* restrict hash_map, const char* restrict key_string), (hash_map, key_string), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(lua_Number, TakeValueNumberForKeyStringWithLength, (LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length), (hash_map, key_string, key_string_length), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(lua_Number, TakeValueNumberForKeyPointer, (LuaHashMap* hash_map, void* key_pointer), (hash_map, key_pointer), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(lua_Number, TakeValueNumberForKeyNumber, (LuaHashMap* restrict hash_map, lua_Number key_number), (hash_map, key_number), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(lua_Number, TakeValueNumberForKeyInteger, (LuaHashMap* restrict hash_map, lua_Integer key_integer), (hash_map, key_integer), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(lua_Integer, TakeValueIntegerForKeyString, (LuaHashMap* restrict hash_map, const char* restrict key_string), (hash_map, key_string), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(lua_Integer, TakeValueIntegerForKeyStringWithLength, (LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length), (hash_map, key_string, key_string_length), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(lua_Integer, TakeValueIntegerForKeyPointer, (LuaHashMap* hash_map, void* key_pointer), (hash_map, key_pointer), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(lua_Integer, TakeValueIntegerForKeyNumber, (LuaHashMap* restrict hash_map, lua_Number key_number), (hash_map, key_number), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(lua_Integer, TakeValueIntegerForKeyInteger, (LuaHashMap* restrict hash_map, lua_Integer key_integer), (hash_map, key_integer), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, CompareAndSetValueStringForKeyString, (LuaHashMap* restrict hash_map, const char* value_string, const char* expected_value_string, const char* restrict key_string), (hash_map, value_string, expected_value_string, key_string), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, CompareAndSetValueStringForKeyStringWithLength, (LuaHashMap* restrict hash_map, const char* value_string, const char* expected_value_string, const char* restrict key_string, size_t value_string_length, size_t expected_value_string_length, size_t key_string_length), (hash_map, value_string, expected_value_string, key_string, value_string_length, expected_value_string_length, key_string_length), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, CompareAndSetValueStringForKeyPointer, (LuaHashMap* hash_map, const char* value_string, const char* expected_value_string, void* key_pointer), (hash_map, value_string, expected_value_string, key_pointer), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, CompareAndSetValueStringForKeyPointerWithLength, (LuaHashMap* hash_map, const char* value_string, const char* expected_value_string, void* key_pointer, size_t value_string_length, size_t expected_value_string_length), (hash_map, value_string, expected_value_string, key_pointer, value_string_length, expected_value_string_length), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, CompareAndSetValueStringForKeyNumber, (LuaHashMap* restrict hash_map, const char* value_string, const char* expected_value_string, lua_Number key_number), (hash_map, value_string, expected_value_string, key_number), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, CompareAndSetValueStringForKeyNumberWithLength, (LuaHashMap* restrict hash_map, const char* value_string, const char* expected_value_string, lua_Number key_number, size_t value_string_length, size_t expected_value_string_length), (hash_map, value_string, expected_value_string, key_number, value_string_length, expected_value_string_length), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, CompareAndSetValueStringForKeyInteger, (LuaHashMap* restrict hash_map, const char* value_string, const char* expected_value_string, lua_Integer key_integer), (hash_map, value_string, expected_value_string, key_integer), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, CompareAndSetValueStringForKeyIntegerWithLength, (LuaHashMap* restrict hash_map, const char* value_string, const char* expected_value_string, lua_Integer key_integer, size_t value_string_length, size_t expected_value_string_length), (hash_map, value_string, expected_value_string, key_integer, value_string_length, expected_value_string_length), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, CompareAndSetValuePointerForKeyString, (LuaHashMap* hash_map, void* value_pointer, void* expected_value_pointer, const char* key_string), (hash_map, value_pointer, expected_value_pointer, key_string), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, CompareAndSetValuePointerForKeyStringWithLength, (LuaHashMap* hash_map, void* value_pointer, void* expected_value_pointer, const char* key_string, size_t key_string_length), (hash_map, value_pointer, expected_value_pointer, key_string, key_string_length), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, CompareAndSetValuePointerForKeyPointer, (LuaHashMap* hash_map, void* value_pointer, void* expected_value_pointer, void* key_pointer), (hash_map, value_pointer, expected_value_pointer, key_pointer), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, CompareAndSetValuePointerForKeyNumber, (LuaHashMap* hash_map, void* value_pointer, void* expected_value_pointer, lua_Number key_number), (hash_map, value_pointer, expected_value_pointer, key_number), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, CompareAndSetValuePointerForKeyInteger, (LuaHashMap* hash_map, void* value_pointer, void* expected_value_pointer, lua_Integer key_integer), (hash_map, value_pointer, expected_value_pointer, key_integer), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, CompareAndSetValueNumberForKeyString, (LuaHashMap* restrict hash_map, lua_Number value_number, lua_Number expected_value_number, const char* restrict key_string), (hash_map, value_number, expected_value_number, key_string), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, CompareAndSetValueNumberForKeyStringWithLength, (LuaHashMap* restrict hash_map, lua_Number value_number, lua_Number expected_value_number, const char* restrict key_string, size_t key_string_length), (hash_map, value_number, expected_value_number, key_string, key_string_length), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, CompareAndSetValueNumberForKeyPointer, (LuaHashMap* hash_map, lua_Number value_number, lua_Number expected_value_number, void* key_pointer), (hash_map, value_number, expected_value_number, key_pointer), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, CompareAndSetValueNumberForKeyNumber, (LuaHashMap* restrict hash_map, lua_Number value_number, lua_Number expected_value_number, lua_Number key_number), (hash_map, value_number, expected_value_number, key_number), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, CompareAndSetValueNumberForKeyInteger, (LuaHashMap* restrict hash_map, lua_Number value_number, lua_Number expected_value_number, lua_Integer key_integer), (hash_map, value_number, expected_value_number, key_integer), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, CompareAndSetValueIntegerForKeyString, (LuaHashMap* restrict hash_map, lua_Integer value_integer, lua_Integer expected_value_integer, const char* restrict key_string), (hash_map, value_integer, expected_value_integer, key_string), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, CompareAndSetValueIntegerForKeyStringWithLength, (LuaHashMap* restrict hash_map, lua_Integer value_integer, lua_Integer expected_value_integer, const char* restrict key_string, size_t key_string_length), (hash_map, value_integer, expected_value_integer, key_string, key_string_length), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, CompareAndSetValueIntegerForKeyPointer, (LuaHashMap* hash_map, lua_Integer value_integer, lua_Integer expected_value_integer, void* key_pointer), (hash_map, value_integer, expected_value_integer, key_pointer), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, CompareAndSetValueIntegerForKeyNumber, (LuaHashMap* restrict hash_map, lua_Integer value_integer, lua_Integer expected_value_integer, lua_Number key_number), (hash_map, value_integer, expected_value_integer, key_number), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, CompareAndSetValueIntegerForKeyInteger, (LuaHashMap* restrict hash_map, lua_Integer value_integer, lua_Integer expected_value_integer, lua_Integer key_integer), (hash_map, value_integer, expected_value_integer, key_integer), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, RemoveKeyStringIfValueString, (LuaHashMap* restrict hash_map, const char* restrict key_string, const char* expected_value_string), (hash_map, key_string, expected_value_string), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, RemoveKeyStringIfValueStringWithLength, (LuaHashMap* restrict hash_map, const char* restrict key_string, const char* expected_value_string, size_t key_string_length, size_t expected_value_string_length), (hash_map, key_string, expected_value_string, key_string_length, expected_value_string_length), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, RemoveKeyPointerIfValueString, (LuaHashMap* hash_map, void* key_pointer, const char* expected_value_string), (hash_map, key_pointer, expected_value_string), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, RemoveKeyPointerIfValueStringWithLength, (LuaHashMap* hash_map, void* key_pointer, const char* expected_value_string, size_t expected_value_string_length), (hash_map, key_pointer, expected_value_string, expected_value_string_length), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, RemoveKeyNumberIfValueString, (LuaHashMap* restrict hash_map, lua_Number key_number, const char* expected_value_string), (hash_map, key_number, expected_value_string), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, RemoveKeyNumberIfValueStringWithLength, (LuaHashMap* restrict hash_map, lua_Number key_number, const char* expected_value_string, size_t expected_value_string_length), (hash_map, key_number, expected_value_string, expected_value_string_length), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, RemoveKeyIntegerIfValueString, (LuaHashMap* restrict hash_map, lua_Integer key_integer, const char* expected_value_string), (hash_map, key_integer, expected_value_string), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, RemoveKeyIntegerIfValueStringWithLength, (LuaHashMap* restrict hash_map, lua_Integer key_integer, const char* expected_value_string, size_t expected_value_string_length), (hash_map, key_integer, expected_value_string, expected_value_string_length), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, RemoveKeyStringIfValuePointer, (LuaHashMap* hash_map, const char* key_string, void* expected_value_pointer), (hash_map, key_string, expected_value_pointer), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, RemoveKeyStringIfValuePointerWithLength, (LuaHashMap* hash_map, const char* key_string, void* expected_value_pointer, size_t key_string_length), (hash_map, key_string, expected_value_pointer, key_string_length), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, RemoveKeyPointerIfValuePointer, (LuaHashMap* hash_map, void* key_pointer, void* expected_value_pointer), (hash_map, key_pointer, expected_value_pointer), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, RemoveKeyNumberIfValuePointer, (LuaHashMap* hash_map, lua_Number key_number, void* expected_value_pointer), (hash_map, key_number, expected_value_pointer), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, RemoveKeyIntegerIfValuePointer, (LuaHashMap* hash_map, lua_Integer key_integer, void* expected_value_pointer), (hash_map, key_integer, expected_value_pointer), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, RemoveKeyStringIfValueNumber, (LuaHashMap* restrict hash_map, const char* restrict key_string, lua_Number expected_value_number), (hash_map, key_string, expected_value_number), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, RemoveKeyStringIfValueNumberWithLength, (LuaHashMap* restrict hash_map, const char* restrict key_string, lua_Number expected_value_number, size_t key_string_length), (hash_map, key_string, expected_value_number, key_string_length), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, RemoveKeyPointerIfValueNumber, (LuaHashMap* hash_map, void* key_pointer, lua_Number expected_value_number), (hash_map, key_pointer, expected_value_number), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, RemoveKeyNumberIfValueNumber, (LuaHashMap* restrict hash_map, lua_Number key_number, lua_Number expected_value_number), (hash_map, key_number, expected_value_number), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, RemoveKeyIntegerIfValueNumber, (LuaHashMap* restrict hash_map, lua_Integer key_integer, lua_Number expected_value_number), (hash_map, key_integer, expected_value_number), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, RemoveKeyStringIfValueInteger, (LuaHashMap* restrict hash_map, const char* restrict key_string, lua_Integer expected_value_integer), (hash_map, key_string, expected_value_integer), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, RemoveKeyStringIfValueIntegerWithLength, (LuaHashMap* restrict hash_map, const char* restrict key_string, lua_Integer expected_value_integer, size_t key_string_length), (hash_map, key_string, expected_value_integer, key_string_length), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, RemoveKeyPointerIfValueInteger, (LuaHashMap* hash_map, void* key_pointer, lua_Integer expected_value_integer), (hash_map, key_pointer, expected_value_integer), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, RemoveKeyNumberIfValueInteger, (LuaHashMap* restrict hash_map, lua_Number key_number, lua_Integer expected_value_integer), (hash_map, key_number, expected_value_integer), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, RemoveKeyIntegerIfValueInteger, (LuaHashMap* restrict hash_map, lua_Integer key_integer, lua_Integer expected_value_integer), (hash_map, key_integer, expected_value_integer), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, ExistsKeyString, (LuaHashMap* restrict hash_map, const char* restrict key_string), (hash_map, key_string), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, ExistsKeyStringWithLength, (LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length), (hash_map, key_string, key_string_length), hash_map)
+LUAHASHMAP_DEFINE_SHARED_FUNCTION(bool, ExistsKeyPointer, (LuaHashMap* hash_map, void* key_pointer), (reader_map, key_pointer))
+LUAHASHMAP_DEFINE_SHARED_FUNCTION(bool, ExistsKeyNumber, (LuaHashMap* hash_map, lua_Number key_number), (reader_map, key_number))
+LUAHASHMAP_DEFINE_SHARED_FUNCTION(bool, ExistsKeyInteger, (LuaHashMap* hash_map, lua_Integer key_integer), (reader_map, key_integer))
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(size_t, ExistsKeysString, (LuaHashMap* hash_map, const char* keys_array[], const size_t key_lengths_array[], unsigned char found_bitmap[], size_t number_of_elements), (hash_map, keys_array, key_lengths_array, found_bitmap, number_of_elements), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(size_t, ExistsKeysPointer, (LuaHashMap* hash_map, void* keys_array[], unsigned char found_bitmap[], size_t number_of_elements), (hash_map, keys_array, found_bitmap, number_of_elements), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(size_t, ExistsKeysNumber, (LuaHashMap* hash_map, const lua_Number keys_array[], unsigned char found_bitmap[], size_t number_of_elements), (hash_map, keys_array, found_bitmap, number_of_elements), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(size_t, ExistsKeysInteger, (LuaHashMap* hash_map, const lua_Integer keys_array[], unsigned char found_bitmap[], size_t number_of_elements), (hash_map, keys_array, found_bitmap, number_of_elements), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(Clear, (LuaHashMap* hash_map), (hash_map), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(Purge, (LuaHashMap* hash_map), (hash_map), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(Reserve, (LuaHashMap* hash_map, int number_of_array_elements, int number_of_hash_elements), (hash_map, number_of_array_elements, number_of_hash_elements), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(Compact, (LuaHashMap* hash_map, bool should_collect_garbage), (hash_map, should_collect_garbage), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(double, GetUnusedCapacityRatio, (LuaHashMap* hash_map), (hash_map), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, SetGCMode, (LuaHashMap* hash_map, LuaHashMapGCMode gc_mode), (hash_map, gc_mode), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(LuaHashMapGCMode, GetGCMode, (LuaHashMap* hash_map), (hash_map), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, GCStep, (LuaHashMap* hash_map, int step_size), (hash_map, step_size), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, SetExactIntegerMode, (LuaHashMap* hash_map, bool use_exact_integers), (hash_map, use_exact_integers), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, GetExactIntegerMode, (LuaHashMap* hash_map), (hash_map), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, IsEmpty, (LuaHashMap* hash_map), (hash_map), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, IteratorNext, (LuaHashMapIterator* hash_iterator), (hash_iterator), Internal_GetHashMapForIterator(hash_iterator))
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(int, ForEach, (LuaHashMap* hash_map, LuaHashMap_ForEachCallback callback_function, void* user_data), (hash_map, callback_function, user_data), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(size_t, RemoveIf, (LuaHashMap* hash_map, LuaHashMap_RemoveIfPredicate predicate_function, void* user_data), (hash_map, predicate_function, user_data), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(size_t, TransformValues, (LuaHashMap* hash_map, LuaHashMap_TransformValuesCallback callback_function, void* user_data), (hash_map, callback_function, user_data), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(size_t, TransformValuesNumber, (LuaHashMap* hash_map, LuaHashMap_TransformValuesNumberCallback callback_function, void* user_data), (hash_map, callback_function, user_data), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(size_t, TransformValuesInteger, (LuaHashMap* hash_map, LuaHashMap_TransformValuesIntegerCallback callback_function, void* user_data), (hash_map, callback_function, user_data), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(AggregateNumbers, (LuaHashMap* hash_map, LuaHashMapAggregateStats* stats_return), (hash_map, stats_return), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, Eval, (LuaHashMap* restrict hash_map, const char* restrict lua_chunk, size_t lua_chunk_length, const LuaHashMapValue* restrict arguments_array, size_t number_of_arguments, LuaHashMapValue* restrict result_return), (hash_map, lua_chunk, lua_chunk_length, arguments_array, number_of_arguments, result_return), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(ClearEvalCache, (LuaHashMap* hash_map), (hash_map), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(LuaHashMapIterator, GetIteratorAtBegin, (LuaHashMap* hash_map), (hash_map), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(LuaHashMapIterator, GetIteratorAtEnd, (LuaHashMap* hash_map), (hash_map), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(LuaHashMapIterator, GetIteratorForKeyString, (LuaHashMap* restrict hash_map, const char* restrict key_string), (hash_map, key_string), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(LuaHashMapIterator, GetIteratorForKeyStringWithLength, (LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length), (hash_map, key_string, key_string_length), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(LuaHashMapIterator, GetIteratorForKeyPointer, (LuaHashMap* hash_map, void* key_pointer), (hash_map, key_pointer), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(LuaHashMapIterator, GetIteratorForKeyNumber, (LuaHashMap* hash_map, lua_Number key_number), (hash_map, key_number), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(LuaHashMapIterator, GetIteratorForKeyInteger, (LuaHashMap* hash_map, lua_Integer key_integer), (hash_map, key_integer), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(size_t, IteratorNextBatch, (LuaHashMapIterator* restrict hash_iterator, LuaHashMapValue* restrict keys_array, LuaHashMapValue* restrict values_array, size_t max_number_of_elements), (hash_iterator, keys_array, values_array, max_number_of_elements), Internal_GetHashMapForIterator(hash_iterator))
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(LuaHashMapCursor*, CreateCursor, (LuaHashMap* hash_map), (hash_map), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(FreeCursor, (LuaHashMapCursor* hash_cursor), (hash_cursor), Internal_GetHashMapForCursor(hash_cursor))
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(CursorReset, (LuaHashMapCursor* hash_cursor), (hash_cursor), Internal_GetHashMapForCursor(hash_cursor))
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, CursorNext, (LuaHashMapCursor* hash_cursor), (hash_cursor), Internal_GetHashMapForCursor(hash_cursor))
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(LuaHashMapScan*, CreateScan, (LuaHashMap* hash_map), (hash_map), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(FreeScan, (LuaHashMapScan* hash_scan), (hash_scan), Internal_GetHashMapForScan(hash_scan))
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(size_t, ScanNext, (LuaHashMapScan* restrict hash_scan, LuaHashMapValue* restrict keys_array, LuaHashMapValue* restrict values_array, size_t max_number_of_elements), (hash_scan, keys_array, values_array, max_number_of_elements), Internal_GetHashMapForScan(hash_scan))
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(SetValueStringAtIterator, (LuaHashMapIterator* restrict hash_iterator, const char* restrict value_string), (hash_iterator, value_string), Internal_GetHashMapForIterator(hash_iterator))
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(SetValueStringAtIteratorWithLength, (LuaHashMapIterator* restrict hash_iterator, const char* restrict value_string, size_t value_string_length), (hash_iterator, value_string, value_string_length), Internal_GetHashMapForIterator(hash_iterator))
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(SetValuePointerAtIterator, (LuaHashMapIterator* hash_iterator, void* value_pointer), (hash_iterator, value_pointer), Internal_GetHashMapForIterator(hash_iterator))
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(SetValueNumberAtIterator, (LuaHashMapIterator* hash_iterator, lua_Number value_number), (hash_iterator, value_number), Internal_GetHashMapForIterator(hash_iterator))
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(SetValueIntegerAtIterator, (LuaHashMapIterator* hash_iterator, lua_Integer value_integer), (hash_iterator, value_integer), Internal_GetHashMapForIterator(hash_iterator))
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(const char*, GetValueStringAtIterator, (LuaHashMapIterator* hash_iterator), (hash_iterator), Internal_GetHashMapForIterator(hash_iterator))
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(const char*, GetValueStringAtIteratorWithLength, (LuaHashMapIterator* restrict hash_iterator, size_t* restrict value_string_length_return), (hash_iterator, value_string_length_return), Internal_GetHashMapForIterator(hash_iterator))
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(void*, GetValuePointerAtIterator, (LuaHashMapIterator* hash_iterator), (hash_iterator), Internal_GetHashMapForIterator(hash_iterator))
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(lua_Number, GetValueNumberAtIterator, (LuaHashMapIterator* hash_iterator), (hash_iterator), Internal_GetHashMapForIterator(hash_iterator))
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(lua_Integer, GetValueIntegerAtIterator, (LuaHashMapIterator* hash_iterator), (hash_iterator), Internal_GetHashMapForIterator(hash_iterator))
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, ExistsAtIterator, (LuaHashMapIterator* hash_iterator), (hash_iterator), Internal_GetHashMapForIterator(hash_iterator))
+LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION(RemoveAtIterator, (LuaHashMapIterator* hash_iterator), (hash_iterator), Internal_GetHashMapForIterator(hash_iterator))
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(size_t, Count, (LuaHashMap* hash_map), (hash_map), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(bool, PublishSnapshot, (LuaHashMap* hash_map), (hash_map), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(int, GetValueTypeAtIterator, (LuaHashMapIterator* hash_iterator), (hash_iterator), Internal_GetHashMapForIterator(hash_iterator))
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(size_t, GetKeysString, (LuaHashMap* hash_map, const char* keys_array[], size_t max_array_size), (hash_map, keys_array, max_array_size), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(size_t, GetKeysPointer, (LuaHashMap* hash_map, void* keys_array[], size_t max_array_size), (hash_map, keys_array, max_array_size), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(size_t, GetKeysNumber, (LuaHashMap* hash_map, lua_Number keys_array[], size_t max_array_size), (hash_map, keys_array, max_array_size), hash_map)
+LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION(size_t, GetKeysInteger, (LuaHashMap* hash_map, lua_Integer keys_array[], size_t max_array_size), (hash_map, keys_array, max_array_size), hash_map)
+
+#undef LUAHASHMAP_DEFINE_EXCLUSIVE_FUNCTION
+#undef LUAHASHMAP_DEFINE_EXCLUSIVE_VOID_FUNCTION
+#undef LUAHASHMAP_DEFINE_SHARED_FUNCTION
+
+
+
 
 #if defined(__LUAHASHMAP_RESTRICT_KEYWORD_DEFINED__)
 	#undef restrict
@@ -814,7 +814,8 @@ union LuaHashMapKeyValueType
 	 * This can happen in 32-bit where double is 8-bytes and size_t + pointer is 4-bytes + 4-bytes == 8 bytes. */
 	LuaHashMapStringContainer theString;
 	lua_Number theNumber;
-/*		lua_Integer theInteger; */
+	/* Used instead of theNumber when the number is an integer (see isKeyInteger/isValueInteger) so 64-bit integers stay exact. */
+	lua_Integer theInteger;
 	void* thePointer;
 };
 
@@ -846,9 +847,47 @@ struct LuaHashMapIterator
 	int valueType;
 	bool atEnd;
 	bool isNext;
+	/* When keyType/valueType is LUA_TNUMBER, these say whether theInteger or theNumber holds it. */
+	bool isKeyInteger;
+	bool isValueInteger;
 };
 
 typedef struct LuaHashMapIterator LuaHashMapIterator;
+
+/**
+ * A typed key or value, used by LuaHashMap_IteratorNextBatch and LuaHashMap_Eval.
+ * valueType is LUA_TSTRING, LUA_TLIGHTUSERDATA, LUA_TNUMBER, LUA_TBOOLEAN (Eval only) or LUA_TNIL.
+ * For LUA_TNUMBER, isInteger says whether theValue.theInteger or theValue.theNumber is used. 
+ * For LUA_TBOOLEAN, theValue.theInteger is 0 or 1.
+ */
+struct LuaHashMapValue
+{
+	union LuaHashMapKeyValueType theValue;
+	int valueType;
+	bool isInteger;
+};
+typedef struct LuaHashMapValue LuaHashMapValue;
+
+/**
+ * An opaque traversal handle that keeps its position inside Lua. See LuaHashMap_CreateCursor.
+ */
+typedef struct LuaHashMapCursor LuaHashMapCursor;
+
+/**
+ * An opaque resumable scan that tolerates the hash table being modified between steps. See LuaHashMap_CreateScan.
+ */
+typedef struct LuaHashMapScan LuaHashMapScan;
+
+/**
+ * Garbage collector modes for LuaHashMap_SetGCMode.
+ */
+typedef enum LuaHashMapGCMode
+{
+	LUAHASHMAP_GCMODE_INCREMENTAL = 0, /**< Lua's default. The collector runs automatically in incremental steps. */
+	LUAHASHMAP_GCMODE_STOPPED, /**< The collector never runs automatically. Use LuaHashMap_GCStep (or Purge/Compact) to collect. */
+	LUAHASHMAP_GCMODE_GENERATIONAL /**< The collector runs automatically in generational mode. Requires Lua 5.4 (or the experimental mode in 5.2). */
+} LuaHashMapGCMode;
+
 /** @defgroup Create Create family of functions
  *  @{
  */
@@ -1045,6 +1084,37 @@ LUAHASHMAP_EXPORT void LuaHashMap_FreeShare(LuaHashMap* hash_map);
  */
 LUAHASHMAP_EXPORT lua_State* LuaHashMap_GetLuaState(LuaHashMap* hash_map);
 
+/** @defgroup AccessFamily Access session functions
+ *  @{
+ */
+
+/**
+ * Begins an access session which pins the hash map's table on the Lua stack.
+ * Normally every operation must fetch the table from the Lua registry before it can do anything.
+ * While a session is open, all the Set/Get/Exists/Remove/Iterator functions on this hash_map reuse the pinned table instead.
+ * This is intended for hot loops that do many operations on the same hash map.
+ * Sessions may be nested. Every call to LuaHashMap_BeginAccess must be balanced with a call to LuaHashMap_EndAccess.
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ *
+ * @warning The table is left on the stack of the lua_State. If you are doing your own Lua stack manipulation on the lua_State,
+ * you must leave the stack as you found it. (Debug builds assert on this.)
+ * Hash maps sharing the lua_State (CreateShare) may have their own sessions open at the same time, and they may be ended in any order.
+ * @note Sessions are ignored (this does nothing) while group locking is enabled. See LuaHashMap_EnableGroupLocking.
+ * @see LuaHashMap_EndAccess
+ */
+LUAHASHMAP_EXPORT void LuaHashMap_BeginAccess(LuaHashMap* hash_map);
+/**
+ * Ends an access session started by LuaHashMap_BeginAccess.
+ * When the outermost session ends, the pinned table is removed from the Lua stack.
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @see LuaHashMap_BeginAccess
+ */
+LUAHASHMAP_EXPORT void LuaHashMap_EndAccess(LuaHashMap* hash_map);
+
+/** @} */
+
 
 
 
@@ -1354,6 +1424,227 @@ LUAHASHMAP_EXPORT void LuaHashMap_SetValueIntegerForKeyInteger(LuaHashMap* hash_
 	
 /** @} */ 
 
+/** @defgroup SetValuesForKeysFamily SetValuesForKeys (batch) family of functions
+ *  @{
+ */
+
+/**
+ * Adds or updates multiple key-value pairs to the hash table in a single batch.
+ * Adds or updates multiple key-value pairs to the hash table in a single batch. The table is fetched only once for the whole batch which avoids the per-call overhead of LuaHashMap_SetValueStringForKeyString.
+ * <string, string> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param values_array The array of values. values_array[i] is the value for keys_array[i]. NULL value strings are treated as strings with length=0 ("").
+ * @param keys_array The array of keys. NULL key strings disallowed and those elements will simply be skipped.
+ * @param value_lengths_array Optional array of string lengths (strlen()) for each value string. (This does not count the \0 terminator character.) Pass NULL to have strlen() computed for you.
+ * @param key_lengths_array Optional array of string lengths (strlen()) for each key string. (This does not count the \0 terminator character.) Pass NULL to have strlen() computed for you.
+ * @param number_of_elements The number of elements in the arrays.
+ *
+ * @note Lua copies strings and internalizes them. This means Lua/LuaHashMap have its own copy of the string and you are free to delete your string if you are done with it.
+ * @see LuaHashMap_SetValueStringForKeyString
+ */
+LUAHASHMAP_EXPORT void LuaHashMap_SetValuesStringForKeysString(LuaHashMap* hash_map, const char* values_array[], const char* keys_array[], const size_t value_lengths_array[], const size_t key_lengths_array[], size_t number_of_elements);
+/**
+ * Adds or updates multiple key-value pairs to the hash table in a single batch.
+ * Adds or updates multiple key-value pairs to the hash table in a single batch. The table is fetched only once for the whole batch which avoids the per-call overhead of LuaHashMap_SetValuePointerForKeyString.
+ * <string, pointer> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param values_array The array of values. values_array[i] is the value for keys_array[i]. NULL value pointers are allowed as legitimate values.
+ * @param keys_array The array of keys. NULL key strings disallowed and those elements will simply be skipped.
+ * @param key_lengths_array Optional array of string lengths (strlen()) for each key string. (This does not count the \0 terminator character.) Pass NULL to have strlen() computed for you.
+ * @param number_of_elements The number of elements in the arrays.
+ *
+ * @note Lua copies strings and internalizes them. This means Lua/LuaHashMap have its own copy of the string and you are free to delete your string if you are done with it.
+ * @see LuaHashMap_SetValuePointerForKeyString
+ */
+LUAHASHMAP_EXPORT void LuaHashMap_SetValuesPointerForKeysString(LuaHashMap* hash_map, void* values_array[], const char* keys_array[], const size_t key_lengths_array[], size_t number_of_elements);
+/**
+ * Adds or updates multiple key-value pairs to the hash table in a single batch.
+ * Adds or updates multiple key-value pairs to the hash table in a single batch. The table is fetched only once for the whole batch which avoids the per-call overhead of LuaHashMap_SetValueNumberForKeyString.
+ * <string, number> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param values_array The array of values. values_array[i] is the value for keys_array[i].
+ * @param keys_array The array of keys. NULL key strings disallowed and those elements will simply be skipped.
+ * @param key_lengths_array Optional array of string lengths (strlen()) for each key string. (This does not count the \0 terminator character.) Pass NULL to have strlen() computed for you.
+ * @param number_of_elements The number of elements in the arrays.
+ *
+ * @note Lua copies strings and internalizes them. This means Lua/LuaHashMap have its own copy of the string and you are free to delete your string if you are done with it.
+ * @see LuaHashMap_SetValueNumberForKeyString
+ */
+LUAHASHMAP_EXPORT void LuaHashMap_SetValuesNumberForKeysString(LuaHashMap* hash_map, const lua_Number values_array[], const char* keys_array[], const size_t key_lengths_array[], size_t number_of_elements);
+/**
+ * Adds or updates multiple key-value pairs to the hash table in a single batch.
+ * Adds or updates multiple key-value pairs to the hash table in a single batch. The table is fetched only once for the whole batch which avoids the per-call overhead of LuaHashMap_SetValueIntegerForKeyString.
+ * <string, integer> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param values_array The array of values. values_array[i] is the value for keys_array[i].
+ * @param keys_array The array of keys. NULL key strings disallowed and those elements will simply be skipped.
+ * @param key_lengths_array Optional array of string lengths (strlen()) for each key string. (This does not count the \0 terminator character.) Pass NULL to have strlen() computed for you.
+ * @param number_of_elements The number of elements in the arrays.
+ *
+ * @note Lua copies strings and internalizes them. This means Lua/LuaHashMap have its own copy of the string and you are free to delete your string if you are done with it.
+ * @see LuaHashMap_SetValueIntegerForKeyString
+ */
+LUAHASHMAP_EXPORT void LuaHashMap_SetValuesIntegerForKeysString(LuaHashMap* hash_map, const lua_Integer values_array[], const char* keys_array[], const size_t key_lengths_array[], size_t number_of_elements);
+/**
+ * Adds or updates multiple key-value pairs to the hash table in a single batch.
+ * Adds or updates multiple key-value pairs to the hash table in a single batch. The table is fetched only once for the whole batch which avoids the per-call overhead of LuaHashMap_SetValueStringForKeyPointer.
+ * <pointer, string> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param values_array The array of values. values_array[i] is the value for keys_array[i]. NULL value strings are treated as strings with length=0 ("").
+ * @param keys_array The array of keys. NULL key pointers are allowed.
+ * @param value_lengths_array Optional array of string lengths (strlen()) for each value string. (This does not count the \0 terminator character.) Pass NULL to have strlen() computed for you.
+ * @param number_of_elements The number of elements in the arrays.
+ *
+ * @note Lua copies strings and internalizes them. This means Lua/LuaHashMap have its own copy of the string and you are free to delete your string if you are done with it.
+ * @see LuaHashMap_SetValueStringForKeyPointer
+ */
+LUAHASHMAP_EXPORT void LuaHashMap_SetValuesStringForKeysPointer(LuaHashMap* hash_map, const char* values_array[], void* keys_array[], const size_t value_lengths_array[], size_t number_of_elements);
+/**
+ * Adds or updates multiple key-value pairs to the hash table in a single batch.
+ * Adds or updates multiple key-value pairs to the hash table in a single batch. The table is fetched only once for the whole batch which avoids the per-call overhead of LuaHashMap_SetValuePointerForKeyPointer.
+ * <pointer, pointer> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param values_array The array of values. values_array[i] is the value for keys_array[i]. NULL value pointers are allowed as legitimate values.
+ * @param keys_array The array of keys. NULL key pointers are allowed.
+ * @param number_of_elements The number of elements in the arrays.
+ * @see LuaHashMap_SetValuePointerForKeyPointer
+ */
+LUAHASHMAP_EXPORT void LuaHashMap_SetValuesPointerForKeysPointer(LuaHashMap* hash_map, void* values_array[], void* keys_array[], size_t number_of_elements);
+/**
+ * Adds or updates multiple key-value pairs to the hash table in a single batch.
+ * Adds or updates multiple key-value pairs to the hash table in a single batch. The table is fetched only once for the whole batch which avoids the per-call overhead of LuaHashMap_SetValueNumberForKeyPointer.
+ * <pointer, number> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param values_array The array of values. values_array[i] is the value for keys_array[i].
+ * @param keys_array The array of keys. NULL key pointers are allowed.
+ * @param number_of_elements The number of elements in the arrays.
+ * @see LuaHashMap_SetValueNumberForKeyPointer
+ */
+LUAHASHMAP_EXPORT void LuaHashMap_SetValuesNumberForKeysPointer(LuaHashMap* hash_map, const lua_Number values_array[], void* keys_array[], size_t number_of_elements);
+/**
+ * Adds or updates multiple key-value pairs to the hash table in a single batch.
+ * Adds or updates multiple key-value pairs to the hash table in a single batch. The table is fetched only once for the whole batch which avoids the per-call overhead of LuaHashMap_SetValueIntegerForKeyPointer.
+ * <pointer, integer> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param values_array The array of values. values_array[i] is the value for keys_array[i].
+ * @param keys_array The array of keys. NULL key pointers are allowed.
+ * @param number_of_elements The number of elements in the arrays.
+ * @see LuaHashMap_SetValueIntegerForKeyPointer
+ */
+LUAHASHMAP_EXPORT void LuaHashMap_SetValuesIntegerForKeysPointer(LuaHashMap* hash_map, const lua_Integer values_array[], void* keys_array[], size_t number_of_elements);
+/**
+ * Adds or updates multiple key-value pairs to the hash table in a single batch.
+ * Adds or updates multiple key-value pairs to the hash table in a single batch. The table is fetched only once for the whole batch which avoids the per-call overhead of LuaHashMap_SetValueStringForKeyNumber.
+ * <number, string> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param values_array The array of values. values_array[i] is the value for keys_array[i]. NULL value strings are treated as strings with length=0 ("").
+ * @param keys_array The array of keys.
+ * @param value_lengths_array Optional array of string lengths (strlen()) for each value string. (This does not count the \0 terminator character.) Pass NULL to have strlen() computed for you.
+ * @param number_of_elements The number of elements in the arrays.
+ *
+ * @note Lua copies strings and internalizes them. This means Lua/LuaHashMap have its own copy of the string and you are free to delete your string if you are done with it.
+ * @see LuaHashMap_SetValueStringForKeyNumber
+ */
+LUAHASHMAP_EXPORT void LuaHashMap_SetValuesStringForKeysNumber(LuaHashMap* hash_map, const char* values_array[], const lua_Number keys_array[], const size_t value_lengths_array[], size_t number_of_elements);
+/**
+ * Adds or updates multiple key-value pairs to the hash table in a single batch.
+ * Adds or updates multiple key-value pairs to the hash table in a single batch. The table is fetched only once for the whole batch which avoids the per-call overhead of LuaHashMap_SetValuePointerForKeyNumber.
+ * <number, pointer> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param values_array The array of values. values_array[i] is the value for keys_array[i]. NULL value pointers are allowed as legitimate values.
+ * @param keys_array The array of keys.
+ * @param number_of_elements The number of elements in the arrays.
+ * @see LuaHashMap_SetValuePointerForKeyNumber
+ */
+LUAHASHMAP_EXPORT void LuaHashMap_SetValuesPointerForKeysNumber(LuaHashMap* hash_map, void* values_array[], const lua_Number keys_array[], size_t number_of_elements);
+/**
+ * Adds or updates multiple key-value pairs to the hash table in a single batch.
+ * Adds or updates multiple key-value pairs to the hash table in a single batch. The table is fetched only once for the whole batch which avoids the per-call overhead of LuaHashMap_SetValueNumberForKeyNumber.
+ * <number, number> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param values_array The array of values. values_array[i] is the value for keys_array[i].
+ * @param keys_array The array of keys.
+ * @param number_of_elements The number of elements in the arrays.
+ * @see LuaHashMap_SetValueNumberForKeyNumber
+ */
+LUAHASHMAP_EXPORT void LuaHashMap_SetValuesNumberForKeysNumber(LuaHashMap* hash_map, const lua_Number values_array[], const lua_Number keys_array[], size_t number_of_elements);
+/**
+ * Adds or updates multiple key-value pairs to the hash table in a single batch.
+ * Adds or updates multiple key-value pairs to the hash table in a single batch. The table is fetched only once for the whole batch which avoids the per-call overhead of LuaHashMap_SetValueIntegerForKeyNumber.
+ * <number, integer> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param values_array The array of values. values_array[i] is the value for keys_array[i].
+ * @param keys_array The array of keys.
+ * @param number_of_elements The number of elements in the arrays.
+ * @see LuaHashMap_SetValueIntegerForKeyNumber
+ */
+LUAHASHMAP_EXPORT void LuaHashMap_SetValuesIntegerForKeysNumber(LuaHashMap* hash_map, const lua_Integer values_array[], const lua_Number keys_array[], size_t number_of_elements);
+/**
+ * Adds or updates multiple key-value pairs to the hash table in a single batch.
+ * Adds or updates multiple key-value pairs to the hash table in a single batch. The table is fetched only once for the whole batch which avoids the per-call overhead of LuaHashMap_SetValueStringForKeyInteger.
+ * <integer, string> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param values_array The array of values. values_array[i] is the value for keys_array[i]. NULL value strings are treated as strings with length=0 ("").
+ * @param keys_array The array of keys.
+ * @param value_lengths_array Optional array of string lengths (strlen()) for each value string. (This does not count the \0 terminator character.) Pass NULL to have strlen() computed for you.
+ * @param number_of_elements The number of elements in the arrays.
+ *
+ * @note Lua copies strings and internalizes them. This means Lua/LuaHashMap have its own copy of the string and you are free to delete your string if you are done with it.
+ * @see LuaHashMap_SetValueStringForKeyInteger
+ */
+LUAHASHMAP_EXPORT void LuaHashMap_SetValuesStringForKeysInteger(LuaHashMap* hash_map, const char* values_array[], const lua_Integer keys_array[], const size_t value_lengths_array[], size_t number_of_elements);
+/**
+ * Adds or updates multiple key-value pairs to the hash table in a single batch.
+ * Adds or updates multiple key-value pairs to the hash table in a single batch. The table is fetched only once for the whole batch which avoids the per-call overhead of LuaHashMap_SetValuePointerForKeyInteger.
+ * <integer, pointer> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param values_array The array of values. values_array[i] is the value for keys_array[i]. NULL value pointers are allowed as legitimate values.
+ * @param keys_array The array of keys.
+ * @param number_of_elements The number of elements in the arrays.
+ * @see LuaHashMap_SetValuePointerForKeyInteger
+ */
+LUAHASHMAP_EXPORT void LuaHashMap_SetValuesPointerForKeysInteger(LuaHashMap* hash_map, void* values_array[], const lua_Integer keys_array[], size_t number_of_elements);
+/**
+ * Adds or updates multiple key-value pairs to the hash table in a single batch.
+ * Adds or updates multiple key-value pairs to the hash table in a single batch. The table is fetched only once for the whole batch which avoids the per-call overhead of LuaHashMap_SetValueNumberForKeyInteger.
+ * <integer, number> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param values_array The array of values. values_array[i] is the value for keys_array[i].
+ * @param keys_array The array of keys.
+ * @param number_of_elements The number of elements in the arrays.
+ * @see LuaHashMap_SetValueNumberForKeyInteger
+ */
+LUAHASHMAP_EXPORT void LuaHashMap_SetValuesNumberForKeysInteger(LuaHashMap* hash_map, const lua_Number values_array[], const lua_Integer keys_array[], size_t number_of_elements);
+/**
+ * Adds or updates multiple key-value pairs to the hash table in a single batch.
+ * Adds or updates multiple key-value pairs to the hash table in a single batch. The table is fetched only once for the whole batch which avoids the per-call overhead of LuaHashMap_SetValueIntegerForKeyInteger.
+ * <integer, integer> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param values_array The array of values. values_array[i] is the value for keys_array[i].
+ * @param keys_array The array of keys.
+ * @param number_of_elements The number of elements in the arrays.
+ * @see LuaHashMap_SetValueIntegerForKeyInteger
+ */
+LUAHASHMAP_EXPORT void LuaHashMap_SetValuesIntegerForKeysInteger(LuaHashMap* hash_map, const lua_Integer values_array[], const lua_Integer keys_array[], size_t number_of_elements);
+
+/** @} */
+
 /** @defgroup GetValueForKeyFamily GetValueForKey family of functions
  *  @{
  */
@@ -1687,1342 +1978,4263 @@ LUAHASHMAP_EXPORT lua_Integer LuaHashMap_GetValueIntegerForKeyInteger(LuaHashMap
 
 
 /** @} */ 
-	
-/** @defgroup ExistsKeyFamily ExistsKey family of functions
+
+/** @defgroup TryGetValueForKeyFamily TryGetValueForKey family of functions
  *  @{
  */
 
-
-/* Exists Functions*/
+/* Key String family */
 /**
- * Returns whether a key/value pair exists in the hash table for a specified key.
- * Returns whether a key/value pair exists in the hash table for a specified key.
- * string version
+ * Looks up a key and returns whether it was found along with its value.
+ * Looks up a key and returns whether it was found along with its value, using a single look up.
+ * Unlike LuaHashMap_GetValueStringForKeyString, this distinguishes a missing key from a stored NULL/empty string.
+ * <string, string> version
  *
  * @param hash_map The LuaHashMap instance to operate on.
- * @param key_string The key to test.
- * @return Returns true if the key/value pair exists in the hash table. Returns false otherwise.
+ * @param key_string The key for the value. NULL key strings disallowed and the operation will simply return false.
+ * @param value_string_return Receives the value for the key, or NULL if not found. May be NULL if you only need the presence and type.
+ * @param value_type_return Receives the Lua type of the stored value (LUA_TSTRING, LUA_TLIGHTUSERDATA, LUA_TNUMBER), or LUA_TNONE if not found. May be NULL.
+ * @return Returns true if the key was found.
  *
- * @note Consider using the GetIteratorForKey + GetCachedValue family of functions if you need to first check for existence and then retrieve the value if it exists.
- * @see LuaHashMap_GetIteratorForKeyString, LuaHashMap_ExistsKeyStringWithLength
+ * @note The returned value string is the Lua internalized pointer. It is only valid as long as the entry remains in the hash table.
+ *
+ * @note If the stored value is a different type than the one requested, this still returns true and value_type_return tells you what was actually stored.
+ * @see LuaHashMap_GetValueStringForKeyString, LuaHashMap_ExistsKeyString
  */
-LUAHASHMAP_EXPORT bool LuaHashMap_ExistsKeyString(LuaHashMap* restrict hash_map, const char* restrict key_string);
+LUAHASHMAP_EXPORT bool LuaHashMap_TryGetValueStringForKeyString(LuaHashMap* restrict hash_map, const char* restrict key_string, const char** restrict value_string_return, int* restrict value_type_return);
 /**
- * Returns whether a key/value pair exists in the hash table for a specified key.
- * Returns whether a key/value pair exists in the hash table for a specified key.
- * string version
- * This version allows you to specify the string length for the string if you already know it as an optimization.
+ * Looks up a key and returns whether it was found along with its value.
+ * Looks up a key and returns whether it was found along with its value, using a single look up.
+ * Unlike LuaHashMap_GetValueStringForKeyString, this distinguishes a missing key from a stored NULL/empty string.
+ * <string, string> version
+ * This version allows you to specify the string length for the key and get the length of the value string.
  *
  * @param hash_map The LuaHashMap instance to operate on.
- * @param key_string The key to test.
+ * @param key_string The key for the value. NULL key strings disallowed and the operation will simply return false.
  * @param key_string_length The string length (strlen()) of the key string. (This does not count the \0 terminator character.)
- * @return Returns true if the key/value pair exists in the hash table. Returns false otherwise.
+ * @param value_string_return Receives the value for the key, or NULL if not found. May be NULL if you only need the presence and type.
+ * @param value_string_length_return Receives the string length of the value string (0 if not found). May be NULL.
+ * @param value_type_return Receives the Lua type of the stored value (LUA_TSTRING, LUA_TLIGHTUSERDATA, LUA_TNUMBER), or LUA_TNONE if not found. May be NULL.
+ * @return Returns true if the key was found.
  *
- * @note Consider using the GetIteratorForKey + GetCachedValue family of functions if you need to first check for existence and then retrieve the value if it exists.
- * @see LuaHashMap_GetIteratorForKeyString, LuaHashMap_ExistsKeyString
+ * @note The returned value string is the Lua internalized pointer. It is only valid as long as the entry remains in the hash table.
+ *
+ * @note If the stored value is a different type than the one requested, this still returns true and value_type_return tells you what was actually stored.
+ * @see LuaHashMap_GetValueStringForKeyString, LuaHashMap_ExistsKeyString
  */
-LUAHASHMAP_EXPORT bool LuaHashMap_ExistsKeyStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length);
+LUAHASHMAP_EXPORT bool LuaHashMap_TryGetValueStringForKeyStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length, const char** restrict value_string_return, size_t* restrict value_string_length_return, int* restrict value_type_return);
 /**
- * Returns whether a key/value pair exists in the hash table for a specified key.
- * Returns whether a key/value pair exists in the hash table for a specified key.
- * pointer version
+ * Looks up a key and returns whether it was found along with its value.
+ * Looks up a key and returns whether it was found along with its value, using a single look up.
+ * Unlike LuaHashMap_GetValuePointerForKeyString, this distinguishes a missing key from a stored NULL.
+ * <string, pointer> version
  *
  * @param hash_map The LuaHashMap instance to operate on.
- * @param key_pointer The key to test.
- * @return Returns true if the key/value pair exists in the hash table. Returns false otherwise.
+ * @param key_string The key for the value. NULL key strings disallowed and the operation will simply return false.
+ * @param value_pointer_return Receives the value for the key, or NULL if not found. May be NULL if you only need the presence and type.
+ * @param value_type_return Receives the Lua type of the stored value (LUA_TSTRING, LUA_TLIGHTUSERDATA, LUA_TNUMBER), or LUA_TNONE if not found. May be NULL.
+ * @return Returns true if the key was found.
  *
- * @note Consider using the GetIteratorForKey + GetCachedValue family of functions if you need to first check for existence and then retrieve the value if it exists.
- * @see LuaHashMap_GetIteratorForKeyPointer
+ * @note If the stored value is a different type than the one requested, this still returns true and value_type_return tells you what was actually stored.
+ * @see LuaHashMap_GetValuePointerForKeyString, LuaHashMap_ExistsKeyString
  */
-LUAHASHMAP_EXPORT bool LuaHashMap_ExistsKeyPointer(LuaHashMap* hash_map, void* key_pointer);
+LUAHASHMAP_EXPORT bool LuaHashMap_TryGetValuePointerForKeyString(LuaHashMap* restrict hash_map, const char* restrict key_string, void** restrict value_pointer_return, int* restrict value_type_return);
 /**
- * Returns whether a key/value pair exists in the hash table for a specified key.
- * Returns whether a key/value pair exists in the hash table for a specified key.
- * number version
+ * Looks up a key and returns whether it was found along with its value.
+ * Looks up a key and returns whether it was found along with its value, using a single look up.
+ * Unlike LuaHashMap_GetValuePointerForKeyString, this distinguishes a missing key from a stored NULL.
+ * <string, pointer> version
+ * This version allows you to specify the string length for the key string if you already know it as an optimization.
  *
  * @param hash_map The LuaHashMap instance to operate on.
- * @param key_number The key to test.
- * @return Returns true if the key/value pair exists in the hash table. Returns false otherwise.
+ * @param key_string The key for the value. NULL key strings disallowed and the operation will simply return false.
+ * @param key_string_length The string length (strlen()) of the key string. (This does not count the \0 terminator character.)
+ * @param value_pointer_return Receives the value for the key, or NULL if not found. May be NULL if you only need the presence and type.
+ * @param value_type_return Receives the Lua type of the stored value (LUA_TSTRING, LUA_TLIGHTUSERDATA, LUA_TNUMBER), or LUA_TNONE if not found. May be NULL.
+ * @return Returns true if the key was found.
  *
- * @note Consider using the GetIteratorForKey + GetCachedValue family of functions if you need to first check for existence and then retrieve the value if it exists.
- * @see LuaHashMap_GetIteratorForKeyNumber
+ * @note If the stored value is a different type than the one requested, this still returns true and value_type_return tells you what was actually stored.
+ * @see LuaHashMap_GetValuePointerForKeyString, LuaHashMap_ExistsKeyString
  */
-LUAHASHMAP_EXPORT bool LuaHashMap_ExistsKeyNumber(LuaHashMap* hash_map, lua_Number key_number);
+LUAHASHMAP_EXPORT bool LuaHashMap_TryGetValuePointerForKeyStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length, void** restrict value_pointer_return, int* restrict value_type_return);
 /**
- * Returns whether a key/value pair exists in the hash table for a specified key.
- * Returns whether a key/value pair exists in the hash table for a specified key.
- * integer version
+ * Looks up a key and returns whether it was found along with its value.
+ * Looks up a key and returns whether it was found along with its value, using a single look up.
+ * Unlike LuaHashMap_GetValueNumberForKeyString, this distinguishes a missing key from a stored 0.0.
+ * <string, number> version
  *
  * @param hash_map The LuaHashMap instance to operate on.
- * @param key_integer The key to test.
- * @return Returns true if the key/value pair exists in the hash table. Returns false otherwise.
+ * @param key_string The key for the value. NULL key strings disallowed and the operation will simply return false.
+ * @param value_number_return Receives the value for the key, or 0.0 if not found. May be NULL if you only need the presence and type.
+ * @param value_type_return Receives the Lua type of the stored value (LUA_TSTRING, LUA_TLIGHTUSERDATA, LUA_TNUMBER), or LUA_TNONE if not found. May be NULL.
+ * @return Returns true if the key was found.
  *
- * @note Consider using the GetIteratorForKey + GetCachedValue family of functions if you need to first check for existence and then retrieve the value if it exists.
- * @see LuaHashMap_GetIteratorForKeyInteger
+ * @note If the stored value is a different type than the one requested, this still returns true and value_type_return tells you what was actually stored.
+ * @see LuaHashMap_GetValueNumberForKeyString, LuaHashMap_ExistsKeyString
  */
-LUAHASHMAP_EXPORT bool LuaHashMap_ExistsKeyInteger(LuaHashMap* hash_map, lua_Integer key_integer);
-
-/** @} */ 
-
-/** @defgroup RemoveKeyFamily RemoveKey family of functions
- *  @{
+LUAHASHMAP_EXPORT bool LuaHashMap_TryGetValueNumberForKeyString(LuaHashMap* restrict hash_map, const char* restrict key_string, lua_Number* restrict value_number_return, int* restrict value_type_return);
+/**
+ * Looks up a key and returns whether it was found along with its value.
+ * Looks up a key and returns whether it was found along with its value, using a single look up.
+ * Unlike LuaHashMap_GetValueNumberForKeyString, this distinguishes a missing key from a stored 0.0.
+ * <string, number> version
+ * This version allows you to specify the string length for the key string if you already know it as an optimization.
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_string The key for the value. NULL key strings disallowed and the operation will simply return false.
+ * @param key_string_length The string length (strlen()) of the key string. (This does not count the \0 terminator character.)
+ * @param value_number_return Receives the value for the key, or 0.0 if not found. May be NULL if you only need the presence and type.
+ * @param value_type_return Receives the Lua type of the stored value (LUA_TSTRING, LUA_TLIGHTUSERDATA, LUA_TNUMBER), or LUA_TNONE if not found. May be NULL.
+ * @return Returns true if the key was found.
+ *
+ * @note If the stored value is a different type than the one requested, this still returns true and value_type_return tells you what was actually stored.
+ * @see LuaHashMap_GetValueNumberForKeyString, LuaHashMap_ExistsKeyString
  */
-
+LUAHASHMAP_EXPORT bool LuaHashMap_TryGetValueNumberForKeyStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length, lua_Number* restrict value_number_return, int* restrict value_type_return);
 /**
- * Removes a key/value pair in the hash table for a specified key.
- * Removes a key/value pair in the hash table for a specified key.
- * string version
- * It is safe to try to remove a key that doesn't exist.
+ * Looks up a key and returns whether it was found along with its value.
+ * Looks up a key and returns whether it was found along with its value, using a single look up.
+ * Unlike LuaHashMap_GetValueIntegerForKeyString, this distinguishes a missing key from a stored 0.
+ * <string, integer> version
  *
  * @param hash_map The LuaHashMap instance to operate on.
- * @param key_string The key to remove.
+ * @param key_string The key for the value. NULL key strings disallowed and the operation will simply return false.
+ * @param value_integer_return Receives the value for the key, or 0 if not found. May be NULL if you only need the presence and type.
+ * @param value_type_return Receives the Lua type of the stored value (LUA_TSTRING, LUA_TLIGHTUSERDATA, LUA_TNUMBER), or LUA_TNONE if not found. May be NULL.
+ * @return Returns true if the key was found.
+ *
+ * @note If the stored value is a different type than the one requested, this still returns true and value_type_return tells you what was actually stored.
+ * @see LuaHashMap_GetValueIntegerForKeyString, LuaHashMap_ExistsKeyString
  */
-LUAHASHMAP_EXPORT void LuaHashMap_RemoveKeyString(LuaHashMap* restrict hash_map, const char* restrict key_string);
+LUAHASHMAP_EXPORT bool LuaHashMap_TryGetValueIntegerForKeyString(LuaHashMap* restrict hash_map, const char* restrict key_string, lua_Integer* restrict value_integer_return, int* restrict value_type_return);
 /**
- * Removes a key/value pair in the hash table for a specified key.
- * Removes a key/value pair in the hash table for a specified key.
- * string version
- * This version allows you to specify the string length for the string if you already know it as an optimization.
- * It is safe to try to remove a key that doesn't exist.
+ * Looks up a key and returns whether it was found along with its value.
+ * Looks up a key and returns whether it was found along with its value, using a single look up.
+ * Unlike LuaHashMap_GetValueIntegerForKeyString, this distinguishes a missing key from a stored 0.
+ * <string, integer> version
+ * This version allows you to specify the string length for the key string if you already know it as an optimization.
  *
  * @param hash_map The LuaHashMap instance to operate on.
- * @param key_string The key to remove.
+ * @param key_string The key for the value. NULL key strings disallowed and the operation will simply return false.
  * @param key_string_length The string length (strlen()) of the key string. (This does not count the \0 terminator character.)
+ * @param value_integer_return Receives the value for the key, or 0 if not found. May be NULL if you only need the presence and type.
+ * @param value_type_return Receives the Lua type of the stored value (LUA_TSTRING, LUA_TLIGHTUSERDATA, LUA_TNUMBER), or LUA_TNONE if not found. May be NULL.
+ * @return Returns true if the key was found.
+ *
+ * @note If the stored value is a different type than the one requested, this still returns true and value_type_return tells you what was actually stored.
+ * @see LuaHashMap_GetValueIntegerForKeyString, LuaHashMap_ExistsKeyString
  */
-LUAHASHMAP_EXPORT void LuaHashMap_RemoveKeyStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length);
+LUAHASHMAP_EXPORT bool LuaHashMap_TryGetValueIntegerForKeyStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length, lua_Integer* restrict value_integer_return, int* restrict value_type_return);
+
+/* Key Pointer family */
 /**
- * Removes a key/value pair in the hash table for a specified key.
- * Removes a key/value pair in the hash table for a specified key.
- * pointer version
- * It is safe to try to remove a key that doesn't exist.
+ * Looks up a key and returns whether it was found along with its value.
+ * Looks up a key and returns whether it was found along with its value, using a single look up.
+ * Unlike LuaHashMap_GetValueStringForKeyPointer, this distinguishes a missing key from a stored NULL/empty string.
+ * <pointer, string> version
  *
  * @param hash_map The LuaHashMap instance to operate on.
- * @param key_pointer The key to remove.
+ * @param key_pointer The key for the value.
+ * @param value_string_return Receives the value for the key, or NULL if not found. May be NULL if you only need the presence and type.
+ * @param value_type_return Receives the Lua type of the stored value (LUA_TSTRING, LUA_TLIGHTUSERDATA, LUA_TNUMBER), or LUA_TNONE if not found. May be NULL.
+ * @return Returns true if the key was found.
+ *
+ * @note The returned value string is the Lua internalized pointer. It is only valid as long as the entry remains in the hash table.
+ *
+ * @note If the stored value is a different type than the one requested, this still returns true and value_type_return tells you what was actually stored.
+ * @see LuaHashMap_GetValueStringForKeyPointer, LuaHashMap_ExistsKeyPointer
  */
-LUAHASHMAP_EXPORT void LuaHashMap_RemoveKeyPointer(LuaHashMap* hash_map, void* key_pointer);
+LUAHASHMAP_EXPORT bool LuaHashMap_TryGetValueStringForKeyPointer(LuaHashMap* hash_map, void* key_pointer, const char** value_string_return, int* value_type_return);
 /**
- * Removes a key/value pair in the hash table for a specified key.
- * Removes a key/value pair in the hash table for a specified key.
- * number version
- * It is safe to try to remove a key that doesn't exist.
+ * Looks up a key and returns whether it was found along with its value.
+ * Looks up a key and returns whether it was found along with its value, using a single look up.
+ * Unlike LuaHashMap_GetValueStringForKeyPointer, this distinguishes a missing key from a stored NULL/empty string.
+ * <pointer, string> version
+ * This version allows you to specify the string length of the value string back.
  *
  * @param hash_map The LuaHashMap instance to operate on.
- * @param key_number The key to remove.
+ * @param key_pointer The key for the value.
+ * @param value_string_return Receives the value for the key, or NULL if not found. May be NULL if you only need the presence and type.
+ * @param value_string_length_return Receives the string length of the value string (0 if not found). May be NULL.
+ * @param value_type_return Receives the Lua type of the stored value (LUA_TSTRING, LUA_TLIGHTUSERDATA, LUA_TNUMBER), or LUA_TNONE if not found. May be NULL.
+ * @return Returns true if the key was found.
+ *
+ * @note The returned value string is the Lua internalized pointer. It is only valid as long as the entry remains in the hash table.
+ *
+ * @note If the stored value is a different type than the one requested, this still returns true and value_type_return tells you what was actually stored.
+ * @see LuaHashMap_GetValueStringForKeyPointer, LuaHashMap_ExistsKeyPointer
  */
-LUAHASHMAP_EXPORT void LuaHashMap_RemoveKeyNumber(LuaHashMap* hash_map, lua_Number key_number);
+LUAHASHMAP_EXPORT bool LuaHashMap_TryGetValueStringForKeyPointerWithLength(LuaHashMap* hash_map, void* key_pointer, const char** value_string_return, size_t* value_string_length_return, int* value_type_return);
 /**
- * Removes a key/value pair in the hash table for a specified key.
- * Removes a key/value pair in the hash table for a specified key.
- * integer version
- * It is safe to try to remove a key that doesn't exist.
+ * Looks up a key and returns whether it was found along with its value.
+ * Looks up a key and returns whether it was found along with its value, using a single look up.
+ * Unlike LuaHashMap_GetValuePointerForKeyPointer, this distinguishes a missing key from a stored NULL.
+ * <pointer, pointer> version
  *
  * @param hash_map The LuaHashMap instance to operate on.
- * @param key_integer The key to remove.
- */
-LUAHASHMAP_EXPORT void LuaHashMap_RemoveKeyInteger(LuaHashMap* hash_map, lua_Integer key_integer);
-/** @} */ 
-
-/** @defgroup ClearFamily Clear family of functions
- *  @{
+ * @param key_pointer The key for the value.
+ * @param value_pointer_return Receives the value for the key, or NULL if not found. May be NULL if you only need the presence and type.
+ * @param value_type_return Receives the Lua type of the stored value (LUA_TSTRING, LUA_TLIGHTUSERDATA, LUA_TNUMBER), or LUA_TNONE if not found. May be NULL.
+ * @return Returns true if the key was found.
+ *
+ * @note If the stored value is a different type than the one requested, this still returns true and value_type_return tells you what was actually stored.
+ * @see LuaHashMap_GetValuePointerForKeyPointer, LuaHashMap_ExistsKeyPointer
  */
+LUAHASHMAP_EXPORT bool LuaHashMap_TryGetValuePointerForKeyPointer(LuaHashMap* hash_map, void* key_pointer, void** value_pointer_return, int* value_type_return);
 /**
- * Removes all entries from the hash table, but doesn't shrink the hash.
- * This removes all entries from the hash table, but it doesn't shrink the hash (doesn't reclaim memory). 
- * @param hash_map The LuaHashMap instance to operate on. 
+ * Looks up a key and returns whether it was found along with its value.
+ * Looks up a key and returns whether it was found along with its value, using a single look up.
+ * Unlike LuaHashMap_GetValueNumberForKeyPointer, this distinguishes a missing key from a stored 0.0.
+ * <pointer, number> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_pointer The key for the value.
+ * @param value_number_return Receives the value for the key, or 0.0 if not found. May be NULL if you only need the presence and type.
+ * @param value_type_return Receives the Lua type of the stored value (LUA_TSTRING, LUA_TLIGHTUSERDATA, LUA_TNUMBER), or LUA_TNONE if not found. May be NULL.
+ * @return Returns true if the key was found.
+ *
+ * @note If the stored value is a different type than the one requested, this still returns true and value_type_return tells you what was actually stored.
+ * @see LuaHashMap_GetValueNumberForKeyPointer, LuaHashMap_ExistsKeyPointer
  */
-LUAHASHMAP_EXPORT void LuaHashMap_Clear(LuaHashMap* hash_map);
+LUAHASHMAP_EXPORT bool LuaHashMap_TryGetValueNumberForKeyPointer(LuaHashMap* hash_map, void* key_pointer, lua_Number* value_number_return, int* value_type_return);
 /**
- * Removes all entries from the hash table and resets the hash size to 0 (reclaims memory)
- * This removes all entries from the hash table and  resets the hash size to 0 (reclaims memory).
- * @param hash_map The LuaHashMap instance to operate on. 
+ * Looks up a key and returns whether it was found along with its value.
+ * Looks up a key and returns whether it was found along with its value, using a single look up.
+ * Unlike LuaHashMap_GetValueIntegerForKeyPointer, this distinguishes a missing key from a stored 0.
+ * <pointer, integer> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_pointer The key for the value.
+ * @param value_integer_return Receives the value for the key, or 0 if not found. May be NULL if you only need the presence and type.
+ * @param value_type_return Receives the Lua type of the stored value (LUA_TSTRING, LUA_TLIGHTUSERDATA, LUA_TNUMBER), or LUA_TNONE if not found. May be NULL.
+ * @return Returns true if the key was found.
+ *
+ * @note If the stored value is a different type than the one requested, this still returns true and value_type_return tells you what was actually stored.
+ * @see LuaHashMap_GetValueIntegerForKeyPointer, LuaHashMap_ExistsKeyPointer
  */
-LUAHASHMAP_EXPORT void LuaHashMap_Purge(LuaHashMap* hash_map);
+LUAHASHMAP_EXPORT bool LuaHashMap_TryGetValueIntegerForKeyPointer(LuaHashMap* hash_map, void* key_pointer, lua_Integer* value_integer_return, int* value_type_return);
 
+/* Key Number family */
 /**
- * Returns whether the hash table is empty or or not.
- * Returns whether the hash table is empty or or not.
- * @param hash_map The LuaHashMap instance to operate on. 
- * @return Returns true if the hash table is empty, otherwise false.
+ * Looks up a key and returns whether it was found along with its value.
+ * Looks up a key and returns whether it was found along with its value, using a single look up.
+ * Unlike LuaHashMap_GetValueStringForKeyNumber, this distinguishes a missing key from a stored NULL/empty string.
+ * <number, string> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_number The key for the value.
+ * @param value_string_return Receives the value for the key, or NULL if not found. May be NULL if you only need the presence and type.
+ * @param value_type_return Receives the Lua type of the stored value (LUA_TSTRING, LUA_TLIGHTUSERDATA, LUA_TNUMBER), or LUA_TNONE if not found. May be NULL.
+ * @return Returns true if the key was found.
+ *
+ * @note The returned value string is the Lua internalized pointer. It is only valid as long as the entry remains in the hash table.
+ *
+ * @note If the stored value is a different type than the one requested, this still returns true and value_type_return tells you what was actually stored.
+ * @see LuaHashMap_GetValueStringForKeyNumber, LuaHashMap_ExistsKeyNumber
  */
-LUAHASHMAP_EXPORT bool LuaHashMap_IsEmpty(LuaHashMap* hash_map);
-
-/** @} */ 
-
-
-
-/* Iterator functions */
-	
-/** @defgroup IteratorFamily Iterator family of functions
- *  @{
+LUAHASHMAP_EXPORT bool LuaHashMap_TryGetValueStringForKeyNumber(LuaHashMap* restrict hash_map, lua_Number key_number, const char** restrict value_string_return, int* restrict value_type_return);
+/**
+ * Looks up a key and returns whether it was found along with its value.
+ * Looks up a key and returns whether it was found along with its value, using a single look up.
+ * Unlike LuaHashMap_GetValueStringForKeyNumber, this distinguishes a missing key from a stored NULL/empty string.
+ * <number, string> version
+ * This version allows you to specify the string length of the value string back.
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_number The key for the value.
+ * @param value_string_return Receives the value for the key, or NULL if not found. May be NULL if you only need the presence and type.
+ * @param value_string_length_return Receives the string length of the value string (0 if not found). May be NULL.
+ * @param value_type_return Receives the Lua type of the stored value (LUA_TSTRING, LUA_TLIGHTUSERDATA, LUA_TNUMBER), or LUA_TNONE if not found. May be NULL.
+ * @return Returns true if the key was found.
+ *
+ * @note The returned value string is the Lua internalized pointer. It is only valid as long as the entry remains in the hash table.
+ *
+ * @note If the stored value is a different type than the one requested, this still returns true and value_type_return tells you what was actually stored.
+ * @see LuaHashMap_GetValueStringForKeyNumber, LuaHashMap_ExistsKeyNumber
  */
-
-
+LUAHASHMAP_EXPORT bool LuaHashMap_TryGetValueStringForKeyNumberWithLength(LuaHashMap* restrict hash_map, lua_Number key_number, const char** restrict value_string_return, size_t* restrict value_string_length_return, int* restrict value_type_return);
 /**
- * Returns an iterator at the start position of the hash table.
- * Returns an iterator at the start position of the hash table.
- * This is what you use if you are going to iterate through the entire collection.
+ * Looks up a key and returns whether it was found along with its value.
+ * Looks up a key and returns whether it was found along with its value, using a single look up.
+ * Unlike LuaHashMap_GetValuePointerForKeyNumber, this distinguishes a missing key from a stored NULL.
+ * <number, pointer> version
  *
- * @param hash_map The LuaHashMap instance to operate on. 
- * @return Returns an iterator at the start position of the hash table. If there is a failure, a "NotFound" iterator will be returned. Use LuaHashMap_IteratorIsNotFound to detect if the iterator is bad.
- * @see LuaHashMap_GetIteratorAtEnd, LuaHashMap_IteratorNext, LuaHashMap_IteratorIsNotFound
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_number The key for the value.
+ * @param value_pointer_return Receives the value for the key, or NULL if not found. May be NULL if you only need the presence and type.
+ * @param value_type_return Receives the Lua type of the stored value (LUA_TSTRING, LUA_TLIGHTUSERDATA, LUA_TNUMBER), or LUA_TNONE if not found. May be NULL.
+ * @return Returns true if the key was found.
+ *
+ * @note If the stored value is a different type than the one requested, this still returns true and value_type_return tells you what was actually stored.
+ * @see LuaHashMap_GetValuePointerForKeyNumber, LuaHashMap_ExistsKeyNumber
  */
-LUAHASHMAP_EXPORT LuaHashMapIterator LuaHashMap_GetIteratorAtBegin(LuaHashMap* hash_map);
+LUAHASHMAP_EXPORT bool LuaHashMap_TryGetValuePointerForKeyNumber(LuaHashMap* restrict hash_map, lua_Number key_number, void** restrict value_pointer_return, int* restrict value_type_return);
 /**
- * Returns an iterator at the end position of the hash table.
- * Returns an iterator at the end position of the hash table.
- * This is what you use if you are going to iterate through the entire collection.
+ * Looks up a key and returns whether it was found along with its value.
+ * Looks up a key and returns whether it was found along with its value, using a single look up.
+ * Unlike LuaHashMap_GetValueNumberForKeyNumber, this distinguishes a missing key from a stored 0.0.
+ * <number, number> version
  *
- * @param hash_map The LuaHashMap instance to operate on. 
- * @return Returns an iterator at the end position of the hash table. If there is a failure, a "NotFound" iterator will be returned. Use LuaHashMap_IteratorIsNotFound to detect if the iterator is bad.
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_number The key for the value.
+ * @param value_number_return Receives the value for the key, or 0.0 if not found. May be NULL if you only need the presence and type.
+ * @param value_type_return Receives the Lua type of the stored value (LUA_TSTRING, LUA_TLIGHTUSERDATA, LUA_TNUMBER), or LUA_TNONE if not found. May be NULL.
+ * @return Returns true if the key was found.
  *
- * @note The end iterator doesn't actually point to the last item in the collection. It is actually one item past the end. It is analgous to a null/termination character in a string. So don't try to get the key or value from the end iterator because it won't give you anything useful.
+ * @note If the stored value is a different type than the one requested, this still returns true and value_type_return tells you what was actually stored.
+ * @see LuaHashMap_GetValueNumberForKeyNumber, LuaHashMap_ExistsKeyNumber
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_TryGetValueNumberForKeyNumber(LuaHashMap* restrict hash_map, lua_Number key_number, lua_Number* restrict value_number_return, int* restrict value_type_return);
+/**
+ * Looks up a key and returns whether it was found along with its value.
+ * Looks up a key and returns whether it was found along with its value, using a single look up.
+ * Unlike LuaHashMap_GetValueIntegerForKeyNumber, this distinguishes a missing key from a stored 0.
+ * <number, integer> version
  *
-@code 	
-	for(LuaHashMapIterator hash_iterator = LuaHashMap_GetIteratorAtBegin(hash_map), hash_iterator_end = LuaHashMap_GetIteratorAtEnd(hash_map);
-		! LuaHashMap_IteratorIsEqual(&hash_iterator, &hash_iterator_end);
-		LuaHashMap_IteratorNext(&hash_iterator)
-	)
-	{
-		fprintf(stderr, "Price of %s: %lf\n", 
-				LuaHashMap_GetKeyStringAtIterator(&hash_iterator), 
-				LuaHashMap_GetCachedValueNumberAtIterator(&hash_iterator));
-	}
-@endcode
- * @see LuaHashMap_IteratorNext, LuaHashMap_GetIteratorAtBegin, LuaHashMap_IteratorIsNotFound, LuaHashMap_IteratorIsEqual
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_number The key for the value.
+ * @param value_integer_return Receives the value for the key, or 0 if not found. May be NULL if you only need the presence and type.
+ * @param value_type_return Receives the Lua type of the stored value (LUA_TSTRING, LUA_TLIGHTUSERDATA, LUA_TNUMBER), or LUA_TNONE if not found. May be NULL.
+ * @return Returns true if the key was found.
+ *
+ * @note If the stored value is a different type than the one requested, this still returns true and value_type_return tells you what was actually stored.
+ * @see LuaHashMap_GetValueIntegerForKeyNumber, LuaHashMap_ExistsKeyNumber
  */
-LUAHASHMAP_EXPORT LuaHashMapIterator LuaHashMap_GetIteratorAtEnd(LuaHashMap* hash_map);
-
+LUAHASHMAP_EXPORT bool LuaHashMap_TryGetValueIntegerForKeyNumber(LuaHashMap* restrict hash_map, lua_Number key_number, lua_Integer* restrict value_integer_return, int* restrict value_type_return);
 
+/* Key Integer family */
 /**
- * Increments the iterator to the next item in the hash table.
- * Increments the iterator to the next item in the hash table.
- * @param hash_iterator The LuaHashMapIterator instance to operate on. 
- * @return Returns true if the iterator successfully went to the next item. False otherwise. This can be useful to know when to stop looping in a control loop.
-@code
-	// This pattern is good if you know you have at least one item in the hash.
-	LuaHashMapIterator hash_iterator = LuaHashMap_GetIteratorAtBegin(hash_map);
-	do
-	{
-		fprintf(stderr, "Price of %s: %lf\n", 
-				LuaHashMap_GetKeyStringAtIterator(&hash_iterator), 
-				LuaHashMap_GetCachedValueNumberAtIterator(&hash_iterator));
-		
-	} while(LuaHashMap_IteratorNext(&hash_iterator));
-@endcode
- * @see LuaHashMap_GetIteratorAtEnd, LuaHashMap_GetIteratorAtBegin, LuaHashMap_IteratorIsNotFound
+ * Looks up a key and returns whether it was found along with its value.
+ * Looks up a key and returns whether it was found along with its value, using a single look up.
+ * Unlike LuaHashMap_GetValueStringForKeyInteger, this distinguishes a missing key from a stored NULL/empty string.
+ * <integer, string> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_integer The key for the value.
+ * @param value_string_return Receives the value for the key, or NULL if not found. May be NULL if you only need the presence and type.
+ * @param value_type_return Receives the Lua type of the stored value (LUA_TSTRING, LUA_TLIGHTUSERDATA, LUA_TNUMBER), or LUA_TNONE if not found. May be NULL.
+ * @return Returns true if the key was found.
+ *
+ * @note The returned value string is the Lua internalized pointer. It is only valid as long as the entry remains in the hash table.
+ *
+ * @note If the stored value is a different type than the one requested, this still returns true and value_type_return tells you what was actually stored.
+ * @see LuaHashMap_GetValueStringForKeyInteger, LuaHashMap_ExistsKeyInteger
  */
-LUAHASHMAP_EXPORT bool LuaHashMap_IteratorNext(LuaHashMapIterator* hash_iterator);
-
+LUAHASHMAP_EXPORT bool LuaHashMap_TryGetValueStringForKeyInteger(LuaHashMap* restrict hash_map, lua_Integer key_integer, const char** restrict value_string_return, int* restrict value_type_return);
 /**
- * Returns an iterator corresponding to the specified key.
- * This returns an iterator corresponding to the specified key. 
- * string version
- * 
- * The intent of this method is to allow you to do multiple operations at the current position without doing unnecessary additional hash look ups.
- * The most common example is you want to test to see if a key/value pair actually exists in the hash table before trying to retrive the value.
- * Using the GetIteratorForKey function, you do one hash lookup, and then you can test existence and extract the CachedValue from the iterator without any subsequent hash look ups.
+ * Looks up a key and returns whether it was found along with its value.
+ * Looks up a key and returns whether it was found along with its value, using a single look up.
+ * Unlike LuaHashMap_GetValueStringForKeyInteger, this distinguishes a missing key from a stored NULL/empty string.
+ * <integer, string> version
+ * This version allows you to specify the string length of the value string back.
  *
- * @param hash_map The LuaHashMap instance to operate on
- * @param key_string The key for the key/value pair
- * @return Returns an iterator at the position of the specified key. If there is a failure, a "NotFound" iterator will be returned. Use LuaHashMap_IteratorIsNotFound to detect if the iterator is bad.
- * 
- @code
-	// This is the one hash look up.
-	LuaHashMapIterator hash_iterator = LuaHashMap_GetIteratorForKeyString(hash_map, "foo");
-	// Thie remaining information is in the iterator itself which avoids another hash lookup.
-	bool exists = LuaHashMap_ExistsAtIterator(&hash_iterator);
-	if(exists)
-	{
-		fprintf(stderr, "The value for key="foo" exists: %lf\n", LuaHashMap_GetCachedValueNumberAtIterator(&hash_iterator));
-	}
-	else
-	{
-		fprintf(stderr, "The key/value pair for key="foo" does not exist\n");
-	}
-@endcode
- * @see LuaHashMap_ExistsAtIterator, LuaHashMap_GetIteratorAtBegin, LuaHashMap_IteratorIsNotFound, LuaHashMap_GetIteratorForKeyStringWithLength
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_integer The key for the value.
+ * @param value_string_return Receives the value for the key, or NULL if not found. May be NULL if you only need the presence and type.
+ * @param value_string_length_return Receives the string length of the value string (0 if not found). May be NULL.
+ * @param value_type_return Receives the Lua type of the stored value (LUA_TSTRING, LUA_TLIGHTUSERDATA, LUA_TNUMBER), or LUA_TNONE if not found. May be NULL.
+ * @return Returns true if the key was found.
+ *
+ * @note The returned value string is the Lua internalized pointer. It is only valid as long as the entry remains in the hash table.
+ *
+ * @note If the stored value is a different type than the one requested, this still returns true and value_type_return tells you what was actually stored.
+ * @see LuaHashMap_GetValueStringForKeyInteger, LuaHashMap_ExistsKeyInteger
  */
-LUAHASHMAP_EXPORT LuaHashMapIterator LuaHashMap_GetIteratorForKeyString(LuaHashMap* restrict hash_map, const char* restrict key_string);
+LUAHASHMAP_EXPORT bool LuaHashMap_TryGetValueStringForKeyIntegerWithLength(LuaHashMap* restrict hash_map, lua_Integer key_integer, const char** restrict value_string_return, size_t* restrict value_string_length_return, int* restrict value_type_return);
 /**
- * Returns an iterator corresponding to the specified key.
- * This returns an iterator corresponding to the specified key. 
- * string version
- * This version allows you to specify the string length for the string if you already know it as an optimization.
- * 
- * The intent of this method is to allow you to do multiple operations at the current position without doing unnecessary additional hash look ups.
- * The most common example is you want to test to see if a key/value pair actually exists in the hash table before trying to retrive the value.
- * Using the GetIteratorForKey function, you do one hash lookup, and then you can test existence and extract the CachedValue from the iterator without any subsequent hash look ups.
+ * Looks up a key and returns whether it was found along with its value.
+ * Looks up a key and returns whether it was found along with its value, using a single look up.
+ * Unlike LuaHashMap_GetValuePointerForKeyInteger, this distinguishes a missing key from a stored NULL.
+ * <integer, pointer> version
  *
- * @param hash_map The LuaHashMap instance to operate on
- * @param key_string The key for the key/value pair
- * @param key_string_length The string length (strlen()) of the key string. (This does not count the \0 terminator character.)
- * @return Returns an iterator at the position of the specified key. If there is a failure, a "NotFound" iterator will be returned. Use LuaHashMap_IteratorIsNotFound to detect if the iterator is bad.
- * 
- @code
-	// This is the one hash look up.
-	size_t key_string_length;
-	LuaHashMapIterator hash_iterator = LuaHashMap_GetIteratorForKeyStringWithLength(hash_map, "foo", &key_string_length);
-	bool exists = LuaHashMap_ExistsAtIterator(&hash_iterator);
-	// This information is in the iterator itself which avoids another hash lookup.
-	if(exists)
-	{
-		fprintf(stderr, "The value for key="foo" exists: %lf\n", LuaHashMap_GetCachedValueNumberAtIterator(&hash_iterator));
-	}
-	else
-	{
-		fprintf(stderr, "The key/value pair for key="foo" does not exist\n");
-	}
-@endcode
- * @see LuaHashMap_ExistsAtIterator, LuaHashMap_GetIteratorAtBegin, LuaHashMap_IteratorIsNotFound, LuaHashMap_GetIteratorForKeyString
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_integer The key for the value.
+ * @param value_pointer_return Receives the value for the key, or NULL if not found. May be NULL if you only need the presence and type.
+ * @param value_type_return Receives the Lua type of the stored value (LUA_TSTRING, LUA_TLIGHTUSERDATA, LUA_TNUMBER), or LUA_TNONE if not found. May be NULL.
+ * @return Returns true if the key was found.
+ *
+ * @note If the stored value is a different type than the one requested, this still returns true and value_type_return tells you what was actually stored.
+ * @see LuaHashMap_GetValuePointerForKeyInteger, LuaHashMap_ExistsKeyInteger
  */
-LUAHASHMAP_EXPORT LuaHashMapIterator LuaHashMap_GetIteratorForKeyStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length);
+LUAHASHMAP_EXPORT bool LuaHashMap_TryGetValuePointerForKeyInteger(LuaHashMap* restrict hash_map, lua_Integer key_integer, void** restrict value_pointer_return, int* restrict value_type_return);
 /**
- * Returns an iterator corresponding to the specified key.
- * This returns an iterator corresponding to the specified key. 
- * pointer version
- * 
- * The intent of this method is to allow you to do multiple operations at the current position without doing unnecessary additional hash look ups.
- * The most common example is you want to test to see if a key/value pair actually exists in the hash table before trying to retrive the value.
- * Using the GetIteratorForKey function, you do one hash lookup, and then you can test existence and extract the CachedValue from the iterator without any subsequent hash look ups.
+ * Looks up a key and returns whether it was found along with its value.
+ * Looks up a key and returns whether it was found along with its value, using a single look up.
+ * Unlike LuaHashMap_GetValueNumberForKeyInteger, this distinguishes a missing key from a stored 0.0.
+ * <integer, number> version
  *
- * @param hash_map The LuaHashMap instance to operate on
- * @param key_pointer The key for the key/value pair
- * @return Returns an iterator at the position of the specified key. If there is a failure, a "NotFound" iterator will be returned. Use LuaHashMap_IteratorIsNotFound to detect if the iterator is bad.
- * 
- @code
-	// This is the one hash look up.
-	LuaHashMapIterator hash_iterator = LuaHashMap_GetIteratorForKeyPointer(hash_map, fooptr);
-	bool exists = LuaHashMap_ExistsAtIterator(&hash_iterator);
-	// This information is in the iterator itself which avoids another hash lookup.
-	if(exists)
-	{
-		fprintf(stderr, "The value for key=fooptr exists: %lf\n", LuaHashMap_GetCachedValueNumberAtIterator(&hash_iterator));
-	}
-	else
-	{
-		fprintf(stderr, "The key/value pair for key=fooptr does not exist\n");
-	}
-@endcode
- * @see LuaHashMap_ExistsAtIterator, LuaHashMap_GetIteratorAtBegin, LuaHashMap_IteratorIsNotFound
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_integer The key for the value.
+ * @param value_number_return Receives the value for the key, or 0.0 if not found. May be NULL if you only need the presence and type.
+ * @param value_type_return Receives the Lua type of the stored value (LUA_TSTRING, LUA_TLIGHTUSERDATA, LUA_TNUMBER), or LUA_TNONE if not found. May be NULL.
+ * @return Returns true if the key was found.
+ *
+ * @note If the stored value is a different type than the one requested, this still returns true and value_type_return tells you what was actually stored.
+ * @see LuaHashMap_GetValueNumberForKeyInteger, LuaHashMap_ExistsKeyInteger
  */
-LUAHASHMAP_EXPORT LuaHashMapIterator LuaHashMap_GetIteratorForKeyPointer(LuaHashMap* hash_map, void* key_pointer);
+LUAHASHMAP_EXPORT bool LuaHashMap_TryGetValueNumberForKeyInteger(LuaHashMap* restrict hash_map, lua_Integer key_integer, lua_Number* restrict value_number_return, int* restrict value_type_return);
 /**
- * Returns an iterator corresponding to the specified key.
- * This returns an iterator corresponding to the specified key. 
- * number version
- * 
- * The intent of this method is to allow you to do multiple operations at the current position without doing unnecessary additional hash look ups.
- * The most common example is you want to test to see if a key/value pair actually exists in the hash table before trying to retrive the value.
- * Using the GetIteratorForKey function, you do one hash lookup, and then you can test existence and extract the CachedValue from the iterator without any subsequent hash look ups.
+ * Looks up a key and returns whether it was found along with its value.
+ * Looks up a key and returns whether it was found along with its value, using a single look up.
+ * Unlike LuaHashMap_GetValueIntegerForKeyInteger, this distinguishes a missing key from a stored 0.
+ * <integer, integer> version
  *
- * @param hash_map The LuaHashMap instance to operate on
- * @param key_number The key for the key/value pair
- * @return Returns an iterator at the position of the specified key. If there is a failure, a "NotFound" iterator will be returned. Use LuaHashMap_IteratorIsNotFound to detect if the iterator is bad.
- * 
- @code
-	// This is the one hash look up.
-	LuaHashMapIterator hash_iterator = LuaHashMap_GetIteratorForKeyPointer(hash_map, fooptr);
-	bool exists = LuaHashMap_ExistsAtIterator(&hash_iterator);
-	// This information is in the iterator itself which avoids another hash lookup.
-	if(exists)
-	{
-		fprintf(stderr, "The value for key=fooptr exists: %lf\n", LuaHashMap_GetCachedValueNumberAtIterator(&hash_iterator));
-	}
-	else
-	{
-		fprintf(stderr, "The key/value pair for key=fooptr does not exist\n");
-	}
-@endcode
- * @see LuaHashMap_ExistsAtIterator, LuaHashMap_GetIteratorAtBegin, LuaHashMap_IteratorIsNotFound
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_integer The key for the value.
+ * @param value_integer_return Receives the value for the key, or 0 if not found. May be NULL if you only need the presence and type.
+ * @param value_type_return Receives the Lua type of the stored value (LUA_TSTRING, LUA_TLIGHTUSERDATA, LUA_TNUMBER), or LUA_TNONE if not found. May be NULL.
+ * @return Returns true if the key was found.
+ *
+ * @note If the stored value is a different type than the one requested, this still returns true and value_type_return tells you what was actually stored.
+ * @see LuaHashMap_GetValueIntegerForKeyInteger, LuaHashMap_ExistsKeyInteger
  */
-LUAHASHMAP_EXPORT LuaHashMapIterator LuaHashMap_GetIteratorForKeyNumber(LuaHashMap* hash_map, lua_Number key_number);
+LUAHASHMAP_EXPORT bool LuaHashMap_TryGetValueIntegerForKeyInteger(LuaHashMap* restrict hash_map, lua_Integer key_integer, lua_Integer* restrict value_integer_return, int* restrict value_type_return);
+
+/** @} */
+
+/** @defgroup GetValuesForKeysFamily GetValuesForKeys (batch) family of functions
+ *  @{
+ */
+
 /**
- * Returns an iterator corresponding to the specified key.
- * This returns an iterator corresponding to the specified key. 
- * integer version
- * 
- * The intent of this method is to allow you to do multiple operations at the current position without doing unnecessary additional hash look ups.
- * The most common example is you want to test to see if a key/value pair actually exists in the hash table before trying to retrive the value.
- * Using the GetIteratorForKey function, you do one hash lookup, and then you can test existence and extract the CachedValue from the iterator without any subsequent hash look ups.
+ * Returns the number of bytes needed for a found_bitmap holding number_of_elements bits.
+ */
+#define LUAHASHMAP_BITMAP_SIZE(number_of_elements) (((number_of_elements)+7)/8)
+/**
+ * Returns non-zero if bit bit_index is set in a found_bitmap filled by the batch Get/Exists functions.
+ */
+#define LUAHASHMAP_BITMAP_ISSET(found_bitmap, bit_index) (((found_bitmap)[(bit_index)/8] >> ((bit_index)%8)) & 1)
+
+/**
+ * Returns the values for multiple keys in the hash table in a single batch.
+ * Returns the values for multiple keys in the hash table in a single batch. The table is fetched only once for the whole batch which avoids the per-call overhead of LuaHashMap_GetValueStringForKeyString.
+ * <string, string> version
  *
- * @param hash_map The LuaHashMap instance to operate on
- * @param key_integer The key for the key/value pair
- * @return Returns an iterator at the position of the specified key. If there is a failure, a "NotFound" iterator will be returned. Use LuaHashMap_IteratorIsNotFound to detect if the iterator is bad.
- * 
- @code
-	// This is the one hash look up.
-	LuaHashMapIterator hash_iterator = LuaHashMap_GetIteratorForKeyPointer(hash_map, fooptr);
-	bool exists = LuaHashMap_ExistsAtIterator(&hash_iterator);
-	// This information is in the iterator itself which avoids another hash lookup.
-	if(exists)
-	{
-		fprintf(stderr, "The value for key=fooptr exists: %lf\n", LuaHashMap_GetCachedValueNumberAtIterator(&hash_iterator));
-	}
-	else
-	{
-		fprintf(stderr, "The key/value pair for key=fooptr does not exist\n");
-	}
-@endcode
- * @see LuaHashMap_ExistsAtIterator, LuaHashMap_GetIteratorAtBegin, LuaHashMap_IteratorIsNotFound
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param values_array The output array which receives the values. values_array[i] is the value for keys_array[i], or NULL if not found.
+ * @param keys_array The array of keys to look up. NULL key strings disallowed and those elements will simply be reported as not found.
+ * @param value_lengths_array Optional output array which receives the string length of each value string (0 if not found). May be NULL.
+ * @param key_lengths_array Optional array of string lengths (strlen()) for each key string. (This does not count the \0 terminator character.) Pass NULL to have strlen() computed for you.
+ * @param found_bitmap Optional bitmap which must hold at least LUAHASHMAP_BITMAP_SIZE(number_of_elements) bytes. Bit i is set if keys_array[i] was found and cleared otherwise. Use LUAHASHMAP_BITMAP_ISSET to query. May be NULL.
+ * @param number_of_elements The number of elements in the arrays.
+ * @return Returns the number of keys that were found.
+ *
+ * @note The returned value strings are the Lua internalized pointers. They are only valid as long as the entries remain in the hash table.
+ * Values that aren't strings (e.g. numbers) come back as NULL with length 0, though they still count as found. Unlike LuaHashMap_GetValueStringForKeyString, numbers are not converted, since the converted string would not outlive the batch.
+ * @see LuaHashMap_GetValueStringForKeyString, LuaHashMap_ExistsKeysString
+ */
+LUAHASHMAP_EXPORT size_t LuaHashMap_GetValuesStringForKeysString(LuaHashMap* hash_map, const char* values_array[], const char* keys_array[], size_t value_lengths_array[], const size_t key_lengths_array[], unsigned char found_bitmap[], size_t number_of_elements);
+/**
+ * Returns the values for multiple keys in the hash table in a single batch.
+ * Returns the values for multiple keys in the hash table in a single batch. The table is fetched only once for the whole batch which avoids the per-call overhead of LuaHashMap_GetValuePointerForKeyString.
+ * <string, pointer> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param values_array The output array which receives the values. values_array[i] is the value for keys_array[i], or NULL if not found.
+ * @param keys_array The array of keys to look up. NULL key strings disallowed and those elements will simply be reported as not found.
+ * @param key_lengths_array Optional array of string lengths (strlen()) for each key string. (This does not count the \0 terminator character.) Pass NULL to have strlen() computed for you.
+ * @param found_bitmap Optional bitmap which must hold at least LUAHASHMAP_BITMAP_SIZE(number_of_elements) bytes. Bit i is set if keys_array[i] was found and cleared otherwise. Use LUAHASHMAP_BITMAP_ISSET to query. May be NULL.
+ * @param number_of_elements The number of elements in the arrays.
+ * @return Returns the number of keys that were found.
+ * @see LuaHashMap_GetValuePointerForKeyString, LuaHashMap_ExistsKeysString
+ */
+LUAHASHMAP_EXPORT size_t LuaHashMap_GetValuesPointerForKeysString(LuaHashMap* hash_map, void* values_array[], const char* keys_array[], const size_t key_lengths_array[], unsigned char found_bitmap[], size_t number_of_elements);
+/**
+ * Returns the values for multiple keys in the hash table in a single batch.
+ * Returns the values for multiple keys in the hash table in a single batch. The table is fetched only once for the whole batch which avoids the per-call overhead of LuaHashMap_GetValueNumberForKeyString.
+ * <string, number> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param values_array The output array which receives the values. values_array[i] is the value for keys_array[i], or 0.0 if not found.
+ * @param keys_array The array of keys to look up. NULL key strings disallowed and those elements will simply be reported as not found.
+ * @param key_lengths_array Optional array of string lengths (strlen()) for each key string. (This does not count the \0 terminator character.) Pass NULL to have strlen() computed for you.
+ * @param found_bitmap Optional bitmap which must hold at least LUAHASHMAP_BITMAP_SIZE(number_of_elements) bytes. Bit i is set if keys_array[i] was found and cleared otherwise. Use LUAHASHMAP_BITMAP_ISSET to query. May be NULL.
+ * @param number_of_elements The number of elements in the arrays.
+ * @return Returns the number of keys that were found.
+ * @see LuaHashMap_GetValueNumberForKeyString, LuaHashMap_ExistsKeysString
+ */
+LUAHASHMAP_EXPORT size_t LuaHashMap_GetValuesNumberForKeysString(LuaHashMap* hash_map, lua_Number values_array[], const char* keys_array[], const size_t key_lengths_array[], unsigned char found_bitmap[], size_t number_of_elements);
+/**
+ * Returns the values for multiple keys in the hash table in a single batch.
+ * Returns the values for multiple keys in the hash table in a single batch. The table is fetched only once for the whole batch which avoids the per-call overhead of LuaHashMap_GetValueIntegerForKeyString.
+ * <string, integer> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param values_array The output array which receives the values. values_array[i] is the value for keys_array[i], or 0 if not found.
+ * @param keys_array The array of keys to look up. NULL key strings disallowed and those elements will simply be reported as not found.
+ * @param key_lengths_array Optional array of string lengths (strlen()) for each key string. (This does not count the \0 terminator character.) Pass NULL to have strlen() computed for you.
+ * @param found_bitmap Optional bitmap which must hold at least LUAHASHMAP_BITMAP_SIZE(number_of_elements) bytes. Bit i is set if keys_array[i] was found and cleared otherwise. Use LUAHASHMAP_BITMAP_ISSET to query. May be NULL.
+ * @param number_of_elements The number of elements in the arrays.
+ * @return Returns the number of keys that were found.
+ * @see LuaHashMap_GetValueIntegerForKeyString, LuaHashMap_ExistsKeysString
+ */
+LUAHASHMAP_EXPORT size_t LuaHashMap_GetValuesIntegerForKeysString(LuaHashMap* hash_map, lua_Integer values_array[], const char* keys_array[], const size_t key_lengths_array[], unsigned char found_bitmap[], size_t number_of_elements);
+/**
+ * Returns the values for multiple keys in the hash table in a single batch.
+ * Returns the values for multiple keys in the hash table in a single batch. The table is fetched only once for the whole batch which avoids the per-call overhead of LuaHashMap_GetValueStringForKeyPointer.
+ * <pointer, string> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param values_array The output array which receives the values. values_array[i] is the value for keys_array[i], or NULL if not found.
+ * @param keys_array The array of keys to look up.
+ * @param value_lengths_array Optional output array which receives the string length of each value string (0 if not found). May be NULL.
+ * @param found_bitmap Optional bitmap which must hold at least LUAHASHMAP_BITMAP_SIZE(number_of_elements) bytes. Bit i is set if keys_array[i] was found and cleared otherwise. Use LUAHASHMAP_BITMAP_ISSET to query. May be NULL.
+ * @param number_of_elements The number of elements in the arrays.
+ * @return Returns the number of keys that were found.
+ *
+ * @note The returned value strings are the Lua internalized pointers. They are only valid as long as the entries remain in the hash table.
+ * Values that aren't strings (e.g. numbers) come back as NULL with length 0, though they still count as found. Unlike LuaHashMap_GetValueStringForKeyString, numbers are not converted, since the converted string would not outlive the batch.
+ * @see LuaHashMap_GetValueStringForKeyPointer, LuaHashMap_ExistsKeysPointer
  */
-LUAHASHMAP_EXPORT LuaHashMapIterator LuaHashMap_GetIteratorForKeyInteger(LuaHashMap* hash_map, lua_Integer key_integer);
-
-#if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 199901L)
-/* Use the C99 inline if available to hint the compiler that this might benefit from inlining. 
- * Since these functions are merely pulling data out of an already exposed struct, inlining seems reasonable.
+LUAHASHMAP_EXPORT size_t LuaHashMap_GetValuesStringForKeysPointer(LuaHashMap* hash_map, const char* values_array[], void* keys_array[], size_t value_lengths_array[], unsigned char found_bitmap[], size_t number_of_elements);
+/**
+ * Returns the values for multiple keys in the hash table in a single batch.
+ * Returns the values for multiple keys in the hash table in a single batch. The table is fetched only once for the whole batch which avoids the per-call overhead of LuaHashMap_GetValuePointerForKeyPointer.
+ * <pointer, pointer> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param values_array The output array which receives the values. values_array[i] is the value for keys_array[i], or NULL if not found.
+ * @param keys_array The array of keys to look up.
+ * @param found_bitmap Optional bitmap which must hold at least LUAHASHMAP_BITMAP_SIZE(number_of_elements) bytes. Bit i is set if keys_array[i] was found and cleared otherwise. Use LUAHASHMAP_BITMAP_ISSET to query. May be NULL.
+ * @param number_of_elements The number of elements in the arrays.
+ * @return Returns the number of keys that were found.
+ * @see LuaHashMap_GetValuePointerForKeyPointer, LuaHashMap_ExistsKeysPointer
  */
+LUAHASHMAP_EXPORT size_t LuaHashMap_GetValuesPointerForKeysPointer(LuaHashMap* hash_map, void* values_array[], void* keys_array[], unsigned char found_bitmap[], size_t number_of_elements);
 /**
- * Returns true if the iterator is "NotFound".
- * Returns true if the iterator is bad (i.e. you tried to get an iterator for a key that doesn't exist). 
+ * Returns the values for multiple keys in the hash table in a single batch.
+ * Returns the values for multiple keys in the hash table in a single batch. The table is fetched only once for the whole batch which avoids the per-call overhead of LuaHashMap_GetValueNumberForKeyPointer.
+ * <pointer, number> version
  *
- * @param hash_iterator The LuaHashMapIterator instance to operate on. 
- * @return Returns true if the iterator is "NotFound" or bad.
- * @note End iterators are considered valid iterators and this function will return false on this case.
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param values_array The output array which receives the values. values_array[i] is the value for keys_array[i], or 0.0 if not found.
+ * @param keys_array The array of keys to look up.
+ * @param found_bitmap Optional bitmap which must hold at least LUAHASHMAP_BITMAP_SIZE(number_of_elements) bytes. Bit i is set if keys_array[i] was found and cleared otherwise. Use LUAHASHMAP_BITMAP_ISSET to query. May be NULL.
+ * @param number_of_elements The number of elements in the arrays.
+ * @return Returns the number of keys that were found.
+ * @see LuaHashMap_GetValueNumberForKeyPointer, LuaHashMap_ExistsKeysPointer
  */
-LUAHASHMAP_EXPORT inline bool LuaHashMap_IteratorIsNotFound(const LuaHashMapIterator* hash_iterator)
-{
-	if(NULL == hash_iterator)
-	{
-		return true;
-	}
-	/* To make this distinct from a good iterator and an end iterator, whichTable==LUA_NOREF seems to be the only unique characteristic. */
-	if(LUA_NOREF == hash_iterator->whichTable)
-	{
-		return true;
-	}
-	else
-	{
-		return false;		
-	}
-}
-#else /* We are not using C99 inline so the standard declaration is here. */
+LUAHASHMAP_EXPORT size_t LuaHashMap_GetValuesNumberForKeysPointer(LuaHashMap* hash_map, lua_Number values_array[], void* keys_array[], unsigned char found_bitmap[], size_t number_of_elements);
 /**
- * Returns true if the iterator is "NotFound".
- * Returns true if the iterator is bad (i.e. you tried to get an iterator for a key that doesn't exist). 
+ * Returns the values for multiple keys in the hash table in a single batch.
+ * Returns the values for multiple keys in the hash table in a single batch. The table is fetched only once for the whole batch which avoids the per-call overhead of LuaHashMap_GetValueIntegerForKeyPointer.
+ * <pointer, integer> version
  *
- * @param hash_iterator The LuaHashMapIterator instance to operate on. 
- * @return Returns true if the iterator is "NotFound" or bad.
- * @note End iterators are considered valid iterators and this function will return false on this case.
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param values_array The output array which receives the values. values_array[i] is the value for keys_array[i], or 0 if not found.
+ * @param keys_array The array of keys to look up.
+ * @param found_bitmap Optional bitmap which must hold at least LUAHASHMAP_BITMAP_SIZE(number_of_elements) bytes. Bit i is set if keys_array[i] was found and cleared otherwise. Use LUAHASHMAP_BITMAP_ISSET to query. May be NULL.
+ * @param number_of_elements The number of elements in the arrays.
+ * @return Returns the number of keys that were found.
+ * @see LuaHashMap_GetValueIntegerForKeyPointer, LuaHashMap_ExistsKeysPointer
  */
-LUAHASHMAP_EXPORT bool LuaHashMap_IteratorIsNotFound(const LuaHashMapIterator* hash_iterator);
-#endif /* defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 199901L) */
-
+LUAHASHMAP_EXPORT size_t LuaHashMap_GetValuesIntegerForKeysPointer(LuaHashMap* hash_map, lua_Integer values_array[], void* keys_array[], unsigned char found_bitmap[], size_t number_of_elements);
 /**
- * Returns true if two iterators are equal.
- * Returns true if two iterators are equal.
- * This generally means they are pointing to the same key/value pair in the same hash table.
+ * Returns the values for multiple keys in the hash table in a single batch.
+ * Returns the values for multiple keys in the hash table in a single batch. The table is fetched only once for the whole batch which avoids the per-call overhead of LuaHashMap_GetValueStringForKeyNumber.
+ * <number, string> version
  *
- * @param hash_iterator1 The first iterator that will be compared.
- * @param hash_iterator2 The other iterator that will be compared.
- * @return Returns true if the iterators are equal.
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param values_array The output array which receives the values. values_array[i] is the value for keys_array[i], or NULL if not found.
+ * @param keys_array The array of keys to look up.
+ * @param value_lengths_array Optional output array which receives the string length of each value string (0 if not found). May be NULL.
+ * @param found_bitmap Optional bitmap which must hold at least LUAHASHMAP_BITMAP_SIZE(number_of_elements) bytes. Bit i is set if keys_array[i] was found and cleared otherwise. Use LUAHASHMAP_BITMAP_ISSET to query. May be NULL.
+ * @param number_of_elements The number of elements in the arrays.
+ * @return Returns the number of keys that were found.
+ *
+ * @note The returned value strings are the Lua internalized pointers. They are only valid as long as the entries remain in the hash table.
+ * Values that aren't strings (e.g. numbers) come back as NULL with length 0, though they still count as found. Unlike LuaHashMap_GetValueStringForKeyString, numbers are not converted, since the converted string would not outlive the batch.
+ * @see LuaHashMap_GetValueStringForKeyNumber, LuaHashMap_ExistsKeysNumber
  */
-LUAHASHMAP_EXPORT bool LuaHashMap_IteratorIsEqual(const LuaHashMapIterator* hash_iterator1, const LuaHashMapIterator* hash_iterator2);
-
-
-/* SetValueAtIterator family */
+LUAHASHMAP_EXPORT size_t LuaHashMap_GetValuesStringForKeysNumber(LuaHashMap* hash_map, const char* values_array[], const lua_Number keys_array[], size_t value_lengths_array[], unsigned char found_bitmap[], size_t number_of_elements);
 /**
- * Updates a value in the hash table pointed to by the iterator.
- * Updates a value in the hash table pointed to by the iterator.
- * The iterator must be a valid iterator (i.e. the key it points to must already be in the hash table).
- * This will not insert new key/value pairs into the hash table.
- * string version
+ * Returns the values for multiple keys in the hash table in a single batch.
+ * Returns the values for multiple keys in the hash table in a single batch. The table is fetched only once for the whole batch which avoids the per-call overhead of LuaHashMap_GetValuePointerForKeyNumber.
+ * <number, pointer> version
  *
- * @param hash_iterator The LuaHashMapIterator instance pointing to the key/value pair you want to update the value to.
- * @param value_string The value for the key. NULL value strings are treated as strings with length=0 ("").
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param values_array The output array which receives the values. values_array[i] is the value for keys_array[i], or NULL if not found.
+ * @param keys_array The array of keys to look up.
+ * @param found_bitmap Optional bitmap which must hold at least LUAHASHMAP_BITMAP_SIZE(number_of_elements) bytes. Bit i is set if keys_array[i] was found and cleared otherwise. Use LUAHASHMAP_BITMAP_ISSET to query. May be NULL.
+ * @param number_of_elements The number of elements in the arrays.
+ * @return Returns the number of keys that were found.
+ * @see LuaHashMap_GetValuePointerForKeyNumber, LuaHashMap_ExistsKeysNumber
+ */
+LUAHASHMAP_EXPORT size_t LuaHashMap_GetValuesPointerForKeysNumber(LuaHashMap* hash_map, void* values_array[], const lua_Number keys_array[], unsigned char found_bitmap[], size_t number_of_elements);
+/**
+ * Returns the values for multiple keys in the hash table in a single batch.
+ * Returns the values for multiple keys in the hash table in a single batch. The table is fetched only once for the whole batch which avoids the per-call overhead of LuaHashMap_GetValueNumberForKeyNumber.
+ * <number, number> version
  *
- * @note Lua copies strings and internalizes them. This means Lua/LuaHashMap have its own copy of the string and you are free to delete your string if you are done with it.
- * @see LuaHashMap_SetValueStringAtIteratorWithLength
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param values_array The output array which receives the values. values_array[i] is the value for keys_array[i], or 0.0 if not found.
+ * @param keys_array The array of keys to look up.
+ * @param found_bitmap Optional bitmap which must hold at least LUAHASHMAP_BITMAP_SIZE(number_of_elements) bytes. Bit i is set if keys_array[i] was found and cleared otherwise. Use LUAHASHMAP_BITMAP_ISSET to query. May be NULL.
+ * @param number_of_elements The number of elements in the arrays.
+ * @return Returns the number of keys that were found.
+ * @see LuaHashMap_GetValueNumberForKeyNumber, LuaHashMap_ExistsKeysNumber
  */
-LUAHASHMAP_EXPORT void LuaHashMap_SetValueStringAtIterator(LuaHashMapIterator* restrict hash_iterator, const char* restrict value_string);
+LUAHASHMAP_EXPORT size_t LuaHashMap_GetValuesNumberForKeysNumber(LuaHashMap* hash_map, lua_Number values_array[], const lua_Number keys_array[], unsigned char found_bitmap[], size_t number_of_elements);
 /**
- * Updates a value in the hash table pointed to by the iterator.
- * Updates a value in the hash table pointed to by the iterator.
- * The iterator must be a valid iterator (i.e. the key it points to must already be in the hash table).
- * This will not insert new key/value pairs into the hash table.
- * string version
- * This version allows you to specify the string length for each string if you already know it as an optimization.
+ * Returns the values for multiple keys in the hash table in a single batch.
+ * Returns the values for multiple keys in the hash table in a single batch. The table is fetched only once for the whole batch which avoids the per-call overhead of LuaHashMap_GetValueIntegerForKeyNumber.
+ * <number, integer> version
  *
- * @param hash_iterator The LuaHashMapIterator instance pointing to the key/value pair you want to update the value to.
- * @param value_string The value for the key. NULL value strings are treated as strings with length=0 ("").
- * @param value_string_length The string length (strlen()) of the value string. (This does not count the \0 terminator character.)
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param values_array The output array which receives the values. values_array[i] is the value for keys_array[i], or 0 if not found.
+ * @param keys_array The array of keys to look up.
+ * @param found_bitmap Optional bitmap which must hold at least LUAHASHMAP_BITMAP_SIZE(number_of_elements) bytes. Bit i is set if keys_array[i] was found and cleared otherwise. Use LUAHASHMAP_BITMAP_ISSET to query. May be NULL.
+ * @param number_of_elements The number of elements in the arrays.
+ * @return Returns the number of keys that were found.
+ * @see LuaHashMap_GetValueIntegerForKeyNumber, LuaHashMap_ExistsKeysNumber
+ */
+LUAHASHMAP_EXPORT size_t LuaHashMap_GetValuesIntegerForKeysNumber(LuaHashMap* hash_map, lua_Integer values_array[], const lua_Number keys_array[], unsigned char found_bitmap[], size_t number_of_elements);
+/**
+ * Returns the values for multiple keys in the hash table in a single batch.
+ * Returns the values for multiple keys in the hash table in a single batch. The table is fetched only once for the whole batch which avoids the per-call overhead of LuaHashMap_GetValueStringForKeyInteger.
+ * <integer, string> version
  *
- * @note Lua copies strings and internalizes them. This means Lua/LuaHashMap have its own copy of the string and you are free to delete your string if you are done with it.
- * @see LuaHashMap_SetValueStringAtIterator
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param values_array The output array which receives the values. values_array[i] is the value for keys_array[i], or NULL if not found.
+ * @param keys_array The array of keys to look up.
+ * @param value_lengths_array Optional output array which receives the string length of each value string (0 if not found). May be NULL.
+ * @param found_bitmap Optional bitmap which must hold at least LUAHASHMAP_BITMAP_SIZE(number_of_elements) bytes. Bit i is set if keys_array[i] was found and cleared otherwise. Use LUAHASHMAP_BITMAP_ISSET to query. May be NULL.
+ * @param number_of_elements The number of elements in the arrays.
+ * @return Returns the number of keys that were found.
+ *
+ * @note The returned value strings are the Lua internalized pointers. They are only valid as long as the entries remain in the hash table.
+ * Values that aren't strings (e.g. numbers) come back as NULL with length 0, though they still count as found. Unlike LuaHashMap_GetValueStringForKeyString, numbers are not converted, since the converted string would not outlive the batch.
+ * @see LuaHashMap_GetValueStringForKeyInteger, LuaHashMap_ExistsKeysInteger
  */
-LUAHASHMAP_EXPORT void LuaHashMap_SetValueStringAtIteratorWithLength(LuaHashMapIterator* restrict hash_iterator, const char* restrict value_string, size_t value_string_length);
+LUAHASHMAP_EXPORT size_t LuaHashMap_GetValuesStringForKeysInteger(LuaHashMap* hash_map, const char* values_array[], const lua_Integer keys_array[], size_t value_lengths_array[], unsigned char found_bitmap[], size_t number_of_elements);
 /**
- * Updates a value in the hash table pointed to by the iterator.
- * Updates a value in the hash table pointed to by the iterator.
- * The iterator must be a valid iterator (i.e. the key it points to must already be in the hash table).
- * This will not insert new key/value pairs into the hash table.
- * pointer version
+ * Returns the values for multiple keys in the hash table in a single batch.
+ * Returns the values for multiple keys in the hash table in a single batch. The table is fetched only once for the whole batch which avoids the per-call overhead of LuaHashMap_GetValuePointerForKeyInteger.
+ * <integer, pointer> version
  *
- * @param hash_iterator The LuaHashMapIterator instance pointing to the key/value pair you want to update the value to.
- * @param value_pointer The value for the key. NULL key pointers are allowed as legitimate values.
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param values_array The output array which receives the values. values_array[i] is the value for keys_array[i], or NULL if not found.
+ * @param keys_array The array of keys to look up.
+ * @param found_bitmap Optional bitmap which must hold at least LUAHASHMAP_BITMAP_SIZE(number_of_elements) bytes. Bit i is set if keys_array[i] was found and cleared otherwise. Use LUAHASHMAP_BITMAP_ISSET to query. May be NULL.
+ * @param number_of_elements The number of elements in the arrays.
+ * @return Returns the number of keys that were found.
+ * @see LuaHashMap_GetValuePointerForKeyInteger, LuaHashMap_ExistsKeysInteger
  */
-LUAHASHMAP_EXPORT void LuaHashMap_SetValuePointerAtIterator(LuaHashMapIterator* hash_iterator, void* value_pointer);
+LUAHASHMAP_EXPORT size_t LuaHashMap_GetValuesPointerForKeysInteger(LuaHashMap* hash_map, void* values_array[], const lua_Integer keys_array[], unsigned char found_bitmap[], size_t number_of_elements);
 /**
- * Updates a value in the hash table pointed to by the iterator.
- * Updates a value in the hash table pointed to by the iterator.
- * The iterator must be a valid iterator (i.e. the key it points to must already be in the hash table).
- * This will not insert new key/value pairs into the hash table.
- * number version
+ * Returns the values for multiple keys in the hash table in a single batch.
+ * Returns the values for multiple keys in the hash table in a single batch. The table is fetched only once for the whole batch which avoids the per-call overhead of LuaHashMap_GetValueNumberForKeyInteger.
+ * <integer, number> version
  *
- * @param hash_iterator The LuaHashMapIterator instance pointing to the key/value pair you want to update the value to.
- * @param value_number The value for the key. NULL key pointers are allowed as legitimate values.
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param values_array The output array which receives the values. values_array[i] is the value for keys_array[i], or 0.0 if not found.
+ * @param keys_array The array of keys to look up.
+ * @param found_bitmap Optional bitmap which must hold at least LUAHASHMAP_BITMAP_SIZE(number_of_elements) bytes. Bit i is set if keys_array[i] was found and cleared otherwise. Use LUAHASHMAP_BITMAP_ISSET to query. May be NULL.
+ * @param number_of_elements The number of elements in the arrays.
+ * @return Returns the number of keys that were found.
+ * @see LuaHashMap_GetValueNumberForKeyInteger, LuaHashMap_ExistsKeysInteger
  */
-LUAHASHMAP_EXPORT void LuaHashMap_SetValueNumberAtIterator(LuaHashMapIterator* hash_iterator, lua_Number value_number);
+LUAHASHMAP_EXPORT size_t LuaHashMap_GetValuesNumberForKeysInteger(LuaHashMap* hash_map, lua_Number values_array[], const lua_Integer keys_array[], unsigned char found_bitmap[], size_t number_of_elements);
 /**
- * Updates a value in the hash table pointed to by the iterator.
- * Updates a value in the hash table pointed to by the iterator.
- * The iterator must be a valid iterator (i.e. the key it points to must already be in the hash table).
- * This will not insert new key/value pairs into the hash table.
- * integer version
+ * Returns the values for multiple keys in the hash table in a single batch.
+ * Returns the values for multiple keys in the hash table in a single batch. The table is fetched only once for the whole batch which avoids the per-call overhead of LuaHashMap_GetValueIntegerForKeyInteger.
+ * <integer, integer> version
  *
- * @param hash_iterator The LuaHashMapIterator instance pointing to the key/value pair you want to update the value to.
- * @param value_integer The value for the key. NULL key pointers are allowed as legitimate values.
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param values_array The output array which receives the values. values_array[i] is the value for keys_array[i], or 0 if not found.
+ * @param keys_array The array of keys to look up.
+ * @param found_bitmap Optional bitmap which must hold at least LUAHASHMAP_BITMAP_SIZE(number_of_elements) bytes. Bit i is set if keys_array[i] was found and cleared otherwise. Use LUAHASHMAP_BITMAP_ISSET to query. May be NULL.
+ * @param number_of_elements The number of elements in the arrays.
+ * @return Returns the number of keys that were found.
+ * @see LuaHashMap_GetValueIntegerForKeyInteger, LuaHashMap_ExistsKeysInteger
  */
-LUAHASHMAP_EXPORT void LuaHashMap_SetValueIntegerAtIterator(LuaHashMapIterator* hash_iterator, lua_Integer value_integer);
-
+LUAHASHMAP_EXPORT size_t LuaHashMap_GetValuesIntegerForKeysInteger(LuaHashMap* hash_map, lua_Integer values_array[], const lua_Integer keys_array[], unsigned char found_bitmap[], size_t number_of_elements);
 
+/** @} */
+	
+/** @defgroup ExistsKeyFamily ExistsKey family of functions
+ *  @{
+ */
 
 
+/* Exists Functions*/
 /**
- * Returns the value in the hash table pointed to by the iterator.
- * Returns the value in the hash table pointed to by the iterator.
+ * Returns whether a key/value pair exists in the hash table for a specified key.
+ * Returns whether a key/value pair exists in the hash table for a specified key.
  * string version
  *
- * @param hash_iterator The LuaHashMapIterator instance pointing to the key/value pair you want to retrieve.
- * @return Returns the Lua internalized pointer for the key string. 
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_string The key to test.
+ * @return Returns true if the key/value pair exists in the hash table. Returns false otherwise.
  *
- * @note If you follow the expected use pattern of the API, then you generally don't need to call this function and you want the CachedValue version of this function. As long as you don't modify the hash table behind the back of your iterator, its cached value should be up-to-date, avoiding the need for another full hash table look up.
- * @see LuaHashMap_GetCachedValueStringAtIterator, LuaHashMap_GetValueStringAtIteratorWithLength
+ * @note Consider using the GetIteratorForKey + GetCachedValue family of functions if you need to first check for existence and then retrieve the value if it exists.
+ * @see LuaHashMap_GetIteratorForKeyString, LuaHashMap_ExistsKeyStringWithLength
  */
-LUAHASHMAP_EXPORT const char* LuaHashMap_GetValueStringAtIterator(LuaHashMapIterator* hash_iterator);
+LUAHASHMAP_EXPORT bool LuaHashMap_ExistsKeyString(LuaHashMap* restrict hash_map, const char* restrict key_string);
 /**
- * Returns the value in the hash table pointed to by the iterator.
- * Returns the value in the hash table pointed to by the iterator.
+ * Returns whether a key/value pair exists in the hash table for a specified key.
+ * Returns whether a key/value pair exists in the hash table for a specified key.
  * string version
  * This version allows you to specify the string length for the string if you already know it as an optimization.
  *
- * @param hash_iterator The LuaHashMapIterator instance pointing to the key/value pair you want to retrieve.
- * @param value_string_length_return This returns by reference the string length (strlen()) of the returned value string. You may pass NULL to ignore this result. 
- * @return Returns the Lua internalized pointer for the key string. 
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_string The key to test.
+ * @param key_string_length The string length (strlen()) of the key string. (This does not count the \0 terminator character.)
+ * @return Returns true if the key/value pair exists in the hash table. Returns false otherwise.
  *
- * @note If you follow the expected use pattern of the API, then you generally don't need to call this function and you want the CachedValue version of this function. As long as you don't modify the hash table behind the back of your iterator, its cached value should be up-to-date, avoiding the need for another full hash table look up.
- * @see LuaHashMap_GetCachedValueStringAtIteratorWithLength, LuaHashMap_GetValueStringAtIterator
+ * @note Consider using the GetIteratorForKey + GetCachedValue family of functions if you need to first check for existence and then retrieve the value if it exists.
+ * @see LuaHashMap_GetIteratorForKeyString, LuaHashMap_ExistsKeyString
  */
-LUAHASHMAP_EXPORT const char* LuaHashMap_GetValueStringAtIteratorWithLength(LuaHashMapIterator* restrict hash_iterator, size_t* restrict value_string_length_return);
+LUAHASHMAP_EXPORT bool LuaHashMap_ExistsKeyStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length);
 /**
- * Returns the value in the hash table pointed to by the iterator.
- * Returns the value in the hash table pointed to by the iterator.
+ * Returns whether a key/value pair exists in the hash table for a specified key.
+ * Returns whether a key/value pair exists in the hash table for a specified key.
  * pointer version
  *
- * @param hash_iterator The LuaHashMapIterator instance pointing to the key/value pair you want to retrieve.
- * @return Returns the value for the key.
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_pointer The key to test.
+ * @return Returns true if the key/value pair exists in the hash table. Returns false otherwise.
  *
- * @note If you follow the expected use pattern of the API, then you generally don't need to call this function and you want the CachedValue version of this function. As long as you don't modify the hash table behind the back of your iterator, its cached value should be up-to-date, avoiding the need for another full hash table look up.
- * @see LuaHashMap_GetCachedValuePointerAtIterator
+ * @note Consider using the GetIteratorForKey + GetCachedValue family of functions if you need to first check for existence and then retrieve the value if it exists.
+ * @see LuaHashMap_GetIteratorForKeyPointer
  */
-LUAHASHMAP_EXPORT void* LuaHashMap_GetValuePointerAtIterator(LuaHashMapIterator* hash_iterator);
+LUAHASHMAP_EXPORT bool LuaHashMap_ExistsKeyPointer(LuaHashMap* hash_map, void* key_pointer);
 /**
- * Returns the value in the hash table pointed to by the iterator.
- * Returns the value in the hash table pointed to by the iterator.
- * pointer version
+ * Returns whether a key/value pair exists in the hash table for a specified key.
+ * Returns whether a key/value pair exists in the hash table for a specified key.
+ * number version
  *
- * @param hash_iterator The LuaHashMapIterator instance pointing to the key/value pair you want to retrieve.
- * @return Returns the value for the key.
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_number The key to test.
+ * @return Returns true if the key/value pair exists in the hash table. Returns false otherwise.
  *
- * @note If you follow the expected use pattern of the API, then you generally don't need to call this function and you want the CachedValue version of this function. As long as you don't modify the hash table behind the back of your iterator, its cached value should be up-to-date, avoiding the need for another full hash table look up.
- * @see LuaHashMap_GetCachedValuePointerAtIterator
+ * @note Consider using the GetIteratorForKey + GetCachedValue family of functions if you need to first check for existence and then retrieve the value if it exists.
+ * @see LuaHashMap_GetIteratorForKeyNumber
  */
-LUAHASHMAP_EXPORT lua_Number LuaHashMap_GetValueNumberAtIterator(LuaHashMapIterator* hash_iterator);
+LUAHASHMAP_EXPORT bool LuaHashMap_ExistsKeyNumber(LuaHashMap* hash_map, lua_Number key_number);
 /**
- * Returns the value in the hash table pointed to by the iterator.
- * Returns the value in the hash table pointed to by the iterator.
- * pointer version
+ * Returns whether a key/value pair exists in the hash table for a specified key.
+ * Returns whether a key/value pair exists in the hash table for a specified key.
+ * integer version
  *
- * @param hash_iterator The LuaHashMapIterator instance pointing to the key/value pair you want to retrieve.
- * @return Returns the value for the key.
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_integer The key to test.
+ * @return Returns true if the key/value pair exists in the hash table. Returns false otherwise.
  *
- * @note If you follow the expected use pattern of the API, then you generally don't need to call this function and you want the CachedValue version of this function. As long as you don't modify the hash table behind the back of your iterator, its cached value should be up-to-date, avoiding the need for another full hash table look up.
- * @see LuaHashMap_GetCachedValuePointerAtIterator
+ * @note Consider using the GetIteratorForKey + GetCachedValue family of functions if you need to first check for existence and then retrieve the value if it exists.
+ * @see LuaHashMap_GetIteratorForKeyInteger
  */
-LUAHASHMAP_EXPORT lua_Integer LuaHashMap_GetValueIntegerAtIterator(LuaHashMapIterator* hash_iterator);
-
+LUAHASHMAP_EXPORT bool LuaHashMap_ExistsKeyInteger(LuaHashMap* hash_map, lua_Integer key_integer);
 
+/** @} */ 
 
-/* LuaHashMapIterator struct accessor functions. */
+/** @defgroup ExistsKeysFamily ExistsKeys (batch) family of functions
+ *  @{
+ */
 
 /**
- * Returns whether a key/value pair exists in the hash table pointed to by the iterator.
- * Returns whether a key/value pair exists in the hash table pointed to by the iterator.
+ * Checks if multiple keys exist in the hash table in a single batch.
+ * Checks if multiple keys exist in the hash table in a single batch. The table is fetched only once for the whole batch which avoids the per-call overhead of LuaHashMap_ExistsKeyString.
+ * string key version
  *
- * @param hash_iterator The LuaHashMapIterator instance pointing to the key/value pair 
- * @return Returns true if the key/value pair exists in the hash table. Returns false otherwise.
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param keys_array The array of keys to look up. NULL key strings disallowed and those elements will simply be reported as not found.
+ * @param key_lengths_array Optional array of string lengths (strlen()) for each key string. (This does not count the \0 terminator character.) Pass NULL to have strlen() computed for you.
+ * @param found_bitmap Optional bitmap which must hold at least LUAHASHMAP_BITMAP_SIZE(number_of_elements) bytes. Bit i is set if keys_array[i] was found and cleared otherwise. Use LUAHASHMAP_BITMAP_ISSET to query. May be NULL.
+ * @param number_of_elements The number of elements in the arrays.
+ * @return Returns the number of keys that were found.
+ * @see LuaHashMap_ExistsKeyString
  */
-LUAHASHMAP_EXPORT bool LuaHashMap_ExistsAtIterator(LuaHashMapIterator* hash_iterator);
+LUAHASHMAP_EXPORT size_t LuaHashMap_ExistsKeysString(LuaHashMap* hash_map, const char* keys_array[], const size_t key_lengths_array[], unsigned char found_bitmap[], size_t number_of_elements);
 /**
- * Removes a key/value pair in the hash table pointed to by the iterator.
- * Removes a key/value pair in the hash table pointed to by the iterator.
+ * Checks if multiple keys exist in the hash table in a single batch.
+ * Checks if multiple keys exist in the hash table in a single batch. The table is fetched only once for the whole batch which avoids the per-call overhead of LuaHashMap_ExistsKeyPointer.
+ * pointer key version
  *
- * @param hash_iterator The LuaHashMapIterator instance pointing to the key/value pair 
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param keys_array The array of keys to look up.
+ * @param found_bitmap Optional bitmap which must hold at least LUAHASHMAP_BITMAP_SIZE(number_of_elements) bytes. Bit i is set if keys_array[i] was found and cleared otherwise. Use LUAHASHMAP_BITMAP_ISSET to query. May be NULL.
+ * @param number_of_elements The number of elements in the arrays.
+ * @return Returns the number of keys that were found.
+ * @see LuaHashMap_ExistsKeyPointer
+ */
+LUAHASHMAP_EXPORT size_t LuaHashMap_ExistsKeysPointer(LuaHashMap* hash_map, void* keys_array[], unsigned char found_bitmap[], size_t number_of_elements);
+/**
+ * Checks if multiple keys exist in the hash table in a single batch.
+ * Checks if multiple keys exist in the hash table in a single batch. The table is fetched only once for the whole batch which avoids the per-call overhead of LuaHashMap_ExistsKeyNumber.
+ * number key version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param keys_array The array of keys to look up.
+ * @param found_bitmap Optional bitmap which must hold at least LUAHASHMAP_BITMAP_SIZE(number_of_elements) bytes. Bit i is set if keys_array[i] was found and cleared otherwise. Use LUAHASHMAP_BITMAP_ISSET to query. May be NULL.
+ * @param number_of_elements The number of elements in the arrays.
+ * @return Returns the number of keys that were found.
+ * @see LuaHashMap_ExistsKeyNumber
+ */
+LUAHASHMAP_EXPORT size_t LuaHashMap_ExistsKeysNumber(LuaHashMap* hash_map, const lua_Number keys_array[], unsigned char found_bitmap[], size_t number_of_elements);
+/**
+ * Checks if multiple keys exist in the hash table in a single batch.
+ * Checks if multiple keys exist in the hash table in a single batch. The table is fetched only once for the whole batch which avoids the per-call overhead of LuaHashMap_ExistsKeyInteger.
+ * integer key version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param keys_array The array of keys to look up.
+ * @param found_bitmap Optional bitmap which must hold at least LUAHASHMAP_BITMAP_SIZE(number_of_elements) bytes. Bit i is set if keys_array[i] was found and cleared otherwise. Use LUAHASHMAP_BITMAP_ISSET to query. May be NULL.
+ * @param number_of_elements The number of elements in the arrays.
+ * @return Returns the number of keys that were found.
+ * @see LuaHashMap_ExistsKeyInteger
+ */
+LUAHASHMAP_EXPORT size_t LuaHashMap_ExistsKeysInteger(LuaHashMap* hash_map, const lua_Integer keys_array[], unsigned char found_bitmap[], size_t number_of_elements);
+
+/** @} */
+
+/** @defgroup RemoveKeyFamily RemoveKey family of functions
+ *  @{
  */
-LUAHASHMAP_EXPORT void LuaHashMap_RemoveAtIterator(LuaHashMapIterator* hash_iterator);
 
 /**
- * Returns the type of the value in the hash table pointed to by the iterator.
- * This returns the type (e.g. string, pointer, number) of the value  in the hash table pointed to by the iterator.
- * The integer return value corresponds directly to Lua's types.
- * Valid values are LUA_TSTRING, LUA_TLIGHTUSERDATA, LUA_TNUMBER.
- * (LUA_TNONE may appear in the case of an error.)
+ * Removes a key/value pair in the hash table for a specified key.
+ * Removes a key/value pair in the hash table for a specified key.
+ * string version
+ * It is safe to try to remove a key that doesn't exist.
  *
- * This information is particularly useful if you want to store different types within the same hash table.
- * You can use this information to dynamically discover which type is stored and then call the correct Get<T> function.
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_string The key to remove.
+ */
+LUAHASHMAP_EXPORT void LuaHashMap_RemoveKeyString(LuaHashMap* restrict hash_map, const char* restrict key_string);
+/**
+ * Removes a key/value pair in the hash table for a specified key.
+ * Removes a key/value pair in the hash table for a specified key.
+ * string version
+ * This version allows you to specify the string length for the string if you already know it as an optimization.
+ * It is safe to try to remove a key that doesn't exist.
  *
- * @param hash_iterator The LuaHashMapIterator instance to operate on.
- * @return Returns an integer corresponding to Lua's mapping of types. Valid values should be LUA_TSTRING, LUA_TLIGHTUSERDATA, LUA_TNUMBER.
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_string The key to remove.
+ * @param key_string_length The string length (strlen()) of the key string. (This does not count the \0 terminator character.)
+ */
+LUAHASHMAP_EXPORT void LuaHashMap_RemoveKeyStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length);
+/**
+ * Removes a key/value pair in the hash table for a specified key.
+ * Removes a key/value pair in the hash table for a specified key.
+ * pointer version
+ * It is safe to try to remove a key that doesn't exist.
  *
- * @note This version does a full hash look up to retrieve the value. Use LuaHashMap_GetCachedValueTypeAtIterator to avoid a full look up.
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_pointer The key to remove.
+ */
+LUAHASHMAP_EXPORT void LuaHashMap_RemoveKeyPointer(LuaHashMap* hash_map, void* key_pointer);
+/**
+ * Removes a key/value pair in the hash table for a specified key.
+ * Removes a key/value pair in the hash table for a specified key.
+ * number version
+ * It is safe to try to remove a key that doesn't exist.
  *
- * @warning (Canonical) Lua does not have a way to distinguish whether the number is a lua_Number or lua_Integer. (It is assumed lua_Number.)
- * If you need to keep integers and floating point distinct, use different hash map instances to keep them separated.
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_number The key to remove.
+ */
+LUAHASHMAP_EXPORT void LuaHashMap_RemoveKeyNumber(LuaHashMap* hash_map, lua_Number key_number);
+/**
+ * Removes a key/value pair in the hash table for a specified key.
+ * Removes a key/value pair in the hash table for a specified key.
+ * integer version
+ * It is safe to try to remove a key that doesn't exist.
  *
- * @see LuaHashMap_GetCachedValueTypeAtIterator
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_integer The key to remove.
  */
-LUAHASHMAP_EXPORT int LuaHashMap_GetValueTypeAtIterator(LuaHashMapIterator* hash_iterator);
-
+LUAHASHMAP_EXPORT void LuaHashMap_RemoveKeyInteger(LuaHashMap* hash_map, lua_Integer key_integer);
+/** @} */ 
 
-#if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 199901L)
-/* Use the C99 inline if available to hint the compiler that this might benefit from inlining. 
- * Since these functions are merely pulling data out of an already exposed struct, inlining seems reasonable.
+/** @defgroup IncrementIntegerForKeyFamily IncrementIntegerForKey family of functions
+ *  @{
  */
-
 /**
- * Returns the type of the key in the iterator.
- * This returns the type (e.g. string, pointer, number) of the key in the iterator.
- * The integer return value corresponds directly to Lua's types.
- * Valid values are LUA_TSTRING, LUA_TLIGHTUSERDATA, LUA_TNUMBER.
- * (LUA_TNONE may appear in the case of an error.)
+ * Adds delta to the integer value for a key.
+ * Adds delta to the integer value for a key, using a single look up.
+ * If the key doesn't exist, it is treated as 0 so the key is created with the value delta.
+ * If the value is not an integer (a string, a pointer, or a number with no exact integer value) 
+ * or the result would overflow lua_Integer, this fails and the value is left unchanged.
+ * <string, integer> version
  *
- * This information is particularly useful if you want to store different types within the same hash table.
- * You can use this information to dynamically discover which type is stored and then call the correct Get<T> function.
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_string The key for the value. NULL key strings disallowed and the operation will simply return false.
+ * @param delta The amount to add. Use a negative number to decrement.
+ * @param value_integer_return If not NULL, the new value is written here on success.
+ * @return Returns true on success, false on failure.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_IncrementIntegerForKeyString(LuaHashMap* restrict hash_map, const char* restrict key_string, lua_Integer delta, lua_Integer* restrict value_integer_return);
+/**
+ * Adds delta to the integer value for a key.
+ * Adds delta to the integer value for a key, using a single look up.
+ * If the key doesn't exist, it is treated as 0 so the key is created with the value delta.
+ * If the value is not an integer (a string, a pointer, or a number with no exact integer value) 
+ * or the result would overflow lua_Integer, this fails and the value is left unchanged.
+ * <pointer, integer> version
  *
- * @param hash_iterator The LuaHashMapIterator instance to operate on.
- * @return Returns an integer corresponding to Lua's mapping of types. Valid values should be LUA_TSTRING, LUA_TLIGHTUSERDATA, LUA_TNUMBER.
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_pointer The key for the value.
+ * @param delta The amount to add. Use a negative number to decrement.
+ * @param value_integer_return If not NULL, the new value is written here on success.
+ * @return Returns true on success, false on failure.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_IncrementIntegerForKeyPointer(LuaHashMap* hash_map, void* key_pointer, lua_Integer delta, lua_Integer* restrict value_integer_return);
+/**
+ * Adds delta to the integer value for a key.
+ * Adds delta to the integer value for a key, using a single look up.
+ * If the key doesn't exist, it is treated as 0 so the key is created with the value delta.
+ * If the value is not an integer (a string, a pointer, or a number with no exact integer value) 
+ * or the result would overflow lua_Integer, this fails and the value is left unchanged.
+ * <number, integer> version
  *
- * @note This simply pulls the key type directly from the struct. This does not involve a full hash look up.
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_number The key for the value.
+ * @param delta The amount to add. Use a negative number to decrement.
+ * @param value_integer_return If not NULL, the new value is written here on success.
+ * @return Returns true on success, false on failure.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_IncrementIntegerForKeyNumber(LuaHashMap* restrict hash_map, lua_Number key_number, lua_Integer delta, lua_Integer* restrict value_integer_return);
+/**
+ * Adds delta to the integer value for a key.
+ * Adds delta to the integer value for a key, using a single look up.
+ * If the key doesn't exist, it is treated as 0 so the key is created with the value delta.
+ * If the value is not an integer (a string, a pointer, or a number with no exact integer value) 
+ * or the result would overflow lua_Integer, this fails and the value is left unchanged.
+ * <integer, integer> version
  *
- * @warning (Canonical) Lua does not have a way to distinguish whether the number is a lua_Number or lua_Integer. (It is assumed lua_Number.)
- * If you need to keep integers and floating point distinct, use different hash map instances to keep them separated.
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_integer The key for the value.
+ * @param delta The amount to add. Use a negative number to decrement.
+ * @param value_integer_return If not NULL, the new value is written here on success.
+ * @return Returns true on success, false on failure.
  */
-LUAHASHMAP_EXPORT inline int LuaHashMap_GetKeyTypeAtIterator(const LuaHashMapIterator* hash_iterator)
-{
-	if(NULL == hash_iterator)
-	{
-		return LUA_TNONE;
-	}
-	return hash_iterator->keyType;
-}
+LUAHASHMAP_EXPORT bool LuaHashMap_IncrementIntegerForKeyInteger(LuaHashMap* restrict hash_map, lua_Integer key_integer, lua_Integer delta, lua_Integer* restrict value_integer_return);
+/**
+ * Adds delta to the integer value for a key.
+ * Adds delta to the integer value for a key, using a single look up.
+ * If the key doesn't exist, it is treated as 0 so the key is created with the value delta.
+ * If the value is not an integer (a string, a pointer, or a number with no exact integer value) 
+ * or the result would overflow lua_Integer, this fails and the value is left unchanged.
+ * <string, integer> version
+ * This version allows you to specify the string length for the key string if you already know it as an optimization.
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_string The key for the value. NULL key strings disallowed and the operation will simply return false.
+ * @param key_string_length The string length (strlen()) of the key string. (This does not count the \0 terminator character.)
+ * @param delta The amount to add. Use a negative number to decrement.
+ * @param value_integer_return If not NULL, the new value is written here on success.
+ * @return Returns true on success, false on failure.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_IncrementIntegerForKeyStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length, lua_Integer delta, lua_Integer* restrict value_integer_return);
+/** @} */ 
 
+/** @defgroup GetOrSetValueForKeyFamily GetOrSetValueForKey family of functions
+ *  @{
+ */
 /**
- * Returns the key corresponding to the iterator.
- * Returns the key corresponding to the current location of the iterator.
- * string version
- * This version allows you to specify the string length for the string if you already know it as an optimization.
+ * Returns the value for a key, adding the given value first if the key doesn't exist.
+ * Returns the existing value for a key, or adds the given value and returns it if the key doesn't exist, using a single look up.
+ * An existing value is never overwritten.
+ * <string, string> version
  *
- * @param hash_iterator The LuaHashMapIterator instance to operate on.
- * @return Returns the Lua internalized pointer for the key string.
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param value_string The value to add if the key doesn't exist.
+ * @param key_string The key for the value. NULL key strings disallowed and the operation will simply return NULL.
+ * @return Returns the value now stored for the key.
  *
- * @note This simply pulls the key directly from the struct. This does not involve a full hash look up.
+ * @note The returned string is the Lua internalized copy, which may be different than the one you supplied.
  */
-LUAHASHMAP_EXPORT inline const char* LuaHashMap_GetKeyStringAtIterator(const LuaHashMapIterator* hash_iterator)
-{
-	if(NULL == hash_iterator)
-	{
-		return NULL;
-	}
-	if(true == hash_iterator->atEnd)
-	{
-		return NULL;
-	}
-	if(true == hash_iterator->isNext)
-	{
-		return NULL;
-	}
-	if(LUA_TSTRING == hash_iterator->keyType)
-	{
-        return hash_iterator->currentKey.theString.stringPointer;
-	}
-	else
-	{
-		/* shouldn't get here */
-		/* LUAHASHMAP_ASSERT(false); */
-		return NULL;
-	}
-}
+LUAHASHMAP_EXPORT const char* LuaHashMap_GetOrSetValueStringForKeyString(LuaHashMap* restrict hash_map, const char* value_string, const char* restrict key_string);
 /**
- * Returns the key corresponding to the iterator.
- * Returns the key corresponding to the current location of the iterator.
- * string version
- * This version allows you to specify the string length for the string if you already know it as an optimization.
+ * Returns the value for a key, adding the given value first if the key doesn't exist.
+ * Returns the existing value for a key, or adds the given value and returns it if the key doesn't exist, using a single look up.
+ * An existing value is never overwritten.
+ * <string, string> version
+ * This version allows you to specify the string length for the key and value strings if you already know it as an optimization.
  *
- * @param hash_iterator The LuaHashMapIterator instance to operate on.
- * @param key_string_length_return This returns by reference the string length (strlen()) of the returned key string. You may pass NULL to ignore this result. 
- * @return Returns the Lua internalized pointer for the key string. 
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param value_string The value to add if the key doesn't exist.
+ * @param key_string The key for the value. NULL key strings disallowed and the operation will simply return NULL.
+ * @param value_string_length The string length (strlen()) of the value string. (This does not count the \0 terminator character.)
+ * @param key_string_length The string length (strlen()) of the key string. (This does not count the \0 terminator character.)
+ * @return Returns the value now stored for the key.
  *
- * @note This simply pulls the key directly from the struct. This does not involve a full hash look up.
+ * @note The returned string is the Lua internalized copy, which may be different than the one you supplied.
  */
-LUAHASHMAP_EXPORT inline const char* LuaHashMap_GetKeyStringAtIteratorWithLength(const LuaHashMapIterator* restrict hash_iterator, size_t* restrict key_string_length_return)
-{
-	if(NULL == hash_iterator)
-	{
-		if(NULL != key_string_length_return)
-		{
-			*key_string_length_return = 0;
-		}
-		return NULL;
-	}
-	if(true == hash_iterator->atEnd)
-	{
-		if(NULL != key_string_length_return)
-		{
-			*key_string_length_return = 0;
-		}
-		return NULL;
-	}
-	if(true == hash_iterator->isNext)
-	{
-		if(NULL != key_string_length_return)
-		{
-			*key_string_length_return = 0;
-		}
-		return NULL;
-	}
-
-	if(NULL != key_string_length_return)
-	{
-		*key_string_length_return = hash_iterator->currentKey.theString.stringLength;
-	}
-
-	if(LUA_TSTRING == hash_iterator->keyType)
-	{
-        return hash_iterator->currentKey.theString.stringPointer;
-	}
-	else
-	{
-		/* shouldn't get here */
-		/* LUAHASHMAP_ASSERT(false); */
-		return NULL;
-	}
-}
+LUAHASHMAP_EXPORT const char* LuaHashMap_GetOrSetValueStringForKeyStringWithLength(LuaHashMap* restrict hash_map, const char* value_string, const char* restrict key_string, size_t value_string_length, size_t key_string_length);
 /**
- * Returns the string length of the key corresponding to the iterator.
- * Returns the string length of the key corresponding to the current location of the iterator.
+ * Returns the value for a key, adding the given value first if the key doesn't exist.
+ * Returns the existing value for a key, or adds the given value and returns it if the key doesn't exist, using a single look up.
+ * An existing value is never overwritten.
+ * <pointer, string> version
  *
- * @param hash_iterator The LuaHashMapIterator instance to operate on.
- * @return Returns the string length (strlen()) of the key pointer.
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param value_string The value to add if the key doesn't exist.
+ * @param key_pointer The key for the value.
+ * @return Returns the value now stored for the key.
  *
- * @note This simply pulls the key directly from the struct. This does not involve a full hash look up.
+ * @note The returned string is the Lua internalized copy, which may be different than the one you supplied.
  */
-LUAHASHMAP_EXPORT inline size_t LuaHashMap_GetKeyStringLengthAtIterator(const LuaHashMapIterator* hash_iterator)
-{
-	if(NULL == hash_iterator)
-	{
-		return 0;
-	}
-	if(true == hash_iterator->atEnd)
-	{
-		return 0;
-	}
-	if(true == hash_iterator->isNext)
-	{
-		return 0;
-	}
-	
-	if(LUA_TSTRING == hash_iterator->keyType)
-	{
-        return hash_iterator->currentKey.theString.stringLength;
-	}
-	else
-	{
-		/* shouldn't get here */
-		/* LUAHASHMAP_ASSERT(false); */
-		return 0;
-	}
-}
+LUAHASHMAP_EXPORT const char* LuaHashMap_GetOrSetValueStringForKeyPointer(LuaHashMap* hash_map, const char* value_string, void* key_pointer);
 /**
- * Returns the key corresponding to the iterator.
- * Returns the key corresponding to the current location of the iterator.
- * pointer version
+ * Returns the value for a key, adding the given value first if the key doesn't exist.
+ * Returns the existing value for a key, or adds the given value and returns it if the key doesn't exist, using a single look up.
+ * An existing value is never overwritten.
+ * <pointer, string> version
+ * This version allows you to specify the string length for the value string if you already know it as an optimization.
  *
- * @param hash_iterator The LuaHashMapIterator instance to operate on.
- * @return Returns the key pointer.
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param value_string The value to add if the key doesn't exist.
+ * @param key_pointer The key for the value.
+ * @param value_string_length The string length (strlen()) of the value string. (This does not count the \0 terminator character.)
+ * @return Returns the value now stored for the key.
  *
- * @note This simply pulls the key directly from the struct. This does not involve a full hash look up.
+ * @note The returned string is the Lua internalized copy, which may be different than the one you supplied.
  */
-LUAHASHMAP_EXPORT inline void* LuaHashMap_GetKeyPointerAtIterator(const LuaHashMapIterator* hash_iterator)
-{
-	if(NULL == hash_iterator)
-	{
-		return NULL;
-	}
-	if(true == hash_iterator->atEnd)
-	{
-		return NULL;
-	}
-	if(true == hash_iterator->isNext)
-	{
-		return NULL;
-	}
-	
-	if(LUA_TLIGHTUSERDATA == hash_iterator->keyType)
-	{
-        return hash_iterator->currentKey.thePointer;
-	}
-	else
-	{
-		/* shouldn't get here */
-		/* LUAHASHMAP_ASSERT(false); */
-		return NULL;
-	}
-}
+LUAHASHMAP_EXPORT const char* LuaHashMap_GetOrSetValueStringForKeyPointerWithLength(LuaHashMap* hash_map, const char* value_string, void* key_pointer, size_t value_string_length);
 /**
- * Returns the key corresponding to the iterator.
- * Returns the key corresponding to the current location of the iterator.
- * number version
+ * Returns the value for a key, adding the given value first if the key doesn't exist.
+ * Returns the existing value for a key, or adds the given value and returns it if the key doesn't exist, using a single look up.
+ * An existing value is never overwritten.
+ * <number, string> version
  *
- * @param hash_iterator The LuaHashMapIterator instance to operate on.
- * @return Returns the key number.
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param value_string The value to add if the key doesn't exist.
+ * @param key_number The key for the value.
+ * @return Returns the value now stored for the key.
  *
- * @note This simply pulls the key directly from the struct. This does not involve a full hash look up.
+ * @note The returned string is the Lua internalized copy, which may be different than the one you supplied.
  */
-LUAHASHMAP_EXPORT inline lua_Number LuaHashMap_GetKeyNumberAtIterator(const LuaHashMapIterator* hash_iterator)
-{
-	if(NULL == hash_iterator)
-	{
-		return 0.0;
-	}
-	if(true == hash_iterator->atEnd)
-	{
-		return 0.0;
-	}
-	if(true == hash_iterator->isNext)
-	{
-		return 0.0;
-	}
-	
-	if(LUA_TNUMBER == hash_iterator->keyType)
-	{
-        return hash_iterator->currentKey.theNumber;
-	}
-	else
-	{
-		/* shouldn't get here */
-		/* LUAHASHMAP_ASSERT(false); */
-		return 0.0;
-	}
-}
+LUAHASHMAP_EXPORT const char* LuaHashMap_GetOrSetValueStringForKeyNumber(LuaHashMap* restrict hash_map, const char* value_string, lua_Number key_number);
 /**
- * Returns the key corresponding to the iterator.
- * Returns the key corresponding to the current location of the iterator.
- * integer version
+ * Returns the value for a key, adding the given value first if the key doesn't exist.
+ * Returns the existing value for a key, or adds the given value and returns it if the key doesn't exist, using a single look up.
+ * An existing value is never overwritten.
+ * <number, string> version
+ * This version allows you to specify the string length for the value string if you already know it as an optimization.
  *
- * @param hash_iterator The LuaHashMapIterator instance to operate on.
- * @return Returns the key integer.
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param value_string The value to add if the key doesn't exist.
+ * @param key_number The key for the value.
+ * @param value_string_length The string length (strlen()) of the value string. (This does not count the \0 terminator character.)
+ * @return Returns the value now stored for the key.
  *
- * @note This simply pulls the key directly from the struct. This does not involve a full hash look up.
+ * @note The returned string is the Lua internalized copy, which may be different than the one you supplied.
  */
-LUAHASHMAP_EXPORT inline lua_Integer LuaHashMap_GetKeyIntegerAtIterator(const LuaHashMapIterator* hash_iterator)
-{
-	if(NULL == hash_iterator)
-	{
-		return 0;
-	}
-	if(true == hash_iterator->atEnd)
-	{
-		return 0;
-	}
-	if(true == hash_iterator->isNext)
-	{
-		return 0;
-	}
-	
-	if(LUA_TNUMBER == hash_iterator->keyType)
-	{
-        return (lua_Integer)hash_iterator->currentKey.theNumber;
-	}
-	else
-	{
-		/* shouldn't get here */
-		/* LUAHASHMAP_ASSERT(false); */
-		return 0;
-	}
-}
-
-
+LUAHASHMAP_EXPORT const char* LuaHashMap_GetOrSetValueStringForKeyNumberWithLength(LuaHashMap* restrict hash_map, const char* value_string, lua_Number key_number, size_t value_string_length);
 /**
- * Returns the type of the cached value in the iterator.
- * This returns the type (e.g. string, pointer, number) of the cached value in the iterator.
- * The integer return value corresponds directly to Lua's types.
- * Valid values are LUA_TSTRING, LUA_TLIGHTUSERDATA, LUA_TNUMBER.
- * (LUA_TNONE may appear in the case of an error.)
+ * Returns the value for a key, adding the given value first if the key doesn't exist.
+ * Returns the existing value for a key, or adds the given value and returns it if the key doesn't exist, using a single look up.
+ * An existing value is never overwritten.
+ * <integer, string> version
  *
- * This information is particularly useful if you want to store different types within the same hash table.
- * You can use this information to dynamically discover which type is stored and then call the correct Get<T> function.
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param value_string The value to add if the key doesn't exist.
+ * @param key_integer The key for the value.
+ * @return Returns the value now stored for the key.
  *
- * @param hash_iterator The LuaHashMapIterator instance to operate on.
- * @return Returns an integer corresponding to Lua's mapping of types. Valid values should be LUA_TSTRING, LUA_TLIGHTUSERDATA, LUA_TNUMBER.
+ * @note The returned string is the Lua internalized copy, which may be different than the one you supplied.
+ */
+LUAHASHMAP_EXPORT const char* LuaHashMap_GetOrSetValueStringForKeyInteger(LuaHashMap* restrict hash_map, const char* value_string, lua_Integer key_integer);
+/**
+ * Returns the value for a key, adding the given value first if the key doesn't exist.
+ * Returns the existing value for a key, or adds the given value and returns it if the key doesn't exist, using a single look up.
+ * An existing value is never overwritten.
+ * <integer, string> version
+ * This version allows you to specify the string length for the value string if you already know it as an optimization.
  *
- * @note This simply pulls the value type directly from the struct. This does not involve a full hash look up.
- * If you follow the expected use pattern of the API (as long as you don't modify the hash table behind the back of your iterator), 
- * its cached value should be up-to-date, avoiding the need to use the regular GetValue<T>AtIterator which requires another full hash table look up.
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param value_string The value to add if the key doesn't exist.
+ * @param key_integer The key for the value.
+ * @param value_string_length The string length (strlen()) of the value string. (This does not count the \0 terminator character.)
+ * @return Returns the value now stored for the key.
  *
- * @warning (Canonical) Lua does not have a way to distinguish whether the number is a lua_Number or lua_Integer. (It is assumed lua_Number.)
- * If you need to keep integers and floating point distinct, use different hash map instances to keep them separated.
+ * @note The returned string is the Lua internalized copy, which may be different than the one you supplied.
  */
-LUAHASHMAP_EXPORT inline int LuaHashMap_GetCachedValueTypeAtIterator(const LuaHashMapIterator* hash_iterator)
-{
-	if(NULL == hash_iterator)
-	{
-		return LUA_TNONE;
-	}
-	if(true == hash_iterator->atEnd)
-	{
-		return LUA_TNONE;
-	}
-	if(true == hash_iterator->isNext)
-	{
-		return LUA_TNONE;
-	}
-	
-	return hash_iterator->valueType;
-}
+LUAHASHMAP_EXPORT const char* LuaHashMap_GetOrSetValueStringForKeyIntegerWithLength(LuaHashMap* restrict hash_map, const char* value_string, lua_Integer key_integer, size_t value_string_length);
 /**
- * Returns the cached value saved in the iterator.
- * Returns the cached value saved in the iterator.
- * string version
+ * Returns the value for a key, adding the given value first if the key doesn't exist.
+ * Returns the existing value for a key, or adds the given value and returns it if the key doesn't exist, using a single look up.
+ * An existing value is never overwritten.
+ * <string, pointer> version
  *
- * @param hash_iterator The LuaHashMapIterator instance to operate on.
- * @return Returns the Lua internalized pointer for the key string. 
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param value_pointer The value to add if the key doesn't exist.
+ * @param key_string The key for the value. NULL key strings disallowed and the operation will simply return NULL.
+ * @return Returns the value now stored for the key.
+ */
+LUAHASHMAP_EXPORT void* LuaHashMap_GetOrSetValuePointerForKeyString(LuaHashMap* hash_map, void* value_pointer, const char* key_string);
+/**
+ * Returns the value for a key, adding the given value first if the key doesn't exist.
+ * Returns the existing value for a key, or adds the given value and returns it if the key doesn't exist, using a single look up.
+ * An existing value is never overwritten.
+ * <string, pointer> version
+ * This version allows you to specify the string length for the key string if you already know it as an optimization.
  *
- * @note This simply pulls the key directly from the struct. This does not involve a full hash look up.
- * If you follow the expected use pattern of the API (as long as you don't modify the hash table behind the back of your iterator), 
- * its cached value should be up-to-date, avoiding the need to use the regular GetValue<T>AtIterator which requires another full hash table look up.
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param value_pointer The value to add if the key doesn't exist.
+ * @param key_string The key for the value. NULL key strings disallowed and the operation will simply return NULL.
+ * @param key_string_length The string length (strlen()) of the key string. (This does not count the \0 terminator character.)
+ * @return Returns the value now stored for the key.
  */
-LUAHASHMAP_EXPORT inline const char* LuaHashMap_GetCachedValueStringAtIterator(const LuaHashMapIterator* hash_iterator)
-{
-	if(NULL == hash_iterator)
-	{
-		return NULL;
-	}
-	if(true == hash_iterator->atEnd)
-	{
-		return NULL;
-	}
-	if(true == hash_iterator->isNext)
-	{
-		return NULL;
-	}
-	if(LUA_TSTRING != hash_iterator->valueType)
-	{
-		return NULL;
-	}
-	return hash_iterator->currentValue.theString.stringPointer;
-}
+LUAHASHMAP_EXPORT void* LuaHashMap_GetOrSetValuePointerForKeyStringWithLength(LuaHashMap* hash_map, void* value_pointer, const char* key_string, size_t key_string_length);
 /**
- * Returns the cached value saved in the iterator.
- * Returns the cached value saved in the iterator.
- * string version
- * This version allows you to specify the string length for the string if you already know it as an optimization.
+ * Returns the value for a key, adding the given value first if the key doesn't exist.
+ * Returns the existing value for a key, or adds the given value and returns it if the key doesn't exist, using a single look up.
+ * An existing value is never overwritten.
+ * <pointer, pointer> version
  *
- * @param hash_iterator The LuaHashMapIterator instance to operate on.
- * @param value_string_length_return This returns by reference the string length (strlen()) of the returned key string. You may pass NULL to ignore this result. 
- * @return Returns the Lua internalized pointer for the key string. 
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param value_pointer The value to add if the key doesn't exist.
+ * @param key_pointer The key for the value.
+ * @return Returns the value now stored for the key.
+ */
+LUAHASHMAP_EXPORT void* LuaHashMap_GetOrSetValuePointerForKeyPointer(LuaHashMap* hash_map, void* value_pointer, void* key_pointer);
+/**
+ * Returns the value for a key, adding the given value first if the key doesn't exist.
+ * Returns the existing value for a key, or adds the given value and returns it if the key doesn't exist, using a single look up.
+ * An existing value is never overwritten.
+ * <number, pointer> version
  *
- * @note This simply pulls the key directly from the struct. This does not involve a full hash look up.
- * If you follow the expected use pattern of the API (as long as you don't modify the hash table behind the back of your iterator), 
- * its cached value should be up-to-date, avoiding the need to use the regular GetValue<T>AtIterator which requires another full hash table look up.
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param value_pointer The value to add if the key doesn't exist.
+ * @param key_number The key for the value.
+ * @return Returns the value now stored for the key.
  */
-LUAHASHMAP_EXPORT inline const char* LuaHashMap_GetCachedValueStringAtIteratorWithLength(const LuaHashMapIterator* restrict hash_iterator, size_t* restrict value_string_length_return)
-{
-	if(NULL == hash_iterator)
-	{
-		if(NULL != value_string_length_return)
-		{
-			*value_string_length_return = 0;
-		}
-		return NULL;
-	}
-	if(true == hash_iterator->atEnd)
-	{
-		if(NULL != value_string_length_return)
-		{
-			*value_string_length_return = 0;
-		}
-		return NULL;
-	}
-	if(true == hash_iterator->isNext)
-	{
-		if(NULL != value_string_length_return)
-		{
-			*value_string_length_return = 0;
-		}
-		return NULL;
-	}
-	if(LUA_TSTRING != hash_iterator->valueType)
-	{
-		if(NULL != value_string_length_return)
-		{
-			*value_string_length_return = 0;
-		}
-		return NULL;
-	}
-
-	if(NULL != value_string_length_return)
-	{
-		*value_string_length_return = hash_iterator->currentKey.theString.stringLength;
-	}
-
-	return hash_iterator->currentValue.theString.stringPointer;
-}
+LUAHASHMAP_EXPORT void* LuaHashMap_GetOrSetValuePointerForKeyNumber(LuaHashMap* hash_map, void* value_pointer, lua_Number key_number);
 /**
- * Returns the string length of the cached value saved in the iterator.
- * Returns the string length of the cached value saved in the current location of the iterator.
+ * Returns the value for a key, adding the given value first if the key doesn't exist.
+ * Returns the existing value for a key, or adds the given value and returns it if the key doesn't exist, using a single look up.
+ * An existing value is never overwritten.
+ * <integer, pointer> version
  *
- * @param hash_iterator The LuaHashMapIterator instance to operate on.
- * @return Returns the string length (strlen()) of the key pointer.
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param value_pointer The value to add if the key doesn't exist.
+ * @param key_integer The key for the value.
+ * @return Returns the value now stored for the key.
+ */
+LUAHASHMAP_EXPORT void* LuaHashMap_GetOrSetValuePointerForKeyInteger(LuaHashMap* hash_map, void* value_pointer, lua_Integer key_integer);
+/**
+ * Returns the value for a key, adding the given value first if the key doesn't exist.
+ * Returns the existing value for a key, or adds the given value and returns it if the key doesn't exist, using a single look up.
+ * An existing value is never overwritten.
+ * <string, number> version
  *
- * @note This simply pulls the key directly from the struct. This does not involve a full hash look up.
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param value_number The value to add if the key doesn't exist.
+ * @param key_string The key for the value. NULL key strings disallowed and the operation will simply return 0.0.
+ * @return Returns the value now stored for the key.
  */
-LUAHASHMAP_EXPORT inline size_t LuaHashMap_GetCachedValueStringLengthAtIterator(const LuaHashMapIterator* hash_iterator)
-{
-	if(NULL == hash_iterator)
-	{
-		return 0;
-	}
-	if(true == hash_iterator->atEnd)
-	{
-		return 0;
-	}
-	if(true == hash_iterator->isNext)
-	{
+LUAHASHMAP_EXPORT lua_Number LuaHashMap_GetOrSetValueNumberForKeyString(LuaHashMap* restrict hash_map, lua_Number value_number, const char* restrict key_string);
+/**
+ * Returns the value for a key, adding the given value first if the key doesn't exist.
+ * Returns the existing value for a key, or adds the given value and returns it if the key doesn't exist, using a single look up.
+ * An existing value is never overwritten.
+ * <string, number> version
+ * This version allows you to specify the string length for the key string if you already know it as an optimization.
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param value_number The value to add if the key doesn't exist.
+ * @param key_string The key for the value. NULL key strings disallowed and the operation will simply return 0.0.
+ * @param key_string_length The string length (strlen()) of the key string. (This does not count the \0 terminator character.)
+ * @return Returns the value now stored for the key.
+ */
+LUAHASHMAP_EXPORT lua_Number LuaHashMap_GetOrSetValueNumberForKeyStringWithLength(LuaHashMap* restrict hash_map, lua_Number value_number, const char* restrict key_string, size_t key_string_length);
+/**
+ * Returns the value for a key, adding the given value first if the key doesn't exist.
+ * Returns the existing value for a key, or adds the given value and returns it if the key doesn't exist, using a single look up.
+ * An existing value is never overwritten.
+ * <pointer, number> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param value_number The value to add if the key doesn't exist.
+ * @param key_pointer The key for the value.
+ * @return Returns the value now stored for the key.
+ */
+LUAHASHMAP_EXPORT lua_Number LuaHashMap_GetOrSetValueNumberForKeyPointer(LuaHashMap* hash_map, lua_Number value_number, void* key_pointer);
+/**
+ * Returns the value for a key, adding the given value first if the key doesn't exist.
+ * Returns the existing value for a key, or adds the given value and returns it if the key doesn't exist, using a single look up.
+ * An existing value is never overwritten.
+ * <number, number> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param value_number The value to add if the key doesn't exist.
+ * @param key_number The key for the value.
+ * @return Returns the value now stored for the key.
+ */
+LUAHASHMAP_EXPORT lua_Number LuaHashMap_GetOrSetValueNumberForKeyNumber(LuaHashMap* restrict hash_map, lua_Number value_number, lua_Number key_number);
+/**
+ * Returns the value for a key, adding the given value first if the key doesn't exist.
+ * Returns the existing value for a key, or adds the given value and returns it if the key doesn't exist, using a single look up.
+ * An existing value is never overwritten.
+ * <integer, number> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param value_number The value to add if the key doesn't exist.
+ * @param key_integer The key for the value.
+ * @return Returns the value now stored for the key.
+ */
+LUAHASHMAP_EXPORT lua_Number LuaHashMap_GetOrSetValueNumberForKeyInteger(LuaHashMap* restrict hash_map, lua_Number value_number, lua_Integer key_integer);
+/**
+ * Returns the value for a key, adding the given value first if the key doesn't exist.
+ * Returns the existing value for a key, or adds the given value and returns it if the key doesn't exist, using a single look up.
+ * An existing value is never overwritten.
+ * <string, integer> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param value_integer The value to add if the key doesn't exist.
+ * @param key_string The key for the value. NULL key strings disallowed and the operation will simply return 0.
+ * @return Returns the value now stored for the key.
+ */
+LUAHASHMAP_EXPORT lua_Integer LuaHashMap_GetOrSetValueIntegerForKeyString(LuaHashMap* restrict hash_map, lua_Integer value_integer, const char* restrict key_string);
+/**
+ * Returns the value for a key, adding the given value first if the key doesn't exist.
+ * Returns the existing value for a key, or adds the given value and returns it if the key doesn't exist, using a single look up.
+ * An existing value is never overwritten.
+ * <string, integer> version
+ * This version allows you to specify the string length for the key string if you already know it as an optimization.
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param value_integer The value to add if the key doesn't exist.
+ * @param key_string The key for the value. NULL key strings disallowed and the operation will simply return 0.
+ * @param key_string_length The string length (strlen()) of the key string. (This does not count the \0 terminator character.)
+ * @return Returns the value now stored for the key.
+ */
+LUAHASHMAP_EXPORT lua_Integer LuaHashMap_GetOrSetValueIntegerForKeyStringWithLength(LuaHashMap* restrict hash_map, lua_Integer value_integer, const char* restrict key_string, size_t key_string_length);
+/**
+ * Returns the value for a key, adding the given value first if the key doesn't exist.
+ * Returns the existing value for a key, or adds the given value and returns it if the key doesn't exist, using a single look up.
+ * An existing value is never overwritten.
+ * <pointer, integer> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param value_integer The value to add if the key doesn't exist.
+ * @param key_pointer The key for the value.
+ * @return Returns the value now stored for the key.
+ */
+LUAHASHMAP_EXPORT lua_Integer LuaHashMap_GetOrSetValueIntegerForKeyPointer(LuaHashMap* hash_map, lua_Integer value_integer, void* key_pointer);
+/**
+ * Returns the value for a key, adding the given value first if the key doesn't exist.
+ * Returns the existing value for a key, or adds the given value and returns it if the key doesn't exist, using a single look up.
+ * An existing value is never overwritten.
+ * <number, integer> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param value_integer The value to add if the key doesn't exist.
+ * @param key_number The key for the value.
+ * @return Returns the value now stored for the key.
+ */
+LUAHASHMAP_EXPORT lua_Integer LuaHashMap_GetOrSetValueIntegerForKeyNumber(LuaHashMap* restrict hash_map, lua_Integer value_integer, lua_Number key_number);
+/**
+ * Returns the value for a key, adding the given value first if the key doesn't exist.
+ * Returns the existing value for a key, or adds the given value and returns it if the key doesn't exist, using a single look up.
+ * An existing value is never overwritten.
+ * <integer, integer> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param value_integer The value to add if the key doesn't exist.
+ * @param key_integer The key for the value.
+ * @return Returns the value now stored for the key.
+ */
+LUAHASHMAP_EXPORT lua_Integer LuaHashMap_GetOrSetValueIntegerForKeyInteger(LuaHashMap* restrict hash_map, lua_Integer value_integer, lua_Integer key_integer);
+/** @} */ 
+
+/** @defgroup TakeValueForKeyFamily TakeValueForKey family of functions
+ * There is no string value version because the string would no longer be referenced by the table once removed.
+ *  @{
+ */
+/**
+ * Removes a key and returns the value it had.
+ * Removes a key/value pair in the hash table for a specified key and returns the value, using a single look up.
+ * It is safe to try to take a key that doesn't exist.
+ * <string, pointer> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_string The key for the value. NULL key strings disallowed and the operation will simply return NULL.
+ * @return Returns the value that was removed, or NULL if the key didn't exist.
+ */
+LUAHASHMAP_EXPORT void* LuaHashMap_TakeValuePointerForKeyString(LuaHashMap* restrict hash_map, const char* restrict key_string);
+/**
+ * Removes a key and returns the value it had.
+ * Removes a key/value pair in the hash table for a specified key and returns the value, using a single look up.
+ * It is safe to try to take a key that doesn't exist.
+ * <string, pointer> version
+ * This version allows you to specify the string length for the key string if you already know it as an optimization.
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_string The key for the value. NULL key strings disallowed and the operation will simply return NULL.
+ * @param key_string_length The string length (strlen()) of the key string. (This does not count the \0 terminator character.)
+ * @return Returns the value that was removed, or NULL if the key didn't exist.
+ */
+LUAHASHMAP_EXPORT void* LuaHashMap_TakeValuePointerForKeyStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length);
+/**
+ * Removes a key and returns the value it had.
+ * Removes a key/value pair in the hash table for a specified key and returns the value, using a single look up.
+ * It is safe to try to take a key that doesn't exist.
+ * <pointer, pointer> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_pointer The key for the value.
+ * @return Returns the value that was removed, or NULL if the key didn't exist.
+ */
+LUAHASHMAP_EXPORT void* LuaHashMap_TakeValuePointerForKeyPointer(LuaHashMap* hash_map, void* key_pointer);
+/**
+ * Removes a key and returns the value it had.
+ * Removes a key/value pair in the hash table for a specified key and returns the value, using a single look up.
+ * It is safe to try to take a key that doesn't exist.
+ * <number, pointer> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_number The key for the value.
+ * @return Returns the value that was removed, or NULL if the key didn't exist.
+ */
+LUAHASHMAP_EXPORT void* LuaHashMap_TakeValuePointerForKeyNumber(LuaHashMap* restrict hash_map, lua_Number key_number);
+/**
+ * Removes a key and returns the value it had.
+ * Removes a key/value pair in the hash table for a specified key and returns the value, using a single look up.
+ * It is safe to try to take a key that doesn't exist.
+ * <integer, pointer> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_integer The key for the value.
+ * @return Returns the value that was removed, or NULL if the key didn't exist.
+ */
+LUAHASHMAP_EXPORT void* LuaHashMap_TakeValuePointerForKeyInteger(LuaHashMap* restrict hash_map, lua_Integer key_integer);
+/**
+ * Removes a key and returns the value it had.
+ * Removes a key/value pair in the hash table for a specified key and returns the value, using a single look up.
+ * It is safe to try to take a key that doesn't exist.
+ * <string, number> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_string The key for the value. NULL key strings disallowed and the operation will simply return 0.0.
+ * @return Returns the value that was removed, or 0.0 if the key didn't exist.
+ */
+LUAHASHMAP_EXPORT lua_Number LuaHashMap_TakeValueNumberForKeyString(LuaHashMap* restrict hash_map, const char* restrict key_string);
+/**
+ * Removes a key and returns the value it had.
+ * Removes a key/value pair in the hash table for a specified key and returns the value, using a single look up.
+ * It is safe to try to take a key that doesn't exist.
+ * <string, number> version
+ * This version allows you to specify the string length for the key string if you already know it as an optimization.
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_string The key for the value. NULL key strings disallowed and the operation will simply return 0.0.
+ * @param key_string_length The string length (strlen()) of the key string. (This does not count the \0 terminator character.)
+ * @return Returns the value that was removed, or 0.0 if the key didn't exist.
+ */
+LUAHASHMAP_EXPORT lua_Number LuaHashMap_TakeValueNumberForKeyStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length);
+/**
+ * Removes a key and returns the value it had.
+ * Removes a key/value pair in the hash table for a specified key and returns the value, using a single look up.
+ * It is safe to try to take a key that doesn't exist.
+ * <pointer, number> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_pointer The key for the value.
+ * @return Returns the value that was removed, or 0.0 if the key didn't exist.
+ */
+LUAHASHMAP_EXPORT lua_Number LuaHashMap_TakeValueNumberForKeyPointer(LuaHashMap* hash_map, void* key_pointer);
+/**
+ * Removes a key and returns the value it had.
+ * Removes a key/value pair in the hash table for a specified key and returns the value, using a single look up.
+ * It is safe to try to take a key that doesn't exist.
+ * <number, number> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_number The key for the value.
+ * @return Returns the value that was removed, or 0.0 if the key didn't exist.
+ */
+LUAHASHMAP_EXPORT lua_Number LuaHashMap_TakeValueNumberForKeyNumber(LuaHashMap* restrict hash_map, lua_Number key_number);
+/**
+ * Removes a key and returns the value it had.
+ * Removes a key/value pair in the hash table for a specified key and returns the value, using a single look up.
+ * It is safe to try to take a key that doesn't exist.
+ * <integer, number> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_integer The key for the value.
+ * @return Returns the value that was removed, or 0.0 if the key didn't exist.
+ */
+LUAHASHMAP_EXPORT lua_Number LuaHashMap_TakeValueNumberForKeyInteger(LuaHashMap* restrict hash_map, lua_Integer key_integer);
+/**
+ * Removes a key and returns the value it had.
+ * Removes a key/value pair in the hash table for a specified key and returns the value, using a single look up.
+ * It is safe to try to take a key that doesn't exist.
+ * <string, integer> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_string The key for the value. NULL key strings disallowed and the operation will simply return 0.
+ * @return Returns the value that was removed, or 0 if the key didn't exist.
+ */
+LUAHASHMAP_EXPORT lua_Integer LuaHashMap_TakeValueIntegerForKeyString(LuaHashMap* restrict hash_map, const char* restrict key_string);
+/**
+ * Removes a key and returns the value it had.
+ * Removes a key/value pair in the hash table for a specified key and returns the value, using a single look up.
+ * It is safe to try to take a key that doesn't exist.
+ * <string, integer> version
+ * This version allows you to specify the string length for the key string if you already know it as an optimization.
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_string The key for the value. NULL key strings disallowed and the operation will simply return 0.
+ * @param key_string_length The string length (strlen()) of the key string. (This does not count the \0 terminator character.)
+ * @return Returns the value that was removed, or 0 if the key didn't exist.
+ */
+LUAHASHMAP_EXPORT lua_Integer LuaHashMap_TakeValueIntegerForKeyStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length);
+/**
+ * Removes a key and returns the value it had.
+ * Removes a key/value pair in the hash table for a specified key and returns the value, using a single look up.
+ * It is safe to try to take a key that doesn't exist.
+ * <pointer, integer> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_pointer The key for the value.
+ * @return Returns the value that was removed, or 0 if the key didn't exist.
+ */
+LUAHASHMAP_EXPORT lua_Integer LuaHashMap_TakeValueIntegerForKeyPointer(LuaHashMap* hash_map, void* key_pointer);
+/**
+ * Removes a key and returns the value it had.
+ * Removes a key/value pair in the hash table for a specified key and returns the value, using a single look up.
+ * It is safe to try to take a key that doesn't exist.
+ * <number, integer> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_number The key for the value.
+ * @return Returns the value that was removed, or 0 if the key didn't exist.
+ */
+LUAHASHMAP_EXPORT lua_Integer LuaHashMap_TakeValueIntegerForKeyNumber(LuaHashMap* restrict hash_map, lua_Number key_number);
+/**
+ * Removes a key and returns the value it had.
+ * Removes a key/value pair in the hash table for a specified key and returns the value, using a single look up.
+ * It is safe to try to take a key that doesn't exist.
+ * <integer, integer> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_integer The key for the value.
+ * @return Returns the value that was removed, or 0 if the key didn't exist.
+ */
+LUAHASHMAP_EXPORT lua_Integer LuaHashMap_TakeValueIntegerForKeyInteger(LuaHashMap* restrict hash_map, lua_Integer key_integer);
+/** @} */ 
+
+/** @defgroup CompareAndSetValueForKeyFamily CompareAndSetValueForKey family of functions
+ *  @{
+ */
+/**
+ * Sets the value for a key only if its current value is equal to an expected value.
+ * Sets the value for a key only if its current value is equal to expected_value_string, using a single look up.
+ * A key that doesn't exist never matches, so this never adds a new key.
+ * <string, string> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param value_string The new value for the key.
+ * @param expected_value_string The value the key must currently have for the new value to be set.
+ * @param key_string The key for the value. NULL key strings disallowed and the operation will simply return false.
+ * @return Returns true if the value matched and was replaced.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_CompareAndSetValueStringForKeyString(LuaHashMap* restrict hash_map, const char* value_string, const char* expected_value_string, const char* restrict key_string);
+/**
+ * Sets the value for a key only if its current value is equal to an expected value.
+ * Sets the value for a key only if its current value is equal to expected_value_string, using a single look up.
+ * A key that doesn't exist never matches, so this never adds a new key.
+ * <string, string> version
+ * This version allows you to specify the string length for the key and value strings if you already know it as an optimization.
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param value_string The new value for the key.
+ * @param expected_value_string The value the key must currently have for the new value to be set.
+ * @param key_string The key for the value. NULL key strings disallowed and the operation will simply return false.
+ * @param value_string_length The string length (strlen()) of value_string. (This does not count the \0 terminator character.)
+ * @param expected_value_string_length The string length (strlen()) of expected_value_string. (This does not count the \0 terminator character.)
+ * @param key_string_length The string length (strlen()) of the key string. (This does not count the \0 terminator character.)
+ * @return Returns true if the value matched and was replaced.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_CompareAndSetValueStringForKeyStringWithLength(LuaHashMap* restrict hash_map, const char* value_string, const char* expected_value_string, const char* restrict key_string, size_t value_string_length, size_t expected_value_string_length, size_t key_string_length);
+/**
+ * Sets the value for a key only if its current value is equal to an expected value.
+ * Sets the value for a key only if its current value is equal to expected_value_string, using a single look up.
+ * A key that doesn't exist never matches, so this never adds a new key.
+ * <pointer, string> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param value_string The new value for the key.
+ * @param expected_value_string The value the key must currently have for the new value to be set.
+ * @param key_pointer The key for the value.
+ * @return Returns true if the value matched and was replaced.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_CompareAndSetValueStringForKeyPointer(LuaHashMap* hash_map, const char* value_string, const char* expected_value_string, void* key_pointer);
+/**
+ * Sets the value for a key only if its current value is equal to an expected value.
+ * Sets the value for a key only if its current value is equal to expected_value_string, using a single look up.
+ * A key that doesn't exist never matches, so this never adds a new key.
+ * <pointer, string> version
+ * This version allows you to specify the string length for the value strings if you already know it as an optimization.
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param value_string The new value for the key.
+ * @param expected_value_string The value the key must currently have for the new value to be set.
+ * @param key_pointer The key for the value.
+ * @param value_string_length The string length (strlen()) of value_string. (This does not count the \0 terminator character.)
+ * @param expected_value_string_length The string length (strlen()) of expected_value_string. (This does not count the \0 terminator character.)
+ * @return Returns true if the value matched and was replaced.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_CompareAndSetValueStringForKeyPointerWithLength(LuaHashMap* hash_map, const char* value_string, const char* expected_value_string, void* key_pointer, size_t value_string_length, size_t expected_value_string_length);
+/**
+ * Sets the value for a key only if its current value is equal to an expected value.
+ * Sets the value for a key only if its current value is equal to expected_value_string, using a single look up.
+ * A key that doesn't exist never matches, so this never adds a new key.
+ * <number, string> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param value_string The new value for the key.
+ * @param expected_value_string The value the key must currently have for the new value to be set.
+ * @param key_number The key for the value.
+ * @return Returns true if the value matched and was replaced.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_CompareAndSetValueStringForKeyNumber(LuaHashMap* restrict hash_map, const char* value_string, const char* expected_value_string, lua_Number key_number);
+/**
+ * Sets the value for a key only if its current value is equal to an expected value.
+ * Sets the value for a key only if its current value is equal to expected_value_string, using a single look up.
+ * A key that doesn't exist never matches, so this never adds a new key.
+ * <number, string> version
+ * This version allows you to specify the string length for the value strings if you already know it as an optimization.
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param value_string The new value for the key.
+ * @param expected_value_string The value the key must currently have for the new value to be set.
+ * @param key_number The key for the value.
+ * @param value_string_length The string length (strlen()) of value_string. (This does not count the \0 terminator character.)
+ * @param expected_value_string_length The string length (strlen()) of expected_value_string. (This does not count the \0 terminator character.)
+ * @return Returns true if the value matched and was replaced.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_CompareAndSetValueStringForKeyNumberWithLength(LuaHashMap* restrict hash_map, const char* value_string, const char* expected_value_string, lua_Number key_number, size_t value_string_length, size_t expected_value_string_length);
+/**
+ * Sets the value for a key only if its current value is equal to an expected value.
+ * Sets the value for a key only if its current value is equal to expected_value_string, using a single look up.
+ * A key that doesn't exist never matches, so this never adds a new key.
+ * <integer, string> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param value_string The new value for the key.
+ * @param expected_value_string The value the key must currently have for the new value to be set.
+ * @param key_integer The key for the value.
+ * @return Returns true if the value matched and was replaced.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_CompareAndSetValueStringForKeyInteger(LuaHashMap* restrict hash_map, const char* value_string, const char* expected_value_string, lua_Integer key_integer);
+/**
+ * Sets the value for a key only if its current value is equal to an expected value.
+ * Sets the value for a key only if its current value is equal to expected_value_string, using a single look up.
+ * A key that doesn't exist never matches, so this never adds a new key.
+ * <integer, string> version
+ * This version allows you to specify the string length for the value strings if you already know it as an optimization.
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param value_string The new value for the key.
+ * @param expected_value_string The value the key must currently have for the new value to be set.
+ * @param key_integer The key for the value.
+ * @param value_string_length The string length (strlen()) of value_string. (This does not count the \0 terminator character.)
+ * @param expected_value_string_length The string length (strlen()) of expected_value_string. (This does not count the \0 terminator character.)
+ * @return Returns true if the value matched and was replaced.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_CompareAndSetValueStringForKeyIntegerWithLength(LuaHashMap* restrict hash_map, const char* value_string, const char* expected_value_string, lua_Integer key_integer, size_t value_string_length, size_t expected_value_string_length);
+/**
+ * Sets the value for a key only if its current value is equal to an expected value.
+ * Sets the value for a key only if its current value is equal to expected_value_pointer, using a single look up.
+ * A key that doesn't exist never matches, so this never adds a new key.
+ * <string, pointer> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param value_pointer The new value for the key.
+ * @param expected_value_pointer The value the key must currently have for the new value to be set.
+ * @param key_string The key for the value. NULL key strings disallowed and the operation will simply return false.
+ * @return Returns true if the value matched and was replaced.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_CompareAndSetValuePointerForKeyString(LuaHashMap* hash_map, void* value_pointer, void* expected_value_pointer, const char* key_string);
+/**
+ * Sets the value for a key only if its current value is equal to an expected value.
+ * Sets the value for a key only if its current value is equal to expected_value_pointer, using a single look up.
+ * A key that doesn't exist never matches, so this never adds a new key.
+ * <string, pointer> version
+ * This version allows you to specify the string length for the key string if you already know it as an optimization.
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param value_pointer The new value for the key.
+ * @param expected_value_pointer The value the key must currently have for the new value to be set.
+ * @param key_string The key for the value. NULL key strings disallowed and the operation will simply return false.
+ * @param key_string_length The string length (strlen()) of the key string. (This does not count the \0 terminator character.)
+ * @return Returns true if the value matched and was replaced.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_CompareAndSetValuePointerForKeyStringWithLength(LuaHashMap* hash_map, void* value_pointer, void* expected_value_pointer, const char* key_string, size_t key_string_length);
+/**
+ * Sets the value for a key only if its current value is equal to an expected value.
+ * Sets the value for a key only if its current value is equal to expected_value_pointer, using a single look up.
+ * A key that doesn't exist never matches, so this never adds a new key.
+ * <pointer, pointer> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param value_pointer The new value for the key.
+ * @param expected_value_pointer The value the key must currently have for the new value to be set.
+ * @param key_pointer The key for the value.
+ * @return Returns true if the value matched and was replaced.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_CompareAndSetValuePointerForKeyPointer(LuaHashMap* hash_map, void* value_pointer, void* expected_value_pointer, void* key_pointer);
+/**
+ * Sets the value for a key only if its current value is equal to an expected value.
+ * Sets the value for a key only if its current value is equal to expected_value_pointer, using a single look up.
+ * A key that doesn't exist never matches, so this never adds a new key.
+ * <number, pointer> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param value_pointer The new value for the key.
+ * @param expected_value_pointer The value the key must currently have for the new value to be set.
+ * @param key_number The key for the value.
+ * @return Returns true if the value matched and was replaced.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_CompareAndSetValuePointerForKeyNumber(LuaHashMap* hash_map, void* value_pointer, void* expected_value_pointer, lua_Number key_number);
+/**
+ * Sets the value for a key only if its current value is equal to an expected value.
+ * Sets the value for a key only if its current value is equal to expected_value_pointer, using a single look up.
+ * A key that doesn't exist never matches, so this never adds a new key.
+ * <integer, pointer> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param value_pointer The new value for the key.
+ * @param expected_value_pointer The value the key must currently have for the new value to be set.
+ * @param key_integer The key for the value.
+ * @return Returns true if the value matched and was replaced.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_CompareAndSetValuePointerForKeyInteger(LuaHashMap* hash_map, void* value_pointer, void* expected_value_pointer, lua_Integer key_integer);
+/**
+ * Sets the value for a key only if its current value is equal to an expected value.
+ * Sets the value for a key only if its current value is equal to expected_value_number, using a single look up.
+ * A key that doesn't exist never matches, so this never adds a new key.
+ * <string, number> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param value_number The new value for the key.
+ * @param expected_value_number The value the key must currently have for the new value to be set.
+ * @param key_string The key for the value. NULL key strings disallowed and the operation will simply return false.
+ * @return Returns true if the value matched and was replaced.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_CompareAndSetValueNumberForKeyString(LuaHashMap* restrict hash_map, lua_Number value_number, lua_Number expected_value_number, const char* restrict key_string);
+/**
+ * Sets the value for a key only if its current value is equal to an expected value.
+ * Sets the value for a key only if its current value is equal to expected_value_number, using a single look up.
+ * A key that doesn't exist never matches, so this never adds a new key.
+ * <string, number> version
+ * This version allows you to specify the string length for the key string if you already know it as an optimization.
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param value_number The new value for the key.
+ * @param expected_value_number The value the key must currently have for the new value to be set.
+ * @param key_string The key for the value. NULL key strings disallowed and the operation will simply return false.
+ * @param key_string_length The string length (strlen()) of the key string. (This does not count the \0 terminator character.)
+ * @return Returns true if the value matched and was replaced.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_CompareAndSetValueNumberForKeyStringWithLength(LuaHashMap* restrict hash_map, lua_Number value_number, lua_Number expected_value_number, const char* restrict key_string, size_t key_string_length);
+/**
+ * Sets the value for a key only if its current value is equal to an expected value.
+ * Sets the value for a key only if its current value is equal to expected_value_number, using a single look up.
+ * A key that doesn't exist never matches, so this never adds a new key.
+ * <pointer, number> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param value_number The new value for the key.
+ * @param expected_value_number The value the key must currently have for the new value to be set.
+ * @param key_pointer The key for the value.
+ * @return Returns true if the value matched and was replaced.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_CompareAndSetValueNumberForKeyPointer(LuaHashMap* hash_map, lua_Number value_number, lua_Number expected_value_number, void* key_pointer);
+/**
+ * Sets the value for a key only if its current value is equal to an expected value.
+ * Sets the value for a key only if its current value is equal to expected_value_number, using a single look up.
+ * A key that doesn't exist never matches, so this never adds a new key.
+ * <number, number> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param value_number The new value for the key.
+ * @param expected_value_number The value the key must currently have for the new value to be set.
+ * @param key_number The key for the value.
+ * @return Returns true if the value matched and was replaced.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_CompareAndSetValueNumberForKeyNumber(LuaHashMap* restrict hash_map, lua_Number value_number, lua_Number expected_value_number, lua_Number key_number);
+/**
+ * Sets the value for a key only if its current value is equal to an expected value.
+ * Sets the value for a key only if its current value is equal to expected_value_number, using a single look up.
+ * A key that doesn't exist never matches, so this never adds a new key.
+ * <integer, number> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param value_number The new value for the key.
+ * @param expected_value_number The value the key must currently have for the new value to be set.
+ * @param key_integer The key for the value.
+ * @return Returns true if the value matched and was replaced.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_CompareAndSetValueNumberForKeyInteger(LuaHashMap* restrict hash_map, lua_Number value_number, lua_Number expected_value_number, lua_Integer key_integer);
+/**
+ * Sets the value for a key only if its current value is equal to an expected value.
+ * Sets the value for a key only if its current value is equal to expected_value_integer, using a single look up.
+ * A key that doesn't exist never matches, so this never adds a new key.
+ * <string, integer> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param value_integer The new value for the key.
+ * @param expected_value_integer The value the key must currently have for the new value to be set.
+ * @param key_string The key for the value. NULL key strings disallowed and the operation will simply return false.
+ * @return Returns true if the value matched and was replaced.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_CompareAndSetValueIntegerForKeyString(LuaHashMap* restrict hash_map, lua_Integer value_integer, lua_Integer expected_value_integer, const char* restrict key_string);
+/**
+ * Sets the value for a key only if its current value is equal to an expected value.
+ * Sets the value for a key only if its current value is equal to expected_value_integer, using a single look up.
+ * A key that doesn't exist never matches, so this never adds a new key.
+ * <string, integer> version
+ * This version allows you to specify the string length for the key string if you already know it as an optimization.
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param value_integer The new value for the key.
+ * @param expected_value_integer The value the key must currently have for the new value to be set.
+ * @param key_string The key for the value. NULL key strings disallowed and the operation will simply return false.
+ * @param key_string_length The string length (strlen()) of the key string. (This does not count the \0 terminator character.)
+ * @return Returns true if the value matched and was replaced.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_CompareAndSetValueIntegerForKeyStringWithLength(LuaHashMap* restrict hash_map, lua_Integer value_integer, lua_Integer expected_value_integer, const char* restrict key_string, size_t key_string_length);
+/**
+ * Sets the value for a key only if its current value is equal to an expected value.
+ * Sets the value for a key only if its current value is equal to expected_value_integer, using a single look up.
+ * A key that doesn't exist never matches, so this never adds a new key.
+ * <pointer, integer> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param value_integer The new value for the key.
+ * @param expected_value_integer The value the key must currently have for the new value to be set.
+ * @param key_pointer The key for the value.
+ * @return Returns true if the value matched and was replaced.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_CompareAndSetValueIntegerForKeyPointer(LuaHashMap* hash_map, lua_Integer value_integer, lua_Integer expected_value_integer, void* key_pointer);
+/**
+ * Sets the value for a key only if its current value is equal to an expected value.
+ * Sets the value for a key only if its current value is equal to expected_value_integer, using a single look up.
+ * A key that doesn't exist never matches, so this never adds a new key.
+ * <number, integer> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param value_integer The new value for the key.
+ * @param expected_value_integer The value the key must currently have for the new value to be set.
+ * @param key_number The key for the value.
+ * @return Returns true if the value matched and was replaced.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_CompareAndSetValueIntegerForKeyNumber(LuaHashMap* restrict hash_map, lua_Integer value_integer, lua_Integer expected_value_integer, lua_Number key_number);
+/**
+ * Sets the value for a key only if its current value is equal to an expected value.
+ * Sets the value for a key only if its current value is equal to expected_value_integer, using a single look up.
+ * A key that doesn't exist never matches, so this never adds a new key.
+ * <integer, integer> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param value_integer The new value for the key.
+ * @param expected_value_integer The value the key must currently have for the new value to be set.
+ * @param key_integer The key for the value.
+ * @return Returns true if the value matched and was replaced.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_CompareAndSetValueIntegerForKeyInteger(LuaHashMap* restrict hash_map, lua_Integer value_integer, lua_Integer expected_value_integer, lua_Integer key_integer);
+/** @} */ 
+
+/** @defgroup RemoveKeyIfValueFamily RemoveKeyIfValue family of functions
+ *  @{
+ */
+/**
+ * Removes a key/value pair only if the current value is equal to an expected value.
+ * Removes a key/value pair in the hash table for a specified key only if its current value is equal to expected_value_string, using a single look up.
+ * It is safe to try to remove a key that doesn't exist.
+ * <string, string> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_string The key to remove. NULL key strings disallowed and the operation will simply return false.
+ * @param expected_value_string The value the key must currently have to be removed.
+ * @return Returns true if the value matched and the key was removed.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_RemoveKeyStringIfValueString(LuaHashMap* restrict hash_map, const char* restrict key_string, const char* expected_value_string);
+/**
+ * Removes a key/value pair only if the current value is equal to an expected value.
+ * Removes a key/value pair in the hash table for a specified key only if its current value is equal to expected_value_string, using a single look up.
+ * It is safe to try to remove a key that doesn't exist.
+ * <string, string> version
+ * This version allows you to specify the string length for the key and value strings if you already know it as an optimization.
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_string The key to remove. NULL key strings disallowed and the operation will simply return false.
+ * @param expected_value_string The value the key must currently have to be removed.
+ * @param key_string_length The string length (strlen()) of the key string. (This does not count the \0 terminator character.)
+ * @param expected_value_string_length The string length (strlen()) of expected_value_string. (This does not count the \0 terminator character.)
+ * @return Returns true if the value matched and the key was removed.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_RemoveKeyStringIfValueStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, const char* expected_value_string, size_t key_string_length, size_t expected_value_string_length);
+/**
+ * Removes a key/value pair only if the current value is equal to an expected value.
+ * Removes a key/value pair in the hash table for a specified key only if its current value is equal to expected_value_string, using a single look up.
+ * It is safe to try to remove a key that doesn't exist.
+ * <pointer, string> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_pointer The key to remove.
+ * @param expected_value_string The value the key must currently have to be removed.
+ * @return Returns true if the value matched and the key was removed.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_RemoveKeyPointerIfValueString(LuaHashMap* hash_map, void* key_pointer, const char* expected_value_string);
+/**
+ * Removes a key/value pair only if the current value is equal to an expected value.
+ * Removes a key/value pair in the hash table for a specified key only if its current value is equal to expected_value_string, using a single look up.
+ * It is safe to try to remove a key that doesn't exist.
+ * <pointer, string> version
+ * This version allows you to specify the string length for the value string if you already know it as an optimization.
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_pointer The key to remove.
+ * @param expected_value_string The value the key must currently have to be removed.
+ * @param expected_value_string_length The string length (strlen()) of expected_value_string. (This does not count the \0 terminator character.)
+ * @return Returns true if the value matched and the key was removed.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_RemoveKeyPointerIfValueStringWithLength(LuaHashMap* hash_map, void* key_pointer, const char* expected_value_string, size_t expected_value_string_length);
+/**
+ * Removes a key/value pair only if the current value is equal to an expected value.
+ * Removes a key/value pair in the hash table for a specified key only if its current value is equal to expected_value_string, using a single look up.
+ * It is safe to try to remove a key that doesn't exist.
+ * <number, string> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_number The key to remove.
+ * @param expected_value_string The value the key must currently have to be removed.
+ * @return Returns true if the value matched and the key was removed.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_RemoveKeyNumberIfValueString(LuaHashMap* restrict hash_map, lua_Number key_number, const char* expected_value_string);
+/**
+ * Removes a key/value pair only if the current value is equal to an expected value.
+ * Removes a key/value pair in the hash table for a specified key only if its current value is equal to expected_value_string, using a single look up.
+ * It is safe to try to remove a key that doesn't exist.
+ * <number, string> version
+ * This version allows you to specify the string length for the value string if you already know it as an optimization.
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_number The key to remove.
+ * @param expected_value_string The value the key must currently have to be removed.
+ * @param expected_value_string_length The string length (strlen()) of expected_value_string. (This does not count the \0 terminator character.)
+ * @return Returns true if the value matched and the key was removed.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_RemoveKeyNumberIfValueStringWithLength(LuaHashMap* restrict hash_map, lua_Number key_number, const char* expected_value_string, size_t expected_value_string_length);
+/**
+ * Removes a key/value pair only if the current value is equal to an expected value.
+ * Removes a key/value pair in the hash table for a specified key only if its current value is equal to expected_value_string, using a single look up.
+ * It is safe to try to remove a key that doesn't exist.
+ * <integer, string> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_integer The key to remove.
+ * @param expected_value_string The value the key must currently have to be removed.
+ * @return Returns true if the value matched and the key was removed.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_RemoveKeyIntegerIfValueString(LuaHashMap* restrict hash_map, lua_Integer key_integer, const char* expected_value_string);
+/**
+ * Removes a key/value pair only if the current value is equal to an expected value.
+ * Removes a key/value pair in the hash table for a specified key only if its current value is equal to expected_value_string, using a single look up.
+ * It is safe to try to remove a key that doesn't exist.
+ * <integer, string> version
+ * This version allows you to specify the string length for the value string if you already know it as an optimization.
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_integer The key to remove.
+ * @param expected_value_string The value the key must currently have to be removed.
+ * @param expected_value_string_length The string length (strlen()) of expected_value_string. (This does not count the \0 terminator character.)
+ * @return Returns true if the value matched and the key was removed.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_RemoveKeyIntegerIfValueStringWithLength(LuaHashMap* restrict hash_map, lua_Integer key_integer, const char* expected_value_string, size_t expected_value_string_length);
+/**
+ * Removes a key/value pair only if the current value is equal to an expected value.
+ * Removes a key/value pair in the hash table for a specified key only if its current value is equal to expected_value_pointer, using a single look up.
+ * It is safe to try to remove a key that doesn't exist.
+ * <string, pointer> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_string The key to remove. NULL key strings disallowed and the operation will simply return false.
+ * @param expected_value_pointer The value the key must currently have to be removed.
+ * @return Returns true if the value matched and the key was removed.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_RemoveKeyStringIfValuePointer(LuaHashMap* hash_map, const char* key_string, void* expected_value_pointer);
+/**
+ * Removes a key/value pair only if the current value is equal to an expected value.
+ * Removes a key/value pair in the hash table for a specified key only if its current value is equal to expected_value_pointer, using a single look up.
+ * It is safe to try to remove a key that doesn't exist.
+ * <string, pointer> version
+ * This version allows you to specify the string length for the key string if you already know it as an optimization.
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_string The key to remove. NULL key strings disallowed and the operation will simply return false.
+ * @param expected_value_pointer The value the key must currently have to be removed.
+ * @param key_string_length The string length (strlen()) of the key string. (This does not count the \0 terminator character.)
+ * @return Returns true if the value matched and the key was removed.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_RemoveKeyStringIfValuePointerWithLength(LuaHashMap* hash_map, const char* key_string, void* expected_value_pointer, size_t key_string_length);
+/**
+ * Removes a key/value pair only if the current value is equal to an expected value.
+ * Removes a key/value pair in the hash table for a specified key only if its current value is equal to expected_value_pointer, using a single look up.
+ * It is safe to try to remove a key that doesn't exist.
+ * <pointer, pointer> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_pointer The key to remove.
+ * @param expected_value_pointer The value the key must currently have to be removed.
+ * @return Returns true if the value matched and the key was removed.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_RemoveKeyPointerIfValuePointer(LuaHashMap* hash_map, void* key_pointer, void* expected_value_pointer);
+/**
+ * Removes a key/value pair only if the current value is equal to an expected value.
+ * Removes a key/value pair in the hash table for a specified key only if its current value is equal to expected_value_pointer, using a single look up.
+ * It is safe to try to remove a key that doesn't exist.
+ * <number, pointer> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_number The key to remove.
+ * @param expected_value_pointer The value the key must currently have to be removed.
+ * @return Returns true if the value matched and the key was removed.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_RemoveKeyNumberIfValuePointer(LuaHashMap* hash_map, lua_Number key_number, void* expected_value_pointer);
+/**
+ * Removes a key/value pair only if the current value is equal to an expected value.
+ * Removes a key/value pair in the hash table for a specified key only if its current value is equal to expected_value_pointer, using a single look up.
+ * It is safe to try to remove a key that doesn't exist.
+ * <integer, pointer> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_integer The key to remove.
+ * @param expected_value_pointer The value the key must currently have to be removed.
+ * @return Returns true if the value matched and the key was removed.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_RemoveKeyIntegerIfValuePointer(LuaHashMap* hash_map, lua_Integer key_integer, void* expected_value_pointer);
+/**
+ * Removes a key/value pair only if the current value is equal to an expected value.
+ * Removes a key/value pair in the hash table for a specified key only if its current value is equal to expected_value_number, using a single look up.
+ * It is safe to try to remove a key that doesn't exist.
+ * <string, number> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_string The key to remove. NULL key strings disallowed and the operation will simply return false.
+ * @param expected_value_number The value the key must currently have to be removed.
+ * @return Returns true if the value matched and the key was removed.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_RemoveKeyStringIfValueNumber(LuaHashMap* restrict hash_map, const char* restrict key_string, lua_Number expected_value_number);
+/**
+ * Removes a key/value pair only if the current value is equal to an expected value.
+ * Removes a key/value pair in the hash table for a specified key only if its current value is equal to expected_value_number, using a single look up.
+ * It is safe to try to remove a key that doesn't exist.
+ * <string, number> version
+ * This version allows you to specify the string length for the key string if you already know it as an optimization.
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_string The key to remove. NULL key strings disallowed and the operation will simply return false.
+ * @param expected_value_number The value the key must currently have to be removed.
+ * @param key_string_length The string length (strlen()) of the key string. (This does not count the \0 terminator character.)
+ * @return Returns true if the value matched and the key was removed.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_RemoveKeyStringIfValueNumberWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, lua_Number expected_value_number, size_t key_string_length);
+/**
+ * Removes a key/value pair only if the current value is equal to an expected value.
+ * Removes a key/value pair in the hash table for a specified key only if its current value is equal to expected_value_number, using a single look up.
+ * It is safe to try to remove a key that doesn't exist.
+ * <pointer, number> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_pointer The key to remove.
+ * @param expected_value_number The value the key must currently have to be removed.
+ * @return Returns true if the value matched and the key was removed.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_RemoveKeyPointerIfValueNumber(LuaHashMap* hash_map, void* key_pointer, lua_Number expected_value_number);
+/**
+ * Removes a key/value pair only if the current value is equal to an expected value.
+ * Removes a key/value pair in the hash table for a specified key only if its current value is equal to expected_value_number, using a single look up.
+ * It is safe to try to remove a key that doesn't exist.
+ * <number, number> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_number The key to remove.
+ * @param expected_value_number The value the key must currently have to be removed.
+ * @return Returns true if the value matched and the key was removed.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_RemoveKeyNumberIfValueNumber(LuaHashMap* restrict hash_map, lua_Number key_number, lua_Number expected_value_number);
+/**
+ * Removes a key/value pair only if the current value is equal to an expected value.
+ * Removes a key/value pair in the hash table for a specified key only if its current value is equal to expected_value_number, using a single look up.
+ * It is safe to try to remove a key that doesn't exist.
+ * <integer, number> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_integer The key to remove.
+ * @param expected_value_number The value the key must currently have to be removed.
+ * @return Returns true if the value matched and the key was removed.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_RemoveKeyIntegerIfValueNumber(LuaHashMap* restrict hash_map, lua_Integer key_integer, lua_Number expected_value_number);
+/**
+ * Removes a key/value pair only if the current value is equal to an expected value.
+ * Removes a key/value pair in the hash table for a specified key only if its current value is equal to expected_value_integer, using a single look up.
+ * It is safe to try to remove a key that doesn't exist.
+ * <string, integer> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_string The key to remove. NULL key strings disallowed and the operation will simply return false.
+ * @param expected_value_integer The value the key must currently have to be removed.
+ * @return Returns true if the value matched and the key was removed.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_RemoveKeyStringIfValueInteger(LuaHashMap* restrict hash_map, const char* restrict key_string, lua_Integer expected_value_integer);
+/**
+ * Removes a key/value pair only if the current value is equal to an expected value.
+ * Removes a key/value pair in the hash table for a specified key only if its current value is equal to expected_value_integer, using a single look up.
+ * It is safe to try to remove a key that doesn't exist.
+ * <string, integer> version
+ * This version allows you to specify the string length for the key string if you already know it as an optimization.
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_string The key to remove. NULL key strings disallowed and the operation will simply return false.
+ * @param expected_value_integer The value the key must currently have to be removed.
+ * @param key_string_length The string length (strlen()) of the key string. (This does not count the \0 terminator character.)
+ * @return Returns true if the value matched and the key was removed.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_RemoveKeyStringIfValueIntegerWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, lua_Integer expected_value_integer, size_t key_string_length);
+/**
+ * Removes a key/value pair only if the current value is equal to an expected value.
+ * Removes a key/value pair in the hash table for a specified key only if its current value is equal to expected_value_integer, using a single look up.
+ * It is safe to try to remove a key that doesn't exist.
+ * <pointer, integer> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_pointer The key to remove.
+ * @param expected_value_integer The value the key must currently have to be removed.
+ * @return Returns true if the value matched and the key was removed.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_RemoveKeyPointerIfValueInteger(LuaHashMap* hash_map, void* key_pointer, lua_Integer expected_value_integer);
+/**
+ * Removes a key/value pair only if the current value is equal to an expected value.
+ * Removes a key/value pair in the hash table for a specified key only if its current value is equal to expected_value_integer, using a single look up.
+ * It is safe to try to remove a key that doesn't exist.
+ * <number, integer> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_number The key to remove.
+ * @param expected_value_integer The value the key must currently have to be removed.
+ * @return Returns true if the value matched and the key was removed.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_RemoveKeyNumberIfValueInteger(LuaHashMap* restrict hash_map, lua_Number key_number, lua_Integer expected_value_integer);
+/**
+ * Removes a key/value pair only if the current value is equal to an expected value.
+ * Removes a key/value pair in the hash table for a specified key only if its current value is equal to expected_value_integer, using a single look up.
+ * It is safe to try to remove a key that doesn't exist.
+ * <integer, integer> version
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param key_integer The key to remove.
+ * @param expected_value_integer The value the key must currently have to be removed.
+ * @return Returns true if the value matched and the key was removed.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_RemoveKeyIntegerIfValueInteger(LuaHashMap* restrict hash_map, lua_Integer key_integer, lua_Integer expected_value_integer);
+/** @} */ 
+
+/** @defgroup ClearFamily Clear family of functions
+ *  @{
+ */
+/**
+ * Removes all entries from the hash table, but doesn't shrink the hash.
+ * This removes all entries from the hash table, but it doesn't shrink the hash (doesn't reclaim memory). 
+ * @param hash_map The LuaHashMap instance to operate on. 
+ */
+LUAHASHMAP_EXPORT void LuaHashMap_Clear(LuaHashMap* hash_map);
+/**
+ * Removes all entries from the hash table and resets the hash size to 0 (reclaims memory)
+ * This removes all entries from the hash table and  resets the hash size to 0 (reclaims memory).
+ * @param hash_map The LuaHashMap instance to operate on. 
+ */
+LUAHASHMAP_EXPORT void LuaHashMap_Purge(LuaHashMap* hash_map);
+
+/**
+ * Returns whether the hash table is empty or or not.
+ * Returns whether the hash table is empty or or not.
+ * @param hash_map The LuaHashMap instance to operate on. 
+ * @return Returns true if the hash table is empty, otherwise false.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_IsEmpty(LuaHashMap* hash_map);
+
+/** @} */ 
+
+/** @defgroup CapacityFamily Capacity family of functions
+ *  @{
+ */
+/**
+ * Grows an existing hash table so it can hold the requested number of elements without rehashing.
+ * Size hints are normally only available at creation (LuaHashMap_CreateWithSizeHints). 
+ * Use this when you know a burst of inserts is coming so Lua doesn't have to go through a cascade of rehashes as the table grows.
+ * Because Lua has no API to resize an existing table, this builds a new table of the requested size 
+ * and copies all the existing entries into it in one O(n) pass. So call it once before the burst, not repeatedly.
+ * This never shrinks the table. If both sizes are already covered (by the current number of entries, an earlier Reserve, 
+ * or the creation size hints), this does nothing, so repeating the same Reserve is cheap.
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param number_of_array_elements Lua tables double as both arrays and hash tables in Lua. As such, this parameter let's you pre-size the number of array elements. Most users of this library will probably use 0 because they don't need the array part.
+ * @param number_of_hash_elements This parameter is used to pre-size the number of hash buckets.
+ *
+ * @warning Any existing iterators for this hash_map are invalidated.
+ * @see LuaHashMap_CreateWithSizeHints
+ */
+LUAHASHMAP_EXPORT void LuaHashMap_Reserve(LuaHashMap* hash_map, int number_of_array_elements, int number_of_hash_elements);
+/**
+ * Shrinks the hash table to fit exactly the number of entries it currently holds.
+ * Lua never shrinks a table when entries are removed (nil'd), so after heavy churn a table can be many times larger than its live contents. 
+ * Unlike LuaHashMap_Purge, this preserves all the entries. Like LuaHashMap_Reserve, this builds a new table and copies all the entries into it in one O(n) pass.
+ * Integer keys 1..n (the length of the table) are kept in the array part and the rest go in the hash part.
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param should_collect_garbage If true, a full garbage collection is run on the lua_State afterwards to reclaim the old table immediately (like Purge).
+ * If false, the old table is left for the garbage collector to reclaim at its own pace which avoids a full collection pause.
+ *
+ * @warning Any existing iterators for this hash_map are invalidated.
+ * @see LuaHashMap_GetUnusedCapacityRatio, LuaHashMap_Purge
+ */
+LUAHASHMAP_EXPORT void LuaHashMap_Compact(LuaHashMap* hash_map, bool should_collect_garbage);
+/**
+ * Returns an estimate of the fraction of the table's capacity that is not holding live entries.
+ * Lua does not expose the real size of a table, so the capacity is estimated from the largest size the table is known to have grown to (or was sized for)
+ * since it was created, purged, reserved, or compacted. Use this to decide when LuaHashMap_Compact is worthwhile.
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @return Returns a value from 0.0 (no unused capacity) to 1.0 (nothing is in use).
+ *
+ * @note This is unused capacity, not a count of deleted slots: slots left behind by removes 
+ * and room the table has not grown into yet (Lua sizes the hash part in powers of 2) look the same.
+ * So a freshly reserved table reports a high ratio too.
+ * @note Lua may on its own shrink a table when it rehashes during an insert, so this can overestimate.
+ * @see LuaHashMap_Compact
+ */
+LUAHASHMAP_EXPORT double LuaHashMap_GetUnusedCapacityRatio(LuaHashMap* hash_map);
+
+/** @} */
+
+/** @defgroup GCFamily Garbage collector family of functions
+ *  @{
+ */
+/**
+ * Sets the garbage collector policy for the lua_State used by the hash map.
+ * By default, Lua runs its garbage collector automatically in incremental steps whenever enough memory has been allocated,
+ * which means collector pauses can happen in the middle of your Set/Get calls (string keys in particular generate allocations).
+ * Maps that only use pointer and number keys and values produce no garbage, so you might stop the collector entirely.
+ * Or you might stop it and run LuaHashMap_GCStep yourself at convenient times (e.g. an idle callback).
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param gc_mode The LuaHashMapGCMode to use.
+ * @return Returns true on success. Returns false if the mode is not supported by the version of Lua you built against (the mode is left unchanged).
+ *
+ * @note The garbage collector belongs to the lua_State, so this affects all hash maps sharing the same lua_State (CreateShare).
+ * @see LuaHashMap_GCStep, LuaHashMap_GetGCMode
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_SetGCMode(LuaHashMap* hash_map, LuaHashMapGCMode gc_mode);
+/**
+ * Returns the garbage collector mode last set through LuaHashMap_SetGCMode on this hash map or any hash map sharing its lua_State.
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @return Returns the LuaHashMapGCMode. The default is LUAHASHMAP_GCMODE_INCREMENTAL.
+ * @see LuaHashMap_SetGCMode
+ */
+LUAHASHMAP_EXPORT LuaHashMapGCMode LuaHashMap_GetGCMode(LuaHashMap* hash_map);
+/**
+ * Performs an incremental step of garbage collection.
+ * This works even when the collector is stopped (LUAHASHMAP_GCMODE_STOPPED) and it stays stopped afterwards.
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param step_size The size of the step. This is passed directly to lua_gc(LUA_GCSTEP) and is roughly in kilobytes of allocation work. 
+ * 0 performs one basic step. Larger values do more work per call.
+ * @return Returns true if the step finished a garbage collection cycle.
+ *
+ * @note The garbage collector belongs to the lua_State, so this affects all hash maps sharing the same lua_State (CreateShare).
+ * @see LuaHashMap_SetGCMode
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_GCStep(LuaHashMap* hash_map, int step_size);
+
+/** @} */
+
+
+/** @defgroup ExactIntegerFamily Exact integer family of functions
+ *  @{
+ */
+/**
+ * Makes lua_Integer keys and values exact for the full range of lua_Integer.
+ * Lua 5.3 and later have a native integer subtype so integers are always exact and this mode is always on.
+ * Before Lua 5.3, every number is a lua_Number (double), so two 64-bit integers above 2^53 that differ only in their low bits
+ * silently become the same key. With this mode on, integers that cannot be represented exactly by a lua_Number are 
+ * stored as light userdata instead, while smaller integers are still stored as plain numbers.
+ * Iterators report these keys and values as LUA_TNUMBER and LuaHashMap_GetKeyIntegerAtIterator/LuaHashMap_GetCachedValueIntegerAtIterator return them exactly.
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param use_exact_integers true to enable exact integers, false to go back to the lua_Number representation.
+ * @return Returns true on success. Returns false if the mode can't be changed: the hash map is not empty 
+ * (existing keys would become unreachable), lua_Integer doesn't fit in a pointer, or (on Lua 5.3+) you tried to disable native integers.
+ *
+ * @warning Before Lua 5.3, with this mode on, light userdata in the table are assumed to be integers. 
+ * Don't mix pointer keys or values with integer keys or values in the same hash map.
+ * Also, a large integer key set by LuaHashMap_SetValue*ForKeyInteger is a different key than the same value set by LuaHashMap_SetValue*ForKeyNumber.
+ * @see LuaHashMap_GetExactIntegerMode
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_SetExactIntegerMode(LuaHashMap* hash_map, bool use_exact_integers);
+/**
+ * Returns whether lua_Integer keys and values are exact for this hash map.
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @return Returns true if integers are stored exactly. This is always true for Lua 5.3 and later.
+ * @see LuaHashMap_SetExactIntegerMode
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_GetExactIntegerMode(LuaHashMap* hash_map);
+
+/** @} */
+
+
+
+/* Iterator functions */
+	
+/** @defgroup IteratorFamily Iterator family of functions
+ *  @{
+ */
+
+
+/**
+ * Returns an iterator at the start position of the hash table.
+ * Returns an iterator at the start position of the hash table.
+ * This is what you use if you are going to iterate through the entire collection.
+ *
+ * @param hash_map The LuaHashMap instance to operate on. 
+ * @return Returns an iterator at the start position of the hash table. If there is a failure, a "NotFound" iterator will be returned. Use LuaHashMap_IteratorIsNotFound to detect if the iterator is bad.
+ * @see LuaHashMap_GetIteratorAtEnd, LuaHashMap_IteratorNext, LuaHashMap_IteratorIsNotFound
+ */
+LUAHASHMAP_EXPORT LuaHashMapIterator LuaHashMap_GetIteratorAtBegin(LuaHashMap* hash_map);
+/**
+ * Returns an iterator at the end position of the hash table.
+ * Returns an iterator at the end position of the hash table.
+ * This is what you use if you are going to iterate through the entire collection.
+ *
+ * @param hash_map The LuaHashMap instance to operate on. 
+ * @return Returns an iterator at the end position of the hash table. If there is a failure, a "NotFound" iterator will be returned. Use LuaHashMap_IteratorIsNotFound to detect if the iterator is bad.
+ *
+ * @note The end iterator doesn't actually point to the last item in the collection. It is actually one item past the end. It is analgous to a null/termination character in a string. So don't try to get the key or value from the end iterator because it won't give you anything useful.
+ *
+@code 	
+	for(LuaHashMapIterator hash_iterator = LuaHashMap_GetIteratorAtBegin(hash_map), hash_iterator_end = LuaHashMap_GetIteratorAtEnd(hash_map);
+		! LuaHashMap_IteratorIsEqual(&hash_iterator, &hash_iterator_end);
+		LuaHashMap_IteratorNext(&hash_iterator)
+	)
+	{
+		fprintf(stderr, "Price of %s: %lf\n", 
+				LuaHashMap_GetKeyStringAtIterator(&hash_iterator), 
+				LuaHashMap_GetCachedValueNumberAtIterator(&hash_iterator));
+	}
+@endcode
+ * @see LuaHashMap_IteratorNext, LuaHashMap_GetIteratorAtBegin, LuaHashMap_IteratorIsNotFound, LuaHashMap_IteratorIsEqual
+ */
+LUAHASHMAP_EXPORT LuaHashMapIterator LuaHashMap_GetIteratorAtEnd(LuaHashMap* hash_map);
+
+
+/**
+ * Increments the iterator to the next item in the hash table.
+ * Increments the iterator to the next item in the hash table.
+ * @param hash_iterator The LuaHashMapIterator instance to operate on. 
+ * @return Returns true if the iterator successfully went to the next item. False otherwise. This can be useful to know when to stop looping in a control loop.
+@code
+	// This pattern is good if you know you have at least one item in the hash.
+	LuaHashMapIterator hash_iterator = LuaHashMap_GetIteratorAtBegin(hash_map);
+	do
+	{
+		fprintf(stderr, "Price of %s: %lf\n", 
+				LuaHashMap_GetKeyStringAtIterator(&hash_iterator), 
+				LuaHashMap_GetCachedValueNumberAtIterator(&hash_iterator));
+		
+	} while(LuaHashMap_IteratorNext(&hash_iterator));
+@endcode
+ * @see LuaHashMap_GetIteratorAtEnd, LuaHashMap_GetIteratorAtBegin, LuaHashMap_IteratorIsNotFound
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_IteratorNext(LuaHashMapIterator* hash_iterator);
+
+/**
+ * Reads up to max_number_of_elements entries starting at the iterator's current entry and advances the iterator to the first entry not read.
+ * This does one table fetch and one continuous lua_next run per call, 
+ * which is much cheaper than calling LuaHashMap_IteratorNext and the accessors for every entry.
+ * Call it again with the same iterator to get the next batch. It returns 0 once the iterator reaches the end.
+ * @param hash_iterator The LuaHashMapIterator instance to operate on. 
+ * @param keys_array Receives the keys. Must have room for max_number_of_elements.
+ * @param values_array Receives the values. Must have room for max_number_of_elements. May be NULL if you only want the keys.
+ * @param max_number_of_elements The most entries to read.
+ * @return Returns the number of entries written to keys_array (and values_array).
+@code
+	LuaHashMapValue keys_array[256];
+	LuaHashMapValue values_array[256];
+	size_t number_of_elements;
+	LuaHashMapIterator hash_iterator = LuaHashMap_GetIteratorAtBegin(hash_map);
+	while((number_of_elements = LuaHashMap_IteratorNextBatch(&hash_iterator, keys_array, values_array, 256)) > 0)
+	{
+		ProcessBatch(keys_array, values_array, number_of_elements);
+	}
+@endcode
+ * @note String pointers are the Lua internalized strings. They remain valid only as long as the key/value stays in the hash table (the same as LuaHashMap_GetKeyStringAtIterator).
+ * @see LuaHashMap_IteratorNext, LuaHashMap_GetIteratorAtBegin
+ */
+LUAHASHMAP_EXPORT size_t LuaHashMap_IteratorNextBatch(LuaHashMapIterator* restrict hash_iterator, LuaHashMapValue* restrict keys_array, LuaHashMapValue* restrict values_array, size_t max_number_of_elements);
+
+/**
+ * Returns an iterator corresponding to the specified key.
+ * This returns an iterator corresponding to the specified key. 
+ * string version
+ * 
+ * The intent of this method is to allow you to do multiple operations at the current position without doing unnecessary additional hash look ups.
+ * The most common example is you want to test to see if a key/value pair actually exists in the hash table before trying to retrive the value.
+ * Using the GetIteratorForKey function, you do one hash lookup, and then you can test existence and extract the CachedValue from the iterator without any subsequent hash look ups.
+ *
+ * @param hash_map The LuaHashMap instance to operate on
+ * @param key_string The key for the key/value pair
+ * @return Returns an iterator at the position of the specified key. If there is a failure, a "NotFound" iterator will be returned. Use LuaHashMap_IteratorIsNotFound to detect if the iterator is bad.
+ * 
+ @code
+	// This is the one hash look up.
+	LuaHashMapIterator hash_iterator = LuaHashMap_GetIteratorForKeyString(hash_map, "foo");
+	// Thie remaining information is in the iterator itself which avoids another hash lookup.
+	bool exists = LuaHashMap_ExistsAtIterator(&hash_iterator);
+	if(exists)
+	{
+		fprintf(stderr, "The value for key="foo" exists: %lf\n", LuaHashMap_GetCachedValueNumberAtIterator(&hash_iterator));
+	}
+	else
+	{
+		fprintf(stderr, "The key/value pair for key="foo" does not exist\n");
+	}
+@endcode
+ * @see LuaHashMap_ExistsAtIterator, LuaHashMap_GetIteratorAtBegin, LuaHashMap_IteratorIsNotFound, LuaHashMap_GetIteratorForKeyStringWithLength
+ */
+LUAHASHMAP_EXPORT LuaHashMapIterator LuaHashMap_GetIteratorForKeyString(LuaHashMap* restrict hash_map, const char* restrict key_string);
+/**
+ * Returns an iterator corresponding to the specified key.
+ * This returns an iterator corresponding to the specified key. 
+ * string version
+ * This version allows you to specify the string length for the string if you already know it as an optimization.
+ * 
+ * The intent of this method is to allow you to do multiple operations at the current position without doing unnecessary additional hash look ups.
+ * The most common example is you want to test to see if a key/value pair actually exists in the hash table before trying to retrive the value.
+ * Using the GetIteratorForKey function, you do one hash lookup, and then you can test existence and extract the CachedValue from the iterator without any subsequent hash look ups.
+ *
+ * @param hash_map The LuaHashMap instance to operate on
+ * @param key_string The key for the key/value pair
+ * @param key_string_length The string length (strlen()) of the key string. (This does not count the \0 terminator character.)
+ * @return Returns an iterator at the position of the specified key. If there is a failure, a "NotFound" iterator will be returned. Use LuaHashMap_IteratorIsNotFound to detect if the iterator is bad.
+ * 
+ @code
+	// This is the one hash look up.
+	size_t key_string_length;
+	LuaHashMapIterator hash_iterator = LuaHashMap_GetIteratorForKeyStringWithLength(hash_map, "foo", &key_string_length);
+	bool exists = LuaHashMap_ExistsAtIterator(&hash_iterator);
+	// This information is in the iterator itself which avoids another hash lookup.
+	if(exists)
+	{
+		fprintf(stderr, "The value for key="foo" exists: %lf\n", LuaHashMap_GetCachedValueNumberAtIterator(&hash_iterator));
+	}
+	else
+	{
+		fprintf(stderr, "The key/value pair for key="foo" does not exist\n");
+	}
+@endcode
+ * @see LuaHashMap_ExistsAtIterator, LuaHashMap_GetIteratorAtBegin, LuaHashMap_IteratorIsNotFound, LuaHashMap_GetIteratorForKeyString
+ */
+LUAHASHMAP_EXPORT LuaHashMapIterator LuaHashMap_GetIteratorForKeyStringWithLength(LuaHashMap* restrict hash_map, const char* restrict key_string, size_t key_string_length);
+/**
+ * Returns an iterator corresponding to the specified key.
+ * This returns an iterator corresponding to the specified key. 
+ * pointer version
+ * 
+ * The intent of this method is to allow you to do multiple operations at the current position without doing unnecessary additional hash look ups.
+ * The most common example is you want to test to see if a key/value pair actually exists in the hash table before trying to retrive the value.
+ * Using the GetIteratorForKey function, you do one hash lookup, and then you can test existence and extract the CachedValue from the iterator without any subsequent hash look ups.
+ *
+ * @param hash_map The LuaHashMap instance to operate on
+ * @param key_pointer The key for the key/value pair
+ * @return Returns an iterator at the position of the specified key. If there is a failure, a "NotFound" iterator will be returned. Use LuaHashMap_IteratorIsNotFound to detect if the iterator is bad.
+ * 
+ @code
+	// This is the one hash look up.
+	LuaHashMapIterator hash_iterator = LuaHashMap_GetIteratorForKeyPointer(hash_map, fooptr);
+	bool exists = LuaHashMap_ExistsAtIterator(&hash_iterator);
+	// This information is in the iterator itself which avoids another hash lookup.
+	if(exists)
+	{
+		fprintf(stderr, "The value for key=fooptr exists: %lf\n", LuaHashMap_GetCachedValueNumberAtIterator(&hash_iterator));
+	}
+	else
+	{
+		fprintf(stderr, "The key/value pair for key=fooptr does not exist\n");
+	}
+@endcode
+ * @see LuaHashMap_ExistsAtIterator, LuaHashMap_GetIteratorAtBegin, LuaHashMap_IteratorIsNotFound
+ */
+LUAHASHMAP_EXPORT LuaHashMapIterator LuaHashMap_GetIteratorForKeyPointer(LuaHashMap* hash_map, void* key_pointer);
+/**
+ * Returns an iterator corresponding to the specified key.
+ * This returns an iterator corresponding to the specified key. 
+ * number version
+ * 
+ * The intent of this method is to allow you to do multiple operations at the current position without doing unnecessary additional hash look ups.
+ * The most common example is you want to test to see if a key/value pair actually exists in the hash table before trying to retrive the value.
+ * Using the GetIteratorForKey function, you do one hash lookup, and then you can test existence and extract the CachedValue from the iterator without any subsequent hash look ups.
+ *
+ * @param hash_map The LuaHashMap instance to operate on
+ * @param key_number The key for the key/value pair
+ * @return Returns an iterator at the position of the specified key. If there is a failure, a "NotFound" iterator will be returned. Use LuaHashMap_IteratorIsNotFound to detect if the iterator is bad.
+ * 
+ @code
+	// This is the one hash look up.
+	LuaHashMapIterator hash_iterator = LuaHashMap_GetIteratorForKeyPointer(hash_map, fooptr);
+	bool exists = LuaHashMap_ExistsAtIterator(&hash_iterator);
+	// This information is in the iterator itself which avoids another hash lookup.
+	if(exists)
+	{
+		fprintf(stderr, "The value for key=fooptr exists: %lf\n", LuaHashMap_GetCachedValueNumberAtIterator(&hash_iterator));
+	}
+	else
+	{
+		fprintf(stderr, "The key/value pair for key=fooptr does not exist\n");
+	}
+@endcode
+ * @see LuaHashMap_ExistsAtIterator, LuaHashMap_GetIteratorAtBegin, LuaHashMap_IteratorIsNotFound
+ */
+LUAHASHMAP_EXPORT LuaHashMapIterator LuaHashMap_GetIteratorForKeyNumber(LuaHashMap* hash_map, lua_Number key_number);
+/**
+ * Returns an iterator corresponding to the specified key.
+ * This returns an iterator corresponding to the specified key. 
+ * integer version
+ * 
+ * The intent of this method is to allow you to do multiple operations at the current position without doing unnecessary additional hash look ups.
+ * The most common example is you want to test to see if a key/value pair actually exists in the hash table before trying to retrive the value.
+ * Using the GetIteratorForKey function, you do one hash lookup, and then you can test existence and extract the CachedValue from the iterator without any subsequent hash look ups.
+ *
+ * @param hash_map The LuaHashMap instance to operate on
+ * @param key_integer The key for the key/value pair
+ * @return Returns an iterator at the position of the specified key. If there is a failure, a "NotFound" iterator will be returned. Use LuaHashMap_IteratorIsNotFound to detect if the iterator is bad.
+ * 
+ @code
+	// This is the one hash look up.
+	LuaHashMapIterator hash_iterator = LuaHashMap_GetIteratorForKeyPointer(hash_map, fooptr);
+	bool exists = LuaHashMap_ExistsAtIterator(&hash_iterator);
+	// This information is in the iterator itself which avoids another hash lookup.
+	if(exists)
+	{
+		fprintf(stderr, "The value for key=fooptr exists: %lf\n", LuaHashMap_GetCachedValueNumberAtIterator(&hash_iterator));
+	}
+	else
+	{
+		fprintf(stderr, "The key/value pair for key=fooptr does not exist\n");
+	}
+@endcode
+ * @see LuaHashMap_ExistsAtIterator, LuaHashMap_GetIteratorAtBegin, LuaHashMap_IteratorIsNotFound
+ */
+LUAHASHMAP_EXPORT LuaHashMapIterator LuaHashMap_GetIteratorForKeyInteger(LuaHashMap* hash_map, lua_Integer key_integer);
+
+#if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 199901L)
+/* Use the C99 inline if available to hint the compiler that this might benefit from inlining. 
+ * Since these functions are merely pulling data out of an already exposed struct, inlining seems reasonable.
+ */
+/**
+ * Returns true if the iterator is "NotFound".
+ * Returns true if the iterator is bad (i.e. you tried to get an iterator for a key that doesn't exist). 
+ *
+ * @param hash_iterator The LuaHashMapIterator instance to operate on. 
+ * @return Returns true if the iterator is "NotFound" or bad.
+ * @note End iterators are considered valid iterators and this function will return false on this case.
+ */
+LUAHASHMAP_EXPORT inline bool LuaHashMap_IteratorIsNotFound(const LuaHashMapIterator* hash_iterator)
+{
+	if(NULL == hash_iterator)
+	{
+		return true;
+	}
+	/* To make this distinct from a good iterator and an end iterator, whichTable==LUA_NOREF seems to be the only unique characteristic. */
+	if(LUA_NOREF == hash_iterator->whichTable)
+	{
+		return true;
+	}
+	else
+	{
+		return false;		
+	}
+}
+#else /* We are not using C99 inline so the standard declaration is here. */
+/**
+ * Returns true if the iterator is "NotFound".
+ * Returns true if the iterator is bad (i.e. you tried to get an iterator for a key that doesn't exist). 
+ *
+ * @param hash_iterator The LuaHashMapIterator instance to operate on. 
+ * @return Returns true if the iterator is "NotFound" or bad.
+ * @note End iterators are considered valid iterators and this function will return false on this case.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_IteratorIsNotFound(const LuaHashMapIterator* hash_iterator);
+#endif /* defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 199901L) */
+
+/**
+ * Returns true if two iterators are equal.
+ * Returns true if two iterators are equal.
+ * This generally means they are pointing to the same key/value pair in the same hash table.
+ *
+ * @param hash_iterator1 The first iterator that will be compared.
+ * @param hash_iterator2 The other iterator that will be compared.
+ * @return Returns true if the iterators are equal.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_IteratorIsEqual(const LuaHashMapIterator* hash_iterator1, const LuaHashMapIterator* hash_iterator2);
+
+
+/* SetValueAtIterator family */
+/**
+ * Updates a value in the hash table pointed to by the iterator.
+ * Updates a value in the hash table pointed to by the iterator.
+ * The iterator must be a valid iterator (i.e. the key it points to must already be in the hash table).
+ * This will not insert new key/value pairs into the hash table.
+ * string version
+ *
+ * @param hash_iterator The LuaHashMapIterator instance pointing to the key/value pair you want to update the value to.
+ * @param value_string The value for the key. NULL value strings are treated as strings with length=0 ("").
+ *
+ * @note Lua copies strings and internalizes them. This means Lua/LuaHashMap have its own copy of the string and you are free to delete your string if you are done with it.
+ * @see LuaHashMap_SetValueStringAtIteratorWithLength
+ */
+LUAHASHMAP_EXPORT void LuaHashMap_SetValueStringAtIterator(LuaHashMapIterator* restrict hash_iterator, const char* restrict value_string);
+/**
+ * Updates a value in the hash table pointed to by the iterator.
+ * Updates a value in the hash table pointed to by the iterator.
+ * The iterator must be a valid iterator (i.e. the key it points to must already be in the hash table).
+ * This will not insert new key/value pairs into the hash table.
+ * string version
+ * This version allows you to specify the string length for each string if you already know it as an optimization.
+ *
+ * @param hash_iterator The LuaHashMapIterator instance pointing to the key/value pair you want to update the value to.
+ * @param value_string The value for the key. NULL value strings are treated as strings with length=0 ("").
+ * @param value_string_length The string length (strlen()) of the value string. (This does not count the \0 terminator character.)
+ *
+ * @note Lua copies strings and internalizes them. This means Lua/LuaHashMap have its own copy of the string and you are free to delete your string if you are done with it.
+ * @see LuaHashMap_SetValueStringAtIterator
+ */
+LUAHASHMAP_EXPORT void LuaHashMap_SetValueStringAtIteratorWithLength(LuaHashMapIterator* restrict hash_iterator, const char* restrict value_string, size_t value_string_length);
+/**
+ * Updates a value in the hash table pointed to by the iterator.
+ * Updates a value in the hash table pointed to by the iterator.
+ * The iterator must be a valid iterator (i.e. the key it points to must already be in the hash table).
+ * This will not insert new key/value pairs into the hash table.
+ * pointer version
+ *
+ * @param hash_iterator The LuaHashMapIterator instance pointing to the key/value pair you want to update the value to.
+ * @param value_pointer The value for the key. NULL key pointers are allowed as legitimate values.
+ */
+LUAHASHMAP_EXPORT void LuaHashMap_SetValuePointerAtIterator(LuaHashMapIterator* hash_iterator, void* value_pointer);
+/**
+ * Updates a value in the hash table pointed to by the iterator.
+ * Updates a value in the hash table pointed to by the iterator.
+ * The iterator must be a valid iterator (i.e. the key it points to must already be in the hash table).
+ * This will not insert new key/value pairs into the hash table.
+ * number version
+ *
+ * @param hash_iterator The LuaHashMapIterator instance pointing to the key/value pair you want to update the value to.
+ * @param value_number The value for the key. NULL key pointers are allowed as legitimate values.
+ */
+LUAHASHMAP_EXPORT void LuaHashMap_SetValueNumberAtIterator(LuaHashMapIterator* hash_iterator, lua_Number value_number);
+/**
+ * Updates a value in the hash table pointed to by the iterator.
+ * Updates a value in the hash table pointed to by the iterator.
+ * The iterator must be a valid iterator (i.e. the key it points to must already be in the hash table).
+ * This will not insert new key/value pairs into the hash table.
+ * integer version
+ *
+ * @param hash_iterator The LuaHashMapIterator instance pointing to the key/value pair you want to update the value to.
+ * @param value_integer The value for the key. NULL key pointers are allowed as legitimate values.
+ */
+LUAHASHMAP_EXPORT void LuaHashMap_SetValueIntegerAtIterator(LuaHashMapIterator* hash_iterator, lua_Integer value_integer);
+
+
+
+
+/**
+ * Returns the value in the hash table pointed to by the iterator.
+ * Returns the value in the hash table pointed to by the iterator.
+ * string version
+ *
+ * @param hash_iterator The LuaHashMapIterator instance pointing to the key/value pair you want to retrieve.
+ * @return Returns the Lua internalized pointer for the key string. 
+ *
+ * @note If you follow the expected use pattern of the API, then you generally don't need to call this function and you want the CachedValue version of this function. As long as you don't modify the hash table behind the back of your iterator, its cached value should be up-to-date, avoiding the need for another full hash table look up.
+ * @see LuaHashMap_GetCachedValueStringAtIterator, LuaHashMap_GetValueStringAtIteratorWithLength
+ */
+LUAHASHMAP_EXPORT const char* LuaHashMap_GetValueStringAtIterator(LuaHashMapIterator* hash_iterator);
+/**
+ * Returns the value in the hash table pointed to by the iterator.
+ * Returns the value in the hash table pointed to by the iterator.
+ * string version
+ * This version allows you to specify the string length for the string if you already know it as an optimization.
+ *
+ * @param hash_iterator The LuaHashMapIterator instance pointing to the key/value pair you want to retrieve.
+ * @param value_string_length_return This returns by reference the string length (strlen()) of the returned value string. You may pass NULL to ignore this result. 
+ * @return Returns the Lua internalized pointer for the key string. 
+ *
+ * @note If you follow the expected use pattern of the API, then you generally don't need to call this function and you want the CachedValue version of this function. As long as you don't modify the hash table behind the back of your iterator, its cached value should be up-to-date, avoiding the need for another full hash table look up.
+ * @see LuaHashMap_GetCachedValueStringAtIteratorWithLength, LuaHashMap_GetValueStringAtIterator
+ */
+LUAHASHMAP_EXPORT const char* LuaHashMap_GetValueStringAtIteratorWithLength(LuaHashMapIterator* restrict hash_iterator, size_t* restrict value_string_length_return);
+/**
+ * Returns the value in the hash table pointed to by the iterator.
+ * Returns the value in the hash table pointed to by the iterator.
+ * pointer version
+ *
+ * @param hash_iterator The LuaHashMapIterator instance pointing to the key/value pair you want to retrieve.
+ * @return Returns the value for the key.
+ *
+ * @note If you follow the expected use pattern of the API, then you generally don't need to call this function and you want the CachedValue version of this function. As long as you don't modify the hash table behind the back of your iterator, its cached value should be up-to-date, avoiding the need for another full hash table look up.
+ * @see LuaHashMap_GetCachedValuePointerAtIterator
+ */
+LUAHASHMAP_EXPORT void* LuaHashMap_GetValuePointerAtIterator(LuaHashMapIterator* hash_iterator);
+/**
+ * Returns the value in the hash table pointed to by the iterator.
+ * Returns the value in the hash table pointed to by the iterator.
+ * pointer version
+ *
+ * @param hash_iterator The LuaHashMapIterator instance pointing to the key/value pair you want to retrieve.
+ * @return Returns the value for the key.
+ *
+ * @note If you follow the expected use pattern of the API, then you generally don't need to call this function and you want the CachedValue version of this function. As long as you don't modify the hash table behind the back of your iterator, its cached value should be up-to-date, avoiding the need for another full hash table look up.
+ * @see LuaHashMap_GetCachedValuePointerAtIterator
+ */
+LUAHASHMAP_EXPORT lua_Number LuaHashMap_GetValueNumberAtIterator(LuaHashMapIterator* hash_iterator);
+/**
+ * Returns the value in the hash table pointed to by the iterator.
+ * Returns the value in the hash table pointed to by the iterator.
+ * pointer version
+ *
+ * @param hash_iterator The LuaHashMapIterator instance pointing to the key/value pair you want to retrieve.
+ * @return Returns the value for the key.
+ *
+ * @note If you follow the expected use pattern of the API, then you generally don't need to call this function and you want the CachedValue version of this function. As long as you don't modify the hash table behind the back of your iterator, its cached value should be up-to-date, avoiding the need for another full hash table look up.
+ * @see LuaHashMap_GetCachedValuePointerAtIterator
+ */
+LUAHASHMAP_EXPORT lua_Integer LuaHashMap_GetValueIntegerAtIterator(LuaHashMapIterator* hash_iterator);
+
+
+
+/* LuaHashMapIterator struct accessor functions. */
+
+/**
+ * Returns whether a key/value pair exists in the hash table pointed to by the iterator.
+ * Returns whether a key/value pair exists in the hash table pointed to by the iterator.
+ *
+ * @param hash_iterator The LuaHashMapIterator instance pointing to the key/value pair 
+ * @return Returns true if the key/value pair exists in the hash table. Returns false otherwise.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_ExistsAtIterator(LuaHashMapIterator* hash_iterator);
+/**
+ * Removes a key/value pair in the hash table pointed to by the iterator.
+ * Removes a key/value pair in the hash table pointed to by the iterator.
+ *
+ * @param hash_iterator The LuaHashMapIterator instance pointing to the key/value pair 
+ */
+LUAHASHMAP_EXPORT void LuaHashMap_RemoveAtIterator(LuaHashMapIterator* hash_iterator);
+
+/**
+ * Returns the type of the value in the hash table pointed to by the iterator.
+ * This returns the type (e.g. string, pointer, number) of the value  in the hash table pointed to by the iterator.
+ * The integer return value corresponds directly to Lua's types.
+ * Valid values are LUA_TSTRING, LUA_TLIGHTUSERDATA, LUA_TNUMBER.
+ * (LUA_TNONE may appear in the case of an error.)
+ *
+ * This information is particularly useful if you want to store different types within the same hash table.
+ * You can use this information to dynamically discover which type is stored and then call the correct Get<T> function.
+ *
+ * @param hash_iterator The LuaHashMapIterator instance to operate on.
+ * @return Returns an integer corresponding to Lua's mapping of types. Valid values should be LUA_TSTRING, LUA_TLIGHTUSERDATA, LUA_TNUMBER.
+ *
+ * @note This version does a full hash look up to retrieve the value. Use LuaHashMap_GetCachedValueTypeAtIterator to avoid a full look up.
+ *
+ * @warning (Canonical) Lua does not have a way to distinguish whether the number is a lua_Number or lua_Integer. (It is assumed lua_Number.)
+ * If you need to keep integers and floating point distinct, use different hash map instances to keep them separated.
+ *
+ * @see LuaHashMap_GetCachedValueTypeAtIterator
+ */
+LUAHASHMAP_EXPORT int LuaHashMap_GetValueTypeAtIterator(LuaHashMapIterator* hash_iterator);
+
+
+#if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 199901L)
+/* Use the C99 inline if available to hint the compiler that this might benefit from inlining. 
+ * Since these functions are merely pulling data out of an already exposed struct, inlining seems reasonable.
+ */
+
+/**
+ * Returns the type of the key in the iterator.
+ * This returns the type (e.g. string, pointer, number) of the key in the iterator.
+ * The integer return value corresponds directly to Lua's types.
+ * Valid values are LUA_TSTRING, LUA_TLIGHTUSERDATA, LUA_TNUMBER.
+ * (LUA_TNONE may appear in the case of an error.)
+ *
+ * This information is particularly useful if you want to store different types within the same hash table.
+ * You can use this information to dynamically discover which type is stored and then call the correct Get<T> function.
+ *
+ * @param hash_iterator The LuaHashMapIterator instance to operate on.
+ * @return Returns an integer corresponding to Lua's mapping of types. Valid values should be LUA_TSTRING, LUA_TLIGHTUSERDATA, LUA_TNUMBER.
+ *
+ * @note This simply pulls the key type directly from the struct. This does not involve a full hash look up.
+ *
+ * @warning (Canonical) Lua does not have a way to distinguish whether the number is a lua_Number or lua_Integer. (It is assumed lua_Number.)
+ * If you need to keep integers and floating point distinct, use different hash map instances to keep them separated.
+ */
+LUAHASHMAP_EXPORT inline int LuaHashMap_GetKeyTypeAtIterator(const LuaHashMapIterator* hash_iterator)
+{
+	if(NULL == hash_iterator)
+	{
+		return LUA_TNONE;
+	}
+	return hash_iterator->keyType;
+}
+
+/**
+ * Returns the key corresponding to the iterator.
+ * Returns the key corresponding to the current location of the iterator.
+ * string version
+ * This version allows you to specify the string length for the string if you already know it as an optimization.
+ *
+ * @param hash_iterator The LuaHashMapIterator instance to operate on.
+ * @return Returns the Lua internalized pointer for the key string.
+ *
+ * @note This simply pulls the key directly from the struct. This does not involve a full hash look up.
+ */
+LUAHASHMAP_EXPORT inline const char* LuaHashMap_GetKeyStringAtIterator(const LuaHashMapIterator* hash_iterator)
+{
+	if(NULL == hash_iterator)
+	{
+		return NULL;
+	}
+	if(true == hash_iterator->atEnd)
+	{
+		return NULL;
+	}
+	if(true == hash_iterator->isNext)
+	{
+		return NULL;
+	}
+	if(LUA_TSTRING == hash_iterator->keyType)
+	{
+        return hash_iterator->currentKey.theString.stringPointer;
+	}
+	else
+	{
+		/* shouldn't get here */
+		/* LUAHASHMAP_ASSERT(false); */
+		return NULL;
+	}
+}
+/**
+ * Returns the key corresponding to the iterator.
+ * Returns the key corresponding to the current location of the iterator.
+ * string version
+ * This version allows you to specify the string length for the string if you already know it as an optimization.
+ *
+ * @param hash_iterator The LuaHashMapIterator instance to operate on.
+ * @param key_string_length_return This returns by reference the string length (strlen()) of the returned key string. You may pass NULL to ignore this result. 
+ * @return Returns the Lua internalized pointer for the key string. 
+ *
+ * @note This simply pulls the key directly from the struct. This does not involve a full hash look up.
+ */
+LUAHASHMAP_EXPORT inline const char* LuaHashMap_GetKeyStringAtIteratorWithLength(const LuaHashMapIterator* restrict hash_iterator, size_t* restrict key_string_length_return)
+{
+	if(NULL == hash_iterator)
+	{
+		if(NULL != key_string_length_return)
+		{
+			*key_string_length_return = 0;
+		}
+		return NULL;
+	}
+	if(true == hash_iterator->atEnd)
+	{
+		if(NULL != key_string_length_return)
+		{
+			*key_string_length_return = 0;
+		}
+		return NULL;
+	}
+	if(true == hash_iterator->isNext)
+	{
+		if(NULL != key_string_length_return)
+		{
+			*key_string_length_return = 0;
+		}
+		return NULL;
+	}
+
+	if(NULL != key_string_length_return)
+	{
+		*key_string_length_return = hash_iterator->currentKey.theString.stringLength;
+	}
+
+	if(LUA_TSTRING == hash_iterator->keyType)
+	{
+        return hash_iterator->currentKey.theString.stringPointer;
+	}
+	else
+	{
+		/* shouldn't get here */
+		/* LUAHASHMAP_ASSERT(false); */
+		return NULL;
+	}
+}
+/**
+ * Returns the string length of the key corresponding to the iterator.
+ * Returns the string length of the key corresponding to the current location of the iterator.
+ *
+ * @param hash_iterator The LuaHashMapIterator instance to operate on.
+ * @return Returns the string length (strlen()) of the key pointer.
+ *
+ * @note This simply pulls the key directly from the struct. This does not involve a full hash look up.
+ */
+LUAHASHMAP_EXPORT inline size_t LuaHashMap_GetKeyStringLengthAtIterator(const LuaHashMapIterator* hash_iterator)
+{
+	if(NULL == hash_iterator)
+	{
+		return 0;
+	}
+	if(true == hash_iterator->atEnd)
+	{
+		return 0;
+	}
+	if(true == hash_iterator->isNext)
+	{
+		return 0;
+	}
+	
+	if(LUA_TSTRING == hash_iterator->keyType)
+	{
+        return hash_iterator->currentKey.theString.stringLength;
+	}
+	else
+	{
+		/* shouldn't get here */
+		/* LUAHASHMAP_ASSERT(false); */
+		return 0;
+	}
+}
+/**
+ * Returns the key corresponding to the iterator.
+ * Returns the key corresponding to the current location of the iterator.
+ * pointer version
+ *
+ * @param hash_iterator The LuaHashMapIterator instance to operate on.
+ * @return Returns the key pointer.
+ *
+ * @note This simply pulls the key directly from the struct. This does not involve a full hash look up.
+ */
+LUAHASHMAP_EXPORT inline void* LuaHashMap_GetKeyPointerAtIterator(const LuaHashMapIterator* hash_iterator)
+{
+	if(NULL == hash_iterator)
+	{
+		return NULL;
+	}
+	if(true == hash_iterator->atEnd)
+	{
+		return NULL;
+	}
+	if(true == hash_iterator->isNext)
+	{
+		return NULL;
+	}
+	
+	if(LUA_TLIGHTUSERDATA == hash_iterator->keyType)
+	{
+        return hash_iterator->currentKey.thePointer;
+	}
+	else
+	{
+		/* shouldn't get here */
+		/* LUAHASHMAP_ASSERT(false); */
+		return NULL;
+	}
+}
+/**
+ * Returns the key corresponding to the iterator.
+ * Returns the key corresponding to the current location of the iterator.
+ * number version
+ *
+ * @param hash_iterator The LuaHashMapIterator instance to operate on.
+ * @return Returns the key number.
+ *
+ * @note This simply pulls the key directly from the struct. This does not involve a full hash look up.
+ */
+LUAHASHMAP_EXPORT inline lua_Number LuaHashMap_GetKeyNumberAtIterator(const LuaHashMapIterator* hash_iterator)
+{
+	if(NULL == hash_iterator)
+	{
+		return 0.0;
+	}
+	if(true == hash_iterator->atEnd)
+	{
+		return 0.0;
+	}
+	if(true == hash_iterator->isNext)
+	{
+		return 0.0;
+	}
+	
+	if(LUA_TNUMBER == hash_iterator->keyType)
+	{
+		if(true == hash_iterator->isKeyInteger)
+		{
+			return (lua_Number)hash_iterator->currentKey.theInteger;
+		}
+        return hash_iterator->currentKey.theNumber;
+	}
+	else
+	{
+		/* shouldn't get here */
+		/* LUAHASHMAP_ASSERT(false); */
+		return 0.0;
+	}
+}
+/**
+ * Returns the key corresponding to the iterator.
+ * Returns the key corresponding to the current location of the iterator.
+ * integer version
+ *
+ * @param hash_iterator The LuaHashMapIterator instance to operate on.
+ * @return Returns the key integer.
+ *
+ * @note This simply pulls the key directly from the struct. This does not involve a full hash look up.
+ */
+LUAHASHMAP_EXPORT inline lua_Integer LuaHashMap_GetKeyIntegerAtIterator(const LuaHashMapIterator* hash_iterator)
+{
+	if(NULL == hash_iterator)
+	{
+		return 0;
+	}
+	if(true == hash_iterator->atEnd)
+	{
+		return 0;
+	}
+	if(true == hash_iterator->isNext)
+	{
+		return 0;
+	}
+	
+	if(LUA_TNUMBER == hash_iterator->keyType)
+	{
+		if(true == hash_iterator->isKeyInteger)
+		{
+			return hash_iterator->currentKey.theInteger;
+		}
+        return (lua_Integer)hash_iterator->currentKey.theNumber;
+	}
+	else
+	{
+		/* shouldn't get here */
+		/* LUAHASHMAP_ASSERT(false); */
+		return 0;
+	}
+}
+
+
+/**
+ * Returns the type of the cached value in the iterator.
+ * This returns the type (e.g. string, pointer, number) of the cached value in the iterator.
+ * The integer return value corresponds directly to Lua's types.
+ * Valid values are LUA_TSTRING, LUA_TLIGHTUSERDATA, LUA_TNUMBER.
+ * (LUA_TNONE may appear in the case of an error.)
+ *
+ * This information is particularly useful if you want to store different types within the same hash table.
+ * You can use this information to dynamically discover which type is stored and then call the correct Get<T> function.
+ *
+ * @param hash_iterator The LuaHashMapIterator instance to operate on.
+ * @return Returns an integer corresponding to Lua's mapping of types. Valid values should be LUA_TSTRING, LUA_TLIGHTUSERDATA, LUA_TNUMBER.
+ *
+ * @note This simply pulls the value type directly from the struct. This does not involve a full hash look up.
+ * If you follow the expected use pattern of the API (as long as you don't modify the hash table behind the back of your iterator), 
+ * its cached value should be up-to-date, avoiding the need to use the regular GetValue<T>AtIterator which requires another full hash table look up.
+ *
+ * @warning (Canonical) Lua does not have a way to distinguish whether the number is a lua_Number or lua_Integer. (It is assumed lua_Number.)
+ * If you need to keep integers and floating point distinct, use different hash map instances to keep them separated.
+ */
+LUAHASHMAP_EXPORT inline int LuaHashMap_GetCachedValueTypeAtIterator(const LuaHashMapIterator* hash_iterator)
+{
+	if(NULL == hash_iterator)
+	{
+		return LUA_TNONE;
+	}
+	if(true == hash_iterator->atEnd)
+	{
+		return LUA_TNONE;
+	}
+	if(true == hash_iterator->isNext)
+	{
+		return LUA_TNONE;
+	}
+	
+	return hash_iterator->valueType;
+}
+/**
+ * Returns the cached value saved in the iterator.
+ * Returns the cached value saved in the iterator.
+ * string version
+ *
+ * @param hash_iterator The LuaHashMapIterator instance to operate on.
+ * @return Returns the Lua internalized pointer for the key string. 
+ *
+ * @note This simply pulls the key directly from the struct. This does not involve a full hash look up.
+ * If you follow the expected use pattern of the API (as long as you don't modify the hash table behind the back of your iterator), 
+ * its cached value should be up-to-date, avoiding the need to use the regular GetValue<T>AtIterator which requires another full hash table look up.
+ */
+LUAHASHMAP_EXPORT inline const char* LuaHashMap_GetCachedValueStringAtIterator(const LuaHashMapIterator* hash_iterator)
+{
+	if(NULL == hash_iterator)
+	{
+		return NULL;
+	}
+	if(true == hash_iterator->atEnd)
+	{
+		return NULL;
+	}
+	if(true == hash_iterator->isNext)
+	{
+		return NULL;
+	}
+	if(LUA_TSTRING != hash_iterator->valueType)
+	{
+		return NULL;
+	}
+	return hash_iterator->currentValue.theString.stringPointer;
+}
+/**
+ * Returns the cached value saved in the iterator.
+ * Returns the cached value saved in the iterator.
+ * string version
+ * This version allows you to specify the string length for the string if you already know it as an optimization.
+ *
+ * @param hash_iterator The LuaHashMapIterator instance to operate on.
+ * @param value_string_length_return This returns by reference the string length (strlen()) of the returned key string. You may pass NULL to ignore this result. 
+ * @return Returns the Lua internalized pointer for the key string. 
+ *
+ * @note This simply pulls the key directly from the struct. This does not involve a full hash look up.
+ * If you follow the expected use pattern of the API (as long as you don't modify the hash table behind the back of your iterator), 
+ * its cached value should be up-to-date, avoiding the need to use the regular GetValue<T>AtIterator which requires another full hash table look up.
+ */
+LUAHASHMAP_EXPORT inline const char* LuaHashMap_GetCachedValueStringAtIteratorWithLength(const LuaHashMapIterator* restrict hash_iterator, size_t* restrict value_string_length_return)
+{
+	if(NULL == hash_iterator)
+	{
+		if(NULL != value_string_length_return)
+		{
+			*value_string_length_return = 0;
+		}
+		return NULL;
+	}
+	if(true == hash_iterator->atEnd)
+	{
+		if(NULL != value_string_length_return)
+		{
+			*value_string_length_return = 0;
+		}
+		return NULL;
+	}
+	if(true == hash_iterator->isNext)
+	{
+		if(NULL != value_string_length_return)
+		{
+			*value_string_length_return = 0;
+		}
+		return NULL;
+	}
+	if(LUA_TSTRING != hash_iterator->valueType)
+	{
+		if(NULL != value_string_length_return)
+		{
+			*value_string_length_return = 0;
+		}
+		return NULL;
+	}
+
+	if(NULL != value_string_length_return)
+	{
+		*value_string_length_return = hash_iterator->currentKey.theString.stringLength;
+	}
+
+	return hash_iterator->currentValue.theString.stringPointer;
+}
+/**
+ * Returns the string length of the cached value saved in the iterator.
+ * Returns the string length of the cached value saved in the current location of the iterator.
+ *
+ * @param hash_iterator The LuaHashMapIterator instance to operate on.
+ * @return Returns the string length (strlen()) of the key pointer.
+ *
+ * @note This simply pulls the key directly from the struct. This does not involve a full hash look up.
+ */
+LUAHASHMAP_EXPORT inline size_t LuaHashMap_GetCachedValueStringLengthAtIterator(const LuaHashMapIterator* hash_iterator)
+{
+	if(NULL == hash_iterator)
+	{
+		return 0;
+	}
+	if(true == hash_iterator->atEnd)
+	{
+		return 0;
+	}
+	if(true == hash_iterator->isNext)
+	{
+		return 0;
+	}
+	if(LUA_TSTRING != hash_iterator->valueType)
+	{
+		return 0;
+	}
+	return hash_iterator->currentValue.theString.stringLength;
+}
+/**
+ * Returns the cached value saved in the iterator.
+ * Returns the cached value saved in the iterator.
+ * pointer version
+ * This version allows you to specify the string length for the string if you already know it as an optimization.
+ *
+ * @param hash_iterator The LuaHashMapIterator instance to operate on.
+ * @return Returns the key pointer. 
+ *
+ * @note This simply pulls the key directly from the struct. This does not involve a full hash look up.
+ * If you follow the expected use pattern of the API (as long as you don't modify the hash table behind the back of your iterator), 
+ * its cached value should be up-to-date, avoiding the need to use the regular GetValue<T>AtIterator which requires another full hash table look up.
+ */
+LUAHASHMAP_EXPORT inline void* LuaHashMap_GetCachedValuePointerAtIterator(const LuaHashMapIterator* hash_iterator)
+{
+	if(NULL == hash_iterator)
+	{
+		return NULL;
+	}
+	if(true == hash_iterator->atEnd)
+	{
+		return NULL;
+	}
+	if(true == hash_iterator->isNext)
+	{
+		return NULL;
+	}
+	if(LUA_TLIGHTUSERDATA != hash_iterator->valueType)
+	{
+		return NULL;
+	}
+	return hash_iterator->currentValue.thePointer;
+}
+/**
+ * Returns the cached value saved in the iterator.
+ * Returns the cached value saved in the iterator.
+ * integer version
+ * This version allows you to specify the string length for the string if you already know it as an optimization.
+ *
+ * @param hash_iterator The LuaHashMapIterator instance to operate on.
+ * @return Returns the key integer. 
+ *
+ * @note This simply pulls the key directly from the struct. This does not involve a full hash look up.
+ * If you follow the expected use pattern of the API (as long as you don't modify the hash table behind the back of your iterator), 
+ * its cached value should be up-to-date, avoiding the need to use the regular GetValue<T>AtIterator which requires another full hash table look up.
+ */
+LUAHASHMAP_EXPORT inline lua_Number LuaHashMap_GetCachedValueNumberAtIterator(const LuaHashMapIterator* hash_iterator)
+{
+	if(NULL == hash_iterator)
+	{
+		return 0.0;
+	}
+	if(true == hash_iterator->atEnd)
+	{
+		return 0.0;
+	}
+	if(true == hash_iterator->isNext)
+	{
+		return 0.0;
+	}
+	if(LUA_TNUMBER != hash_iterator->valueType)
+	{
+		return 0.0;
+	}
+	if(true == hash_iterator->isValueInteger)
+	{
+		return (lua_Number)hash_iterator->currentValue.theInteger;
+	}
+	return hash_iterator->currentValue.theNumber;
+}
+/**
+ * Returns the cached value saved in the iterator.
+ * Returns the cached value saved in the iterator.
+ * integer version
+ * This version allows you to specify the string length for the string if you already know it as an optimization.
+ *
+ * @param hash_iterator The LuaHashMapIterator instance to operate on.
+ * @return Returns the key integer. 
+ *
+ * @note This simply pulls the key directly from the struct. This does not involve a full hash look up.
+ * If you follow the expected use pattern of the API (as long as you don't modify the hash table behind the back of your iterator), 
+ * its cached value should be up-to-date, avoiding the need to use the regular GetValue<T>AtIterator which requires another full hash table look up.
+ */
+LUAHASHMAP_EXPORT inline lua_Integer LuaHashMap_GetCachedValueIntegerAtIterator(const LuaHashMapIterator* hash_iterator)
+{
+	if(NULL == hash_iterator)
+	{
 		return 0;
 	}
-	if(LUA_TSTRING != hash_iterator->valueType)
+	if(true == hash_iterator->atEnd)
 	{
 		return 0;
 	}
-	return hash_iterator->currentValue.theString.stringLength;
+	if(true == hash_iterator->isNext)
+	{
+		return 0;
+	}
+	if(LUA_TNUMBER != hash_iterator->valueType)
+	{
+		return 0;
+	}
+	if(true == hash_iterator->isValueInteger)
+	{
+		return hash_iterator->currentValue.theInteger;
+	}
+	return (lua_Integer)hash_iterator->currentValue.theNumber;
 }
+
+#else /* We are not using C99 inline so the standard declaration is here. */
+
+/**
+ * Returns the type of the key in the iterator.
+ * This returns the type (e.g. string, pointer, number) of the key in the iterator.
+ * The integer return value corresponds directly to Lua's types.
+ * Valid values are LUA_TSTRING, LUA_TLIGHTUSERDATA, LUA_TNUMBER.
+ * (LUA_TNONE may appear in the case of an error.)
+ *
+ * This information is particularly useful if you want to store different types within the same hash table.
+ * You can use this information to dynamically discover which type is stored and then call the correct Get<T> function.
+ *
+ * @param hash_iterator The LuaHashMapIterator instance to operate on.
+ * @return Returns an integer corresponding to Lua's mapping of types. Valid values should be LUA_TSTRING, LUA_TLIGHTUSERDATA, LUA_TNUMBER.
+ *
+ * @note This simply pulls the key type directly from the struct. This does not involve a full hash look up.
+ *
+ * @warning (Canonical) Lua does not have a way to distinguish whether the number is a lua_Number or lua_Integer. (It is assumed lua_Number.)
+ * If you need to keep integers and floating point distinct, use different hash map instances to keep them separated.
+ */
+LUAHASHMAP_EXPORT int LuaHashMap_GetKeyTypeAtIterator(const LuaHashMapIterator* hash_iterator);
+
+/**
+ * Returns the key corresponding to the iterator.
+ * Returns the key corresponding to the current location of the iterator.
+ * string version
+ * This version allows you to specify the string length for the string if you already know it as an optimization.
+ *
+ * @param hash_iterator The LuaHashMapIterator instance to operate on.
+ * @return Returns the Lua internalized pointer for the key string.
+ *
+ * @note This simply pulls the key directly from the struct. This does not involve a full hash look up.
+ */
+LUAHASHMAP_EXPORT const char* LuaHashMap_GetKeyStringAtIterator(const LuaHashMapIterator* hash_iterator);
+/**
+ * Returns the key corresponding to the iterator.
+ * Returns the key corresponding to the current location of the iterator.
+ * string version
+ * This version allows you to specify the string length for the string if you already know it as an optimization.
+ *
+ * @param hash_iterator The LuaHashMapIterator instance to operate on.
+ * @param key_string_length_return This returns by reference the string length (strlen()) of the returned key string. You may pass NULL to ignore this result. 
+ * @return Returns the Lua internalized pointer for the key string. 
+ *
+ * @note This simply pulls the key directly from the struct. This does not involve a full hash look up.
+ */
+LUAHASHMAP_EXPORT const char* LuaHashMap_GetKeyStringAtIteratorWithLength(const LuaHashMapIterator* restrict hash_iterator, size_t* restrict key_string_length_return);
+/**
+ * Returns the string length of the key corresponding to the iterator.
+ * Returns the string length of the key corresponding to the current location of the iterator.
+ *
+ * @param hash_iterator The LuaHashMapIterator instance to operate on.
+ * @return Returns the string length (strlen()) of the key pointer.
+ *
+ * @note This simply pulls the key directly from the struct. This does not involve a full hash look up.
+ */
+LUAHASHMAP_EXPORT size_t LuaHashMap_GetKeyStringLengthAtIterator(const LuaHashMapIterator* hash_iterator);
+/**
+ * Returns the key corresponding to the iterator.
+ * Returns the key corresponding to the current location of the iterator.
+ * pointer version
+ *
+ * @param hash_iterator The LuaHashMapIterator instance to operate on.
+ * @return Returns the key pointer.
+ *
+ * @note This simply pulls the key directly from the struct. This does not involve a full hash look up.
+ */
+LUAHASHMAP_EXPORT void* LuaHashMap_GetKeyPointerAtIterator(const LuaHashMapIterator* hash_iterator);
+/**
+ * Returns the key corresponding to the iterator.
+ * Returns the key corresponding to the current location of the iterator.
+ * number version
+ *
+ * @param hash_iterator The LuaHashMapIterator instance to operate on.
+ * @return Returns the key number.
+ *
+ * @note This simply pulls the key directly from the struct. This does not involve a full hash look up.
+ */
+LUAHASHMAP_EXPORT lua_Number LuaHashMap_GetKeyNumberAtIterator(const LuaHashMapIterator* hash_iterator);
+/**
+ * Returns the key corresponding to the iterator.
+ * Returns the key corresponding to the current location of the iterator.
+ * integer version
+ *
+ * @param hash_iterator The LuaHashMapIterator instance to operate on.
+ * @return Returns the key integer.
+ *
+ * @note This simply pulls the key directly from the struct. This does not involve a full hash look up.
+ */
+LUAHASHMAP_EXPORT lua_Integer LuaHashMap_GetKeyIntegerAtIterator(const LuaHashMapIterator* hash_iterator);
+
+
+/**
+ * Returns the type of the cached value in the iterator.
+ * This returns the type (e.g. string, pointer, number) of the cached value in the iterator.
+ * The integer return value corresponds directly to Lua's types.
+ * Valid values are LUA_TSTRING, LUA_TLIGHTUSERDATA, LUA_TNUMBER.
+ * (LUA_TNONE may appear in the case of an error.)
+ *
+ * This information is particularly useful if you want to store different types within the same hash table.
+ * You can use this information to dynamically discover which type is stored and then call the correct Get<T> function.
+ *
+ * @param hash_iterator The LuaHashMapIterator instance to operate on.
+ * @return Returns an integer corresponding to Lua's mapping of types. Valid values should be LUA_TSTRING, LUA_TLIGHTUSERDATA, LUA_TNUMBER.
+ *
+ * @note This simply pulls the value type directly from the struct. This does not involve a full hash look up.
+ * If you follow the expected use pattern of the API (as long as you don't modify the hash table behind the back of your iterator), 
+ * its cached value should be up-to-date, avoiding the need to use the regular GetValue<T>AtIterator which requires another full hash table look up.
+ *
+ * @warning (Canonical) Lua does not have a way to distinguish whether the number is a lua_Number or lua_Integer. (It is assumed lua_Number.)
+ * If you need to keep integers and floating point distinct, use different hash map instances to keep them separated.
+ */
+LUAHASHMAP_EXPORT int LuaHashMap_GetCachedValueTypeAtIterator(const LuaHashMapIterator* hash_iterator);
+
+/**
+ * Returns the cached value saved in the iterator.
+ * Returns the cached value saved in the iterator.
+ * string version
+ * This version allows you to specify the string length for the string if you already know it as an optimization.
+ *
+ * @param hash_iterator The LuaHashMapIterator instance to operate on.
+ * @return Returns the Lua internalized pointer for the key string. 
+ *
+ * @note This simply pulls the key directly from the struct. This does not involve a full hash look up.
+ * If you follow the expected use pattern of the API (as long as you don't modify the hash table behind the back of your iterator), 
+ * its cached value should be up-to-date, avoiding the need to use the regular GetValue<T>AtIterator which requires another full hash table look up.
+ */
+LUAHASHMAP_EXPORT const char* LuaHashMap_GetCachedValueStringAtIterator(const LuaHashMapIterator* hash_iterator);
+/**
+ * Returns the cached value saved in the iterator.
+ * Returns the cached value saved in the iterator.
+ * string version
+ * This version allows you to specify the string length for the string if you already know it as an optimization.
+ *
+ * @param hash_iterator The LuaHashMapIterator instance to operate on.
+ * @param value_string_length_return This returns by reference the string length (strlen()) of the returned key string. You may pass NULL to ignore this result. 
+ * @return Returns the Lua internalized pointer for the key string. 
+ *
+ * @note This simply pulls the key directly from the struct. This does not involve a full hash look up.
+ * If you follow the expected use pattern of the API (as long as you don't modify the hash table behind the back of your iterator), 
+ * its cached value should be up-to-date, avoiding the need to use the regular GetValue<T>AtIterator which requires another full hash table look up.
+ */
+LUAHASHMAP_EXPORT const char* LuaHashMap_GetCachedValueStringAtIteratorWithLength(const LuaHashMapIterator* restrict hash_iterator, size_t* restrict value_string_length_return);
+/**
+ * Returns the string length of the cached value saved in the iterator.
+ * Returns the string length of the cached value saved in the current location of the iterator.
+ *
+ * @param hash_iterator The LuaHashMapIterator instance to operate on.
+ * @return Returns the string length (strlen()) of the key pointer.
+ *
+ * @note This simply pulls the key directly from the struct. This does not involve a full hash look up.
+ */
+LUAHASHMAP_EXPORT size_t LuaHashMap_GetCachedValueStringLengthAtIterator(const LuaHashMapIterator* hash_iterator);
+/**
+ * Returns the cached value saved in the iterator.
+ * Returns the cached value saved in the iterator.
+ * pointer version
+ * This version allows you to specify the string length for the string if you already know it as an optimization.
+ *
+ * @param hash_iterator The LuaHashMapIterator instance to operate on.
+ * @return Returns the key pointer. 
+ *
+ * @note This simply pulls the key directly from the struct. This does not involve a full hash look up.
+ * If you follow the expected use pattern of the API (as long as you don't modify the hash table behind the back of your iterator), 
+ * its cached value should be up-to-date, avoiding the need to use the regular GetValue<T>AtIterator which requires another full hash table look up.
+ */
+LUAHASHMAP_EXPORT void* LuaHashMap_GetCachedValuePointerAtIterator(const LuaHashMapIterator* hash_iterator);
 /**
  * Returns the cached value saved in the iterator.
  * Returns the cached value saved in the iterator.
- * pointer version
+ * number version
  * This version allows you to specify the string length for the string if you already know it as an optimization.
  *
  * @param hash_iterator The LuaHashMapIterator instance to operate on.
- * @return Returns the key pointer. 
+ * @return Returns the key number. 
  *
  * @note This simply pulls the key directly from the struct. This does not involve a full hash look up.
  * If you follow the expected use pattern of the API (as long as you don't modify the hash table behind the back of your iterator), 
  * its cached value should be up-to-date, avoiding the need to use the regular GetValue<T>AtIterator which requires another full hash table look up.
  */
-LUAHASHMAP_EXPORT inline void* LuaHashMap_GetCachedValuePointerAtIterator(const LuaHashMapIterator* hash_iterator)
-{
-	if(NULL == hash_iterator)
-	{
-		return NULL;
-	}
-	if(true == hash_iterator->atEnd)
-	{
-		return NULL;
-	}
-	if(true == hash_iterator->isNext)
+LUAHASHMAP_EXPORT lua_Number LuaHashMap_GetCachedValueNumberAtIterator(const LuaHashMapIterator* hash_iterator);
+/**
+ * Returns the cached value saved in the iterator.
+ * Returns the cached value saved in the iterator.
+ * integer version
+ * This version allows you to specify the string length for the string if you already know it as an optimization.
+ *
+ * @param hash_iterator The LuaHashMapIterator instance to operate on.
+ * @return Returns the key integer. 
+ *
+ * @note This simply pulls the key directly from the struct. This does not involve a full hash look up.
+ * If you follow the expected use pattern of the API (as long as you don't modify the hash table behind the back of your iterator), 
+ * its cached value should be up-to-date, avoiding the need to use the regular GetValue<T>AtIterator which requires another full hash table look up.
+ */
+LUAHASHMAP_EXPORT lua_Integer LuaHashMap_GetCachedValueIntegerAtIterator(const LuaHashMapIterator* hash_iterator);
+#endif /* defined(__STDC_VERSION__) && (__STDC_VERSION__ > 199901L) */
+
+/** @} */ 
+
+/** @defgroup CursorFamily Cursor family of functions
+ *  @{
+ */
+/**
+ * Creates a cursor for traversing the hash table.
+ * A LuaHashMapIterator is a plain struct, so every LuaHashMap_IteratorNext has to fetch the table and push (and re-hash) the current key again.
+ * A cursor instead owns a Lua thread (coroutine) whose stack holds the table and the current key between steps, 
+ * so LuaHashMap_CursorNext is a single lua_next. Since each cursor has its own stack, any number of cursors can be live at once, 
+ * including over different hash maps in the same CreateShare group, and the main stack is left alone.
+ * The cursor starts before the first entry. Call LuaHashMap_CursorNext to move onto the first entry.
+ *
+ * @param hash_map The LuaHashMap instance to traverse.
+ * @return Returns a new cursor, or NULL on failure. Free it with LuaHashMap_FreeCursor.
+@code
+	LuaHashMapCursor* hash_cursor = LuaHashMap_CreateCursor(hash_map);
+	while(LuaHashMap_CursorNext(hash_cursor))
 	{
-		return NULL;
+		const LuaHashMapIterator* hash_iterator = LuaHashMap_GetIteratorAtCursor(hash_cursor);
+		fprintf(stderr, "Price of %s: %lf\n", 
+			LuaHashMap_GetKeyStringAtIterator(hash_iterator), 
+			LuaHashMap_GetCachedValueNumberAtIterator(hash_iterator));
 	}
-	if(LUA_TLIGHTUSERDATA != hash_iterator->valueType)
+	LuaHashMap_FreeCursor(hash_cursor);
+@endcode
+ * @note As with lua_next, you may change or remove the current entry (or any existing entry) during the traversal, but adding new keys makes the rest of the traversal undefined.
+ * Purge, Reserve and Compact replace the table, so a cursor keeps walking the old table until LuaHashMap_CursorReset.
+ * @warning Cursors live inside the lua_State, so free every cursor before calling LuaHashMap_Free or LuaHashMap_FreeShare on its hash map. 
+ * Cursors are not a license to use one lua_State from several OS threads at once; that still needs your own locking.
+ * @see LuaHashMap_FreeCursor, LuaHashMap_CursorNext, LuaHashMap_GetIteratorAtCursor
+ */
+LUAHASHMAP_EXPORT LuaHashMapCursor* LuaHashMap_CreateCursor(LuaHashMap* hash_map);
+
+/**
+ * Frees a cursor created with LuaHashMap_CreateCursor.
+ * @param hash_cursor The cursor to free. NULL is ignored.
+ */
+LUAHASHMAP_EXPORT void LuaHashMap_FreeCursor(LuaHashMapCursor* hash_cursor);
+
+/**
+ * Moves the cursor back to before the first entry so the hash table can be traversed again.
+ * This also picks up a table that was replaced by Purge, Reserve or Compact.
+ * @param hash_cursor The cursor to operate on.
+ */
+LUAHASHMAP_EXPORT void LuaHashMap_CursorReset(LuaHashMapCursor* hash_cursor);
+
+/**
+ * Advances the cursor to the next entry.
+ * @param hash_cursor The cursor to operate on.
+ * @return Returns true if the cursor is on an entry, or false once the traversal has finished.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_CursorNext(LuaHashMapCursor* hash_cursor);
+
+/**
+ * Returns an iterator describing the cursor's current entry.
+ * Use it with LuaHashMap_GetKeyTypeAtIterator, LuaHashMap_GetKey<T>AtIterator, LuaHashMap_GetCachedValueTypeAtIterator and LuaHashMap_GetCachedValue<T>AtIterator.
+ * Copy it if you want to use the other iterator functions (e.g. LuaHashMap_SetValue<T>AtIterator). Advancing the copy does not move the cursor.
+ * @param hash_cursor The cursor to operate on.
+ * @return Returns a pointer owned by the cursor. It is updated in place by LuaHashMap_CursorNext and LuaHashMap_CursorReset. 
+ * Key string pointers remain valid while the cursor is on that entry.
+ */
+LUAHASHMAP_EXPORT const LuaHashMapIterator* LuaHashMap_GetIteratorAtCursor(const LuaHashMapCursor* hash_cursor);
+/** @} */ 
+
+/** @defgroup ScanFamily Scan family of functions
+ *  @{
+ */
+/**
+ * Creates a resumable scan for walking a large hash table in small slices while it keeps changing.
+ * Iterators and cursors are undefined if keys are added during the traversal, because inserting can rehash the table.
+ * A scan may be stepped with LuaHashMap_ScanNext across any number of Set, Remove, Clear, Purge, Reserve, Compact or Eval calls in between, 
+ * and guarantees that every key present for the whole scan is returned at least once.
+ * Keys added or removed during the scan may or may not be returned.
+ *
+ * As long as no key is added (and the table is not replaced), the scan is a plain continuous lua_next and returns every key exactly once.
+ * The first time it notices a key was added, it copies the keys currently in the table and finishes by walking that copy, 
+ * so keys already returned may be returned again. The copy costs one pass over the table and happens at most once per scan.
+ *
+ * @param hash_map The LuaHashMap instance to scan.
+ * @return Returns a new scan, or NULL on failure. Free it with LuaHashMap_FreeScan.
+@code
+	// Once per event loop tick
+	LuaHashMapValue keys_array[1000];
+	LuaHashMapValue values_array[1000];
+	size_t number_of_elements = LuaHashMap_ScanNext(hash_scan, keys_array, values_array, 1000);
+	ProcessBatch(keys_array, values_array, number_of_elements);
+	if(0 == number_of_elements)
 	{
-		return NULL;
+		LuaHashMap_FreeScan(hash_scan);
+		hash_scan = NULL;
 	}
-	return hash_iterator->currentValue.thePointer;
-}
+@endcode
+ * @warning Scans live inside the lua_State, so free every scan before calling LuaHashMap_Free or LuaHashMap_FreeShare on its hash map.
+ * Changes made through the raw lua_State (LuaHashMap_GetLuaState) are not seen by the scan; use LuaHashMap_Eval instead.
+ * @see LuaHashMap_FreeScan, LuaHashMap_ScanNext
+ */
+LUAHASHMAP_EXPORT LuaHashMapScan* LuaHashMap_CreateScan(LuaHashMap* hash_map);
+
+/**
+ * Frees a scan created with LuaHashMap_CreateScan. The scan does not need to be finished.
+ * @param hash_scan The scan to free. NULL is ignored.
+ */
+LUAHASHMAP_EXPORT void LuaHashMap_FreeScan(LuaHashMapScan* hash_scan);
+
+/**
+ * Returns the next slice of a scan.
+ * @param hash_scan The scan to operate on.
+ * @param keys_array Receives the keys. Must have room for max_number_of_elements.
+ * @param values_array Receives the values. Must have room for max_number_of_elements. May be NULL if you only want the keys.
+ * @param max_number_of_elements The most entries to return.
+ * @return Returns the number of entries written, or 0 once the scan is finished.
+ * @note String pointers are the Lua internalized strings. They remain valid only as long as the key/value stays in the hash table.
+ * @see LuaHashMap_CreateScan, LuaHashMap_IteratorNextBatch
+ */
+LUAHASHMAP_EXPORT size_t LuaHashMap_ScanNext(LuaHashMapScan* restrict hash_scan, LuaHashMapValue* restrict keys_array, LuaHashMapValue* restrict values_array, size_t max_number_of_elements);
+/** @} */ 
+
+/** @defgroup ForEachFamily ForEach family of functions
+ *  @{
+ */
+/**
+ * The callback type for LuaHashMap_ForEach.
+ * @param hash_iterator An iterator for the current key/value pair. 
+ * Use LuaHashMap_GetKeyTypeAtIterator, LuaHashMap_GetCachedValueTypeAtIterator, LuaHashMap_GetKey<T>AtIterator and LuaHashMap_GetCachedValue<T>AtIterator to read it.
+ * The iterator is only valid during the callback.
+ * @param user_data The user_data pointer passed to LuaHashMap_ForEach.
+ * @return Return 0 to continue the traversal or any other value to stop it.
+ */
+typedef int (*LuaHashMap_ForEachCallback)(const LuaHashMapIterator* hash_iterator, void* user_data);
+
+/**
+ * Calls a function for every key/value pair in the hash table.
+ * Calls a function for every key/value pair in the hash table in a single continuous traversal.
+ * This is faster than looping with LuaHashMap_IteratorNext because the current key is kept inside Lua between steps 
+ * instead of being re-pushed (and re-hashed for strings) and looked up again for every element.
+ * The traversal order is undefined, just like the iterators.
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param callback_function The function to call for each key/value pair. Return non-zero from it to stop early.
+ * @param user_data A pointer that is passed through to callback_function untouched.
+ * @return Returns the non-zero value returned by callback_function that stopped the traversal, or 0 if every pair was visited.
+ *
+ * @warning The traversal holds state on the lua_State stack, so callback_function must not call any other LuaHashMap function 
+ * on this hash_map or any hash_map sharing its lua_State. Use the iterator accessors on hash_iterator instead.
+ * @see LuaHashMap_GetIteratorAtBegin, LuaHashMap_IteratorNext
+ */
+LUAHASHMAP_EXPORT int LuaHashMap_ForEach(LuaHashMap* hash_map, LuaHashMap_ForEachCallback callback_function, void* user_data);
+/** @} */ 
+
+/** @defgroup RemoveIfFamily RemoveIf family of functions
+ *  @{
+ */
+/**
+ * The predicate type for LuaHashMap_RemoveIf.
+ * @param hash_iterator An iterator for the current key/value pair. Read it the same way as in LuaHashMap_ForEachCallback.
+ * @param user_data The user_data pointer passed to LuaHashMap_RemoveIf.
+ * @return Return non-zero to remove the current key/value pair. (This is an int instead of bool so the type is the same in C89, C99 and C++.)
+ */
+typedef int (*LuaHashMap_RemoveIfPredicate)(const LuaHashMapIterator* hash_iterator, void* user_data);
+
+/**
+ * Removes every key/value pair that a predicate function returns non-zero for.
+ * Removes every key/value pair that a predicate function returns non-zero for in a single traversal of the hash table.
+ * This is faster than looping with the iterators and calling LuaHashMap_RemoveAtIterator, 
+ * which must re-push the key and look ahead to the next key for every removal.
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param predicate_function The function to call for each key/value pair. Return non-zero from it to remove the pair.
+ * @param user_data A pointer that is passed through to predicate_function untouched.
+ * @return Returns the number of key/value pairs removed.
+ *
+ * @warning Like LuaHashMap_ForEach, predicate_function must not call any other LuaHashMap function 
+ * on this hash_map or any hash_map sharing its lua_State.
+ * @see LuaHashMap_ForEach, LuaHashMap_RemoveAtIterator
+ */
+LUAHASHMAP_EXPORT size_t LuaHashMap_RemoveIf(LuaHashMap* hash_map, LuaHashMap_RemoveIfPredicate predicate_function, void* user_data);
+/** @} */ 
+
+/** @defgroup TransformValuesFamily TransformValues family of functions
+ *  @{
+ */
+/**
+ * The callback type for LuaHashMap_TransformValues.
+ * @param hash_iterator An iterator for the current key/value pair. Read it the same way as in LuaHashMap_ForEachCallback.
+ * To change the value, write the new value into hash_iterator->currentValue and set hash_iterator->valueType 
+ * (LUA_TSTRING, LUA_TLIGHTUSERDATA or LUA_TNUMBER, with hash_iterator->isValueInteger saying whether theInteger or theNumber is used) and return non-zero.
+ * A new string is copied by Lua, so it only needs to stay valid until the callback returns. Set valueType to LUA_TNIL to remove the pair.
+ * @param user_data The user_data pointer passed to LuaHashMap_TransformValues.
+ * @return Return non-zero to store the (changed) value in hash_iterator, or 0 to leave the value as is.
+ */
+typedef int (*LuaHashMap_TransformValuesCallback)(LuaHashMapIterator* hash_iterator, void* user_data);
+/**
+ * The callback type for LuaHashMap_TransformValuesNumber.
+ * @param value_number The current value.
+ * @param user_data The user_data pointer passed to LuaHashMap_TransformValuesNumber.
+ * @return Return the new value.
+ */
+typedef lua_Number (*LuaHashMap_TransformValuesNumberCallback)(lua_Number value_number, void* user_data);
+/**
+ * The callback type for LuaHashMap_TransformValuesInteger.
+ * @param value_integer The current value.
+ * @param user_data The user_data pointer passed to LuaHashMap_TransformValuesInteger.
+ * @return Return the new value.
+ */
+typedef lua_Integer (*LuaHashMap_TransformValuesIntegerCallback)(lua_Integer value_integer, void* user_data);
+
+/**
+ * Rewrites values in place in a single traversal of the hash table.
+ * Rewrites values in place in a single traversal of the hash table.
+ * This is faster than looping with the iterators and calling LuaHashMap_SetValue<T>AtIterator, 
+ * which must re-push the key and look up the table for every element.
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param callback_function The function to call for each key/value pair. See LuaHashMap_TransformValuesCallback.
+ * @param user_data A pointer that is passed through to callback_function untouched.
+ * @return Returns the number of values that were changed (or removed).
+ *
+ * @warning Like LuaHashMap_ForEach, callback_function must not call any other LuaHashMap function 
+ * on this hash_map or any hash_map sharing its lua_State.
+ * @see LuaHashMap_TransformValuesNumber, LuaHashMap_TransformValuesInteger, LuaHashMap_ForEach
+ */
+LUAHASHMAP_EXPORT size_t LuaHashMap_TransformValues(LuaHashMap* hash_map, LuaHashMap_TransformValuesCallback callback_function, void* user_data);
+/**
+ * Rewrites every number value in place in a single traversal of the hash table.
+ * Rewrites every number value in place in a single traversal of the hash table.
+ * number version
+ * Values that are not numbers are skipped. This is the fast version of LuaHashMap_TransformValues for things like decaying every counter.
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param callback_function The function that computes the new value from the current one.
+ * @param user_data A pointer that is passed through to callback_function untouched.
+ * @return Returns the number of values that were rewritten.
+ *
+ * @warning callback_function must not call any LuaHashMap function on this hash_map or any hash_map sharing its lua_State.
+ * @see LuaHashMap_TransformValues, LuaHashMap_TransformValuesInteger
+ */
+LUAHASHMAP_EXPORT size_t LuaHashMap_TransformValuesNumber(LuaHashMap* hash_map, LuaHashMap_TransformValuesNumberCallback callback_function, void* user_data);
+/**
+ * Rewrites every number value in place in a single traversal of the hash table.
+ * Rewrites every number value in place in a single traversal of the hash table.
+ * integer version
+ * Values that are not numbers are skipped. Values are read and written as integers, the same as LuaHashMap_GetValueInteger<T> and LuaHashMap_SetValueInteger<T>.
+ * In Lua 5.3+, floats that have no exact integer value (e.g. 2.5) are skipped too, since lua_tointeger would read them as 0.
+ * (In Lua 5.1/5.2 they are truncated, like LuaHashMap_GetValueInteger<T>.)
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param callback_function The function that computes the new value from the current one.
+ * @param user_data A pointer that is passed through to callback_function untouched.
+ * @return Returns the number of values that were rewritten. Skipped values are not counted.
+ *
+ * @warning callback_function must not call any LuaHashMap function on this hash_map or any hash_map sharing its lua_State.
+ * @see LuaHashMap_TransformValues, LuaHashMap_TransformValuesNumber
+ */
+LUAHASHMAP_EXPORT size_t LuaHashMap_TransformValuesInteger(LuaHashMap* hash_map, LuaHashMap_TransformValuesIntegerCallback callback_function, void* user_data);
+/** @} */ 
+
+/** @defgroup AggregateFamily Aggregate family of functions
+ *  @{
+ */
+/**
+ * Summary statistics over a set of numbers, filled in by LuaHashMap_AggregateNumbers.
+ * min, max and mean are 0 when count is 0.
+ */
+struct LuaHashMapNumberStats
+{
+	size_t count; /**< How many numbers were seen. */
+	lua_Number sum; /**< The sum of all the numbers. */
+	lua_Number min; /**< The smallest number. */
+	lua_Number max; /**< The largest number. */
+	lua_Number mean; /**< sum/count */
+};
+typedef struct LuaHashMapNumberStats LuaHashMapNumberStats;
+
+/**
+ * The result of LuaHashMap_AggregateNumbers, with separate statistics for the number values and the number keys.
+ */
+struct LuaHashMapAggregateStats
+{
+	LuaHashMapNumberStats values; /**< Statistics over every value that is a number. */
+	LuaHashMapNumberStats keys; /**< Statistics over every key that is a number. */
+};
+typedef struct LuaHashMapAggregateStats LuaHashMapAggregateStats;
+
+/**
+ * Computes count, sum, min, max and mean of the number values and number keys in the hash table.
+ * Computes count, sum, min, max and mean of the number values and number keys in the hash table in a single traversal.
+ * Keys and values that are not numbers are skipped. Integers are included (converted to lua_Number).
+ * This is much faster than iterating from C because no per-element iterator work or look ups are done.
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param stats_return The struct to fill with the results. Everything is zeroed first.
+ */
+LUAHASHMAP_EXPORT void LuaHashMap_AggregateNumbers(LuaHashMap* hash_map, LuaHashMapAggregateStats* stats_return);
+/** @} */ 
+
+/** @defgroup EvalFamily Eval family of functions
+ *  @{
+ */
+/**
+ * Runs a Lua chunk inside the hash map's lua_State with the hash map's table as its first argument.
+ * Runs a Lua chunk inside the hash map's lua_State with the hash map's table as its first argument, followed by arguments_array.
+ * This lets filters, aggregations and bulk rewrites run entirely inside the Lua VM instead of crossing the C API for every element.
+ * The chunk sees its arguments through ..., e.g. "local map, threshold = ... local n = 0 for k, v in pairs(map) do if v > threshold then n = n + 1 end end return n"
+ * Compiled chunks are cached by their source, so repeating the same chunk skips the parser. 
+ * Only Lua source is accepted. Precompiled bytecode is rejected, since Lua doesn't verify it and a malformed chunk can corrupt memory.
+ * Chunks run in a private environment table, not the lua_State's globals, which Eval never touches.
+ * The environment is built the first time Eval is used on a lua_State and holds the base, string, table and math libraries, 
+ * minus the functions that reach outside it (dofile, loadfile, load, loadstring, getfenv, setfenv, collectgarbage, print, ...).
+ * Globals a chunk assigns land in that environment and are seen by later chunks on any hash map sharing the lua_State.
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ * @param lua_chunk The Lua source to run.
+ * @param lua_chunk_length The length of lua_chunk in bytes.
+ * @param arguments_array The arguments to pass after the table. May be NULL if number_of_arguments is 0.
+ * @param number_of_arguments The number of elements in arguments_array.
+ * @param result_return Receives the first value returned by the chunk, or the error message string on failure. May be NULL.
+ * Strings stay valid until the next Eval on this hash map, or until it is freed. Evals on other hash maps sharing the lua_State don't affect them.
+ * @return Returns true if the chunk compiled and ran without error. Returns false for precompiled bytecode.
+ *
+ * @warning The chunk must only store strings, numbers and nil in the table, since that is all LuaHashMap can read back.
+ * Only run trusted chunks: the environment is not a security boundary (e.g. the string metatable is shared).
+ * @note The element count is recomputed lazily after an Eval, so the next LuaHashMap_Count may be O(n).
+ * @see LuaHashMap_ClearEvalCache
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_Eval(LuaHashMap* restrict hash_map, const char* restrict lua_chunk, size_t lua_chunk_length, const LuaHashMapValue* restrict arguments_array, size_t number_of_arguments, LuaHashMapValue* restrict result_return);
+/**
+ * Releases the compiled chunks cached by LuaHashMap_Eval.
+ * Releases the compiled chunks cached by LuaHashMap_Eval for this hash map's lua_State (and all hash maps sharing it).
+ * Use this if you generate many different chunks, since the cache is never trimmed automatically.
+ * The Eval environment and the results returned by earlier Evals are kept.
+ *
+ * @param hash_map The LuaHashMap instance to operate on.
+ */
+LUAHASHMAP_EXPORT void LuaHashMap_ClearEvalCache(LuaHashMap* hash_map);
+/** @} */ 
+
+/** @defgroup ShardedFamily LuaHashMapSharded family of functions
+ *  @{
+ */
+/**
+ * A lua_State is single threaded, so one LuaHashMap can only ever keep one core busy.
+ * LuaHashMapSharded spreads keys across several completely independent LuaHashMap instances (each with its own lua_State and its own lock)
+ * so threads that hit different shards never wait on each other.
+ *
+ * The LuaHashMapSharded_ functions are thread-safe and mirror the LuaHashMap_ functions of the same name, 
+ * except that nothing hands out a pointer into a lua_State: once the shard is unlocked, another thread could remove the string and Lua would collect it.
+ * So the SetValue*ForKeyString functions return nothing, and string values are read with the LuaHashMapSharded_CopyValueString* functions instead of GetValueString*.
+ * Iteration is LuaHashMapSharded_ForEach, which holds each shard's lock while its callback runs.
+ * Keys are assigned to shards by a hash of the key contents (string bytes, pointer value, or integer value). 
+ * Whole number keys go to the same shard as the equivalent integer key, just as they are the same key in Lua.
+ */
+typedef struct LuaHashMapSharded LuaHashMapSharded;
+
+/**
+ * Creates a new sharded hash map.
+ * @param number_of_shards The number of independent LuaHashMap instances to spread the keys across. 
+ * More shards means less contention but more memory. A small multiple of the number of threads hitting the map is a good start.
+ * @return Returns a new sharded hash map, or NULL if number_of_shards is 0 or on failure.
+ * @see LuaHashMapSharded_Free
+ */
+LUAHASHMAP_EXPORT LuaHashMapSharded* LuaHashMapSharded_Create(size_t number_of_shards);
+
+/**
+ * Creates a new sharded hash map and pre-sizes the shards.
+ * @param number_of_shards The number of independent LuaHashMap instances to spread the keys across.
+ * @param number_of_hash_elements The total number of elements you expect. Each shard is sized for its share. See LuaHashMap_CreateWithSizeHints.
+ * @return Returns a new sharded hash map, or NULL if number_of_shards is 0 or on failure.
+ */
+LUAHASHMAP_EXPORT LuaHashMapSharded* LuaHashMapSharded_CreateWithSizeHints(size_t number_of_shards, int number_of_hash_elements);
+
+/**
+ * Frees a sharded hash map and all its shards. No other thread may be using it.
+ */
+LUAHASHMAP_EXPORT void LuaHashMapSharded_Free(LuaHashMapSharded* sharded_hash_map);
+
+/**
+ * Returns the number of shards the map was created with.
+ */
+LUAHASHMAP_EXPORT size_t LuaHashMapSharded_GetNumberOfShards(LuaHashMapSharded* sharded_hash_map);
+
+/**
+ * Returns the number of items in all shards.
+ * Each shard is counted under its own lock, so while other threads are writing this is a point-in-time estimate.
+ * @see LuaHashMap_Count
+ */
+LUAHASHMAP_EXPORT size_t LuaHashMapSharded_Count(LuaHashMapSharded* sharded_hash_map);
+
+/**
+ * Returns true if every shard is empty.
+ * @see LuaHashMap_IsEmpty
+ */
+LUAHASHMAP_EXPORT bool LuaHashMapSharded_IsEmpty(LuaHashMapSharded* sharded_hash_map);
+
+/**
+ * Clears every shard, one shard at a time.
+ * @see LuaHashMap_Clear
+ */
+LUAHASHMAP_EXPORT void LuaHashMapSharded_Clear(LuaHashMapSharded* sharded_hash_map);
+
+/**
+ * Calls a function for every key/value pair in every shard. 
+ * Each shard is locked while it is traversed, so other threads can keep using the other shards.
+ * @warning callback_function must not call any LuaHashMapSharded function on this map (the shard's lock is not recursive).
+ * @see LuaHashMap_ForEach
+ */
+LUAHASHMAP_EXPORT int LuaHashMapSharded_ForEach(LuaHashMapSharded* sharded_hash_map, LuaHashMap_ForEachCallback callback_function, void* user_data);
+
+/** Sharded version of LuaHashMap_SetValueStringForKeyString. @see LuaHashMap_SetValueStringForKeyString */
+LUAHASHMAP_EXPORT void LuaHashMapSharded_SetValueStringForKeyString(LuaHashMapSharded* restrict sharded_hash_map, const char* value_string, const char* key_string);
+
+/** Sharded version of LuaHashMap_SetValueStringForKeyStringWithLength. @see LuaHashMap_SetValueStringForKeyStringWithLength */
+LUAHASHMAP_EXPORT void LuaHashMapSharded_SetValueStringForKeyStringWithLength(LuaHashMapSharded* restrict sharded_hash_map, const char* value_string, const char* key_string, size_t value_string_length, size_t key_string_length);
+
+/** Sharded version of LuaHashMap_SetValuePointerForKeyString. @see LuaHashMap_SetValuePointerForKeyString */
+LUAHASHMAP_EXPORT void LuaHashMapSharded_SetValuePointerForKeyString(LuaHashMapSharded* sharded_hash_map, void* value_pointer, const char* key_string);
+
+/** Sharded version of LuaHashMap_SetValuePointerForKeyStringWithLength. @see LuaHashMap_SetValuePointerForKeyStringWithLength */
+LUAHASHMAP_EXPORT void LuaHashMapSharded_SetValuePointerForKeyStringWithLength(LuaHashMapSharded* sharded_hash_map, void* value_pointer, const char* key_string, size_t key_string_length);
+
+/** Sharded version of LuaHashMap_SetValueNumberForKeyString. @see LuaHashMap_SetValueNumberForKeyString */
+LUAHASHMAP_EXPORT void LuaHashMapSharded_SetValueNumberForKeyString(LuaHashMapSharded* restrict sharded_hash_map, lua_Number value_number, const char* restrict key_string);
+
+/** Sharded version of LuaHashMap_SetValueNumberForKeyStringWithLength. @see LuaHashMap_SetValueNumberForKeyStringWithLength */
+LUAHASHMAP_EXPORT void LuaHashMapSharded_SetValueNumberForKeyStringWithLength(LuaHashMapSharded* restrict sharded_hash_map, lua_Number value_number, const char* restrict key_string, size_t key_string_length);
+
+/** Sharded version of LuaHashMap_SetValueIntegerForKeyString. @see LuaHashMap_SetValueIntegerForKeyString */
+LUAHASHMAP_EXPORT void LuaHashMapSharded_SetValueIntegerForKeyString(LuaHashMapSharded* restrict sharded_hash_map, lua_Integer value_integer, const char* restrict key_string);
+
+/** Sharded version of LuaHashMap_SetValueIntegerForKeyStringWithLength. @see LuaHashMap_SetValueIntegerForKeyStringWithLength */
+LUAHASHMAP_EXPORT void LuaHashMapSharded_SetValueIntegerForKeyStringWithLength(LuaHashMapSharded* restrict sharded_hash_map, lua_Integer value_integer, const char* restrict key_string, size_t key_string_length);
+
+/** Sharded version of LuaHashMap_SetValueStringForKeyPointer. @see LuaHashMap_SetValueStringForKeyPointer */
+LUAHASHMAP_EXPORT void LuaHashMapSharded_SetValueStringForKeyPointer(LuaHashMapSharded* sharded_hash_map, const char* value_string, void* key_pointer);
+
+/** Sharded version of LuaHashMap_SetValueStringForKeyPointerWithLength. @see LuaHashMap_SetValueStringForKeyPointerWithLength */
+LUAHASHMAP_EXPORT void LuaHashMapSharded_SetValueStringForKeyPointerWithLength(LuaHashMapSharded* sharded_hash_map, const char* value_string, void* key_pointer, size_t value_string_length);
+
+/** Sharded version of LuaHashMap_SetValuePointerForKeyPointer. @see LuaHashMap_SetValuePointerForKeyPointer */
+LUAHASHMAP_EXPORT void LuaHashMapSharded_SetValuePointerForKeyPointer(LuaHashMapSharded* sharded_hash_map, void* value_pointer, void* key_pointer);
+
+/** Sharded version of LuaHashMap_SetValueNumberForKeyPointer. @see LuaHashMap_SetValueNumberForKeyPointer */
+LUAHASHMAP_EXPORT void LuaHashMapSharded_SetValueNumberForKeyPointer(LuaHashMapSharded* sharded_hash_map, lua_Number value_number, void* key_pointer);
+
+/** Sharded version of LuaHashMap_SetValueIntegerForKeyPointer. @see LuaHashMap_SetValueIntegerForKeyPointer */
+LUAHASHMAP_EXPORT void LuaHashMapSharded_SetValueIntegerForKeyPointer(LuaHashMapSharded* sharded_hash_map, lua_Integer value_integer, void* key_pointer);
+
+/** Sharded version of LuaHashMap_SetValueStringForKeyNumber. @see LuaHashMap_SetValueStringForKeyNumber */
+LUAHASHMAP_EXPORT void LuaHashMapSharded_SetValueStringForKeyNumber(LuaHashMapSharded* restrict sharded_hash_map, const char* restrict value_string, lua_Number key_number);
+
+/** Sharded version of LuaHashMap_SetValueStringForKeyNumberWithLength. @see LuaHashMap_SetValueStringForKeyNumberWithLength */
+LUAHASHMAP_EXPORT void LuaHashMapSharded_SetValueStringForKeyNumberWithLength(LuaHashMapSharded* restrict sharded_hash_map, const char* restrict value_string, lua_Number key_number, size_t value_string_length);
+
+/** Sharded version of LuaHashMap_SetValuePointerForKeyNumber. @see LuaHashMap_SetValuePointerForKeyNumber */
+LUAHASHMAP_EXPORT void LuaHashMapSharded_SetValuePointerForKeyNumber(LuaHashMapSharded* sharded_hash_map, void* value_pointer, lua_Number key_number);
+
+/** Sharded version of LuaHashMap_SetValueNumberForKeyNumber. @see LuaHashMap_SetValueNumberForKeyNumber */
+LUAHASHMAP_EXPORT void LuaHashMapSharded_SetValueNumberForKeyNumber(LuaHashMapSharded* sharded_hash_map, lua_Number value_number, lua_Number key_number);
+
+/** Sharded version of LuaHashMap_SetValueIntegerForKeyNumber. @see LuaHashMap_SetValueIntegerForKeyNumber */
+LUAHASHMAP_EXPORT void LuaHashMapSharded_SetValueIntegerForKeyNumber(LuaHashMapSharded* sharded_hash_map, lua_Integer value_integer, lua_Number key_number);
+
+/** Sharded version of LuaHashMap_SetValueStringForKeyInteger. @see LuaHashMap_SetValueStringForKeyInteger */
+LUAHASHMAP_EXPORT void LuaHashMapSharded_SetValueStringForKeyInteger(LuaHashMapSharded* restrict sharded_hash_map, const char* restrict value_string, lua_Integer key_integer);
+
+/** Sharded version of LuaHashMap_SetValueStringForKeyIntegerWithLength. @see LuaHashMap_SetValueStringForKeyIntegerWithLength */
+LUAHASHMAP_EXPORT void LuaHashMapSharded_SetValueStringForKeyIntegerWithLength(LuaHashMapSharded* restrict sharded_hash_map, const char* restrict value_string, lua_Integer key_integer, size_t value_string_length);
+
+/** Sharded version of LuaHashMap_SetValuePointerForKeyInteger. @see LuaHashMap_SetValuePointerForKeyInteger */
+LUAHASHMAP_EXPORT void LuaHashMapSharded_SetValuePointerForKeyInteger(LuaHashMapSharded* sharded_hash_map, void* value_pointer, lua_Integer key_integer);
+
+/** Sharded version of LuaHashMap_SetValueNumberForKeyInteger. @see LuaHashMap_SetValueNumberForKeyInteger */
+LUAHASHMAP_EXPORT void LuaHashMapSharded_SetValueNumberForKeyInteger(LuaHashMapSharded* sharded_hash_map, lua_Number value_number, lua_Integer key_integer);
+
+/** Sharded version of LuaHashMap_SetValueIntegerForKeyInteger. @see LuaHashMap_SetValueIntegerForKeyInteger */
+LUAHASHMAP_EXPORT void LuaHashMapSharded_SetValueIntegerForKeyInteger(LuaHashMapSharded* sharded_hash_map, lua_Integer value_integer, lua_Integer key_integer);
+
+/**
+ * Copies the string value for a key into value_buffer while the shard is locked, so the copy stays valid whatever other threads do.
+ * Like snprintf, at most value_buffer_size-1 bytes are copied and the result is always terminated (if value_buffer_size > 0).
+ * @param value_buffer Where the value is copied to. May be NULL if value_buffer_size is 0, to just get the length.
+ * @param value_buffer_size The size of value_buffer in bytes.
+ * @return Returns the full length of the value in bytes, not counting the terminator. The copy is complete if this is less than value_buffer_size.
+ * A key that isn't there copies as the empty string and returns 0 (use LuaHashMapSharded_ExistsKey* to tell them apart).
+ * @see LuaHashMap_GetValueStringForKeyStringWithLength
+ */
+LUAHASHMAP_EXPORT size_t LuaHashMapSharded_CopyValueStringForKeyString(LuaHashMapSharded* restrict sharded_hash_map, const char* restrict key_string, char* restrict value_buffer, size_t value_buffer_size);
+
+/** Like LuaHashMapSharded_CopyValueStringForKeyString, for a key with an explicit length. @see LuaHashMapSharded_CopyValueStringForKeyString */
+LUAHASHMAP_EXPORT size_t LuaHashMapSharded_CopyValueStringForKeyStringWithLength(LuaHashMapSharded* restrict sharded_hash_map, const char* restrict key_string, char* restrict value_buffer, size_t value_buffer_size, size_t key_string_length);
+
+/** Sharded version of LuaHashMap_GetValuePointerForKeyString. @see LuaHashMap_GetValuePointerForKeyString */
+LUAHASHMAP_EXPORT void* LuaHashMapSharded_GetValuePointerForKeyString(LuaHashMapSharded* restrict sharded_hash_map, const char* restrict key_string);
+
+/** Sharded version of LuaHashMap_GetValuePointerForKeyStringWithLength. @see LuaHashMap_GetValuePointerForKeyStringWithLength */
+LUAHASHMAP_EXPORT void* LuaHashMapSharded_GetValuePointerForKeyStringWithLength(LuaHashMapSharded* restrict sharded_hash_map, const char* restrict key_string, size_t key_string_length);
+
+/** Sharded version of LuaHashMap_GetValueNumberForKeyString. @see LuaHashMap_GetValueNumberForKeyString */
+LUAHASHMAP_EXPORT lua_Number LuaHashMapSharded_GetValueNumberForKeyString(LuaHashMapSharded* restrict sharded_hash_map, const char* restrict key_string);
+
+/** Sharded version of LuaHashMap_GetValueNumberForKeyStringWithLength. @see LuaHashMap_GetValueNumberForKeyStringWithLength */
+LUAHASHMAP_EXPORT lua_Number LuaHashMapSharded_GetValueNumberForKeyStringWithLength(LuaHashMapSharded* restrict sharded_hash_map, const char* restrict key_string, size_t key_string_length);
+
+/** Sharded version of LuaHashMap_GetValueIntegerForKeyString. @see LuaHashMap_GetValueIntegerForKeyString */
+LUAHASHMAP_EXPORT lua_Integer LuaHashMapSharded_GetValueIntegerForKeyString(LuaHashMapSharded* restrict sharded_hash_map, const char* restrict key_string);
+
+/** Sharded version of LuaHashMap_GetValueIntegerForKeyStringWithLength. @see LuaHashMap_GetValueIntegerForKeyStringWithLength */
+LUAHASHMAP_EXPORT lua_Integer LuaHashMapSharded_GetValueIntegerForKeyStringWithLength(LuaHashMapSharded* restrict sharded_hash_map, const char* restrict key_string, size_t key_string_length);
+
+/** Like LuaHashMapSharded_CopyValueStringForKeyString, for a pointer key. @see LuaHashMapSharded_CopyValueStringForKeyString */
+LUAHASHMAP_EXPORT size_t LuaHashMapSharded_CopyValueStringForKeyPointer(LuaHashMapSharded* restrict sharded_hash_map, void* key_pointer, char* restrict value_buffer, size_t value_buffer_size);
+
+/** Sharded version of LuaHashMap_GetValuePointerForKeyPointer. @see LuaHashMap_GetValuePointerForKeyPointer */
+LUAHASHMAP_EXPORT void* LuaHashMapSharded_GetValuePointerForKeyPointer(LuaHashMapSharded* sharded_hash_map, void* key_pointer);
+
+/** Sharded version of LuaHashMap_GetValueNumberForKeyPointer. @see LuaHashMap_GetValueNumberForKeyPointer */
+LUAHASHMAP_EXPORT lua_Number LuaHashMapSharded_GetValueNumberForKeyPointer(LuaHashMapSharded* sharded_hash_map, void* key_pointer);
+
+/** Sharded version of LuaHashMap_GetValueIntegerForKeyPointer. @see LuaHashMap_GetValueIntegerForKeyPointer */
+LUAHASHMAP_EXPORT lua_Integer LuaHashMapSharded_GetValueIntegerForKeyPointer(LuaHashMapSharded* sharded_hash_map, void* key_pointer);
+
+/** Like LuaHashMapSharded_CopyValueStringForKeyString, for a number key. @see LuaHashMapSharded_CopyValueStringForKeyString */
+LUAHASHMAP_EXPORT size_t LuaHashMapSharded_CopyValueStringForKeyNumber(LuaHashMapSharded* restrict sharded_hash_map, lua_Number key_number, char* restrict value_buffer, size_t value_buffer_size);
+
+/** Sharded version of LuaHashMap_GetValuePointerForKeyNumber. @see LuaHashMap_GetValuePointerForKeyNumber */
+LUAHASHMAP_EXPORT void* LuaHashMapSharded_GetValuePointerForKeyNumber(LuaHashMapSharded* sharded_hash_map, lua_Number key_number);
+
+/** Sharded version of LuaHashMap_GetValueNumberForKeyNumber. @see LuaHashMap_GetValueNumberForKeyNumber */
+LUAHASHMAP_EXPORT lua_Number LuaHashMapSharded_GetValueNumberForKeyNumber(LuaHashMapSharded* sharded_hash_map, lua_Number key_number);
+
+/** Sharded version of LuaHashMap_GetValueIntegerForKeyNumber. @see LuaHashMap_GetValueIntegerForKeyNumber */
+LUAHASHMAP_EXPORT lua_Integer LuaHashMapSharded_GetValueIntegerForKeyNumber(LuaHashMapSharded* sharded_hash_map, lua_Number key_number);
+
+/** Like LuaHashMapSharded_CopyValueStringForKeyString, for an integer key. @see LuaHashMapSharded_CopyValueStringForKeyString */
+LUAHASHMAP_EXPORT size_t LuaHashMapSharded_CopyValueStringForKeyInteger(LuaHashMapSharded* restrict sharded_hash_map, lua_Integer key_integer, char* restrict value_buffer, size_t value_buffer_size);
+
+/** Sharded version of LuaHashMap_GetValuePointerForKeyInteger. @see LuaHashMap_GetValuePointerForKeyInteger */
+LUAHASHMAP_EXPORT void* LuaHashMapSharded_GetValuePointerForKeyInteger(LuaHashMapSharded* sharded_hash_map, lua_Integer key_integer);
+
+/** Sharded version of LuaHashMap_GetValueNumberForKeyInteger. @see LuaHashMap_GetValueNumberForKeyInteger */
+LUAHASHMAP_EXPORT lua_Number LuaHashMapSharded_GetValueNumberForKeyInteger(LuaHashMapSharded* sharded_hash_map, lua_Integer key_integer);
+
+/** Sharded version of LuaHashMap_GetValueIntegerForKeyInteger. @see LuaHashMap_GetValueIntegerForKeyInteger */
+LUAHASHMAP_EXPORT lua_Integer LuaHashMapSharded_GetValueIntegerForKeyInteger(LuaHashMapSharded* sharded_hash_map, lua_Integer key_integer);
+
+/** Sharded version of LuaHashMap_ExistsKeyString. @see LuaHashMap_ExistsKeyString */
+LUAHASHMAP_EXPORT bool LuaHashMapSharded_ExistsKeyString(LuaHashMapSharded* restrict sharded_hash_map, const char* restrict key_string);
+
+/** Sharded version of LuaHashMap_ExistsKeyStringWithLength. @see LuaHashMap_ExistsKeyStringWithLength */
+LUAHASHMAP_EXPORT bool LuaHashMapSharded_ExistsKeyStringWithLength(LuaHashMapSharded* restrict sharded_hash_map, const char* restrict key_string, size_t key_string_length);
+
+/** Sharded version of LuaHashMap_ExistsKeyPointer. @see LuaHashMap_ExistsKeyPointer */
+LUAHASHMAP_EXPORT bool LuaHashMapSharded_ExistsKeyPointer(LuaHashMapSharded* sharded_hash_map, void* key_pointer);
+
+/** Sharded version of LuaHashMap_ExistsKeyNumber. @see LuaHashMap_ExistsKeyNumber */
+LUAHASHMAP_EXPORT bool LuaHashMapSharded_ExistsKeyNumber(LuaHashMapSharded* sharded_hash_map, lua_Number key_number);
+
+/** Sharded version of LuaHashMap_ExistsKeyInteger. @see LuaHashMap_ExistsKeyInteger */
+LUAHASHMAP_EXPORT bool LuaHashMapSharded_ExistsKeyInteger(LuaHashMapSharded* sharded_hash_map, lua_Integer key_integer);
+
+/** Sharded version of LuaHashMap_RemoveKeyString. @see LuaHashMap_RemoveKeyString */
+LUAHASHMAP_EXPORT void LuaHashMapSharded_RemoveKeyString(LuaHashMapSharded* restrict sharded_hash_map, const char* restrict key_string);
+
+/** Sharded version of LuaHashMap_RemoveKeyStringWithLength. @see LuaHashMap_RemoveKeyStringWithLength */
+LUAHASHMAP_EXPORT void LuaHashMapSharded_RemoveKeyStringWithLength(LuaHashMapSharded* restrict sharded_hash_map, const char* restrict key_string, size_t key_string_length);
+
+/** Sharded version of LuaHashMap_RemoveKeyPointer. @see LuaHashMap_RemoveKeyPointer */
+LUAHASHMAP_EXPORT void LuaHashMapSharded_RemoveKeyPointer(LuaHashMapSharded* sharded_hash_map, void* key_pointer);
+
+/** Sharded version of LuaHashMap_RemoveKeyNumber. @see LuaHashMap_RemoveKeyNumber */
+LUAHASHMAP_EXPORT void LuaHashMapSharded_RemoveKeyNumber(LuaHashMapSharded* sharded_hash_map, lua_Number key_number);
+
+/** Sharded version of LuaHashMap_RemoveKeyInteger. @see LuaHashMap_RemoveKeyInteger */
+LUAHASHMAP_EXPORT void LuaHashMapSharded_RemoveKeyInteger(LuaHashMapSharded* sharded_hash_map, lua_Integer key_integer);
+/** @} */ 
+
+/** @defgroup GroupLockingFamily Group locking family of functions
+ *  @{
+ */
+/**
+ * Counters for the group lock. They are only updated while locking is enabled.
+ * "Contended" means the lock was not immediately available and the thread had to wait.
+ */
+struct LuaHashMapLockStatistics
+{
+	size_t exclusiveAcquireCount; /**< Number of times the lock was taken for writing (or any operation that may allocate). */
+	size_t exclusiveContendedCount; /**< How many of those had to wait. */
+	size_t sharedAcquireCount; /**< Number of times the lock was taken by a read-only lookup. */
+	size_t sharedContendedCount; /**< How many of those had to wait. */
+	size_t readerStateUnavailableCount; /**< How many read-only lookups found no free reader state and fell back to the exclusive lock. */
+};
+typedef struct LuaHashMapLockStatistics LuaHashMapLockStatistics;
+
+/**
+ * Makes the hash map, and every hash map that shares its lua_State, safe to use from multiple threads.
+ * Once enabled, every LuaHashMap_ function that takes one of these hash maps (or an iterator, cursor, or scan on one)
+ * takes the group's lock for the duration of the call.
+ * 
+ * Most operations take the lock exclusively since the whole group shares one lua_State. 
+ * Lookups that can't allocate (the Get/TryGet/Exists functions with pointer, number, or integer keys and non-string values)
+ * take it shared and run concurrently, each on its own Lua thread borrowed from a pool. 
+ * If all of the reader states are in use, the lookup falls back to the exclusive lock.
+ * With Lua 5.4 every operation is exclusive and no reader states are created, 
+ * because 5.4 updates a table's internal size hint even on a raw integer lookup, so no lookup is truly read-only.
+ *
+ * The lock belongs to the lua_State, so it covers every hash map on it: the creator, 
+ * shares made with LuaHashMap_CreateShare*, and hash maps made with LuaHashMap_CreateShareFromLuaState*, whether they were created before or after this call.
+ * Locking is off by default and costs a flag check per call when off.
+ *
+ * @param hash_map Any hash map on the lua_State, including a share or one made from a caller-owned lua_State.
+ * @param number_of_reader_states The maximum number of concurrent read-only lookups. A good value is the number of reader threads. 
+ * 0 makes every operation exclusive.
+ * @return Returns true on success or if locking was already enabled, false on failure, 
+ * or if an access session (LuaHashMap_BeginAccess) is still open on any hash map in the group.
+ *
+ * @warning Call this before any other thread touches the hash maps. 
+ * The LuaHashMap_CreateShareFromLuaState* functions must not run concurrently with other users of the lua_State.
+ * @warning Iterators are not snapshots. Other threads may change the hash map between calls that use the iterator. 
+ * Cursors and scans have the same caveats they do in single threaded code (see LuaHashMap_CreateScan).
+ * @warning The callbacks of LuaHashMap_ForEach, LuaHashMap_RemoveIf, LuaHashMap_TransformValues, etc. run while the lock is held, 
+ * so they must not call LuaHashMap_ functions on hash maps in the same group. (They will deadlock.)
+ * @warning Returned string pointers point into the lua_State. They are only valid as long as no other thread removes or replaces the value.
+ * @note Access sessions are ignored while locking is enabled: LuaHashMap_BeginAccess and LuaHashMap_EndAccess do nothing, 
+ * since a table pinned on the shared stack would be disturbed by the other threads between calls.
+ * @note The lock is freed when the lua_State is closed, by LuaHashMap_Free or by lua_close for a caller-owned lua_State. 
+ * @see LuaHashMap_GetLockStatistics
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_EnableGroupLocking(LuaHashMap* hash_map, size_t number_of_reader_states);
+
+/**
+ * Copies the group lock's contention counters.
+ * @param hash_map Any hash map in the group.
+ * @param statistics_return The counters are written here.
+ * @return Returns false if group locking is not enabled.
+ * @see LuaHashMap_EnableGroupLocking
+ */
+LUAHASHMAP_EXPORT bool LuaHashMap_GetLockStatistics(LuaHashMap* hash_map, LuaHashMapLockStatistics* statistics_return);
+
+/** @} */ 
+
+/** @defgroup ActorFamily LuaHashMapActor family of functions
+ *  @{
+ */
 /**
- * Returns the cached value saved in the iterator.
- * Returns the cached value saved in the iterator.
- * integer version
- * This version allows you to specify the string length for the string if you already know it as an optimization.
+ * An actor gives one owner thread sole use of a hash map. Other threads never touch the lua_State. 
+ * Instead they submit LuaHashMapActorRequest operations through a lock-free queue, and the owner executes them in batches.
+ * Each batch is one trip through the queue, one access session (see LuaHashMap_BeginAccess) and, if group locking is enabled, one lock acquisition.
  *
- * @param hash_iterator The LuaHashMapIterator instance to operate on.
- * @return Returns the key integer. 
- *
- * @note This simply pulls the key directly from the struct. This does not involve a full hash look up.
- * If you follow the expected use pattern of the API (as long as you don't modify the hash table behind the back of your iterator), 
- * its cached value should be up-to-date, avoiding the need to use the regular GetValue<T>AtIterator which requires another full hash table look up.
+ * The owner calls LuaHashMapActor_Drain (e.g. from its own event loop) or LuaHashMapActor_Run (which sleeps while there is no work).
+ * While an actor is running, only the owner thread may call LuaHashMap_ functions on the hash map.
  */
-LUAHASHMAP_EXPORT inline lua_Number LuaHashMap_GetCachedValueNumberAtIterator(const LuaHashMapIterator* hash_iterator)
+typedef struct LuaHashMapActor LuaHashMapActor;
+
+/**
+ * The operations a LuaHashMapActorRequest can carry.
+ */
+typedef enum LuaHashMapActorOperation
 {
-	if(NULL == hash_iterator)
-	{
-		return 0.0;
-	}
-	if(true == hash_iterator->atEnd)
-	{
-		return 0.0;
-	}
-	if(true == hash_iterator->isNext)
-	{
-		return 0.0;
-	}
-	if(LUA_TNUMBER != hash_iterator->valueType)
-	{
-		return 0.0;
-	}
-	return hash_iterator->currentValue.theNumber;
-}
+	LUAHASHMAP_ACTOR_GET = 0, /**< Looks up theKey. The result goes in theValue (LUA_TNIL if not found). */
+	LUAHASHMAP_ACTOR_SET, /**< Sets theKey to theValue. A LUA_TNIL value removes the key. */
+	LUAHASHMAP_ACTOR_REMOVE, /**< Removes theKey. */
+	LUAHASHMAP_ACTOR_EXISTS /**< Sets wasFound if theKey is in the hash map. */
+} LuaHashMapActorOperation;
+
+typedef struct LuaHashMapActorRequest LuaHashMapActorRequest;
+
 /**
- * Returns the cached value saved in the iterator.
- * Returns the cached value saved in the iterator.
- * integer version
- * This version allows you to specify the string length for the string if you already know it as an optimization.
- *
- * @param hash_iterator The LuaHashMapIterator instance to operate on.
- * @return Returns the key integer. 
- *
- * @note This simply pulls the key directly from the struct. This does not involve a full hash look up.
- * If you follow the expected use pattern of the API (as long as you don't modify the hash table behind the back of your iterator), 
- * its cached value should be up-to-date, avoiding the need to use the regular GetValue<T>AtIterator which requires another full hash table look up.
+ * Called on the owner thread right after a request executes. 
+ * A string in theValue points into the lua_State and is only valid until the callback returns.
+ * The callback must not call LuaHashMap_ functions on the actor's hash map, but it may submit new requests.
  */
-LUAHASHMAP_EXPORT inline lua_Integer LuaHashMap_GetCachedValueIntegerAtIterator(const LuaHashMapIterator* hash_iterator)
+typedef void (*LuaHashMapActor_CompletionFunction)(LuaHashMapActorRequest* actor_request, void* user_data);
+
+/**
+ * One operation for the owner thread. Requests are intrusive, so submitting never allocates. 
+ * The submitter owns the memory and must keep it (and any key/value string it points to) alive until the request completes.
+ */
+struct LuaHashMapActorRequest
 {
-	if(NULL == hash_iterator)
-	{
-		return 0;
-	}
-	if(true == hash_iterator->atEnd)
-	{
-		return 0;
-	}
-	if(true == hash_iterator->isNext)
-	{
-		return 0;
-	}
-	if(LUA_TNUMBER != hash_iterator->valueType)
-	{
-		return 0;
-	}
-	return (lua_Integer)hash_iterator->currentValue.theNumber;
-}
+	LuaHashMapActorOperation theOperation;
+	LuaHashMapValue theKey; /**< LUA_TSTRING (with theString.stringLength set), LUA_TLIGHTUSERDATA or LUA_TNUMBER. */
+	LuaHashMapValue theValue; /**< The value to set for LUAHASHMAP_ACTOR_SET, or the result of LUAHASHMAP_ACTOR_GET. */
+	bool wasFound; /**< Set by LUAHASHMAP_ACTOR_GET and LUAHASHMAP_ACTOR_EXISTS. */
+	/** Optional. If set, this is how you learn the request completed: it is called instead of marking the request complete, 
+	 * and the actor doesn't touch the request after calling it, so the callback may free it.
+	 * If NULL, poll LuaHashMapActor_IsRequestComplete instead.
+	 */
+	LuaHashMapActor_CompletionFunction completionFunction;
+	void* userData; /**< Passed to completionFunction. */
+	/** Optional. Where a polled (no completionFunction) LUAHASHMAP_ACTOR_GET copies a string result. 
+	 * The string in the lua_State may be collected as soon as the owner moves on, so a polled GET never returns a pointer into it.
+	 * The copy is '\0' terminated and theValue.theString.stringPointer points at stringBuffer.
+	 * If stringBuffer is NULL or smaller than the string plus the terminator, stringPointer is NULL and stringLength is the length of the string, 
+	 * so you can resubmit with a bigger buffer.
+	 */
+	char* stringBuffer;
+	size_t stringBufferSize; /**< The size of stringBuffer in bytes. */
 
-#else /* We are not using C99 inline so the standard declaration is here. */
+	/* These are implementation details. LuaHashMapActor_Submit/SubmitBatch set them. */
+	LuaHashMapActorRequest* nextRequest;
+	volatile long isComplete;
+};
 
 /**
- * Returns the type of the key in the iterator.
- * This returns the type (e.g. string, pointer, number) of the key in the iterator.
- * The integer return value corresponds directly to Lua's types.
- * Valid values are LUA_TSTRING, LUA_TLIGHTUSERDATA, LUA_TNUMBER.
- * (LUA_TNONE may appear in the case of an error.)
- *
- * This information is particularly useful if you want to store different types within the same hash table.
- * You can use this information to dynamically discover which type is stored and then call the correct Get<T> function.
- *
- * @param hash_iterator The LuaHashMapIterator instance to operate on.
- * @return Returns an integer corresponding to Lua's mapping of types. Valid values should be LUA_TSTRING, LUA_TLIGHTUSERDATA, LUA_TNUMBER.
- *
- * @note This simply pulls the key type directly from the struct. This does not involve a full hash look up.
- *
- * @warning (Canonical) Lua does not have a way to distinguish whether the number is a lua_Number or lua_Integer. (It is assumed lua_Number.)
- * If you need to keep integers and floating point distinct, use different hash map instances to keep them separated.
+ * Creates an actor for an existing hash map. The actor doesn't own the hash map.
+ * @return Returns the actor or NULL on failure.
  */
-LUAHASHMAP_EXPORT int LuaHashMap_GetKeyTypeAtIterator(const LuaHashMapIterator* hash_iterator);
+LUAHASHMAP_EXPORT LuaHashMapActor* LuaHashMapActor_Create(LuaHashMap* hash_map);
 
 /**
- * Returns the key corresponding to the iterator.
- * Returns the key corresponding to the current location of the iterator.
- * string version
- * This version allows you to specify the string length for the string if you already know it as an optimization.
- *
- * @param hash_iterator The LuaHashMapIterator instance to operate on.
- * @return Returns the Lua internalized pointer for the key string.
- *
- * @note This simply pulls the key directly from the struct. This does not involve a full hash look up.
+ * Frees the actor. Any requests still queued are executed first (on the calling thread) so nobody waits forever. 
+ * The owner must not be inside LuaHashMapActor_Run or LuaHashMapActor_Drain.
  */
-LUAHASHMAP_EXPORT const char* LuaHashMap_GetKeyStringAtIterator(const LuaHashMapIterator* hash_iterator);
+LUAHASHMAP_EXPORT void LuaHashMapActor_Free(LuaHashMapActor* hash_actor);
+
 /**
- * Returns the key corresponding to the iterator.
- * Returns the key corresponding to the current location of the iterator.
- * string version
- * This version allows you to specify the string length for the string if you already know it as an optimization.
- *
- * @param hash_iterator The LuaHashMapIterator instance to operate on.
- * @param key_string_length_return This returns by reference the string length (strlen()) of the returned key string. You may pass NULL to ignore this result. 
- * @return Returns the Lua internalized pointer for the key string. 
- *
- * @note This simply pulls the key directly from the struct. This does not involve a full hash look up.
+ * Returns the hash map the actor executes requests against.
  */
-LUAHASHMAP_EXPORT const char* LuaHashMap_GetKeyStringAtIteratorWithLength(const LuaHashMapIterator* restrict hash_iterator, size_t* restrict key_string_length_return);
+LUAHASHMAP_EXPORT LuaHashMap* LuaHashMapActor_GetHashMap(LuaHashMapActor* hash_actor);
+
 /**
- * Returns the string length of the key corresponding to the iterator.
- * Returns the string length of the key corresponding to the current location of the iterator.
- *
- * @param hash_iterator The LuaHashMapIterator instance to operate on.
- * @return Returns the string length (strlen()) of the key pointer.
- *
- * @note This simply pulls the key directly from the struct. This does not involve a full hash look up.
+ * Queues a request for the owner thread. Callable from any thread. This never blocks unless the owner is asleep in LuaHashMapActor_Run and must be woken.
+ * @return Returns false (and doesn't queue) if either argument is NULL.
  */
-LUAHASHMAP_EXPORT size_t LuaHashMap_GetKeyStringLengthAtIterator(const LuaHashMapIterator* hash_iterator);
+LUAHASHMAP_EXPORT bool LuaHashMapActor_Submit(LuaHashMapActor* restrict hash_actor, LuaHashMapActorRequest* restrict actor_request);
+
 /**
- * Returns the key corresponding to the iterator.
- * Returns the key corresponding to the current location of the iterator.
- * pointer version
- *
- * @param hash_iterator The LuaHashMapIterator instance to operate on.
- * @return Returns the key pointer.
- *
- * @note This simply pulls the key directly from the struct. This does not involve a full hash look up.
+ * Queues an array of requests with a single atomic operation, so they are guaranteed to be executed together in the same batch, in array order.
+ * Callable from any thread.
+ * @return Returns false (and doesn't queue) if either pointer is NULL or number_of_requests is 0.
  */
-LUAHASHMAP_EXPORT void* LuaHashMap_GetKeyPointerAtIterator(const LuaHashMapIterator* hash_iterator);
+LUAHASHMAP_EXPORT bool LuaHashMapActor_SubmitBatch(LuaHashMapActor* restrict hash_actor, LuaHashMapActorRequest* restrict actor_requests, size_t number_of_requests);
+
 /**
- * Returns the key corresponding to the iterator.
- * Returns the key corresponding to the current location of the iterator.
- * number version
- *
- * @param hash_iterator The LuaHashMapIterator instance to operate on.
- * @return Returns the key number.
- *
- * @note This simply pulls the key directly from the struct. This does not involve a full hash look up.
+ * Returns true once a request without a completionFunction has been executed. Callable from any thread.
+ * The results in the request are visible to the calling thread once this returns true.
+ * @warning A string result of LUAHASHMAP_ACTOR_GET is only usable here if the request supplied a big enough stringBuffer. 
+ * (stringPointer is NULL otherwise.) Strings are only valid in place inside a completionFunction.
  */
-LUAHASHMAP_EXPORT lua_Number LuaHashMap_GetKeyNumberAtIterator(const LuaHashMapIterator* hash_iterator);
+LUAHASHMAP_EXPORT bool LuaHashMapActor_IsRequestComplete(const LuaHashMapActorRequest* actor_request);
+
 /**
- * Returns the key corresponding to the iterator.
- * Returns the key corresponding to the current location of the iterator.
- * integer version
- *
- * @param hash_iterator The LuaHashMapIterator instance to operate on.
- * @return Returns the key integer.
- *
- * @note This simply pulls the key directly from the struct. This does not involve a full hash look up.
+ * Executes every request queued so far, in submission order, as one batch. Only the owner thread may call this. Never blocks waiting for work.
+ * @return Returns the number of requests executed.
  */
-LUAHASHMAP_EXPORT lua_Integer LuaHashMap_GetKeyIntegerAtIterator(const LuaHashMapIterator* hash_iterator);
+LUAHASHMAP_EXPORT size_t LuaHashMapActor_Drain(LuaHashMapActor* hash_actor);
 
+/**
+ * Makes the calling thread the owner and executes requests until LuaHashMapActor_Stop is called, sleeping when there is nothing to do.
+ * Requests queued before the stop are executed before this returns.
+ */
+LUAHASHMAP_EXPORT void LuaHashMapActor_Run(LuaHashMapActor* hash_actor);
 
 /**
- * Returns the type of the cached value in the iterator.
- * This returns the type (e.g. string, pointer, number) of the cached value in the iterator.
- * The integer return value corresponds directly to Lua's types.
- * Valid values are LUA_TSTRING, LUA_TLIGHTUSERDATA, LUA_TNUMBER.
- * (LUA_TNONE may appear in the case of an error.)
- *
- * This information is particularly useful if you want to store different types within the same hash table.
- * You can use this information to dynamically discover which type is stored and then call the correct Get<T> function.
- *
- * @param hash_iterator The LuaHashMapIterator instance to operate on.
- * @return Returns an integer corresponding to Lua's mapping of types. Valid values should be LUA_TSTRING, LUA_TLIGHTUSERDATA, LUA_TNUMBER.
- *
- * @note This simply pulls the value type directly from the struct. This does not involve a full hash look up.
- * If you follow the expected use pattern of the API (as long as you don't modify the hash table behind the back of your iterator), 
- * its cached value should be up-to-date, avoiding the need to use the regular GetValue<T>AtIterator which requires another full hash table look up.
- *
- * @warning (Canonical) Lua does not have a way to distinguish whether the number is a lua_Number or lua_Integer. (It is assumed lua_Number.)
- * If you need to keep integers and floating point distinct, use different hash map instances to keep them separated.
+ * For owners with their own loop: sleeps until there are requests to drain or LuaHashMapActor_Stop is called.
+ * LuaHashMapActor_Run is a loop of LuaHashMapActor_Drain and this.
+ * @return Returns true if there are requests to drain, or false (and clears the stop) if LuaHashMapActor_Stop was called. 
+ * Drain once more after a false return to finish any requests submitted before the stop.
  */
-LUAHASHMAP_EXPORT int LuaHashMap_GetCachedValueTypeAtIterator(const LuaHashMapIterator* hash_iterator);
+LUAHASHMAP_EXPORT bool LuaHashMapActor_WaitForRequests(LuaHashMapActor* hash_actor);
 
 /**
- * Returns the cached value saved in the iterator.
- * Returns the cached value saved in the iterator.
- * string version
- * This version allows you to specify the string length for the string if you already know it as an optimization.
- *
- * @param hash_iterator The LuaHashMapIterator instance to operate on.
- * @return Returns the Lua internalized pointer for the key string. 
- *
- * @note This simply pulls the key directly from the struct. This does not involve a full hash look up.
- * If you follow the expected use pattern of the API (as long as you don't modify the hash table behind the back of your iterator), 
- * its cached value should be up-to-date, avoiding the need to use the regular GetValue<T>AtIterator which requires another full hash table look up.
+ * Asks LuaHashMapActor_Run (or LuaHashMapActor_WaitForRequests) to return. Callable from any thread. 
+ */
+LUAHASHMAP_EXPORT void LuaHashMapActor_Stop(LuaHashMapActor* hash_actor);
+
+/** @} */ 
+
+/** @defgroup SnapshotFamily Snapshot family of functions
+ *  @{
  */
-LUAHASHMAP_EXPORT const char* LuaHashMap_GetCachedValueStringAtIterator(const LuaHashMapIterator* hash_iterator);
 /**
- * Returns the cached value saved in the iterator.
- * Returns the cached value saved in the iterator.
- * string version
- * This version allows you to specify the string length for the string if you already know it as an optimization.
- *
- * @param hash_iterator The LuaHashMapIterator instance to operate on.
- * @param value_string_length_return This returns by reference the string length (strlen()) of the returned key string. You may pass NULL to ignore this result. 
- * @return Returns the Lua internalized pointer for the key string. 
+ * A read-only copy of a hash map that lives outside the lua_State, so any number of threads can look things up in it 
+ * at the same time without locks, while the writer keeps changing the live hash map.
  *
- * @note This simply pulls the key directly from the struct. This does not involve a full hash look up.
- * If you follow the expected use pattern of the API (as long as you don't modify the hash table behind the back of your iterator), 
- * its cached value should be up-to-date, avoiding the need to use the regular GetValue<T>AtIterator which requires another full hash table look up.
+ * The writer calls LuaHashMap_PublishSnapshot whenever readers should see its changes (e.g. after each batch of writes, or on a timer).
+ * A reader calls LuaHashMap_AcquireSnapshot, does as many lookups as it likes, and calls LuaHashMapSnapshot_Release.
+ * A snapshot is freed once it has been replaced and every reader holding it has released it.
+ * Acquire and release each cost a few atomic operations, so hold a snapshot across a batch of lookups rather than acquiring one per lookup.
  */
-LUAHASHMAP_EXPORT const char* LuaHashMap_GetCachedValueStringAtIteratorWithLength(const LuaHashMapIterator* restrict hash_iterator, size_t* restrict value_string_length_return);
+typedef struct LuaHashMapSnapshot LuaHashMapSnapshot;
+
 /**
- * Returns the string length of the cached value saved in the iterator.
- * Returns the string length of the cached value saved in the current location of the iterator.
- *
- * @param hash_iterator The LuaHashMapIterator instance to operate on.
- * @return Returns the string length (strlen()) of the key pointer.
- *
- * @note This simply pulls the key directly from the struct. This does not involve a full hash look up.
+ * Copies the hash map into a new snapshot and makes it the one LuaHashMap_AcquireSnapshot returns. 
+ * Readers holding the previous snapshot keep using it until they release it.
+ * This is O(n) and copies every string key and value. 
+ * Snapshots hold string, number, light userdata, and boolean keys. Entries with other key types (only possible through LuaHashMap_Eval) are left out.
+ * Values of types other than those are copied as their type only (see LuaHashMapValue).
+ * @param hash_map The hash map to copy. Only the writer may call this; it is not safe to call from several threads at once.
+ * @return Returns false (and leaves the previous snapshot published) if memory ran out.
+ * @note This may briefly spin if a reader is in the middle of LuaHashMap_AcquireSnapshot.
+ * @note LuaHashMap_Free and LuaHashMap_FreeShare drop the published snapshot. Readers must not call LuaHashMap_AcquireSnapshot on a freed hash map.
  */
-LUAHASHMAP_EXPORT size_t LuaHashMap_GetCachedValueStringLengthAtIterator(const LuaHashMapIterator* hash_iterator);
+LUAHASHMAP_EXPORT bool LuaHashMap_PublishSnapshot(LuaHashMap* hash_map);
+
 /**
- * Returns the cached value saved in the iterator.
- * Returns the cached value saved in the iterator.
- * pointer version
- * This version allows you to specify the string length for the string if you already know it as an optimization.
- *
- * @param hash_iterator The LuaHashMapIterator instance to operate on.
- * @return Returns the key pointer. 
- *
- * @note This simply pulls the key directly from the struct. This does not involve a full hash look up.
- * If you follow the expected use pattern of the API (as long as you don't modify the hash table behind the back of your iterator), 
- * its cached value should be up-to-date, avoiding the need to use the regular GetValue<T>AtIterator which requires another full hash table look up.
+ * Returns a reference to the most recently published snapshot. Callable from any thread, lock-free, and never touches the lua_State.
+ * @return Returns NULL if nothing has been published. Otherwise, release the snapshot with LuaHashMapSnapshot_Release when done.
  */
-LUAHASHMAP_EXPORT void* LuaHashMap_GetCachedValuePointerAtIterator(const LuaHashMapIterator* hash_iterator);
+LUAHASHMAP_EXPORT LuaHashMapSnapshot* LuaHashMap_AcquireSnapshot(LuaHashMap* hash_map);
+
 /**
- * Returns the cached value saved in the iterator.
- * Returns the cached value saved in the iterator.
- * number version
- * This version allows you to specify the string length for the string if you already know it as an optimization.
- *
- * @param hash_iterator The LuaHashMapIterator instance to operate on.
- * @return Returns the key number. 
- *
- * @note This simply pulls the key directly from the struct. This does not involve a full hash look up.
- * If you follow the expected use pattern of the API (as long as you don't modify the hash table behind the back of your iterator), 
- * its cached value should be up-to-date, avoiding the need to use the regular GetValue<T>AtIterator which requires another full hash table look up.
+ * Drops a reference from LuaHashMap_AcquireSnapshot. Values returned from the snapshot (including string pointers) are invalid afterwards.
  */
-LUAHASHMAP_EXPORT lua_Number LuaHashMap_GetCachedValueNumberAtIterator(const LuaHashMapIterator* hash_iterator);
+LUAHASHMAP_EXPORT void LuaHashMapSnapshot_Release(LuaHashMapSnapshot* hash_snapshot);
+
 /**
- * Returns the cached value saved in the iterator.
- * Returns the cached value saved in the iterator.
- * integer version
- * This version allows you to specify the string length for the string if you already know it as an optimization.
- *
- * @param hash_iterator The LuaHashMapIterator instance to operate on.
- * @return Returns the key integer. 
- *
- * @note This simply pulls the key directly from the struct. This does not involve a full hash look up.
- * If you follow the expected use pattern of the API (as long as you don't modify the hash table behind the back of your iterator), 
- * its cached value should be up-to-date, avoiding the need to use the regular GetValue<T>AtIterator which requires another full hash table look up.
+ * Returns the number of entries in the snapshot. O(1).
  */
-LUAHASHMAP_EXPORT lua_Integer LuaHashMap_GetCachedValueIntegerAtIterator(const LuaHashMapIterator* hash_iterator);
-#endif /* defined(__STDC_VERSION__) && (__STDC_VERSION__ > 199901L) */
+LUAHASHMAP_EXPORT size_t LuaHashMapSnapshot_Count(const LuaHashMapSnapshot* hash_snapshot);
+
+/**
+ * Looks up a key in the snapshot. Keys match the way they do in the hash map, e.g. the integer 1 finds the number 1.0.
+ * @param the_key A LUA_TSTRING (with theString.stringLength set), LUA_TLIGHTUSERDATA, LUA_TNUMBER or LUA_TBOOLEAN key.
+ * @param value_return If not NULL, the value is copied here. String values point into the snapshot and stay valid until it is released.
+ * @return Returns true if the key was found.
+ */
+LUAHASHMAP_EXPORT bool LuaHashMapSnapshot_GetValueForKey(const LuaHashMapSnapshot* restrict hash_snapshot, const LuaHashMapValue* restrict the_key, LuaHashMapValue* restrict value_return);
+/** String key version of LuaHashMapSnapshot_GetValueForKey. @see LuaHashMapSnapshot_GetValueForKey */
+LUAHASHMAP_EXPORT bool LuaHashMapSnapshot_GetValueForKeyString(const LuaHashMapSnapshot* restrict hash_snapshot, const char* restrict key_string, LuaHashMapValue* restrict value_return);
+/** Pointer key version of LuaHashMapSnapshot_GetValueForKey. @see LuaHashMapSnapshot_GetValueForKey */
+LUAHASHMAP_EXPORT bool LuaHashMapSnapshot_GetValueForKeyPointer(const LuaHashMapSnapshot* restrict hash_snapshot, void* key_pointer, LuaHashMapValue* restrict value_return);
+/** Number key version of LuaHashMapSnapshot_GetValueForKey. @see LuaHashMapSnapshot_GetValueForKey */
+LUAHASHMAP_EXPORT bool LuaHashMapSnapshot_GetValueForKeyNumber(const LuaHashMapSnapshot* restrict hash_snapshot, lua_Number key_number, LuaHashMapValue* restrict value_return);
+/** Integer key version of LuaHashMapSnapshot_GetValueForKey. @see LuaHashMapSnapshot_GetValueForKey */
+LUAHASHMAP_EXPORT bool LuaHashMapSnapshot_GetValueForKeyInteger(const LuaHashMapSnapshot* restrict hash_snapshot, lua_Integer key_integer, LuaHashMapValue* restrict value_return);
 
 /** @} */ 
 
 
 
+
 /* Experimental Functions: These might be removed, modified, or made permanent. */
 
 /**
  * (Experimental) Returns the number of items in the hash table.
  * This returns the number of key/value pairs currently in your hash table. 
- * This is O(n). Since it is slow, it should be used sparingly.
+ * This is O(1). The count is maintained by all the Set/Remove/Clear/Purge functions.
  * @param hash_map The LuaHashMap instance to operate on
+ * @note If you modify the table directly through the lua_State backdoor, the count will not know about it.
  * @return Returns the number of items in the hash table.
  */
 LUAHASHMAP_EXPORT size_t LuaHashMap_Count(LuaHashMap* hash_map);	
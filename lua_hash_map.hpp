@@ -33,6 +33,24 @@ extern "C" {
 #include <iterator>
 #include <string>
 
+// lua_hash_map_actor needs std::future (C++11)
+#if (__cplusplus >= 201103L) || (defined(_MSC_VER) && (_MSC_VER >= 1700))
+	#define LUAHASHMAPCPP_HAS_FUTURE 1
+	#include <future>
+	#include <memory>
+	#include <cstring>
+#endif
+
+// The co_await interface of lua_hash_map_actor needs C++20 coroutines
+#if defined(LUAHASHMAPCPP_HAS_FUTURE) && defined(__cpp_impl_coroutine) && defined(__has_include)
+	#if __has_include(<coroutine>)
+		#define LUAHASHMAPCPP_HAS_COROUTINE 1
+		#include <coroutine>
+		#include <exception>
+		#include <vector>
+	#endif
+#endif
+
 namespace lhm
 {
 	
@@ -78,6 +96,38 @@ public:
 	
 };
 
+/* RAII helper for LuaHashMap_BeginAccess/LuaHashMap_EndAccess.
+ * Works with any lua_hash_map specialization. The map's table stays pinned on the Lua stack
+ * for the lifetime of the guard so every operation in the scope skips the registry lookup.
+ * Example:
+ *     {
+ *         lhm::scoped_access<lhm::lua_hash_map<lua_Integer, lua_Integer> > the_access(the_map);
+ *         for(...) { the_map.insert(...); }
+ *     }
+ */
+template<class _Map>
+class scoped_access
+{
+private:
+	_Map& theMap;
+	
+	// Not copyable
+	scoped_access(const scoped_access&);
+	scoped_access& operator=(const scoped_access&);
+
+public:
+	explicit scoped_access(_Map& the_map)
+	: theMap(the_map)
+	{
+		theMap.begin_access();
+	}
+	
+	~scoped_access()
+	{
+		theMap.end_access();
+	}
+};
+
 /* This seems stupid, but it seems I must reimplement every single method 
  * for each partial specialization, even if I just want to reuse the base behavior.
  */
@@ -114,9 +164,24 @@ public:
 		return LuaHashMap_IsEmpty(luaHashMap);
 	}
 	
+	void begin_access()
+	{
+		LuaHashMap_BeginAccess(luaHashMap);
+	}
+	
+	void end_access()
+	{
+		LuaHashMap_EndAccess(luaHashMap);
+	}
+	
 	size_t size() const
 	{
-		return LuaHashMap_GetKeysString(luaHashMap, NULL, 0);
+		return LuaHashMap_Count(luaHashMap);
+	}
+	
+	void reserve(size_t number_of_elements)
+	{
+		LuaHashMap_Reserve(luaHashMap, 0, static_cast<int>(number_of_elements));
 	}
 	
 	void insert(const pair_type& key_value_pair)
@@ -209,6 +274,12 @@ public:
 		the_iter.set_current_key(key_string);
 		return the_iter;
 	}
+	
+	// Looks up the key and fetches its value with a single look up. Returns false if the key was not found.
+	bool find(_TKey key_string, _TValue& value_return)
+	{
+		return LuaHashMap_TryGetValueStringForKeyString(luaHashMap, key_string, &value_return, NULL);
+	}
     
     iterator begin()
     {
@@ -228,6 +299,23 @@ public:
 		return erase((*the_iterator).first);
 	}
 
+	// Removes every key/value pair the predicate returns true for in a single pass. Returns the number removed.
+	// The predicate is called with a pair_type and must not use this map (or any map sharing its lua_State).
+	template<class _Predicate>
+	size_t erase_if(_Predicate the_predicate)
+	{
+		return LuaHashMap_RemoveIf(luaHashMap, &erase_if_predicate<_Predicate>, &the_predicate);
+	}
+
+private:
+	template<class _Predicate>
+	static int erase_if_predicate(const LuaHashMapIterator* hash_iterator, void* user_data)
+	{
+		// Only the cached key and value are safe to read while LuaHashMap_RemoveIf is traversing
+		return (*static_cast<_Predicate*>(user_data))(std::make_pair(static_cast<_TKey>(hash_iterator->currentKey.theString.stringPointer), static_cast<_TValue>(LuaHashMap_GetCachedValueStringAtIterator(hash_iterator))));
+	}
+public:
+
 	
 //	LuaHashMap* GetLuaHashMap() { return hashMap; }
 	
@@ -268,9 +356,24 @@ public:
 		return LuaHashMap_IsEmpty(luaHashMap);
 	}
 	
+	void begin_access()
+	{
+		LuaHashMap_BeginAccess(luaHashMap);
+	}
+	
+	void end_access()
+	{
+		LuaHashMap_EndAccess(luaHashMap);
+	}
+	
 	size_t size() const
 	{
-		return LuaHashMap_GetKeysString(luaHashMap, NULL, 0);
+		return LuaHashMap_Count(luaHashMap);
+	}
+	
+	void reserve(size_t number_of_elements)
+	{
+		LuaHashMap_Reserve(luaHashMap, 0, static_cast<int>(number_of_elements));
 	}
 	
 	void insert(const pair_type& key_value_pair)
@@ -362,6 +465,18 @@ public:
 		the_iter.set_current_key(key_string);
 		return the_iter;
 	}
+	
+	// Looks up the key and fetches its value with a single look up. Returns false if the key was not found.
+	bool find(_TKey key_string, _TValue*& value_return)
+	{
+		void* value_pointer = NULL;
+		bool is_found = LuaHashMap_TryGetValuePointerForKeyString(luaHashMap, key_string, &value_pointer, NULL);
+		if(true == is_found)
+		{
+			value_return = static_cast<_TValue*>(value_pointer);
+		}
+		return is_found;
+	}
     
     iterator begin()
     {
@@ -381,6 +496,23 @@ public:
 		return erase((*the_iterator).first);
 	}
 
+	// Removes every key/value pair the predicate returns true for in a single pass. Returns the number removed.
+	// The predicate is called with a pair_type and must not use this map (or any map sharing its lua_State).
+	template<class _Predicate>
+	size_t erase_if(_Predicate the_predicate)
+	{
+		return LuaHashMap_RemoveIf(luaHashMap, &erase_if_predicate<_Predicate>, &the_predicate);
+	}
+
+private:
+	template<class _Predicate>
+	static int erase_if_predicate(const LuaHashMapIterator* hash_iterator, void* user_data)
+	{
+		// Only the cached key and value are safe to read while LuaHashMap_RemoveIf is traversing
+		return (*static_cast<_Predicate*>(user_data))(std::make_pair(static_cast<_TKey>(hash_iterator->currentKey.theString.stringPointer), static_cast<_TValue*>(LuaHashMap_GetCachedValuePointerAtIterator(hash_iterator))));
+	}
+public:
+
 };
 
 	
@@ -419,9 +551,24 @@ public:
 		return LuaHashMap_IsEmpty(luaHashMap);
 	}
 	
+	void begin_access()
+	{
+		LuaHashMap_BeginAccess(luaHashMap);
+	}
+	
+	void end_access()
+	{
+		LuaHashMap_EndAccess(luaHashMap);
+	}
+	
 	size_t size() const
 	{
-		return LuaHashMap_GetKeysString(luaHashMap, NULL, 0);
+		return LuaHashMap_Count(luaHashMap);
+	}
+	
+	void reserve(size_t number_of_elements)
+	{
+		LuaHashMap_Reserve(luaHashMap, 0, static_cast<int>(number_of_elements));
 	}
 	
 	void insert(const pair_type& key_value_pair)
@@ -513,6 +660,12 @@ public:
 		the_iter.set_current_key(key_string);
 		return the_iter;
 	}
+	
+	// Looks up the key and fetches its value with a single look up. Returns false if the key was not found.
+	bool find(_TKey key_string, _TValue& value_return)
+	{
+		return LuaHashMap_TryGetValueNumberForKeyString(luaHashMap, key_string, &value_return, NULL);
+	}
     
     iterator begin()
     {
@@ -532,6 +685,23 @@ public:
 		return erase((*the_iterator).first);
 	}
 
+	// Removes every key/value pair the predicate returns true for in a single pass. Returns the number removed.
+	// The predicate is called with a pair_type and must not use this map (or any map sharing its lua_State).
+	template<class _Predicate>
+	size_t erase_if(_Predicate the_predicate)
+	{
+		return LuaHashMap_RemoveIf(luaHashMap, &erase_if_predicate<_Predicate>, &the_predicate);
+	}
+
+private:
+	template<class _Predicate>
+	static int erase_if_predicate(const LuaHashMapIterator* hash_iterator, void* user_data)
+	{
+		// Only the cached key and value are safe to read while LuaHashMap_RemoveIf is traversing
+		return (*static_cast<_Predicate*>(user_data))(std::make_pair(static_cast<_TKey>(hash_iterator->currentKey.theString.stringPointer), static_cast<_TValue>(LuaHashMap_GetCachedValueNumberAtIterator(hash_iterator))));
+	}
+public:
+
 };
 
 /* This seems stupid, but it seems I must reimplement every single method 
@@ -569,9 +739,24 @@ public:
 		return LuaHashMap_IsEmpty(luaHashMap);
 	}
 	
+	void begin_access()
+	{
+		LuaHashMap_BeginAccess(luaHashMap);
+	}
+	
+	void end_access()
+	{
+		LuaHashMap_EndAccess(luaHashMap);
+	}
+	
 	size_t size() const
 	{
-		return LuaHashMap_GetKeysString(luaHashMap, NULL, 0);
+		return LuaHashMap_Count(luaHashMap);
+	}
+	
+	void reserve(size_t number_of_elements)
+	{
+		LuaHashMap_Reserve(luaHashMap, 0, static_cast<int>(number_of_elements));
 	}
 	
 	void insert(const pair_type& key_value_pair)
@@ -663,6 +848,12 @@ public:
 		the_iter.set_current_key(key_string);
 		return the_iter;
 	}
+	
+	// Looks up the key and fetches its value with a single look up. Returns false if the key was not found.
+	bool find(_TKey key_string, _TValue& value_return)
+	{
+		return LuaHashMap_TryGetValueIntegerForKeyString(luaHashMap, key_string, &value_return, NULL);
+	}
     
     iterator begin()
     {
@@ -682,6 +873,23 @@ public:
 		return erase((*the_iterator).first);
 	}
 
+	// Removes every key/value pair the predicate returns true for in a single pass. Returns the number removed.
+	// The predicate is called with a pair_type and must not use this map (or any map sharing its lua_State).
+	template<class _Predicate>
+	size_t erase_if(_Predicate the_predicate)
+	{
+		return LuaHashMap_RemoveIf(luaHashMap, &erase_if_predicate<_Predicate>, &the_predicate);
+	}
+
+private:
+	template<class _Predicate>
+	static int erase_if_predicate(const LuaHashMapIterator* hash_iterator, void* user_data)
+	{
+		// Only the cached key and value are safe to read while LuaHashMap_RemoveIf is traversing
+		return (*static_cast<_Predicate*>(user_data))(std::make_pair(static_cast<_TKey>(hash_iterator->currentKey.theString.stringPointer), static_cast<_TValue>(LuaHashMap_GetCachedValueIntegerAtIterator(hash_iterator))));
+	}
+public:
+
 };
 
 
@@ -719,9 +927,24 @@ public:
 		return LuaHashMap_IsEmpty(luaHashMap);
 	}
 	
+	void begin_access()
+	{
+		LuaHashMap_BeginAccess(luaHashMap);
+	}
+	
+	void end_access()
+	{
+		LuaHashMap_EndAccess(luaHashMap);
+	}
+	
 	size_t size() const
 	{
-		return LuaHashMap_GetKeysPointer(luaHashMap, NULL, 0);
+		return LuaHashMap_Count(luaHashMap);
+	}
+	
+	void reserve(size_t number_of_elements)
+	{
+		LuaHashMap_Reserve(luaHashMap, 0, static_cast<int>(number_of_elements));
 	}
 	
 	void insert(const pair_type& key_value_pair)
@@ -813,6 +1036,18 @@ public:
 		the_iter.set_current_key(key);
 		return the_iter;
 	}
+	
+	// Looks up the key and fetches its value with a single look up. Returns false if the key was not found.
+	bool find(_TKey* key, _TValue*& value_return)
+	{
+		void* value_pointer = NULL;
+		bool is_found = LuaHashMap_TryGetValuePointerForKeyPointer(luaHashMap, key, &value_pointer, NULL);
+		if(true == is_found)
+		{
+			value_return = static_cast<_TValue*>(value_pointer);
+		}
+		return is_found;
+	}
     
     iterator begin()
     {
@@ -832,6 +1067,23 @@ public:
 		return erase((*the_iterator).first);
 	}
 
+	// Removes every key/value pair the predicate returns true for in a single pass. Returns the number removed.
+	// The predicate is called with a pair_type and must not use this map (or any map sharing its lua_State).
+	template<class _Predicate>
+	size_t erase_if(_Predicate the_predicate)
+	{
+		return LuaHashMap_RemoveIf(luaHashMap, &erase_if_predicate<_Predicate>, &the_predicate);
+	}
+
+private:
+	template<class _Predicate>
+	static int erase_if_predicate(const LuaHashMapIterator* hash_iterator, void* user_data)
+	{
+		// Only the cached key and value are safe to read while LuaHashMap_RemoveIf is traversing
+		return (*static_cast<_Predicate*>(user_data))(std::make_pair(static_cast<_TKey*>(hash_iterator->currentKey.thePointer), static_cast<_TValue*>(LuaHashMap_GetCachedValuePointerAtIterator(hash_iterator))));
+	}
+public:
+
 };
 
 
@@ -873,9 +1125,24 @@ public:
 		return LuaHashMap_IsEmpty(luaHashMap);
 	}
 	
+	void begin_access()
+	{
+		LuaHashMap_BeginAccess(luaHashMap);
+	}
+	
+	void end_access()
+	{
+		LuaHashMap_EndAccess(luaHashMap);
+	}
+	
 	size_t size() const
 	{
-		return LuaHashMap_GetKeysPointer(luaHashMap, NULL, 0);
+		return LuaHashMap_Count(luaHashMap);
+	}
+	
+	void reserve(size_t number_of_elements)
+	{
+		LuaHashMap_Reserve(luaHashMap, 0, static_cast<int>(number_of_elements));
 	}
 	
 	void insert(const pair_type& key_value_pair)
@@ -967,6 +1234,12 @@ public:
 		the_iter.set_current_key(key);
 		return the_iter;
 	}
+	
+	// Looks up the key and fetches its value with a single look up. Returns false if the key was not found.
+	bool find(_TKey* key, _TValue& value_return)
+	{
+		return LuaHashMap_TryGetValueStringForKeyPointer(luaHashMap, key, &value_return, NULL);
+	}
     
     iterator begin()
     {
@@ -986,6 +1259,23 @@ public:
 		return erase((*the_iterator).first);
 	}
 
+	// Removes every key/value pair the predicate returns true for in a single pass. Returns the number removed.
+	// The predicate is called with a pair_type and must not use this map (or any map sharing its lua_State).
+	template<class _Predicate>
+	size_t erase_if(_Predicate the_predicate)
+	{
+		return LuaHashMap_RemoveIf(luaHashMap, &erase_if_predicate<_Predicate>, &the_predicate);
+	}
+
+private:
+	template<class _Predicate>
+	static int erase_if_predicate(const LuaHashMapIterator* hash_iterator, void* user_data)
+	{
+		// Only the cached key and value are safe to read while LuaHashMap_RemoveIf is traversing
+		return (*static_cast<_Predicate*>(user_data))(std::make_pair(static_cast<_TKey*>(hash_iterator->currentKey.thePointer), static_cast<_TValue*>(LuaHashMap_GetCachedValueStringAtIterator(hash_iterator))));
+	}
+public:
+
 };
 	
 
@@ -1024,9 +1314,24 @@ public:
 		return LuaHashMap_IsEmpty(luaHashMap);
 	}
 	
+	void begin_access()
+	{
+		LuaHashMap_BeginAccess(luaHashMap);
+	}
+	
+	void end_access()
+	{
+		LuaHashMap_EndAccess(luaHashMap);
+	}
+	
 	size_t size() const
 	{
-		return LuaHashMap_GetKeysPointer(luaHashMap, NULL, 0);
+		return LuaHashMap_Count(luaHashMap);
+	}
+	
+	void reserve(size_t number_of_elements)
+	{
+		LuaHashMap_Reserve(luaHashMap, 0, static_cast<int>(number_of_elements));
 	}
 	
 	void insert(const pair_type& key_value_pair)
@@ -1118,6 +1423,12 @@ public:
 		the_iter.set_current_key(key);
 		return the_iter;
 	}
+	
+	// Looks up the key and fetches its value with a single look up. Returns false if the key was not found.
+	bool find(_TKey* key, _TValue& value_return)
+	{
+		return LuaHashMap_TryGetValueNumberForKeyPointer(luaHashMap, key, &value_return, NULL);
+	}
     
     iterator begin()
     {
@@ -1137,6 +1448,23 @@ public:
 		return erase((*the_iterator).first);
 	}
 
+	// Removes every key/value pair the predicate returns true for in a single pass. Returns the number removed.
+	// The predicate is called with a pair_type and must not use this map (or any map sharing its lua_State).
+	template<class _Predicate>
+	size_t erase_if(_Predicate the_predicate)
+	{
+		return LuaHashMap_RemoveIf(luaHashMap, &erase_if_predicate<_Predicate>, &the_predicate);
+	}
+
+private:
+	template<class _Predicate>
+	static int erase_if_predicate(const LuaHashMapIterator* hash_iterator, void* user_data)
+	{
+		// Only the cached key and value are safe to read while LuaHashMap_RemoveIf is traversing
+		return (*static_cast<_Predicate*>(user_data))(std::make_pair(static_cast<_TKey*>(hash_iterator->currentKey.thePointer), static_cast<_TValue>(LuaHashMap_GetCachedValueNumberAtIterator(hash_iterator))));
+	}
+public:
+
 };
 
 /* This seems stupid, but it seems I must reimplement every single method 
@@ -1174,9 +1502,24 @@ public:
 		return LuaHashMap_IsEmpty(luaHashMap);
 	}
 	
+	void begin_access()
+	{
+		LuaHashMap_BeginAccess(luaHashMap);
+	}
+	
+	void end_access()
+	{
+		LuaHashMap_EndAccess(luaHashMap);
+	}
+	
 	size_t size() const
 	{
-		return LuaHashMap_GetKeysPointer(luaHashMap, NULL, 0);
+		return LuaHashMap_Count(luaHashMap);
+	}
+	
+	void reserve(size_t number_of_elements)
+	{
+		LuaHashMap_Reserve(luaHashMap, 0, static_cast<int>(number_of_elements));
 	}
 	
 	void insert(const pair_type& key_value_pair)
@@ -1268,6 +1611,12 @@ public:
 		the_iter.set_current_key(key);
 		return the_iter;
 	}
+	
+	// Looks up the key and fetches its value with a single look up. Returns false if the key was not found.
+	bool find(_TKey* key, _TValue& value_return)
+	{
+		return LuaHashMap_TryGetValueIntegerForKeyPointer(luaHashMap, key, &value_return, NULL);
+	}
     
     iterator begin()
     {
@@ -1287,6 +1636,23 @@ public:
 		return erase((*the_iterator).first);
 	}
 
+	// Removes every key/value pair the predicate returns true for in a single pass. Returns the number removed.
+	// The predicate is called with a pair_type and must not use this map (or any map sharing its lua_State).
+	template<class _Predicate>
+	size_t erase_if(_Predicate the_predicate)
+	{
+		return LuaHashMap_RemoveIf(luaHashMap, &erase_if_predicate<_Predicate>, &the_predicate);
+	}
+
+private:
+	template<class _Predicate>
+	static int erase_if_predicate(const LuaHashMapIterator* hash_iterator, void* user_data)
+	{
+		// Only the cached key and value are safe to read while LuaHashMap_RemoveIf is traversing
+		return (*static_cast<_Predicate*>(user_data))(std::make_pair(static_cast<_TKey*>(hash_iterator->currentKey.thePointer), static_cast<_TValue>(LuaHashMap_GetCachedValueIntegerAtIterator(hash_iterator))));
+	}
+public:
+
 };
 
 
@@ -1324,9 +1690,24 @@ public:
 		return LuaHashMap_IsEmpty(luaHashMap);
 	}
 	
+	void begin_access()
+	{
+		LuaHashMap_BeginAccess(luaHashMap);
+	}
+	
+	void end_access()
+	{
+		LuaHashMap_EndAccess(luaHashMap);
+	}
+	
 	size_t size() const
 	{
-		return LuaHashMap_GetKeysInteger(luaHashMap, NULL, 0);
+		return LuaHashMap_Count(luaHashMap);
+	}
+	
+	void reserve(size_t number_of_elements)
+	{
+		LuaHashMap_Reserve(luaHashMap, 0, static_cast<int>(number_of_elements));
 	}
 	
 	void insert(const pair_type& key_value_pair)
@@ -1390,7 +1771,7 @@ public:
 		
 		pair_type operator*()
 		{
-			return std::make_pair(static_cast<_TKey>(luaHashMapIterator.currentKey.theNumber), static_cast<_TValue*>(LuaHashMap_GetValuePointerAtIterator(&luaHashMapIterator)));
+			return std::make_pair(static_cast<_TKey>(LuaHashMap_GetKeyIntegerAtIterator(&luaHashMapIterator)), static_cast<_TValue*>(LuaHashMap_GetValuePointerAtIterator(&luaHashMapIterator)));
 		}
 		
 		bool operator==(const iterator& the_other) const
@@ -1417,6 +1798,18 @@ public:
 		the_iter.set_current_key(key);
 		return the_iter;
 	}
+	
+	// Looks up the key and fetches its value with a single look up. Returns false if the key was not found.
+	bool find(_TKey key, _TValue*& value_return)
+	{
+		void* value_pointer = NULL;
+		bool is_found = LuaHashMap_TryGetValuePointerForKeyInteger(luaHashMap, key, &value_pointer, NULL);
+		if(true == is_found)
+		{
+			value_return = static_cast<_TValue*>(value_pointer);
+		}
+		return is_found;
+	}
     
     iterator begin()
     {
@@ -1436,6 +1829,23 @@ public:
 		return erase((*the_iterator).first);
 	}
 
+	// Removes every key/value pair the predicate returns true for in a single pass. Returns the number removed.
+	// The predicate is called with a pair_type and must not use this map (or any map sharing its lua_State).
+	template<class _Predicate>
+	size_t erase_if(_Predicate the_predicate)
+	{
+		return LuaHashMap_RemoveIf(luaHashMap, &erase_if_predicate<_Predicate>, &the_predicate);
+	}
+
+private:
+	template<class _Predicate>
+	static int erase_if_predicate(const LuaHashMapIterator* hash_iterator, void* user_data)
+	{
+		// Only the cached key and value are safe to read while LuaHashMap_RemoveIf is traversing
+		return (*static_cast<_Predicate*>(user_data))(std::make_pair(static_cast<_TKey>(LuaHashMap_GetKeyIntegerAtIterator(hash_iterator)), static_cast<_TValue*>(LuaHashMap_GetCachedValuePointerAtIterator(hash_iterator))));
+	}
+public:
+
 };
 
 
@@ -1474,9 +1884,24 @@ public:
 		return LuaHashMap_IsEmpty(luaHashMap);
 	}
 	
+	void begin_access()
+	{
+		LuaHashMap_BeginAccess(luaHashMap);
+	}
+	
+	void end_access()
+	{
+		LuaHashMap_EndAccess(luaHashMap);
+	}
+	
 	size_t size() const
 	{
-		return LuaHashMap_GetKeysInteger(luaHashMap, NULL, 0);
+		return LuaHashMap_Count(luaHashMap);
+	}
+	
+	void reserve(size_t number_of_elements)
+	{
+		LuaHashMap_Reserve(luaHashMap, 0, static_cast<int>(number_of_elements));
 	}
 	
 	void insert(const pair_type& key_value_pair)
@@ -1540,7 +1965,7 @@ public:
 		
 		pair_type operator*()
 		{
-			return std::make_pair(static_cast<_TKey>(luaHashMapIterator.currentKey.theNumber), static_cast<_TValue>(LuaHashMap_GetValueStringAtIterator(&luaHashMapIterator)));
+			return std::make_pair(static_cast<_TKey>(LuaHashMap_GetKeyIntegerAtIterator(&luaHashMapIterator)), static_cast<_TValue>(LuaHashMap_GetValueStringAtIterator(&luaHashMapIterator)));
 		}
 		
 		bool operator==(const iterator& the_other) const
@@ -1567,6 +1992,12 @@ public:
 		the_iter.set_current_key(key);
 		return the_iter;
 	}
+	
+	// Looks up the key and fetches its value with a single look up. Returns false if the key was not found.
+	bool find(_TKey key, _TValue& value_return)
+	{
+		return LuaHashMap_TryGetValueStringForKeyInteger(luaHashMap, key, &value_return, NULL);
+	}
     
     iterator begin()
     {
@@ -1586,6 +2017,23 @@ public:
 		return erase((*the_iterator).first);
 	}
 
+	// Removes every key/value pair the predicate returns true for in a single pass. Returns the number removed.
+	// The predicate is called with a pair_type and must not use this map (or any map sharing its lua_State).
+	template<class _Predicate>
+	size_t erase_if(_Predicate the_predicate)
+	{
+		return LuaHashMap_RemoveIf(luaHashMap, &erase_if_predicate<_Predicate>, &the_predicate);
+	}
+
+private:
+	template<class _Predicate>
+	static int erase_if_predicate(const LuaHashMapIterator* hash_iterator, void* user_data)
+	{
+		// Only the cached key and value are safe to read while LuaHashMap_RemoveIf is traversing
+		return (*static_cast<_Predicate*>(user_data))(std::make_pair(static_cast<_TKey>(LuaHashMap_GetKeyIntegerAtIterator(hash_iterator)), static_cast<_TValue>(LuaHashMap_GetCachedValueStringAtIterator(hash_iterator))));
+	}
+public:
+
 };
 
 
@@ -1624,9 +2072,24 @@ public:
 		return LuaHashMap_IsEmpty(luaHashMap);
 	}
 	
+	void begin_access()
+	{
+		LuaHashMap_BeginAccess(luaHashMap);
+	}
+	
+	void end_access()
+	{
+		LuaHashMap_EndAccess(luaHashMap);
+	}
+	
 	size_t size() const
 	{
-		return LuaHashMap_GetKeysInteger(luaHashMap, NULL, 0);
+		return LuaHashMap_Count(luaHashMap);
+	}
+	
+	void reserve(size_t number_of_elements)
+	{
+		LuaHashMap_Reserve(luaHashMap, 0, static_cast<int>(number_of_elements));
 	}
 	
 	void insert(const pair_type& key_value_pair)
@@ -1690,7 +2153,7 @@ public:
 		
 		pair_type operator*()
 		{
-			return std::make_pair(static_cast<_TKey>(luaHashMapIterator.currentKey.theNumber), static_cast<_TValue>(LuaHashMap_GetValueIntegerAtIterator(&luaHashMapIterator)));
+			return std::make_pair(static_cast<_TKey>(LuaHashMap_GetKeyIntegerAtIterator(&luaHashMapIterator)), static_cast<_TValue>(LuaHashMap_GetValueIntegerAtIterator(&luaHashMapIterator)));
 		}
 		
 		bool operator==(const iterator& the_other) const
@@ -1717,6 +2180,12 @@ public:
 		the_iter.set_current_key(key);
 		return the_iter;
 	}
+	
+	// Looks up the key and fetches its value with a single look up. Returns false if the key was not found.
+	bool find(_TKey key, _TValue& value_return)
+	{
+		return LuaHashMap_TryGetValueIntegerForKeyInteger(luaHashMap, key, &value_return, NULL);
+	}
     
     iterator begin()
     {
@@ -1736,6 +2205,23 @@ public:
 		return erase((*the_iterator).first);
 	}
 
+	// Removes every key/value pair the predicate returns true for in a single pass. Returns the number removed.
+	// The predicate is called with a pair_type and must not use this map (or any map sharing its lua_State).
+	template<class _Predicate>
+	size_t erase_if(_Predicate the_predicate)
+	{
+		return LuaHashMap_RemoveIf(luaHashMap, &erase_if_predicate<_Predicate>, &the_predicate);
+	}
+
+private:
+	template<class _Predicate>
+	static int erase_if_predicate(const LuaHashMapIterator* hash_iterator, void* user_data)
+	{
+		// Only the cached key and value are safe to read while LuaHashMap_RemoveIf is traversing
+		return (*static_cast<_Predicate*>(user_data))(std::make_pair(static_cast<_TKey>(LuaHashMap_GetKeyIntegerAtIterator(hash_iterator)), static_cast<_TValue>(LuaHashMap_GetCachedValueIntegerAtIterator(hash_iterator))));
+	}
+public:
+
 };
 
 
@@ -1775,9 +2261,24 @@ public:
 		return LuaHashMap_IsEmpty(luaHashMap);
 	}
 	
+	void begin_access()
+	{
+		LuaHashMap_BeginAccess(luaHashMap);
+	}
+	
+	void end_access()
+	{
+		LuaHashMap_EndAccess(luaHashMap);
+	}
+	
 	size_t size() const
 	{
-		return LuaHashMap_GetKeysInteger(luaHashMap, NULL, 0);
+		return LuaHashMap_Count(luaHashMap);
+	}
+	
+	void reserve(size_t number_of_elements)
+	{
+		LuaHashMap_Reserve(luaHashMap, 0, static_cast<int>(number_of_elements));
 	}
 	
 	void insert(const pair_type& key_value_pair)
@@ -1841,7 +2342,7 @@ public:
 		
 		pair_type operator*()
 		{
-			return std::make_pair(static_cast<_TKey>(luaHashMapIterator.currentKey.theNumber), static_cast<_TValue>(LuaHashMap_GetValueNumberAtIterator(&luaHashMapIterator)));
+			return std::make_pair(static_cast<_TKey>(LuaHashMap_GetKeyIntegerAtIterator(&luaHashMapIterator)), static_cast<_TValue>(LuaHashMap_GetValueNumberAtIterator(&luaHashMapIterator)));
 		}
 		
 		bool operator==(const iterator& the_other) const
@@ -1868,6 +2369,12 @@ public:
 		the_iter.set_current_key(key);
 		return the_iter;
 	}
+	
+	// Looks up the key and fetches its value with a single look up. Returns false if the key was not found.
+	bool find(_TKey key, _TValue& value_return)
+	{
+		return LuaHashMap_TryGetValueNumberForKeyInteger(luaHashMap, key, &value_return, NULL);
+	}
     
     iterator begin()
     {
@@ -1887,7 +2394,24 @@ public:
 		return erase((*the_iterator).first);
 	}
 
-};
+	// Removes every key/value pair the predicate returns true for in a single pass. Returns the number removed.
+	// The predicate is called with a pair_type and must not use this map (or any map sharing its lua_State).
+	template<class _Predicate>
+	size_t erase_if(_Predicate the_predicate)
+	{
+		return LuaHashMap_RemoveIf(luaHashMap, &erase_if_predicate<_Predicate>, &the_predicate);
+	}
+
+private:
+	template<class _Predicate>
+	static int erase_if_predicate(const LuaHashMapIterator* hash_iterator, void* user_data)
+	{
+		// Only the cached key and value are safe to read while LuaHashMap_RemoveIf is traversing
+		return (*static_cast<_Predicate*>(user_data))(std::make_pair(static_cast<_TKey>(LuaHashMap_GetKeyIntegerAtIterator(hash_iterator)), static_cast<_TValue>(LuaHashMap_GetCachedValueNumberAtIterator(hash_iterator))));
+	}
+public:
+
+};
 
 
 /* This seems stupid, but it seems I must reimplement every single method 
@@ -1924,9 +2448,24 @@ public:
 		return LuaHashMap_IsEmpty(luaHashMap);
 	}
 	
+	void begin_access()
+	{
+		LuaHashMap_BeginAccess(luaHashMap);
+	}
+	
+	void end_access()
+	{
+		LuaHashMap_EndAccess(luaHashMap);
+	}
+	
 	size_t size() const
 	{
-		return LuaHashMap_GetKeysNumber(luaHashMap, NULL, 0);
+		return LuaHashMap_Count(luaHashMap);
+	}
+	
+	void reserve(size_t number_of_elements)
+	{
+		LuaHashMap_Reserve(luaHashMap, 0, static_cast<int>(number_of_elements));
 	}
 	
 	void insert(const pair_type& key_value_pair)
@@ -1990,7 +2529,7 @@ public:
 		
 		pair_type operator*()
 		{
-			return std::make_pair(static_cast<_TKey>(luaHashMapIterator.currentKey.theNumber), static_cast<_TValue*>(LuaHashMap_GetValuePointerAtIterator(&luaHashMapIterator)));
+			return std::make_pair(static_cast<_TKey>(LuaHashMap_GetKeyNumberAtIterator(&luaHashMapIterator)), static_cast<_TValue*>(LuaHashMap_GetValuePointerAtIterator(&luaHashMapIterator)));
 		}
 		
 		bool operator==(const iterator& the_other) const
@@ -2017,6 +2556,18 @@ public:
 		the_iter.set_current_key(key);
 		return the_iter;
 	}
+	
+	// Looks up the key and fetches its value with a single look up. Returns false if the key was not found.
+	bool find(_TKey key, _TValue*& value_return)
+	{
+		void* value_pointer = NULL;
+		bool is_found = LuaHashMap_TryGetValuePointerForKeyNumber(luaHashMap, key, &value_pointer, NULL);
+		if(true == is_found)
+		{
+			value_return = static_cast<_TValue*>(value_pointer);
+		}
+		return is_found;
+	}
     
     iterator begin()
     {
@@ -2036,6 +2587,23 @@ public:
 		return erase((*the_iterator).first);
 	}
 
+	// Removes every key/value pair the predicate returns true for in a single pass. Returns the number removed.
+	// The predicate is called with a pair_type and must not use this map (or any map sharing its lua_State).
+	template<class _Predicate>
+	size_t erase_if(_Predicate the_predicate)
+	{
+		return LuaHashMap_RemoveIf(luaHashMap, &erase_if_predicate<_Predicate>, &the_predicate);
+	}
+
+private:
+	template<class _Predicate>
+	static int erase_if_predicate(const LuaHashMapIterator* hash_iterator, void* user_data)
+	{
+		// Only the cached key and value are safe to read while LuaHashMap_RemoveIf is traversing
+		return (*static_cast<_Predicate*>(user_data))(std::make_pair(static_cast<_TKey>(LuaHashMap_GetKeyNumberAtIterator(hash_iterator)), static_cast<_TValue*>(LuaHashMap_GetCachedValuePointerAtIterator(hash_iterator))));
+	}
+public:
+
 };
 
 
@@ -2074,9 +2642,24 @@ public:
 		return LuaHashMap_IsEmpty(luaHashMap);
 	}
 	
+	void begin_access()
+	{
+		LuaHashMap_BeginAccess(luaHashMap);
+	}
+	
+	void end_access()
+	{
+		LuaHashMap_EndAccess(luaHashMap);
+	}
+	
 	size_t size() const
 	{
-		return LuaHashMap_GetKeysNumber(luaHashMap, NULL, 0);
+		return LuaHashMap_Count(luaHashMap);
+	}
+	
+	void reserve(size_t number_of_elements)
+	{
+		LuaHashMap_Reserve(luaHashMap, 0, static_cast<int>(number_of_elements));
 	}
 	
 	void insert(const pair_type& key_value_pair)
@@ -2140,7 +2723,7 @@ public:
 		
 		pair_type operator*()
 		{
-			return std::make_pair(static_cast<_TKey>(luaHashMapIterator.currentKey.theNumber), static_cast<_TValue>(LuaHashMap_GetValueStringAtIterator(&luaHashMapIterator)));
+			return std::make_pair(static_cast<_TKey>(LuaHashMap_GetKeyNumberAtIterator(&luaHashMapIterator)), static_cast<_TValue>(LuaHashMap_GetValueStringAtIterator(&luaHashMapIterator)));
 		}
 		
 		bool operator==(const iterator& the_other) const
@@ -2167,6 +2750,12 @@ public:
 		the_iter.set_current_key(key);
 		return the_iter;
 	}
+	
+	// Looks up the key and fetches its value with a single look up. Returns false if the key was not found.
+	bool find(_TKey key, _TValue& value_return)
+	{
+		return LuaHashMap_TryGetValueStringForKeyNumber(luaHashMap, key, &value_return, NULL);
+	}
     
     iterator begin()
     {
@@ -2186,6 +2775,23 @@ public:
 		return erase((*the_iterator).first);
 	}
 
+	// Removes every key/value pair the predicate returns true for in a single pass. Returns the number removed.
+	// The predicate is called with a pair_type and must not use this map (or any map sharing its lua_State).
+	template<class _Predicate>
+	size_t erase_if(_Predicate the_predicate)
+	{
+		return LuaHashMap_RemoveIf(luaHashMap, &erase_if_predicate<_Predicate>, &the_predicate);
+	}
+
+private:
+	template<class _Predicate>
+	static int erase_if_predicate(const LuaHashMapIterator* hash_iterator, void* user_data)
+	{
+		// Only the cached key and value are safe to read while LuaHashMap_RemoveIf is traversing
+		return (*static_cast<_Predicate*>(user_data))(std::make_pair(static_cast<_TKey>(LuaHashMap_GetKeyNumberAtIterator(hash_iterator)), static_cast<_TValue>(LuaHashMap_GetCachedValueStringAtIterator(hash_iterator))));
+	}
+public:
+
 };
 
 
@@ -2224,9 +2830,24 @@ public:
 		return LuaHashMap_IsEmpty(luaHashMap);
 	}
 	
+	void begin_access()
+	{
+		LuaHashMap_BeginAccess(luaHashMap);
+	}
+	
+	void end_access()
+	{
+		LuaHashMap_EndAccess(luaHashMap);
+	}
+	
 	size_t size() const
 	{
-		return LuaHashMap_GetKeysNumber(luaHashMap, NULL, 0);
+		return LuaHashMap_Count(luaHashMap);
+	}
+	
+	void reserve(size_t number_of_elements)
+	{
+		LuaHashMap_Reserve(luaHashMap, 0, static_cast<int>(number_of_elements));
 	}
 	
 	void insert(const pair_type& key_value_pair)
@@ -2290,7 +2911,7 @@ public:
 		
 		pair_type operator*()
 		{
-			return std::make_pair(static_cast<_TKey>(luaHashMapIterator.currentKey.theNumber), static_cast<_TValue>(LuaHashMap_GetValueIntegerAtIterator(&luaHashMapIterator)));
+			return std::make_pair(static_cast<_TKey>(LuaHashMap_GetKeyNumberAtIterator(&luaHashMapIterator)), static_cast<_TValue>(LuaHashMap_GetValueIntegerAtIterator(&luaHashMapIterator)));
 		}
 		
 		bool operator==(const iterator& the_other) const
@@ -2317,6 +2938,12 @@ public:
 		the_iter.set_current_key(key);
 		return the_iter;
 	}
+	
+	// Looks up the key and fetches its value with a single look up. Returns false if the key was not found.
+	bool find(_TKey key, _TValue& value_return)
+	{
+		return LuaHashMap_TryGetValueIntegerForKeyNumber(luaHashMap, key, &value_return, NULL);
+	}
     
     iterator begin()
     {
@@ -2336,6 +2963,23 @@ public:
 		return erase((*the_iterator).first);
 	}
 
+	// Removes every key/value pair the predicate returns true for in a single pass. Returns the number removed.
+	// The predicate is called with a pair_type and must not use this map (or any map sharing its lua_State).
+	template<class _Predicate>
+	size_t erase_if(_Predicate the_predicate)
+	{
+		return LuaHashMap_RemoveIf(luaHashMap, &erase_if_predicate<_Predicate>, &the_predicate);
+	}
+
+private:
+	template<class _Predicate>
+	static int erase_if_predicate(const LuaHashMapIterator* hash_iterator, void* user_data)
+	{
+		// Only the cached key and value are safe to read while LuaHashMap_RemoveIf is traversing
+		return (*static_cast<_Predicate*>(user_data))(std::make_pair(static_cast<_TKey>(LuaHashMap_GetKeyNumberAtIterator(hash_iterator)), static_cast<_TValue>(LuaHashMap_GetCachedValueIntegerAtIterator(hash_iterator))));
+	}
+public:
+
 };
 
 
@@ -2374,9 +3018,24 @@ public:
 		return LuaHashMap_IsEmpty(luaHashMap);
 	}
 	
+	void begin_access()
+	{
+		LuaHashMap_BeginAccess(luaHashMap);
+	}
+	
+	void end_access()
+	{
+		LuaHashMap_EndAccess(luaHashMap);
+	}
+	
 	size_t size() const
 	{
-		return LuaHashMap_GetKeysNumber(luaHashMap, NULL, 0);
+		return LuaHashMap_Count(luaHashMap);
+	}
+	
+	void reserve(size_t number_of_elements)
+	{
+		LuaHashMap_Reserve(luaHashMap, 0, static_cast<int>(number_of_elements));
 	}
 	
 	void insert(const pair_type& key_value_pair)
@@ -2440,7 +3099,7 @@ public:
 		
 		pair_type operator*()
 		{
-			return std::make_pair(static_cast<_TKey>(luaHashMapIterator.currentKey.theNumber), static_cast<_TValue>(LuaHashMap_GetValueNumberAtIterator(&luaHashMapIterator)));
+			return std::make_pair(static_cast<_TKey>(LuaHashMap_GetKeyNumberAtIterator(&luaHashMapIterator)), static_cast<_TValue>(LuaHashMap_GetValueNumberAtIterator(&luaHashMapIterator)));
 		}
 		
 		bool operator==(const iterator& the_other) const
@@ -2467,6 +3126,12 @@ public:
 		the_iter.set_current_key(key);
 		return the_iter;
 	}
+	
+	// Looks up the key and fetches its value with a single look up. Returns false if the key was not found.
+	bool find(_TKey key, _TValue& value_return)
+	{
+		return LuaHashMap_TryGetValueNumberForKeyNumber(luaHashMap, key, &value_return, NULL);
+	}
     
     iterator begin()
     {
@@ -2486,6 +3151,23 @@ public:
 		return erase((*the_iterator).first);
 	}
 
+	// Removes every key/value pair the predicate returns true for in a single pass. Returns the number removed.
+	// The predicate is called with a pair_type and must not use this map (or any map sharing its lua_State).
+	template<class _Predicate>
+	size_t erase_if(_Predicate the_predicate)
+	{
+		return LuaHashMap_RemoveIf(luaHashMap, &erase_if_predicate<_Predicate>, &the_predicate);
+	}
+
+private:
+	template<class _Predicate>
+	static int erase_if_predicate(const LuaHashMapIterator* hash_iterator, void* user_data)
+	{
+		// Only the cached key and value are safe to read while LuaHashMap_RemoveIf is traversing
+		return (*static_cast<_Predicate*>(user_data))(std::make_pair(static_cast<_TKey>(LuaHashMap_GetKeyNumberAtIterator(hash_iterator)), static_cast<_TValue>(LuaHashMap_GetCachedValueNumberAtIterator(hash_iterator))));
+	}
+public:
+
 };
 
 
@@ -2530,9 +3212,24 @@ public:
 		return LuaHashMap_IsEmpty(luaHashMap);
 	}
 	
+	void begin_access()
+	{
+		LuaHashMap_BeginAccess(luaHashMap);
+	}
+	
+	void end_access()
+	{
+		LuaHashMap_EndAccess(luaHashMap);
+	}
+	
 	size_t size() const
 	{
-		return LuaHashMap_GetKeysString(luaHashMap, NULL, 0);
+		return LuaHashMap_Count(luaHashMap);
+	}
+	
+	void reserve(size_t number_of_elements)
+	{
+		LuaHashMap_Reserve(luaHashMap, 0, static_cast<int>(number_of_elements));
 	}
 	
 	void insert(const pair_type& key_value_pair)
@@ -2625,6 +3322,12 @@ public:
 		the_iter.set_current_key(key_string);
 		return the_iter;
 	}
+	
+	// Looks up the key and fetches its value with a single look up. Returns false if the key was not found.
+	bool find(_TKey key_string, _TValue& value_return)
+	{
+		return LuaHashMap_TryGetValueStringForKeyStringWithLength(luaHashMap, key_string.c_str(), key_string.size(), &value_return, NULL, NULL);
+	}
     
     iterator begin()
     {
@@ -2643,6 +3346,23 @@ public:
 	{
 		return erase((*the_iterator).first);
 	}
+
+	// Removes every key/value pair the predicate returns true for in a single pass. Returns the number removed.
+	// The predicate is called with a pair_type and must not use this map (or any map sharing its lua_State).
+	template<class _Predicate>
+	size_t erase_if(_Predicate the_predicate)
+	{
+		return LuaHashMap_RemoveIf(luaHashMap, &erase_if_predicate<_Predicate>, &the_predicate);
+	}
+
+private:
+	template<class _Predicate>
+	static int erase_if_predicate(const LuaHashMapIterator* hash_iterator, void* user_data)
+	{
+		// Only the cached key and value are safe to read while LuaHashMap_RemoveIf is traversing
+		return (*static_cast<_Predicate*>(user_data))(std::make_pair(static_cast<_TKey>(std::string(hash_iterator->currentKey.theString.stringPointer)), static_cast<_TValue>(LuaHashMap_GetCachedValueStringAtIterator(hash_iterator))));
+	}
+public:
 };
 	
 
@@ -2683,9 +3403,24 @@ public:
 		return LuaHashMap_IsEmpty(luaHashMap);
 	}
 	
+	void begin_access()
+	{
+		LuaHashMap_BeginAccess(luaHashMap);
+	}
+	
+	void end_access()
+	{
+		LuaHashMap_EndAccess(luaHashMap);
+	}
+	
 	size_t size() const
 	{
-		return LuaHashMap_GetKeysString(luaHashMap, NULL, 0);
+		return LuaHashMap_Count(luaHashMap);
+	}
+	
+	void reserve(size_t number_of_elements)
+	{
+		LuaHashMap_Reserve(luaHashMap, 0, static_cast<int>(number_of_elements));
 	}
 	
 	void insert(const pair_type& key_value_pair)
@@ -2778,6 +3513,18 @@ public:
 		the_iter.set_current_key(key_string);
 		return the_iter;
 	}
+	
+	// Looks up the key and fetches its value with a single look up. Returns false if the key was not found.
+	bool find(_TKey key_string, _TValue& value_return)
+	{
+		const char* value_string = NULL;
+		bool is_found = LuaHashMap_TryGetValueStringForKeyString(luaHashMap, key_string, &value_string, NULL);
+		if(true == is_found && NULL != value_string)
+		{
+			value_return.assign(value_string);
+		}
+		return is_found;
+	}
     
     iterator begin()
     {
@@ -2797,6 +3544,23 @@ public:
 		return erase((*the_iterator).first);
 	}
 
+	// Removes every key/value pair the predicate returns true for in a single pass. Returns the number removed.
+	// The predicate is called with a pair_type and must not use this map (or any map sharing its lua_State).
+	template<class _Predicate>
+	size_t erase_if(_Predicate the_predicate)
+	{
+		return LuaHashMap_RemoveIf(luaHashMap, &erase_if_predicate<_Predicate>, &the_predicate);
+	}
+
+private:
+	template<class _Predicate>
+	static int erase_if_predicate(const LuaHashMapIterator* hash_iterator, void* user_data)
+	{
+		// Only the cached key and value are safe to read while LuaHashMap_RemoveIf is traversing
+		return (*static_cast<_Predicate*>(user_data))(std::make_pair(static_cast<_TKey>(hash_iterator->currentKey.theString.stringPointer), static_cast<_TValue>(std::string(LuaHashMap_GetCachedValueStringAtIterator(hash_iterator)))));
+	}
+public:
+
 };
 
 	
@@ -2836,9 +3600,24 @@ public:
 		return LuaHashMap_IsEmpty(luaHashMap);
 	}
 	
+	void begin_access()
+	{
+		LuaHashMap_BeginAccess(luaHashMap);
+	}
+	
+	void end_access()
+	{
+		LuaHashMap_EndAccess(luaHashMap);
+	}
+	
 	size_t size() const
 	{
-		return LuaHashMap_GetKeysString(luaHashMap, NULL, 0);
+		return LuaHashMap_Count(luaHashMap);
+	}
+	
+	void reserve(size_t number_of_elements)
+	{
+		LuaHashMap_Reserve(luaHashMap, 0, static_cast<int>(number_of_elements));
 	}
 	
 	void insert(const pair_type& key_value_pair)
@@ -2931,6 +3710,19 @@ public:
 		the_iter.set_current_key(key_string);
 		return the_iter;
 	}
+	
+	// Looks up the key and fetches its value with a single look up. Returns false if the key was not found.
+	bool find(_TKey key_string, _TValue& value_return)
+	{
+		const char* value_string = NULL;
+		size_t value_string_length = 0;
+		bool is_found = LuaHashMap_TryGetValueStringForKeyStringWithLength(luaHashMap, key_string.c_str(), key_string.size(), &value_string, &value_string_length, NULL);
+		if(true == is_found)
+		{
+			value_return.assign(value_string, value_string_length);
+		}
+		return is_found;
+	}
     
     iterator begin()
     {
@@ -2949,6 +3741,23 @@ public:
 	{
 		return erase((*the_iterator).first);
 	}
+
+	// Removes every key/value pair the predicate returns true for in a single pass. Returns the number removed.
+	// The predicate is called with a pair_type and must not use this map (or any map sharing its lua_State).
+	template<class _Predicate>
+	size_t erase_if(_Predicate the_predicate)
+	{
+		return LuaHashMap_RemoveIf(luaHashMap, &erase_if_predicate<_Predicate>, &the_predicate);
+	}
+
+private:
+	template<class _Predicate>
+	static int erase_if_predicate(const LuaHashMapIterator* hash_iterator, void* user_data)
+	{
+		// Only the cached key and value are safe to read while LuaHashMap_RemoveIf is traversing
+		return (*static_cast<_Predicate*>(user_data))(std::make_pair(static_cast<_TKey>(std::string(hash_iterator->currentKey.theString.stringPointer)), static_cast<_TValue>(std::string(LuaHashMap_GetCachedValueStringAtIterator(hash_iterator)))));
+	}
+public:
 };
 	
 
@@ -2987,9 +3796,24 @@ public:
 		return LuaHashMap_IsEmpty(luaHashMap);
 	}
 	
+	void begin_access()
+	{
+		LuaHashMap_BeginAccess(luaHashMap);
+	}
+	
+	void end_access()
+	{
+		LuaHashMap_EndAccess(luaHashMap);
+	}
+	
 	size_t size() const
 	{
-		return LuaHashMap_GetKeysString(luaHashMap, NULL, 0);
+		return LuaHashMap_Count(luaHashMap);
+	}
+	
+	void reserve(size_t number_of_elements)
+	{
+		LuaHashMap_Reserve(luaHashMap, 0, static_cast<int>(number_of_elements));
 	}
 	
 	void insert(const pair_type& key_value_pair)
@@ -3081,6 +3905,18 @@ public:
 		the_iter.set_current_key(key_string);
 		return the_iter;
 	}
+	
+	// Looks up the key and fetches its value with a single look up. Returns false if the key was not found.
+	bool find(_TKey key_string, _TValue*& value_return)
+	{
+		void* value_pointer = NULL;
+		bool is_found = LuaHashMap_TryGetValuePointerForKeyStringWithLength(luaHashMap, key_string.c_str(), key_string.size(), &value_pointer, NULL);
+		if(true == is_found)
+		{
+			value_return = static_cast<_TValue*>(value_pointer);
+		}
+		return is_found;
+	}
     
     iterator begin()
     {
@@ -3100,6 +3936,23 @@ public:
 		return erase((*the_iterator).first);
 	}
 
+	// Removes every key/value pair the predicate returns true for in a single pass. Returns the number removed.
+	// The predicate is called with a pair_type and must not use this map (or any map sharing its lua_State).
+	template<class _Predicate>
+	size_t erase_if(_Predicate the_predicate)
+	{
+		return LuaHashMap_RemoveIf(luaHashMap, &erase_if_predicate<_Predicate>, &the_predicate);
+	}
+
+private:
+	template<class _Predicate>
+	static int erase_if_predicate(const LuaHashMapIterator* hash_iterator, void* user_data)
+	{
+		// Only the cached key and value are safe to read while LuaHashMap_RemoveIf is traversing
+		return (*static_cast<_Predicate*>(user_data))(std::make_pair(static_cast<_TKey>(std::string(hash_iterator->currentKey.theString.stringPointer)), static_cast<_TValue*>(LuaHashMap_GetCachedValuePointerAtIterator(hash_iterator))));
+	}
+public:
+
 };
 
 	
@@ -3138,9 +3991,24 @@ public:
 		return LuaHashMap_IsEmpty(luaHashMap);
 	}
 	
+	void begin_access()
+	{
+		LuaHashMap_BeginAccess(luaHashMap);
+	}
+	
+	void end_access()
+	{
+		LuaHashMap_EndAccess(luaHashMap);
+	}
+	
 	size_t size() const
 	{
-		return LuaHashMap_GetKeysString(luaHashMap, NULL, 0);
+		return LuaHashMap_Count(luaHashMap);
+	}
+	
+	void reserve(size_t number_of_elements)
+	{
+		LuaHashMap_Reserve(luaHashMap, 0, static_cast<int>(number_of_elements));
 	}
 	
 	void insert(const pair_type& key_value_pair)
@@ -3232,6 +4100,12 @@ public:
 		the_iter.set_current_key(key_string);
 		return the_iter;
 	}
+	
+	// Looks up the key and fetches its value with a single look up. Returns false if the key was not found.
+	bool find(_TKey key_string, _TValue& value_return)
+	{
+		return LuaHashMap_TryGetValueNumberForKeyStringWithLength(luaHashMap, key_string.c_str(), key_string.size(), &value_return, NULL);
+	}
     
     iterator begin()
     {
@@ -3251,6 +4125,23 @@ public:
 		return erase((*the_iterator).first);
 	}
 
+	// Removes every key/value pair the predicate returns true for in a single pass. Returns the number removed.
+	// The predicate is called with a pair_type and must not use this map (or any map sharing its lua_State).
+	template<class _Predicate>
+	size_t erase_if(_Predicate the_predicate)
+	{
+		return LuaHashMap_RemoveIf(luaHashMap, &erase_if_predicate<_Predicate>, &the_predicate);
+	}
+
+private:
+	template<class _Predicate>
+	static int erase_if_predicate(const LuaHashMapIterator* hash_iterator, void* user_data)
+	{
+		// Only the cached key and value are safe to read while LuaHashMap_RemoveIf is traversing
+		return (*static_cast<_Predicate*>(user_data))(std::make_pair(static_cast<_TKey>(std::string(hash_iterator->currentKey.theString.stringPointer)), static_cast<_TValue>(LuaHashMap_GetCachedValueNumberAtIterator(hash_iterator))));
+	}
+public:
+
 };
 
 /* This seems stupid, but it seems I must reimplement every single method 
@@ -3288,9 +4179,24 @@ public:
 		return LuaHashMap_IsEmpty(luaHashMap);
 	}
 	
+	void begin_access()
+	{
+		LuaHashMap_BeginAccess(luaHashMap);
+	}
+	
+	void end_access()
+	{
+		LuaHashMap_EndAccess(luaHashMap);
+	}
+	
 	size_t size() const
 	{
-		return LuaHashMap_GetKeysString(luaHashMap, NULL, 0);
+		return LuaHashMap_Count(luaHashMap);
+	}
+	
+	void reserve(size_t number_of_elements)
+	{
+		LuaHashMap_Reserve(luaHashMap, 0, static_cast<int>(number_of_elements));
 	}
 	
 	void insert(const pair_type& key_value_pair)
@@ -3382,6 +4288,12 @@ public:
 		the_iter.set_current_key(key_string);
 		return the_iter;
 	}
+	
+	// Looks up the key and fetches its value with a single look up. Returns false if the key was not found.
+	bool find(_TKey key_string, _TValue& value_return)
+	{
+		return LuaHashMap_TryGetValueIntegerForKeyStringWithLength(luaHashMap, key_string.c_str(), key_string.size(), &value_return, NULL);
+	}
     
     iterator begin()
     {
@@ -3401,6 +4313,23 @@ public:
 		return erase((*the_iterator).first);
 	}
 
+	// Removes every key/value pair the predicate returns true for in a single pass. Returns the number removed.
+	// The predicate is called with a pair_type and must not use this map (or any map sharing its lua_State).
+	template<class _Predicate>
+	size_t erase_if(_Predicate the_predicate)
+	{
+		return LuaHashMap_RemoveIf(luaHashMap, &erase_if_predicate<_Predicate>, &the_predicate);
+	}
+
+private:
+	template<class _Predicate>
+	static int erase_if_predicate(const LuaHashMapIterator* hash_iterator, void* user_data)
+	{
+		// Only the cached key and value are safe to read while LuaHashMap_RemoveIf is traversing
+		return (*static_cast<_Predicate*>(user_data))(std::make_pair(static_cast<_TKey>(std::string(hash_iterator->currentKey.theString.stringPointer)), static_cast<_TValue>(LuaHashMap_GetCachedValueIntegerAtIterator(hash_iterator))));
+	}
+public:
+
 };
 
 
@@ -3441,9 +4370,24 @@ public:
 		return LuaHashMap_IsEmpty(luaHashMap);
 	}
 	
+	void begin_access()
+	{
+		LuaHashMap_BeginAccess(luaHashMap);
+	}
+	
+	void end_access()
+	{
+		LuaHashMap_EndAccess(luaHashMap);
+	}
+	
 	size_t size() const
 	{
-		return LuaHashMap_GetKeysPointer(luaHashMap, NULL, 0);
+		return LuaHashMap_Count(luaHashMap);
+	}
+	
+	void reserve(size_t number_of_elements)
+	{
+		LuaHashMap_Reserve(luaHashMap, 0, static_cast<int>(number_of_elements));
 	}
 	
 	void insert(const pair_type& key_value_pair)
@@ -3535,6 +4479,19 @@ public:
 		the_iter.set_current_key(key);
 		return the_iter;
 	}
+	
+	// Looks up the key and fetches its value with a single look up. Returns false if the key was not found.
+	bool find(_TKey* key, _TValue& value_return)
+	{
+		const char* value_string = NULL;
+		size_t value_string_length = 0;
+		bool is_found = LuaHashMap_TryGetValueStringForKeyPointerWithLength(luaHashMap, key, &value_string, &value_string_length, NULL);
+		if(true == is_found)
+		{
+			value_return.assign(value_string, value_string_length);
+		}
+		return is_found;
+	}
     
     iterator begin()
     {
@@ -3554,6 +4511,23 @@ public:
 		return erase((*the_iterator).first);
 	}
 
+	// Removes every key/value pair the predicate returns true for in a single pass. Returns the number removed.
+	// The predicate is called with a pair_type and must not use this map (or any map sharing its lua_State).
+	template<class _Predicate>
+	size_t erase_if(_Predicate the_predicate)
+	{
+		return LuaHashMap_RemoveIf(luaHashMap, &erase_if_predicate<_Predicate>, &the_predicate);
+	}
+
+private:
+	template<class _Predicate>
+	static int erase_if_predicate(const LuaHashMapIterator* hash_iterator, void* user_data)
+	{
+		// Only the cached key and value are safe to read while LuaHashMap_RemoveIf is traversing
+		return (*static_cast<_Predicate*>(user_data))(std::make_pair(static_cast<_TKey*>(hash_iterator->currentKey.thePointer), static_cast<_TValue>(std::string(LuaHashMap_GetCachedValueStringAtIterator(hash_iterator)))));
+	}
+public:
+
 };
 	
 
@@ -3593,9 +4567,24 @@ public:
 		return LuaHashMap_IsEmpty(luaHashMap);
 	}
 	
+	void begin_access()
+	{
+		LuaHashMap_BeginAccess(luaHashMap);
+	}
+	
+	void end_access()
+	{
+		LuaHashMap_EndAccess(luaHashMap);
+	}
+	
 	size_t size() const
 	{
-		return LuaHashMap_GetKeysInteger(luaHashMap, NULL, 0);
+		return LuaHashMap_Count(luaHashMap);
+	}
+	
+	void reserve(size_t number_of_elements)
+	{
+		LuaHashMap_Reserve(luaHashMap, 0, static_cast<int>(number_of_elements));
 	}
 	
 	void insert(const pair_type& key_value_pair)
@@ -3659,7 +4648,7 @@ public:
 		
 		pair_type operator*()
 		{
-			return std::make_pair(static_cast<_TKey>(luaHashMapIterator.currentKey.theNumber), static_cast<_TValue>(std::string(LuaHashMap_GetValueStringAtIterator(&luaHashMapIterator))));
+			return std::make_pair(static_cast<_TKey>(LuaHashMap_GetKeyIntegerAtIterator(&luaHashMapIterator)), static_cast<_TValue>(std::string(LuaHashMap_GetValueStringAtIterator(&luaHashMapIterator))));
 		}
 		
 		bool operator==(const iterator& the_other) const
@@ -3686,6 +4675,19 @@ public:
 		the_iter.set_current_key(key);
 		return the_iter;
 	}
+	
+	// Looks up the key and fetches its value with a single look up. Returns false if the key was not found.
+	bool find(_TKey key, _TValue& value_return)
+	{
+		const char* value_string = NULL;
+		size_t value_string_length = 0;
+		bool is_found = LuaHashMap_TryGetValueStringForKeyIntegerWithLength(luaHashMap, key, &value_string, &value_string_length, NULL);
+		if(true == is_found)
+		{
+			value_return.assign(value_string, value_string_length);
+		}
+		return is_found;
+	}
     
     iterator begin()
     {
@@ -3705,6 +4707,23 @@ public:
 		return erase((*the_iterator).first);
 	}
 
+	// Removes every key/value pair the predicate returns true for in a single pass. Returns the number removed.
+	// The predicate is called with a pair_type and must not use this map (or any map sharing its lua_State).
+	template<class _Predicate>
+	size_t erase_if(_Predicate the_predicate)
+	{
+		return LuaHashMap_RemoveIf(luaHashMap, &erase_if_predicate<_Predicate>, &the_predicate);
+	}
+
+private:
+	template<class _Predicate>
+	static int erase_if_predicate(const LuaHashMapIterator* hash_iterator, void* user_data)
+	{
+		// Only the cached key and value are safe to read while LuaHashMap_RemoveIf is traversing
+		return (*static_cast<_Predicate*>(user_data))(std::make_pair(static_cast<_TKey>(LuaHashMap_GetKeyIntegerAtIterator(hash_iterator)), static_cast<_TValue>(std::string(LuaHashMap_GetCachedValueStringAtIterator(hash_iterator)))));
+	}
+public:
+
 };
 
 
@@ -3744,9 +4763,24 @@ public:
 		return LuaHashMap_IsEmpty(luaHashMap);
 	}
 	
+	void begin_access()
+	{
+		LuaHashMap_BeginAccess(luaHashMap);
+	}
+	
+	void end_access()
+	{
+		LuaHashMap_EndAccess(luaHashMap);
+	}
+	
 	size_t size() const
 	{
-		return LuaHashMap_GetKeysNumber(luaHashMap, NULL, 0);
+		return LuaHashMap_Count(luaHashMap);
+	}
+	
+	void reserve(size_t number_of_elements)
+	{
+		LuaHashMap_Reserve(luaHashMap, 0, static_cast<int>(number_of_elements));
 	}
 	
 	void insert(const pair_type& key_value_pair)
@@ -3810,7 +4844,7 @@ public:
 		
 		pair_type operator*()
 		{
-			return std::make_pair(static_cast<_TKey>(luaHashMapIterator.currentKey.theNumber), static_cast<_TValue>(std::string(LuaHashMap_GetValueStringAtIterator(&luaHashMapIterator))));
+			return std::make_pair(static_cast<_TKey>(LuaHashMap_GetKeyNumberAtIterator(&luaHashMapIterator)), static_cast<_TValue>(std::string(LuaHashMap_GetValueStringAtIterator(&luaHashMapIterator))));
 		}
 		
 		bool operator==(const iterator& the_other) const
@@ -3837,6 +4871,19 @@ public:
 		the_iter.set_current_key(key);
 		return the_iter;
 	}
+	
+	// Looks up the key and fetches its value with a single look up. Returns false if the key was not found.
+	bool find(_TKey key, _TValue& value_return)
+	{
+		const char* value_string = NULL;
+		size_t value_string_length = 0;
+		bool is_found = LuaHashMap_TryGetValueStringForKeyNumberWithLength(luaHashMap, key, &value_string, &value_string_length, NULL);
+		if(true == is_found)
+		{
+			value_return.assign(value_string, value_string_length);
+		}
+		return is_found;
+	}
     
     iterator begin()
     {
@@ -3856,9 +4903,501 @@ public:
 		return erase((*the_iterator).first);
 	}
 
+	// Removes every key/value pair the predicate returns true for in a single pass. Returns the number removed.
+	// The predicate is called with a pair_type and must not use this map (or any map sharing its lua_State).
+	template<class _Predicate>
+	size_t erase_if(_Predicate the_predicate)
+	{
+		return LuaHashMap_RemoveIf(luaHashMap, &erase_if_predicate<_Predicate>, &the_predicate);
+	}
+
+private:
+	template<class _Predicate>
+	static int erase_if_predicate(const LuaHashMapIterator* hash_iterator, void* user_data)
+	{
+		// Only the cached key and value are safe to read while LuaHashMap_RemoveIf is traversing
+		return (*static_cast<_Predicate*>(user_data))(std::make_pair(static_cast<_TKey>(LuaHashMap_GetKeyNumberAtIterator(hash_iterator)), static_cast<_TValue>(std::string(LuaHashMap_GetCachedValueStringAtIterator(hash_iterator)))));
+	}
+public:
+
 };
 
 
+// Same as the erase_if member function. Mirrors the C++20 std::erase_if for the standard containers.
+template<class _Key, class _Tp, class _Predicate>
+size_t erase_if(lua_hash_map<_Key, _Tp>& the_map, _Predicate the_predicate)
+{
+	return the_map.erase_if(the_predicate);
+}
+
+#ifdef LUAHASHMAPCPP_HAS_FUTURE
+/* A hash map owned by one thread (see LuaHashMapActor). Any thread may call find/contains/insert/erase.
+ * They queue the operation without locking and return a std::future that the owner fulfills.
+ * The owner thread calls run() (which blocks until stop()) or drain() from its own loop.
+ * Keys may be lua_Integer, lua_Number, std::string or a pointer. Values may be the same. 
+ * (const char* is not supported because the string would have to outlive the request.)
+ * Example:
+ *     lhm::lua_hash_map_actor<std::string, lua_Integer> the_map;
+ *     std::thread owner_thread([&the_map]() { the_map.run(); });
+ *     the_map.insert(std::make_pair(std::string("apple"), lua_Integer(1)));
+ *     std::pair<bool, lua_Integer> the_result = the_map.find("apple").get();
+ *     the_map.stop();
+ *     owner_thread.join();
+ * With C++20, coroutines can co_await async_find/async_contains/async_insert/async_erase/async_find_all instead.
+ * The single-key awaitables allocate nothing per request: the request lives in the coroutine frame.
+ * async_find_all allocates once per call: it copies the keys and holds its requests and results in vectors.
+ * The owner resumes the coroutines after the batch their requests were in, so a coroutine continues on the owner thread.
+ *     std::pair<bool, lua_Integer> the_result = co_await the_map.async_find("apple");
+ */
+template<class _Key, class _Tp>
+class lua_hash_map_actor
+{
+public:
+	typedef _Key _TKey;
+	typedef _Tp _TValue;
+	typedef std::pair<_TKey, _TValue> pair_type;
+
+private:
+	LuaHashMap* luaHashMap;
+	LuaHashMapActor* luaHashMapActor;
+
+	// The heap allocated state of one request. The completion callback frees it.
+	template<class _Result>
+	struct pending_request
+	{
+		LuaHashMapActorRequest actorRequest;
+		// Keeps std::string keys and values alive until the owner runs the request
+		_TKey theKey;
+		_TValue theValue;
+		std::promise<_Result> thePromise;
+
+		pending_request(const _TKey& the_key, const _TValue& the_value)
+		: theKey(the_key), theValue(the_value)
+		{
+			std::memset(&actorRequest, 0, sizeof(LuaHashMapActorRequest));
+		}
+	};
+
+	lua_hash_map_actor(const lua_hash_map_actor&) = delete;
+	lua_hash_map_actor& operator=(const lua_hash_map_actor&) = delete;
+
+	static void to_lua_hash_map_value(lua_Integer the_integer, LuaHashMapValue& value_return)
+	{
+		value_return.valueType = LUA_TNUMBER;
+		value_return.isInteger = true;
+		value_return.theValue.theInteger = the_integer;
+	}
+	static void to_lua_hash_map_value(lua_Number the_number, LuaHashMapValue& value_return)
+	{
+		value_return.valueType = LUA_TNUMBER;
+		value_return.isInteger = false;
+		value_return.theValue.theNumber = the_number;
+	}
+	static void to_lua_hash_map_value(const std::string& the_string, LuaHashMapValue& value_return)
+	{
+		value_return.valueType = LUA_TSTRING;
+		value_return.theValue.theString.stringPointer = the_string.c_str();
+		value_return.theValue.theString.stringLength = the_string.length();
+	}
+	template<class _TPointer>
+	static void to_lua_hash_map_value(_TPointer* the_pointer, LuaHashMapValue& value_return)
+	{
+		value_return.valueType = LUA_TLIGHTUSERDATA;
+		value_return.theValue.thePointer = (void*)the_pointer;
+	}
+	static void to_lua_hash_map_value(const char* the_string, LuaHashMapValue& value_return) = delete;
+
+	static void from_lua_hash_map_value(const LuaHashMapValue& the_value, lua_Integer& value_return)
+	{
+		value_return = the_value.isInteger ? the_value.theValue.theInteger : static_cast<lua_Integer>(the_value.theValue.theNumber);
+	}
+	static void from_lua_hash_map_value(const LuaHashMapValue& the_value, lua_Number& value_return)
+	{
+		value_return = the_value.isInteger ? static_cast<lua_Number>(the_value.theValue.theInteger) : the_value.theValue.theNumber;
+	}
+	static void from_lua_hash_map_value(const LuaHashMapValue& the_value, std::string& value_return)
+	{
+		// The string lives in the lua_State, so copy it while we are still in the callback
+		value_return.assign(the_value.theValue.theString.stringPointer, the_value.theValue.theString.stringLength);
+	}
+	template<class _TPointer>
+	static void from_lua_hash_map_value(const LuaHashMapValue& the_value, _TPointer*& value_return)
+	{
+		value_return = static_cast<_TPointer*>(the_value.theValue.thePointer);
+	}
+
+	template<class _Result>
+	std::future<_Result> submit(pending_request<_Result>* the_request, LuaHashMapActorOperation the_operation, LuaHashMapActor_CompletionFunction completion_function)
+	{
+		std::future<_Result> the_future = the_request->thePromise.get_future();
+		the_request->actorRequest.theOperation = the_operation;
+		to_lua_hash_map_value(the_request->theKey, the_request->actorRequest.theKey);
+		if(LUAHASHMAP_ACTOR_SET == the_operation)
+		{
+			to_lua_hash_map_value(the_request->theValue, the_request->actorRequest.theValue);
+		}
+		the_request->actorRequest.completionFunction = completion_function;
+		the_request->actorRequest.userData = the_request;
+		LuaHashMapActor_Submit(luaHashMapActor, &the_request->actorRequest);
+		return the_future;
+	}
+
+	// These run on the owner thread. Exceptions must not escape into the C code, so they go to the future instead.
+	static void complete_find(LuaHashMapActorRequest* actor_request, void* user_data)
+	{
+		std::unique_ptr<pending_request<std::pair<bool, _TValue> > > the_request(static_cast<pending_request<std::pair<bool, _TValue> >*>(user_data));
+		try
+		{
+			_TValue the_value = _TValue();
+			if(true == actor_request->wasFound)
+			{
+				from_lua_hash_map_value(actor_request->theValue, the_value);
+			}
+			the_request->thePromise.set_value(std::make_pair(static_cast<bool>(actor_request->wasFound), the_value));
+		}
+		catch(...)
+		{
+			the_request->thePromise.set_exception(std::current_exception());
+		}
+	}
+	static void complete_contains(LuaHashMapActorRequest* actor_request, void* user_data)
+	{
+		std::unique_ptr<pending_request<bool> > the_request(static_cast<pending_request<bool>*>(user_data));
+		the_request->thePromise.set_value(true == actor_request->wasFound);
+	}
+	static void complete_void(LuaHashMapActorRequest* actor_request, void* user_data)
+	{
+		std::unique_ptr<pending_request<void> > the_request(static_cast<pending_request<void>*>(user_data));
+		(void)actor_request;
+		the_request->thePromise.set_value();
+	}
+
+#ifdef LUAHASHMAPCPP_HAS_COROUTINE
+	// A coroutine waiting on the owner. Finished ones are linked into the resume list, so completing never allocates or throws.
+	struct resumable
+	{
+		std::coroutine_handle<> theHandle;
+		resumable* nextResumable;
+
+		resumable()
+		: theHandle(), nextResumable(NULL)
+		{
+		}
+	};
+	// Owner thread only
+	resumable* resumeListHead;
+	resumable* resumeListTail;
+
+	void queue_resume(resumable* the_resumable)
+	{
+		the_resumable->nextResumable = NULL;
+		if(NULL == resumeListTail)
+		{
+			resumeListHead = the_resumable;
+		}
+		else
+		{
+			resumeListTail->nextResumable = the_resumable;
+		}
+		resumeListTail = the_resumable;
+	}
+
+	// Resumed coroutines may submit more requests. Those go to the next batch.
+	void resume_pending()
+	{
+		resumable* the_resumable = resumeListHead;
+		resumeListHead = NULL;
+		resumeListTail = NULL;
+		while(NULL != the_resumable)
+		{
+			// Resuming can destroy the frame the resumable lives in
+			resumable* next_resumable = the_resumable->nextResumable;
+			the_resumable->theHandle.resume();
+			the_resumable = next_resumable;
+		}
+	}
+
+	// The state shared by the single key awaitables. It lives in the coroutine frame.
+	// It can't be copied or moved because the request points into it once submitted.
+	struct single_request : resumable
+	{
+		lua_hash_map_actor* theActor;
+		LuaHashMapActorRequest actorRequest;
+		_TKey theKey;
+		_TValue theValue;
+		bool wasFound;
+		std::exception_ptr theException;
+
+		single_request(lua_hash_map_actor* the_actor, LuaHashMapActorOperation the_operation, const _TKey& the_key, const _TValue& the_value)
+		: theActor(the_actor), theKey(the_key), theValue(the_value), wasFound(false)
+		{
+			std::memset(&actorRequest, 0, sizeof(LuaHashMapActorRequest));
+			actorRequest.theOperation = the_operation;
+		}
+		single_request(const single_request&) = delete;
+		single_request& operator=(const single_request&) = delete;
+
+		bool await_ready() const
+		{
+			return false;
+		}
+		void await_suspend(std::coroutine_handle<> the_handle)
+		{
+			this->theHandle = the_handle;
+			to_lua_hash_map_value(theKey, actorRequest.theKey);
+			if(LUAHASHMAP_ACTOR_SET == actorRequest.theOperation)
+			{
+				to_lua_hash_map_value(theValue, actorRequest.theValue);
+			}
+			actorRequest.completionFunction = &complete;
+			actorRequest.userData = this;
+			// The owner may resume (and destroy) us as soon as this is queued, so don't touch this afterwards.
+			LuaHashMapActor_Submit(theActor->luaHashMapActor, &actorRequest);
+		}
+		static void complete(LuaHashMapActorRequest* actor_request, void* user_data)
+		{
+			single_request* the_request = static_cast<single_request*>(user_data);
+			the_request->wasFound = (true == actor_request->wasFound);
+			if((true == the_request->wasFound) && (LUAHASHMAP_ACTOR_GET == actor_request->theOperation))
+			{
+				try
+				{
+					from_lua_hash_map_value(actor_request->theValue, the_request->theValue);
+				}
+				catch(...)
+				{
+					the_request->theException = std::current_exception();
+				}
+			}
+			the_request->theActor->queue_resume(the_request);
+		}
+		void rethrow_if_failed() const
+		{
+			if(theException)
+			{
+				std::rethrow_exception(theException);
+			}
+		}
+	};
+
+public:
+	struct find_awaitable : single_request
+	{
+		find_awaitable(lua_hash_map_actor* the_actor, const _TKey& the_key)
+		: single_request(the_actor, LUAHASHMAP_ACTOR_GET, the_key, _TValue())
+		{
+		}
+		std::pair<bool, _TValue> await_resume()
+		{
+			this->rethrow_if_failed();
+			return std::make_pair(this->wasFound, this->theValue);
+		}
+	};
+
+	struct contains_awaitable : single_request
+	{
+		contains_awaitable(lua_hash_map_actor* the_actor, const _TKey& the_key)
+		: single_request(the_actor, LUAHASHMAP_ACTOR_EXISTS, the_key, _TValue())
+		{
+		}
+		bool await_resume() const
+		{
+			return this->wasFound;
+		}
+	};
+
+	// Used by async_insert and async_erase
+	struct modify_awaitable : single_request
+	{
+		modify_awaitable(lua_hash_map_actor* the_actor, LuaHashMapActorOperation the_operation, const _TKey& the_key, const _TValue& the_value)
+		: single_request(the_actor, the_operation, the_key, the_value)
+		{
+		}
+		void await_resume() const
+		{
+		}
+	};
+
+	// Looks up several keys with one submission, so they all run in the same batch and the coroutine is resumed once.
+	// Unlike the single-key awaitables this allocates: the keys are copied (so they outlive a temporary vector)
+	// and the requests and results live in vectors sized to the number of keys.
+	class find_all_awaitable : resumable
+	{
+		lua_hash_map_actor* theActor;
+		std::vector<_TKey> theKeys;
+		std::vector<LuaHashMapActorRequest> actorRequests;
+		std::vector<std::pair<bool, _TValue> > theResults;
+		// Only touched by the owner once submitted
+		size_t numberOfPendingRequests;
+		std::exception_ptr theException;
+
+		static void complete(LuaHashMapActorRequest* actor_request, void* user_data)
+		{
+			find_all_awaitable* the_awaitable = static_cast<find_all_awaitable*>(user_data);
+			std::pair<bool, _TValue>& the_result = the_awaitable->theResults[actor_request - &the_awaitable->actorRequests[0]];
+			the_result.first = (true == actor_request->wasFound);
+			if(true == the_result.first)
+			{
+				try
+				{
+					from_lua_hash_map_value(actor_request->theValue, the_result.second);
+				}
+				catch(...)
+				{
+					the_awaitable->theException = std::current_exception();
+				}
+			}
+			the_awaitable->numberOfPendingRequests--;
+			if(0 == the_awaitable->numberOfPendingRequests)
+			{
+				the_awaitable->theActor->queue_resume(the_awaitable);
+			}
+		}
+
+	public:
+		find_all_awaitable(lua_hash_map_actor* the_actor, const std::vector<_TKey>& the_keys)
+		: theActor(the_actor), theKeys(the_keys), actorRequests(the_keys.size()), theResults(the_keys.size(), std::make_pair(false, _TValue())), numberOfPendingRequests(the_keys.size())
+		{
+			for(size_t i=0; i<actorRequests.size(); i++)
+			{
+				std::memset(&actorRequests[i], 0, sizeof(LuaHashMapActorRequest));
+			}
+		}
+		find_all_awaitable(const find_all_awaitable&) = delete;
+		find_all_awaitable& operator=(const find_all_awaitable&) = delete;
+
+		bool await_ready() const
+		{
+			return theKeys.empty();
+		}
+		void await_suspend(std::coroutine_handle<> the_handle)
+		{
+			this->theHandle = the_handle;
+			for(size_t i=0; i<actorRequests.size(); i++)
+			{
+				actorRequests[i].theOperation = LUAHASHMAP_ACTOR_GET;
+				to_lua_hash_map_value(theKeys[i], actorRequests[i].theKey);
+				actorRequests[i].completionFunction = &complete;
+				actorRequests[i].userData = this;
+			}
+			// The owner may resume (and destroy) us as soon as this is queued, so don't touch this afterwards.
+			LuaHashMapActor_SubmitBatch(theActor->luaHashMapActor, &actorRequests[0], actorRequests.size());
+		}
+		std::vector<std::pair<bool, _TValue> > await_resume()
+		{
+			if(theException)
+			{
+				std::rethrow_exception(theException);
+			}
+			return std::move(theResults);
+		}
+	};
+
+private:
+#endif /* LUAHASHMAPCPP_HAS_COROUTINE */
+
+public:
+	lua_hash_map_actor()
+	: luaHashMap(NULL), luaHashMapActor(NULL)
+	{
+#ifdef LUAHASHMAPCPP_HAS_COROUTINE
+		resumeListHead = NULL;
+		resumeListTail = NULL;
+#endif
+		luaHashMap = LuaHashMap_Create();
+		luaHashMapActor = LuaHashMapActor_Create(luaHashMap);
+	}
+
+	// The owner must have returned from run() by now. Requests still queued are completed first
+	// (and waiting coroutines resumed, on the calling thread).
+	~lua_hash_map_actor()
+	{
+		while(0 != drain())
+		{
+		}
+		LuaHashMapActor_Free(luaHashMapActor);
+		LuaHashMap_Free(luaHashMap);
+	}
+
+	// Owner thread only: executes requests until stop() is called.
+	void run()
+	{
+		do
+		{
+			drain();
+		} while(LuaHashMapActor_WaitForRequests(luaHashMapActor));
+		// Finish what was queued before the stop
+		drain();
+	}
+
+	// Any thread: makes run() return once the requests queued so far are done.
+	void stop()
+	{
+		LuaHashMapActor_Stop(luaHashMapActor);
+	}
+
+	// Owner thread only: executes everything queued so far as one batch. Returns the number of requests executed.
+	size_t drain()
+	{
+		size_t number_of_requests = LuaHashMapActor_Drain(luaHashMapActor);
+#ifdef LUAHASHMAPCPP_HAS_COROUTINE
+		resume_pending();
+#endif
+		return number_of_requests;
+	}
+
+	// Resolves to (true, value) or (false, _TValue()) if the key was not found.
+	std::future<std::pair<bool, _TValue> > find(const _TKey& key)
+	{
+		return submit(new pending_request<std::pair<bool, _TValue> >(key, _TValue()), LUAHASHMAP_ACTOR_GET, &complete_find);
+	}
+
+	std::future<bool> contains(const _TKey& key)
+	{
+		return submit(new pending_request<bool>(key, _TValue()), LUAHASHMAP_ACTOR_EXISTS, &complete_contains);
+	}
+
+	std::future<void> insert(const pair_type& key_value_pair)
+	{
+		return submit(new pending_request<void>(key_value_pair.first, key_value_pair.second), LUAHASHMAP_ACTOR_SET, &complete_void);
+	}
+
+	std::future<void> erase(const _TKey& key)
+	{
+		return submit(new pending_request<void>(key, _TValue()), LUAHASHMAP_ACTOR_REMOVE, &complete_void);
+	}
+
+#ifdef LUAHASHMAPCPP_HAS_COROUTINE
+	// co_await resolves to (true, value) or (false, _TValue()). The awaitable holds the key, so it may be a temporary.
+	find_awaitable async_find(const _TKey& key)
+	{
+		return find_awaitable(this, key);
+	}
+
+	contains_awaitable async_contains(const _TKey& key)
+	{
+		return contains_awaitable(this, key);
+	}
+
+	modify_awaitable async_insert(const pair_type& key_value_pair)
+	{
+		return modify_awaitable(this, LUAHASHMAP_ACTOR_SET, key_value_pair.first, key_value_pair.second);
+	}
+
+	modify_awaitable async_erase(const _TKey& key)
+	{
+		return modify_awaitable(this, LUAHASHMAP_ACTOR_REMOVE, key, _TValue());
+	}
+
+	// co_await resolves to one (found, value) pair per key, in the same order.
+	find_all_awaitable async_find_all(const std::vector<_TKey>& keys)
+	{
+		return find_all_awaitable(this, keys);
+	}
+#endif
+};
+#endif /* LUAHASHMAPCPP_HAS_FUTURE */
+
 } /* end namespace */
 
 #endif /* CPP_LUA_HASH_MAP_H */
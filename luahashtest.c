@@ -1,9 +1,11 @@
 
 #include "LuaHashMap.h"
+#include "lauxlib.h"
 #include <stdio.h>
 #include <assert.h>
 #include <string.h>
 #include <stdlib.h>
+#include <limits.h>
 
 //#define ENABLE_BENCHMARK
 
@@ -11,6 +13,10 @@
 #include <QuartzCore/QuartzCore.h>
 #endif
 
+#if !defined(_WIN32) && !defined(WIN32)
+#include <pthread.h>
+#endif
+
 static int Internal_safestrcmp(const char* str1, const char* str2)
 {
 	if(NULL == str1 && NULL == str2)
@@ -157,129 +163,2027 @@ void TestSimpleKeyStringNumberValueWithIterator()
 }
 
 
-void TestValueStringNULL()
-{	
+void TestValueStringNULL()
+{	
+	LuaHashMap* hash_map = LuaHashMap_Create();
+	/* Better to declare when you assign it, but you need C99 */
+	LuaHashMapIterator hash_iterator;
+
+	fprintf(stderr, "TestValueStringNULL start\n");
+	
+	LuaHashMap_SetValueStringForKeyString(hash_map, "$3.99", "milk");
+	/* Lua treats NULL strings as pushing nil which removes an entry */
+	LuaHashMap_SetValueStringForKeyString(hash_map, NULL, "gas");
+	LuaHashMap_SetValueStringForKeyString(hash_map, "$2.99", "bread");
+	
+	hash_iterator = LuaHashMap_GetIteratorAtBegin(hash_map);
+	do
+	{
+		fprintf(stderr, "Price of %s: %s\n", 
+			   LuaHashMap_GetKeyStringAtIterator(&hash_iterator), 
+			   LuaHashMap_GetValueStringAtIterator(&hash_iterator));
+		
+	} while(LuaHashMap_IteratorNext(&hash_iterator));
+
+	/* Lua treats NULL strings as pushing nil which removes an entry. Thus we only have 2. */
+	/* Internal change: I now use lua_pushlstring and pass an explict 0 length. This causes Lua to push an empty string and create a key/value pair. So the count is 3. */
+//	assert(2 == LuaHashMap_Count(hash_map));
+	assert(3 == LuaHashMap_Count(hash_map));
+//	assert(0 == LuaHashMap_ExistsKeyString(hash_map, "gas"));
+	assert(1 == LuaHashMap_ExistsKeyString(hash_map, "gas"));
+	assert(1 == LuaHashMap_ExistsKeyString(hash_map, "milk"));
+	assert(1 == LuaHashMap_ExistsKeyString(hash_map, "bread"));
+
+	/* Lua treats NULL strings as pushing nil which removes an entry */
+	/* Internal change: lua_pushlstring causes the value to be set to an empty string so the entry remains. */
+	LuaHashMap_SetValueStringForKeyString(hash_map, NULL, "bread");
+
+	hash_iterator = LuaHashMap_GetIteratorAtBegin(hash_map);	
+	do
+	{
+		fprintf(stderr, "Price of %s: %s\n", 
+			   LuaHashMap_GetKeyStringAtIterator(&hash_iterator), 
+			   LuaHashMap_GetValueStringAtIterator(&hash_iterator));
+		
+	} while(LuaHashMap_IteratorNext(&hash_iterator));
+//	assert(1 == LuaHashMap_Count(hash_map));
+	assert(3 == LuaHashMap_Count(hash_map));
+//	assert(0 == LuaHashMap_ExistsKeyString(hash_map, "gas"));
+	assert(1 == LuaHashMap_ExistsKeyString(hash_map, "gas"));
+	assert(1 == LuaHashMap_ExistsKeyString(hash_map, "milk"));
+//	assert(0 == LuaHashMap_ExistsKeyString(hash_map, "bread"));
+	assert(1 == LuaHashMap_ExistsKeyString(hash_map, "bread"));
+	
+
+	LuaHashMap_Free(hash_map);
+	fprintf(stderr, "TestValueStringNULL done\n");	
+}
+
+
+void TestValuePointerNULL()
+{	
+	LuaHashMap* hash_map = LuaHashMap_Create();
+	/* Better to declare when you assign it, but you need C99 */
+	LuaHashMapIterator hash_iterator;
+	LuaHashMapIterator hash_iterator_end;
+
+	fprintf(stderr, "TestValuePointerNULL start\n");
+	
+	LuaHashMap_SetValuePointerForKeyString(hash_map, (void*)399, "milk");
+	/* Unlike strings, Lua seems to push NULL pointers as 0 which does not remove an entry. */
+	LuaHashMap_SetValuePointerForKeyString(hash_map, NULL, "gas");
+	LuaHashMap_SetValuePointerForKeyString(hash_map, (void*)299, "bread");
+	
+	hash_iterator = LuaHashMap_GetIteratorAtBegin(hash_map);
+	do
+	{
+		fprintf(stderr, "Price of %s: %d\n", 
+				LuaHashMap_GetKeyStringAtIterator(&hash_iterator), 
+				(int)LuaHashMap_GetValuePointerAtIterator(&hash_iterator));
+		
+	} while(LuaHashMap_IteratorNext(&hash_iterator));
+	/* Unlike strings, Lua seems to push NULL pointers as 0 which does not remove an entry. Thus we have 3. */
+	assert(3 == LuaHashMap_Count(hash_map));
+	assert(1 == LuaHashMap_ExistsKeyString(hash_map, "gas"));
+	assert(1 == LuaHashMap_ExistsKeyString(hash_map, "milk"));
+	assert(1 == LuaHashMap_ExistsKeyString(hash_map, "bread"));
+	assert((void*)399 == LuaHashMap_GetValuePointerForKeyString(hash_map, "milk"));
+	assert(NULL == LuaHashMap_GetValuePointerForKeyString(hash_map, "gas"));
+	assert((void*)299 == LuaHashMap_GetValuePointerForKeyString(hash_map, "bread"));
+
+	
+	LuaHashMap_SetValuePointerForKeyString(hash_map, NULL, "bread");
+
+	/* Showing a different way to loop */
+	for(hash_iterator = LuaHashMap_GetIteratorAtBegin(hash_map), hash_iterator_end = LuaHashMap_GetIteratorAtEnd(hash_map);
+		! LuaHashMap_IteratorIsEqual(&hash_iterator, &hash_iterator_end);
+		LuaHashMap_IteratorNext(&hash_iterator)
+	)
+	{
+		fprintf(stderr, "Price of %s: %d\n", 
+				LuaHashMap_GetKeyStringAtIterator(&hash_iterator), 
+				(int)LuaHashMap_GetValuePointerAtIterator(&hash_iterator));
+		
+	}
+	assert(1 == LuaHashMap_ExistsKeyString(hash_map, "gas"));
+	assert(1 == LuaHashMap_ExistsKeyString(hash_map, "milk"));
+	assert(1 == LuaHashMap_ExistsKeyString(hash_map, "bread"));
+	assert((void*)399 == LuaHashMap_GetValuePointerForKeyString(hash_map, "milk"));
+	assert(NULL == LuaHashMap_GetValuePointerForKeyString(hash_map, "gas"));
+	assert(NULL == LuaHashMap_GetValuePointerForKeyString(hash_map, "bread"));
+	
+	
+	
+	
+	/* Lua will also accept NULL for both keys and values when used as pointers (userdata) */
+	LuaHashMap_SetValuePointerForKeyPointer(hash_map, NULL, NULL);
+	assert(4 == LuaHashMap_Count(hash_map));
+	 
+	 
+	 
+	
+	LuaHashMap_Free(hash_map);
+	fprintf(stderr, "TestValuePointerNULL done\n");
+	
+	
+}
+
+void TestSetValuesForKeys()
+{
+	size_t i;
+	LuaHashMap* hash_map = LuaHashMap_Create();
+	const char* key_strings[] = { "milk", "gas", NULL, "bread" };
+	const char* value_strings[] = { "$3.99", NULL, "$1.00", "$2.99" };
+	lua_Integer key_integers[100];
+	void* value_pointers[100];
+
+	fprintf(stderr, "TestSetValuesForKeys start\n");
+
+	/* NULL keys are skipped and NULL value strings become "" just like the single versions */
+	LuaHashMap_SetValuesStringForKeysString(hash_map, value_strings, key_strings, NULL, NULL, 4);
+	assert(3 == LuaHashMap_Count(hash_map));
+	assert(0 == Internal_safestrcmp("$3.99", LuaHashMap_GetValueStringForKeyString(hash_map, "milk")));
+	assert(0 == Internal_safestrcmp("", LuaHashMap_GetValueStringForKeyString(hash_map, "gas")));
+	assert(0 == Internal_safestrcmp("$2.99", LuaHashMap_GetValueStringForKeyString(hash_map, "bread")));
+	LuaHashMap_Clear(hash_map);
+
+	for(i=0; i<100; i++)
+	{
+		key_integers[i] = (lua_Integer)i;
+		value_pointers[i] = (void*)(i+1000);
+	}
+	LuaHashMap_SetValuesPointerForKeysInteger(hash_map, value_pointers, key_integers, 100);
+	assert(100 == LuaHashMap_Count(hash_map));
+	for(i=0; i<100; i++)
+	{
+		assert((void*)(i+1000) == LuaHashMap_GetValuePointerForKeyInteger(hash_map, (lua_Integer)i));
+	}
+
+	LuaHashMap_Free(hash_map);
+	fprintf(stderr, "TestSetValuesForKeys done\n");
+}
+
+void TestGetValuesForKeys()
+{
+	size_t i;
+	size_t ret_size;
+	LuaHashMap* hash_map = LuaHashMap_Create();
+	const char* key_strings[] = { "milk", "gas", "bread", "eggs", NULL };
+	void* value_pointers[5];
+	unsigned char found_bitmap[LUAHASHMAP_BITMAP_SIZE(5)];
+	lua_Integer key_integers[20];
+	lua_Number value_numbers[20];
+	const char* value_strings[20];
+	size_t value_lengths[20];
+
+	fprintf(stderr, "TestGetValuesForKeys start\n");
+
+	LuaHashMap_SetValuePointerForKeyString(hash_map, (void*)399, "milk");
+	LuaHashMap_SetValuePointerForKeyString(hash_map, NULL, "gas");
+	LuaHashMap_SetValuePointerForKeyString(hash_map, (void*)299, "bread");
+
+	ret_size = LuaHashMap_GetValuesPointerForKeysString(hash_map, value_pointers, key_strings, NULL, found_bitmap, 5);
+	assert(3 == ret_size);
+	assert((void*)399 == value_pointers[0]);
+	assert(NULL == value_pointers[1]);
+	assert((void*)299 == value_pointers[2]);
+	assert(NULL == value_pointers[3]);
+	assert(LUAHASHMAP_BITMAP_ISSET(found_bitmap, 0));
+	assert(LUAHASHMAP_BITMAP_ISSET(found_bitmap, 1));
+	assert(LUAHASHMAP_BITMAP_ISSET(found_bitmap, 2));
+	assert(!LUAHASHMAP_BITMAP_ISSET(found_bitmap, 3));
+	assert(!LUAHASHMAP_BITMAP_ISSET(found_bitmap, 4));
+	assert(3 == LuaHashMap_ExistsKeysString(hash_map, key_strings, NULL, NULL, 5));
+	LuaHashMap_Clear(hash_map);
+
+	for(i=0; i<10; i++)
+	{
+		LuaHashMap_SetValueNumberForKeyInteger(hash_map, (lua_Number)i + 0.5, (lua_Integer)i);
+	}
+	for(i=0; i<20; i++)
+	{
+		key_integers[i] = (lua_Integer)i;
+	}
+	ret_size = LuaHashMap_GetValuesNumberForKeysInteger(hash_map, value_numbers, key_integers, NULL, 20);
+	assert(10 == ret_size);
+	for(i=0; i<20; i++)
+	{
+		assert(((i<10) ? (lua_Number)i + 0.5 : 0.0) == value_numbers[i]);
+	}
+
+	/* Number values are found but not converted to strings, since nothing would keep the converted strings alive */
+	LuaHashMap_SetValueStringForKeyInteger(hash_map, "even", 0);
+	LuaHashMap_SetValueStringForKeyInteger(hash_map, "odd", 1);
+	ret_size = LuaHashMap_GetValuesStringForKeysInteger(hash_map, value_strings, key_integers, value_lengths, NULL, 20);
+	assert(10 == ret_size);
+	assert(0 == Internal_safestrcmp("even", value_strings[0]));
+	assert(3 == value_lengths[1]);
+	for(i=2; i<20; i++)
+	{
+		assert(NULL == value_strings[i]);
+		assert(0 == value_lengths[i]);
+	}
+
+	LuaHashMap_Free(hash_map);
+	fprintf(stderr, "TestGetValuesForKeys done\n");
+}
+
+void TestAccessSession()
+{
+	size_t i;
+	LuaHashMap* hash_map = LuaHashMap_Create();
+	LuaHashMap* shared_map = LuaHashMap_CreateShare(hash_map);
+	LuaHashMapIterator hash_iterator;
+	size_t iterator_count = 0;
+
+	fprintf(stderr, "TestAccessSession start\n");
+
+	LuaHashMap_BeginAccess(hash_map);
+	assert(1 == lua_gettop(LuaHashMap_GetLuaState(hash_map)));
+	for(i=0; i<1000; i++)
+	{
+		LuaHashMap_SetValueIntegerForKeyInteger(hash_map, (lua_Integer)i*2, (lua_Integer)i);
+	}
+	/* Nested sessions don't push the table again */
+	LuaHashMap_BeginAccess(hash_map);
+	assert(1 == lua_gettop(LuaHashMap_GetLuaState(hash_map)));
+	for(i=0; i<1000; i++)
+	{
+		assert((lua_Integer)i*2 == LuaHashMap_GetValueIntegerForKeyInteger(hash_map, (lua_Integer)i));
+	}
+	LuaHashMap_RemoveKeyInteger(hash_map, 500);
+	assert(false == LuaHashMap_ExistsKeyInteger(hash_map, 500));
+	LuaHashMap_EndAccess(hash_map);
+
+	hash_iterator = LuaHashMap_GetIteratorAtBegin(hash_map);
+	do
+	{
+		iterator_count++;
+	} while(LuaHashMap_IteratorNext(&hash_iterator));
+	assert(999 == iterator_count);
+	assert(999 == LuaHashMap_Count(hash_map));
+
+	/* Purge swaps in a new table which must replace the pinned one */
+	LuaHashMap_Purge(hash_map);
+	assert(1 == lua_gettop(LuaHashMap_GetLuaState(hash_map)));
+	LuaHashMap_SetValueIntegerForKeyInteger(hash_map, 7, 7);
+	assert(1 == LuaHashMap_Count(hash_map));
+
+	LuaHashMap_EndAccess(hash_map);
+	assert(0 == lua_gettop(LuaHashMap_GetLuaState(hash_map)));
+	assert(7 == LuaHashMap_GetValueIntegerForKeyInteger(hash_map, 7));
+
+	/* Unbalanced EndAccess is harmless */
+	LuaHashMap_EndAccess(hash_map);
+	assert(0 == lua_gettop(LuaHashMap_GetLuaState(hash_map)));
+
+	/* The shared map is untouched */
+	assert(0 == LuaHashMap_Count(shared_map));
+
+	/* Sessions on hash maps sharing a lua_State may overlap and end in any order */
+	{
+		LuaHashMap* third_map = LuaHashMap_CreateShare(hash_map);
+		LuaHashMap_BeginAccess(hash_map);
+		LuaHashMap_BeginAccess(shared_map);
+		assert(2 == lua_gettop(LuaHashMap_GetLuaState(hash_map)));
+		LuaHashMap_SetValueIntegerForKeyInteger(hash_map, 1, 1);
+		LuaHashMap_SetValueIntegerForKeyInteger(shared_map, 2, 2);
+		LuaHashMap_SetValueIntegerForKeyInteger(third_map, 3, 3);
+		/* Ending the lower session first must not move the table pinned above it */
+		LuaHashMap_EndAccess(hash_map);
+		assert(2 == LuaHashMap_GetValueIntegerForKeyInteger(shared_map, 2));
+		assert(false == LuaHashMap_ExistsKeyInteger(shared_map, 1));
+		LuaHashMap_SetValueIntegerForKeyInteger(shared_map, 4, 4);
+		/* And a new session may start on top of the hole */
+		LuaHashMap_BeginAccess(third_map);
+		assert(1 == LuaHashMap_GetValueIntegerForKeyInteger(hash_map, 1));
+		assert(3 == LuaHashMap_GetValueIntegerForKeyInteger(third_map, 3));
+		LuaHashMap_EndAccess(shared_map);
+		assert(3 == lua_gettop(LuaHashMap_GetLuaState(hash_map)));
+		assert(2 == LuaHashMap_Count(shared_map));
+		assert(false == LuaHashMap_ExistsKeyInteger(third_map, 2));
+		LuaHashMap_EndAccess(third_map);
+		assert(0 == lua_gettop(LuaHashMap_GetLuaState(hash_map)));
+
+		/* Freeing a share with a session still open doesn't disturb the others */
+		LuaHashMap_BeginAccess(third_map);
+		LuaHashMap_BeginAccess(shared_map);
+		LuaHashMap_FreeShare(third_map);
+		assert(4 == LuaHashMap_GetValueIntegerForKeyInteger(shared_map, 4));
+		LuaHashMap_EndAccess(shared_map);
+		assert(0 == lua_gettop(LuaHashMap_GetLuaState(hash_map)));
+	}
+
+	LuaHashMap_FreeShare(shared_map);
+	LuaHashMap_Free(hash_map);
+	fprintf(stderr, "TestAccessSession done\n");
+}
+
+void TestCount()
+{
+	LuaHashMap* hash_map = LuaHashMap_Create();
+	LuaHashMapIterator hash_iterator;
+
+	fprintf(stderr, "TestCount start\n");
+
+	LuaHashMap_SetValueIntegerForKeyString(hash_map, 1, "one");
+	LuaHashMap_SetValueIntegerForKeyString(hash_map, 2, "two");
+	assert(2 == LuaHashMap_Count(hash_map));
+	/* Overwrites don't change the count */
+	LuaHashMap_SetValueStringForKeyString(hash_map, "uno", "one");
+	assert(2 == LuaHashMap_Count(hash_map));
+	/* Removing a key that doesn't exist doesn't change the count */
+	LuaHashMap_RemoveKeyString(hash_map, "three");
+	assert(2 == LuaHashMap_Count(hash_map));
+
+	hash_iterator = LuaHashMap_GetIteratorForKeyString(hash_map, "two");
+	LuaHashMap_SetValueNumberAtIterator(&hash_iterator, 2.5);
+	assert(2 == LuaHashMap_Count(hash_map));
+	LuaHashMap_RemoveAtIterator(&hash_iterator);
+	assert(1 == LuaHashMap_Count(hash_map));
+	LuaHashMap_RemoveKeyString(hash_map, "two");
+	assert(1 == LuaHashMap_Count(hash_map));
+
+	LuaHashMap_Clear(hash_map);
+	assert(0 == LuaHashMap_Count(hash_map));
+	LuaHashMap_SetValuePointerForKeyPointer(hash_map, NULL, NULL);
+	assert(1 == LuaHashMap_Count(hash_map));
+	LuaHashMap_Purge(hash_map);
+	assert(0 == LuaHashMap_Count(hash_map));
+
+	LuaHashMap_Free(hash_map);
+	fprintf(stderr, "TestCount done\n");
+}
+
+void TestReserve()
+{
+	size_t i;
+	LuaHashMap* hash_map = LuaHashMap_Create();
+
+	fprintf(stderr, "TestReserve start\n");
+
+	for(i=0; i<100; i++)
+	{
+		LuaHashMap_SetValuePointerForKeyInteger(hash_map, (void*)(i+1), (lua_Integer)i);
+	}
+	LuaHashMap_SetValueStringForKeyString(hash_map, "value", "key");
+
+	LuaHashMap_Reserve(hash_map, 0, 100000);
+	assert(101 == LuaHashMap_Count(hash_map));
+	for(i=0; i<100; i++)
+	{
+		assert((void*)(i+1) == LuaHashMap_GetValuePointerForKeyInteger(hash_map, (lua_Integer)i));
+	}
+	assert(0 == Internal_safestrcmp("value", LuaHashMap_GetValueStringForKeyString(hash_map, "key")));
+
+	/* Reserve inside an access session must keep using the new table */
+	LuaHashMap_BeginAccess(hash_map);
+	LuaHashMap_Reserve(hash_map, 16, 200000);
+	LuaHashMap_SetValuePointerForKeyInteger(hash_map, (void*)1000, 1000);
+	{
+		/* A request that is already covered must not rebuild the table (the pinned table on top of the stack stays the same) */
+		lua_State* lua_state = LuaHashMap_GetLuaState(hash_map);
+		const void* table_pointer = lua_topointer(lua_state, -1);
+		LuaHashMap_Reserve(hash_map, 16, 200000);
+		assert(table_pointer == lua_topointer(lua_state, -1));
+		LuaHashMap_Reserve(hash_map, 8, 1000);
+		assert(table_pointer == lua_topointer(lua_state, -1));
+		LuaHashMap_Reserve(hash_map, 32, 200000);
+		assert(table_pointer != lua_topointer(lua_state, -1));
+	}
+	LuaHashMap_EndAccess(hash_map);
+	assert((void*)1000 == LuaHashMap_GetValuePointerForKeyInteger(hash_map, 1000));
+	assert(102 == LuaHashMap_Count(hash_map));
+
+	LuaHashMap_Free(hash_map);
+	fprintf(stderr, "TestReserve done\n");
+}
+
+void TestCompact()
+{
+	size_t i;
+	LuaHashMap* hash_map = LuaHashMap_Create();
+
+	fprintf(stderr, "TestCompact start\n");
+
+	for(i=0; i<1024; i++)
+	{
+		LuaHashMap_SetValueIntegerForKeyNumber(hash_map, (lua_Integer)i, (lua_Number)i + 0.5);
+	}
+	assert(0.0 == LuaHashMap_GetUnusedCapacityRatio(hash_map));
+	for(i=0; i<1000; i++)
+	{
+		LuaHashMap_RemoveKeyNumber(hash_map, (lua_Number)i + 0.5);
+	}
+	assert(24 == LuaHashMap_Count(hash_map));
+	assert(LuaHashMap_GetUnusedCapacityRatio(hash_map) > 0.9);
+
+	LuaHashMap_Compact(hash_map, false);
+	assert(24 == LuaHashMap_Count(hash_map));
+	assert(LuaHashMap_GetUnusedCapacityRatio(hash_map) < 0.5);
+	for(i=1000; i<1024; i++)
+	{
+		assert((lua_Integer)i == LuaHashMap_GetValueIntegerForKeyNumber(hash_map, (lua_Number)i + 0.5));
+	}
+
+	LuaHashMap_Clear(hash_map);
+	LuaHashMap_Compact(hash_map, true);
+	assert(0 == LuaHashMap_Count(hash_map));
+	assert(0.0 == LuaHashMap_GetUnusedCapacityRatio(hash_map));
+
+	/* Keys 1..n go back in the array part, so they count as capacity in use */
+	for(i=1; i<=100; i++)
+	{
+		LuaHashMap_SetValueIntegerForKeyInteger(hash_map, (lua_Integer)i*2, (lua_Integer)i);
+	}
+	LuaHashMap_SetValueStringForKeyString(hash_map, "value", "key");
+	LuaHashMap_Compact(hash_map, false);
+	assert(101 == LuaHashMap_Count(hash_map));
+	assert(0.0 == LuaHashMap_GetUnusedCapacityRatio(hash_map));
+	for(i=1; i<=100; i++)
+	{
+		assert((lua_Integer)i*2 == LuaHashMap_GetValueIntegerForKeyInteger(hash_map, (lua_Integer)i));
+	}
+	assert(0 == Internal_safestrcmp("value", LuaHashMap_GetValueStringForKeyString(hash_map, "key")));
+	/* Reserving no more than Compact sized the table for changes nothing */
+	LuaHashMap_Reserve(hash_map, 100, 1);
+	assert(0.0 == LuaHashMap_GetUnusedCapacityRatio(hash_map));
+
+	LuaHashMap_Free(hash_map);
+	fprintf(stderr, "TestCompact done\n");
+}
+
+void TestGCMode()
+{
+	size_t i;
+	int step_count = 0;
+	LuaHashMap* hash_map = LuaHashMap_Create();
+	static char str_buffer[64];
+
+	fprintf(stderr, "TestGCMode start\n");
+
+	assert(LUAHASHMAP_GCMODE_INCREMENTAL == LuaHashMap_GetGCMode(hash_map));
+	assert(true == LuaHashMap_SetGCMode(hash_map, LUAHASHMAP_GCMODE_STOPPED));
+	assert(LUAHASHMAP_GCMODE_STOPPED == LuaHashMap_GetGCMode(hash_map));
+
+	for(i=0; i<10000; i++)
+	{
+		sprintf(str_buffer, "key%d", (int)i);
+		LuaHashMap_SetValueIntegerForKeyString(hash_map, (lua_Integer)i, str_buffer);
+	}
+	LuaHashMap_Clear(hash_map);
+
+	/* Step until a cycle finishes. The collector must stay stopped afterwards. */
+	while(false == LuaHashMap_GCStep(hash_map, 64) && step_count < 100000)
+	{
+		step_count++;
+	}
+	assert(step_count < 100000);
+	assert(LUAHASHMAP_GCMODE_STOPPED == LuaHashMap_GetGCMode(hash_map));
+
+	assert(true == LuaHashMap_SetGCMode(hash_map, LUAHASHMAP_GCMODE_INCREMENTAL));
+#if LUA_VERSION_NUM == 502 || LUA_VERSION_NUM == 504
+	assert(true == LuaHashMap_SetGCMode(hash_map, LUAHASHMAP_GCMODE_GENERATIONAL));
+#else
+	assert(false == LuaHashMap_SetGCMode(hash_map, LUAHASHMAP_GCMODE_GENERATIONAL));
+	assert(LUAHASHMAP_GCMODE_INCREMENTAL == LuaHashMap_GetGCMode(hash_map));
+#endif
+
+	/* The mode belongs to the lua_State, so every hash map sharing it sees the same one */
+	{
+		LuaHashMap* shared_map = LuaHashMap_CreateShare(hash_map);
+		assert(true == LuaHashMap_SetGCMode(shared_map, LUAHASHMAP_GCMODE_STOPPED));
+		assert(LUAHASHMAP_GCMODE_STOPPED == LuaHashMap_GetGCMode(hash_map));
+		/* A step through the other hash map must still leave the collector stopped (Lua 5.1 restarts it) */
+		LuaHashMap_GCStep(hash_map, 0);
+		assert(LUAHASHMAP_GCMODE_STOPPED == LuaHashMap_GetGCMode(shared_map));
+		assert(true == LuaHashMap_SetGCMode(hash_map, LUAHASHMAP_GCMODE_INCREMENTAL));
+		assert(LUAHASHMAP_GCMODE_INCREMENTAL == LuaHashMap_GetGCMode(shared_map));
+		LuaHashMap_FreeShare(shared_map);
+	}
+
+	LuaHashMap_Free(hash_map);
+	fprintf(stderr, "TestGCMode done\n");
+}
+
+void TestExactIntegers()
+{
+	size_t i;
+	lua_Integer big_key = 1;
+	lua_Integer keys_seen = 0;
+	LuaHashMapIterator hash_iterator;
+	LuaHashMap* hash_map = LuaHashMap_Create();
+
+	fprintf(stderr, "TestExactIntegers start\n");
+
+	assert(true == LuaHashMap_SetExactIntegerMode(hash_map, true));
+	assert(true == LuaHashMap_GetExactIntegerMode(hash_map));
+
+	/* Neighbors above 2^53 collide if they are round-tripped through a double. */
+	if(sizeof(lua_Integer) >= 8)
+	{
+		for(i=0; i<60; i++)
+		{
+			big_key *= 2;
+		}
+	}
+	else
+	{
+		big_key = 1000;
+	}
+
+	LuaHashMap_SetValueIntegerForKeyInteger(hash_map, big_key + 1, big_key);
+	LuaHashMap_SetValueIntegerForKeyInteger(hash_map, big_key + 2, big_key + 1);
+	LuaHashMap_SetValueIntegerForKeyInteger(hash_map, 7, 3);
+	assert(3 == LuaHashMap_Count(hash_map));
+	assert(big_key + 1 == LuaHashMap_GetValueIntegerForKeyInteger(hash_map, big_key));
+	assert(big_key + 2 == LuaHashMap_GetValueIntegerForKeyInteger(hash_map, big_key + 1));
+	assert(7 == LuaHashMap_GetValueIntegerForKeyInteger(hash_map, 3));
+
+	/* The mode can't change once there are keys that depend on it. */
+#if LUA_VERSION_NUM < 503
+	assert(false == LuaHashMap_SetExactIntegerMode(hash_map, false));
+#endif
+
+	hash_iterator = LuaHashMap_GetIteratorAtBegin(hash_map);
+	do
+	{
+		lua_Integer the_key = LuaHashMap_GetKeyIntegerAtIterator(&hash_iterator);
+		assert(LUA_TNUMBER == LuaHashMap_GetKeyTypeAtIterator(&hash_iterator));
+		assert(the_key + 1 == LuaHashMap_GetCachedValueIntegerAtIterator(&hash_iterator) || 3 == the_key);
+		keys_seen++;
+	} while(LuaHashMap_IteratorNext(&hash_iterator));
+	assert(3 == keys_seen);
+
+	hash_iterator = LuaHashMap_GetIteratorForKeyInteger(hash_map, big_key + 1);
+	assert(big_key + 1 == LuaHashMap_GetKeyIntegerAtIterator(&hash_iterator));
+	assert(big_key + 2 == LuaHashMap_GetValueIntegerAtIterator(&hash_iterator));
+	LuaHashMap_RemoveAtIterator(&hash_iterator);
+	assert(2 == LuaHashMap_Count(hash_map));
+	assert(true == LuaHashMap_ExistsKeyInteger(hash_map, big_key));
+	assert(false == LuaHashMap_ExistsKeyInteger(hash_map, big_key + 1));
+
+	LuaHashMap_Free(hash_map);
+	fprintf(stderr, "TestExactIntegers done\n");
+}
+
+void TestIntegerKeysArrayPart()
+{
+	lua_Integer i;
+	LuaHashMapIterator hash_iterator;
+	LuaHashMap* hash_map = LuaHashMap_CreateWithSizeHints(1000, 0);
+
+	fprintf(stderr, "TestIntegerKeysArrayPart start\n");
+
+	/* Dense keys 1..1000 land in the array part. 0, negative, and far away keys land in the hash part. */
+	for(i=1; i<=1000; i++)
+	{
+		LuaHashMap_SetValueIntegerForKeyInteger(hash_map, i*2, i);
+	}
+	LuaHashMap_SetValueStringForKeyInteger(hash_map, "zero", 0);
+	LuaHashMap_SetValueStringForKeyInteger(hash_map, "negative", -5);
+	LuaHashMap_SetValueNumberForKeyInteger(hash_map, 1.5, 1000000);
+	assert(1003 == LuaHashMap_Count(hash_map));
+
+	/* Overwriting doesn't change the count */
+	LuaHashMap_SetValueIntegerForKeyInteger(hash_map, 42, 500);
+	assert(1003 == LuaHashMap_Count(hash_map));
+	assert(42 == LuaHashMap_GetValueIntegerForKeyInteger(hash_map, 500));
+	assert(0 == Internal_safestrcmp("zero", LuaHashMap_GetValueStringForKeyInteger(hash_map, 0)));
+	assert(0 == Internal_safestrcmp("negative", LuaHashMap_GetValueStringForKeyInteger(hash_map, -5)));
+	assert(1.5 == LuaHashMap_GetValueNumberForKeyInteger(hash_map, 1000000));
+	/* Integer keys and the equivalent number keys are the same key */
+	assert(42 == LuaHashMap_GetValueIntegerForKeyNumber(hash_map, 500.0));
+
+	assert(true == LuaHashMap_ExistsKeyInteger(hash_map, 1000));
+	assert(false == LuaHashMap_ExistsKeyInteger(hash_map, 1001));
+	LuaHashMap_RemoveKeyInteger(hash_map, 1000);
+	LuaHashMap_RemoveKeyInteger(hash_map, 1001);
+	LuaHashMap_RemoveKeyInteger(hash_map, -5);
+	assert(1001 == LuaHashMap_Count(hash_map));
+	assert(false == LuaHashMap_ExistsKeyInteger(hash_map, 1000));
+
+	hash_iterator = LuaHashMap_GetIteratorForKeyInteger(hash_map, -5);
+	assert(true == LuaHashMap_IteratorIsNotFound(&hash_iterator));
+	hash_iterator = LuaHashMap_GetIteratorForKeyInteger(hash_map, 999);
+	assert(999 == LuaHashMap_GetKeyIntegerAtIterator(&hash_iterator));
+	assert(999*2 == LuaHashMap_GetCachedValueIntegerAtIterator(&hash_iterator));
+
+	LuaHashMap_Free(hash_map);
+	fprintf(stderr, "TestIntegerKeysArrayPart done\n");
+}
+
+void TestTryGetValue()
+{
+	lua_Integer ret_integer = 99;
+	void* ret_pointer = &ret_integer;
+	const char* ret_string = NULL;
+	size_t ret_string_length = 0;
+	lua_Number ret_number = 99.0;
+	int value_type = LUA_TNIL;
+	LuaHashMap* hash_map = LuaHashMap_Create();
+
+	fprintf(stderr, "TestTryGetValue start\n");
+
+	/* 0 and NULL are legal stored values and must be distinguishable from a missing key */
+	LuaHashMap_SetValueIntegerForKeyString(hash_map, 0, "zero");
+	LuaHashMap_SetValuePointerForKeyInteger(hash_map, NULL, 5);
+	LuaHashMap_SetValueStringForKeyNumber(hash_map, "hello", 1.5);
+
+	assert(true == LuaHashMap_TryGetValueIntegerForKeyString(hash_map, "zero", &ret_integer, &value_type));
+	assert(0 == ret_integer);
+	assert(LUA_TNUMBER == value_type);
+	assert(false == LuaHashMap_TryGetValueIntegerForKeyString(hash_map, "one", &ret_integer, &value_type));
+	assert(LUA_TNONE == value_type);
+	assert(false == LuaHashMap_TryGetValueIntegerForKeyString(hash_map, NULL, &ret_integer, NULL));
+
+	assert(true == LuaHashMap_TryGetValuePointerForKeyInteger(hash_map, 5, &ret_pointer, &value_type));
+	assert(NULL == ret_pointer);
+	assert(LUA_TLIGHTUSERDATA == value_type);
+	assert(false == LuaHashMap_TryGetValuePointerForKeyInteger(hash_map, 6, &ret_pointer, NULL));
+
+	assert(true == LuaHashMap_TryGetValueStringForKeyNumberWithLength(hash_map, 1.5, &ret_string, &ret_string_length, &value_type));
+	assert(0 == Internal_safestrcmp("hello", ret_string));
+	assert(5 == ret_string_length);
+	assert(LUA_TSTRING == value_type);
+
+	/* Asking for the wrong type still reports found along with what is really there */
+	assert(true == LuaHashMap_TryGetValueNumberForKeyNumber(hash_map, 1.5, &ret_number, &value_type));
+	assert(LUA_TSTRING == value_type);
+	assert(true == LuaHashMap_TryGetValueNumberForKeyStringWithLength(hash_map, "zeroes", 4, NULL, &value_type));
+	assert(LUA_TNUMBER == value_type);
+
+	LuaHashMap_Free(hash_map);
+	fprintf(stderr, "TestTryGetValue done\n");
+}
+
+void TestIncrementGetOrSetTake()
+{
+	const char* ret_string;
+	lua_Integer ret_integer;
+	char key_buffer[8] = "counter";
+	LuaHashMap* hash_map = LuaHashMap_Create();
+
+	fprintf(stderr, "TestIncrementGetOrSetTake start\n");
+
+	/* A missing key starts at 0 */
+	assert(true == LuaHashMap_IncrementIntegerForKeyString(hash_map, "counter", 1, &ret_integer));
+	assert(1 == ret_integer);
+	assert(1 == LuaHashMap_Count(hash_map));
+	assert(true == LuaHashMap_IncrementIntegerForKeyStringWithLength(hash_map, key_buffer, 7, 10, &ret_integer));
+	assert(11 == ret_integer);
+	assert(true == LuaHashMap_IncrementIntegerForKeyString(hash_map, key_buffer, -2, NULL));
+	assert(9 == LuaHashMap_GetValueIntegerForKeyString(hash_map, "counter"));
+	assert(false == LuaHashMap_IncrementIntegerForKeyString(hash_map, NULL, 1, &ret_integer));
+	assert(true == LuaHashMap_IncrementIntegerForKeyInteger(hash_map, 1, 3, &ret_integer));
+	assert(3 == ret_integer);
+	assert(true == LuaHashMap_IncrementIntegerForKeyInteger(hash_map, 1, 3, &ret_integer));
+	assert(6 == ret_integer);
+	assert(true == LuaHashMap_IncrementIntegerForKeyPointer(hash_map, hash_map, -1, &ret_integer));
+	assert(-1 == ret_integer);
+	assert(3 == LuaHashMap_Count(hash_map));
+
+	/* Values that aren't integers are left alone */
+	LuaHashMap_SetValueStringForKeyString(hash_map, "12", "string");
+	ret_integer = 99;
+	assert(false == LuaHashMap_IncrementIntegerForKeyString(hash_map, "string", 1, &ret_integer));
+	assert(99 == ret_integer);
+	assert(0 == Internal_safestrcmp("12", LuaHashMap_GetValueStringForKeyString(hash_map, "string")));
+	LuaHashMap_SetValuePointerForKeyString(hash_map, key_buffer, "string");
+	assert(false == LuaHashMap_IncrementIntegerForKeyString(hash_map, "string", 1, NULL));
+	assert(key_buffer == LuaHashMap_GetValuePointerForKeyString(hash_map, "string"));
+	/* Every Lua version refuses to truncate a number with a fraction */
+	LuaHashMap_SetValueNumberForKeyString(hash_map, 2.5, "string");
+	assert(false == LuaHashMap_IncrementIntegerForKeyString(hash_map, "string", 1, NULL));
+	assert(2.5 == LuaHashMap_GetValueNumberForKeyString(hash_map, "string"));
+	LuaHashMap_SetValueNumberForKeyString(hash_map, -1e300, "string");
+	assert(false == LuaHashMap_IncrementIntegerForKeyString(hash_map, "string", 1, NULL));
+	/* A float with an exact integer value is fine */
+	LuaHashMap_SetValueNumberForKeyString(hash_map, 2.0, "string");
+	assert(true == LuaHashMap_IncrementIntegerForKeyString(hash_map, "string", 1, &ret_integer));
+	assert(3 == ret_integer);
+	LuaHashMap_RemoveKeyString(hash_map, "string");
+
+	/* Overflow fails instead of wrapping. (Exact integer mode so values near the limit survive before Lua 5.3.) */
+	{
+		const lua_Integer integer_max = (lua_Integer)((((lua_Integer)1 << (sizeof(lua_Integer)*CHAR_BIT - 2)) - 1) * 2 + 1);
+		LuaHashMap* exact_map = LuaHashMap_Create();
+		assert(true == LuaHashMap_SetExactIntegerMode(exact_map, true));
+		assert(true == LuaHashMap_IncrementIntegerForKeyInteger(exact_map, 5, integer_max - 1, NULL));
+		assert(true == LuaHashMap_IncrementIntegerForKeyInteger(exact_map, 5, 1, &ret_integer));
+		assert(integer_max == ret_integer);
+		assert(false == LuaHashMap_IncrementIntegerForKeyInteger(exact_map, 5, 1, NULL));
+		assert(integer_max == LuaHashMap_GetValueIntegerForKeyInteger(exact_map, 5));
+		assert(true == LuaHashMap_IncrementIntegerForKeyInteger(exact_map, 6, -integer_max, NULL));
+		assert(true == LuaHashMap_IncrementIntegerForKeyInteger(exact_map, 6, -1, &ret_integer));
+		assert(-integer_max - 1 == ret_integer);
+		assert(false == LuaHashMap_IncrementIntegerForKeyInteger(exact_map, 6, -1, NULL));
+		assert(-integer_max - 1 == LuaHashMap_GetValueIntegerForKeyInteger(exact_map, 6));
+		/* Integer keys outside what rawgeti/rawseti can take still work */
+		assert(true == LuaHashMap_IncrementIntegerForKeyInteger(exact_map, integer_max, 2, NULL));
+		assert(true == LuaHashMap_IncrementIntegerForKeyInteger(exact_map, integer_max, 2, &ret_integer));
+		assert(4 == ret_integer);
+		assert(3 == LuaHashMap_Count(exact_map));
+		LuaHashMap_Free(exact_map);
+	}
+
+	/* GetOrSet never overwrites */
+	assert(6 == LuaHashMap_GetOrSetValueIntegerForKeyInteger(hash_map, 100, 1));
+	assert(100 == LuaHashMap_GetOrSetValueIntegerForKeyInteger(hash_map, 100, 2));
+	assert(100 == LuaHashMap_GetOrSetValueIntegerForKeyInteger(hash_map, 200, 2));
+	assert(4 == LuaHashMap_Count(hash_map));
+	ret_string = LuaHashMap_GetOrSetValueStringForKeyNumber(hash_map, "first", 2.5);
+	assert(0 == Internal_safestrcmp("first", ret_string));
+	ret_string = LuaHashMap_GetOrSetValueStringForKeyNumber(hash_map, "second", 2.5);
+	assert(0 == Internal_safestrcmp("first", ret_string));
+	ret_string = LuaHashMap_GetOrSetValueStringForKeyStringWithLength(hash_map, "abcdef", "keykey", 3, 3);
+	assert(0 == Internal_safestrcmp("abc", ret_string));
+	assert(0 == Internal_safestrcmp("abc", LuaHashMap_GetValueStringForKeyString(hash_map, "key")));
+	assert(&key_buffer == LuaHashMap_GetOrSetValuePointerForKeyString(hash_map, &key_buffer, "pointer"));
+	assert(&key_buffer == LuaHashMap_GetOrSetValuePointerForKeyString(hash_map, NULL, "pointer"));
+	assert(1.25 == LuaHashMap_GetOrSetValueNumberForKeyPointer(hash_map, 1.25, key_buffer));
+	assert(8 == LuaHashMap_Count(hash_map));
+
+	/* Take removes and returns */
+	assert(100 == LuaHashMap_TakeValueIntegerForKeyInteger(hash_map, 2));
+	assert(false == LuaHashMap_ExistsKeyInteger(hash_map, 2));
+	assert(0 == LuaHashMap_TakeValueIntegerForKeyInteger(hash_map, 2));
+	assert(9 == LuaHashMap_TakeValueIntegerForKeyStringWithLength(hash_map, key_buffer, 7));
+	assert(&key_buffer == LuaHashMap_TakeValuePointerForKeyString(hash_map, "pointer"));
+	assert(1.25 == LuaHashMap_TakeValueNumberForKeyPointer(hash_map, key_buffer));
+	assert(NULL == LuaHashMap_TakeValuePointerForKeyString(hash_map, NULL));
+	assert(4 == LuaHashMap_Count(hash_map));
+
+	LuaHashMap_Free(hash_map);
+	fprintf(stderr, "TestIncrementGetOrSetTake done\n");
+}
+
+void TestCompareAndSet()
+{
+	int dummy1;
+	int dummy2;
+	LuaHashMap* hash_map = LuaHashMap_Create();
+
+	fprintf(stderr, "TestCompareAndSet start\n");
+
+	LuaHashMap_SetValueStringForKeyString(hash_map, "v1", "session");
+	LuaHashMap_SetValueIntegerForKeyInteger(hash_map, 10, 1);
+	LuaHashMap_SetValuePointerForKeyNumber(hash_map, &dummy1, 2.5);
+
+	assert(false == LuaHashMap_CompareAndSetValueStringForKeyString(hash_map, "v2", "v0", "session"));
+	assert(0 == Internal_safestrcmp("v1", LuaHashMap_GetValueStringForKeyString(hash_map, "session")));
+	assert(true == LuaHashMap_CompareAndSetValueStringForKeyString(hash_map, "v2", "v1", "session"));
+	assert(0 == Internal_safestrcmp("v2", LuaHashMap_GetValueStringForKeyString(hash_map, "session")));
+	assert(true == LuaHashMap_CompareAndSetValueStringForKeyStringWithLength(hash_map, "v3xx", "v2xx", "sessionxx", 2, 2, 7));
+	assert(0 == Internal_safestrcmp("v3", LuaHashMap_GetValueStringForKeyString(hash_map, "session")));
+	assert(false == LuaHashMap_CompareAndSetValueStringForKeyString(hash_map, "v2", "v1", NULL));
+
+	/* A missing key never matches and is never added */
+	assert(false == LuaHashMap_CompareAndSetValueIntegerForKeyInteger(hash_map, 5, 0, 7));
+	assert(false == LuaHashMap_ExistsKeyInteger(hash_map, 7));
+	assert(true == LuaHashMap_CompareAndSetValueIntegerForKeyInteger(hash_map, 11, 10, 1));
+	assert(11 == LuaHashMap_GetValueIntegerForKeyInteger(hash_map, 1));
+	/* A value of a different type never matches */
+	assert(false == LuaHashMap_CompareAndSetValueStringForKeyInteger(hash_map, "x", "11", 1));
+	assert(true == LuaHashMap_CompareAndSetValuePointerForKeyNumber(hash_map, &dummy2, &dummy1, 2.5));
+	assert(&dummy2 == LuaHashMap_GetValuePointerForKeyNumber(hash_map, 2.5));
+	assert(3 == LuaHashMap_Count(hash_map));
+
+	assert(false == LuaHashMap_RemoveKeyPointerIfValueInteger(hash_map, &dummy1, 0));
+	assert(false == LuaHashMap_RemoveKeyIntegerIfValueInteger(hash_map, 1, 10));
+	assert(true == LuaHashMap_RemoveKeyIntegerIfValueInteger(hash_map, 1, 11));
+	assert(false == LuaHashMap_ExistsKeyInteger(hash_map, 1));
+	assert(true == LuaHashMap_RemoveKeyNumberIfValuePointer(hash_map, 2.5, &dummy2));
+	assert(false == LuaHashMap_RemoveKeyStringIfValueString(hash_map, "session", "v2"));
+	assert(true == LuaHashMap_RemoveKeyStringIfValueStringWithLength(hash_map, "sessions", "v3", 7, 2));
+	assert(0 == LuaHashMap_Count(hash_map));
+	assert(true == LuaHashMap_IsEmpty(hash_map));
+
+	/* Integer keys too big for rawgeti/rawseti (before Lua 5.3) take the pushed key path */
+	{
+		lua_Integer big_key = (sizeof(lua_Integer) >= 8) ? ((lua_Integer)1 << 40) : (lua_Integer)INT_MAX;
+		LuaHashMap_SetValueIntegerForKeyInteger(hash_map, 3, big_key);
+		assert(false == LuaHashMap_CompareAndSetValueIntegerForKeyInteger(hash_map, 4, 2, big_key));
+		assert(true == LuaHashMap_CompareAndSetValueIntegerForKeyInteger(hash_map, 4, 3, big_key));
+		assert(4 == LuaHashMap_GetValueIntegerForKeyInteger(hash_map, big_key));
+		assert(false == LuaHashMap_RemoveKeyIntegerIfValueInteger(hash_map, big_key, 3));
+		assert(true == LuaHashMap_RemoveKeyIntegerIfValueInteger(hash_map, big_key, 4));
+		assert(true == LuaHashMap_IsEmpty(hash_map));
+	}
+
+	LuaHashMap_Free(hash_map);
+	fprintf(stderr, "TestCompareAndSet done\n");
+}
+
+struct TestForEachData
+{
+	size_t numberOfCalls;
+	lua_Integer sumOfValues;
+	size_t lengthOfKeys;
+	size_t stopAfter;
+};
+
+static int TestForEachCallback(const LuaHashMapIterator* hash_iterator, void* user_data)
+{
+	struct TestForEachData* for_each_data = (struct TestForEachData*)user_data;
+	assert(LUA_TSTRING == LuaHashMap_GetKeyTypeAtIterator(hash_iterator));
+	assert(LUA_TNUMBER == LuaHashMap_GetCachedValueTypeAtIterator(hash_iterator));
+	for_each_data->numberOfCalls++;
+	for_each_data->sumOfValues += LuaHashMap_GetCachedValueIntegerAtIterator(hash_iterator);
+	for_each_data->lengthOfKeys += strlen(LuaHashMap_GetKeyStringAtIterator(hash_iterator));
+	if(for_each_data->numberOfCalls == for_each_data->stopAfter)
+	{
+		return 42;
+	}
+	return 0;
+}
+
+void TestForEach()
+{
+	struct TestForEachData for_each_data = { 0, 0, 0, 0 };
+	LuaHashMap* hash_map = LuaHashMap_Create();
+
+	fprintf(stderr, "TestForEach start\n");
+
+	assert(0 == LuaHashMap_ForEach(hash_map, TestForEachCallback, &for_each_data));
+	assert(0 == for_each_data.numberOfCalls);
+
+	LuaHashMap_SetValueIntegerForKeyString(hash_map, 1, "a");
+	LuaHashMap_SetValueIntegerForKeyString(hash_map, 20, "bb");
+	LuaHashMap_SetValueIntegerForKeyString(hash_map, 300, "ccc");
+	LuaHashMap_SetValueIntegerForKeyString(hash_map, 4000, "dddd");
+
+	assert(0 == LuaHashMap_ForEach(hash_map, TestForEachCallback, &for_each_data));
+	assert(4 == for_each_data.numberOfCalls);
+	assert(4321 == for_each_data.sumOfValues);
+	assert(10 == for_each_data.lengthOfKeys);
+
+	/* Early exit returns the callback's value */
+	memset(&for_each_data, 0, sizeof(for_each_data));
+	for_each_data.stopAfter = 2;
+	assert(42 == LuaHashMap_ForEach(hash_map, TestForEachCallback, &for_each_data));
+	assert(2 == for_each_data.numberOfCalls);
+
+	assert(0 == LuaHashMap_ForEach(hash_map, NULL, NULL));
+	assert(0 == LuaHashMap_ForEach(NULL, TestForEachCallback, &for_each_data));
+
+	LuaHashMap_Free(hash_map);
+	fprintf(stderr, "TestForEach done\n");
+}
+
+static int TestRemoveIfPredicate(const LuaHashMapIterator* hash_iterator, void* user_data)
+{
+	lua_Integer threshold = *(lua_Integer*)user_data;
+	return LuaHashMap_GetCachedValueIntegerAtIterator(hash_iterator) < threshold;
+}
+
+void TestRemoveIf()
+{
+	lua_Integer threshold = 50;
+	lua_Integer i;
+	LuaHashMap* hash_map = LuaHashMap_Create();
+
+	fprintf(stderr, "TestRemoveIf start\n");
+
+	assert(0 == LuaHashMap_RemoveIf(hash_map, TestRemoveIfPredicate, &threshold));
+	for(i=0; i<100; i++)
+	{
+		LuaHashMap_SetValueIntegerForKeyInteger(hash_map, i, i);
+		LuaHashMap_SetValueIntegerForKeyNumber(hash_map, i, (lua_Number)i + 0.5);
+	}
+	assert(200 == LuaHashMap_Count(hash_map));
+
+	assert(100 == LuaHashMap_RemoveIf(hash_map, TestRemoveIfPredicate, &threshold));
+	assert(100 == LuaHashMap_Count(hash_map));
+	assert(false == LuaHashMap_ExistsKeyInteger(hash_map, 49));
+	assert(false == LuaHashMap_ExistsKeyNumber(hash_map, 49.5));
+	assert(true == LuaHashMap_ExistsKeyInteger(hash_map, 50));
+	assert(true == LuaHashMap_ExistsKeyNumber(hash_map, 99.5));
+	assert(0 == LuaHashMap_RemoveIf(hash_map, TestRemoveIfPredicate, &threshold));
+
+	threshold = 1000;
+	assert(100 == LuaHashMap_RemoveIf(hash_map, TestRemoveIfPredicate, &threshold));
+	assert(true == LuaHashMap_IsEmpty(hash_map));
+	assert(0 == LuaHashMap_RemoveIf(hash_map, NULL, NULL));
+
+	LuaHashMap_Free(hash_map);
+	fprintf(stderr, "TestRemoveIf done\n");
+}
+
+static lua_Number TestTransformValuesDecay(lua_Number value_number, void* user_data)
+{
+	return value_number * *(lua_Number*)user_data;
+}
+
+static lua_Integer TestTransformValuesDouble(lua_Integer value_integer, void* user_data)
+{
+	(void)user_data;
+	return value_integer * 2;
+}
+
+static int TestTransformValuesCallback(LuaHashMapIterator* hash_iterator, void* user_data)
+{
+	(void)user_data;
+	if(LUA_TSTRING != LuaHashMap_GetCachedValueTypeAtIterator(hash_iterator))
+	{
+		return 0;
+	}
+	if(0 == Internal_safestrcmp("drop", LuaHashMap_GetCachedValueStringAtIterator(hash_iterator)))
+	{
+		hash_iterator->valueType = LUA_TNIL;
+	}
+	else
+	{
+		lua_Integer string_length = (lua_Integer)LuaHashMap_GetCachedValueStringLengthAtIterator(hash_iterator);
+		hash_iterator->valueType = LUA_TNUMBER;
+		hash_iterator->isValueInteger = true;
+		hash_iterator->currentValue.theInteger = string_length;
+	}
+	return 1;
+}
+
+void TestTransformValues()
+{
+	lua_Number decay = 0.5;
+	int dummy;
+	LuaHashMap* hash_map = LuaHashMap_Create();
+
+	fprintf(stderr, "TestTransformValues start\n");
+
+	LuaHashMap_SetValueNumberForKeyString(hash_map, 10.0, "a");
+	LuaHashMap_SetValueIntegerForKeyString(hash_map, 7, "b");
+	LuaHashMap_SetValuePointerForKeyString(hash_map, &dummy, "c");
+	LuaHashMap_SetValueStringForKeyString(hash_map, "hello", "d");
+	LuaHashMap_SetValueStringForKeyString(hash_map, "drop", "e");
+
+	assert(2 == LuaHashMap_TransformValuesNumber(hash_map, TestTransformValuesDecay, &decay));
+	assert(5.0 == LuaHashMap_GetValueNumberForKeyString(hash_map, "a"));
+	assert(3.5 == LuaHashMap_GetValueNumberForKeyString(hash_map, "b"));
+	assert(&dummy == LuaHashMap_GetValuePointerForKeyString(hash_map, "c"));
+
+	LuaHashMap_SetValueNumberForKeyString(hash_map, 2.5, "f");
+#if LUA_VERSION_NUM >= 503
+	/* Floats with no exact integer value (3.5 and 2.5) are skipped, not read as 0 */
+	assert(1 == LuaHashMap_TransformValuesInteger(hash_map, TestTransformValuesDouble, NULL));
+	assert(3.5 == LuaHashMap_GetValueNumberForKeyString(hash_map, "b"));
+	assert(2.5 == LuaHashMap_GetValueNumberForKeyString(hash_map, "f"));
+#else
+	assert(3 == LuaHashMap_TransformValuesInteger(hash_map, TestTransformValuesDouble, NULL));
+	assert(4 == LuaHashMap_GetValueIntegerForKeyString(hash_map, "f"));
+#endif
+	assert(10 == LuaHashMap_GetValueIntegerForKeyString(hash_map, "a"));
+	LuaHashMap_RemoveKeyString(hash_map, "f");
+
+	/* Strings become their length and "drop" is removed */
+	assert(2 == LuaHashMap_TransformValues(hash_map, TestTransformValuesCallback, NULL));
+	assert(5 == LuaHashMap_GetValueIntegerForKeyString(hash_map, "d"));
+	assert(false == LuaHashMap_ExistsKeyString(hash_map, "e"));
+	assert(4 == LuaHashMap_Count(hash_map));
+	assert(0 == LuaHashMap_TransformValues(hash_map, TestTransformValuesCallback, NULL));
+
+	LuaHashMap_Free(hash_map);
+	fprintf(stderr, "TestTransformValues done\n");
+}
+
+void TestAggregateNumbers()
+{
+	LuaHashMapAggregateStats the_stats;
+	LuaHashMap* hash_map = LuaHashMap_Create();
+
+	fprintf(stderr, "TestAggregateNumbers start\n");
+
+	LuaHashMap_AggregateNumbers(hash_map, &the_stats);
+	assert(0 == the_stats.values.count);
+	assert(0.0 == the_stats.values.mean);
+
+	LuaHashMap_SetValueNumberForKeyString(hash_map, 1.5, "a");
+	LuaHashMap_SetValueIntegerForKeyInteger(hash_map, -4, 10);
+	LuaHashMap_SetValueNumberForKeyNumber(hash_map, 8.5, 20.0);
+	LuaHashMap_SetValueStringForKeyInteger(hash_map, "not a number", 30);
+	LuaHashMap_SetValuePointerForKeyString(hash_map, hash_map, "b");
+
+	LuaHashMap_AggregateNumbers(hash_map, &the_stats);
+	assert(3 == the_stats.values.count);
+	assert(6.0 == the_stats.values.sum);
+	assert(-4.0 == the_stats.values.min);
+	assert(8.5 == the_stats.values.max);
+	assert(2.0 == the_stats.values.mean);
+	assert(3 == the_stats.keys.count);
+	assert(60.0 == the_stats.keys.sum);
+	assert(10.0 == the_stats.keys.min);
+	assert(30.0 == the_stats.keys.max);
+	assert(20.0 == the_stats.keys.mean);
+
+	LuaHashMap_Free(hash_map);
+	fprintf(stderr, "TestAggregateNumbers done\n");
+}
+
+void TestEval()
+{
+	static const char* count_above_chunk = "local map, threshold = ... local n = 0 for k, v in pairs(map) do if v > threshold then n = n + 1 end end return n";
+	static const char* scale_and_drop_chunk = "local map, factor = ... for k, v in pairs(map) do if v < 2 then map[k] = nil else map[k] = v * factor end end";
+	LuaHashMapValue the_argument;
+	LuaHashMapValue the_result;
+	LuaHashMapValue shared_result;
+	LuaHashMap* hash_map = LuaHashMap_Create();
+	LuaHashMap* shared_hash_map;
+	lua_State* lua_state = LuaHashMap_GetLuaState(hash_map);
+
+	fprintf(stderr, "TestEval start\n");
+
+	LuaHashMap_SetValueIntegerForKeyString(hash_map, 1, "a");
+	LuaHashMap_SetValueIntegerForKeyString(hash_map, 2, "b");
+	LuaHashMap_SetValueIntegerForKeyString(hash_map, 3, "c");
+
+	memset(&the_argument, 0, sizeof(the_argument));
+	the_argument.valueType = LUA_TNUMBER;
+	the_argument.theValue.theNumber = 1.5;
+	assert(true == LuaHashMap_Eval(hash_map, count_above_chunk, strlen(count_above_chunk), &the_argument, 1, &the_result));
+	assert(LUA_TNUMBER == the_result.valueType);
+	assert(2 == (the_result.isInteger ? the_result.theValue.theInteger : (lua_Integer)the_result.theValue.theNumber));
+	/* The second run uses the cached chunk */
+	the_argument.theValue.theNumber = 2.5;
+	assert(true == LuaHashMap_Eval(hash_map, count_above_chunk, strlen(count_above_chunk), &the_argument, 1, &the_result));
+	assert(1 == (the_result.isInteger ? the_result.theValue.theInteger : (lua_Integer)the_result.theValue.theNumber));
+
+	/* Bulk rewrite and remove inside the VM. The count must catch up. */
+	the_argument.isInteger = true;
+	the_argument.theValue.theInteger = 10;
+	assert(true == LuaHashMap_Eval(hash_map, scale_and_drop_chunk, strlen(scale_and_drop_chunk), &the_argument, 1, &the_result));
+	assert(LUA_TNIL == the_result.valueType);
+	assert(2 == LuaHashMap_Count(hash_map));
+	assert(false == LuaHashMap_ExistsKeyString(hash_map, "a"));
+	assert(30 == LuaHashMap_GetValueIntegerForKeyString(hash_map, "c"));
+	LuaHashMap_SetValueIntegerForKeyString(hash_map, 4, "d");
+	assert(3 == LuaHashMap_Count(hash_map));
+
+	/* Sets and removes made while the count is stale don't look up the old value, but the recount still catches them */
+	assert(true == LuaHashMap_Eval(hash_map, "return 1", 8, NULL, 0, NULL));
+	LuaHashMap_SetValueIntegerForKeyString(hash_map, 5, "e");
+	LuaHashMap_SetValueIntegerForKeyString(hash_map, 6, "e");
+	LuaHashMap_SetValueIntegerForKeyInteger(hash_map, 7, 1);
+	LuaHashMap_RemoveKeyString(hash_map, "d");
+	LuaHashMap_RemoveKeyString(hash_map, "not_there");
+	assert(4 == LuaHashMap_Count(hash_map));
+	LuaHashMap_RemoveKeyInteger(hash_map, 1);
+	assert(3 == LuaHashMap_Count(hash_map));
+
+	assert(true == LuaHashMap_Eval(hash_map, "return string.rep('ab', 2), 5", 29, NULL, 0, &the_result));
+	assert(LUA_TSTRING == the_result.valueType);
+	assert(0 == Internal_safestrcmp("abab", the_result.theValue.theString.stringPointer));
+	assert(true == LuaHashMap_Eval(hash_map, "return next(...) ~= nil", 23, NULL, 0, &the_result));
+	assert(LUA_TBOOLEAN == the_result.valueType);
+	assert(1 == the_result.theValue.theInteger);
+
+	/* Errors report the message as the result */
+	assert(false == LuaHashMap_Eval(hash_map, "return +", 8, NULL, 0, &the_result));
+	assert(LUA_TSTRING == the_result.valueType);
+	assert(false == LuaHashMap_Eval(hash_map, "error('boom')", 13, NULL, 0, &the_result));
+	assert(NULL != strstr(the_result.theValue.theString.stringPointer, "boom"));
+	assert(false == LuaHashMap_Eval(hash_map, NULL, 0, NULL, 0, NULL));
+	/* Precompiled bytecode is refused */
+	assert(false == LuaHashMap_Eval(hash_map, "\033Lua", 4, NULL, 0, &the_result));
+	assert(LUA_TSTRING == the_result.valueType);
+	assert(NULL != strstr(the_result.theValue.theString.stringPointer, "binary chunk"));
+
+	LuaHashMap_ClearEvalCache(hash_map);
+	assert(true == LuaHashMap_Eval(hash_map, count_above_chunk, strlen(count_above_chunk), &the_argument, 1, NULL));
+	assert(3 == LuaHashMap_Count(hash_map));
+
+	/* Chunks run in their own environment. The lua_State's globals are left alone, even by a chunk that assigns one. */
+	lua_pushinteger(lua_state, 42);
+	lua_setglobal(lua_state, "user_global");
+	assert(true == LuaHashMap_Eval(hash_map, "eval_global = 7 return user_global == nil and print == nil and dofile == nil", 76, NULL, 0, &the_result));
+	assert(LUA_TBOOLEAN == the_result.valueType);
+	assert(1 == the_result.theValue.theInteger);
+	lua_getglobal(lua_state, "eval_global");
+	assert(lua_isnil(lua_state, -1));
+	lua_getglobal(lua_state, "pairs");
+	assert(lua_isnil(lua_state, -1));
+	lua_getglobal(lua_state, "user_global");
+	assert(42 == lua_tointeger(lua_state, -1));
+	lua_pop(lua_state, 3);
+	assert(true == LuaHashMap_Eval(hash_map, "return eval_global", 18, NULL, 0, &the_result));
+	assert(7 == (the_result.isInteger ? the_result.theValue.theInteger : (lua_Integer)the_result.theValue.theNumber));
+
+	/* Each hash map keeps its own result, so an Eval on a share doesn't invalidate ours. */
+	shared_hash_map = LuaHashMap_CreateShare(hash_map);
+	assert(true == LuaHashMap_Eval(hash_map, "return string.rep('x', 3)", 25, NULL, 0, &the_result));
+	assert(true == LuaHashMap_Eval(shared_hash_map, "return string.rep('y', 3)", 25, NULL, 0, &shared_result));
+	lua_gc(lua_state, LUA_GCCOLLECT, 0);
+	assert(0 == Internal_safestrcmp("xxx", the_result.theValue.theString.stringPointer));
+	assert(0 == Internal_safestrcmp("yyy", shared_result.theValue.theString.stringPointer));
+	LuaHashMap_FreeShare(shared_hash_map);
+	assert(0 == lua_gettop(lua_state));
+
+	LuaHashMap_Free(hash_map);
+	fprintf(stderr, "TestEval done\n");
+}
+
+static lua_Integer TestIteratorNextBatch_ToInteger(const LuaHashMapValue* the_value)
+{
+	return the_value->isInteger ? the_value->theValue.theInteger : (lua_Integer)the_value->theValue.theNumber;
+}
+
+void TestIteratorNextBatch()
+{
+	LuaHashMapValue keys_array[7];
+	LuaHashMapValue values_array[7];
+	LuaHashMapIterator hash_iterator;
+	size_t number_of_elements;
+	size_t total_elements = 0;
+	lua_Integer sum_of_keys = 0;
+	lua_Integer i;
+	size_t j;
+	LuaHashMap* hash_map = LuaHashMap_Create();
+
+	fprintf(stderr, "TestIteratorNextBatch start\n");
+
+	for(i=1; i<=100; i++)
+	{
+		LuaHashMap_SetValueIntegerForKeyInteger(hash_map, i*2, i);
+	}
+
+	hash_iterator = LuaHashMap_GetIteratorAtBegin(hash_map);
+	while((number_of_elements = LuaHashMap_IteratorNextBatch(&hash_iterator, keys_array, values_array, 7)) > 0)
+	{
+		assert(number_of_elements <= 7);
+		for(j=0; j<number_of_elements; j++)
+		{
+			assert(LUA_TNUMBER == keys_array[j].valueType);
+			assert(LUA_TNUMBER == values_array[j].valueType);
+			assert(TestIteratorNextBatch_ToInteger(&values_array[j]) == TestIteratorNextBatch_ToInteger(&keys_array[j]) * 2);
+			sum_of_keys += TestIteratorNextBatch_ToInteger(&keys_array[j]);
+		}
+		total_elements += number_of_elements;
+	}
+	assert(100 == total_elements);
+	assert(5050 == sum_of_keys);
+	assert(0 == LuaHashMap_IteratorNextBatch(&hash_iterator, keys_array, values_array, 7));
+
+	/* A batch leaves the iterator on the next entry so it mixes with the single step API. Keys only this time. */
+	hash_iterator = LuaHashMap_GetIteratorAtBegin(hash_map);
+	assert(3 == LuaHashMap_IteratorNextBatch(&hash_iterator, keys_array, NULL, 3));
+	for(j=0; j<3; j++)
+	{
+		assert(TestIteratorNextBatch_ToInteger(&keys_array[j]) != LuaHashMap_GetKeyIntegerAtIterator(&hash_iterator));
+	}
+	assert(LuaHashMap_GetKeyIntegerAtIterator(&hash_iterator) * 2 == LuaHashMap_GetValueIntegerAtIterator(&hash_iterator));
+	/* Removing the current entry moves the iterator to the next one, and the batch starts there. */
+	i = LuaHashMap_GetKeyIntegerAtIterator(&hash_iterator);
+	LuaHashMap_RemoveAtIterator(&hash_iterator);
+	total_elements = 0;
+	while((number_of_elements = LuaHashMap_IteratorNextBatch(&hash_iterator, keys_array, NULL, 7)) > 0)
+	{
+		for(j=0; j<number_of_elements; j++)
+		{
+			assert(i != TestIteratorNextBatch_ToInteger(&keys_array[j]));
+		}
+		total_elements += number_of_elements;
+	}
+	assert(96 == total_elements);
+	assert(99 == LuaHashMap_Count(hash_map));
+
+	LuaHashMap_Clear(hash_map);
+	hash_iterator = LuaHashMap_GetIteratorAtBegin(hash_map);
+	assert(0 == LuaHashMap_IteratorNextBatch(&hash_iterator, keys_array, values_array, 7));
+
+	LuaHashMap_Free(hash_map);
+	fprintf(stderr, "TestIteratorNextBatch done\n");
+}
+
+void TestCursor()
+{
+	LuaHashMap* hash_map = LuaHashMap_Create();
+	LuaHashMap* shared_hash_map = LuaHashMap_CreateShare(hash_map);
+	LuaHashMapCursor* outer_cursor;
+	LuaHashMapCursor* inner_cursor;
+	LuaHashMapCursor* shared_cursor;
+	const LuaHashMapIterator* hash_iterator;
+	size_t number_of_pairs = 0;
+	size_t number_of_steps = 0;
+	lua_Integer i;
+
+	fprintf(stderr, "TestCursor start\n");
+
+	for(i=0; i<10; i++)
+	{
+		LuaHashMap_SetValueIntegerForKeyInteger(hash_map, i*i, i);
+	}
+	LuaHashMap_SetValueStringForKeyString(shared_hash_map, "1", "one");
+	LuaHashMap_SetValueStringForKeyString(shared_hash_map, "2", "two");
+
+	/* Nested cursors over the same map and a cursor over a map in the same share group don't disturb each other. */
+	outer_cursor = LuaHashMap_CreateCursor(hash_map);
+	inner_cursor = LuaHashMap_CreateCursor(hash_map);
+	shared_cursor = LuaHashMap_CreateCursor(shared_hash_map);
+	assert(LUA_TNONE == LuaHashMap_GetKeyTypeAtIterator(LuaHashMap_GetIteratorAtCursor(outer_cursor)));
+	while(LuaHashMap_CursorNext(outer_cursor))
+	{
+		hash_iterator = LuaHashMap_GetIteratorAtCursor(outer_cursor);
+		i = LuaHashMap_GetKeyIntegerAtIterator(hash_iterator);
+		assert(i*i == LuaHashMap_GetCachedValueIntegerAtIterator(hash_iterator));
+
+		LuaHashMap_CursorReset(inner_cursor);
+		while(LuaHashMap_CursorNext(inner_cursor))
+		{
+			number_of_pairs++;
+			/* Regular API calls in between steps are fine too. */
+			assert(true == LuaHashMap_ExistsKeyInteger(hash_map, LuaHashMap_GetKeyIntegerAtIterator(LuaHashMap_GetIteratorAtCursor(inner_cursor))));
+		}
+		if(LuaHashMap_CursorNext(shared_cursor))
+		{
+			assert(LUA_TSTRING == LuaHashMap_GetKeyTypeAtIterator(LuaHashMap_GetIteratorAtCursor(shared_cursor)));
+			assert(3 == LuaHashMap_GetKeyStringLengthAtIterator(LuaHashMap_GetIteratorAtCursor(shared_cursor)));
+		}
+		assert(i == LuaHashMap_GetKeyIntegerAtIterator(LuaHashMap_GetIteratorAtCursor(outer_cursor)));
+	}
+	assert(100 == number_of_pairs);
+	assert(false == LuaHashMap_CursorNext(outer_cursor));
+	assert(false == LuaHashMap_CursorNext(shared_cursor));
+
+	/* Removing the current entry while walking is allowed, just like with lua_next. */
+	LuaHashMap_CursorReset(outer_cursor);
+	while(LuaHashMap_CursorNext(outer_cursor))
+	{
+		i = LuaHashMap_GetKeyIntegerAtIterator(LuaHashMap_GetIteratorAtCursor(outer_cursor));
+		if(0 == i % 2)
+		{
+			LuaHashMap_RemoveKeyInteger(hash_map, i);
+		}
+		number_of_steps++;
+	}
+	assert(10 == number_of_steps);
+	assert(5 == LuaHashMap_Count(hash_map));
+
+	/* Purge swaps in a new table. Reset picks it up. */
+	LuaHashMap_Purge(hash_map);
+	LuaHashMap_SetValueIntegerForKeyInteger(hash_map, 42, 7);
+	LuaHashMap_CursorReset(outer_cursor);
+	assert(true == LuaHashMap_CursorNext(outer_cursor));
+	assert(7 == LuaHashMap_GetKeyIntegerAtIterator(LuaHashMap_GetIteratorAtCursor(outer_cursor)));
+	assert(false == LuaHashMap_CursorNext(outer_cursor));
+
+	LuaHashMap_FreeCursor(shared_cursor);
+	LuaHashMap_FreeCursor(inner_cursor);
+	LuaHashMap_FreeCursor(outer_cursor);
+	LuaHashMap_FreeCursor(NULL);
+	LuaHashMap_FreeShare(shared_hash_map);
+	LuaHashMap_Free(hash_map);
+	fprintf(stderr, "TestCursor done\n");
+}
+
+void TestScan()
+{
+	LuaHashMapValue keys_array[100];
+	unsigned char* visit_counts = (unsigned char*)calloc(3000, sizeof(unsigned char));
+	LuaHashMapScan* hash_scan;
+	size_t number_of_elements;
+	size_t number_of_ticks = 0;
+	lua_Integer the_key;
+	lua_Integer i;
+	size_t j;
+	LuaHashMap* hash_map = LuaHashMap_Create();
+
+	fprintf(stderr, "TestScan start\n");
+
+	for(i=0; i<2000; i++)
+	{
+		LuaHashMap_SetValueIntegerForKeyInteger(hash_map, i, i);
+	}
+
+	/* Without inserts, every key comes back exactly once. */
+	hash_scan = LuaHashMap_CreateScan(hash_map);
+	while((number_of_elements = LuaHashMap_ScanNext(hash_scan, keys_array, NULL, 100)) > 0)
+	{
+		for(j=0; j<number_of_elements; j++)
+		{
+			visit_counts[TestIteratorNextBatch_ToInteger(&keys_array[j])]++;
+		}
+		/* Overwriting values in between slices keeps the fast path. */
+		LuaHashMap_SetValueIntegerForKeyInteger(hash_map, -1, TestIteratorNextBatch_ToInteger(&keys_array[0]));
+	}
+	assert(0 == LuaHashMap_ScanNext(hash_scan, keys_array, NULL, 100));
+	LuaHashMap_FreeScan(hash_scan);
+	for(i=0; i<2000; i++)
+	{
+		assert(1 == visit_counts[i]);
+	}
+
+	/* Keys below 1000 stay for the whole scan. Keys 1000-1999 get removed and keys 2000+ get added while scanning. */
+	memset(visit_counts, 0, 3000);
+	hash_scan = LuaHashMap_CreateScan(hash_map);
+	while((number_of_elements = LuaHashMap_ScanNext(hash_scan, keys_array, NULL, 100)) > 0)
+	{
+		for(j=0; j<number_of_elements; j++)
+		{
+			the_key = TestIteratorNextBatch_ToInteger(&keys_array[j]);
+			assert(the_key >= 0 && the_key < 3000);
+			visit_counts[the_key]++;
+		}
+		for(i=0; i<50; i++)
+		{
+			the_key = 1000 + (lua_Integer)number_of_ticks*50 + i;
+			if(the_key < 2000)
+			{
+				LuaHashMap_RemoveKeyInteger(hash_map, the_key);
+			}
+			LuaHashMap_SetValueIntegerForKeyInteger(hash_map, the_key, 2000 + (lua_Integer)number_of_ticks*50 + i);
+		}
+		/* Replacing the table entirely is covered too. */
+		if(3 == number_of_ticks)
+		{
+			LuaHashMap_Compact(hash_map, false);
+		}
+		number_of_ticks++;
+	}
+	LuaHashMap_FreeScan(hash_scan);
+	for(i=0; i<1000; i++)
+	{
+		assert(visit_counts[i] >= 1);
+	}
+
+	LuaHashMap_FreeScan(NULL);
+	LuaHashMap_Free(hash_map);
+	free(visit_counts);
+	fprintf(stderr, "TestScan done\n");
+}
+
+static int TestSharded_SumValues(const LuaHashMapIterator* hash_iterator, void* user_data)
+{
+	*(lua_Integer*)user_data += LuaHashMap_GetCachedValueIntegerAtIterator(hash_iterator);
+	return 0;
+}
+
+#if !defined(_WIN32) && !defined(WIN32)
+#define TEST_SHARDED_NUMBER_OF_THREADS 8
+#define TEST_SHARDED_KEYS_PER_THREAD 2000
+
+struct TestShardedThreadData
+{
+	LuaHashMapSharded* shardedHashMap;
+	lua_Integer firstKey;
+};
+
+static void* TestSharded_ThreadFunction(void* user_data)
+{
+	struct TestShardedThreadData* thread_data = (struct TestShardedThreadData*)user_data;
+	lua_Integer i;
+	char key_buffer[32];
+	for(i=thread_data->firstKey; i<thread_data->firstKey+TEST_SHARDED_KEYS_PER_THREAD; i++)
+	{
+		LuaHashMapSharded_SetValueIntegerForKeyInteger(thread_data->shardedHashMap, i, i);
+		sprintf(key_buffer, "key%d", (int)i);
+		LuaHashMapSharded_SetValueIntegerForKeyString(thread_data->shardedHashMap, i, key_buffer);
+		assert(i == LuaHashMapSharded_GetValueIntegerForKeyInteger(thread_data->shardedHashMap, i));
+		if(0 == i % 2)
+		{
+			LuaHashMapSharded_RemoveKeyString(thread_data->shardedHashMap, key_buffer);
+		}
+	}
+	return NULL;
+}
+#endif
+
+void TestSharded()
+{
+	LuaHashMapSharded* sharded_hash_map = LuaHashMapSharded_Create(7);
+	lua_Integer sum_of_values = 0;
+	char value_buffer[8];
+	int dummy_object;
+
+	fprintf(stderr, "TestSharded start\n");
+
+	assert(NULL == LuaHashMapSharded_Create(0));
+	assert(7 == LuaHashMapSharded_GetNumberOfShards(sharded_hash_map));
+	assert(true == LuaHashMapSharded_IsEmpty(sharded_hash_map));
+
+	LuaHashMapSharded_SetValueStringForKeyString(sharded_hash_map, "red", "apple");
+	LuaHashMapSharded_SetValuePointerForKeyPointer(sharded_hash_map, &dummy_object, &dummy_object);
+	LuaHashMapSharded_SetValueNumberForKeyNumber(sharded_hash_map, 2.5, 1.5);
+	LuaHashMapSharded_SetValueIntegerForKeyInteger(sharded_hash_map, 10, 3);
+	assert(4 == LuaHashMapSharded_Count(sharded_hash_map));
+
+	assert(3 == LuaHashMapSharded_CopyValueStringForKeyStringWithLength(sharded_hash_map, "apple", value_buffer, sizeof(value_buffer), 5));
+	assert(0 == Internal_safestrcmp("red", value_buffer));
+	/* Too small a buffer gets what fits plus the full length */
+	assert(3 == LuaHashMapSharded_CopyValueStringForKeyString(sharded_hash_map, "apple", value_buffer, 3));
+	assert(0 == Internal_safestrcmp("re", value_buffer));
+	assert(3 == LuaHashMapSharded_CopyValueStringForKeyString(sharded_hash_map, "apple", NULL, 0));
+	assert(0 == LuaHashMapSharded_CopyValueStringForKeyString(sharded_hash_map, "banana", value_buffer, sizeof(value_buffer)));
+	assert(0 == Internal_safestrcmp("", value_buffer));
+	LuaHashMapSharded_SetValueStringForKeyInteger(sharded_hash_map, "green", 7);
+	assert(5 == LuaHashMapSharded_CopyValueStringForKeyNumber(sharded_hash_map, 7.0, value_buffer, sizeof(value_buffer)));
+	assert(0 == Internal_safestrcmp("green", value_buffer));
+	LuaHashMapSharded_RemoveKeyInteger(sharded_hash_map, 7);
+	assert(&dummy_object == LuaHashMapSharded_GetValuePointerForKeyPointer(sharded_hash_map, &dummy_object));
+	assert(2.5 == LuaHashMapSharded_GetValueNumberForKeyNumber(sharded_hash_map, 1.5));
+	/* 3.0 and 3 are the same key so they must land on the same shard */
+	assert(10 == LuaHashMapSharded_GetValueIntegerForKeyNumber(sharded_hash_map, 3.0));
+	assert(true == LuaHashMapSharded_ExistsKeyInteger(sharded_hash_map, 3));
+	assert(false == LuaHashMapSharded_ExistsKeyString(sharded_hash_map, "banana"));
+	assert(false == LuaHashMapSharded_ExistsKeyString(sharded_hash_map, NULL));
+
+	LuaHashMapSharded_RemoveKeyPointer(sharded_hash_map, &dummy_object);
+	LuaHashMapSharded_RemoveKeyNumber(sharded_hash_map, 1.5);
+	LuaHashMapSharded_RemoveKeyString(sharded_hash_map, "apple");
+	assert(1 == LuaHashMapSharded_Count(sharded_hash_map));
+	LuaHashMapSharded_Clear(sharded_hash_map);
+	assert(true == LuaHashMapSharded_IsEmpty(sharded_hash_map));
+	LuaHashMapSharded_Free(sharded_hash_map);
+
+#if !defined(_WIN32) && !defined(WIN32)
+	{
+		pthread_t threads_array[TEST_SHARDED_NUMBER_OF_THREADS];
+		struct TestShardedThreadData thread_data_array[TEST_SHARDED_NUMBER_OF_THREADS];
+		size_t i;
+		lua_Integer expected_sum = 0;
+
+		sharded_hash_map = LuaHashMapSharded_CreateWithSizeHints(16, TEST_SHARDED_NUMBER_OF_THREADS*TEST_SHARDED_KEYS_PER_THREAD*2);
+		for(i=0; i<TEST_SHARDED_NUMBER_OF_THREADS; i++)
+		{
+			thread_data_array[i].shardedHashMap = sharded_hash_map;
+			thread_data_array[i].firstKey = (lua_Integer)(i*TEST_SHARDED_KEYS_PER_THREAD);
+			pthread_create(&threads_array[i], NULL, TestSharded_ThreadFunction, &thread_data_array[i]);
+		}
+		for(i=0; i<TEST_SHARDED_NUMBER_OF_THREADS; i++)
+		{
+			pthread_join(threads_array[i], NULL);
+		}
+		/* Every integer key plus the odd string keys */
+		assert(TEST_SHARDED_NUMBER_OF_THREADS*TEST_SHARDED_KEYS_PER_THREAD*3/2 == LuaHashMapSharded_Count(sharded_hash_map));
+		assert(0 == LuaHashMapSharded_ForEach(sharded_hash_map, TestSharded_SumValues, &sum_of_values));
+		for(i=0; i<TEST_SHARDED_NUMBER_OF_THREADS*TEST_SHARDED_KEYS_PER_THREAD; i++)
+		{
+			expected_sum += (lua_Integer)i;
+			if(1 == i % 2)
+			{
+				expected_sum += (lua_Integer)i;
+			}
+		}
+		assert(expected_sum == sum_of_values);
+		LuaHashMapSharded_Free(sharded_hash_map);
+	}
+#endif
+
+	fprintf(stderr, "TestSharded done\n");
+}
+
+#if !defined(_WIN32) && !defined(WIN32)
+#define TEST_GROUP_LOCKING_NUMBER_OF_THREADS 6
+#define TEST_GROUP_LOCKING_KEYS_PER_THREAD 2000
+
+struct TestGroupLockingThreadData
+{
+	LuaHashMap* writerHashMap;
+	LuaHashMap* readerHashMap;
+	lua_Integer firstKey;
+};
+
+static void* TestGroupLocking_ThreadFunction(void* user_data)
+{
+	struct TestGroupLockingThreadData* thread_data = (struct TestGroupLockingThreadData*)user_data;
+	lua_Integer i;
+	char key_buffer[32];
+	for(i=thread_data->firstKey; i<thread_data->firstKey+TEST_GROUP_LOCKING_KEYS_PER_THREAD; i++)
+	{
+		/* Writes to one map of the group go through the exclusive lock */
+		LuaHashMap_SetValueIntegerForKeyInteger(thread_data->writerHashMap, i, i);
+		sprintf(key_buffer, "key%d", (int)i);
+		LuaHashMap_SetValueIntegerForKeyString(thread_data->writerHashMap, i, key_buffer);
+		assert(i == LuaHashMap_GetValueIntegerForKeyInteger(thread_data->writerHashMap, i));
+		/* Reads of the other map take the shared lock. The reader map never changes during the threaded part. */
+		assert((i % 100)*2 == LuaHashMap_GetValueIntegerForKeyInteger(thread_data->readerHashMap, i % 100));
+		assert(true == LuaHashMap_ExistsKeyInteger(thread_data->readerHashMap, i % 100));
+		if(0 == i % 2)
+		{
+			LuaHashMap_RemoveKeyString(thread_data->writerHashMap, key_buffer);
+		}
+	}
+	return NULL;
+}
+
+/* Only integer key lookups, all at once. Any miss means a reader disturbed the table for another. */
+static void* TestGroupLocking_ReaderThreadFunction(void* user_data)
+{
+	LuaHashMap* hash_map = (LuaHashMap*)user_data;
+	lua_Integer i;
+	int j;
+	for(j=0; j<20; j++)
+	{
+		for(i=1; i<=1000; i++)
+		{
+			assert(i*3 == LuaHashMap_GetValueIntegerForKeyInteger(hash_map, i));
+		}
+		assert(false == LuaHashMap_ExistsKeyInteger(hash_map, 1001));
+	}
+	return NULL;
+}
+#endif
+
+void TestGroupLocking()
+{
 	LuaHashMap* hash_map = LuaHashMap_Create();
-	/* Better to declare when you assign it, but you need C99 */
+	LuaHashMap* share_map;
+	LuaHashMapLockStatistics lock_statistics;
 	LuaHashMapIterator hash_iterator;
+	lua_Integer i;
+	int dummy_object;
+
+	fprintf(stderr, "TestGroupLocking start\n");
+
+	assert(false == LuaHashMap_GetLockStatistics(hash_map, &lock_statistics));
+	/* Locking can't be turned on while a session is pinning a table */
+	share_map = LuaHashMap_CreateShare(hash_map);
+	LuaHashMap_BeginAccess(share_map);
+	assert(false == LuaHashMap_EnableGroupLocking(hash_map, 4));
+	LuaHashMap_EndAccess(share_map);
+	/* Any hash map in the group can turn it on, and it covers the ones created before too */
+	assert(true == LuaHashMap_EnableGroupLocking(share_map, 4));
+	/* Enabling twice is harmless */
+	assert(true == LuaHashMap_EnableGroupLocking(hash_map, 4));
+
+	assert(true == LuaHashMap_GetLockStatistics(hash_map, &lock_statistics));
+	assert(0 == lock_statistics.sharedAcquireCount);
+
+	LuaHashMap_SetValuePointerForKeyPointer(hash_map, &dummy_object, &dummy_object);
+	LuaHashMap_SetValueNumberForKeyNumber(hash_map, 2.5, 1.5);
+	LuaHashMap_SetValueStringForKeyString(share_map, "red", "apple");
+	assert(&dummy_object == LuaHashMap_GetValuePointerForKeyPointer(hash_map, &dummy_object));
+	assert(2.5 == LuaHashMap_GetValueNumberForKeyNumber(hash_map, 1.5));
+	assert(false == LuaHashMap_ExistsKeyNumber(hash_map, 99.0));
+	assert(0 == Internal_safestrcmp("red", LuaHashMap_GetValueStringForKeyString(share_map, "apple")));
+	assert(2 == LuaHashMap_Count(hash_map));
+
+	/* Sessions are refused with locking on, since other threads use the stack in between calls. */
+	LuaHashMap_BeginAccess(hash_map);
+	assert(0 == lua_gettop(LuaHashMap_GetLuaState(hash_map)));
+	assert(2.5 == LuaHashMap_GetValueNumberForKeyNumber(hash_map, 1.5));
+	LuaHashMap_EndAccess(hash_map);
 
-	fprintf(stderr, "TestValueStringNULL start\n");
-	
-	LuaHashMap_SetValueStringForKeyString(hash_map, "$3.99", "milk");
-	/* Lua treats NULL strings as pushing nil which removes an entry */
-	LuaHashMap_SetValueStringForKeyString(hash_map, NULL, "gas");
-	LuaHashMap_SetValueStringForKeyString(hash_map, "$2.99", "bread");
-	
 	hash_iterator = LuaHashMap_GetIteratorAtBegin(hash_map);
+	i = 0;
 	do
 	{
-		fprintf(stderr, "Price of %s: %s\n", 
-			   LuaHashMap_GetKeyStringAtIterator(&hash_iterator), 
-			   LuaHashMap_GetValueStringAtIterator(&hash_iterator));
-		
+		i++;
 	} while(LuaHashMap_IteratorNext(&hash_iterator));
+	assert(2 == i);
+
+	assert(true == LuaHashMap_GetLockStatistics(share_map, &lock_statistics));
+#if LUA_VERSION_NUM >= 504
+	/* No lookup is read-only on 5.4 */
+	assert(0 == lock_statistics.sharedAcquireCount);
+#else
+	/* GetValuePointer, GetValueNumber x2, ExistsKeyNumber */
+	assert(4 == lock_statistics.sharedAcquireCount);
+#endif
+	assert(0 == lock_statistics.readerStateUnavailableCount);
+	assert(lock_statistics.exclusiveAcquireCount >= 8);
 
-	/* Lua treats NULL strings as pushing nil which removes an entry. Thus we only have 2. */
-	/* Internal change: I now use lua_pushlstring and pass an explict 0 length. This causes Lua to push an empty string and create a key/value pair. So the count is 3. */
-//	assert(2 == LuaHashMap_Count(hash_map));
-	assert(3 == LuaHashMap_Count(hash_map));
-//	assert(0 == LuaHashMap_ExistsKeyString(hash_map, "gas"));
-	assert(1 == LuaHashMap_ExistsKeyString(hash_map, "gas"));
-	assert(1 == LuaHashMap_ExistsKeyString(hash_map, "milk"));
-	assert(1 == LuaHashMap_ExistsKeyString(hash_map, "bread"));
-
-	/* Lua treats NULL strings as pushing nil which removes an entry */
-	/* Internal change: lua_pushlstring causes the value to be set to an empty string so the entry remains. */
-	LuaHashMap_SetValueStringForKeyString(hash_map, NULL, "bread");
+	LuaHashMap_Clear(hash_map);
+	LuaHashMap_Clear(share_map);
 
-	hash_iterator = LuaHashMap_GetIteratorAtBegin(hash_map);	
-	do
+#if !defined(_WIN32) && !defined(WIN32)
 	{
-		fprintf(stderr, "Price of %s: %s\n", 
-			   LuaHashMap_GetKeyStringAtIterator(&hash_iterator), 
-			   LuaHashMap_GetValueStringAtIterator(&hash_iterator));
-		
-	} while(LuaHashMap_IteratorNext(&hash_iterator));
-//	assert(1 == LuaHashMap_Count(hash_map));
-	assert(3 == LuaHashMap_Count(hash_map));
-//	assert(0 == LuaHashMap_ExistsKeyString(hash_map, "gas"));
-	assert(1 == LuaHashMap_ExistsKeyString(hash_map, "gas"));
-	assert(1 == LuaHashMap_ExistsKeyString(hash_map, "milk"));
-//	assert(0 == LuaHashMap_ExistsKeyString(hash_map, "bread"));
-	assert(1 == LuaHashMap_ExistsKeyString(hash_map, "bread"));
-	
+		pthread_t threads_array[TEST_GROUP_LOCKING_NUMBER_OF_THREADS];
+		struct TestGroupLockingThreadData thread_data_array[TEST_GROUP_LOCKING_NUMBER_OF_THREADS];
+		size_t j;
+
+		for(i=0; i<100; i++)
+		{
+			LuaHashMap_SetValueIntegerForKeyInteger(share_map, i*2, i);
+		}
+		for(j=0; j<TEST_GROUP_LOCKING_NUMBER_OF_THREADS; j++)
+		{
+			thread_data_array[j].writerHashMap = hash_map;
+			thread_data_array[j].readerHashMap = share_map;
+			thread_data_array[j].firstKey = (lua_Integer)(j*TEST_GROUP_LOCKING_KEYS_PER_THREAD);
+			pthread_create(&threads_array[j], NULL, TestGroupLocking_ThreadFunction, &thread_data_array[j]);
+		}
+		for(j=0; j<TEST_GROUP_LOCKING_NUMBER_OF_THREADS; j++)
+		{
+			pthread_join(threads_array[j], NULL);
+		}
+		/* Every integer key plus the odd string keys */
+		assert(TEST_GROUP_LOCKING_NUMBER_OF_THREADS*TEST_GROUP_LOCKING_KEYS_PER_THREAD*3/2 == LuaHashMap_Count(hash_map));
+		assert(100 == LuaHashMap_Count(share_map));
+
+		assert(true == LuaHashMap_GetLockStatistics(hash_map, &lock_statistics));
+#if LUA_VERSION_NUM < 504
+		/* A lookup that found no free reader state counts as exclusive instead */
+		assert(lock_statistics.sharedAcquireCount + lock_statistics.readerStateUnavailableCount >= TEST_GROUP_LOCKING_NUMBER_OF_THREADS*TEST_GROUP_LOCKING_KEYS_PER_THREAD*2);
+#endif
+		assert(lock_statistics.exclusiveContendedCount <= lock_statistics.exclusiveAcquireCount);
+		assert(lock_statistics.sharedContendedCount <= lock_statistics.sharedAcquireCount);
+		fprintf(stderr, "TestGroupLocking exclusive: %d (%d contended), shared: %d (%d contended, %d without a reader state)\n",
+			(int)lock_statistics.exclusiveAcquireCount, (int)lock_statistics.exclusiveContendedCount,
+			(int)lock_statistics.sharedAcquireCount, (int)lock_statistics.sharedContendedCount,
+			(int)lock_statistics.readerStateUnavailableCount
+		);
+
+		/* Readers only, all doing integer key lookups on the same table at the same time */
+		LuaHashMap_Clear(share_map);
+		for(i=1; i<=1000; i++)
+		{
+			LuaHashMap_SetValueIntegerForKeyInteger(share_map, i*3, i);
+		}
+		for(j=0; j<TEST_GROUP_LOCKING_NUMBER_OF_THREADS; j++)
+		{
+			pthread_create(&threads_array[j], NULL, TestGroupLocking_ReaderThreadFunction, share_map);
+		}
+		for(j=0; j<TEST_GROUP_LOCKING_NUMBER_OF_THREADS; j++)
+		{
+			pthread_join(threads_array[j], NULL);
+		}
+	}
+#endif
 
+	LuaHashMap_FreeShare(share_map);
 	LuaHashMap_Free(hash_map);
-	fprintf(stderr, "TestValueStringNULL done\n");	
+
+	/* Without reader states every lookup falls back to exclusive, and is counted only once */
+	{
+		LuaHashMapLockStatistics statistics_before;
+		hash_map = LuaHashMap_Create();
+		assert(true == LuaHashMap_EnableGroupLocking(hash_map, 0));
+		assert(true == LuaHashMap_GetLockStatistics(hash_map, &statistics_before));
+		assert(false == LuaHashMap_ExistsKeyInteger(hash_map, 1));
+		assert(true == LuaHashMap_GetLockStatistics(hash_map, &lock_statistics));
+		assert(0 == lock_statistics.sharedAcquireCount);
+		assert(statistics_before.exclusiveAcquireCount + 1 == lock_statistics.exclusiveAcquireCount);
+#if LUA_VERSION_NUM < 504
+		assert(1 == lock_statistics.readerStateUnavailableCount);
+#endif
+		LuaHashMap_Free(hash_map);
+	}
+
+	/* A group on a caller-owned lua_State can lock too. lua_close frees the lock. */
+	{
+		lua_State* lua_state = luaL_newstate();
+		LuaHashMap* first_map = LuaHashMap_CreateShareFromLuaState(lua_state);
+		LuaHashMap* second_map = LuaHashMap_CreateShareFromLuaState(lua_state);
+		assert(true == LuaHashMap_EnableGroupLocking(second_map, 2));
+		LuaHashMap_SetValueIntegerForKeyInteger(first_map, 5, 1);
+		assert(true == LuaHashMap_GetLockStatistics(first_map, &lock_statistics));
+		assert(lock_statistics.exclusiveAcquireCount >= 1);
+		assert(5 == LuaHashMap_GetValueIntegerForKeyInteger(second_map, 1) + LuaHashMap_GetValueIntegerForKeyInteger(first_map, 1));
+		LuaHashMap_FreeShare(second_map);
+		LuaHashMap_FreeShare(first_map);
+		lua_close(lua_state);
+	}
+	fprintf(stderr, "TestGroupLocking done\n");
 }
 
+static void TestActor_SetIntegerRequest(LuaHashMapActorRequest* actor_request, LuaHashMapActorOperation the_operation, lua_Integer key_integer, lua_Integer value_integer)
+{
+	memset(actor_request, 0, sizeof(LuaHashMapActorRequest));
+	actor_request->theOperation = the_operation;
+	actor_request->theKey.valueType = LUA_TNUMBER;
+	actor_request->theKey.isInteger = true;
+	actor_request->theKey.theValue.theInteger = key_integer;
+	actor_request->theValue.valueType = LUA_TNUMBER;
+	actor_request->theValue.isInteger = true;
+	actor_request->theValue.theValue.theInteger = value_integer;
+}
 
-void TestValuePointerNULL()
-{	
+static void TestActor_CountCompletions(LuaHashMapActorRequest* actor_request, void* user_data)
+{
+	(void)actor_request;
+	(*(int*)user_data)++;
+}
+
+#if !defined(_WIN32) && !defined(WIN32)
+#define TEST_ACTOR_NUMBER_OF_THREADS 4
+#define TEST_ACTOR_KEYS_PER_THREAD 2000
+
+struct TestActorThreadData
+{
+	LuaHashMapActor* hashActor;
+	lua_Integer firstKey;
+};
+
+static void* TestActor_OwnerThreadFunction(void* user_data)
+{
+	LuaHashMapActor_Run((LuaHashMapActor*)user_data);
+	return NULL;
+}
+
+static void* TestActor_SubmitThreadFunction(void* user_data)
+{
+	struct TestActorThreadData* thread_data = (struct TestActorThreadData*)user_data;
+	LuaHashMapActorRequest set_request;
+	LuaHashMapActorRequest get_request;
+	lua_Integer i;
+	for(i=thread_data->firstKey; i<thread_data->firstKey+TEST_ACTOR_KEYS_PER_THREAD; i++)
+	{
+		/* Two requests in flight at once. They run in submission order so the get sees the set. */
+		TestActor_SetIntegerRequest(&set_request, LUAHASHMAP_ACTOR_SET, i, i*3);
+		TestActor_SetIntegerRequest(&get_request, LUAHASHMAP_ACTOR_GET, i, 0);
+		assert(true == LuaHashMapActor_Submit(thread_data->hashActor, &set_request));
+		assert(true == LuaHashMapActor_Submit(thread_data->hashActor, &get_request));
+		while(false == LuaHashMapActor_IsRequestComplete(&get_request))
+		{
+		}
+		assert(true == LuaHashMapActor_IsRequestComplete(&set_request));
+		assert(true == get_request.wasFound);
+		assert(i*3 == TestIteratorNextBatch_ToInteger(&get_request.theValue));
+	}
+	return NULL;
+}
+#endif
+
+void TestActor()
+{
 	LuaHashMap* hash_map = LuaHashMap_Create();
-	/* Better to declare when you assign it, but you need C99 */
-	LuaHashMapIterator hash_iterator;
-	LuaHashMapIterator hash_iterator_end;
+	LuaHashMapActor* hash_actor = LuaHashMapActor_Create(hash_map);
+	LuaHashMapActorRequest requests_array[5];
+	int number_of_completions = 0;
+
+	fprintf(stderr, "TestActor start\n");
+
+	assert(NULL == LuaHashMapActor_Create(NULL));
+	assert(hash_map == LuaHashMapActor_GetHashMap(hash_actor));
+	assert(false == LuaHashMapActor_Submit(hash_actor, NULL));
+	assert(0 == LuaHashMapActor_Drain(hash_actor));
+
+	TestActor_SetIntegerRequest(&requests_array[0], LUAHASHMAP_ACTOR_SET, 1, 10);
+	TestActor_SetIntegerRequest(&requests_array[1], LUAHASHMAP_ACTOR_GET, 1, 0);
+	TestActor_SetIntegerRequest(&requests_array[2], LUAHASHMAP_ACTOR_REMOVE, 1, 0);
+	TestActor_SetIntegerRequest(&requests_array[3], LUAHASHMAP_ACTOR_EXISTS, 1, 0);
+	/* String keys and values */
+	memset(&requests_array[4], 0, sizeof(LuaHashMapActorRequest));
+	requests_array[4].theOperation = LUAHASHMAP_ACTOR_SET;
+	requests_array[4].theKey.valueType = LUA_TSTRING;
+	requests_array[4].theKey.theValue.theString.stringPointer = "apple";
+	requests_array[4].theKey.theValue.theString.stringLength = 5;
+	requests_array[4].theValue.valueType = LUA_TSTRING;
+	requests_array[4].theValue.theValue.theString.stringPointer = "red";
+	requests_array[4].theValue.theValue.theString.stringLength = 3;
+	requests_array[4].completionFunction = TestActor_CountCompletions;
+	requests_array[4].userData = &number_of_completions;
+
+	assert(true == LuaHashMapActor_Submit(hash_actor, &requests_array[0]));
+	assert(true == LuaHashMapActor_Submit(hash_actor, &requests_array[1]));
+	assert(true == LuaHashMapActor_Submit(hash_actor, &requests_array[2]));
+	assert(true == LuaHashMapActor_Submit(hash_actor, &requests_array[3]));
+	assert(true == LuaHashMapActor_Submit(hash_actor, &requests_array[4]));
+	assert(false == LuaHashMapActor_IsRequestComplete(&requests_array[0]));
+	/* Nothing runs until the owner drains */
+	assert(true == LuaHashMap_IsEmpty(hash_map));
+
+	assert(5 == LuaHashMapActor_Drain(hash_actor));
+	assert(true == LuaHashMapActor_IsRequestComplete(&requests_array[0]));
+	assert(true == requests_array[1].wasFound);
+	assert(10 == TestIteratorNextBatch_ToInteger(&requests_array[1].theValue));
+	assert(false == requests_array[3].wasFound);
+	/* The callback replaces the completion flag */
+	assert(1 == number_of_completions);
+	assert(false == LuaHashMapActor_IsRequestComplete(&requests_array[4]));
+	assert(1 == LuaHashMap_Count(hash_map));
+	assert(0 == Internal_safestrcmp("red", LuaHashMap_GetValueStringForKeyString(hash_map, "apple")));
+
+	/* A polled GET copies a string result into the request's buffer, or reports the length it needs */
+	{
+		char string_buffer[4];
+		requests_array[4].theOperation = LUAHASHMAP_ACTOR_GET;
+		requests_array[4].completionFunction = NULL;
+		requests_array[4].stringBuffer = string_buffer;
+		requests_array[4].stringBufferSize = sizeof(string_buffer);
+		requests_array[3] = requests_array[4];
+		requests_array[3].stringBufferSize = 3;
+		requests_array[2] = requests_array[4];
+		requests_array[2].stringBuffer = NULL;
+		assert(true == LuaHashMapActor_Submit(hash_actor, &requests_array[4]));
+		assert(true == LuaHashMapActor_Submit(hash_actor, &requests_array[3]));
+		assert(true == LuaHashMapActor_Submit(hash_actor, &requests_array[2]));
+		assert(3 == LuaHashMapActor_Drain(hash_actor));
+		assert(true == LuaHashMapActor_IsRequestComplete(&requests_array[4]));
+		assert(LUA_TSTRING == requests_array[4].theValue.valueType);
+		assert(string_buffer == requests_array[4].theValue.theValue.theString.stringPointer);
+		assert(0 == Internal_safestrcmp("red", string_buffer));
+		assert(true == requests_array[3].wasFound);
+		assert(NULL == requests_array[3].theValue.theValue.theString.stringPointer);
+		assert(3 == requests_array[3].theValue.theValue.theString.stringLength);
+		assert(NULL == requests_array[2].theValue.theValue.theString.stringPointer);
+	}
 
-	fprintf(stderr, "TestValuePointerNULL start\n");
-	
-	LuaHashMap_SetValuePointerForKeyString(hash_map, (void*)399, "milk");
-	/* Unlike strings, Lua seems to push NULL pointers as 0 which does not remove an entry. */
-	LuaHashMap_SetValuePointerForKeyString(hash_map, NULL, "gas");
-	LuaHashMap_SetValuePointerForKeyString(hash_map, (void*)299, "bread");
-	
-	hash_iterator = LuaHashMap_GetIteratorAtBegin(hash_map);
-	do
+	/* Unsupported keys complete as not found */
+	TestActor_SetIntegerRequest(&requests_array[0], LUAHASHMAP_ACTOR_GET, 1, 0);
+	requests_array[0].theKey.valueType = LUA_TNIL;
+	assert(true == LuaHashMapActor_Submit(hash_actor, &requests_array[0]));
+	/* A stop before Run still drains and returns */
+	LuaHashMapActor_Stop(hash_actor);
+	LuaHashMapActor_Run(hash_actor);
+	assert(true == LuaHashMapActor_IsRequestComplete(&requests_array[0]));
+	assert(false == requests_array[0].wasFound);
+	assert(LUA_TNIL == requests_array[0].theValue.valueType);
+	LuaHashMap_Clear(hash_map);
+
+	/* A batch runs in array order, after whatever was already queued */
+	assert(false == LuaHashMapActor_SubmitBatch(hash_actor, requests_array, 0));
+	TestActor_SetIntegerRequest(&requests_array[0], LUAHASHMAP_ACTOR_SET, 2, 20);
+	assert(true == LuaHashMapActor_Submit(hash_actor, &requests_array[0]));
+	TestActor_SetIntegerRequest(&requests_array[1], LUAHASHMAP_ACTOR_GET, 2, 0);
+	TestActor_SetIntegerRequest(&requests_array[2], LUAHASHMAP_ACTOR_SET, 2, 30);
+	TestActor_SetIntegerRequest(&requests_array[3], LUAHASHMAP_ACTOR_GET, 2, 0);
+	assert(true == LuaHashMapActor_SubmitBatch(hash_actor, &requests_array[1], 3));
+	/* Requests are pending, so this returns without sleeping */
+	assert(true == LuaHashMapActor_WaitForRequests(hash_actor));
+	assert(4 == LuaHashMapActor_Drain(hash_actor));
+	assert(20 == TestIteratorNextBatch_ToInteger(&requests_array[1].theValue));
+	assert(30 == TestIteratorNextBatch_ToInteger(&requests_array[3].theValue));
+	/* The stop is consumed by the wait */
+	LuaHashMapActor_Stop(hash_actor);
+	assert(false == LuaHashMapActor_WaitForRequests(hash_actor));
+	LuaHashMap_Clear(hash_map);
+
+#if !defined(_WIN32) && !defined(WIN32)
 	{
-		fprintf(stderr, "Price of %s: %d\n", 
-				LuaHashMap_GetKeyStringAtIterator(&hash_iterator), 
-				(int)LuaHashMap_GetValuePointerAtIterator(&hash_iterator));
-		
-	} while(LuaHashMap_IteratorNext(&hash_iterator));
-	/* Unlike strings, Lua seems to push NULL pointers as 0 which does not remove an entry. Thus we have 3. */
-	assert(3 == LuaHashMap_Count(hash_map));
-	assert(1 == LuaHashMap_ExistsKeyString(hash_map, "gas"));
-	assert(1 == LuaHashMap_ExistsKeyString(hash_map, "milk"));
-	assert(1 == LuaHashMap_ExistsKeyString(hash_map, "bread"));
-	assert((void*)399 == LuaHashMap_GetValuePointerForKeyString(hash_map, "milk"));
-	assert(NULL == LuaHashMap_GetValuePointerForKeyString(hash_map, "gas"));
-	assert((void*)299 == LuaHashMap_GetValuePointerForKeyString(hash_map, "bread"));
+		pthread_t owner_thread;
+		pthread_t threads_array[TEST_ACTOR_NUMBER_OF_THREADS];
+		struct TestActorThreadData thread_data_array[TEST_ACTOR_NUMBER_OF_THREADS];
+		size_t i;
 
-	
-	LuaHashMap_SetValuePointerForKeyString(hash_map, NULL, "bread");
+		pthread_create(&owner_thread, NULL, TestActor_OwnerThreadFunction, hash_actor);
+		for(i=0; i<TEST_ACTOR_NUMBER_OF_THREADS; i++)
+		{
+			thread_data_array[i].hashActor = hash_actor;
+			thread_data_array[i].firstKey = (lua_Integer)(i*TEST_ACTOR_KEYS_PER_THREAD);
+			pthread_create(&threads_array[i], NULL, TestActor_SubmitThreadFunction, &thread_data_array[i]);
+		}
+		for(i=0; i<TEST_ACTOR_NUMBER_OF_THREADS; i++)
+		{
+			pthread_join(threads_array[i], NULL);
+		}
+		LuaHashMapActor_Stop(hash_actor);
+		pthread_join(owner_thread, NULL);
+		assert(TEST_ACTOR_NUMBER_OF_THREADS*TEST_ACTOR_KEYS_PER_THREAD == LuaHashMap_Count(hash_map));
+	}
+#endif
 
-	/* Showing a different way to loop */
-	for(hash_iterator = LuaHashMap_GetIteratorAtBegin(hash_map), hash_iterator_end = LuaHashMap_GetIteratorAtEnd(hash_map);
-		! LuaHashMap_IteratorIsEqual(&hash_iterator, &hash_iterator_end);
-		LuaHashMap_IteratorNext(&hash_iterator)
-	)
+	LuaHashMapActor_Free(hash_actor);
+	LuaHashMap_Free(hash_map);
+	fprintf(stderr, "TestActor done\n");
+}
+
+#if !defined(_WIN32) && !defined(WIN32)
+#define TEST_SNAPSHOT_NUMBER_OF_THREADS 4
+#define TEST_SNAPSHOT_NUMBER_OF_KEYS 100
+#define TEST_SNAPSHOT_LAST_GENERATION 200
+
+/* The writer sets every key to the generation before publishing it, so a reader must never see a mix. */
+static void* TestSnapshot_ReaderThreadFunction(void* user_data)
+{
+	LuaHashMap* hash_map = (LuaHashMap*)user_data;
+	lua_Integer the_generation = -1;
+	while(TEST_SNAPSHOT_LAST_GENERATION != the_generation)
 	{
-		fprintf(stderr, "Price of %s: %d\n", 
-				LuaHashMap_GetKeyStringAtIterator(&hash_iterator), 
-				(int)LuaHashMap_GetValuePointerAtIterator(&hash_iterator));
-		
+		LuaHashMapSnapshot* hash_snapshot = LuaHashMap_AcquireSnapshot(hash_map);
+		LuaHashMapValue the_value;
+		lua_Integer i;
+		if(NULL == hash_snapshot)
+		{
+			continue;
+		}
+		/* The snapshot from before the writer started */
+		if(false == LuaHashMapSnapshot_GetValueForKeyString(hash_snapshot, "generation", &the_value))
+		{
+			LuaHashMapSnapshot_Release(hash_snapshot);
+			continue;
+		}
+		/* Snapshots only move forward */
+		assert(TestIteratorNextBatch_ToInteger(&the_value) >= the_generation);
+		the_generation = TestIteratorNextBatch_ToInteger(&the_value);
+		for(i=0; i<TEST_SNAPSHOT_NUMBER_OF_KEYS; i++)
+		{
+			assert(true == LuaHashMapSnapshot_GetValueForKeyInteger(hash_snapshot, i, &the_value));
+			assert(the_generation == TestIteratorNextBatch_ToInteger(&the_value));
+		}
+		LuaHashMapSnapshot_Release(hash_snapshot);
 	}
-	assert(1 == LuaHashMap_ExistsKeyString(hash_map, "gas"));
-	assert(1 == LuaHashMap_ExistsKeyString(hash_map, "milk"));
-	assert(1 == LuaHashMap_ExistsKeyString(hash_map, "bread"));
-	assert((void*)399 == LuaHashMap_GetValuePointerForKeyString(hash_map, "milk"));
-	assert(NULL == LuaHashMap_GetValuePointerForKeyString(hash_map, "gas"));
-	assert(NULL == LuaHashMap_GetValuePointerForKeyString(hash_map, "bread"));
-	
-	
-	
-	
-	/* Lua will also accept NULL for both keys and values when used as pointers (userdata) */
-	LuaHashMap_SetValuePointerForKeyPointer(hash_map, NULL, NULL);
-	assert(4 == LuaHashMap_Count(hash_map));
-	 
-	 
-	 
-	
+	return NULL;
+}
+#endif
+
+void TestSnapshot()
+{
+	LuaHashMap* hash_map = LuaHashMap_Create();
+	LuaHashMapSnapshot* hash_snapshot;
+	LuaHashMapSnapshot* old_snapshot;
+	LuaHashMapValue the_key;
+	LuaHashMapValue the_value;
+	int some_pointer = 0;
+
+	fprintf(stderr, "TestSnapshot start\n");
+
+	assert(NULL == LuaHashMap_AcquireSnapshot(hash_map));
+	assert(0 == LuaHashMapSnapshot_Count(NULL));
+	LuaHashMapSnapshot_Release(NULL);
+
+	LuaHashMap_SetValueStringForKeyString(hash_map, "apple", "red");
+	LuaHashMap_SetValueIntegerForKeyInteger(hash_map, 100, 1);
+	LuaHashMap_SetValueNumberForKeyNumber(hash_map, 3.5, 2.5);
+	LuaHashMap_SetValuePointerForKeyPointer(hash_map, &some_pointer, &some_pointer);
+	assert(true == LuaHashMap_PublishSnapshot(hash_map));
+	hash_snapshot = LuaHashMap_AcquireSnapshot(hash_map);
+	assert(NULL != hash_snapshot);
+	assert(4 == LuaHashMapSnapshot_Count(hash_snapshot));
+
+	assert(true == LuaHashMapSnapshot_GetValueForKeyString(hash_snapshot, "red", &the_value));
+	assert(LUA_TSTRING == the_value.valueType);
+	assert(0 == Internal_safestrcmp("apple", the_value.theValue.theString.stringPointer));
+	assert(5 == the_value.theValue.theString.stringLength);
+	assert(false == LuaHashMapSnapshot_GetValueForKeyString(hash_snapshot, "green", &the_value));
+	assert(false == LuaHashMapSnapshot_GetValueForKeyString(hash_snapshot, NULL, &the_value));
+	assert(true == LuaHashMapSnapshot_GetValueForKeyInteger(hash_snapshot, 1, &the_value));
+	assert(100 == TestIteratorNextBatch_ToInteger(&the_value));
+	/* 1 and 1.0 are the same key */
+	assert(true == LuaHashMapSnapshot_GetValueForKeyNumber(hash_snapshot, 1.0, NULL));
+	assert(true == LuaHashMapSnapshot_GetValueForKeyNumber(hash_snapshot, 2.5, &the_value));
+	assert(LUA_TNUMBER == the_value.valueType);
+	assert(3.5 == the_value.theValue.theNumber);
+	assert(true == LuaHashMapSnapshot_GetValueForKeyPointer(hash_snapshot, &some_pointer, &the_value));
+	assert(&some_pointer == the_value.theValue.thePointer);
+	/* The generic version with a key that isn't NUL terminated */
+	the_key.valueType = LUA_TSTRING;
+	the_key.theValue.theString.stringPointer = "redder";
+	the_key.theValue.theString.stringLength = 3;
+	assert(true == LuaHashMapSnapshot_GetValueForKey(hash_snapshot, &the_key, NULL));
+	the_key.valueType = LUA_TNIL;
+	assert(false == LuaHashMapSnapshot_GetValueForKey(hash_snapshot, &the_key, NULL));
+
+	/* Changes to the live map don't show until the next publish, and the old snapshot stays valid while held */
+	LuaHashMap_RemoveKeyString(hash_map, "red");
+	LuaHashMap_SetValueIntegerForKeyInteger(hash_map, 200, 1);
+	assert(true == LuaHashMapSnapshot_GetValueForKeyString(hash_snapshot, "red", NULL));
+	assert(hash_snapshot == LuaHashMap_AcquireSnapshot(hash_map));
+	LuaHashMapSnapshot_Release(hash_snapshot);
+	old_snapshot = hash_snapshot;
+	assert(true == LuaHashMap_PublishSnapshot(hash_map));
+	hash_snapshot = LuaHashMap_AcquireSnapshot(hash_map);
+	assert(old_snapshot != hash_snapshot);
+	assert(false == LuaHashMapSnapshot_GetValueForKeyString(hash_snapshot, "red", NULL));
+	assert(true == LuaHashMapSnapshot_GetValueForKeyInteger(hash_snapshot, 1, &the_value));
+	assert(200 == TestIteratorNextBatch_ToInteger(&the_value));
+	assert(true == LuaHashMapSnapshot_GetValueForKeyString(old_snapshot, "red", &the_value));
+	assert(0 == Internal_safestrcmp("apple", the_value.theValue.theString.stringPointer));
+	LuaHashMapSnapshot_Release(old_snapshot);
+	LuaHashMapSnapshot_Release(hash_snapshot);
+
+	/* A big enough map to grow the buckets, published from inside an access session */
+	{
+		lua_Integer i;
+		LuaHashMap_BeginAccess(hash_map);
+		for(i=0; i<1000; i++)
+		{
+			LuaHashMap_SetValueIntegerForKeyInteger(hash_map, i*2, i);
+		}
+		assert(true == LuaHashMap_PublishSnapshot(hash_map));
+		LuaHashMap_EndAccess(hash_map);
+		hash_snapshot = LuaHashMap_AcquireSnapshot(hash_map);
+		assert(LuaHashMap_Count(hash_map) == LuaHashMapSnapshot_Count(hash_snapshot));
+		for(i=0; i<1000; i++)
+		{
+			assert(true == LuaHashMapSnapshot_GetValueForKeyInteger(hash_snapshot, i, &the_value));
+			assert(i*2 == TestIteratorNextBatch_ToInteger(&the_value));
+		}
+		LuaHashMapSnapshot_Release(hash_snapshot);
+	}
+	LuaHashMap_Clear(hash_map);
+
+#if !defined(_WIN32) && !defined(WIN32)
+	{
+		pthread_t threads_array[TEST_SNAPSHOT_NUMBER_OF_THREADS];
+		lua_Integer the_generation;
+		lua_Integer i;
+		size_t j;
+
+		for(j=0; j<TEST_SNAPSHOT_NUMBER_OF_THREADS; j++)
+		{
+			pthread_create(&threads_array[j], NULL, TestSnapshot_ReaderThreadFunction, hash_map);
+		}
+		for(the_generation=0; the_generation<=TEST_SNAPSHOT_LAST_GENERATION; the_generation++)
+		{
+			for(i=0; i<TEST_SNAPSHOT_NUMBER_OF_KEYS; i++)
+			{
+				LuaHashMap_SetValueIntegerForKeyInteger(hash_map, the_generation, i);
+			}
+			LuaHashMap_SetValueIntegerForKeyString(hash_map, the_generation, "generation");
+			assert(true == LuaHashMap_PublishSnapshot(hash_map));
+		}
+		for(j=0; j<TEST_SNAPSHOT_NUMBER_OF_THREADS; j++)
+		{
+			pthread_join(threads_array[j], NULL);
+		}
+	}
+#endif
+
+	/* A reader may outlive the hash map's reference */
+	hash_snapshot = LuaHashMap_AcquireSnapshot(hash_map);
 	LuaHashMap_Free(hash_map);
-	fprintf(stderr, "TestValuePointerNULL done\n");
-	
-	
+	assert(true == LuaHashMapSnapshot_GetValueForKeyInteger(hash_snapshot, 0, NULL));
+	LuaHashMapSnapshot_Release(hash_snapshot);
+	fprintf(stderr, "TestSnapshot done\n");
 }
 
 void BenchMarkSameStringPointer()
@@ -693,6 +2597,52 @@ void BenchMarkIteratorGetLookupWithLength()
 
 }
 
+void BenchMarkIntegerKeysArrayPart()
+{
+	const size_t NUMBER_OF_ELEMENTS = 1000000;
+	/* Dense IDs 1..N presized into the array part, which is where lua_rawgeti/lua_rawseti shine. */
+	LuaHashMap* hash_map = LuaHashMap_CreateWithSizeHints((int)NUMBER_OF_ELEMENTS, 0);
+	size_t i;
+	fprintf(stderr, "BenchMarkIntegerKeysArrayPart start\n");
+	for(i=1; i<=NUMBER_OF_ELEMENTS; i++)
+	{
+		LuaHashMap_SetValueIntegerForKeyInteger(hash_map, (lua_Integer)i, (lua_Integer)i);
+	}
+	fprintf(stderr, "count: %d\n", (int)LuaHashMap_Count(hash_map));
+
+#if defined(ENABLE_BENCHMARK) && defined(__APPLE__)
+	const size_t NUM_OF_LOOPS = 10;
+	size_t j;
+	CFTimeInterval start_time = CACurrentMediaTime();
+
+	for(j=0; j<NUM_OF_LOOPS; j++)
+	{
+		for(i=1; i<=NUMBER_OF_ELEMENTS; i++)
+		{
+			if(false == LuaHashMap_ExistsKeyInteger(hash_map, (lua_Integer)i))
+			{
+				fprintf(stderr, "Assertion failure. key: %d not in hash\n", (int)i);
+			}
+			else
+			{
+				lua_Integer ret_val = LuaHashMap_GetValueIntegerForKeyInteger(hash_map, (lua_Integer)i);
+				/* Just so the compiler doesn't throw away code, use the value */
+				if(ret_val > (lua_Integer)NUMBER_OF_ELEMENTS)
+				{
+					fprintf(stderr, "Assertion failure. value: %d exceeds NUMBER_OF_ELEMENTS\n", (int)ret_val);
+				}
+			}
+			LuaHashMap_SetValueIntegerForKeyInteger(hash_map, (lua_Integer)j, (lua_Integer)i);
+		}
+	}
+	CFTimeInterval end_time = CACurrentMediaTime();
+	fprintf(stderr, "diff time: %lf\n", end_time-start_time);
+#endif
+	LuaHashMap_Free(hash_map);
+	fprintf(stderr, "BenchMarkIntegerKeysArrayPart done\n");
+}
+
+
 
 void BenchMarkStringInsertionDifferentPointer()
 {	
@@ -1186,6 +3136,8 @@ int main(int argc, char* argv[])
 	BenchMarkExistsGetLookupWithLength();
 	BenchMarkIteratorGetLookupWithLength();
 
+	BenchMarkIntegerKeysArrayPart();
+
 	
 	BenchMarkStringInsertionDifferentPointer();
 	BenchMarkStringInsertionSamePointer();
@@ -1200,6 +3152,30 @@ int main(int argc, char* argv[])
 	TestSimpleKeyStringNumberValueWithIterator();
 	TestValuePointerNULL();
 	TestValueStringNULL();
+	TestSetValuesForKeys();
+	TestGetValuesForKeys();
+	TestAccessSession();
+	TestCount();
+	TestReserve();
+	TestCompact();
+	TestGCMode();
+	TestExactIntegers();
+	TestIntegerKeysArrayPart();
+	TestTryGetValue();
+	TestIncrementGetOrSetTake();
+	TestCompareAndSet();
+	TestForEach();
+	TestRemoveIf();
+	TestTransformValues();
+	TestAggregateNumbers();
+	TestEval();
+	TestIteratorNextBatch();
+	TestCursor();
+	TestScan();
+	TestSharded();
+	TestGroupLocking();
+	TestActor();
+	TestSnapshot();
 	
 	LuaHashMap_Free(hash_map);
 	fprintf(stderr, "Program passed all tests!\n");
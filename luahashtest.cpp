@@ -5,6 +5,13 @@
 #include <string.h>
 #include <iostream>
 #include <string>
+#ifdef LUAHASHMAPCPP_HAS_FUTURE
+#include <thread>
+#include <vector>
+#endif
+#ifdef LUAHASHMAPCPP_HAS_COROUTINE
+#include <atomic>
+#endif
 
 
 static int Internal_safestrcmp(const char* str1, const char* str2)
@@ -2819,7 +2826,262 @@ int DoKeyNumberValueStringCpp()
 	return 0;
 }
 
+int DoScopedAccess()
+{
+	lhm::lua_hash_map<lua_Integer, lua_Integer> hash_map;
+	lua_Integer i;
+	size_t ret_val;
+
+	hash_map.reserve(100);
+	{
+		lhm::scoped_access<lhm::lua_hash_map<lua_Integer, lua_Integer> > the_access(hash_map);
+		for(i=0; i<100; i++)
+		{
+			hash_map.insert(std::pair<lua_Integer, lua_Integer>(i, i*2));
+		}
+		{
+			// nested sessions are allowed
+			lhm::scoped_access<lhm::lua_hash_map<lua_Integer, lua_Integer> > the_nested_access(hash_map);
+			ret_val = hash_map.erase(50);
+			assert(1 == ret_val);
+		}
+		ret_val = hash_map.size();
+		assert(99 == ret_val);
+	}
+
+	ret_val = hash_map.size();
+	assert(99 == ret_val);
+	assert(0 == hash_map.erase(50));
+	assert((*hash_map.find(10)).second == 20);
+
+	return 0;
+}
+
+
+int DoFindWithValue()
+{
+	lhm::lua_hash_map<lua_Integer, void*> hash_map;
+	lhm::lua_hash_map<std::string, std::string> string_map;
+	void* ret_pointer = &hash_map;
+	std::string ret_string;
+
+	// NULL is a legal value, so find-with-value must tell it apart from a missing key.
+	hash_map.insert(std::pair<lua_Integer, void*>(1, (void*)NULL));
+	assert(true == hash_map.find(1, ret_pointer));
+	assert(NULL == ret_pointer);
+	assert(false == hash_map.find(2, ret_pointer));
+
+	string_map.insert(std::pair<std::string, std::string>("key", "value"));
+	assert(true == string_map.find("key", ret_string));
+	assert("value" == ret_string);
+	assert(false == string_map.find("missing", ret_string));
+
+	return 0;
+}
+
 
+struct IsOddValue
+{
+	bool operator()(const std::pair<lua_Integer, lua_Integer>& key_value_pair) const
+	{
+		return 0 != (key_value_pair.second % 2);
+	}
+};
+
+struct IsExpiredSession
+{
+	bool operator()(const std::pair<std::string, lua_Number>& key_value_pair) const
+	{
+		return key_value_pair.second < 100.0;
+	}
+};
+
+int DoEraseIf()
+{
+	lhm::lua_hash_map<lua_Integer, lua_Integer> hash_map;
+	lhm::lua_hash_map<std::string, lua_Number> session_map;
+	lua_Integer ret_integer;
+	lua_Number ret_number;
+
+	for(lua_Integer i=0; i<10; i++)
+	{
+		hash_map.insert(std::pair<lua_Integer, lua_Integer>(i, i*3));
+	}
+	assert(5 == hash_map.erase_if(IsOddValue()));
+	assert(5 == hash_map.size());
+	assert(false == hash_map.find(1, ret_integer));
+	assert(true == hash_map.find(2, ret_integer));
+	assert(6 == ret_integer);
+	assert(0 == lhm::erase_if(hash_map, IsOddValue()));
+
+	session_map.insert(std::pair<std::string, lua_Number>("old", 50.0));
+	session_map.insert(std::pair<std::string, lua_Number>("new", 150.0));
+	assert(1 == lhm::erase_if(session_map, IsExpiredSession()));
+	assert(1 == session_map.size());
+	assert(true == session_map.find("new", ret_number));
+	assert(false == session_map.find("old", ret_number));
+
+	return 0;
+}
+
+
+int DoActor()
+{
+#ifdef LUAHASHMAPCPP_HAS_FUTURE
+	{
+		// Single threaded: nothing happens until the owner drains
+		lhm::lua_hash_map_actor<std::string, lua_Integer> hash_map;
+		std::future<void> insert_future = hash_map.insert(std::make_pair(std::string("apple"), lua_Integer(1)));
+		std::future<std::pair<bool, lua_Integer> > find_future = hash_map.find("apple");
+		std::future<bool> contains_future = hash_map.contains("banana");
+		std::future<void> erase_future = hash_map.erase("apple");
+		std::future<std::pair<bool, lua_Integer> > find_after_erase_future = hash_map.find("apple");
+		assert(std::future_status::timeout == find_future.wait_for(std::chrono::seconds(0)));
+		assert(5 == hash_map.drain());
+		insert_future.get();
+		erase_future.get();
+		std::pair<bool, lua_Integer> the_result = find_future.get();
+		assert(true == the_result.first);
+		assert(1 == the_result.second);
+		assert(false == contains_future.get());
+		assert(false == find_after_erase_future.get().first);
+	}
+	{
+		lhm::lua_hash_map_actor<lua_Integer, std::string> hash_map;
+		std::thread owner_thread([&hash_map]() { hash_map.run(); });
+		std::vector<std::thread> threads_array;
+		for(lua_Integer i=0; i<4; i++)
+		{
+			threads_array.push_back(std::thread([&hash_map, i]() {
+				for(lua_Integer j=i*1000; j<(i+1)*1000; j++)
+				{
+					hash_map.insert(std::make_pair(j, std::to_string(j)));
+					// Requests run in order so the find sees the insert
+					std::pair<bool, std::string> the_result = hash_map.find(j).get();
+					assert(true == the_result.first);
+					assert(std::to_string(j) == the_result.second);
+				}
+			}));
+		}
+		for(size_t i=0; i<threads_array.size(); i++)
+		{
+			threads_array[i].join();
+		}
+		assert(true == hash_map.contains(3999).get());
+		assert(false == hash_map.contains(4000).get());
+		hash_map.stop();
+		owner_thread.join();
+	}
+#endif
+	return 0;
+}
+
+
+#ifdef LUAHASHMAPCPP_HAS_COROUTINE
+// The smallest coroutine type: starts right away and nobody waits for it.
+struct FireAndForgetTask
+{
+	struct promise_type
+	{
+		FireAndForgetTask get_return_object() { return FireAndForgetTask(); }
+		std::suspend_never initial_suspend() { return std::suspend_never(); }
+		std::suspend_never final_suspend() noexcept { return std::suspend_never(); }
+		void return_void() {}
+		void unhandled_exception() { std::terminate(); }
+	};
+};
+
+static FireAndForgetTask DoCoroutine_Steps(lhm::lua_hash_map_actor<std::string, lua_Integer>& hash_map, int& step_return)
+{
+	co_await hash_map.async_insert(std::make_pair(std::string("apple"), lua_Integer(1)));
+	step_return = 1;
+
+	std::pair<bool, lua_Integer> the_result = co_await hash_map.async_find("apple");
+	assert(true == the_result.first);
+	assert(1 == the_result.second);
+	step_return = 2;
+
+	std::vector<std::string> the_keys;
+	the_keys.push_back("banana");
+	the_keys.push_back("apple");
+	the_keys.push_back("cherry");
+	std::vector<std::pair<bool, lua_Integer> > the_results = co_await hash_map.async_find_all(the_keys);
+	assert(3 == the_results.size());
+	assert(false == the_results[0].first);
+	assert(true == the_results[1].first);
+	assert(1 == the_results[1].second);
+	assert(false == the_results[2].first);
+	step_return = 3;
+
+	co_await hash_map.async_erase("apple");
+	assert(false == co_await hash_map.async_contains("apple"));
+	step_return = 4;
+}
+
+static FireAndForgetTask DoCoroutine_Worker(lhm::lua_hash_map_actor<lua_Integer, lua_Integer>& hash_map, lua_Integer first_key, std::thread::id owner_id, std::atomic<int>& finished_count)
+{
+	for(lua_Integer i=first_key; i<first_key+100; i++)
+	{
+		co_await hash_map.async_insert(std::make_pair(i, i*2));
+		// After the first co_await we continue on the owner thread
+		assert(owner_id == std::this_thread::get_id());
+		std::pair<bool, lua_Integer> the_result = co_await hash_map.async_find(i);
+		assert(true == the_result.first);
+		assert(i*2 == the_result.second);
+	}
+	finished_count++;
+}
+#endif
+
+int DoCoroutine()
+{
+#ifdef LUAHASHMAPCPP_HAS_COROUTINE
+	{
+		// Single threaded: each drain runs one request and resumes the coroutine to its next co_await
+		lhm::lua_hash_map_actor<std::string, lua_Integer> hash_map;
+		int the_step = 0;
+		DoCoroutine_Steps(hash_map, the_step);
+		assert(0 == the_step);
+		assert(1 == hash_map.drain());
+		assert(1 == the_step);
+		assert(1 == hash_map.drain());
+		assert(2 == the_step);
+		// async_find_all submits all its keys as one batch
+		assert(3 == hash_map.drain());
+		assert(3 == the_step);
+		assert(1 == hash_map.drain());
+		assert(1 == hash_map.drain());
+		assert(4 == the_step);
+		assert(0 == hash_map.drain());
+	}
+	{
+		lhm::lua_hash_map_actor<lua_Integer, lua_Integer> hash_map;
+		std::atomic<int> finished_count(0);
+		std::thread owner_thread([&hash_map]() { hash_map.run(); });
+		std::thread::id owner_id = owner_thread.get_id();
+		std::vector<std::thread> threads_array;
+		for(lua_Integer i=0; i<4; i++)
+		{
+			threads_array.push_back(std::thread([&hash_map, &finished_count, owner_id, i]() {
+				DoCoroutine_Worker(hash_map, i*100, owner_id, finished_count);
+			}));
+		}
+		for(size_t i=0; i<threads_array.size(); i++)
+		{
+			threads_array[i].join();
+		}
+		while(4 != finished_count)
+		{
+			std::this_thread::yield();
+		}
+		assert(true == hash_map.contains(399).get());
+		assert(false == hash_map.contains(400).get());
+		hash_map.stop();
+		owner_thread.join();
+	}
+#endif
+	return 0;
+}
 
 
 int main(int argc, char* argv[])
@@ -2859,6 +3121,12 @@ int main(int argc, char* argv[])
 	DoKeyIntegerValueStringCpp();
 	DoKeyNumberValueStringCpp();
 
+	DoScopedAccess();
+	DoFindWithValue();
+	DoEraseIf();
+	DoActor();
+	DoCoroutine();
+
 	
 	fprintf(stderr, "Program passed all tests!\n");
     return 0;